@@ -43,6 +43,7 @@ namespace Forsyth
     //          the size of the simulated post-transform cache (max:64)
     //-----------------------------------------------------------------------------
     void OptimizeFaces(const uint16* indexList, uint indexCount, uint vertexCount, uint16* newIndexList, uint16 lruCacheSize);
+    void OptimizeFaces(const uint* indexList, uint indexCount, uint vertexCount, uint* newIndexList, uint16 lruCacheSize);
 
     namespace
     {
@@ -172,7 +173,8 @@ namespace Forsyth
         };
     }
 
-    void OptimizeFaces(const uint16* indexList, uint indexCount, uint vertexCount, uint16* newIndexList, uint16 lruCacheSize)
+    template <typename IndexT>
+    static void OptimizeFacesImpl(const IndexT* indexList, uint indexCount, uint vertexCount, IndexT* newIndexList, uint16 lruCacheSize)
     {
         std::vector<OptimizeVertexData> vertexDataList;
         vertexDataList.resize(vertexCount);
@@ -180,7 +182,7 @@ namespace Forsyth
         // compute face count per vertex
         for (uint i=0; i<indexCount; ++i)
         {
-            uint16 index = indexList[i];
+            IndexT index = indexList[i];
             assert(index < vertexCount);
             OptimizeVertexData& vertexData = vertexDataList[index];
             vertexData.activeFaceListSize++;
@@ -211,7 +213,7 @@ namespace Forsyth
         {
             for (uint j=0; j<3; ++j)
             {
-                uint16 index = indexList[i+j];
+                IndexT index = indexList[i+j];
                 OptimizeVertexData& vertexData = vertexDataList[index];
                 activeFaceList[vertexData.activeFaceListStart + vertexData.activeFaceListSize] = i;
                 vertexData.activeFaceListSize++;
@@ -221,9 +223,9 @@ namespace Forsyth
         std::vector<byte> processedFaceList;
         processedFaceList.resize(indexCount);
 
-        uint16 vertexCacheBuffer[(kMaxVertexCacheSize+3)*2];
-        uint16* cache0 = vertexCacheBuffer;
-        uint16* cache1 = vertexCacheBuffer+(kMaxVertexCacheSize+3);
+        IndexT vertexCacheBuffer[(kMaxVertexCacheSize+3)*2];
+        IndexT* cache0 = vertexCacheBuffer;
+        IndexT* cache1 = vertexCacheBuffer+(kMaxVertexCacheSize+3);
         uint16 entriesInCache0 = 0;
 
         uint bestFace = 0;
@@ -245,7 +247,7 @@ namespace Forsyth
                         float faceScore = 0.f;
                         for (uint k=0; k<3; ++k)
                         {
-                            uint16 index = indexList[face+k];
+                            IndexT index = indexList[face+k];
                             OptimizeVertexData& vertexData = vertexDataList[index];
                             assert(vertexData.activeFaceListSize > 0);
                             assert(vertexData.cachePos0 >= lruCacheSize);
@@ -274,7 +276,7 @@ namespace Forsyth
             // add bestFace to LRU cache and to newIndexList
             for (uint v = 0; v < 3; ++v)
             {
-                uint16 index = indexList[bestFace+v];
+                IndexT index = indexList[bestFace+v];
                 newIndexList[i+v] = index;
 
                 OptimizeVertexData& vertexData = vertexDataList[index];
@@ -305,7 +307,7 @@ namespace Forsyth
             // move the rest of the old verts in the cache down and compute their new scores
             for (uint c0 = 0; c0 < entriesInCache0; ++c0)
             {
-                uint16 index = cache0[c0];
+                IndexT index = cache0[c0];
                 OptimizeVertexData& vertexData = vertexDataList[index];
 
                 if (vertexData.cachePos1 >= entriesInCache1)
@@ -320,7 +322,7 @@ namespace Forsyth
             bestScore = -1.f;
             for (uint c1 = 0; c1 < entriesInCache1; ++c1)
             {
-                uint16 index = cache1[c1];
+                IndexT index = cache1[c1];
                 OptimizeVertexData& vertexData = vertexDataList[index];
                 vertexData.cachePos0 = vertexData.cachePos1;
                 vertexData.cachePos1 = kEvictedCacheIndex;
@@ -330,7 +332,7 @@ namespace Forsyth
                     float faceScore = 0.f;
                     for (uint v=0; v<3; v++)
                     {
-                        uint16 faceIndex = indexList[face+v];
+                        IndexT faceIndex = indexList[face+v];
                         OptimizeVertexData& faceVertexData = vertexDataList[faceIndex];
                         faceScore += faceVertexData.score;
                     }
@@ -347,4 +349,15 @@ namespace Forsyth
         }
     }
 
+
+    void OptimizeFaces(const uint16* indexList, uint indexCount, uint vertexCount, uint16* newIndexList, uint16 lruCacheSize)
+    {
+        OptimizeFacesImpl(indexList, indexCount, vertexCount, newIndexList, lruCacheSize);
+    }
+
+    void OptimizeFaces(const uint* indexList, uint indexCount, uint vertexCount, uint* newIndexList, uint16 lruCacheSize)
+    {
+        OptimizeFacesImpl(indexList, indexCount, vertexCount, newIndexList, lruCacheSize);
+    }
+
 } // namespace Forsyth
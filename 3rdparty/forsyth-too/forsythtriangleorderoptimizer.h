@@ -38,6 +38,7 @@ namespace Forsyth
 	//          the size of the simulated post-transform cache (max:64)
 	//-----------------------------------------------------------------------------
 	void OptimizeFaces(const uint16_t* indexList, uint32_t indexCount, uint32_t vertexCount, uint16_t* newIndexList, uint16_t lruCacheSize);
+	void OptimizeFaces(const uint32_t* indexList, uint32_t indexCount, uint32_t vertexCount, uint32_t* newIndexList, uint16_t lruCacheSize);
 
 } // namespace Forsyth
 
@@ -7,8 +7,11 @@
 
 #include <bgfx.h>
 #include <bx/timer.h>
+#include <bx/uint32_t.h>
 #include "entry/entry.h"
+#include "entry/input.h"
 #include "fpumath.h"
+#include "polygonizer.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -19,440 +22,84 @@
 
 bgfx::VertexDecl s_PosNormalColorDecl;
 
-struct PosNormalColorVertex
-{
-	float m_pos[3];
-	float m_normal[3];
-	uint32_t m_abgr;
-};
+static const uint32_t s_dims[] = { 32, 64, 128, 192 };
+static const uint32_t s_numThreads[] = { 1, 2, 4, 8 };
 
-struct Grid
+struct Settings
 {
-	Grid()
-		: m_val(0.0f)
-	{
-		m_normal[0] = 0.0f;
-		m_normal[1] = 0.0f;
-		m_normal[2] = 0.0f;
-	}
-
-	float m_val;
-	float m_normal[3];
+	uint32_t m_dims;
+	uint32_t m_numThreads;
+	bool m_benchmark;
 };
 
-// Triangulation tables taken from:
-// http://paulbourke.net/geometry/polygonise/
+static Settings s_settings = { 0, 2, false };
 
-static const uint16_t s_edges[256] =
+static void cmdSetDims(const void* _userData)
 {
-	0x000, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
-	0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
-	0x190, 0x099, 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
-	0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
-	0x230, 0x339, 0x033, 0x13a, 0x636, 0x73f, 0x435, 0x53c,
-	0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
-	0x3a0, 0x2a9, 0x1a3, 0x0aa, 0x7a6, 0x6af, 0x5a5, 0x4ac,
-	0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
-	0x460, 0x569, 0x663, 0x76a, 0x66 , 0x16f, 0x265, 0x36c,
-	0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
-	0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0x0ff, 0x3f5, 0x2fc,
-	0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
-	0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x055, 0x15c,
-	0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
-	0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0x0cc,
-	0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
-	0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc,
-	0x0cc, 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
-	0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c,
-	0x15c, 0x55 , 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
-	0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc,
-	0x2fc, 0x3f5, 0x0ff, 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
-	0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c,
-	0x36c, 0x265, 0x16f, 0x066, 0x76a, 0x663, 0x569, 0x460,
-	0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac,
-	0x4ac, 0x5a5, 0x6af, 0x7a6, 0x0aa, 0x1a3, 0x2a9, 0x3a0,
-	0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c,
-	0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x033, 0x339, 0x230,
-	0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c,
-	0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x099, 0x190,
-	0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c,
-	0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x000,
-};
+	s_settings.m_dims = uint32_t(uintptr_t(_userData) );
+}
 
-static const int8_t s_indices[256][16] =
+static void cmdCycleThreads(const void* /*_userData*/)
 {
-	{  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  1,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  8,  3,  9,  8,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  2, 10,  0,  2,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  8,  3,  2, 10,  8, 10,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0, 11,  2,  8, 11,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  9,  0,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1, 11,  2,  1,  9, 11,  9,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   3, 10,  1, 11, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0, 10,  1,  0,  8, 10,  8, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  9,  0,  3, 11,  9, 11, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  3,  0,  7,  3,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  1,  9,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  1,  9,  4,  7,  1,  7,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  4,  7,  3,  0,  4,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  2, 10,  9,  0,  2,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   2, 10,  9,  2,  9,  7,  2,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
-	{   8,  4,  7,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  4,  7, 11,  2,  4,  2,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  0,  1,  8,  4,  7,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  7, 11,  9,  4, 11,  9, 11,  2,  9,  2,  1, -1, -1, -1, -1 },
-	{   3, 10,  1,  3, 11, 10,  7,  8,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   1, 11, 10,  1,  4, 11,  1,  0,  4,  7, 11,  4, -1, -1, -1, -1 },
-	{   4,  7,  8,  9,  0, 11,  9, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
-	{   4,  7, 11,  4, 11,  9,  9, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  5,  4,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  5,  4,  1,  5,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  5,  4,  8,  3,  5,  3,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  0,  8,  1,  2, 10,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   5,  2, 10,  5,  4,  2,  4,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{   2, 10,  5,  3,  2,  5,  3,  5,  4,  3,  4,  8, -1, -1, -1, -1 },
-	{   9,  5,  4,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0, 11,  2,  0,  8, 11,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  5,  4,  0,  1,  5,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  1,  5,  2,  5,  8,  2,  8, 11,  4,  8,  5, -1, -1, -1, -1 },
-	{  10,  3, 11, 10,  1,  3,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  9,  5,  0,  8,  1,  8, 10,  1,  8, 11, 10, -1, -1, -1, -1 },
-	{   5,  4,  0,  5,  0, 11,  5, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
-	{   5,  4,  8,  5,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  7,  8,  5,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  3,  0,  9,  5,  3,  5,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  7,  8,  0,  1,  7,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  7,  8,  9,  5,  7, 10,  1,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  1,  2,  9,  5,  0,  5,  3,  0,  5,  7,  3, -1, -1, -1, -1 },
-	{   8,  0,  2,  8,  2,  5,  8,  5,  7, 10,  5,  2, -1, -1, -1, -1 },
-	{   2, 10,  5,  2,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   7,  9,  5,  7,  8,  9,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  5,  7,  9,  7,  2,  9,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
-	{   2,  3, 11,  0,  1,  8,  1,  7,  8,  1,  5,  7, -1, -1, -1, -1 },
-	{  11,  2,  1, 11,  1,  7,  7,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  5,  8,  8,  5,  7, 10,  1,  3, 10,  3, 11, -1, -1, -1, -1 },
-	{   5,  7,  0,  5,  0,  9,  7, 11,  0,  1,  0, 10, 11, 10,  0, -1 },
-	{  11, 10,  0, 11,  0,  3, 10,  5,  0,  8,  0,  7,  5,  7,  0, -1 },
-	{  11, 10,  5,  7, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  0,  1,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  8,  3,  1,  9,  8,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  6,  5,  2,  6,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  6,  5,  1,  2,  6,  3,  0,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  6,  5,  9,  0,  6,  0,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   5,  9,  8,  5,  8,  2,  5,  2,  6,  3,  2,  8, -1, -1, -1, -1 },
-	{   2,  3, 11, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  0,  8, 11,  2,  0, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  1,  9,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   5, 10,  6,  1,  9,  2,  9, 11,  2,  9,  8, 11, -1, -1, -1, -1 },
-	{   6,  3, 11,  6,  5,  3,  5,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8, 11,  0, 11,  5,  0,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
-	{   3, 11,  6,  0,  3,  6,  0,  6,  5,  0,  5,  9, -1, -1, -1, -1 },
-	{   6,  5,  9,  6,  9, 11, 11,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   5, 10,  6,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  3,  0,  4,  7,  3,  6,  5, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  9,  0,  5, 10,  6,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  6,  5,  1,  9,  7,  1,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
-	{   6,  1,  2,  6,  5,  1,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2,  5,  5,  2,  6,  3,  0,  4,  3,  4,  7, -1, -1, -1, -1 },
-	{   8,  4,  7,  9,  0,  5,  0,  6,  5,  0,  2,  6, -1, -1, -1, -1 },
-	{   7,  3,  9,  7,  9,  4,  3,  2,  9,  5,  9,  6,  2,  6,  9, -1 },
-	{   3, 11,  2,  7,  8,  4, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   5, 10,  6,  4,  7,  2,  4,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
-	{   0,  1,  9,  4,  7,  8,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1 },
-	{   9,  2,  1,  9, 11,  2,  9,  4, 11,  7, 11,  4,  5, 10,  6, -1 },
-	{   8,  4,  7,  3, 11,  5,  3,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
-	{   5,  1, 11,  5, 11,  6,  1,  0, 11,  7, 11,  4,  0,  4, 11, -1 },
-	{   0,  5,  9,  0,  6,  5,  0,  3,  6, 11,  6,  3,  8,  4,  7, -1 },
-	{   6,  5,  9,  6,  9, 11,  4,  7,  9,  7, 11,  9, -1, -1, -1, -1 },
-	{  10,  4,  9,  6,  4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4, 10,  6,  4,  9, 10,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  0,  1, 10,  6,  0,  6,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  3,  1,  8,  1,  6,  8,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
-	{   1,  4,  9,  1,  2,  4,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  0,  8,  1,  2,  9,  2,  4,  9,  2,  6,  4, -1, -1, -1, -1 },
-	{   0,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  3,  2,  8,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  4,  9, 10,  6,  4, 11,  2,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  2,  2,  8, 11,  4,  9, 10,  4, 10,  6, -1, -1, -1, -1 },
-	{   3, 11,  2,  0,  1,  6,  0,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
-	{   6,  4,  1,  6,  1, 10,  4,  8,  1,  2,  1, 11,  8, 11,  1, -1 },
-	{   9,  6,  4,  9,  3,  6,  9,  1,  3, 11,  6,  3, -1, -1, -1, -1 },
-	{   8, 11,  1,  8,  1,  0, 11,  6,  1,  9,  1,  4,  6,  4,  1, -1 },
-	{   3, 11,  6,  3,  6,  0,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   6,  4,  8, 11,  6,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   7, 10,  6,  7,  8, 10,  8,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  7,  3,  0, 10,  7,  0,  9, 10,  6,  7, 10, -1, -1, -1, -1 },
-	{  10,  6,  7,  1, 10,  7,  1,  7,  8,  1,  8,  0, -1, -1, -1, -1 },
-	{  10,  6,  7, 10,  7,  1,  1,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2,  6,  1,  6,  8,  1,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
-	{   2,  6,  9,  2,  9,  1,  6,  7,  9,  0,  9,  3,  7,  3,  9, -1 },
-	{   7,  8,  0,  7,  0,  6,  6,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{   7,  3,  2,  6,  7,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  3, 11, 10,  6,  8, 10,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
-	{   2,  0,  7,  2,  7, 11,  0,  9,  7,  6,  7, 10,  9, 10,  7, -1 },
-	{   1,  8,  0,  1,  7,  8,  1, 10,  7,  6,  7, 10,  2,  3, 11, -1 },
-	{  11,  2,  1, 11,  1,  7, 10,  6,  1,  6,  7,  1, -1, -1, -1, -1 },
-	{   8,  9,  6,  8,  6,  7,  9,  1,  6, 11,  6,  3,  1,  3,  6, -1 },
-	{   0,  9,  1, 11,  6,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   7,  8,  0,  7,  0,  6,  3, 11,  0, 11,  6,  0, -1, -1, -1, -1 },
-	{   7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  0,  8, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  1,  9, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  1,  9,  8,  3,  1, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  1,  2,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10,  3,  0,  8,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  9,  0,  2, 10,  9,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   6, 11,  7,  2, 10,  3, 10,  8,  3, 10,  9,  8, -1, -1, -1, -1 },
-	{   7,  2,  3,  6,  2,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   7,  0,  8,  7,  6,  0,  6,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  7,  6,  2,  3,  7,  0,  1,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  6,  2,  1,  8,  6,  1,  9,  8,  8,  7,  6, -1, -1, -1, -1 },
-	{  10,  7,  6, 10,  1,  7,  1,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  7,  6,  1,  7, 10,  1,  8,  7,  1,  0,  8, -1, -1, -1, -1 },
-	{   0,  3,  7,  0,  7, 10,  0, 10,  9,  6, 10,  7, -1, -1, -1, -1 },
-	{   7,  6, 10,  7, 10,  8,  8, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   6,  8,  4, 11,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  6, 11,  3,  0,  6,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  6, 11,  8,  4,  6,  9,  0,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  4,  6,  9,  6,  3,  9,  3,  1, 11,  3,  6, -1, -1, -1, -1 },
-	{   6,  8,  4,  6, 11,  8,  2, 10,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10,  3,  0, 11,  0,  6, 11,  0,  4,  6, -1, -1, -1, -1 },
-	{   4, 11,  8,  4,  6, 11,  0,  2,  9,  2, 10,  9, -1, -1, -1, -1 },
-	{  10,  9,  3, 10,  3,  2,  9,  4,  3, 11,  3,  6,  4,  6,  3, -1 },
-	{   8,  2,  3,  8,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  9,  0,  2,  3,  4,  2,  4,  6,  4,  3,  8, -1, -1, -1, -1 },
-	{   1,  9,  4,  1,  4,  2,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  1,  3,  8,  6,  1,  8,  4,  6,  6, 10,  1, -1, -1, -1, -1 },
-	{  10,  1,  0, 10,  0,  6,  6,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  6,  3,  4,  3,  8,  6, 10,  3,  0,  3,  9, 10,  9,  3, -1 },
-	{  10,  9,  4,  6, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  9,  5,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3,  4,  9,  5, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
-	{   5,  0,  1,  5,  4,  0,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  7,  6,  8,  3,  4,  3,  5,  4,  3,  1,  5, -1, -1, -1, -1 },
-	{   9,  5,  4, 10,  1,  2,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   6, 11,  7,  1,  2, 10,  0,  8,  3,  4,  9,  5, -1, -1, -1, -1 },
-	{   7,  6, 11,  5,  4, 10,  4,  2, 10,  4,  0,  2, -1, -1, -1, -1 },
-	{   3,  4,  8,  3,  5,  4,  3,  2,  5, 10,  5,  2, 11,  7,  6, -1 },
-	{   7,  2,  3,  7,  6,  2,  5,  4,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  5,  4,  0,  8,  6,  0,  6,  2,  6,  8,  7, -1, -1, -1, -1 },
-	{   3,  6,  2,  3,  7,  6,  1,  5,  0,  5,  4,  0, -1, -1, -1, -1 },
-	{   6,  2,  8,  6,  8,  7,  2,  1,  8,  4,  8,  5,  1,  5,  8, -1 },
-	{   9,  5,  4, 10,  1,  6,  1,  7,  6,  1,  3,  7, -1, -1, -1, -1 },
-	{   1,  6, 10,  1,  7,  6,  1,  0,  7,  8,  7,  0,  9,  5,  4, -1 },
-	{   4,  0, 10,  4, 10,  5,  0,  3, 10,  6, 10,  7,  3,  7, 10, -1 },
-	{   7,  6, 10,  7, 10,  8,  5,  4, 10,  4,  8, 10, -1, -1, -1, -1 },
-	{   6,  9,  5,  6, 11,  9, 11,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  6, 11,  0,  6,  3,  0,  5,  6,  0,  9,  5, -1, -1, -1, -1 },
-	{   0, 11,  8,  0,  5, 11,  0,  1,  5,  5,  6, 11, -1, -1, -1, -1 },
-	{   6, 11,  3,  6,  3,  5,  5,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 10,  9,  5, 11,  9, 11,  8, 11,  5,  6, -1, -1, -1, -1 },
-	{   0, 11,  3,  0,  6, 11,  0,  9,  6,  5,  6,  9,  1,  2, 10, -1 },
-	{  11,  8,  5, 11,  5,  6,  8,  0,  5, 10,  5,  2,  0,  2,  5, -1 },
-	{   6, 11,  3,  6,  3,  5,  2, 10,  3, 10,  5,  3, -1, -1, -1, -1 },
-	{   5,  8,  9,  5,  2,  8,  5,  6,  2,  3,  8,  2, -1, -1, -1, -1 },
-	{   9,  5,  6,  9,  6,  0,  0,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  5,  8,  1,  8,  0,  5,  6,  8,  3,  8,  2,  6,  2,  8, -1 },
-	{   1,  5,  6,  2,  1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  3,  6,  1,  6, 10,  3,  8,  6,  5,  6,  9,  8,  9,  6, -1 },
-	{  10,  1,  0, 10,  0,  6,  9,  5,  0,  5,  6,  0, -1, -1, -1, -1 },
-	{   0,  3,  8,  5,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  5,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  5, 10,  7,  5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  5, 10, 11,  7,  5,  8,  3,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{   5, 11,  7,  5, 10, 11,  1,  9,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{  10,  7,  5, 10, 11,  7,  9,  8,  1,  8,  3,  1, -1, -1, -1, -1 },
-	{  11,  1,  2, 11,  7,  1,  7,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3,  1,  2,  7,  1,  7,  5,  7,  2, 11, -1, -1, -1, -1 },
-	{   9,  7,  5,  9,  2,  7,  9,  0,  2,  2, 11,  7, -1, -1, -1, -1 },
-	{   7,  5,  2,  7,  2, 11,  5,  9,  2,  3,  2,  8,  9,  8,  2, -1 },
-	{   2,  5, 10,  2,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  2,  0,  8,  5,  2,  8,  7,  5, 10,  2,  5, -1, -1, -1, -1 },
-	{   9,  0,  1,  5, 10,  3,  5,  3,  7,  3, 10,  2, -1, -1, -1, -1 },
-	{   9,  8,  2,  9,  2,  1,  8,  7,  2, 10,  2,  5,  7,  5,  2, -1 },
-	{   1,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  7,  0,  7,  1,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  0,  3,  9,  3,  5,  5,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
-	{   9,  8,  7,  5,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   5,  8,  4,  5, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   5,  0,  4,  5, 11,  0,  5, 10, 11, 11,  3,  0, -1, -1, -1, -1 },
-	{   0,  1,  9,  8,  4, 10,  8, 10, 11, 10,  4,  5, -1, -1, -1, -1 },
-	{  10, 11,  4, 10,  4,  5, 11,  3,  4,  9,  4,  1,  3,  1,  4, -1 },
-	{   2,  5,  1,  2,  8,  5,  2, 11,  8,  4,  5,  8, -1, -1, -1, -1 },
-	{   0,  4, 11,  0, 11,  3,  4,  5, 11,  2, 11,  1,  5,  1, 11, -1 },
-	{   0,  2,  5,  0,  5,  9,  2, 11,  5,  4,  5,  8, 11,  8,  5, -1 },
-	{   9,  4,  5,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  5, 10,  3,  5,  2,  3,  4,  5,  3,  8,  4, -1, -1, -1, -1 },
-	{   5, 10,  2,  5,  2,  4,  4,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{   3, 10,  2,  3,  5, 10,  3,  8,  5,  4,  5,  8,  0,  1,  9, -1 },
-	{   5, 10,  2,  5,  2,  4,  1,  9,  2,  9,  4,  2, -1, -1, -1, -1 },
-	{   8,  4,  5,  8,  5,  3,  3,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  4,  5,  1,  0,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   8,  4,  5,  8,  5,  3,  9,  0,  5,  0,  3,  5, -1, -1, -1, -1 },
-	{   9,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4, 11,  7,  4,  9, 11,  9, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  8,  3,  4,  9,  7,  9, 11,  7,  9, 10, 11, -1, -1, -1, -1 },
-	{   1, 10, 11,  1, 11,  4,  1,  4,  0,  7,  4, 11, -1, -1, -1, -1 },
-	{   3,  1,  4,  3,  4,  8,  1, 10,  4,  7,  4, 11, 10, 11,  4, -1 },
-	{   4, 11,  7,  9, 11,  4,  9,  2, 11,  9,  1,  2, -1, -1, -1, -1 },
-	{   9,  7,  4,  9, 11,  7,  9,  1, 11,  2, 11,  1,  0,  8,  3, -1 },
-	{  11,  7,  4, 11,  4,  2,  2,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
-	{  11,  7,  4, 11,  4,  2,  8,  3,  4,  3,  2,  4, -1, -1, -1, -1 },
-	{   2,  9, 10,  2,  7,  9,  2,  3,  7,  7,  4,  9, -1, -1, -1, -1 },
-	{   9, 10,  7,  9,  7,  4, 10,  2,  7,  8,  7,  0,  2,  0,  7, -1 },
-	{   3,  7, 10,  3, 10,  2,  7,  4, 10,  1, 10,  0,  4,  0, 10, -1 },
-	{   1, 10,  2,  8,  7,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  9,  1,  4,  1,  7,  7,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  9,  1,  4,  1,  7,  0,  8,  1,  8,  7,  1, -1, -1, -1, -1 },
-	{   4,  0,  3,  7,  4,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   9, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  0,  9,  3,  9, 11, 11,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  1, 10,  0, 10,  8,  8, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  1, 10, 11,  3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  2, 11,  1, 11,  9,  9, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  0,  9,  3,  9, 11,  1,  2,  9,  2, 11,  9, -1, -1, -1, -1 },
-	{   0,  2, 11,  8,  0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   3,  2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  3,  8,  2,  8, 10, 10,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
-	{   9, 10,  2,  0,  9,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   2,  3,  8,  2,  8, 10,  0,  1,  8,  1, 10,  8, -1, -1, -1, -1 },
-	{   1, 10,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   1,  3,  8,  9,  1,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  9,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{   0,  3,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-	{  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
-};
+	s_settings.m_numThreads = (s_settings.m_numThreads+1) % BX_COUNTOF(s_numThreads);
+}
 
-static const float s_cube[8][3] =
+static void cmdBenchmark(const void* /*_userData*/)
 {
-	{ 0.0f, 1.0f, 1.0f }, // 0
-	{ 1.0f, 1.0f, 1.0f }, // 1
-	{ 1.0f, 1.0f, 0.0f }, // 2
-	{ 0.0f, 1.0f, 0.0f }, // 3
-	{ 0.0f, 0.0f, 1.0f }, // 4
-	{ 1.0f, 0.0f, 1.0f }, // 5
-	{ 1.0f, 0.0f, 0.0f }, // 6
-	{ 0.0f, 0.0f, 0.0f }, // 7
-};
+	s_settings.m_benchmark = true;
+}
 
-float vertLerp(float* __restrict _result, float _iso, uint32_t _idx0, float _v0, uint32_t _idx1, float _v1)
+static const InputBinding s_bindings[] =
 {
-	const float* __restrict edge0 = s_cube[_idx0];
-	const float* __restrict edge1 = s_cube[_idx1];
-
-	if (fabsf(_iso-_v1) < 0.00001f)
-	{
-		_result[0] = edge1[0];
-		_result[1] = edge1[1];
-		_result[2] = edge1[2];
-		return 1.0f;
-	}
-
-	if (fabsf(_iso-_v0) < 0.00001f
-	||  fabsf(_v0-_v1) < 0.00001f)
-	{
-		_result[0] = edge0[0];
-		_result[1] = edge0[1];
-		_result[2] = edge0[2];
-		return 0.0f;
-	}
+	{ entry::Key::Key1, entry::Modifier::None, 1, cmdSetDims,      (const void*)0 },
+	{ entry::Key::Key2, entry::Modifier::None, 1, cmdSetDims,      (const void*)1 },
+	{ entry::Key::Key3, entry::Modifier::None, 1, cmdSetDims,      (const void*)2 },
+	{ entry::Key::Key4, entry::Modifier::None, 1, cmdSetDims,      (const void*)3 },
+	{ entry::Key::KeyT, entry::Modifier::None, 1, cmdCycleThreads, NULL           },
+	{ entry::Key::KeyB, entry::Modifier::None, 1, cmdBenchmark,    NULL           },
+
+	INPUT_BINDING_END
+};
 
-	float lerp = (_iso - _v0) / (_v1 - _v0);
-	_result[0] = edge0[0] + lerp * (edge1[0] - edge0[0]);
-	_result[1] = edge0[1] + lerp * (edge1[1] - edge0[1]);
-	_result[2] = edge0[2] + lerp * (edge1[2] - edge0[2]);
+// Grid covers same world space extent at every resolution.
+#define GRID_EXTENT 32.0f
 
-	return lerp;
+static void setGrid(Polygonizer& _polygonizer, uint32_t _dims)
+{
+	const float min[3] = { -GRID_EXTENT*0.5f, -GRID_EXTENT*0.5f, -GRID_EXTENT*0.5f };
+	_polygonizer.setGrid(_dims, min, GRID_EXTENT/float(_dims-1) );
 }
 
-uint32_t triangulate(uint8_t* _result, uint32_t _stride, const float* __restrict _rgb, const float* __restrict _xyz, const Grid* _val[8], float _iso)
+struct BenchmarkResult
 {
-	uint8_t cubeindex = 0;
-	cubeindex |= (_val[0]->m_val < _iso) ? 0x01 : 0;
-	cubeindex |= (_val[1]->m_val < _iso) ? 0x02 : 0;
-	cubeindex |= (_val[2]->m_val < _iso) ? 0x04 : 0;
-	cubeindex |= (_val[3]->m_val < _iso) ? 0x08 : 0;
-	cubeindex |= (_val[4]->m_val < _iso) ? 0x10 : 0;
-	cubeindex |= (_val[5]->m_val < _iso) ? 0x20 : 0;
-	cubeindex |= (_val[6]->m_val < _iso) ? 0x40 : 0;
-	cubeindex |= (_val[7]->m_val < _iso) ? 0x80 : 0;
-
-	if (0 == s_edges[cubeindex])
-	{
-		return 0;
-	}
+	double m_cellsPerSec[2];
+};
 
-	float verts[12][6];
-	uint16_t flags = s_edges[cubeindex];
+// Best of few runs for every grid size, on single thread and on all threads.
+static void benchmark(BenchmarkResult* _result, Polygonizer& _polygonizer, const float (*_spheres)[4], uint32_t _numSpheres)
+{
+	const double freq = double(bx::getHPFrequency() );
+	const uint32_t numThreads[2] = { 1, s_numThreads[BX_COUNTOF(s_numThreads)-1] };
 
-	for (uint32_t ii = 0; ii < 12; ++ii)
+	for (uint32_t ii = 0; ii < BX_COUNTOF(s_dims); ++ii)
 	{
-		if (flags & (1<<ii) )
+		setGrid(_polygonizer, s_dims[ii]);
+
+		for (uint32_t jj = 0; jj < 2; ++jj)
 		{
-			uint32_t idx0 = ii&7;
-			uint32_t idx1 = "\x1\x2\x3\x0\x5\x6\x7\x4\x4\x5\x6\x7"[ii];
-			float* vertex = verts[ii];
-			float lerp = vertLerp(vertex, _iso, idx0, _val[idx0]->m_val, idx1, _val[idx1]->m_val);
-
-			const float* na = _val[idx0]->m_normal;
-			const float* nb = _val[idx1]->m_normal;
-			vertex[3] = na[0] + lerp * (nb[0] - na[0]);
-			vertex[4] = na[1] + lerp * (nb[1] - na[1]);
-			vertex[5] = na[2] + lerp * (nb[2] - na[2]);
-		}
-	}
+			_polygonizer.setNumThreads(numThreads[jj]);
 
-	float dr = _rgb[3] - _rgb[0];
-	float dg = _rgb[4] - _rgb[1];
-	float db = _rgb[5] - _rgb[2];
+			int64_t best = INT64_MAX;
+			for (uint32_t run = 0; run < 4; ++run)
+			{
+				_polygonizer.polygonize(_spheres, _numSpheres, 0.5f);
+				const int64_t time = _polygonizer.getStats().m_time;
+				best = time < best ? time : best;
+			}
 
-	uint32_t num = 0;
-	const int8_t* indices = s_indices[cubeindex];
-	for (uint32_t ii = 0; indices[ii] != -1; ++ii)
-	{
-		const float* vertex = verts[indices[ii] ];
-
-		float* xyz = (float*)_result;
-		xyz[0] = _xyz[0] + vertex[0];
-		xyz[1] = _xyz[1] + vertex[1];
-		xyz[2] = _xyz[2] + vertex[2];
-
-		xyz[3] = vertex[3];
-		xyz[4] = vertex[4];
-		xyz[5] = vertex[5];
-
-		uint32_t rr = uint8_t( (_rgb[0] + vertex[0]*dr)*255.0f);
-		uint32_t gg = uint8_t( (_rgb[1] + vertex[1]*dg)*255.0f);
-		uint32_t bb = uint8_t( (_rgb[2] + vertex[2]*db)*255.0f);
-
-		uint32_t* abgr = (uint32_t*)&_result[24];
-		*abgr = 0xff000000
-			  | (bb<<16)
-			  | (gg<<8)
-			  | rr
-			  ;
-
-		_result += _stride;
-		++num;
+			_result[ii].m_cellsPerSec[jj] = double(_polygonizer.getStats().m_numCells)*freq/double(best > 0 ? best : 1);
+		}
 	}
-
-	return num;
 }
 
 int _main_(int /*_argc*/, char** /*_argv*/)
@@ -517,12 +164,13 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	bgfx::destroyVertexShader(vsh);
 	bgfx::destroyFragmentShader(fsh);
 
-#define DIMS 32
+	inputAddBindings("metaballs", s_bindings);
+
+	Polygonizer polygonizer;
+	uint32_t dims = UINT32_MAX;
 
-	Grid* grid = new Grid[DIMS*DIMS*DIMS];
-	const uint32_t ypitch = DIMS;
-	const uint32_t zpitch = DIMS*DIMS;
-	const float invdim = 1.0f/float(DIMS-1);
+	BenchmarkResult benchmarkResult[BX_COUNTOF(s_dims)];
+	bool benchmarkValid = false;
 
 	int64_t timeOffset = bx::getHPCounter();
 
@@ -559,168 +207,104 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		// Set view and projection matrix for view 0.
 		bgfx::setViewTransform(0, view, proj);
 
-		// Stats.
-		uint32_t numVertices = 0;
-		int64_t profUpdate = 0;
-		int64_t profNormal = 0;
-		int64_t profTriangulate = 0;
-
-		// Allocate 32K vertices in transient vertex buffer.
-		uint32_t maxVertices = (32<<10);
-		bgfx::TransientVertexBuffer tvb;
-		bgfx::allocTransientVertexBuffer(&tvb, maxVertices, s_PosNormalColorDecl);
-
 		const uint32_t numSpheres = 16;
 		float sphere[numSpheres][4];
 		for (uint32_t ii = 0; ii < numSpheres; ++ii)
 		{
-			sphere[ii][0] = sin(time*(ii*0.21f)+ii*0.37f) * (DIMS * 0.5f - 8.0f);
-			sphere[ii][1] = sin(time*(ii*0.37f)+ii*0.67f) * (DIMS * 0.5f - 8.0f);
-			sphere[ii][2] = cos(time*(ii*0.11f)+ii*0.13f) * (DIMS * 0.5f - 8.0f);
+			sphere[ii][0] = sin(time*(ii*0.21f)+ii*0.37f) * (GRID_EXTENT * 0.5f - 8.0f);
+			sphere[ii][1] = sin(time*(ii*0.37f)+ii*0.67f) * (GRID_EXTENT * 0.5f - 8.0f);
+			sphere[ii][2] = cos(time*(ii*0.11f)+ii*0.13f) * (GRID_EXTENT * 0.5f - 8.0f);
 			sphere[ii][3] = 1.0f/(2.0f + (sin(time*(ii*0.13f) )*0.5f+0.5f)*2.0f);
 		}
 
-		profUpdate = bx::getHPCounter();
-		
-		for (uint32_t zz = 0; zz < DIMS; ++zz)
+		if (s_settings.m_benchmark)
 		{
-			for (uint32_t yy = 0; yy < DIMS; ++yy)
-			{
-				uint32_t offset = (zz*DIMS+yy)*DIMS;
-
-				for (uint32_t xx = 0; xx < DIMS; ++xx)
-				{
-					uint32_t xoffset = offset + xx;
-
-					float dist = 0.0f;
-					float prod = 1.0f;
-					for (uint32_t ii = 0; ii < numSpheres; ++ii)
-					{
-						const float* pos = sphere[ii];
-						float dx = pos[0] - (-DIMS*0.5f + float(xx) );
-						float dy = pos[1] - (-DIMS*0.5f + float(yy) );
-						float dz = pos[2] - (-DIMS*0.5f + float(zz) );
-						float invr = pos[3];
-						float dot = dx*dx + dy*dy + dz*dz;
-						dot *= invr*invr;
-
-						dist *= dot;
-						dist += prod;
-						prod *= dot;
-					}
-
-					grid[xoffset].m_val = dist / prod - 1.0f;
-				}
-			}
+			benchmark(benchmarkResult, polygonizer, sphere, numSpheres);
+			benchmarkValid = true;
+			s_settings.m_benchmark = false;
+			dims = UINT32_MAX;
 		}
 
-		profUpdate = bx::getHPCounter() - profUpdate;
-
-		profNormal = bx::getHPCounter();
-
-		for (uint32_t zz = 1; zz < DIMS-1; ++zz)
+		if (dims != s_dims[s_settings.m_dims])
 		{
-			for (uint32_t yy = 1; yy < DIMS-1; ++yy)
-			{
-				uint32_t offset = (zz*DIMS+yy)*DIMS;
-
-				for (uint32_t xx = 1; xx < DIMS-1; ++xx)
-				{
-					uint32_t xoffset = offset + xx;
-
-					float normal[3] =
-					{
-						grid[xoffset-1     ].m_val - grid[xoffset+1     ].m_val,
-						grid[xoffset-ypitch].m_val - grid[xoffset+ypitch].m_val,
-						grid[xoffset-zpitch].m_val - grid[xoffset+zpitch].m_val,
-					};
-
-					vec3Norm(grid[xoffset].m_normal, normal);
-				}
-			}
+			dims = s_dims[s_settings.m_dims];
+			setGrid(polygonizer, dims);
 		}
 
-		profNormal = bx::getHPCounter() - profNormal;
+		const uint32_t numThreads = s_numThreads[s_settings.m_numThreads];
+		polygonizer.setNumThreads(numThreads);
 
-		profTriangulate = bx::getHPCounter();
+		uint32_t numVertices = polygonizer.polygonize(sphere, numSpheres, 0.5f);
+		const PolygonizerStats& stats = polygonizer.getStats();
 
-		PosNormalColorVertex* vertex = (PosNormalColorVertex*)tvb.data;
+		// Allocate only as much as was generated, up to 192K vertices in
+		// transient vertex buffer.
+		const uint32_t maxVertices = (192<<10);
+		numVertices = bx::uint32_min(numVertices, maxVertices);
+		numVertices -= numVertices%3;
 
-		for (uint32_t zz = 0; zz < DIMS-1 && numVertices+12 < maxVertices; ++zz)
+		if (0 < numVertices
+		&&  bgfx::checkAvailTransientVertexBuffer(numVertices, s_PosNormalColorDecl) )
 		{
-			float rgb[6];
-			rgb[2] = zz*invdim;
-			rgb[5] = (zz+1)*invdim;
+			bgfx::TransientVertexBuffer tvb;
+			bgfx::allocTransientVertexBuffer(&tvb, numVertices, s_PosNormalColorDecl);
+			numVertices = polygonizer.copy( (PolygonizerVertex*)tvb.data, numVertices);
 
-			for (uint32_t yy = 0; yy < DIMS-1 && numVertices+12 < maxVertices; ++yy)
-			{
-				uint32_t offset = (zz*DIMS+yy)*DIMS;
-
-				rgb[1] = yy*invdim;
-				rgb[4] = (yy+1)*invdim;
-
-				for (uint32_t xx = 0; xx < DIMS-1 && numVertices+12 < maxVertices; ++xx)
-				{
-					uint32_t xoffset = offset + xx;
-
-					rgb[0] = xx*invdim;
-					rgb[3] = (xx+1)*invdim;
-
-					float pos[3] =
-					{
-						-DIMS*0.5f + float(xx),
-						-DIMS*0.5f + float(yy),
-						-DIMS*0.5f + float(zz)
-					};
-
-					const Grid* val[8] = { 
-						&grid[xoffset+zpitch+ypitch  ],
-						&grid[xoffset+zpitch+ypitch+1],
-						&grid[xoffset+ypitch+1       ],
-						&grid[xoffset+ypitch         ],
-						&grid[xoffset+zpitch         ],
-						&grid[xoffset+zpitch+1       ],
-						&grid[xoffset+1              ],
-						&grid[xoffset                ],
-					};
-
-					uint32_t num = triangulate( (uint8_t*)vertex, s_PosNormalColorDecl.m_stride, rgb, pos, val, 0.5f);
-					vertex += num;
-					numVertices += num;
-				}
-			}
-		}
-
-		profTriangulate = bx::getHPCounter() - profTriangulate;
-
-		float mtx[16];
-		mtxRotateXY(mtx, time*0.67f, time);
+			float mtx[16];
+			mtxRotateXY(mtx, time*0.67f, time);
 
-		// Set model matrix for rendering.
-		bgfx::setTransform(mtx);
+			// Set model matrix for rendering.
+			bgfx::setTransform(mtx);
 
-		// Set vertex and fragment shaders.
-		bgfx::setProgram(program);
+			// Set vertex and fragment shaders.
+			bgfx::setProgram(program);
 
-		// Set vertex and index buffer.
-		bgfx::setVertexBuffer(&tvb, numVertices);
+			// Set vertex and index buffer.
+			bgfx::setVertexBuffer(&tvb, numVertices);
 
-		// Submit primitive for rendering to view 0.
-		bgfx::submit(0);
+			// Submit primitive for rendering to view 0.
+			bgfx::submit(0);
+		}
 
 		// Display stats.
-		bgfx::dbgTextPrintf(1, 4, 0x0f, "Num vertices: %5d (%6.4f%%)", numVertices, float(numVertices)/maxVertices * 100);
-		bgfx::dbgTextPrintf(1, 5, 0x0f, "      Update: % 7.3f[ms]", double(profUpdate)*toMs);
-		bgfx::dbgTextPrintf(1, 6, 0x0f, "Calc normals: % 7.3f[ms]", double(profNormal)*toMs);
-		bgfx::dbgTextPrintf(1, 7, 0x0f, " Triangulate: % 7.3f[ms]", double(profTriangulate)*toMs);
-		bgfx::dbgTextPrintf(1, 8, 0x0f, "       Frame: % 7.3f[ms]", double(frameTime)*toMs);
+		const double polygonizeTime = double(stats.m_time)*toMs;
+		bgfx::dbgTextPrintf(1, 4, 0x0f, "        Grid: %3d^3, keys 1-4 (%d cells)", dims, stats.m_numCells);
+		bgfx::dbgTextPrintf(1, 5, 0x0f, "     Threads: %d, key T", numThreads);
+		bgfx::dbgTextPrintf(1, 6, 0x0f, "Num vertices: %6d (%6.4f%%)", stats.m_numVertices, float(numVertices)/maxVertices * 100);
+		if (0 < stats.m_numVerticesDropped)
+		{
+			bgfx::dbgTextPrintf(42, 6, 0x4f, "Dropped: %6d vertices", stats.m_numVerticesDropped);
+		}
+		bgfx::dbgTextPrintf(1, 7, 0x0f, "     Skipped: %5d / %5d blocks", stats.m_numBlocksSkipped, stats.m_numBlocks);
+		bgfx::dbgTextPrintf(1, 8, 0x0f, "  Polygonize: % 7.3f[ms] (%7.2f Mcells/s)"
+			, polygonizeTime
+			, double(stats.m_numCells)/(polygonizeTime > 0.0 ? polygonizeTime : 1.0)/1000.0
+			);
+		bgfx::dbgTextPrintf(1, 9, 0x0f, "       Frame: % 7.3f[ms]", double(frameTime)*toMs);
+
+		if (benchmarkValid)
+		{
+			bgfx::dbgTextPrintf(1, 11, 0x0f, "Benchmark, key B (Mcells/s)   1 thread  %d threads", s_numThreads[BX_COUNTOF(s_numThreads)-1]);
+			for (uint32_t ii = 0; ii < BX_COUNTOF(s_dims); ++ii)
+			{
+				bgfx::dbgTextPrintf(1, 12+ii, 0x0f, "  %3d^3                       %8.2f  %9.2f"
+					, s_dims[ii]
+					, benchmarkResult[ii].m_cellsPerSec[0]*1e-6
+					, benchmarkResult[ii].m_cellsPerSec[1]*1e-6
+					);
+			}
+		}
+		else
+		{
+			bgfx::dbgTextPrintf(1, 11, 0x0f, "Benchmark, key B");
+		}
 
 		// Advance to next frame. Rendering thread will be kicked to 
 		// process submitted rendering primitives.
 		bgfx::frame();
 	}
 
-	delete [] grid;
+	inputRemoveBindings("metaballs");
 
 	// Cleanup.
 	bgfx::destroyProgram(program);
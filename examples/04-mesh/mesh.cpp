@@ -11,8 +11,10 @@
 #include <bgfx.h>
 #include <bx/timer.h>
 #include <bx/readerwriter.h>
+#include <bx/thread.h>
 #include "entry/entry.h"
 #include "fpumath.h"
+#include "meshloader.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -126,11 +128,13 @@ struct Group
 	void reset()
 	{
 		m_vbh.idx = bgfx::invalidHandle;
+		m_vbhStream.idx = bgfx::invalidHandle;
 		m_ibh.idx = bgfx::invalidHandle;
 		m_prims.clear();
 	}
 
 	bgfx::VertexBufferHandle m_vbh;
+	bgfx::VertexBufferHandle m_vbhStream; // Attributes other than position, vertex stream 1.
 	bgfx::IndexBufferHandle m_ibh;
 	Sphere m_sphere;
 	Aabb m_aabb;
@@ -142,46 +146,37 @@ struct Mesh
 {
 	void load(const char* _filePath)
 	{
-#define BGFX_CHUNK_MAGIC_VB BX_MAKEFOURCC('V', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_IB BX_MAKEFOURCC('I', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
-
 		bx::CrtFileReader reader;
 		reader.open(_filePath);
 
 		Group group;
 
 		uint32_t chunk;
-		while (4 == bx::read(&reader, chunk) )
+		bool ok = true;
+		while (ok && 4 == bx::read(&reader, chunk) )
 		{
 			switch (chunk)
 			{
 			case BGFX_CHUNK_MAGIC_VB:
-				{
-					bx::read(&reader, group.m_sphere);
-					bx::read(&reader, group.m_aabb);
-					bx::read(&reader, group.m_obb);
-
-					bx::read(&reader, m_decl);
-					uint16_t stride = m_decl.getStride();
-
-					uint16_t numVertices;
-					bx::read(&reader, numVertices);
-					const bgfx::Memory* mem = bgfx::alloc(numVertices*stride);
-					bx::read(&reader, mem->data, mem->size);
+			case BGFX_CHUNK_MAGIC_VB32:
+			case BGFX_CHUNK_MAGIC_VBC:
+				bx::read(&reader, group.m_sphere);
+				bx::read(&reader, group.m_aabb);
+				bx::read(&reader, group.m_obb);
+				group.m_vbh = meshLoadVertexBuffer(&reader, chunk, m_decl);
+				ok = bgfx::isValid(group.m_vbh);
+				break;
 
-					group.m_vbh = bgfx::createVertexBuffer(mem, m_decl);
-				}
+			case BGFX_CHUNK_MAGIC_VBS:
+				ok = meshLoadVertexStream(&reader, group.m_vbhStream);
 				break;
 
 			case BGFX_CHUNK_MAGIC_IB:
-				{
-					uint32_t numIndices;
-					bx::read(&reader, numIndices);
-					const bgfx::Memory* mem = bgfx::alloc(numIndices*2);
-					bx::read(&reader, mem->data, mem->size);
-					group.m_ibh = bgfx::createIndexBuffer(mem);
-				}
+			case BGFX_CHUNK_MAGIC_IB32:
+			case BGFX_CHUNK_MAGIC_IBC:
+			case BGFX_CHUNK_MAGIC_IBC32:
+				group.m_ibh = meshLoadIndexBuffer(&reader, chunk);
+				ok = bgfx::isValid(group.m_ibh);
 				break;
 
 			case BGFX_CHUNK_MAGIC_PRI:
@@ -227,6 +222,27 @@ struct Mesh
 			}
 		}
 
+		if (!ok)
+		{
+			DBG("Failed to load %s, chunk %08x is corrupt.", _filePath, chunk);
+
+			// Buffers of incomplete group are not owned by any group yet.
+			if (bgfx::isValid(group.m_vbh) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbh);
+			}
+
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+
+			if (bgfx::isValid(group.m_ibh) )
+			{
+				bgfx::destroyIndexBuffer(group.m_ibh);
+			}
+		}
+
 		reader.close();
 	}
 
@@ -237,6 +253,11 @@ struct Mesh
 			const Group& group = *it;
 			bgfx::destroyVertexBuffer(group.m_vbh);
 
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+
 			if (bgfx::isValid(group.m_ibh) )
 			{
 				bgfx::destroyIndexBuffer(group.m_ibh);
@@ -257,6 +278,11 @@ struct Mesh
 			bgfx::setIndexBuffer(group.m_ibh);
 			bgfx::setVertexBuffer(group.m_vbh);
 
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::setVertexStream(1, group.m_vbhStream);
+			}
+
 			// Set render states.
 			bgfx::setState(0
 				|BGFX_STATE_RGB_WRITE
@@ -277,6 +303,23 @@ struct Mesh
 	GroupArray m_groups;
 };
 
+struct MeshLoadTask
+{
+	Mesh* m_mesh;
+	const char* m_filePath;
+
+	// Posted by loader thread once mesh is loaded.
+	bx::Semaphore m_done;
+};
+
+static int32_t meshLoadThread(void* _userData)
+{
+	MeshLoadTask* task = (MeshLoadTask*)_userData;
+	task->m_mesh->load(task->m_filePath);
+	task->m_done.post();
+	return 0;
+}
+
 int _main_(int /*_argc*/, char** /*_argv*/)
 {
 	uint32_t width = 1280;
@@ -327,8 +370,15 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 
 	bgfx::ProgramHandle program = loadProgram("vs_mesh", "fs_mesh");
 
+	// Mesh buffers are created on loader thread, while main thread keeps
+	// rendering.
 	Mesh mesh;
-	mesh.load("meshes/bunny.bin");
+	MeshLoadTask loadTask;
+	loadTask.m_mesh = &mesh;
+	loadTask.m_filePath = "meshes/bunny.bin";
+	bx::Thread loader;
+	loader.init(meshLoadThread, &loadTask);
+	bool meshLoaded = false;
 
 	int64_t timeOffset = bx::getHPCounter();
 
@@ -356,6 +406,11 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		bgfx::dbgTextPrintf(0, 2, 0x6f, "Description: Loading meshes.");
 		bgfx::dbgTextPrintf(0, 3, 0x0f, "Frame: % 7.3f[ms]", double(frameTime)*toMs);
 
+		if (!meshLoaded)
+		{
+			bgfx::dbgTextPrintf(0, 4, 0x0f, "Loading mesh on worker thread...");
+		}
+
 		float at[3] = { 0.0f, 1.0f, 0.0f };
 		float eye[3] = { 0.0f, 1.0f, -2.5f };
 
@@ -373,11 +428,29 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 			, time*0.37f
 			); 
 
-		mesh.submit(program, mtx);
+		if (meshLoaded)
+		{
+			mesh.submit(program, mtx);
+		}
+
+		// Buffers created on loader thread can be used after frame call,
+		// which started after they were created.
+		const bool loaderDone = !meshLoaded && loadTask.m_done.wait(0);
 
 		// Advance to next frame. Rendering thread will be kicked to 
 		// process submitted rendering primitives.
 		bgfx::frame();
+
+		if (loaderDone)
+		{
+			loader.shutdown();
+			meshLoaded = true;
+		}
+	}
+
+	if (!meshLoaded)
+	{
+		loader.shutdown();
 	}
 
 	mesh.unload();
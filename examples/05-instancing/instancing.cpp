@@ -219,30 +219,35 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 			// Set view and projection matrix for view 0.
 			bgfx::setViewTransform(0, view, proj);
 
-			const uint16_t instanceStride = 80;
-			const bgfx::InstanceDataBuffer* idb = bgfx::allocInstanceDataBuffer(121, instanceStride);
-			if (NULL != idb)
+			// Transform (i_data0-i_data3) and color (i_data4) are in separate
+			// instance data streams.
+			const uint16_t transformStride = 64;
+			const uint16_t colorStride = 16;
+			if (bgfx::checkAvailInstanceDataBuffer(121, transformStride+colorStride, 2) )
 			{
-				uint8_t* data = idb->data;
+				const bgfx::InstanceDataBuffer* idb = bgfx::allocInstanceDataBuffer(121, transformStride);
+				const bgfx::InstanceDataBuffer* idbColor = bgfx::allocInstanceDataBuffer(121, colorStride);
+
+				float* mtx = (float*)idb->data;
+				float* color = (float*)idbColor->data;
 
 				// Write instance data for 11x11 cubes.
 				for (uint32_t yy = 0; yy < 11; ++yy)
 				{
 					for (uint32_t xx = 0; xx < 11; ++xx)
 					{
-						float* mtx = (float*)data;
 						mtxRotateXY(mtx, time + xx*0.21f, time + yy*0.37f);
 						mtx[12] = -15.0f + float(xx)*3.0f;
 						mtx[13] = -15.0f + float(yy)*3.0f;
 						mtx[14] = 0.0f;
 
-						float* color = (float*)&data[64];
 						color[0] = sin(time+float(xx)/11.0f)*0.5f+0.5f;
 						color[1] = cos(time+float(yy)/11.0f)*0.5f+0.5f;
 						color[2] = sin(time*3.0f)*0.5f+0.5f;
 						color[3] = 1.0f;
 
-						data += instanceStride;
+						mtx += transformStride/sizeof(float);
+						color += colorStride/sizeof(float);
 					}
 				}
 
@@ -253,8 +258,9 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 				bgfx::setVertexBuffer(vbh);
 				bgfx::setIndexBuffer(ibh);
 
-				// Set instance data buffer.
+				// Set instance data buffers.
 				bgfx::setInstanceDataBuffer(idb);
+				bgfx::setInstanceDataStream(1, idbColor);
 
 				// Set render states.
 				bgfx::setState(BGFX_STATE_DEFAULT);
@@ -11,6 +11,7 @@
 #include "fpumath.h"
 #include "packrect.h"
 
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <list>
@@ -173,6 +174,33 @@ static void updateTextureCubeRectBgra8(bgfx::TextureHandle _handle, uint8_t _sid
 	bgfx::updateTextureCube(_handle, _side, 0, _x, _y, _width, _height, mem);
 }
 
+// Each mip level of streaming texture has different color, to show which
+// mip levels are sampled.
+static const uint8_t s_mipColorBgra8[][4] =
+{
+	{ 0xff, 0xff, 0xff, 0xff },
+	{ 0x00, 0x00, 0xff, 0xff },
+	{ 0x00, 0xff, 0x00, 0xff },
+	{ 0xff, 0x00, 0x00, 0xff },
+	{ 0x00, 0xff, 0xff, 0xff },
+	{ 0xff, 0x00, 0xff, 0xff },
+	{ 0xff, 0xff, 0x00, 0xff },
+	{ 0x80, 0x80, 0x80, 0xff },
+	{ 0x00, 0x00, 0x00, 0xff },
+};
+
+static uint8_t* fillMipBgra8(uint8_t* _dst, uint32_t _size, uint8_t _mip)
+{
+	const uint8_t* color = s_mipColorBgra8[_mip%BX_COUNTOF(s_mipColorBgra8)];
+	for (uint32_t ii = 0, num = _size*_size; ii < num; ++ii)
+	{
+		memcpy(_dst, color, 4);
+		_dst += 4;
+	}
+
+	return _dst;
+}
+
 int _main_(int /*_argc*/, char** /*_argv*/)
 {
 	uint32_t width = 1280;
@@ -270,6 +298,33 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 
 	uint8_t* texture2dData = (uint8_t*)malloc(texture2dSize*texture2dSize*4);
 
+	// Streaming texture is created with mip levels from streamingBaseMip,
+	// finer mip levels are uploaded when streaming manager requests them.
+	const uint16_t streamingSize = 256;
+	const uint8_t streamingNumMips = 9;
+	const uint8_t streamingBaseMip = 4;
+
+	uint32_t streamingStorage = 0;
+	for (uint8_t mip = streamingBaseMip; mip < streamingNumMips; ++mip)
+	{
+		const uint32_t mipSize = streamingSize>>mip;
+		streamingStorage += mipSize*mipSize*4;
+	}
+
+	mem = bgfx::alloc(streamingStorage);
+	uint8_t* streamingData = mem->data;
+	for (uint8_t mip = streamingBaseMip; mip < streamingNumMips; ++mip)
+	{
+		streamingData = fillMipBgra8(streamingData, streamingSize>>mip, mip);
+	}
+
+	bgfx::TextureHandle textureStreaming = bgfx::createTexture2DStreaming(streamingSize, streamingSize, streamingNumMips
+		, bgfx::TextureFormat::BGRA8
+		, BGFX_TEXTURE_NONE
+		, streamingBaseMip
+		, mem
+		);
+
 	uint8_t rr = rand()%255;
 	uint8_t gg = rand()%255;
 	uint8_t bb = rand()%255;
@@ -373,6 +428,25 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 
 		bgfx::dbgTextPrintf(0, 4, 0x0f, "hit: %d, miss %d", hit, miss);
 
+		// Upload mip levels requested by streaming manager in last frame.
+		bgfx::TextureStreamRequest requests[16];
+		for (uint16_t ii = 0, num = bgfx::getTextureStreamingRequests(requests, BX_COUNTOF(requests) ); ii < num; ++ii)
+		{
+			const bgfx::TextureStreamRequest& request = requests[ii];
+			const uint32_t mipSize = streamingSize>>request.mip;
+			const bgfx::Memory* mipMem = bgfx::alloc(mipSize*mipSize*4);
+			fillMipBgra8(mipMem->data, mipSize, request.mip);
+			bgfx::updateTexture2DStreaming(request.handle, request.mip, mipMem);
+		}
+
+		bgfx::TextureStreamingStats streamingStats;
+		bgfx::getTextureStreamingStats(streamingStats);
+		bgfx::dbgTextPrintf(0, 5, 0x0f, "Streaming: resident %d[KiB], wanted %d[KiB], requests %d"
+			, streamingStats.resident>>10
+			, streamingStats.requested>>10
+			, streamingStats.numRequests
+			);
+
 		float at[3] = { 0.0f, 0.0f, 0.0f };
 		float eye[3] = { 0.0f, 0.0f, -5.0f };
 		
@@ -435,6 +509,33 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		// Submit primitive for rendering to view 0.
 		bgfx::submit(1);
 
+		// Streaming texture is drawn only half of the time. While it's not
+		// used, its finest mip levels are dropped, and they're requested
+		// again once it's used.
+		if (fmodf(time, 8.0f) < 4.0f)
+		{
+			mtxTranslate(mtx, -8.0f - BX_COUNTOF(textures)*0.1f*0.5f + 2.1f, 1.9f, 0.0f);
+
+			// Set model matrix for rendering.
+			bgfx::setTransform(mtx);
+
+			// Set vertex and fragment shaders.
+			bgfx::setProgram(programCmp);
+
+			// Set vertex and index buffer.
+			bgfx::setVertexBuffer(vbh);
+			bgfx::setIndexBuffer(ibh);
+
+			// Bind texture.
+			bgfx::setTexture(0, u_texColor, textureStreaming);
+
+			// Set render states.
+			bgfx::setState(BGFX_STATE_DEFAULT);
+
+			// Submit primitive for rendering to view 1.
+			bgfx::submit(1);
+		}
+
 
 		for (uint32_t ii = 0; ii < BX_COUNTOF(textures); ++ii)
 		{
@@ -473,6 +574,7 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		bgfx::destroyTexture(textures[ii]);
 	}
 
+	bgfx::destroyTexture(textureStreaming);
 	bgfx::destroyTexture(texture2d);
 	bgfx::destroyTexture(textureCube);
 	bgfx::destroyIndexBuffer(ibh);
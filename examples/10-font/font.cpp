@@ -185,6 +185,18 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		bgfx::dbgTextPrintf(0, 2, 0x6f, "Description: Use the font system to display text and styled text.");
 		bgfx::dbgTextPrintf(0, 3, 0x0f, "Frame: % 7.3f[ms]", double(frameTime)*toMs);
 
+		const FontManagerStats& stats = fontManager->getStats();
+		bgfx::dbgTextPrintf(0, 4, 0x0f, "Glyphs: %d, pending: %d, atlas updates: %d, upload: %d[bytes]"
+			, stats.numGlyphs
+			, stats.numPending
+			, stats.numUpdates
+			, stats.uploadSize
+			);
+
+		// Text buffer upload of previous frame.
+		bgfx::dbgTextPrintf(0, 5, 0x0f, "Text buffer upload: %d[bytes]", textBufferManager->getUploadSize() );
+		textBufferManager->resetUploadSize();
+
 		// Use transient text to display debug information.
 		wchar_t fpsText[64];
 		bx::swnprintf(fpsText, BX_COUNTOF(fpsText), L"Frame: % 7.3f[ms]", double(frameTime) * toMs);
@@ -209,6 +221,10 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		// Set view and projection matrix for view 0.
 		bgfx::setViewTransform(0, view, proj);
 
+		// Add glyphs finished by worker threads to atlas, and upload glyphs
+		// added to atlas this frame.
+		fontManager->update();
+
 		// Submit the debug text.
 		textBufferManager->submitTextBuffer(transientText, 0);
 
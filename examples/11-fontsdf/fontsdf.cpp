@@ -232,6 +232,9 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		// Set model matrix for rendering.
 		bgfx::setTransform(tmpMat3);
 
+		// Upload glyphs added to atlas this frame.
+		fontManager->update();
+
 		// Draw your text.
 		textBufferManager->submitTextBuffer(scrollableBuffer, 0);
 
@@ -13,6 +13,7 @@
 #include <bx/readerwriter.h>
 #include "entry/entry.h"
 #include "fpumath.h"
+#include "meshloader.h"
 #include "imgui/imgui.h"
 
 #define RENDER_VIEWID_RANGE1_PASS_0   1 
@@ -717,11 +718,13 @@ struct Group
 	void reset()
 	{
 		m_vbh.idx = bgfx::invalidHandle;
+		m_vbhStream.idx = bgfx::invalidHandle;
 		m_ibh.idx = bgfx::invalidHandle;
 		m_prims.clear();
 	}
 
 	bgfx::VertexBufferHandle m_vbh;
+	bgfx::VertexBufferHandle m_vbhStream; // Attributes other than position, vertex stream 1.
 	bgfx::IndexBufferHandle m_ibh;
 	Sphere m_sphere;
 	Aabb m_aabb;
@@ -757,46 +760,37 @@ struct Mesh
 
 	void load(const char* _filePath)
 	{
-#define BGFX_CHUNK_MAGIC_VB BX_MAKEFOURCC('V', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_IB BX_MAKEFOURCC('I', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
-
 		bx::CrtFileReader reader;
 		reader.open(_filePath);
 
 		Group group;
 
 		uint32_t chunk;
-		while (4 == bx::read(&reader, chunk) )
+		bool ok = true;
+		while (ok && 4 == bx::read(&reader, chunk) )
 		{
 			switch (chunk)
 			{
 			case BGFX_CHUNK_MAGIC_VB:
-				{
-					bx::read(&reader, group.m_sphere);
-					bx::read(&reader, group.m_aabb);
-					bx::read(&reader, group.m_obb);
-
-					bx::read(&reader, m_decl);
-					uint16_t stride = m_decl.getStride();
-
-					uint16_t numVertices;
-					bx::read(&reader, numVertices);
-					const bgfx::Memory* mem = bgfx::alloc(numVertices*stride);
-					bx::read(&reader, mem->data, mem->size);
+			case BGFX_CHUNK_MAGIC_VB32:
+			case BGFX_CHUNK_MAGIC_VBC:
+				bx::read(&reader, group.m_sphere);
+				bx::read(&reader, group.m_aabb);
+				bx::read(&reader, group.m_obb);
+				group.m_vbh = meshLoadVertexBuffer(&reader, chunk, m_decl);
+				ok = bgfx::isValid(group.m_vbh);
+				break;
 
-					group.m_vbh = bgfx::createVertexBuffer(mem, m_decl);
-				}
+			case BGFX_CHUNK_MAGIC_VBS:
+				ok = meshLoadVertexStream(&reader, group.m_vbhStream);
 				break;
 
 			case BGFX_CHUNK_MAGIC_IB:
-				{
-					uint32_t numIndices;
-					bx::read(&reader, numIndices);
-					const bgfx::Memory* mem = bgfx::alloc(numIndices*2);
-					bx::read(&reader, mem->data, mem->size);
-					group.m_ibh = bgfx::createIndexBuffer(mem);
-				}
+			case BGFX_CHUNK_MAGIC_IB32:
+			case BGFX_CHUNK_MAGIC_IBC:
+			case BGFX_CHUNK_MAGIC_IBC32:
+				group.m_ibh = meshLoadIndexBuffer(&reader, chunk);
+				ok = bgfx::isValid(group.m_ibh);
 				break;
 
 			case BGFX_CHUNK_MAGIC_PRI:
@@ -842,6 +836,27 @@ struct Mesh
 			}
 		}
 
+		if (!ok)
+		{
+			DBG("Failed to load %s, chunk %08x is corrupt.", _filePath, chunk);
+
+			// Buffers of incomplete group are not owned by any group yet.
+			if (bgfx::isValid(group.m_vbh) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbh);
+			}
+
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+
+			if (bgfx::isValid(group.m_ibh) )
+			{
+				bgfx::destroyIndexBuffer(group.m_ibh);
+			}
+		}
+
 		reader.close();
 	}
 
@@ -852,6 +867,11 @@ struct Mesh
 			const Group& group = *it;
 			bgfx::destroyVertexBuffer(group.m_vbh);
 
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+
 			if (bgfx::invalidHandle != group.m_ibh.idx)
 			{
 				bgfx::destroyIndexBuffer(group.m_ibh);
@@ -881,6 +901,11 @@ struct Mesh
 			bgfx::setIndexBuffer(group.m_ibh);
 			bgfx::setVertexBuffer(group.m_vbh);
 
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::setVertexStream(1, group.m_vbhStream);
+			}
+
 			// Set texture
 			if (bgfx::invalidHandle != _texture.idx)
 			{
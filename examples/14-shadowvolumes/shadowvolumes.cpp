@@ -22,11 +22,14 @@ using namespace std::tr1;
 #include <bx/allocator.h>
 #include <bx/hash.h>
 #include <bx/float4_t.h>
+#include <bx/cpu.h>
 #include "entry/entry.h"
 #include "fpumath.h"
 #include "imgui/imgui.h"
 
 #define SV_USE_SIMD 1
+#define SV_EDGE_BLOCK_SIZE (4*(8*sizeof(float) + 2*sizeof(uint32_t) ) )
+#define SV_FACE_BLOCK_SIZE (4*4*sizeof(float) )
 #define MAX_INSTANCE_COUNT 25
 #define MAX_LIGHTS_COUNT 5
 
@@ -693,17 +696,9 @@ typedef std::vector<Primitive> PrimitiveArray;
 struct Face
 {
 	uint16_t m_i[3];
-	float m_plane[4];
 };
 typedef std::vector<Face> FaceArray;
 
-struct Edge
-{
-	bool m_faceReverseOrder[2];
-	uint8_t m_faceIndex;
-	uint16_t m_i0, m_i1;
-};
-
 struct Plane
 {
 	float m_plane[4];
@@ -713,7 +708,6 @@ struct HalfEdge
 {
 #define INVALID_EDGE_INDEX UINT16_MAX
 	uint16_t m_secondIndex;
-	bool m_marked;
 };
 
 struct HalfEdges
@@ -753,7 +747,6 @@ struct HalfEdges
 			for (uint32_t jj = 0, end = (uint32_t)row.size(); jj < end; ++jj)
 			{
 				he->m_secondIndex = row[jj];
-				he->m_marked = false;
 				++he;
 			}
 			he->m_secondIndex = INVALID_EDGE_INDEX;
@@ -771,29 +764,32 @@ struct HalfEdges
 		m_offsets = NULL;
 	}
 
-	void mark(uint16_t _firstIndex, uint16_t _secondIndex)
+	// Marks are kept outside of half-edge data, one byte per half-edge,
+	// so that multiple threads can extract silhouettes of the same group.
+	void mark(uint8_t* _marks, uint16_t _firstIndex, uint16_t _secondIndex) const
 	{
-		HalfEdge* ptr = &m_data[m_offsets[_firstIndex]];
+		const HalfEdge* ptr = &m_data[m_offsets[_firstIndex]];
 		while (INVALID_EDGE_INDEX != ptr->m_secondIndex)
 		{
 			if (ptr->m_secondIndex == _secondIndex)
 			{
-				ptr->m_marked = true;
+				_marks[ptr - m_data] = 1;
 				break;
 			}
 			++ptr;
 		}
 	}
 
-	bool unmark(uint16_t _firstIndex, uint16_t _secondIndex)
+	bool unmark(uint8_t* _marks, uint16_t _firstIndex, uint16_t _secondIndex) const
 	{
 		bool ret = false;
-		HalfEdge* ptr = &m_data[m_offsets[_firstIndex]];
+		const HalfEdge* ptr = &m_data[m_offsets[_firstIndex]];
 		while (INVALID_EDGE_INDEX != ptr->m_secondIndex)
 		{
-			if (ptr->m_secondIndex == _secondIndex && ptr->m_marked)
+			uint8_t& marked = _marks[ptr - m_data];
+			if (ptr->m_secondIndex == _secondIndex && marked)
 			{
-				ptr->m_marked = false;
+				marked = 0;
 				ret = true;
 				break;
 			}
@@ -802,6 +798,11 @@ struct HalfEdges
 		return ret;
 	}
 
+	inline uint32_t size() const
+	{
+		return uint32_t(m_endPtr - m_data);
+	}
+
 	inline HalfEdge* begin() const
 	{
 		return m_data;
@@ -817,67 +818,6 @@ struct HalfEdges
 	HalfEdge* m_endPtr;
 };
 
-struct WeldedVertex
-{
-	uint16_t m_v;
-	bool m_welded;
-};
-
-inline float sqLength(const float _a[3], const float _b[3])
-{
-	const float xx = _a[0] - _b[0];
-	const float yy = _a[1] - _b[1];
-	const float zz = _a[2] - _b[2];
-	return xx*xx + yy*yy + zz*zz;
-}
-
-uint16_t weldVertices(WeldedVertex* _output, const bgfx::VertexDecl& _decl, const void* _data, uint16_t _num, float _epsilon)
-{
-	const uint32_t hashSize = bx::uint32_nextpow2(_num);
-	const uint32_t hashMask = hashSize-1;
-	const float epsilonSq = _epsilon*_epsilon;
-
-	uint32_t numVertices = 0;
-
-	const uint32_t size = sizeof(uint16_t)*(hashSize + _num);
-	uint16_t* hashTable = (uint16_t*)alloca(size);
-	memset(hashTable, 0xff, size);
-
-	uint16_t* next = hashTable + hashSize;
-
-	for (uint32_t ii = 0; ii < _num; ++ii)
-	{
-		float pos[4];
-		vertexUnpack(pos, bgfx::Attrib::Position, _decl, _data, ii);
-		uint32_t hashValue = bx::hashMurmur2A(pos, 3*sizeof(float) ) & hashMask;
-
-		uint16_t offset = hashTable[hashValue];
-		for (; UINT16_MAX != offset; offset = next[offset])
-		{
-			float test[4];
-			vertexUnpack(test, bgfx::Attrib::Position, _decl, _data, _output[offset].m_v);
-
-			if (sqLength(test, pos) < epsilonSq)
-			{
-				_output[ii].m_v = _output[offset].m_v;
-				_output[ii].m_welded = true;
-				break;
-			}
-		}
-
-		if (UINT16_MAX == offset)
-		{
-			_output[ii].m_v = ii;
-			_output[ii].m_welded = false;
-			next[ii] = hashTable[hashValue];
-			hashTable[hashValue] = ii;
-			numVertices++;
-		}
-	}
-
-	return numVertices;
-}
-
 struct Group
 {
 	Group()
@@ -894,8 +834,11 @@ struct Group
 		m_numIndices = 0;
 		m_indices = NULL;
 		m_numEdges = 0;
-		m_edges = NULL;
-		m_edgePlanesUnalignedPtr = NULL;
+		m_edgeIndices = NULL;
+		m_soaUnalignedPtr = NULL;
+		m_edgePlanes = NULL;
+		m_edgeReverse = NULL;
+		m_facePlanes = NULL;
 		m_prims.clear();
 	}
 
@@ -908,6 +851,9 @@ struct Group
 			, m_i0(_i0)
 			, m_i1(_i1)
 		{
+			// Open edges have only one face.
+			memset(m_faceReverseOrder, 0, sizeof(m_faceReverseOrder) );
+			memset(m_plane, 0, sizeof(m_plane) );
 		}
 
 		bool m_faceReverseOrder[2];
@@ -927,28 +873,26 @@ struct Group
 
 		//Init faces and edges.
 		m_faces.reserve(m_numIndices/3); //1 face = 3 indices
-		m_edges = (Edge*)malloc(m_numIndices * sizeof(Edge)); //1 triangle = 3 indices = 3 edges.
-		m_edgePlanesUnalignedPtr = (Plane*)malloc(m_numIndices * sizeof(Plane) + 15);
-		m_edgePlanes = (Plane*)bx::alignPtr(m_edgePlanesUnalignedPtr, 0, 16);
+		std::vector<Plane> facePlanes;
+		facePlanes.reserve(m_numIndices/3);
 
 		typedef std::map<std::pair<uint16_t, uint16_t>, EdgeAndPlane> EdgeMap;
 		EdgeMap edgeMap;
 
-		//Get unique indices.
-		WeldedVertex* uniqueVertices = (WeldedVertex*)malloc(m_numVertices*sizeof(WeldedVertex) );
-		::weldVertices(uniqueVertices, _decl, m_vertices, m_numVertices, 0.0001f);
+		//Get unique indices. Weld by position only.
+		float epsilon[bgfx::Attrib::Count];
+		for (uint32_t ii = 0; ii < bgfx::Attrib::Count; ++ii)
+		{
+			epsilon[ii] = -1.0f;
+		}
+		epsilon[bgfx::Attrib::Position] = 0.0001f;
+
+		uint32_t* uniqueVertices = (uint32_t*)malloc(m_numVertices*sizeof(uint32_t) );
+		bgfx::weldVertices(uniqueVertices, _decl, m_vertices, m_numVertices, epsilon);
 		uint16_t* uniqueIndices = (uint16_t*)malloc(m_numIndices*sizeof(uint16_t) );
 		for (uint32_t ii = 0; ii < m_numIndices; ++ii)
 		{
-			uint16_t index = m_indices[ii];
-			if (uniqueVertices[index].m_welded)
-			{
-				uniqueIndices[ii] = uniqueVertices[index].m_v;
-			}
-			else
-			{
-				uniqueIndices[ii] = index;
-			}
+			uniqueIndices[ii] = (uint16_t)uniqueVertices[m_indices[ii] ];
 		}
 		free(uniqueVertices);
 
@@ -969,9 +913,12 @@ struct Group
 			face.m_i[0] = i0;
 			face.m_i[1] = i1;
 			face.m_i[2] = i2;
-			memcpy(face.m_plane, plane, 4*sizeof(float) );
 			m_faces.push_back(face);
 
+			Plane facePlane;
+			memcpy(facePlane.m_plane, plane, 4*sizeof(float) );
+			facePlanes.push_back(facePlane);
+
 			//Use unique indices for EdgeMap.
 			const uint16_t* uindices = &uniqueIndices[ii*3];
 			const uint16_t ui0 = uindices[0];
@@ -1013,17 +960,63 @@ struct Group
 
 		free(uniqueIndices);
 
-		uint32_t index = 0;
+		// Planes are stored as SoA in blocks of 4, so that 4 edges/faces
+		// are tested against light at once. Padding edges are never
+		// silhouette (one face facing and one not facing any light).
+		const uint32_t numEdges = uint32_t(edgeMap.size() );
+		const uint32_t numFaces = uint32_t(m_faces.size() );
+		const uint32_t numEdgeBlocks = (numEdges+3)/4;
+		const uint32_t numFaceBlocks = (numFaces+3)/4;
+
+		m_edgeIndices = (uint16_t*)malloc(numEdges*2*sizeof(uint16_t) );
+		m_soaUnalignedPtr = malloc(numEdgeBlocks*SV_EDGE_BLOCK_SIZE + numFaceBlocks*SV_FACE_BLOCK_SIZE + 15);
+		m_edgePlanes = (float*)bx::alignPtr(m_soaUnalignedPtr, 0, 16);
+		m_edgeReverse = (uint32_t*)&m_edgePlanes[numEdgeBlocks*32];
+		m_facePlanes = (float*)&m_edgeReverse[numEdgeBlocks*8];
+
+		for (uint32_t ii = 0, num = numEdgeBlocks*4; ii < num; ++ii)
+		{
+			float* planes = &m_edgePlanes[ii/4*32 + ii%4];
+			uint32_t* reverse = &m_edgeReverse[ii/4*8 + ii%4];
+			for (uint32_t jj = 0; jj < 8; ++jj)
+			{
+				planes[jj*4] = 0.0f;
+			}
+			planes[12] = 1.0f;
+			planes[28] = -1.0f;
+			reverse[0] = 0;
+			reverse[4] = 0;
+		}
+
 		for (EdgeMap::const_iterator iter = edgeMap.begin(), end = edgeMap.end(); iter != end; ++iter)
 		{
-			Edge* edge = &m_edges[m_numEdges];
-			Plane* plane = &m_edgePlanes[index];
+			const EdgeAndPlane& ep = iter->second;
+			float* planes = &m_edgePlanes[m_numEdges/4*32 + m_numEdges%4];
+			uint32_t* reverse = &m_edgeReverse[m_numEdges/4*8 + m_numEdges%4];
 
-			memcpy(edge, iter->second.m_faceReverseOrder, sizeof(Edge));
-			memcpy(plane, iter->second.m_plane, 2 * sizeof(Plane));
+			for (uint32_t jj = 0; jj < 2; ++jj)
+			{
+				planes[jj*16 +  0] = ep.m_plane[jj].m_plane[0];
+				planes[jj*16 +  4] = ep.m_plane[jj].m_plane[1];
+				planes[jj*16 +  8] = ep.m_plane[jj].m_plane[2];
+				planes[jj*16 + 12] = ep.m_plane[jj].m_plane[3];
+				reverse[jj*4] = ep.m_faceReverseOrder[jj];
+			}
+
+			m_edgeIndices[m_numEdges*2+0] = ep.m_i0;
+			m_edgeIndices[m_numEdges*2+1] = ep.m_i1;
 
 			m_numEdges++;
-			index += 2;
+		}
+
+		for (uint32_t ii = 0, num = numFaceBlocks*4; ii < num; ++ii)
+		{
+			float* planes = &m_facePlanes[ii/4*16 + ii%4];
+			const float* plane = ii < numFaces ? facePlanes[ii].m_plane : NULL;
+			planes[ 0] = NULL != plane ? plane[0] : 0.0f;
+			planes[ 4] = NULL != plane ? plane[1] : 0.0f;
+			planes[ 8] = NULL != plane ? plane[2] : 0.0f;
+			planes[12] = NULL != plane ? plane[3] : -1.0f;
 		}
 	}
 
@@ -1038,10 +1031,10 @@ struct Group
 		m_vertices = NULL;
 		free(m_indices);
 		m_indices = NULL;
-		free(m_edges);
-		m_edges = NULL;
-		free(m_edgePlanesUnalignedPtr);
-		m_edgePlanesUnalignedPtr = NULL;
+		free(m_edgeIndices);
+		m_edgeIndices = NULL;
+		free(m_soaUnalignedPtr);
+		m_soaUnalignedPtr = NULL;
 		m_halfEdges.destroy();
 	}
 
@@ -1056,9 +1049,11 @@ struct Group
 	Obb m_obb;
 	PrimitiveArray m_prims;
 	uint32_t m_numEdges;
-	Edge* m_edges;
-	Plane* m_edgePlanesUnalignedPtr;
-	Plane* m_edgePlanes;
+	uint16_t* m_edgeIndices;
+	void* m_soaUnalignedPtr;
+	float* m_edgePlanes;     // Per 4 edges: first face xyzw, second face xyzw.
+	uint32_t* m_edgeReverse; // Per 4 edges: first face, second face.
+	float* m_facePlanes;     // Per 4 faces: xyzw.
 	FaceArray m_faces;
 	HalfEdges m_halfEdges;
 };
@@ -1311,43 +1306,94 @@ struct Instance
 	Model* m_model;
 };
 
-#define SV_INSTANCE_MEM_SIZE (1500 << 10)
-#define SV_INSTANCE_COUNT ( (25 > MAX_INSTANCE_COUNT) ? 25 : MAX_INSTANCE_COUNT)
-#define SV_PAGE_SIZE (SV_INSTANCE_MEM_SIZE * SV_INSTANCE_COUNT * MAX_LIGHTS_COUNT)
+#define SV_BLOCK_SIZE (1<<20)
+#define SV_MAX_THREADS 8
 
+// Per thread arena. Memory is referenced by bgfx::makeRef until the end of
+// next frame, so blocks are kept in two pages which are swapped every
+// frame. Blocks are never moved, arena grows by adding blocks.
 struct ShadowVolumeAllocator
 {
+	struct Block
+	{
+		Block* m_next;
+		uint32_t m_size;
+		uint32_t m_used;
+	};
+
 	ShadowVolumeAllocator()
+		: m_current(NULL)
+		, m_page(0)
 	{
-		m_mem = (uint8_t*)malloc(SV_PAGE_SIZE*2);
-		m_ptr = m_mem;
-		m_firstPage = true;
+		m_first[0] = NULL;
+		m_first[1] = NULL;
 	}
 
 	~ShadowVolumeAllocator()
 	{
-		free(m_mem);
+		for (uint32_t ii = 0; ii < 2; ++ii)
+		{
+			for (Block* block = m_first[ii]; NULL != block;)
+			{
+				Block* next = block->m_next;
+				free(block);
+				block = next;
+			}
+		}
 	}
 
 	void* alloc(uint32_t _size)
 	{
-		void* ret = (void*)m_ptr;
-		m_ptr += _size;
-		BX_CHECK(m_ptr - m_mem < (m_firstPage ? SV_PAGE_SIZE : 2 * SV_PAGE_SIZE), "Buffer overflow!");
+		_size = (_size+15)&~15;
+
+		if (NULL == m_current
+		||  m_current->m_used + _size > m_current->m_size)
+		{
+			Block* next = NULL == m_current ? m_first[m_page] : m_current->m_next;
+			if (NULL == next
+			||  _size > next->m_size)
+			{
+				const uint32_t size = uint32_max(SV_BLOCK_SIZE, _size);
+				Block* block = (Block*)malloc(sizeof(Block) + 16 + size);
+				block->m_next = next;
+				block->m_size = size;
+				block->m_used = 0;
+
+				if (NULL == m_current)
+				{
+					m_first[m_page] = block;
+				}
+				else
+				{
+					m_current->m_next = block;
+				}
+
+				next = block;
+			}
+
+			m_current = next;
+		}
+
+		uint8_t* data = (uint8_t*)bx::alignPtr(m_current + 1, 0, 16);
+		void* ret = &data[m_current->m_used];
+		m_current->m_used += _size;
 		return ret;
 	}
 
 	void swap()
 	{
-		m_ptr = m_firstPage ? m_mem + SV_PAGE_SIZE : m_mem;
-		m_firstPage = !m_firstPage;
+		m_page ^= 1;
+		for (Block* block = m_first[m_page]; NULL != block; block = block->m_next)
+		{
+			block->m_used = 0;
+		}
+		m_current = NULL;
 	}
 
-	uint8_t* m_mem;
-	uint8_t* m_ptr;
-	bool m_firstPage;
+	Block* m_first[2];
+	Block* m_current;
+	uint32_t m_page;
 };
-static ShadowVolumeAllocator s_svAllocator;
 
 struct ShadowVolumeImpl
 {
@@ -1369,6 +1415,19 @@ struct ShadowVolumeAlgorithm
 
 struct ShadowVolume
 {
+	ShadowVolume()
+	{
+		m_vbSides.idx    = bgfx::invalidHandle;
+		m_ibSides.idx    = bgfx::invalidHandle;
+		m_ibFrontCap.idx = bgfx::invalidHandle;
+		m_ibBackCap.idx  = bgfx::invalidHandle;
+		m_numVertices = 0;
+		m_numIndices  = 0;
+		m_mtx      = NULL;
+		m_lightPos = NULL;
+		m_cap      = false;
+	}
+
 	bgfx::VertexBufferHandle m_vbSides;
 	bgfx::IndexBufferHandle m_ibSides;
 	bgfx::IndexBufferHandle m_ibFrontCap;
@@ -1383,6 +1442,74 @@ struct ShadowVolume
 	bool m_cap;
 };
 
+struct ShadowVolumeVertex
+{
+	ShadowVolumeVertex(const float* _v3, float _extrude = 0.0f, float _k = 1.0f)
+	{
+		memcpy(m_v, _v3, 3*sizeof(float) );
+		m_extrude = _extrude;
+		m_k = _k;
+	}
+
+	float m_v[3];
+	float m_extrude;
+	float m_k;
+};
+
+// Shadow volume geometry doesn't depend on instance transform, only on
+// light position in model space. Volume is kept as long as it matches,
+// and entries which are not used by current frame are pruned.
+struct ShadowVolumeCacheEntry
+{
+	ShadowVolumeCacheEntry()
+		: m_group(NULL)
+		, m_frame(0)
+	{
+	}
+
+	const Group* m_group;
+	uint32_t m_frame;
+	float m_light[3];
+	ShadowVolumeImpl::Enum m_impl;
+	ShadowVolumeAlgorithm::Enum m_algo;
+	bool m_textureAsStencil;
+	ShadowVolume m_volume;
+};
+
+typedef std::unordered_map<uint32_t, ShadowVolumeCacheEntry> ShadowVolumeCache;
+
+struct ShadowVolumeTask
+{
+	const Group* m_group;
+	uint16_t m_stride;
+	float m_light[3]; // in model space
+	ShadowVolumeImpl::Enum m_impl;
+	ShadowVolumeAlgorithm::Enum m_algo;
+	bool m_textureAsStencil;
+	ShadowVolumeCacheEntry* m_entry;
+
+	// Output.
+	ShadowVolumeVertex* m_verticesSide;
+	uint16_t* m_indicesSide;
+	uint16_t* m_indicesFrontCap;
+	uint16_t* m_indicesBackCap;
+	uint32_t m_numVerticesSide;
+	uint32_t m_numIndicesSide;
+	uint32_t m_numIndicesFrontCap;
+	uint32_t m_numIndicesBackCap;
+};
+
+// Per thread state of shadow volume extraction.
+struct ShadowVolumeWorker
+{
+	ShadowVolumeAllocator m_allocator;
+	std::vector<int8_t> m_edgeK;
+	std::vector<uint8_t> m_faceFront;
+	std::vector<uint8_t> m_halfEdgeMarks;
+};
+
+static ShadowVolumeWorker s_svWorkers[SV_MAX_THREADS];
+
 void shadowVolumeLightTransform(float* __restrict _outLightPos
 							  , const float* __restrict _scale
 							  , const float* __restrict _rotate
@@ -1427,52 +1554,150 @@ void shadowVolumeLightTransform(float* __restrict _outLightPos
 	vec3MulMtx(_outLightPos, origin, mtx);
 }
 
-void shadowVolumeCreate(ShadowVolume& _shadowVolume
-					  , Group& _group
-					  , uint16_t _stride
-					  , const float* _mtx
-					  , const float* _light // in model space
-					  , ShadowVolumeImpl::Enum _impl = ShadowVolumeImpl::DepthPass
-					  , ShadowVolumeAlgorithm::Enum _algo = ShadowVolumeAlgorithm::FaceBased
-					  , bool _textureAsStencil = false
-					  )
+// Writes 1 for faces facing light. _frontFacing must hold number of faces
+// rounded up to multiple of 4.
+void shadowVolumeClassifyFaces(uint8_t* _frontFacing, const Group& _group, const float* _light)
 {
-	const uint8_t*    vertices   = _group.m_vertices;
-	const FaceArray&  faces      = _group.m_faces;
-	const Edge*       edges      = _group.m_edges;
-	const Plane*      edgePlanes = _group.m_edgePlanes;
-	const uint32_t    numEdges   = _group.m_numEdges;
-	HalfEdges&        halfEdges  = _group.m_halfEdges;
+	const uint32_t numFaces = uint32_t(_group.m_faces.size() );
+	const float* planes = _group.m_facePlanes;
+
+#if SV_USE_SIMD
+	using namespace bx;
+
+	const float4_t lx   = float4_splat(_light[0]);
+	const float4_t ly   = float4_splat(_light[1]);
+	const float4_t lz   = float4_splat(_light[2]);
+	const float4_t zero = float4_zero();
+	const float4_t onei = float4_isplat(1);
 
-	struct VertexData
+	for (uint32_t ii = 0; ii < numFaces; ii += 4, planes += 16)
 	{
-		VertexData()
-		{
-		}
+		const float4_t vX = float4_ld(&planes[ 0]);
+		const float4_t vY = float4_ld(&planes[ 4]);
+		const float4_t vZ = float4_ld(&planes[ 8]);
+		const float4_t vW = float4_ld(&planes[12]);
+
+		const float4_t r0  = float4_mul(vX, lx);
+		const float4_t r1  = float4_mul(vY, ly);
+		const float4_t r2  = float4_mul(vZ, lz);
+		const float4_t dot = float4_add(r0, float4_add(r1, r2) );
+		const float4_t f   = float4_add(dot, vW);
+
+		const float4_t mask  = float4_cmpgt(f, zero);
+		const float4_t front = float4_and(mask, onei);
+
+		BX_ALIGN_STRUCT_16(uint32_t res[4]);
+		float4_st(&res, front);
+
+		_frontFacing[ii+0] = uint8_t(res[0]);
+		_frontFacing[ii+1] = uint8_t(res[1]);
+		_frontFacing[ii+2] = uint8_t(res[2]);
+		_frontFacing[ii+3] = uint8_t(res[3]);
+	}
+#else
+	for (uint32_t ii = 0; ii < numFaces; ++ii)
+	{
+		const float* plane = &planes[ii/4*16 + ii%4];
+		const float f = plane[0]*_light[0] + plane[4]*_light[1] + plane[8]*_light[2] + plane[12];
+		_frontFacing[ii] = uint8_t(f > 0.0f);
+	}
+#endif // SV_USE_SIMD
+}
 
-		VertexData(const float* _v3, float _extrude = 0.0f, float _k = 1.0f)
+// Writes silhouette multiplier of each edge (-2, 0 or 2). _k must hold
+// number of edges rounded up to multiple of 4.
+void shadowVolumeClassifyEdges(int8_t* _k, const Group& _group, const float* _light)
+{
+	const uint32_t numEdges = _group.m_numEdges;
+	const float* planes = _group.m_edgePlanes;
+	const uint32_t* reverse = _group.m_edgeReverse;
+
+#if SV_USE_SIMD
+	using namespace bx;
+
+	const float4_t lx   = float4_splat(_light[0]);
+	const float4_t ly   = float4_splat(_light[1]);
+	const float4_t lz   = float4_splat(_light[2]);
+	const float4_t zero = float4_zero();
+	const float4_t onei = float4_isplat(1);
+	const float4_t twoi = float4_isplat(2);
+
+	for (uint32_t ii = 0; ii < numEdges; ii += 4, planes += 32, reverse += 8)
+	{
+		float4_t side[2];
+		for (uint32_t jj = 0; jj < 2; ++jj)
 		{
-			memcpy(m_v, _v3, 3*sizeof(float) );
-			m_extrude = _extrude;
-			m_k = _k;
+			const float* plane = &planes[jj*16];
+			const float4_t vX = float4_ld(&plane[ 0]);
+			const float4_t vY = float4_ld(&plane[ 4]);
+			const float4_t vZ = float4_ld(&plane[ 8]);
+			const float4_t vW = float4_ld(&plane[12]);
+
+			const float4_t r0  = float4_mul(vX, lx);
+			const float4_t r1  = float4_mul(vY, ly);
+			const float4_t r2  = float4_mul(vZ, lz);
+			const float4_t dot = float4_add(r0, float4_add(r1, r2) );
+			const float4_t f   = float4_add(dot, vW);
+
+			const float4_t mask = float4_cmpgt(f, zero);
+			const float4_t tmp0 = float4_and(mask, onei);
+			side[jj] = float4_xor(tmp0, float4_ld(&reverse[jj*4]) );
 		}
 
-		float m_v[3];
-		float m_extrude;
-		float m_k;
-	};
+		const float4_t tmp1 = float4_iadd(side[0], side[1]);
+		const float4_t tmp2 = float4_sll(tmp1, 1);
+		const float4_t k    = float4_isub(tmp2, twoi);
+
+		BX_ALIGN_STRUCT_16(int32_t res[4]);
+		float4_st(&res, k);
 
-	bool cap = (ShadowVolumeImpl::DepthFail == _impl);
+		_k[ii+0] = int8_t(res[0]);
+		_k[ii+1] = int8_t(res[1]);
+		_k[ii+2] = int8_t(res[2]);
+		_k[ii+3] = int8_t(res[3]);
+	}
+#else
+	for (uint32_t ii = 0; ii < numEdges; ++ii)
+	{
+		const float* plane = &planes[ii/4*32 + ii%4];
+		const uint32_t* rev = &reverse[ii/4*8 + ii%4];
+		const float f0 = plane[ 0]*_light[0] + plane[ 4]*_light[1] + plane[ 8]*_light[2] + plane[12];
+		const float f1 = plane[16]*_light[0] + plane[20]*_light[1] + plane[24]*_light[2] + plane[28];
+		const int32_t s0 = int32_t(f0 > 0.0f) ^ rev[0];
+		const int32_t s1 = int32_t(f1 > 0.0f) ^ rev[4];
+		_k[ii] = int8_t( ( (s0 + s1) << 1) - 2);
+	}
+#endif // SV_USE_SIMD
+}
 
-	VertexData* verticesSide    = (VertexData*) s_svAllocator.alloc(20000 * sizeof(VertexData) );
-	uint16_t*   indicesSide     = (uint16_t*)   s_svAllocator.alloc(20000 * 3*sizeof(uint16_t) );
-	uint16_t*   indicesFrontCap = 0;
-	uint16_t*   indicesBackCap  = 0;
+// Builds shadow volume geometry into worker's arena. Thread safe, doesn't
+// call bgfx. Faces and edges are classified first, so that output is
+// allocated with exact size.
+void shadowVolumeExtract(ShadowVolumeTask& _task, ShadowVolumeWorker& _worker)
+{
+	const Group&      group     = *_task.m_group;
+	const uint8_t*    vertices  = group.m_vertices;
+	const FaceArray&  faces     = group.m_faces;
+	const uint16_t*   edges     = group.m_edgeIndices;
+	const uint32_t    numEdges  = group.m_numEdges;
+	const uint32_t    numFaces  = uint32_t(faces.size() );
+	const HalfEdges&  halfEdges = group.m_halfEdges;
+	const uint16_t    stride    = _task.m_stride;
+	const bool textureAsStencil = _task.m_textureAsStencil;
+
+	bool cap = (ShadowVolumeImpl::DepthFail == _task.m_impl);
+
+	if (_worker.m_faceFront.size() < (numFaces+3)/4*4)
+	{
+		_worker.m_faceFront.resize( (numFaces+3)/4*4);
+	}
+	uint8_t* frontFacing = &_worker.m_faceFront[0];
+	shadowVolumeClassifyFaces(frontFacing, group, _task.m_light);
 
-	if (cap)
+	uint32_t numFrontFaces = 0;
+	for (uint32_t ii = 0; ii < numFaces; ++ii)
 	{
-		indicesFrontCap = (uint16_t*)s_svAllocator.alloc(80000 * 3*sizeof(uint16_t) );
-		indicesBackCap  = (uint16_t*)s_svAllocator.alloc(80000 * 3*sizeof(uint16_t) );
+		numFrontFaces += frontFacing[ii];
 	}
 
 	uint32_t vsideI    = 0;
@@ -1482,17 +1707,19 @@ void shadowVolumeCreate(ShadowVolume& _shadowVolume
 
 	uint16_t indexSide = 0;
 
-	if (ShadowVolumeAlgorithm::FaceBased == _algo)
+	if (ShadowVolumeAlgorithm::FaceBased == _task.m_algo)
 	{
-		for (FaceArray::const_iterator iter = faces.begin(), end = faces.end(); iter != end; ++iter)
+		if (_worker.m_halfEdgeMarks.size() < halfEdges.size() )
 		{
-			const Face& face = *iter;
+			_worker.m_halfEdgeMarks.resize(halfEdges.size(), 0);
+		}
+		uint8_t* marks = &_worker.m_halfEdgeMarks[0];
 
-			bool frontFacing = false;
-			float f = vec3Dot(face.m_plane, _light) + face.m_plane[3];
-			if (f > 0.0f)
+		for (uint32_t ii = 0; ii < numFaces; ++ii)
+		{
+			if (frontFacing[ii])
 			{
-				frontFacing = true;
+				const Face& face = faces[ii];
 				uint16_t triangleEdges[3][2] =
 				{
 					{ face.m_i[0], face.m_i[1] },
@@ -1500,32 +1727,45 @@ void shadowVolumeCreate(ShadowVolume& _shadowVolume
 					{ face.m_i[2], face.m_i[0] },
 				};
 
-				for (uint8_t ii = 0; ii < 3; ++ii)
+				for (uint8_t jj = 0; jj < 3; ++jj)
 				{
-					uint16_t first  = triangleEdges[ii][0];
-					uint16_t second = triangleEdges[ii][1];
+					uint16_t first  = triangleEdges[jj][0];
+					uint16_t second = triangleEdges[jj][1];
 
-					if (!halfEdges.unmark(second, first) )
+					if (!halfEdges.unmark(marks, second, first) )
 					{
-						halfEdges.mark(first, second);
+						halfEdges.mark(marks, first, second);
 					}
 				}
 			}
+		}
+
+		uint32_t numMarked = 0;
+		for (uint32_t ii = 0, num = halfEdges.size(); ii < num; ++ii)
+		{
+			numMarked += marks[ii];
+		}
 
-			if (cap)
+		_task.m_verticesSide    = (ShadowVolumeVertex*)_worker.m_allocator.alloc(numMarked*4*sizeof(ShadowVolumeVertex) );
+		_task.m_indicesSide     = (uint16_t*)_worker.m_allocator.alloc(numMarked*6*sizeof(uint16_t) );
+		_task.m_indicesFrontCap = cap ? (uint16_t*)_worker.m_allocator.alloc(numFrontFaces*3*sizeof(uint16_t) ) : NULL;
+		_task.m_indicesBackCap  = cap ? (uint16_t*)_worker.m_allocator.alloc( (numFaces-numFrontFaces)*3*sizeof(uint16_t) ) : NULL;
+
+		ShadowVolumeVertex* verticesSide = _task.m_verticesSide;
+		uint16_t* indicesSide = _task.m_indicesSide;
+
+		if (cap)
+		{
+			for (uint32_t ii = 0; ii < numFaces; ++ii)
 			{
-				if (frontFacing)
-				{
-					indicesFrontCap[frontCapI++] = face.m_i[0];
-					indicesFrontCap[frontCapI++] = face.m_i[1];
-					indicesFrontCap[frontCapI++] = face.m_i[2];
-				}
-				else
-				{
-					indicesBackCap[backCapI++] = face.m_i[0];
-					indicesBackCap[backCapI++] = face.m_i[1];
-					indicesBackCap[backCapI++] = face.m_i[2];
-				}
+				const Face& face = faces[ii];
+				uint16_t* indices = frontFacing[ii]
+					? &_task.m_indicesFrontCap[(frontCapI+=3)-3]
+					: &_task.m_indicesBackCap[(backCapI+=3)-3]
+					;
+				indices[0] = face.m_i[0];
+				indices[1] = face.m_i[1];
+				indices[2] = face.m_i[2];
 
 				/**
 				 * if '_useFrontFacingFacesAsBackCap' is needed, implement it as such:
@@ -1544,20 +1784,21 @@ void shadowVolumeCreate(ShadowVolume& _shadowVolume
 
 		// Fill side arrays.
 		uint16_t firstIndex = 0;
-		HalfEdge* he = halfEdges.begin();
+		const HalfEdge* he = halfEdges.begin();
 		while (halfEdges.end() != he)
 		{
-			if (he->m_marked)
+			uint8_t& marked = marks[he - halfEdges.begin()];
+			if (marked)
 			{
-				he->m_marked = false;
+				marked = 0;
 
-				const float* v0 = (float*)&vertices[firstIndex*_stride];
-				const float* v1 = (float*)&vertices[he->m_secondIndex*_stride];
+				const float* v0 = (float*)&vertices[firstIndex*stride];
+				const float* v1 = (float*)&vertices[he->m_secondIndex*stride];
 
-				verticesSide[vsideI++] = VertexData(v0, 0.0f);
-				verticesSide[vsideI++] = VertexData(v0, 1.0f);
-				verticesSide[vsideI++] = VertexData(v1, 0.0f);
-				verticesSide[vsideI++] = VertexData(v1, 1.0f);
+				verticesSide[vsideI++] = ShadowVolumeVertex(v0, 0.0f);
+				verticesSide[vsideI++] = ShadowVolumeVertex(v0, 1.0f);
+				verticesSide[vsideI++] = ShadowVolumeVertex(v1, 0.0f);
+				verticesSide[vsideI++] = ShadowVolumeVertex(v1, 1.0f);
 
 				indicesSide[sideI++] = indexSide+0;
 				indicesSide[sideI++] = indexSide+1;
@@ -1580,117 +1821,47 @@ void shadowVolumeCreate(ShadowVolume& _shadowVolume
 	}
 	else // ShadowVolumeAlgorithm::EdgeBased:
 	{
-		uint32_t ii = 0;
-
-#if SV_USE_SIMD
-		uint32_t numEdgesRounded = numEdges & (~0x1);
-
-		using namespace bx;
-
-		const float4_t lx = float4_splat(_light[0]);
-		const float4_t ly = float4_splat(_light[1]);
-		const float4_t lz = float4_splat(_light[2]);
-
-		for (; ii < numEdgesRounded; ii+=2)
+		if (_worker.m_edgeK.size() < (numEdges+3)/4*4)
 		{
-			const Edge& edge0 = edges[ii];
-			const Edge& edge1 = edges[ii+1];
-			const Plane* edgePlane0 = &edgePlanes[ii*2];
-			const Plane* edgePlane1 = &edgePlanes[ii*2 + 2];
-
-			const float4_t reverse = float4_ild(edge0.m_faceReverseOrder[0]
-						 , edge1.m_faceReverseOrder[0]
-						 , edge0.m_faceReverseOrder[1]
-						 , edge1.m_faceReverseOrder[1]
-						 );
-
-			const float4_t v0 = float4_ld(edgePlane0[0].m_plane);
-			const float4_t v1 = float4_ld(edgePlane1[0].m_plane);
-			const float4_t v2 = float4_ld(edgePlane0[1].m_plane);
-			const float4_t v3 = float4_ld(edgePlane1[1].m_plane);
-
-			const float4_t xxyy0 = float4_shuf_xAyB(v0, v2);
-			const float4_t zzww0 = float4_shuf_zCwD(v0, v2);
-			const float4_t xxyy1 = float4_shuf_xAyB(v1, v3);
-			const float4_t zzww1 = float4_shuf_zCwD(v1, v3);
+			_worker.m_edgeK.resize( (numEdges+3)/4*4);
+		}
+		int8_t* edgeK = _worker.m_edgeK.empty() ? NULL : &_worker.m_edgeK[0];
+		shadowVolumeClassifyEdges(edgeK, group, _task.m_light);
 
-			const float4_t vX = float4_shuf_xAyB(xxyy0, xxyy1);
-			const float4_t vY = float4_shuf_zCwD(xxyy0, xxyy1);
-			const float4_t vZ = float4_shuf_xAyB(zzww0, zzww1);
-			const float4_t vW = float4_shuf_zCwD(zzww0, zzww1);
+		uint32_t numSilhouette = 0;
+		uint32_t numSideIndices = 0;
+		for (uint32_t ii = 0; ii < numEdges; ++ii)
+		{
+			const int32_t k = edgeK[ii];
+			numSilhouette  += 0 != k;
+			numSideIndices += 0 != k ? (textureAsStencil ? 6 : abs(k)*6) : 0;
+		}
 
-			const float4_t r0 = float4_mul(vX, lx);
-			const float4_t r1 = float4_mul(vY, ly);
-			const float4_t r2 = float4_mul(vZ, lz);
+		const uint32_t numCapCopies = 1 + uint32_t(!textureAsStencil);
 
-			const float4_t dot = float4_add(r0, float4_add(r1, r2));
-			const float4_t f = float4_add(dot, vW);
+		_task.m_verticesSide    = (ShadowVolumeVertex*)_worker.m_allocator.alloc(numSilhouette*4*sizeof(ShadowVolumeVertex) );
+		_task.m_indicesSide     = (uint16_t*)_worker.m_allocator.alloc(numSideIndices*sizeof(uint16_t) );
+		_task.m_indicesFrontCap = cap ? (uint16_t*)_worker.m_allocator.alloc(numFrontFaces*3*numCapCopies*sizeof(uint16_t) ) : NULL;
+		_task.m_indicesBackCap  = cap ? (uint16_t*)_worker.m_allocator.alloc( (numFaces-numFrontFaces)*3*numCapCopies*sizeof(uint16_t) ) : NULL;
 
-			const float4_t zero = float4_zero();
-			const float4_t mask = float4_cmpgt(f, zero);
-			const float4_t onef = float4_splat(1.0f);
-			const float4_t tmp0 = float4_and(mask, onef);
-			const float4_t tmp1 = float4_ftoi(tmp0);
-			const float4_t tmp2 = float4_xor(tmp1, reverse);
-			const float4_t tmp3 = float4_sll(tmp2, 1);
-			const float4_t onei = float4_isplat(1);
-			const float4_t tmp4 = float4_isub(tmp3, onei);
-
-			BX_ALIGN_STRUCT_16(int32_t res[4]);
-			float4_st(&res, tmp4);
-
-			for (uint16_t jj = 0; jj < 2; ++jj)
-			{
-				int16_t k = res[jj] + res[jj+2];
-				if (k != 0)
-				{
-					float* v0 = (float*)&vertices[edges[ii+jj].m_i0*_stride];
-					float* v1 = (float*)&vertices[edges[ii+jj].m_i1*_stride];
-					verticesSide[vsideI++] = VertexData(v0, 0.0f, float(k));
-					verticesSide[vsideI++] = VertexData(v0, 1.0f, float(k));
-					verticesSide[vsideI++] = VertexData(v1, 0.0f, float(k));
-					verticesSide[vsideI++] = VertexData(v1, 1.0f, float(k));
-
-					k = _textureAsStencil ? 1 : k;
-					uint16_t winding = uint16_t(k > 0);
-					for (uint8_t ii = 0, end = abs(k); ii < end; ++ii)
-					{
-						indicesSide[sideI++] = indexSide;
-						indicesSide[sideI++] = indexSide + 2 - winding;
-						indicesSide[sideI++] = indexSide + 1 + winding;
-
-						indicesSide[sideI++] = indexSide + 2;
-						indicesSide[sideI++] = indexSide + 3 - winding*2;
-						indicesSide[sideI++] = indexSide + 1 + winding*2;
-					}
+		ShadowVolumeVertex* verticesSide = _task.m_verticesSide;
+		uint16_t* indicesSide = _task.m_indicesSide;
 
-					indexSide += 4;
-				}
-			}
-		}
-#endif
-
-		for (; ii < numEdges; ++ii)
+		for (uint32_t ii = 0; ii < numEdges; ++ii)
 		{
-			const Edge& edge = edges[ii];
-			const Plane* edgePlane = &edgePlanes[ii*2];
-
-			int16_t s0 = ( (vec3Dot(edgePlane[0].m_plane, _light) + edgePlane[0].m_plane[3]) > 0.0f) ^ edge.m_faceReverseOrder[0];
-			int16_t s1 = ( (vec3Dot(edgePlane[1].m_plane, _light) + edgePlane[1].m_plane[3]) > 0.0f) ^ edge.m_faceReverseOrder[1];
-			int16_t k = ( (s0 + s1) << 1) - 2;
-
+			int16_t k = edgeK[ii];
 			if (k != 0)
 			{
-				float* v0 = (float*)&vertices[edge.m_i0*_stride];
-				float* v1 = (float*)&vertices[edge.m_i1*_stride];
-				verticesSide[vsideI++] = VertexData(v0, 0.0f, k);
-				verticesSide[vsideI++] = VertexData(v0, 1.0f, k);
-				verticesSide[vsideI++] = VertexData(v1, 0.0f, k);
-				verticesSide[vsideI++] = VertexData(v1, 1.0f, k);
-
-				k = _textureAsStencil ? 1 : k;
+				const float* v0 = (float*)&vertices[edges[ii*2+0]*stride];
+				const float* v1 = (float*)&vertices[edges[ii*2+1]*stride];
+				verticesSide[vsideI++] = ShadowVolumeVertex(v0, 0.0f, float(k) );
+				verticesSide[vsideI++] = ShadowVolumeVertex(v0, 1.0f, float(k) );
+				verticesSide[vsideI++] = ShadowVolumeVertex(v1, 0.0f, float(k) );
+				verticesSide[vsideI++] = ShadowVolumeVertex(v1, 1.0f, float(k) );
+
+				k = textureAsStencil ? 1 : k;
 				uint16_t winding = uint16_t(k > 0);
-				for (uint8_t ii = 0, end = abs(k); ii < end; ++ii)
+				for (uint8_t jj = 0, end = uint8_t(abs(k) ); jj < end; ++jj)
 				{
 					indicesSide[sideI++] = indexSide;
 					indicesSide[sideI++] = indexSide + 2 - winding;
@@ -1708,79 +1879,158 @@ void shadowVolumeCreate(ShadowVolume& _shadowVolume
 		if (cap)
 		{
 			// This could/should be done on GPU!
-			for (FaceArray::const_iterator iter = faces.begin(), end = faces.end(); iter != end; ++iter)
+			for (uint32_t ii = 0; ii < numFaces; ++ii)
 			{
-				const Face& face = *iter;
-
-				float f = vec3Dot(face.m_plane, _light) + face.m_plane[3];
-				bool frontFacing = (f > 0.0f);
+				const Face& face = faces[ii];
 
-				for (uint8_t ii = 0, end = 1 + uint8_t(!_textureAsStencil); ii < end; ++ii)
+				for (uint8_t jj = 0; jj < numCapCopies; ++jj)
 				{
-					if (frontFacing)
-					{
-						indicesFrontCap[frontCapI++] = face.m_i[0];
-						indicesFrontCap[frontCapI++] = face.m_i[1];
-						indicesFrontCap[frontCapI++] = face.m_i[2];
-					}
-					else
-					{
-						indicesBackCap[backCapI++] = face.m_i[0];
-						indicesBackCap[backCapI++] = face.m_i[1];
-						indicesBackCap[backCapI++] = face.m_i[2];
-					}
+					uint16_t* indices = frontFacing[ii]
+						? &_task.m_indicesFrontCap[(frontCapI+=3)-3]
+						: &_task.m_indicesBackCap[(backCapI+=3)-3]
+						;
+					indices[0] = face.m_i[0];
+					indices[1] = face.m_i[1];
+					indices[2] = face.m_i[2];
 				}
 			}
 		}
 	}
 
+	_task.m_numVerticesSide    = vsideI;
+	_task.m_numIndicesSide     = sideI;
+	_task.m_numIndicesFrontCap = frontCapI;
+	_task.m_numIndicesBackCap  = backCapI;
+}
+
+struct ShadowVolumeJob
+{
+	ShadowVolumeTask* m_tasks;
+	uint32_t m_numTasks;
+	volatile int32_t m_next;
+};
+
+static void shadowVolumeWorker(uint32_t _thread, void* _userData)
+{
+	ShadowVolumeJob& job = *(ShadowVolumeJob*)_userData;
+	ShadowVolumeWorker& worker = s_svWorkers[_thread];
+
+	for (uint32_t ii = (uint32_t)bx::atomicFetchAndAdd(&job.m_next, 1)
+		; ii < job.m_numTasks
+		; ii = (uint32_t)bx::atomicFetchAndAdd(&job.m_next, 1)
+		)
+	{
+		shadowVolumeExtract(job.m_tasks[ii], worker);
+	}
+}
+
+// Extract shadow volumes of all tasks on up to _numThreads threads.
+void shadowVolumeExtract(ShadowVolumeTask* _tasks, uint32_t _numTasks, uint32_t _numThreads)
+{
+	ShadowVolumeJob job;
+	job.m_tasks = _tasks;
+	job.m_numTasks = _numTasks;
+	job.m_next = 0;
+
+	const uint32_t numThreads = uint32_max(1, _numThreads < SV_MAX_THREADS ? _numThreads : SV_MAX_THREADS);
+	bgfx::parallelFor(numThreads, shadowVolumeWorker, &job, numThreads);
+}
+
+void shadowVolumeDestroy(ShadowVolume& _shadowVolume)
+{
+	if (bgfx::invalidHandle != _shadowVolume.m_vbSides.idx)
+	{
+		bgfx::destroyVertexBuffer(_shadowVolume.m_vbSides);
+		bgfx::destroyIndexBuffer(_shadowVolume.m_ibSides);
+	}
+
+	if (bgfx::invalidHandle != _shadowVolume.m_ibFrontCap.idx)
+	{
+		bgfx::destroyIndexBuffer(_shadowVolume.m_ibFrontCap);
+		bgfx::destroyIndexBuffer(_shadowVolume.m_ibBackCap);
+	}
+
+	_shadowVolume = ShadowVolume();
+}
+
+// Create buffers from extracted geometry. Must be called on main thread.
+void shadowVolumeCreate(ShadowVolume& _shadowVolume, const ShadowVolumeTask& _task)
+{
 	bgfx::VertexDecl decl;
 	decl.begin();
 	decl.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
 	decl.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float);
 	decl.end();
 
+	shadowVolumeDestroy(_shadowVolume);
+
+	const bool cap = (ShadowVolumeImpl::DepthFail == _task.m_impl);
+
 	//fill the structure
-	_shadowVolume.m_numVertices = vsideI;
-	_shadowVolume.m_numIndices  = sideI + frontCapI + backCapI;
-	_shadowVolume.m_mtx         = _mtx;
-	_shadowVolume.m_lightPos    = _light;
+	_shadowVolume.m_numVertices = _task.m_numVerticesSide;
+	_shadowVolume.m_numIndices  = _task.m_numIndicesSide + _task.m_numIndicesFrontCap + _task.m_numIndicesBackCap;
 	_shadowVolume.m_cap         = cap;
 
+	// Arena memory stays valid until the end of next frame, buffers are
+	// kept while volume is cached.
 	const bgfx::Memory* mem;
 
 	//sides
-	uint32_t vsize = vsideI * 5*sizeof(float);
-	uint32_t isize = sideI * sizeof(uint16_t);
+	uint32_t vsize = _task.m_numVerticesSide * sizeof(ShadowVolumeVertex);
+	uint32_t isize = _task.m_numIndicesSide * sizeof(uint16_t);
 
-	mem = bgfx::makeRef(verticesSide, vsize);
+	mem = bgfx::makeRef(_task.m_verticesSide, vsize);
 	_shadowVolume.m_vbSides = bgfx::createVertexBuffer(mem, decl);
 
-	mem = bgfx::makeRef(indicesSide, isize);
+	mem = bgfx::makeRef(_task.m_indicesSide, isize);
 	_shadowVolume.m_ibSides = bgfx::createIndexBuffer(mem);
 
-	// bgfx::destroy*Buffer doesn't actually destroy buffers now.
-	// Instead, these bgfx::destroy*Buffer commands get queued to be executed after the end of the next frame.
-	bgfx::destroyVertexBuffer(_shadowVolume.m_vbSides);
-	bgfx::destroyIndexBuffer(_shadowVolume.m_ibSides);
-
 	if (cap)
 	{
 		//front cap
-		isize = frontCapI * sizeof(uint16_t);
-		mem = bgfx::makeRef(indicesFrontCap, isize);
+		isize = _task.m_numIndicesFrontCap * sizeof(uint16_t);
+		mem = bgfx::makeRef(_task.m_indicesFrontCap, isize);
 		_shadowVolume.m_ibFrontCap = bgfx::createIndexBuffer(mem);
 
-		//gets destroyed after the end of the next frame
-		bgfx::destroyIndexBuffer(_shadowVolume.m_ibFrontCap);
-
 		//back cap
-		isize = backCapI * sizeof(uint16_t);
-		mem = bgfx::makeRef(indicesBackCap, isize);
+		isize = _task.m_numIndicesBackCap * sizeof(uint16_t);
+		mem = bgfx::makeRef(_task.m_indicesBackCap, isize);
 		_shadowVolume.m_ibBackCap = bgfx::createIndexBuffer(mem);
+	}
+}
 
-		//gets destroyed after the end of the next frame
-		bgfx::destroyIndexBuffer(_shadowVolume.m_ibBackCap);
+bool shadowVolumeCacheMatch(const ShadowVolumeCacheEntry& _entry, const ShadowVolumeTask& _task)
+{
+	return _entry.m_group == _task.m_group
+		&& 0 == memcmp(_entry.m_light, _task.m_light, sizeof(_entry.m_light) )
+		&& _entry.m_impl == _task.m_impl
+		&& _entry.m_algo == _task.m_algo
+		&& _entry.m_textureAsStencil == _task.m_textureAsStencil
+		;
+}
+
+void shadowVolumeCacheClear(ShadowVolumeCache& _cache)
+{
+	for (ShadowVolumeCache::iterator it = _cache.begin(), itEnd = _cache.end(); it != itEnd; ++it)
+	{
+		shadowVolumeDestroy(it->second.m_volume);
+	}
+	_cache.clear();
+}
+
+void shadowVolumeCachePrune(ShadowVolumeCache& _cache, uint32_t _frame)
+{
+	for (ShadowVolumeCache::iterator it = _cache.begin(), itEnd = _cache.end(); it != itEnd;)
+	{
+		if (it->second.m_frame != _frame)
+		{
+			shadowVolumeDestroy(it->second.m_volume);
+			_cache.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
 	}
 }
 
@@ -2114,6 +2364,25 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	uint32_t numShadowVolumeVertices = 0;
 	uint32_t numShadowVolumeIndices  = 0;
 
+	int64_t svTime = 0;
+	uint32_t numShadowVolumeEdges  = 0;
+	uint32_t numShadowVolumes      = 0;
+	uint32_t numShadowVolumesCached = 0;
+
+	// Shadow volume extraction, one task per light, caster and group.
+	struct ShadowVolumeInstance
+	{
+		float m_mtx[16];
+		float m_lightPos[3];
+		ShadowVolumeImpl::Enum m_impl;
+		uint32_t m_firstTask;
+	};
+
+	std::vector<ShadowVolumeInstance> svInstances;
+	std::vector<ShadowVolumeTask> svTasks;
+	std::vector<ShadowVolumeTask> svDirtyTasks;
+	ShadowVolumeCache svCache;
+
 	uint32_t oldWidth = 0;
 	uint32_t oldHeight = 0;
 
@@ -2124,6 +2393,8 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	bool settings_mixedSvImpl        = true;
 	bool settings_useStencilTexture  = true;
 	bool settings_drawShadowVolumes  = false;
+	bool settings_cacheShadowVolumes = true;
+	float settings_numThreads        = 4.0f;
 	float settings_numLights         = 1.0f;
 	float settings_instanceCount     = 9.0f;
 	ShadowVolumeImpl::Enum      settings_shadowVolumeImpl      = ShadowVolumeImpl::DepthFail;
@@ -2159,6 +2430,8 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	LightPattern lightPattern = LightPattern0;
 	MeshChoice currentMesh = BunnyLowPoly;
 	Scene currentScene = Scene0;
+	Scene cachedScene = Scene0;
+	uint32_t svFrame = 1;
 
 	entry::MouseState mouseState;
 	while (!entry::processEvents(viewState.m_width, viewState.m_height, debug, reset, &mouseState) )
@@ -2286,7 +2559,16 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 			imguiSlider("Instance count", &settings_instanceCount, 1.0f, float(MAX_INSTANCE_COUNT), 1.0f);
 		}
 
+		imguiSlider("Threads", &settings_numThreads, 1.0f, float(SV_MAX_THREADS), 1.0f);
+		settings_cacheShadowVolumes = imguiCheck("Cache volumes", settings_cacheShadowVolumes)
+			? !settings_cacheShadowVolumes
+			: settings_cacheShadowVolumes
+			;
+
 		imguiLabel("CPU Time: %7.1f [ms]", double(profTime)*toMs);
+		imguiLabel("Extraction: %7.1f [ms]", double(svTime)*toMs);
+		imguiLabel("Edges: %7.1f [M/s]", 0 != svTime ? double(numShadowVolumeEdges)/(double(svTime)/freq)/1000000.0 : 0.0);
+		imguiLabel("Cached volumes: %u/%u", numShadowVolumesCached, numShadowVolumes);
 		imguiLabel("Volume Vertices: %5.uk", numShadowVolumeVertices/1000);
 		imguiLabel("Volume Indices: %6.uk", numShadowVolumeIndices/1000);
 		numShadowVolumeVertices = 0;
@@ -2649,43 +2931,24 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 
 		profTime = bx::getHPCounter();
 
+		// Cache is keyed by caster index, drop it when scene changes.
+		if (cachedScene != currentScene)
+		{
+			shadowVolumeCacheClear(svCache);
+			cachedScene = currentScene;
+		}
+
 		/**
-		 * For each light:
-		 * 1. Compute and draw shadow volume to stencil buffer
-		 * 2. Draw diffuse with stencil test
+		 * Setup shadow volume tasks for every light and caster. Volumes
+		 * are extracted in parallel, and only for those that changed.
 		 */
-		for (uint8_t ii = 0, viewId = VIEWID_RANGE15_PASS2; ii < settings_numLights; ++ii, ++viewId)
+		svInstances.clear();
+		svTasks.clear();
+		svDirtyTasks.clear();
+		for (uint8_t ii = 0; ii < settings_numLights; ++ii)
 		{
 			const float* lightPos = lightPosRadius[ii];
 
-			memcpy(s_uniforms.m_lightPosRadius, lightPosRadius[ii], 4*sizeof(float) );
-			memcpy(s_uniforms.m_lightRgbInnerR, lightRgbInnerR[ii], 3*sizeof(float) );
-			memcpy(s_uniforms.m_color,          lightRgbInnerR[ii], 3*sizeof(float) );
-
-			if (settings_useStencilTexture)
-			{
-				bgfx::setViewRenderTarget(viewId, s_stencilRt);
-
-				bgfx::setViewClear(viewId
-						, BGFX_CLEAR_COLOR_BIT
-						, 0x00000000
-						, 1.0f
-						, 0
-						);
-			}
-			else
-			{
-				const bgfx::RenderTargetHandle invalidRt = BGFX_INVALID_HANDLE;
-				bgfx::setViewRenderTarget(viewId, invalidRt);
-
-				bgfx::setViewClear(viewId
-						, BGFX_CLEAR_STENCIL_BIT
-						, clearValues.m_clearRgba
-						, clearValues.m_clearDepth
-						, clearValues.m_clearStencil
-						);
-			}
-
 			// Create near clip volume for current light.
 			float nearClipVolume[6 * 4] = {};
 			float pointLight[4];
@@ -2703,31 +2966,25 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 				const Instance& instance = shadowCasters[currentScene][jj];
 				Model* model = instance.m_model;
 
-				ShadowVolumeImpl::Enum shadowVolumeImpl = settings_shadowVolumeImpl;
+				ShadowVolumeInstance svInstance;
+				svInstance.m_impl = settings_shadowVolumeImpl;
 				if (settings_mixedSvImpl)
 				{
 					// If instance is inside near clip volume, depth fail must be used, else depth pass is fine.
 					bool isInsideVolume = clipTest(nearClipVolume, 6, model->m_mesh, instance.m_scale, instance.m_pos);
-					shadowVolumeImpl = (isInsideVolume ? ShadowVolumeImpl::DepthFail : ShadowVolumeImpl::DepthPass);
+					svInstance.m_impl = (isInsideVolume ? ShadowVolumeImpl::DepthFail : ShadowVolumeImpl::DepthPass);
 				}
-				s_uniforms.m_svparams.m_dfail = float(ShadowVolumeImpl::DepthFail == shadowVolumeImpl);
 
 				// Compute virtual light position for shadow volume generation.
-				float transformedLightPos[3];
-				shadowVolumeLightTransform(transformedLightPos
+				shadowVolumeLightTransform(svInstance.m_lightPos
 					, instance.m_scale
 					, instance.m_rotation
 					, instance.m_pos
 					, lightPos
 					);
 
-				// Set virtual light pos.
-				memcpy(s_uniforms.m_virtualLightPos_extrusionDist, transformedLightPos, 3*sizeof(float) );
-				s_uniforms.m_virtualLightPos_extrusionDist[3] = instance.m_svExtrusionDistance;
-
 				// Compute transform for shadow volume.
-				float shadowVolumeMtx[16];
-				mtxScaleRotateTranslate(shadowVolumeMtx
+				mtxScaleRotateTranslate(svInstance.m_mtx
 						, instance.m_scale[0]
 						, instance.m_scale[1]
 						, instance.m_scale[2]
@@ -2739,23 +2996,126 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 						, instance.m_pos[2]
 						);
 
+				svInstance.m_firstTask = uint32_t(svTasks.size() );
+				svInstances.push_back(svInstance);
+
 				GroupArray& groups = model->m_mesh.m_groups;
-				const uint16_t stride = model->m_mesh.m_decl.getStride();
-				for (GroupArray::iterator it = groups.begin(), itEnd = groups.end(); it != itEnd; ++it)
+				for (uint32_t kk = 0, num = uint32_t(groups.size() ); kk < num; ++kk)
 				{
-					Group& group = *it;
-
-					// Create shadow volume.
-					ShadowVolume shadowVolume;
-					shadowVolumeCreate(shadowVolume
-						, group
-						, stride
-						, shadowVolumeMtx
-						, transformedLightPos
-						, shadowVolumeImpl
-						, settings_shadowVolumeAlgorithm
-						, settings_useStencilTexture
+					ShadowVolumeTask task;
+					task.m_group  = &groups[kk];
+					task.m_stride = model->m_mesh.m_decl.getStride();
+					memcpy(task.m_light, svInstance.m_lightPos, 3*sizeof(float) );
+					task.m_impl = svInstance.m_impl;
+					task.m_algo = settings_shadowVolumeAlgorithm;
+					task.m_textureAsStencil = settings_useStencilTexture;
+
+					const uint32_t key = (uint32_t(jj)<<16) | (uint32_t(ii)<<8) | kk;
+					task.m_entry = &svCache[key];
+					task.m_entry->m_frame = svFrame;
+					svTasks.push_back(task);
+				}
+			}
+		}
+
+		// Drop volumes of lights and casters which are not used anymore.
+		shadowVolumeCachePrune(svCache, svFrame);
+		++svFrame;
+
+		numShadowVolumes = uint32_t(svTasks.size() );
+		numShadowVolumeEdges = 0;
+		for (uint32_t ii = 0; ii < numShadowVolumes; ++ii)
+		{
+			ShadowVolumeTask& task = svTasks[ii];
+			if (!settings_cacheShadowVolumes
+			||  !shadowVolumeCacheMatch(*task.m_entry, task) )
+			{
+				svDirtyTasks.push_back(task);
+				numShadowVolumeEdges += task.m_group->m_numEdges;
+			}
+		}
+		numShadowVolumesCached = numShadowVolumes - uint32_t(svDirtyTasks.size() );
+
+		if (!svDirtyTasks.empty() )
+		{
+			svTime = bx::getHPCounter();
+			shadowVolumeExtract(&svDirtyTasks[0], uint32_t(svDirtyTasks.size() ), uint32_t(settings_numThreads) );
+			svTime = bx::getHPCounter() - svTime;
+
+			for (uint32_t ii = 0, num = uint32_t(svDirtyTasks.size() ); ii < num; ++ii)
+			{
+				const ShadowVolumeTask& task = svDirtyTasks[ii];
+				ShadowVolumeCacheEntry& entry = *task.m_entry;
+				shadowVolumeCreate(entry.m_volume, task);
+				entry.m_group = task.m_group;
+				memcpy(entry.m_light, task.m_light, 3*sizeof(float) );
+				entry.m_impl = task.m_impl;
+				entry.m_algo = task.m_algo;
+				entry.m_textureAsStencil = task.m_textureAsStencil;
+			}
+		}
+		else
+		{
+			svTime = 0;
+		}
+
+		/**
+		 * For each light:
+		 * 1. Compute and draw shadow volume to stencil buffer
+		 * 2. Draw diffuse with stencil test
+		 */
+		for (uint8_t ii = 0, viewId = VIEWID_RANGE15_PASS2; ii < settings_numLights; ++ii, ++viewId)
+		{
+			memcpy(s_uniforms.m_lightPosRadius, lightPosRadius[ii], 4*sizeof(float) );
+			memcpy(s_uniforms.m_lightRgbInnerR, lightRgbInnerR[ii], 3*sizeof(float) );
+			memcpy(s_uniforms.m_color,          lightRgbInnerR[ii], 3*sizeof(float) );
+
+			if (settings_useStencilTexture)
+			{
+				bgfx::setViewRenderTarget(viewId, s_stencilRt);
+
+				bgfx::setViewClear(viewId
+						, BGFX_CLEAR_COLOR_BIT
+						, 0x00000000
+						, 1.0f
+						, 0
+						);
+			}
+			else
+			{
+				const bgfx::RenderTargetHandle invalidRt = BGFX_INVALID_HANDLE;
+				bgfx::setViewRenderTarget(viewId, invalidRt);
+
+				bgfx::setViewClear(viewId
+						, BGFX_CLEAR_STENCIL_BIT
+						, clearValues.m_clearRgba
+						, clearValues.m_clearDepth
+						, clearValues.m_clearStencil
 						);
+			}
+
+			for (uint8_t jj = 0; jj < shadowCastersCount[currentScene]; ++jj)
+			{
+				const Instance& instance = shadowCasters[currentScene][jj];
+				Model* model = instance.m_model;
+
+				const ShadowVolumeInstance& svInstance = svInstances[ii*shadowCastersCount[currentScene] + jj];
+				const ShadowVolumeImpl::Enum shadowVolumeImpl = svInstance.m_impl;
+				s_uniforms.m_svparams.m_dfail = float(ShadowVolumeImpl::DepthFail == shadowVolumeImpl);
+
+				// Set virtual light pos.
+				memcpy(s_uniforms.m_virtualLightPos_extrusionDist, svInstance.m_lightPos, 3*sizeof(float) );
+				s_uniforms.m_virtualLightPos_extrusionDist[3] = instance.m_svExtrusionDistance;
+
+				const float* shadowVolumeMtx = svInstance.m_mtx;
+
+				GroupArray& groups = model->m_mesh.m_groups;
+				for (uint32_t kk = 0, num = uint32_t(groups.size() ); kk < num; ++kk)
+				{
+					Group& group = groups[kk];
+					ShadowVolume& shadowVolume = svTasks[svInstance.m_firstTask + kk].m_entry->m_volume;
+					shadowVolume.m_mtx      = shadowVolumeMtx;
+					shadowVolume.m_lightPos = svInstance.m_lightPos;
 
 					numShadowVolumeVertices += shadowVolume.m_numVertices;
 					numShadowVolumeIndices += shadowVolume.m_numIndices;
@@ -2893,7 +3253,10 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		bgfx::frame();
 
 		// Swap memory pages.
-		s_svAllocator.swap();
+		for (uint32_t ii = 0; ii < SV_MAX_THREADS; ++ii)
+		{
+			s_svWorkers[ii].m_allocator.swap();
+		}
 
 		// Reset clear values.
 		bgfx::setViewClearMask(UINT32_MAX
@@ -2905,6 +3268,8 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	}
 
 	// Cleanup
+	shadowVolumeCacheClear(svCache);
+
 	bunnyLowPolyModel.unload();
 	bunnyHighPolyModel.unload();
 	columnModel.unload();
@@ -15,6 +15,7 @@
 #include "entry/entry.h"
 #include "entry/camera.h"
 #include "fpumath.h"
+#include "meshloader.h"
 #include "imgui/imgui.h"
 
 #define RENDER_PASS_0 1
@@ -982,11 +983,13 @@ struct Group
 	void reset()
 	{
 		m_vbh.idx = bgfx::invalidHandle;
+		m_vbhStream.idx = bgfx::invalidHandle;
 		m_ibh.idx = bgfx::invalidHandle;
 		m_prims.clear();
 	}
 
-	bgfx::VertexBufferHandle m_vbh;
+	bgfx::VertexBufferHandle m_vbh;       // Positions, vertex stream 0.
+	bgfx::VertexBufferHandle m_vbhStream; // Remaining attributes, vertex stream 1.
 	bgfx::IndexBufferHandle m_ibh;
 	Sphere m_sphere;
 	Aabb m_aabb;
@@ -996,16 +999,53 @@ struct Group
 
 struct Mesh
 {
+	// Split vertices into position stream, which is all shadow map passes
+	// fetch, and stream of remaining attributes.
+	static void createVertexStreams(Group& _group, const void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl)
+	{
+		bgfx::VertexDecl posDecl;
+		bgfx::VertexDecl attrDecl;
+		posDecl.begin();
+		attrDecl.begin();
+
+		for (uint32_t attr = 0; attr < bgfx::Attrib::Count; ++attr)
+		{
+			if (_decl.has(bgfx::Attrib::Enum(attr) ) )
+			{
+				uint8_t num;
+				bgfx::AttribType::Enum type;
+				bool normalized;
+				bool asInt;
+				_decl.decode(bgfx::Attrib::Enum(attr), num, type, normalized, asInt);
+
+				bgfx::VertexDecl& decl = bgfx::Attrib::Position == attr ? posDecl : attrDecl;
+				decl.add(bgfx::Attrib::Enum(attr), num, type, normalized, asInt);
+			}
+		}
+
+		posDecl.end();
+		attrDecl.end();
+
+		const bgfx::Memory* mem = bgfx::alloc(_numVertices*posDecl.getStride() );
+		bgfx::vertexConvert(posDecl, mem->data, _decl, _vertices, _numVertices);
+		_group.m_vbh = bgfx::createVertexBuffer(mem, posDecl);
+
+		if (0 < attrDecl.getStride() )
+		{
+			mem = bgfx::alloc(_numVertices*attrDecl.getStride() );
+			bgfx::vertexConvert(attrDecl, mem->data, _decl, _vertices, _numVertices);
+			_group.m_vbhStream = bgfx::createVertexBuffer(mem, attrDecl);
+		}
+	}
+
 	void load(const void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl _decl, const uint16_t* _indices, uint32_t _numIndices)
 	{
 		Group group;
+		createVertexStreams(group, _vertices, _numVertices, _decl);
+
 		const bgfx::Memory* mem;
 		uint32_t size;
 
-		size = _numVertices*_decl.getStride();
-		mem = bgfx::makeRef(_vertices, size);
-		group.m_vbh = bgfx::createVertexBuffer(mem, _decl);
-
 		size = _numIndices*2;
 		mem = bgfx::makeRef(_indices, size);
 		group.m_ibh = bgfx::createIndexBuffer(mem);
@@ -1021,46 +1061,48 @@ struct Mesh
 
 	void load(const char* _filePath)
 	{
-#define BGFX_CHUNK_MAGIC_VB BX_MAKEFOURCC('V', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_IB BX_MAKEFOURCC('I', 'B', ' ', 0x0)
-#define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
-
 		bx::CrtFileReader reader;
 		reader.open(_filePath);
 
 		Group group;
+		std::vector<uint8_t> vertices;
+		uint32_t numVertices = 0;
 
 		uint32_t chunk;
-		while (4 == bx::read(&reader, chunk) )
+		bool ok = true;
+		while (ok && 4 == bx::read(&reader, chunk) )
 		{
 			switch (chunk)
 			{
 			case BGFX_CHUNK_MAGIC_VB:
+			case BGFX_CHUNK_MAGIC_VB32:
+			case BGFX_CHUNK_MAGIC_VBC:
 				{
 					bx::read(&reader, group.m_sphere);
 					bx::read(&reader, group.m_aabb);
 					bx::read(&reader, group.m_obb);
 
-					bx::read(&reader, m_decl);
-					uint16_t stride = m_decl.getStride();
-
-					uint16_t numVertices;
-					bx::read(&reader, numVertices);
-					const bgfx::Memory* mem = bgfx::alloc(numVertices*stride);
-					bx::read(&reader, mem->data, mem->size);
-
-					group.m_vbh = bgfx::createVertexBuffer(mem, m_decl);
+					// Vertex buffers are created with primitives, once it's
+					// known whether file already has separate vertex stream.
+					ok = meshReadVertexHeader(&reader, chunk, m_decl, numVertices);
+					if (ok)
+					{
+						vertices.resize(numVertices*m_decl.getStride() );
+						ok = meshReadVertexData(&reader, chunk, &vertices[0], numVertices, m_decl);
+					}
 				}
 				break;
 
+			case BGFX_CHUNK_MAGIC_VBS:
+				ok = meshLoadVertexStream(&reader, group.m_vbhStream);
+				break;
+
 			case BGFX_CHUNK_MAGIC_IB:
-				{
-					uint32_t numIndices;
-					bx::read(&reader, numIndices);
-					const bgfx::Memory* mem = bgfx::alloc(numIndices*2);
-					bx::read(&reader, mem->data, mem->size);
-					group.m_ibh = bgfx::createIndexBuffer(mem);
-				}
+			case BGFX_CHUNK_MAGIC_IB32:
+			case BGFX_CHUNK_MAGIC_IBC:
+			case BGFX_CHUNK_MAGIC_IBC32:
+				group.m_ibh = meshLoadIndexBuffer(&reader, chunk);
+				ok = bgfx::isValid(group.m_ibh);
 				break;
 
 			case BGFX_CHUNK_MAGIC_PRI:
@@ -1095,6 +1137,17 @@ struct Mesh
 						group.m_prims.push_back(prim);
 					}
 
+					if (bgfx::invalidHandle != group.m_vbhStream.idx)
+					{
+						const bgfx::Memory* mem = bgfx::alloc(uint32_t(vertices.size() ) );
+						memcpy(mem->data, &vertices[0], mem->size);
+						group.m_vbh = bgfx::createVertexBuffer(mem, m_decl);
+					}
+					else
+					{
+						createVertexStreams(group, &vertices[0], numVertices, m_decl);
+					}
+
 					m_groups.push_back(group);
 					group.reset();
 				}
@@ -1106,6 +1159,27 @@ struct Mesh
 			}
 		}
 
+		if (!ok)
+		{
+			DBG("Failed to load %s, chunk %08x is corrupt.", _filePath, chunk);
+
+			// Buffers of incomplete group are not owned by any group yet.
+			if (bgfx::isValid(group.m_vbh) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbh);
+			}
+
+			if (bgfx::isValid(group.m_ibh) )
+			{
+				bgfx::destroyIndexBuffer(group.m_ibh);
+			}
+
+			if (bgfx::isValid(group.m_vbhStream) )
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+		}
+
 		reader.close();
 	}
 
@@ -1116,6 +1190,11 @@ struct Mesh
 			const Group& group = *it;
 			bgfx::destroyVertexBuffer(group.m_vbh);
 
+			if (bgfx::invalidHandle != group.m_vbhStream.idx)
+			{
+				bgfx::destroyVertexBuffer(group.m_vbhStream);
+			}
+
 			if (bgfx::invalidHandle != group.m_ibh.idx)
 			{
 				bgfx::destroyIndexBuffer(group.m_ibh);
@@ -1145,6 +1224,11 @@ struct Mesh
 			bgfx::setIndexBuffer(group.m_ibh);
 			bgfx::setVertexBuffer(group.m_vbh);
 
+			if (bgfx::invalidHandle != group.m_vbhStream.idx)
+			{
+				bgfx::setVertexStream(1, group.m_vbhStream);
+			}
+
 			// Set textures.
 			if (bgfx::invalidHandle != _texture.idx)
 			{
@@ -1165,6 +1249,31 @@ struct Mesh
 		}
 	}
 
+	// Shadow map passes fetch positions only, and don't sample textures.
+	void submitDepth(uint8_t _viewId, float* _mtx, bgfx::ProgramHandle _program, const RenderState& _renderState)
+	{
+		for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+		{
+			const Group& group = *it;
+
+			// Set uniforms.
+			s_uniforms.submitPerDrawUniforms();
+
+			// Set model matrix for rendering.
+			bgfx::setTransform(_mtx);
+			bgfx::setProgram(_program);
+			bgfx::setIndexBuffer(group.m_ibh);
+			bgfx::setVertexBuffer(group.m_vbh);
+
+			// Apply render state.
+			bgfx::setStencil(_renderState.m_fstencil, _renderState.m_bstencil);
+			bgfx::setState(_renderState.m_state, _renderState.m_blendFactorRgba);
+
+			// Submit.
+			bgfx::submit(_viewId);
+		}
+	}
+
 	bgfx::VertexDecl m_decl;
 	typedef std::vector<Group> GroupArray;
 	GroupArray m_groups;
@@ -2915,28 +3024,28 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 				}
 
 				// Floor.
-				hplaneMesh.submit(viewId
+				hplaneMesh.submitDepth(viewId
 						, mtxFloor
 						, *currentSmSettings->m_progPack
 						, s_renderStates[renderStateIndex]
 						);
 
 				// Bunny.
-				bunnyMesh.submit(viewId
+				bunnyMesh.submitDepth(viewId
 						, mtxBunny
 						, *currentSmSettings->m_progPack
 						, s_renderStates[renderStateIndex]
 						);
 
 				// Hollow cube.
-				hollowcubeMesh.submit(viewId
+				hollowcubeMesh.submitDepth(viewId
 						, mtxHollowcube
 						, *currentSmSettings->m_progPack
 						, s_renderStates[renderStateIndex]
 						);
 
 				// Cube.
-				cubeMesh.submit(viewId
+				cubeMesh.submitDepth(viewId
 						, mtxCube
 						, *currentSmSettings->m_progPack
 						, s_renderStates[renderStateIndex]
@@ -2945,7 +3054,7 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 				// Trees.
 				for (uint8_t ii = 0; ii < numTrees; ++ii)
 				{
-					treeMesh.submit(viewId
+					treeMesh.submitDepth(viewId
 							, mtxTrees[ii]
 							, *currentSmSettings->m_progPack
 							, s_renderStates[renderStateIndex]
@@ -59,6 +59,28 @@ static const uint16_t s_cubeIndices[36] =
 	6, 3, 7,
 };
 
+static void submitPerCall(uint32_t _num, const float* _mtx, bgfx::ProgramHandle _program, bgfx::VertexBufferHandle _vbh, bgfx::IndexBufferHandle _ibh)
+{
+	for (uint32_t ii = 0; ii < _num; ++ii)
+	{
+		// Set model matrix for rendering.
+		bgfx::setTransform(&_mtx[ii*16]);
+
+		// Set vertex and fragment shaders.
+		bgfx::setProgram(_program);
+
+		// Set vertex and index buffer.
+		bgfx::setVertexBuffer(_vbh);
+		bgfx::setIndexBuffer(_ibh);
+
+		// Set render states.
+		bgfx::setState(BGFX_STATE_DEFAULT);
+
+		// Submit primitive for rendering to view 0.
+		bgfx::submit(0);
+	}
+}
+
 int _main_(int /*_argc*/, char** /*_argv*/)
 {
 	uint32_t width = 1280;
@@ -136,6 +158,32 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 	int32_t scrollArea = 0;
 	int32_t dim = 16;
 	uint32_t transform = 0;
+	uint32_t submitMode = 0;
+
+	// Per draw call arrays used by both submit paths.
+	const uint32_t maxDim = 40;
+	const uint32_t maxDrawCalls = maxDim*maxDim*maxDim;
+	float* mtxArray = new float[maxDrawCalls*16];
+	bgfx::ProgramHandle* programArray = new bgfx::ProgramHandle[maxDrawCalls];
+	bgfx::VertexBufferHandle* vbhArray = new bgfx::VertexBufferHandle[maxDrawCalls];
+	bgfx::IndexBufferHandle* ibhArray = new bgfx::IndexBufferHandle[maxDrawCalls];
+	uint64_t* stateArray = new uint64_t[maxDrawCalls];
+
+	for (uint32_t ii = 0; ii < maxDrawCalls; ++ii)
+	{
+		programArray[ii] = program;
+		vbhArray[ii] = vbh;
+		ibhArray[ii] = ibh;
+		stateArray[ii] = BGFX_STATE_DEFAULT;
+	}
+
+	// Draw list is recorded again only when number of draw calls or
+	// transform mode changes.
+	bgfx::DrawListHandle drawList = bgfx::createDrawList();
+	int32_t drawListDim = 0;
+	uint32_t drawListTransform = UINT32_MAX;
+
+	int64_t submitTime = 0;
 
 	entry::MouseState mouseState;
 
@@ -164,7 +212,7 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 			{
 				if (deltaTimeAvgNs < 1000000/65)
 				{
-					dim = bx::uint32_min(dim + 2, 40);
+					dim = bx::uint32_min(dim + 2, maxDim);
 				}
 				else if (deltaTimeAvgNs > 1000000/57)
 				{
@@ -200,14 +248,22 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 			);
 		imguiSeparatorLine();
 
+		submitMode = imguiChoose(submitMode
+			, "Submit per call"
+			, "Submit arrays"
+			, "Submit draw list (static)"
+			);
+		imguiSeparatorLine();
+
 		if (imguiCheck("Auto adjust", autoAdjust) )
 		{
 			autoAdjust ^= true;
 		}
 
-		imguiSlider("Dim", &dim, 5, 40);
+		imguiSlider("Dim", &dim, 5, maxDim);
 		imguiLabel("Draw calls: %d", dim*dim*dim);
 		imguiLabel("Avg Delta Time (1 second) [ms]: %0.4f", deltaTimeAvgNs/1000.0f);
+		imguiLabel("Submit [ms]: %0.4f", double(submitTime)*toMs);
 
 		imguiEndScrollArea();
 		imguiEndFrame();
@@ -246,6 +302,9 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 		pos[1] = -step*dim / 2.0f;
 		pos[2] = -15.0;
 
+		const uint32_t numDrawCalls = dim*dim*dim;
+
+		float* mtx = mtxArray;
 		for (uint32_t zz = 0; zz < uint32_t(dim); ++zz)
 		{
 			for (uint32_t yy = 0; yy < uint32_t(dim); ++yy)
@@ -255,39 +314,73 @@ int _main_(int /*_argc*/, char** /*_argv*/)
 					float mtxR[16];
 					mtxRotateXYZ(mtxR, time + xx*0.21f, time + yy*0.37f, time + yy*0.13f);
 
-					float mtx[16];
 					mtxMul(mtx, mtxS, mtxR);
 
 					mtx[12] = pos[0] + float(xx)*step;
 					mtx[13] = pos[1] + float(yy)*step;
 					mtx[14] = pos[2] + float(zz)*step;
 
-					// Set model matrix for rendering.
-					bgfx::setTransform(mtx);
+					mtx += 16;
+				}
+			}
+		}
 
-					// Set vertex and fragment shaders.
-					bgfx::setProgram(program);
+		// Draw list replays transforms recorded with it, so cubes are not
+		// animated while draw list is used.
+		if (2 == submitMode
+		&& (drawListDim != dim || drawListTransform != transform) )
+		{
+			bgfx::beginDrawList(drawList);
+			submitPerCall(numDrawCalls, mtxArray, program, vbh, ibh);
+			bgfx::endDrawList();
 
-					// Set vertex and index buffer.
-					bgfx::setVertexBuffer(vbh);
-					bgfx::setIndexBuffer(ibh);
+			drawListDim = dim;
+			drawListTransform = transform;
+		}
 
-					// Set render states.
-					bgfx::setState(BGFX_STATE_DEFAULT);
+		// Only submission is timed, so that all paths can be compared.
+		submitTime = bx::getHPCounter();
 
-					// Submit primitive for rendering to view 0.
-					bgfx::submit(0);
-				}
-			}
+		if (0 == submitMode)
+		{
+			submitPerCall(numDrawCalls, mtxArray, program, vbh, ibh);
+		}
+		else if (2 == submitMode)
+		{
+			// Submit all recorded primitives for rendering to view 0.
+			bgfx::submit(0, drawList);
+		}
+		else
+		{
+			bgfx::SubmitArrays arrays;
+			memset(&arrays, 0, sizeof(arrays) );
+			arrays.num = numDrawCalls;
+			arrays.program = programArray;
+			arrays.state = stateArray;
+			arrays.mtx = mtxArray;
+			arrays.vertexBuffer = vbhArray;
+			arrays.indexBuffer = ibhArray;
+
+			// Submit all primitives for rendering to view 0.
+			bgfx::submit(0, arrays);
 		}
 
+		submitTime = bx::getHPCounter() - submitTime;
+
 		// Advance to next frame. Rendering thread will be kicked to 
 		// process submitted rendering primitives.
 		bgfx::frame();
 	}
 
+	delete [] stateArray;
+	delete [] ibhArray;
+	delete [] vbhArray;
+	delete [] programArray;
+	delete [] mtxArray;
+
 	// Cleanup.
 	imguiDestroy();
+	bgfx::destroyDrawList(drawList);
 	bgfx::destroyIndexBuffer(ibh);
 	bgfx::destroyVertexBuffer(vbh);
 	bgfx::destroyProgram(program);
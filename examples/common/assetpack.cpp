@@ -0,0 +1,223 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "assetpack.h"
+
+#include <bx/hash.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if BX_PLATFORM_WINDOWS
+#	include <windows.h>
+#elif BX_PLATFORM_NACL || BX_PLATFORM_EMSCRIPTEN
+	// Memory mapping is not available, pack is read into memory.
+#else
+#	define ASSETPACK_MMAP 1
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif // BX_PLATFORM_
+
+uint32_t assetPackHash(const char* _name)
+{
+	return bx::hashMurmur2A(_name, (uint32_t)strlen(_name) );
+}
+
+AssetPack::AssetPack()
+	: m_data(NULL)
+	, m_header(NULL)
+	, m_toc(NULL)
+	, m_size(0)
+#if BX_PLATFORM_WINDOWS
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(NULL)
+#endif // BX_PLATFORM_WINDOWS
+	, m_mapped(false)
+{
+}
+
+AssetPack::~AssetPack()
+{
+	close();
+}
+
+bool AssetPack::open(const char* _filePath)
+{
+	close();
+
+#if BX_PLATFORM_WINDOWS
+	m_file = CreateFileA(_filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (INVALID_HANDLE_VALUE == m_file)
+	{
+		return false;
+	}
+
+	m_size = GetFileSize(m_file, NULL);
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL != m_mapping)
+	{
+		m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	m_mapped = true;
+#elif ASSETPACK_MMAP
+	int fd = ::open(_filePath, O_RDONLY);
+	if (-1 == fd)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (0 == fstat(fd, &st) )
+	{
+		m_size = (uint32_t)st.st_size;
+		void* ptr = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		m_data = MAP_FAILED == ptr ? NULL : (const uint8_t*)ptr;
+	}
+	::close(fd);
+	m_mapped = true;
+#else
+	FILE* file = fopen(_filePath, "rb");
+	if (NULL == file)
+	{
+		return false;
+	}
+
+	fseek(file, 0L, SEEK_END);
+	m_size = (uint32_t)ftell(file);
+	fseek(file, 0L, SEEK_SET);
+	uint8_t* data = (uint8_t*)malloc(m_size);
+	size_t read = fread(data, 1, m_size, file);
+	fclose(file);
+	m_data = read == m_size ? data : NULL;
+	if (NULL == m_data)
+	{
+		free(data);
+	}
+	m_mapped = false;
+#endif // BX_PLATFORM_
+
+	if (NULL == m_data
+	||  sizeof(AssetPackHeader) > m_size)
+	{
+		close();
+		return false;
+	}
+
+	m_header = (const AssetPackHeader*)m_data;
+	if (ASSETPACK_MAGIC != m_header->magic
+	||  ASSETPACK_VERSION != m_header->version
+	||  m_size < m_header->size)
+	{
+		close();
+		return false;
+	}
+
+	// Table of contents and every entry must be inside of pack, so that
+	// truncated or corrupt pack can't be read out of bounds.
+	const uint64_t tocEnd = uint64_t(m_header->tocOffset) + uint64_t(m_header->numEntries)*sizeof(AssetPackEntry);
+	if (0 != m_header->tocOffset % ASSETPACK_ALIGN
+	||  tocEnd > m_size)
+	{
+		close();
+		return false;
+	}
+
+	m_toc = (const AssetPackEntry*)(m_data + m_header->tocOffset);
+
+	for (uint32_t ii = 0, num = m_header->numEntries; ii < num; ++ii)
+	{
+		const AssetPackEntry& entry = m_toc[ii];
+
+		// Asset is followed by zero terminator, name is zero terminated.
+		if (uint64_t(entry.offset) + uint64_t(entry.size) >= m_size
+		||  entry.name >= m_size
+		||  NULL == memchr(m_data + entry.name, 0, m_size - entry.name) )
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void AssetPack::close()
+{
+	if (NULL != m_data)
+	{
+#if BX_PLATFORM_WINDOWS
+		UnmapViewOfFile(m_data);
+#elif ASSETPACK_MMAP
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#else
+		free(const_cast<uint8_t*>(m_data) );
+#endif // BX_PLATFORM_
+	}
+
+#if BX_PLATFORM_WINDOWS
+	if (NULL != m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = NULL;
+	}
+
+	if (INVALID_HANDLE_VALUE != m_file)
+	{
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#endif // BX_PLATFORM_WINDOWS
+
+	m_data = NULL;
+	m_header = NULL;
+	m_toc = NULL;
+	m_size = 0;
+	m_mapped = false;
+}
+
+const void* AssetPack::find(const char* _name, uint32_t& _size) const
+{
+	_size = 0;
+
+	if (NULL == m_header)
+	{
+		return NULL;
+	}
+
+	const uint32_t hash = assetPackHash(_name);
+
+	// Lower bound binary search, table of contents is sorted by hash.
+	uint32_t first = 0;
+	uint32_t count = m_header->numEntries;
+	while (0 < count)
+	{
+		const uint32_t step = count/2;
+		const uint32_t mid = first + step;
+		if (m_toc[mid].hash < hash)
+		{
+			first = mid + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	for (uint32_t ii = first, num = m_header->numEntries; ii < num && hash == m_toc[ii].hash; ++ii)
+	{
+		const AssetPackEntry& entry = m_toc[ii];
+		if (0 == strcmp(_name, (const char*)m_data + entry.name) )
+		{
+			_size = entry.size;
+			return m_data + entry.offset;
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef ASSETPACK_H_HEADER_GUARD
+#define ASSETPACK_H_HEADER_GUARD
+
+#include <bx/bx.h>
+#include <bgfx.h>
+
+#define ASSETPACK_MAGIC BX_MAKEFOURCC('P', 'A', 'K', 0x0)
+#define ASSETPACK_VERSION 1
+
+/// Alignment of table of contents and of every asset inside pack.
+#define ASSETPACK_ALIGN 16
+
+/// Pack layout:
+///
+///   AssetPackHeader
+///   AssetPackEntry[numEntries] sorted by name hash
+///   name strings, zero terminated
+///   asset data, each asset aligned to ASSETPACK_ALIGN and followed by at
+///     least one zero byte
+///
+struct AssetPackHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numEntries;
+	uint32_t tocOffset;
+	uint32_t namesOffset;
+	uint32_t size;
+};
+
+struct AssetPackEntry
+{
+	uint32_t hash;
+	uint32_t name;
+	uint32_t offset;
+	uint32_t size;
+};
+
+/// Read-only view of asset pack. Pack file is memory mapped, and assets
+/// are returned without copying.
+///
+class AssetPack
+{
+public:
+	AssetPack();
+	~AssetPack();
+
+	/// Map pack file into memory.
+	bool open(const char* _filePath);
+
+	/// Unmap pack file. All pointers and references returned from pack
+	/// become invalid.
+	void close();
+
+	/// Find asset by name.
+	///
+	/// @param _name Asset path as it was passed to packc.
+	/// @param _size Returns asset size in bytes.
+	/// @returns Pointer to asset data or NULL if asset is not found.
+	///
+	const void* find(const char* _name, uint32_t& _size) const;
+
+	/// Returns reference to asset data, or NULL if asset is not found.
+	///
+	/// NOTE:
+	///   Referenced size includes zero terminator, same as files loaded
+	///   by examples. Pack must stay open until bgfx is done with
+	///   reference (at least 2 frames).
+	///
+	const bgfx::Memory* makeRef(const char* _name) const
+	{
+		uint32_t size;
+		const void* data = find(_name, size);
+		if (NULL != data)
+		{
+			return bgfx::makeRef(data, size+1);
+		}
+
+		return NULL;
+	}
+
+	uint32_t getNumEntries() const
+	{
+		return NULL == m_header ? 0 : m_header->numEntries;
+	}
+
+	const char* getName(uint32_t _idx) const
+	{
+		return (const char*)m_data + m_toc[_idx].name;
+	}
+
+	uint32_t getSize(uint32_t _idx) const
+	{
+		return m_toc[_idx].size;
+	}
+
+	const void* getData(uint32_t _idx) const
+	{
+		return m_data + m_toc[_idx].offset;
+	}
+
+private:
+	const uint8_t* m_data;
+	const AssetPackHeader* m_header;
+	const AssetPackEntry* m_toc;
+	uint32_t m_size;
+#if BX_PLATFORM_WINDOWS
+	void* m_file;
+	void* m_mapping;
+#endif // BX_PLATFORM_WINDOWS
+	bool m_mapped;
+};
+
+/// Returns hash of asset name stored in pack.
+uint32_t assetPackHash(const char* _name);
+
+#endif // ASSETPACK_H_HEADER_GUARD
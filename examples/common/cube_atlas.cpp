@@ -5,6 +5,7 @@
 
 #include "common.h"
 #include <bgfx.h>
+#include <bx/readerwriter.h>
 
 #include <limits.h> // INT_MAX
 #include <memory.h> // memset
@@ -43,6 +44,18 @@ public:
 	/// reset to initial state
 	void clear();
 
+	/// write packing state, to be restored with read
+	void write(bx::WriterI* _writer) const;
+
+	/// restore packing state written by write
+	void read(bx::ReaderI* _reader);
+
+	/// return the byte size of the packing state written by write
+	uint32_t getWriteSize() const
+	{
+		return 8 + (uint32_t)m_skyline.size() * 8;
+	}
+
 private:
 	int32_t fit(uint32_t _skylineNodeIndex, uint16_t _width, uint16_t _height);
 
@@ -190,6 +203,37 @@ void RectanglePacker::clear()
 	m_skyline.push_back(Node(1, 1, m_width - 2) );
 }
 
+void RectanglePacker::write(bx::WriterI* _writer) const
+{
+	bx::write(_writer, m_usedSpace);
+	bx::write(_writer, (uint32_t)m_skyline.size() );
+
+	for (uint32_t ii = 0, num = (uint32_t)m_skyline.size(); ii < num; ++ii)
+	{
+		const Node& node = m_skyline[ii];
+		bx::write(_writer, node.x);
+		bx::write(_writer, node.y);
+		bx::write(_writer, node.width);
+	}
+}
+
+void RectanglePacker::read(bx::ReaderI* _reader)
+{
+	uint32_t num;
+	bx::read(_reader, m_usedSpace);
+	bx::read(_reader, num);
+
+	m_skyline.clear();
+	for (uint32_t ii = 0; ii < num; ++ii)
+	{
+		Node node(0, 0, 0);
+		bx::read(_reader, node.x);
+		bx::read(_reader, node.y);
+		bx::read(_reader, node.width);
+		m_skyline.push_back(node);
+	}
+}
+
 int32_t RectanglePacker::fit(uint32_t _skylineNodeIndex, uint16_t _width, uint16_t _height)
 {
 	int32_t width = _width;
@@ -258,6 +302,7 @@ Atlas::Atlas(uint16_t _textureSize, uint16_t _maxRegionsCount)
 	, m_textureSize(_textureSize)
 	, m_regionCount(0)
 	, m_maxRegionCount(_maxRegionsCount)
+	, m_ownTextureBuffer(true)
 {
 	BX_CHECK(_textureSize >= 64 && _textureSize <= 4096, "Invalid _textureSize %d.", _textureSize);
 	BX_CHECK(_maxRegionsCount >= 64 && _maxRegionsCount <= 32000, "Invalid _maxRegionsCount %d.", _maxRegionsCount);
@@ -281,11 +326,13 @@ Atlas::Atlas(uint16_t _textureSize, uint16_t _maxRegionsCount)
 }
 
 Atlas::Atlas(uint16_t _textureSize, const uint8_t* _textureBuffer, uint16_t _regionCount, const uint8_t* _regionBuffer, uint16_t _maxRegionsCount)
-	: m_usedLayers(24)
+	: m_layers(NULL)
+	, m_usedLayers(24)
 	, m_usedFaces(6)
 	, m_textureSize(_textureSize)
 	, m_regionCount(_regionCount)
 	, m_maxRegionCount(_regionCount < _maxRegionsCount ? _regionCount : _maxRegionsCount)
+	, m_ownTextureBuffer(true)
 {
 	BX_CHECK(_regionCount <= 64 && _maxRegionsCount <= 4096, "_regionCount %d, _maxRegionsCount %d", _regionCount, _maxRegionsCount);
 
@@ -305,17 +352,94 @@ Atlas::Atlas(uint16_t _textureSize, const uint8_t* _textureBuffer, uint16_t _reg
 		);
 }
 
+Atlas::Atlas(bx::ReaderI* _reader, const uint8_t* _textureBuffer)
+	: m_ownTextureBuffer(false)
+{
+	uint16_t padding;
+	bx::read(_reader, m_textureSize);
+	bx::read(_reader, m_maxRegionCount);
+	bx::read(_reader, m_regionCount);
+	bx::read(_reader, padding);
+	bx::read(_reader, m_usedLayers);
+	bx::read(_reader, m_usedFaces);
+
+	BX_CHECK(m_textureSize >= 64 && m_textureSize <= 4096, "Invalid _textureSize %d.", m_textureSize);
+	BX_CHECK(m_regionCount <= m_maxRegionCount, "m_regionCount %d, m_maxRegionCount %d", m_regionCount, m_maxRegionCount);
+
+	init();
+
+	m_layers = new PackedLayer[24];
+	for (int ii = 0; ii < 24; ++ii)
+	{
+		m_layers[ii].packer.init(m_textureSize, m_textureSize);
+		bx::read(_reader, m_layers[ii].faceRegion);
+		m_layers[ii].packer.read(_reader);
+	}
+
+	m_regions = new AtlasRegion[m_maxRegionCount];
+	bx::read(_reader, m_regions, m_regionCount * sizeof(AtlasRegion) );
+
+	m_textureBuffer = const_cast<uint8_t*>(_textureBuffer);
+
+	m_textureHandle = bgfx::createTextureCube(m_textureSize
+		, 1
+		, bgfx::TextureFormat::BGRA8
+		, BGFX_TEXTURE_NONE
+		, bgfx::makeRef(m_textureBuffer, getTextureBufferSize() )
+		);
+}
+
 Atlas::~Atlas()
 {
 	bgfx::destroyTexture(m_textureHandle);
 
 	delete [] m_layers;
 	delete [] m_regions;
-	delete [] m_textureBuffer;
+
+	if (m_ownTextureBuffer)
+	{
+		delete [] m_textureBuffer;
+	}
+}
+
+uint32_t Atlas::getStateSize() const
+{
+	uint32_t size = 16 + m_regionCount * sizeof(AtlasRegion);
+	for (int ii = 0; ii < 24; ++ii)
+	{
+		size += sizeof(AtlasRegion) + m_layers[ii].packer.getWriteSize();
+	}
+
+	return size;
+}
+
+void Atlas::writeState(bx::WriterI* _writer) const
+{
+	BX_CHECK(NULL != m_layers, "Static atlas can't be written.");
+
+	uint16_t padding = 0;
+	bx::write(_writer, m_textureSize);
+	bx::write(_writer, m_maxRegionCount);
+	bx::write(_writer, m_regionCount);
+	bx::write(_writer, padding);
+	bx::write(_writer, m_usedLayers);
+	bx::write(_writer, m_usedFaces);
+
+	for (int ii = 0; ii < 24; ++ii)
+	{
+		bx::write(_writer, m_layers[ii].faceRegion);
+		m_layers[ii].packer.write(_writer);
+	}
+
+	bx::write(_writer, m_regions, m_regionCount * sizeof(AtlasRegion) );
 }
 
 void Atlas::init()
 {
+	memset(m_numDirtyRects, 0, sizeof(m_numDirtyRects) );
+	m_numUpdates = 0;
+	m_uploadSize = 0;
+
 	m_texelSize = float(UINT16_MAX) / float(m_textureSize);
 	float texelHalf = m_texelSize/2.0f;
 	switch (bgfx::getRendererType())
@@ -404,27 +528,29 @@ uint16_t Atlas::addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bit
 
 void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer)
 {
-	const bgfx::Memory* mem = bgfx::alloc(_region.width * _region.height * 4);
-	memset(mem->data, 0, mem->size);
-	if (_region.getType() == AtlasRegion::TYPE_BGRA8)
+	if (!m_ownTextureBuffer)
 	{
-		const uint8_t* inLineBuffer = _bitmapBuffer;
-		uint8_t* outLineBuffer = m_textureBuffer + _region.getFaceIndex() * (m_textureSize * m_textureSize * 4) + ( ( (_region.y * m_textureSize) + _region.x) * 4);
+		uint8_t* textureBuffer = new uint8_t[getTextureBufferSize()];
+		memcpy(textureBuffer, m_textureBuffer, getTextureBufferSize() );
+		m_textureBuffer = textureBuffer;
+		m_ownTextureBuffer = true;
+	}
 
+	const uint8_t* inLineBuffer = _bitmapBuffer;
+	uint8_t* outLineBuffer = m_textureBuffer + _region.getFaceIndex() * (m_textureSize * m_textureSize * 4) + ( ( (_region.y * m_textureSize) + _region.x) * 4);
+
+	if (_region.getType() == AtlasRegion::TYPE_BGRA8)
+	{
 		for (int yy = 0; yy < _region.height; ++yy)
 		{
 			memcpy(outLineBuffer, inLineBuffer, _region.width * 4);
 			inLineBuffer += _region.width * 4;
 			outLineBuffer += m_textureSize * 4;
 		}
-
-		memcpy(mem->data, _bitmapBuffer, mem->size);
 	}
 	else
 	{
 		uint32_t layer = _region.getComponentIndex();
-		const uint8_t* inLineBuffer = _bitmapBuffer;
-		uint8_t* outLineBuffer = (m_textureBuffer + _region.getFaceIndex() * (m_textureSize * m_textureSize * 4) + ( ( (_region.y * m_textureSize) + _region.x) * 4) );
 
 		for (int yy = 0; yy < _region.height; ++yy)
 		{
@@ -433,13 +559,115 @@ void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffe
 				outLineBuffer[(xx * 4) + layer] = inLineBuffer[xx];
 			}
 
-			memcpy(mem->data + yy * _region.width * 4, outLineBuffer, _region.width * 4);
 			inLineBuffer += _region.width;
 			outLineBuffer += m_textureSize * 4;
 		}
 	}
 
-	bgfx::updateTextureCube(m_textureHandle, (uint8_t)_region.getFaceIndex(), 0, _region.x, _region.y, _region.width, _region.height, mem);
+	addDirtyRect(_region.getFaceIndex(), _region.x, _region.y, _region.width, _region.height);
+}
+
+static uint32_t rectArea(uint16_t _x0, uint16_t _y0, uint16_t _x1, uint16_t _y1)
+{
+	return (_x1 - _x0) * (_y1 - _y0);
+}
+
+void Atlas::addDirtyRect(uint32_t _faceIndex, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height)
+{
+	if (0 == _width
+	||  0 == _height)
+	{
+		return;
+	}
+
+	DirtyRect* rects = m_dirtyRects[_faceIndex];
+	uint32_t numRects = m_numDirtyRects[_faceIndex];
+
+	DirtyRect rect;
+	rect.x0 = _x;
+	rect.y0 = _y;
+	rect.x1 = _x + _width;
+	rect.y1 = _y + _height;
+	const int32_t area = (int32_t)rectArea(rect.x0, rect.y0, rect.x1, rect.y1);
+
+	// Merge with the rectangle for which merging uploads the least amount
+	// of texels that are not dirty. Regions packed next to each other merge
+	// for free, distant ones get their own rectangle until all are used.
+	uint32_t best = UINT32_MAX;
+	int32_t bestWaste = INT32_MAX;
+	DirtyRect bestMerged = rect;
+
+	for (uint32_t ii = 0; ii < numRects; ++ii)
+	{
+		const DirtyRect& other = rects[ii];
+
+		DirtyRect merged;
+		merged.x0 = other.x0 < rect.x0 ? other.x0 : rect.x0;
+		merged.y0 = other.y0 < rect.y0 ? other.y0 : rect.y0;
+		merged.x1 = other.x1 > rect.x1 ? other.x1 : rect.x1;
+		merged.y1 = other.y1 > rect.y1 ? other.y1 : rect.y1;
+
+		int32_t waste = (int32_t)rectArea(merged.x0, merged.y0, merged.x1, merged.y1)
+			- (int32_t)rectArea(other.x0, other.y0, other.x1, other.y1)
+			- area
+			;
+
+		if (waste < bestWaste)
+		{
+			best = ii;
+			bestWaste = waste;
+			bestMerged = merged;
+		}
+	}
+
+	if (UINT32_MAX != best
+	&&  (bestWaste <= area || MAX_ATLAS_DIRTY_RECTS == numRects) )
+	{
+		rects[best] = bestMerged;
+	}
+	else
+	{
+		rects[numRects] = rect;
+		m_numDirtyRects[_faceIndex] = uint8_t(numRects + 1);
+	}
+}
+
+void Atlas::update()
+{
+	m_numUpdates = 0;
+	m_uploadSize = 0;
+
+	const uint32_t facePitch = m_textureSize * m_textureSize * 4;
+	const uint32_t linePitch = m_textureSize * 4;
+
+	for (uint32_t face = 0; face < 6; ++face)
+	{
+		for (uint32_t ii = 0, num = m_numDirtyRects[face]; ii < num; ++ii)
+		{
+			const DirtyRect& rect = m_dirtyRects[face][ii];
+			const uint16_t width = rect.x1 - rect.x0;
+			const uint16_t height = rect.y1 - rect.y0;
+			const uint32_t pitch = width * 4;
+
+			const bgfx::Memory* mem = bgfx::alloc(pitch * height);
+
+			const uint8_t* inLineBuffer = m_textureBuffer + face * facePitch + rect.y0 * linePitch + rect.x0 * 4;
+			uint8_t* outLineBuffer = mem->data;
+			for (uint32_t yy = 0; yy < height; ++yy)
+			{
+				memcpy(outLineBuffer, inLineBuffer, pitch);
+				inLineBuffer += linePitch;
+				outLineBuffer += pitch;
+			}
+
+			++m_numUpdates;
+			m_uploadSize += mem->size;
+
+			bgfx::updateTextureCube(m_textureHandle, (uint8_t)face, 0, rect.x0, rect.y0, width, height, mem);
+		}
+
+		m_numDirtyRects[face] = 0;
+	}
 }
 
 void Atlas::packFaceLayerUV(uint32_t _idx, uint8_t* _vertexBuffer, uint32_t _offset, uint32_t _stride) const
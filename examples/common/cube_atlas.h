@@ -17,6 +17,11 @@
 
 #include <bgfx.h>
 
+namespace bx { struct ReaderI; struct WriterI; }
+
+/// maximum number of rectangles uploaded per face by Atlas::update, nearby rectangles are merged
+#define MAX_ATLAS_DIRTY_RECTS 4
+
 struct AtlasRegion
 {
 	enum Type
@@ -65,14 +70,42 @@ public:
 	/// @param regionBuffer buffer containing the region (will be copied)
 	/// @param maxRegionCount maximum number of region allowed in the atlas
 	Atlas(uint16_t _textureSize, const uint8_t* _textureBuffer, uint16_t _regionCount, const uint8_t* _regionBuffer, uint16_t _maxRegionsCount = 4096);
+
+	/// initialize a dynamic atlas from state written by writeState (region can be updated and added)
+	/// @param reader reader positioned at the state written by writeState, state is copied
+	/// @param textureBuffer buffer of size getTextureBufferSize(), referenced by the texture and not copied unless a region is added or updated, it must stay valid for the atlas lifetime
+	Atlas(bx::ReaderI* _reader, const uint8_t* _textureBuffer);
 	~Atlas();
 
+	/// write the packing state and regions (but not the texture) of a dynamic atlas
+	void writeState(bx::WriterI* _writer) const;
+
+	/// retrieve the byte size of the state written by writeState
+	uint32_t getStateSize() const;
+
 	/// add a region to the atlas, and copy the content of mem to the underlying texture
 	uint16_t addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bitmapBuffer, AtlasRegion::Type _type = AtlasRegion::TYPE_BGRA8, uint16_t outline = 0);
 
 	/// update a preallocated region
+	/// @remark the region is only written to the mirrored texture buffer, the texture is updated by update()
 	void updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer);
 
+	/// upload regions added or updated since last call to the texture, with one texture update per dirty rectangle
+	/// @remark call once per frame, before submitting anything using the atlas
+	void update();
+
+	/// retrieve the number of texture updates issued by last update()
+	uint32_t getNumUpdates() const
+	{
+		return m_numUpdates;
+	}
+
+	/// retrieve the number of bytes uploaded by last update()
+	uint32_t getUploadSize() const
+	{
+		return m_uploadSize;
+	}
+
 	/// Pack the UV coordinates of the four corners of a region to a vertex buffer using the supplied vertex format.
 	/// v0 -- v3
 	/// |     |     encoded in that order:  v0,v1,v2,v3
@@ -148,6 +181,7 @@ public:
 
 private:
 	void init();
+	void addDirtyRect(uint32_t _faceIndex, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height);
 
 	struct PackedLayer;
 	PackedLayer* m_layers;
@@ -164,6 +198,20 @@ private:
 
 	uint16_t m_regionCount;
 	uint16_t m_maxRegionCount;
+
+	struct DirtyRect
+	{
+		uint16_t x0, y0;
+		uint16_t x1, y1;
+	};
+
+	DirtyRect m_dirtyRects[6][MAX_ATLAS_DIRTY_RECTS];
+	uint8_t m_numDirtyRects[6];
+
+	uint32_t m_numUpdates;
+	uint32_t m_uploadSize;
+
+	bool m_ownTextureBuffer;
 };
 
 #endif // CUBE_ATLAS_H_HEADER_GUARD
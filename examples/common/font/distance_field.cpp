@@ -0,0 +1,434 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <bgfx.h>
+
+#include "distance_field.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define DISTANCE_FIELD_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define DISTANCE_FIELD_SSE2 0
+#endif // SSE2
+
+/// Nearest seed row when column has no seed above/below.
+static const int32_t s_noSeedAbove = -(1<<20);
+static const int32_t s_noSeedBelow =   1<<20;
+static const float s_far = 1000000.0f;
+static const float s_inf = 1e30f;
+
+struct DistanceFieldContext
+{
+	float* m_dist;
+	const uint8_t* m_coverage;
+	int32_t* m_nearestOuter;
+	int32_t* m_nearestInner;
+	uint8_t* m_lineScratch;
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_numChunks;
+};
+
+static uint32_t lineScratchSize(uint32_t _width)
+{
+	return (4*_width+1)*sizeof(int32_t);
+}
+
+uint32_t distanceFieldScratchSize(uint32_t _width, uint32_t _height, uint32_t _numThreads)
+{
+	return 2*_width*_height*sizeof(int32_t)
+		+ _numThreads*lineScratchSize(_width)
+		;
+}
+
+static void getChunkRange(uint32_t& _start, uint32_t& _end, uint32_t _num, uint32_t _chunk, uint32_t _numChunks)
+{
+	_start = uint32_t(uint64_t(_num)*_chunk/_numChunks);
+	_end   = uint32_t(uint64_t(_num)*(_chunk+1)/_numChunks);
+}
+
+/// Find nearest seed row within column. Outer seeds are pixels with any
+/// coverage, inner seeds are pixels that are not fully covered. Columns
+/// are independent, rows are swept top-down and then bottom-up.
+static void nearestInColumns(uint32_t _chunk, void* _userData)
+{
+	const DistanceFieldContext& ctx = *(const DistanceFieldContext*)_userData;
+	const uint32_t width = ctx.m_width;
+	const uint32_t height = ctx.m_height;
+
+	uint32_t start;
+	uint32_t end;
+	getChunkRange(start, end, width, _chunk, ctx.m_numChunks);
+
+	int32_t* belowOuter = (int32_t*)(ctx.m_lineScratch + _chunk*lineScratchSize(width) );
+	int32_t* belowInner = belowOuter + width;
+
+	for (uint32_t yy = 0; yy < height; ++yy)
+	{
+		const uint8_t* coverage = &ctx.m_coverage[yy*width];
+		int32_t* outer = &ctx.m_nearestOuter[yy*width];
+		int32_t* inner = &ctx.m_nearestInner[yy*width];
+		const int32_t* prevOuter = outer - width;
+		const int32_t* prevInner = inner - width;
+		uint32_t xx = start;
+
+#if DISTANCE_FIELD_SSE2
+		if (0 < yy)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i full = _mm_set1_epi32(255);
+			const __m128i row  = _mm_set1_epi32(yy);
+
+			for (; xx+4 <= end; xx += 4)
+			{
+				int32_t bytes;
+				memcpy(&bytes, &coverage[xx], 4);
+				const __m128i cc = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+				const __m128i isEmpty = _mm_cmpeq_epi32(cc, zero);
+				const __m128i isFull  = _mm_cmpeq_epi32(cc, full);
+				const __m128i po = _mm_loadu_si128( (const __m128i*)&prevOuter[xx]);
+				const __m128i pi = _mm_loadu_si128( (const __m128i*)&prevInner[xx]);
+				_mm_storeu_si128( (__m128i*)&outer[xx], _mm_or_si128(_mm_and_si128(isEmpty, po), _mm_andnot_si128(isEmpty, row) ) );
+				_mm_storeu_si128( (__m128i*)&inner[xx], _mm_or_si128(_mm_and_si128(isFull,  pi), _mm_andnot_si128(isFull,  row) ) );
+			}
+		}
+#endif // DISTANCE_FIELD_SSE2
+
+		for (; xx < end; ++xx)
+		{
+			outer[xx] = 0   != coverage[xx] ? int32_t(yy) : 0 < yy ? prevOuter[xx] : s_noSeedAbove;
+			inner[xx] = 255 != coverage[xx] ? int32_t(yy) : 0 < yy ? prevInner[xx] : s_noSeedAbove;
+		}
+	}
+
+	for (uint32_t xx = start; xx < end; ++xx)
+	{
+		belowOuter[xx] = s_noSeedBelow;
+		belowInner[xx] = s_noSeedBelow;
+	}
+
+	for (uint32_t yy = height; yy-- > 0;)
+	{
+		const uint8_t* coverage = &ctx.m_coverage[yy*width];
+		int32_t* outer = &ctx.m_nearestOuter[yy*width];
+		int32_t* inner = &ctx.m_nearestInner[yy*width];
+		uint32_t xx = start;
+
+#if DISTANCE_FIELD_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi32(255);
+		const __m128i row  = _mm_set1_epi32(yy);
+		const __m128i row2 = _mm_set1_epi32(2*yy);
+
+		for (; xx+4 <= end; xx += 4)
+		{
+			int32_t bytes;
+			memcpy(&bytes, &coverage[xx], 4);
+			const __m128i cc = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+			const __m128i isEmpty = _mm_cmpeq_epi32(cc, zero);
+			const __m128i isFull  = _mm_cmpeq_epi32(cc, full);
+
+			// below = seed ? yy : below
+			// nearest = yy - above <= below - yy ? above : below
+			__m128i bo = _mm_loadu_si128( (const __m128i*)&belowOuter[xx]);
+			__m128i bi = _mm_loadu_si128( (const __m128i*)&belowInner[xx]);
+			bo = _mm_or_si128(_mm_and_si128(isEmpty, bo), _mm_andnot_si128(isEmpty, row) );
+			bi = _mm_or_si128(_mm_and_si128(isFull,  bi), _mm_andnot_si128(isFull,  row) );
+			_mm_storeu_si128( (__m128i*)&belowOuter[xx], bo);
+			_mm_storeu_si128( (__m128i*)&belowInner[xx], bi);
+
+			const __m128i ao = _mm_loadu_si128( (const __m128i*)&outer[xx]);
+			const __m128i ai = _mm_loadu_si128( (const __m128i*)&inner[xx]);
+			const __m128i useBelowOuter = _mm_cmpgt_epi32(_mm_sub_epi32(row2, ao), bo);
+			const __m128i useBelowInner = _mm_cmpgt_epi32(_mm_sub_epi32(row2, ai), bi);
+			_mm_storeu_si128( (__m128i*)&outer[xx], _mm_or_si128(_mm_and_si128(useBelowOuter, bo), _mm_andnot_si128(useBelowOuter, ao) ) );
+			_mm_storeu_si128( (__m128i*)&inner[xx], _mm_or_si128(_mm_and_si128(useBelowInner, bi), _mm_andnot_si128(useBelowInner, ai) ) );
+		}
+#endif // DISTANCE_FIELD_SSE2
+
+		for (; xx < end; ++xx)
+		{
+			belowOuter[xx] = 0   != coverage[xx] ? int32_t(yy) : belowOuter[xx];
+			belowInner[xx] = 255 != coverage[xx] ? int32_t(yy) : belowInner[xx];
+			outer[xx] = 2*int32_t(yy) - outer[xx] > belowOuter[xx] ? belowOuter[xx] : outer[xx];
+			inner[xx] = 2*int32_t(yy) - inner[xx] > belowInner[xx] ? belowInner[xx] : inner[xx];
+		}
+	}
+}
+
+/// For every pixel in row find column of nearest seed, where cost of
+/// column is squared distance to its nearest seed row. Lower envelope of
+/// parabolas (Felzenszwalb and Huttenlocher) is built left to right, and
+/// then sampled.
+static void nearestInRow(int32_t* _column, const int32_t* _nearest, int32_t _row, uint32_t _width, float* _ff, int32_t* _vv, float* _zz)
+{
+	for (uint32_t ii = 0; ii < _width; ++ii)
+	{
+		const float dy = float(_row - _nearest[ii]);
+		_ff[ii] = dy*dy;
+	}
+
+	_vv[0] = 0;
+	_zz[0] = -s_inf;
+	_zz[1] =  s_inf;
+
+	int32_t kk = 0;
+	for (int32_t qq = 1; qq < int32_t(_width); ++qq)
+	{
+		const float fq = _ff[qq] + float(qq*qq);
+		float ss;
+		do
+		{
+			const int32_t rr = _vv[kk];
+			ss = (fq - _ff[rr] - float(rr*rr) ) / float(2*(qq - rr) );
+		}
+		while (ss <= _zz[kk] && --kk >= 0);
+
+		++kk;
+		_vv[kk] = qq;
+		_zz[kk] = ss;
+		_zz[kk+1] = s_inf;
+	}
+
+	kk = 0;
+	for (int32_t qq = 0; qq < int32_t(_width); ++qq)
+	{
+		while (_zz[kk+1] < float(qq) )
+		{
+			++kk;
+		}
+
+		_column[qq] = _vv[kk];
+	}
+}
+
+/// Distance from pixel center to edge crossing the pixel, given unit edge
+/// normal and coverage. Normal is folded into first octant, where edge
+/// either cuts pixel corner (triangle), or crosses two opposite sides
+/// (trapezoid).
+static float edgeDistance(float _nx, float _ny, float _coverage)
+{
+	float nx = fabsf(_nx);
+	float ny = fabsf(_ny);
+	if (nx < ny)
+	{
+		const float tmp = nx;
+		nx = ny;
+		ny = tmp;
+	}
+
+	if (0.0f == ny)
+	{
+		return 0.5f - _coverage;
+	}
+
+	const float corner = 0.5f*ny/nx;
+	if (_coverage < corner)
+	{
+		return 0.5f*(nx + ny) - sqrtf(2.0f*nx*ny*_coverage);
+	}
+
+	if (_coverage > 1.0f - corner)
+	{
+		return sqrtf(2.0f*nx*ny*(1.0f - _coverage) ) - 0.5f*(nx + ny);
+	}
+
+	return (0.5f - _coverage)*nx;
+}
+
+/// Distance to edge near seed pixel. Direction to seed is used as edge
+/// normal, except at seed itself where coverage gradient is used.
+static float seedDistance(const DistanceFieldContext& _ctx, int32_t _x, int32_t _y, int32_t _seedX, int32_t _seedY, bool _inner)
+{
+	if (0 > _seedY
+	||  int32_t(_ctx.m_height) <= _seedY)
+	{
+		return s_far;
+	}
+
+	const int32_t width = int32_t(_ctx.m_width);
+	const uint8_t* coverage = &_ctx.m_coverage[_seedY*width + _seedX];
+	const float alpha = float(_inner ? 255 - *coverage : *coverage)*(1.0f/255.0f);
+
+	const int32_t dx = _x - _seedX;
+	const int32_t dy = _y - _seedY;
+	if (0 != dx
+	||  0 != dy)
+	{
+		const float length = sqrtf(float(dx*dx + dy*dy) );
+		const float invLength = 1.0f/length;
+		return length + edgeDistance(float(dx)*invLength, float(dy)*invLength, alpha);
+	}
+
+	float gx = 0.0f;
+	float gy = 0.0f;
+	if (0 < _x && _x < width-1
+	&&  0 < _y && _y < int32_t(_ctx.m_height)-1)
+	{
+		const float sqrt2 = 1.4142136f;
+		const float c00 = coverage[-width-1];
+		const float c10 = coverage[-width  ];
+		const float c20 = coverage[-width+1];
+		const float c01 = coverage[      -1];
+		const float c21 = coverage[      +1];
+		const float c02 = coverage[ width-1];
+		const float c12 = coverage[ width  ];
+		const float c22 = coverage[ width+1];
+		gx = c20 + sqrt2*c21 + c22 - c00 - sqrt2*c01 - c02;
+		gy = c02 + sqrt2*c12 + c22 - c00 - sqrt2*c10 - c20;
+	}
+
+	const float length = sqrtf(gx*gx + gy*gy);
+	if (0.0f == length)
+	{
+		return 0.5f - alpha;
+	}
+
+	return edgeDistance(gx/length, gy/length, alpha);
+}
+
+/// Seed nearest to pixel center is not always nearest to edge, when it's
+/// only partially covered. Its neighbors are tested too, unless their
+/// distance lower bound rules them out. Edge is farther than center of
+/// pixels less than half covered, and at most half diagonal closer for
+/// the rest.
+static float nearestDistance(const DistanceFieldContext& _ctx, int32_t _x, int32_t _y, int32_t _seedX, int32_t _seedY, bool _inner)
+{
+	float result = seedDistance(_ctx, _x, _y, _seedX, _seedY, _inner);
+	if (s_far == result)
+	{
+		return result;
+	}
+
+	const int32_t width = int32_t(_ctx.m_width);
+	const int32_t height = int32_t(_ctx.m_height);
+	const uint8_t notSeed = _inner ? 255 : 0;
+	const uint8_t fullSeed = _inner ? 0 : 255;
+
+	if (fullSeed != _ctx.m_coverage[_seedY*width + _seedX])
+	{
+		for (int32_t yy = _seedY-1; yy <= _seedY+1; ++yy)
+		{
+			for (int32_t xx = _seedX-1; xx <= _seedX+1; ++xx)
+			{
+				if (0 > xx || xx >= width
+				||  0 > yy || yy >= height)
+				{
+					continue;
+				}
+
+				const uint8_t coverage = _ctx.m_coverage[yy*width + xx];
+				if (notSeed == coverage
+				|| (xx == _seedX && yy == _seedY) )
+				{
+					continue;
+				}
+
+				const float alpha = float(_inner ? 255 - coverage : coverage)*(1.0f/255.0f);
+				const float bound = result + (alpha < 0.5f ? 0.0f : 0.7072f);
+				const int32_t dx = _x - xx;
+				const int32_t dy = _y - yy;
+				if (0.0f < bound
+				&&  bound*bound <= float(dx*dx + dy*dy) )
+				{
+					continue;
+				}
+
+				const float dist = seedDistance(_ctx, _x, _y, xx, yy, _inner);
+				result = dist < result ? dist : result;
+			}
+		}
+	}
+
+	return result;
+}
+
+static void distanceInRows(uint32_t _chunk, void* _userData)
+{
+	const DistanceFieldContext& ctx = *(const DistanceFieldContext*)_userData;
+	const uint32_t width = ctx.m_width;
+
+	uint32_t start;
+	uint32_t end;
+	getChunkRange(start, end, ctx.m_height, _chunk, ctx.m_numChunks);
+
+	int32_t* column = (int32_t*)(ctx.m_lineScratch + _chunk*lineScratchSize(width) );
+	int32_t* vv = column + width;
+	float* ff = (float*)(vv + width);
+	float* zz = ff + width;
+
+	for (uint32_t yy = start; yy < end; ++yy)
+	{
+		const int32_t* nearestOuter = &ctx.m_nearestOuter[yy*width];
+		const int32_t* nearestInner = &ctx.m_nearestInner[yy*width];
+		float* dist = &ctx.m_dist[yy*width];
+
+		nearestInRow(column, nearestOuter, int32_t(yy), width, ff, vv, zz);
+		for (uint32_t xx = 0; xx < width; ++xx)
+		{
+			const int32_t seedX = column[xx];
+			const float outside = nearestDistance(ctx, int32_t(xx), int32_t(yy), seedX, nearestOuter[seedX], false);
+			dist[xx] = outside > 0.0f ? outside : 0.0f;
+		}
+
+		nearestInRow(column, nearestInner, int32_t(yy), width, ff, vv, zz);
+		for (uint32_t xx = 0; xx < width; ++xx)
+		{
+			const int32_t seedX = column[xx];
+			const float inside = nearestDistance(ctx, int32_t(xx), int32_t(yy), seedX, nearestInner[seedX], true);
+			dist[xx] -= inside > 0.0f ? inside : 0.0f;
+		}
+	}
+}
+
+void distanceField(float* _dist, const uint8_t* _coverage, uint32_t _width, uint32_t _height, void* _scratch, uint32_t _numThreads)
+{
+	DistanceFieldContext ctx;
+	ctx.m_dist = _dist;
+	ctx.m_coverage = _coverage;
+	ctx.m_nearestOuter = (int32_t*)_scratch;
+	ctx.m_nearestInner = ctx.m_nearestOuter + _width*_height;
+	ctx.m_lineScratch = (uint8_t*)(ctx.m_nearestInner + _width*_height);
+	ctx.m_width = _width;
+	ctx.m_height = _height;
+	ctx.m_numChunks = _numThreads < 1 ? 1 : _numThreads;
+
+	bgfx::parallelFor(ctx.m_numChunks, nearestInColumns, &ctx, ctx.m_numChunks);
+	bgfx::parallelFor(ctx.m_numChunks, distanceInRows, &ctx, ctx.m_numChunks);
+}
+
+void distanceFieldQuantize(uint8_t* _out, const float* _dist, uint32_t _num, float _scale, float _offset)
+{
+	uint32_t ii = 0;
+
+#if DISTANCE_FIELD_SSE2
+	const __m128 scale  = _mm_set1_ps(_scale);
+	const __m128 offset = _mm_set1_ps(_offset);
+	const __m128 fmin   = _mm_setzero_ps();
+	const __m128 fmax   = _mm_set1_ps(255.0f);
+	const __m128i full  = _mm_set1_epi32(255);
+
+	for (; ii+4 <= _num; ii += 4)
+	{
+		const __m128 val = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&_dist[ii]), scale), offset);
+		const __m128i ival = _mm_sub_epi32(full, _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(val, fmax), fmin) ) );
+		const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(ival, ival), ival);
+		const int32_t packed = _mm_cvtsi128_si32(bytes);
+		memcpy(&_out[ii], &packed, 4);
+	}
+#endif // DISTANCE_FIELD_SSE2
+
+	for (; ii < _num; ++ii)
+	{
+		float val = _dist[ii]*_scale + _offset;
+		val = val < 0.0f ? 0.0f : val;
+		val = val > 255.0f ? 255.0f : val;
+		_out[ii] = uint8_t(255 - int32_t(val) );
+	}
+}
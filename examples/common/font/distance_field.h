@@ -0,0 +1,38 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef DISTANCE_FIELD_H_HEADER_GUARD
+#define DISTANCE_FIELD_H_HEADER_GUARD
+
+#include <stdint.h>
+
+/// Returns size of scratch memory in bytes required by distanceField.
+///
+/// @param _numThreads Number of threads distanceField will be called with.
+///
+uint32_t distanceFieldScratchSize(uint32_t _width, uint32_t _height, uint32_t _numThreads = 1);
+
+/// Compute signed distance field from 8-bit coverage image.
+///
+/// Shape edge is at coverage 0.5. Partially covered pixels are seeded
+/// with subpixel distance to the edge, and squared Euclidean distance is
+/// computed exactly with separable lower envelope of parabolas (Felzenszwalb
+/// and Huttenlocher), first along columns and then along rows. Runs in
+/// linear time.
+///
+/// @param _dist Distance in pixels, positive outside of shape.
+/// @param _coverage Coverage, 255 is inside of shape.
+/// @param _scratch Scratch memory of distanceFieldScratchSize bytes.
+/// @param _numThreads Number of threads used, including calling thread.
+///   Result doesn't depend on number of threads.
+///
+void distanceField(float* _dist, const uint8_t* _coverage, uint32_t _width, uint32_t _height, void* _scratch, uint32_t _numThreads = 1);
+
+/// Quantize distance field to 8-bit, where 255 is inside of shape:
+///   out = 255 - clamp(dist*_scale + _offset, 0, 255)
+///
+void distanceFieldQuantize(uint8_t* _out, const float* _dist, uint32_t _num, float _scale, float _offset);
+
+#endif // DISTANCE_FIELD_H_HEADER_GUARD
@@ -6,15 +6,21 @@
 #include "../common.h"
 
 #include <bgfx.h>
+#include <bx/hash.h>
+#include <bx/mutex.h>
+#include <bx/readerwriter.h>
+#include <bx/thread.h>
+#include <bx/uint32_t.h>
 #include <freetype/freetype.h>
-#include <edtaa3/edtaa3func.cpp>
 #include <wchar.h> // wcslen
 
 #include <tinystl/allocator.h>
 #include <tinystl/unordered_map.h>
+#include <tinystl/unordered_set.h>
 namespace stl = tinystl;
 
 #include "font_manager.h"
+#include "distance_field.h"
 #include "../cube_atlas.h"
 
 struct FTHolder
@@ -47,9 +53,10 @@ public:
 	/// @ remark buffer min size: glyphInfo.m_width * glyphInfo * height * sizeof(uint32_t)
 	bool bakeGlyphSubpixel(CodePoint _codePoint, GlyphInfo& _outGlyphInfo, uint8_t* _outBuffer);
 
-	/// raster a glyph as 8bit signed distance to a memory buffer
+	/// raster a glyph as 8bit alpha padded for signed distance to a memory
+	/// buffer, distance is computed by makeDistanceMap
 	/// update the GlyphInfo according to the raster strategy
-	/// @ remark buffer min size: glyphInfo.m_width * glyphInfo * height * sizeof(char)
+	/// @ remark buffer min size: MAX_DISTANCE_GLYPH_SIZE * MAX_DISTANCE_GLYPH_SIZE * sizeof(char)
 	bool bakeGlyphDistance(CodePoint _codePoint, GlyphInfo& _outGlyphInfo, uint8_t* _outBuffer);
 
 private:
@@ -245,96 +252,21 @@ bool TrueTypeFont::bakeGlyphSubpixel(CodePoint _codePoint, GlyphInfo& _glyphInfo
 	return true;
 }
 
-static void makeDistanceMap(const uint8_t* _img, uint8_t* _outImg, uint32_t _width, uint32_t _height)
-{
-	int16_t* xdist = (int16_t*)malloc(_width * _height * sizeof(int16_t) );
-	int16_t* ydist = (int16_t*)malloc(_width * _height * sizeof(int16_t) );
-	double* gx = (double*)calloc(_width * _height, sizeof(double) );
-	double* gy = (double*)calloc(_width * _height, sizeof(double) );
-	double* data = (double*)calloc(_width * _height, sizeof(double) );
-	double* outside = (double*)calloc(_width * _height, sizeof(double) );
-	double* inside = (double*)calloc(_width * _height, sizeof(double) );
-	uint32_t ii;
-
-	// Convert img into double (data)
-	double img_min = 255, img_max = -255;
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		double v = _img[ii];
-		data[ii] = v;
-		if (v > img_max)
-		{
-			img_max = v;
-		}
-
-		if (v < img_min)
-		{
-			img_min = v;
-		}
-	}
-
-	// Rescale image levels between 0 and 1
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		data[ii] = (_img[ii] - img_min) / (img_max - img_min);
-	}
-
-	// Compute outside = edtaa3(bitmap); % Transform background (0's)
-	computegradient(data, _width, _height, gx, gy);
-	edtaa3(data, gx, gy, _width, _height, xdist, ydist, outside);
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		if (outside[ii] < 0)
-		{
-			outside[ii] = 0.0;
-		}
-	}
-
-	// Compute inside = edtaa3(1-bitmap); % Transform foreground (1's)
-	memset(gx, 0, sizeof(double) * _width * _height);
-	memset(gy, 0, sizeof(double) * _width * _height);
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		data[ii] = 1.0 - data[ii];
-	}
-
-	computegradient(data, _width, _height, gx, gy);
-	edtaa3(data, gx, gy, _width, _height, xdist, ydist, inside);
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		if (inside[ii] < 0)
-		{
-			inside[ii] = 0.0;
-		}
-	}
-
-	// distmap = outside - inside; % Bipolar distance field
-	uint8_t* out = _outImg;
-	for (ii = 0; ii < _width * _height; ++ii)
-	{
-		outside[ii] -= inside[ii];
-		outside[ii] = 128 + outside[ii] * 16;
-
-		if (outside[ii] < 0)
-		{
-			outside[ii] = 0;
-		}
-
-		if (outside[ii] > 255)
-		{
-			outside[ii] = 255;
-		}
+#define MAX_DISTANCE_GLYPH_SIZE 128
 
-		out[ii] = 255 - (uint8_t) outside[ii];
-	}
+static uint32_t distanceMapScratchSize()
+{
+	return MAX_DISTANCE_GLYPH_SIZE*MAX_DISTANCE_GLYPH_SIZE*sizeof(float)
+		+ distanceFieldScratchSize(MAX_DISTANCE_GLYPH_SIZE, MAX_DISTANCE_GLYPH_SIZE)
+		;
+}
 
-	free(xdist);
-	free(ydist);
-	free(gx);
-	free(gy);
-	free(data);
-	free(outside);
-	free(inside);
+/// Replace 8bit alpha with signed distance, 16 levels per pixel.
+static void makeDistanceMap(uint8_t* _img, uint32_t _width, uint32_t _height, uint8_t* _scratch)
+{
+	float* dist = (float*)_scratch;
+	distanceField(dist, _img, _width, _height, _scratch + _width*_height*sizeof(float) );
+	distanceFieldQuantize(_img, dist, _width*_height, 16.0f, 128.0f);
 }
 
 bool TrueTypeFont::bakeGlyphDistance(CodePoint _codePoint, GlyphInfo& _glyphInfo, uint8_t* _outBuffer)
@@ -382,21 +314,23 @@ bool TrueTypeFont::bakeGlyphDistance(CodePoint _codePoint, GlyphInfo& _glyphInfo
 
 		uint32_t nw = ww + dw * 2;
 		uint32_t nh = hh + dh * 2;
-		BX_CHECK(nw * nh < 128 * 128, "Buffer overflow (size %d)", nw * nh);
+		BX_CHECK(nw * nh < MAX_DISTANCE_GLYPH_SIZE * MAX_DISTANCE_GLYPH_SIZE, "Buffer overflow (size %d)", nw * nh);
 
-		uint32_t buffSize = nw * nh * sizeof(uint8_t);
-
-		uint8_t* alphaImg = (uint8_t*)malloc(buffSize);
-		memset(alphaImg, 0, nw * nh * sizeof(uint8_t) );
+		// pad in place, last row first so that rows are not overwritten
+		// before they are moved
+		for (int32_t ii = hh - 1; ii >= 0; --ii)
+		{
+			memmove(_outBuffer + (ii + dh) * nw + dw, _outBuffer + ii * ww, ww);
+		}
 
-		//copy the original buffer to the temp one
 		for (uint32_t ii = dh; ii < nh - dh; ++ii)
 		{
-			memcpy(alphaImg + ii * nw + dw, _outBuffer + (ii - dh) * ww, ww);
+			memset(_outBuffer + ii * nw, 0, dw);
+			memset(_outBuffer + ii * nw + dw + ww, 0, dw);
 		}
 
-		makeDistanceMap(alphaImg, _outBuffer, nw, nh);
-		free(alphaImg);
+		memset(_outBuffer, 0, dh * nw);
+		memset(_outBuffer + (nh - dh) * nw, 0, dh * nw);
 
 		_glyphInfo.offset_x -= (float)dw;
 		_glyphInfo.offset_y -= (float)dh;
@@ -407,15 +341,58 @@ bool TrueTypeFont::bakeGlyphDistance(CodePoint _codePoint, GlyphInfo& _glyphInfo
 	return true;
 }
 
+/// Raster a glyph for given font type, computing distance field of distance
+/// fonts.
+static bool bakeGlyph(TrueTypeFont* _ttf, uint32_t _fontType, CodePoint _codePoint, GlyphInfo& _glyphInfo, uint8_t* _buffer, uint8_t* _distanceScratch)
+{
+	switch (_fontType)
+	{
+	case FONT_TYPE_ALPHA:
+		return _ttf->bakeGlyphAlpha(_codePoint, _glyphInfo, _buffer);
+
+	case FONT_TYPE_DISTANCE:
+	case FONT_TYPE_DISTANCE_SUBPIXEL:
+		if (!_ttf->bakeGlyphDistance(_codePoint, _glyphInfo, _buffer) )
+		{
+			return false;
+		}
+
+		if (0.0f < _glyphInfo.width)
+		{
+			makeDistanceMap(_buffer, (uint32_t)_glyphInfo.width, (uint32_t)_glyphInfo.height, _distanceScratch);
+		}
+		return true;
+
+	default:
+		BX_CHECK(false, "TextureType not supported yet");
+	}
+
+	return false;
+}
+
+#define MAX_GLYPH_WORKERS 16
+#define MAX_GLYPH_REQUESTS 4096
+
+// Glyphs are rasterized into buffer of this size, both by workers and on
+// calling thread. Size is sufficient for subpixel glyph of largest pixel
+// height accepted by TrueTypeFont::init.
+#define MAX_FONT_BUFFER_SIZE (512 * 512 * 4)
+
 typedef stl::unordered_map<CodePoint, GlyphInfo> GlyphHashMap;
+typedef stl::unordered_set<CodePoint> CodePointSet;
 
 // cache font data
 struct FontManager::CachedFont
 {
 	CachedFont()
 		: trueTypeFont(NULL)
+		, typefaceIndex(0)
+		, fileHash(0)
+		, fileSize(0)
 	{
 		masterFontHandle.idx = bx::HandleAlloc::invalid;
+		ttfHandle.idx = bx::HandleAlloc::invalid;
+		memset(workerFonts, 0, sizeof(workerFonts) );
 	}
 
 	FontInfo fontInfo;
@@ -424,9 +401,206 @@ struct FontManager::CachedFont
 	// an handle to a master font in case of sub distance field font
 	FontHandle masterFontHandle;
 	int16_t padding;
+
+	// TrueType file and face used to create FreeType face of each worker
+	// thread, FreeType face can't be shared between threads
+	TrueTypeHandle ttfHandle;
+	uint32_t typefaceIndex;
+
+	// identify TrueType file in font cache
+	uint32_t fileHash;
+	uint32_t fileSize;
+	TrueTypeFont* workerFonts[MAX_GLYPH_WORKERS];
+
+	// glyphs requested from worker threads, not yet added to atlas
+	CodePointSet pendingGlyphs;
 };
 
-#define MAX_FONT_BUFFER_SIZE (512 * 512 * 4)
+#define FONT_CACHE_MAGIC BX_MAKEFOURCC('F', 'N', 'T', 0x0)
+#define FONT_CACHE_VERSION 1
+
+/// Alignment of atlas texture inside font cache.
+#define FONT_CACHE_ALIGN 16
+
+/// Font cache layout:
+///
+///   FontCacheHeader
+///   atlas texture, aligned to FONT_CACHE_ALIGN
+///   atlas state written by Atlas::writeState
+///   FontCacheFont[numFonts]
+///   FontCacheGlyph[numGlyphs], glyphs of each font are consecutive
+///
+struct FontCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	uint32_t textureOffset;
+	uint32_t textureSize;
+	uint32_t atlasOffset;
+	uint32_t atlasSize;
+	uint32_t fontsOffset;
+	uint32_t numFonts;
+	uint32_t glyphsOffset;
+	uint32_t numGlyphs;
+	uint16_t blackGlyphRegion;
+	uint16_t padding;
+};
+
+/// Cached font is matched by TrueType file hash and size, typeface, pixel
+/// size and font type.
+struct FontCacheFont
+{
+	uint32_t fileHash;
+	uint32_t fileSize;
+	uint32_t typefaceIndex;
+	uint32_t pixelSize;
+	uint32_t fontType;
+	uint32_t firstGlyph;
+	uint32_t numGlyphs;
+};
+
+struct FontCacheGlyph
+{
+	CodePoint codePoint;
+	GlyphInfo glyphInfo;
+};
+
+struct GlyphRequest
+{
+	FontHandle handle;
+	CodePoint codePoint;
+};
+
+struct GlyphResult
+{
+	FontHandle handle;
+	CodePoint codePoint;
+	GlyphInfo glyphInfo;
+	uint8_t* data; // NULL if glyph failed to raster
+};
+
+struct FontManager::GlyphQueue
+{
+	struct Worker
+	{
+		GlyphQueue* queue;
+		uint32_t index;
+		uint8_t* buffer;
+		uint8_t* distanceScratch;
+		bx::Thread thread;
+	};
+
+	GlyphQueue(CachedFont* _cachedFonts, CachedFile* _cachedFiles)
+		: cachedFonts(_cachedFonts)
+		, cachedFiles(_cachedFiles)
+		, results(resultBuffers[0])
+		, collected(resultBuffers[1])
+		, requestRead(0)
+		, requestWrite(0)
+		, numResults(0)
+		, numPending(0)
+		, numWorkers(0)
+		, exit(false)
+	{
+	}
+
+	~GlyphQueue()
+	{
+		for (uint32_t ii = 0; ii < numResults; ++ii)
+		{
+			delete [] results[ii].data;
+		}
+	}
+
+	static int32_t workerThread(void* _userData);
+
+	CachedFont* cachedFonts;
+	CachedFile* cachedFiles;
+
+	bx::LwMutex mutex;
+	bx::Semaphore sem;
+
+	GlyphRequest requests[MAX_GLYPH_REQUESTS];
+	GlyphResult resultBuffers[2][MAX_GLYPH_REQUESTS];
+	GlyphResult* results;
+	GlyphResult* collected;
+
+	uint32_t requestRead;
+	uint32_t requestWrite;
+	uint32_t numResults;
+
+	// requested glyphs not yet collected, only accessed by owner thread
+	uint32_t numPending;
+
+	Worker workers[MAX_GLYPH_WORKERS];
+	uint32_t numWorkers;
+	bool exit;
+};
+
+int32_t FontManager::GlyphQueue::workerThread(void* _userData)
+{
+	Worker& worker = *(Worker*)_userData;
+	GlyphQueue& queue = *worker.queue;
+
+	for (;;)
+	{
+		queue.sem.wait();
+
+		GlyphRequest request;
+		{
+			bx::LwMutexScope scope(queue.mutex);
+
+			if (queue.requestRead == queue.requestWrite)
+			{
+				if (queue.exit)
+				{
+					return 0;
+				}
+
+				continue;
+			}
+
+			request = queue.requests[queue.requestRead % MAX_GLYPH_REQUESTS];
+			++queue.requestRead;
+		}
+
+		CachedFont& font = queue.cachedFonts[request.handle.idx];
+
+		TrueTypeFont*& ttf = font.workerFonts[worker.index];
+		if (NULL == ttf)
+		{
+			const CachedFile& file = queue.cachedFiles[font.ttfHandle.idx];
+
+			ttf = new TrueTypeFont();
+			if (!ttf->init(file.buffer, file.bufferSize, font.typefaceIndex, font.fontInfo.pixelSize) )
+			{
+				delete ttf;
+				ttf = NULL;
+			}
+		}
+
+		GlyphResult result;
+		result.handle = request.handle;
+		result.codePoint = request.codePoint;
+		result.data = NULL;
+
+		if (NULL != ttf
+		&&  bakeGlyph(ttf, font.fontInfo.fontType, request.codePoint, result.glyphInfo, worker.buffer, worker.distanceScratch) )
+		{
+			uint32_t size = (uint32_t)result.glyphInfo.width * (uint32_t)result.glyphInfo.height;
+			BX_CHECK(size <= MAX_FONT_BUFFER_SIZE, "Buffer overflow (size %d)", size);
+
+			result.data = new uint8_t[size];
+			memcpy(result.data, worker.buffer, size);
+		}
+
+		bx::LwMutexScope scope(queue.mutex);
+		queue.results[queue.numResults++] = result;
+	}
+}
+
+#define MAX_DISTANCE_GLYPH_BATCH (MAX_FONT_BUFFER_SIZE / (MAX_DISTANCE_GLYPH_SIZE * MAX_DISTANCE_GLYPH_SIZE) )
 
 FontManager::FontManager(Atlas* _atlas)
 	: m_ownAtlas(false)
@@ -447,6 +621,12 @@ void FontManager::init()
 	m_cachedFiles = new CachedFile[MAX_OPENED_FILES];
 	m_cachedFonts = new CachedFont[MAX_OPENED_FONT];
 	m_buffer = new uint8_t[MAX_FONT_BUFFER_SIZE];
+	m_cache = NULL;
+	m_numThreads = 1;
+	m_distanceScratch = new uint8_t[distanceMapScratchSize()];
+	m_glyphQueue = new GlyphQueue(m_cachedFonts, m_cachedFiles);
+	memset(&m_stats, 0, sizeof(m_stats) );
+	m_numGlyphs = 0;
 
 	const uint32_t W = 3;
 	// Create filler rectangle
@@ -462,6 +642,9 @@ void FontManager::init()
 
 FontManager::~FontManager()
 {
+	stopWorkers();
+	delete m_glyphQueue;
+
 	BX_CHECK(m_fontHandles.getNumHandles() == 0, "All the fonts must be destroyed before destroying the manager");
 	delete [] m_cachedFonts;
 
@@ -469,6 +652,7 @@ FontManager::~FontManager()
 	delete [] m_cachedFiles;
 
 	delete [] m_buffer;
+	delete [] m_distanceScratch;
 
 	if (m_ownAtlas)
 	{
@@ -476,12 +660,24 @@ FontManager::~FontManager()
 	}
 }
 
+void FontManager::setNumThreads(uint32_t _numThreads)
+{
+	// workers are restarted with new number of threads by next request
+	stopWorkers();
+
+	m_numThreads = bx::uint32_min(bx::uint32_max(_numThreads, 1), MAX_DISTANCE_GLYPH_BATCH);
+
+	delete [] m_distanceScratch;
+	m_distanceScratch = new uint8_t[m_numThreads*distanceMapScratchSize()];
+}
+
 TrueTypeHandle FontManager::createTtf(const uint8_t* _buffer, uint32_t _size)
 {
 	uint16_t id = m_filesHandles.alloc();
 	BX_CHECK(id != bx::HandleAlloc::invalid, "Invalid handle used");
 	m_cachedFiles[id].buffer = new uint8_t[_size];
 	m_cachedFiles[id].bufferSize = _size;
+	m_cachedFiles[id].hash = bx::hashMurmur2A(_buffer, _size);
 	memcpy(m_cachedFiles[id].buffer, _buffer, _size);
 
 	TrueTypeHandle ret = { id };
@@ -491,7 +687,27 @@ TrueTypeHandle FontManager::createTtf(const uint8_t* _buffer, uint32_t _size)
 void FontManager::destroyTtf(TrueTypeHandle _handle)
 {
 	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
-	delete m_cachedFiles[_handle.idx].buffer;
+
+	// worker faces use file buffer, fonts created from this file can't be
+	// requested anymore
+	stopWorkers();
+
+	for (uint32_t ii = 0; ii < MAX_OPENED_FONT; ++ii)
+	{
+		CachedFont& font = m_cachedFonts[ii];
+		if (font.ttfHandle.idx == _handle.idx)
+		{
+			for (uint32_t jj = 0; jj < MAX_GLYPH_WORKERS; ++jj)
+			{
+				delete font.workerFonts[jj];
+				font.workerFonts[jj] = NULL;
+			}
+
+			font.ttfHandle.idx = bx::HandleAlloc::invalid;
+		}
+	}
+
+	delete [] m_cachedFiles[_handle.idx].buffer;
 	m_cachedFiles[_handle.idx].bufferSize = 0;
 	m_cachedFiles[_handle.idx].buffer = NULL;
 	m_filesHandles.free(_handle.idx);
@@ -519,6 +735,36 @@ FontHandle FontManager::createFontByPixelSize(TrueTypeHandle _ttfHandle, uint32_
 	font.fontInfo.pixelSize = _pixelSize;
 	font.cachedGlyphs.clear();
 	font.masterFontHandle.idx = bx::HandleAlloc::invalid;
+	font.ttfHandle = _ttfHandle;
+	font.typefaceIndex = _typefaceIndex;
+	font.fileHash = m_cachedFiles[_ttfHandle.idx].hash;
+	font.fileSize = m_cachedFiles[_ttfHandle.idx].bufferSize;
+
+	if (NULL != m_cache)
+	{
+		const FontCacheHeader& header = *(const FontCacheHeader*)m_cache;
+		const FontCacheFont* cachedFonts = (const FontCacheFont*)(m_cache + header.fontsOffset);
+		const FontCacheGlyph* cachedGlyphs = (const FontCacheGlyph*)(m_cache + header.glyphsOffset);
+
+		for (uint32_t ii = 0; ii < header.numFonts; ++ii)
+		{
+			const FontCacheFont& cached = cachedFonts[ii];
+			if (cached.fileHash == font.fileHash
+			&&  cached.fileSize == font.fileSize
+			&&  cached.typefaceIndex == _typefaceIndex
+			&&  cached.pixelSize == _pixelSize
+			&&  cached.fontType == _fontType)
+			{
+				for (uint32_t jj = 0; jj < cached.numGlyphs; ++jj)
+				{
+					const FontCacheGlyph& glyph = cachedGlyphs[cached.firstGlyph + jj];
+					font.cachedGlyphs[glyph.codePoint] = glyph.glyphInfo;
+				}
+
+				break;
+			}
+		}
+	}
 
 	FontHandle handle = { fontIdx };
 	return handle;
@@ -548,6 +794,7 @@ FontHandle FontManager::createScaledFontToPixelSize(FontHandle _baseFontHandle,
 	font.fontInfo = newFontInfo;
 	font.trueTypeFont = NULL;
 	font.masterFontHandle = _baseFontHandle;
+	font.ttfHandle.idx = bx::HandleAlloc::invalid;
 
 	FontHandle handle = { fontIdx };
 	return handle;
@@ -559,6 +806,16 @@ void FontManager::destroyFont(FontHandle _handle)
 
 	CachedFont& font = m_cachedFonts[_handle.idx];
 
+	// wait for requested glyphs, worker threads might be using this font
+	stopWorkers();
+	addFinishedGlyphs();
+
+	for (uint32_t ii = 0; ii < MAX_GLYPH_WORKERS; ++ii)
+	{
+		delete font.workerFonts[ii];
+		font.workerFonts[ii] = NULL;
+	}
+
 	if (font.trueTypeFont != NULL)
 	{
 		delete font.trueTypeFont;
@@ -566,9 +823,308 @@ void FontManager::destroyFont(FontHandle _handle)
 	}
 
 	font.cachedGlyphs.clear();
+	font.pendingGlyphs.clear();
+	font.ttfHandle.idx = bx::HandleAlloc::invalid;
 	m_fontHandles.free(_handle.idx);
 }
 
+void FontManager::saveCache(bx::WriterI* _writer) const
+{
+	uint32_t numFonts = 0;
+	uint32_t numGlyphs = 0;
+	for (uint32_t ii = 0; ii < MAX_OPENED_FONT; ++ii)
+	{
+		const CachedFont& font = m_cachedFonts[ii];
+		if (NULL != font.trueTypeFont)
+		{
+			++numFonts;
+			numGlyphs += (uint32_t)font.cachedGlyphs.size();
+		}
+	}
+
+	FontCacheHeader header;
+	header.magic = FONT_CACHE_MAGIC;
+	header.version = FONT_CACHE_VERSION;
+	header.textureOffset = (sizeof(FontCacheHeader) + FONT_CACHE_ALIGN - 1) & ~(FONT_CACHE_ALIGN - 1);
+	header.textureSize = m_atlas->getTextureBufferSize();
+	header.atlasOffset = header.textureOffset + header.textureSize;
+	header.atlasSize = m_atlas->getStateSize();
+	header.fontsOffset = header.atlasOffset + header.atlasSize;
+	header.numFonts = numFonts;
+	header.glyphsOffset = header.fontsOffset + numFonts * sizeof(FontCacheFont);
+	header.numGlyphs = numGlyphs;
+	header.size = header.glyphsOffset + numGlyphs * sizeof(FontCacheGlyph);
+	header.blackGlyphRegion = m_blackGlyph.regionIndex;
+	header.padding = 0;
+	bx::write(_writer, header);
+
+	uint8_t zero[FONT_CACHE_ALIGN] = {};
+	bx::write(_writer, zero, header.textureOffset - sizeof(FontCacheHeader) );
+	bx::write(_writer, m_atlas->getTextureBuffer(), header.textureSize);
+	m_atlas->writeState(_writer);
+
+	uint32_t firstGlyph = 0;
+	for (uint32_t ii = 0; ii < MAX_OPENED_FONT; ++ii)
+	{
+		const CachedFont& font = m_cachedFonts[ii];
+		if (NULL != font.trueTypeFont)
+		{
+			FontCacheFont cached;
+			cached.fileHash = font.fileHash;
+			cached.fileSize = font.fileSize;
+			cached.typefaceIndex = font.typefaceIndex;
+			cached.pixelSize = font.fontInfo.pixelSize;
+			cached.fontType = font.fontInfo.fontType;
+			cached.firstGlyph = firstGlyph;
+			cached.numGlyphs = (uint32_t)font.cachedGlyphs.size();
+			bx::write(_writer, cached);
+
+			firstGlyph += cached.numGlyphs;
+		}
+	}
+
+	for (uint32_t ii = 0; ii < MAX_OPENED_FONT; ++ii)
+	{
+		const CachedFont& font = m_cachedFonts[ii];
+		if (NULL != font.trueTypeFont)
+		{
+			for (GlyphHashMap::const_iterator it = font.cachedGlyphs.begin(), itEnd = font.cachedGlyphs.end(); it != itEnd; ++it)
+			{
+				FontCacheGlyph glyph;
+				glyph.codePoint = it->first;
+				glyph.glyphInfo = it->second;
+				bx::write(_writer, glyph);
+			}
+		}
+	}
+}
+
+bool FontManager::loadCache(const void* _data, uint32_t _size)
+{
+	if (!m_ownAtlas
+	||  0 != m_fontHandles.getNumHandles() )
+	{
+		return false;
+	}
+
+	const uint8_t* data = (const uint8_t*)_data;
+	const FontCacheHeader& header = *(const FontCacheHeader*)data;
+
+	// Offsets are summed in 64-bit, damaged header must not wrap around.
+	if (_size < sizeof(FontCacheHeader)
+	||  FONT_CACHE_MAGIC != header.magic
+	||  FONT_CACHE_VERSION != header.version
+	||  _size < header.size
+	||  header.textureOffset < sizeof(FontCacheHeader)
+	||  header.atlasSize < 4*sizeof(uint16_t)
+	||  uint64_t(header.atlasOffset)  != uint64_t(header.textureOffset) + header.textureSize
+	||  uint64_t(header.fontsOffset)  != uint64_t(header.atlasOffset) + header.atlasSize
+	||  uint64_t(header.glyphsOffset) != uint64_t(header.fontsOffset) + uint64_t(header.numFonts) * sizeof(FontCacheFont)
+	||  uint64_t(header.size)         != uint64_t(header.glyphsOffset) + uint64_t(header.numGlyphs) * sizeof(FontCacheGlyph) )
+	{
+		BX_WARN(false, "Invalid font cache.");
+		return false;
+	}
+
+	// Atlas data starts with texture size, max region count, and region
+	// count.
+	uint16_t atlasHeader[3];
+	memcpy(atlasHeader, data + header.atlasOffset, sizeof(atlasHeader) );
+	const uint16_t textureSize = atlasHeader[0];
+	const uint16_t regionCount = atlasHeader[2];
+	if (uint64_t(header.textureSize) != 6 * uint64_t(textureSize) * textureSize * 4
+	||  regionCount > atlasHeader[1]
+	||  header.blackGlyphRegion >= regionCount)
+	{
+		BX_WARN(false, "Invalid font cache atlas.");
+		return false;
+	}
+
+	const FontCacheFont* cachedFonts = (const FontCacheFont*)(data + header.fontsOffset);
+	for (uint32_t ii = 0; ii < header.numFonts; ++ii)
+	{
+		if (uint64_t(cachedFonts[ii].firstGlyph) + cachedFonts[ii].numGlyphs > header.numGlyphs)
+		{
+			BX_WARN(false, "Invalid font cache glyph range.");
+			return false;
+		}
+	}
+
+	const FontCacheGlyph* cachedGlyphs = (const FontCacheGlyph*)(data + header.glyphsOffset);
+	for (uint32_t ii = 0; ii < header.numGlyphs; ++ii)
+	{
+		if (cachedGlyphs[ii].glyphInfo.regionIndex >= regionCount)
+		{
+			BX_WARN(false, "Invalid font cache glyph region.");
+			return false;
+		}
+	}
+
+	bx::MemoryReader reader(data + header.atlasOffset, header.atlasSize);
+
+	delete m_atlas;
+	m_atlas = new Atlas(&reader, data + header.textureOffset);
+	m_blackGlyph.regionIndex = header.blackGlyphRegion;
+	m_cache = data;
+
+	return true;
+}
+
+bool FontManager::requestGlyphs(FontHandle _handle, const wchar_t* _string)
+{
+	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
+	CachedFont& font = m_cachedFonts[_handle.idx];
+
+	if (NULL == font.trueTypeFont)
+	{
+		return isValid(font.masterFontHandle)
+			&& requestGlyphs(font.masterFontHandle, _string)
+			;
+	}
+
+	if (!isValid(font.ttfHandle) )
+	{
+		return false;
+	}
+
+	startWorkers();
+
+	GlyphQueue& queue = *m_glyphQueue;
+	uint32_t numRequests = 0;
+	bool result = true;
+
+	{
+		bx::LwMutexScope scope(queue.mutex);
+
+		for (uint32_t ii = 0, end = (uint32_t)wcslen(_string); ii < end; ++ii)
+		{
+			CodePoint codePoint = _string[ii];
+
+			if (font.cachedGlyphs.end() != font.cachedGlyphs.find(codePoint)
+			||  font.pendingGlyphs.end() != font.pendingGlyphs.find(codePoint) )
+			{
+				continue;
+			}
+
+			if (MAX_GLYPH_REQUESTS == queue.numPending)
+			{
+				result = false;
+				break;
+			}
+
+			GlyphRequest& request = queue.requests[queue.requestWrite % MAX_GLYPH_REQUESTS];
+			request.handle = _handle;
+			request.codePoint = codePoint;
+			++queue.requestWrite;
+
+			font.pendingGlyphs.insert(codePoint);
+			++queue.numPending;
+			++numRequests;
+		}
+	}
+
+	if (0 < numRequests)
+	{
+		queue.sem.post(numRequests);
+	}
+
+	return result;
+}
+
+void FontManager::update()
+{
+	addFinishedGlyphs();
+	m_atlas->update();
+
+	m_stats.numGlyphs = m_numGlyphs;
+	m_stats.numPending = m_glyphQueue->numPending;
+	m_stats.numUpdates = m_atlas->getNumUpdates();
+	m_stats.uploadSize = m_atlas->getUploadSize();
+	m_numGlyphs = 0;
+}
+
+void FontManager::startWorkers()
+{
+	GlyphQueue& queue = *m_glyphQueue;
+	if (0 != queue.numWorkers)
+	{
+		return;
+	}
+
+	queue.exit = false;
+	queue.numWorkers = bx::uint32_min(m_numThreads, MAX_GLYPH_WORKERS);
+
+	for (uint32_t ii = 0; ii < queue.numWorkers; ++ii)
+	{
+		GlyphQueue::Worker& worker = queue.workers[ii];
+		worker.queue = &queue;
+		worker.index = ii;
+		worker.buffer = new uint8_t[MAX_FONT_BUFFER_SIZE];
+		worker.distanceScratch = new uint8_t[distanceMapScratchSize()];
+		worker.thread.init(GlyphQueue::workerThread, &worker);
+	}
+}
+
+void FontManager::stopWorkers()
+{
+	GlyphQueue& queue = *m_glyphQueue;
+	if (0 == queue.numWorkers)
+	{
+		return;
+	}
+
+	// Workers finish all queued requests before they exit.
+	{
+		bx::LwMutexScope scope(queue.mutex);
+		queue.exit = true;
+	}
+
+	queue.sem.post(queue.numWorkers);
+
+	for (uint32_t ii = 0; ii < queue.numWorkers; ++ii)
+	{
+		GlyphQueue::Worker& worker = queue.workers[ii];
+		worker.thread.shutdown();
+		delete [] worker.buffer;
+		delete [] worker.distanceScratch;
+	}
+
+	queue.numWorkers = 0;
+}
+
+void FontManager::addFinishedGlyphs()
+{
+	GlyphQueue& queue = *m_glyphQueue;
+
+	uint32_t numResults;
+	{
+		bx::LwMutexScope scope(queue.mutex);
+		numResults = queue.numResults;
+		GlyphResult* results = queue.results;
+		queue.results = queue.collected;
+		queue.collected = results;
+		queue.numResults = 0;
+	}
+
+	for (uint32_t ii = 0; ii < numResults; ++ii)
+	{
+		GlyphResult& result = queue.collected[ii];
+		CachedFont& font = m_cachedFonts[result.handle.idx];
+
+		font.pendingGlyphs.erase(result.codePoint);
+		--queue.numPending;
+
+		// Glyph might have been rasterized synchronously in the meantime.
+		if (NULL != result.data
+		&&  font.cachedGlyphs.end() == font.cachedGlyphs.find(result.codePoint) )
+		{
+			addGlyph(result.handle, result.codePoint, result.glyphInfo, result.data);
+		}
+
+		delete [] result.data;
+	}
+}
+
 bool FontManager::preloadGlyph(FontHandle _handle, const wchar_t* _string)
 {
 	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
@@ -579,6 +1135,12 @@ bool FontManager::preloadGlyph(FontHandle _handle, const wchar_t* _string)
 		return false;
 	}
 
+	if (FONT_TYPE_DISTANCE == font.fontInfo.fontType
+	||  FONT_TYPE_DISTANCE_SUBPIXEL == font.fontInfo.fontType)
+	{
+		return preloadDistanceGlyphs(_handle, _string);
+	}
+
 	for (uint32_t ii = 0, end = (uint32_t)wcslen(_string); ii < end; ++ii)
 	{
 		CodePoint codePoint = _string[ii];
@@ -591,6 +1153,93 @@ bool FontManager::preloadGlyph(FontHandle _handle, const wchar_t* _string)
 	return true;
 }
 
+struct DistanceGlyphBatch
+{
+	uint8_t* m_buffer;
+	uint8_t* m_scratch;
+	const GlyphInfo* m_glyphInfo;
+	uint32_t m_numGlyphs;
+	uint32_t m_numThreads;
+};
+
+static void makeDistanceMapBatch(uint32_t _thread, void* _userData)
+{
+	const DistanceGlyphBatch& batch = *(const DistanceGlyphBatch*)_userData;
+	uint8_t* scratch = batch.m_scratch + _thread*distanceMapScratchSize();
+
+	for (uint32_t ii = _thread; ii < batch.m_numGlyphs; ii += batch.m_numThreads)
+	{
+		const GlyphInfo& glyphInfo = batch.m_glyphInfo[ii];
+		if (0.0f < glyphInfo.width)
+		{
+			uint8_t* buffer = batch.m_buffer + ii*MAX_DISTANCE_GLYPH_SIZE*MAX_DISTANCE_GLYPH_SIZE;
+			makeDistanceMap(buffer, (uint32_t)glyphInfo.width, (uint32_t)glyphInfo.height, scratch);
+		}
+	}
+}
+
+bool FontManager::preloadDistanceGlyphs(FontHandle _handle, const wchar_t* _string)
+{
+	CachedFont& font = m_cachedFonts[_handle.idx];
+
+	CodePoint codePoints[MAX_DISTANCE_GLYPH_BATCH];
+	GlyphInfo glyphInfo[MAX_DISTANCE_GLYPH_BATCH];
+
+	DistanceGlyphBatch batch;
+	batch.m_buffer = m_buffer;
+	batch.m_scratch = m_distanceScratch;
+	batch.m_glyphInfo = glyphInfo;
+	batch.m_numGlyphs = 0;
+	batch.m_numThreads = m_numThreads;
+
+	// Glyphs are rasterized one by one, since FreeType face can't be used
+	// from multiple threads, and then distance fields of whole batch are
+	// computed in parallel.
+	for (uint32_t ii = 0, end = (uint32_t)wcslen(_string); ii <= end; ++ii)
+	{
+		if (ii < end)
+		{
+			CodePoint codePoint = _string[ii];
+
+			bool cached = font.cachedGlyphs.end() != font.cachedGlyphs.find(codePoint);
+			for (uint32_t jj = 0; jj < batch.m_numGlyphs && !cached; ++jj)
+			{
+				cached = codePoint == codePoints[jj];
+			}
+
+			if (cached)
+			{
+				continue;
+			}
+
+			uint8_t* buffer = m_buffer + batch.m_numGlyphs*MAX_DISTANCE_GLYPH_SIZE*MAX_DISTANCE_GLYPH_SIZE;
+			font.trueTypeFont->bakeGlyphDistance(codePoint, glyphInfo[batch.m_numGlyphs], buffer);
+			codePoints[batch.m_numGlyphs] = codePoint;
+			++batch.m_numGlyphs;
+
+			if (MAX_DISTANCE_GLYPH_BATCH != batch.m_numGlyphs)
+			{
+				continue;
+			}
+		}
+
+		bgfx::parallelFor(m_numThreads, makeDistanceMapBatch, &batch, m_numThreads);
+
+		for (uint32_t jj = 0; jj < batch.m_numGlyphs; ++jj)
+		{
+			uint8_t* buffer = m_buffer + jj*MAX_DISTANCE_GLYPH_SIZE*MAX_DISTANCE_GLYPH_SIZE;
+			if (!addGlyph(_handle, codePoints[jj], glyphInfo[jj], buffer) )
+			{
+				return false;
+			}
+		}
+
+		batch.m_numGlyphs = 0;
+	}
+
+	return true;
+}
+
 bool FontManager::preloadGlyph(FontHandle _handle, CodePoint _codePoint)
 {
 	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
@@ -606,39 +1255,9 @@ bool FontManager::preloadGlyph(FontHandle _handle, CodePoint _codePoint)
 	if (NULL != font.trueTypeFont)
 	{
 		GlyphInfo glyphInfo;
+		bakeGlyph(font.trueTypeFont, font.fontInfo.fontType, _codePoint, glyphInfo, m_buffer, m_distanceScratch);
 
-		switch (font.fontInfo.fontType)
-		{
-		case FONT_TYPE_ALPHA:
-			font.trueTypeFont->bakeGlyphAlpha(_codePoint, glyphInfo, m_buffer);
-			break;
-
-		case FONT_TYPE_DISTANCE:
-			font.trueTypeFont->bakeGlyphDistance(_codePoint, glyphInfo, m_buffer);
-			break;
-
-		case FONT_TYPE_DISTANCE_SUBPIXEL:
-			font.trueTypeFont->bakeGlyphDistance(_codePoint, glyphInfo, m_buffer);
-			break;
-
-		default:
-			BX_CHECK(false, "TextureType not supported yet");
-		}
-
-		if (!addBitmap(glyphInfo, m_buffer) )
-		{
-			return false;
-		}
-
-		glyphInfo.advance_x = (glyphInfo.advance_x * fontInfo.scale);
-		glyphInfo.advance_y = (glyphInfo.advance_y * fontInfo.scale);
-		glyphInfo.offset_x = (glyphInfo.offset_x * fontInfo.scale);
-		glyphInfo.offset_y = (glyphInfo.offset_y * fontInfo.scale);
-		glyphInfo.height = (glyphInfo.height * fontInfo.scale);
-		glyphInfo.width = (glyphInfo.width * fontInfo.scale);
-
-		font.cachedGlyphs[_codePoint] = glyphInfo;
-		return true;
+		return addGlyph(_handle, _codePoint, glyphInfo, m_buffer);
 	}
 
 	if (isValid(font.masterFontHandle)
@@ -686,6 +1305,28 @@ const GlyphInfo* FontManager::getGlyphInfo(FontHandle _handle, CodePoint _codePo
 	return &it->second;
 }
 
+bool FontManager::addGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _glyphInfo, const uint8_t* _data)
+{
+	CachedFont& font = m_cachedFonts[_handle.idx];
+	const FontInfo& fontInfo = font.fontInfo;
+
+	if (!addBitmap(_glyphInfo, _data) )
+	{
+		return false;
+	}
+
+	_glyphInfo.advance_x = (_glyphInfo.advance_x * fontInfo.scale);
+	_glyphInfo.advance_y = (_glyphInfo.advance_y * fontInfo.scale);
+	_glyphInfo.offset_x = (_glyphInfo.offset_x * fontInfo.scale);
+	_glyphInfo.offset_y = (_glyphInfo.offset_y * fontInfo.scale);
+	_glyphInfo.height = (_glyphInfo.height * fontInfo.scale);
+	_glyphInfo.width = (_glyphInfo.width * fontInfo.scale);
+
+	font.cachedGlyphs[_codePoint] = _glyphInfo;
+	++m_numGlyphs;
+	return true;
+}
+
 bool FontManager::addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data)
 {
 	_glyphInfo.regionIndex = m_atlas->addRegion( (uint16_t) ceil(_glyphInfo.width), (uint16_t) ceil(_glyphInfo.height), _data, AtlasRegion::TYPE_GRAY);
@@ -10,6 +10,7 @@
 #include <bgfx.h>
 
 class Atlas;
+namespace bx { struct WriterI; }
 
 #define MAX_OPENED_FILES 64
 #define MAX_OPENED_FONT  64
@@ -116,6 +117,22 @@ struct GlyphInfo
 BGFX_HANDLE(TrueTypeHandle);
 BGFX_HANDLE(FontHandle);
 
+/// Glyph and atlas upload statistics, see FontManager::update.
+struct FontManagerStats
+{
+	/// Glyphs added to atlas since previous update.
+	uint32_t numGlyphs;
+
+	/// Requested glyphs not yet added to atlas.
+	uint32_t numPending;
+
+	/// Texture updates issued by last update.
+	uint32_t numUpdates;
+
+	/// Bytes uploaded to atlas texture by last update.
+	uint32_t uploadSize;
+};
+
 class FontManager
 {
 public:
@@ -162,6 +179,46 @@ public:
 	/// Preload a single glyph, return true on success.
 	bool preloadGlyph(FontHandle _handle, CodePoint _character);
 
+	/// Request glyphs to be rasterized on worker threads, each with its own
+	/// FreeType face. Glyphs are added to atlas by update, glyphs used
+	/// before that are rasterized on calling thread as usual.
+	///
+	/// @return False if font is not a TrueType font or request queue is
+	///   full.
+	bool requestGlyphs(FontHandle _handle, const wchar_t* _string);
+
+	/// Add glyphs finished by worker threads to atlas, and upload atlas
+	/// changes to texture with one update per dirty rectangle. Call once
+	/// per frame, before submitting text.
+	void update();
+
+	/// Return glyph and upload statistics of last update.
+	const FontManagerStats& getStats() const
+	{
+		return m_stats;
+	}
+
+	/// Set number of threads, including calling thread, used to compute
+	/// distance field of glyphs preloaded together from a string. This is
+	/// also number of worker threads used for requested glyphs.
+	void setNumThreads(uint32_t _numThreads);
+
+	/// Write glyphs of fonts created from TrueType files, atlas regions and
+	/// atlas texture as font cache.
+	void saveCache(bx::WriterI* _writer) const;
+
+	/// Load font cache written by saveCache. Fonts created afterwards from
+	/// the same TrueType file, typeface, pixel size and font type start
+	/// with cached glyphs instead of rasterizing them.
+	///
+	/// @param _data Font cache. Atlas texture is created by reference to
+	///   it, without copy, so it must stay valid until font manager is
+	///   destroyed.
+	///
+	/// @return False if cache is invalid, if atlas is external, or if fonts
+	///   were already created.
+	bool loadCache(const void* _data, uint32_t _size);
+
 	/// Return the font descriptor of a font.
 	///
 	/// @remark the handle is required to be valid
@@ -183,9 +240,17 @@ private:
 	{
 		uint8_t* buffer;
 		uint32_t bufferSize;
+		uint32_t hash;
 	};
 
+	struct GlyphQueue;
+
 	void init();
+	void startWorkers();
+	void stopWorkers();
+	void addFinishedGlyphs();
+	bool preloadDistanceGlyphs(FontHandle _handle, const wchar_t* _string);
+	bool addGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _glyphInfo, const uint8_t* _data);
 	bool addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data);
 
 	bool m_ownAtlas;
@@ -199,8 +264,19 @@ private:
 
 	GlyphInfo m_blackGlyph;
 
+	//font cache loaded by loadCache
+	const uint8_t* m_cache;
+
 	//temporary buffer to raster glyph
 	uint8_t* m_buffer;
+
+	//scratch memory for distance field, per thread
+	uint8_t* m_distanceScratch;
+	uint32_t m_numThreads;
+
+	GlyphQueue* m_glyphQueue;
+	FontManagerStats m_stats;
+	uint32_t m_numGlyphs;
 };
 
 #endif // FONT_MANAGER_H_HEADER_GUARD
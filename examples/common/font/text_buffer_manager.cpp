@@ -6,6 +6,7 @@
 #include "../common.h"
 
 #include <bgfx.h>
+#include <bx/uint32_t.h>
 #include <stddef.h> // offsetof
 #include <memory.h> // memcpy
 #include <wchar.h>  // wcslen
@@ -22,9 +23,17 @@
 #include "fs_font_distance_field_subpixel.bin.h"
 
 #define MAX_BUFFERED_CHARACTERS (8192 - 5)
+#define MAX_TEXT_DIRTY_RANGES 8
 
 class TextBuffer
 {
+	struct TextVertex
+	{
+		float x, y;
+		int16_t u, v, w, t;
+		uint32_t rgba;
+	};
+
 public:
 
 	/// TextBuffer is bound to a fontManager for glyph retrieval
@@ -128,8 +137,35 @@ public:
 		return m_rectangle;
 	}
 
+	/// Number of vertex ranges modified since last clearDirtyRanges.
+	uint32_t getNumDirtyRanges() const
+	{
+		return m_numDirtyRanges;
+	}
+
+	/// Get vertex range modified since last clearDirtyRanges, clamped
+	/// to current vertex count. Returns false if range is empty.
+	bool getDirtyRange(uint32_t _idx, uint32_t& _startVertex, uint32_t& _numVertices) const
+	{
+		const DirtyRange& range = m_dirtyRanges[_idx];
+		const uint32_t end = range.end < m_vertexCount ? range.end : m_vertexCount;
+		_startVertex = range.begin;
+		_numVertices = end > range.begin ? end - range.begin : 0;
+		return 0 != _numVertices;
+	}
+
+	/// Mark vertices as uploaded. Rewritten vertices that don't change
+	/// won't be reported as dirty until buffer grows past current size.
+	void clearDirtyRanges()
+	{
+		m_numDirtyRanges = 0;
+		m_cleanVertexCount = m_vertexCount;
+	}
+
 private:
 	void appendGlyph(FontHandle _handle, CodePoint _codePoint);
+	void appendQuad(float _x0, float _y0, float _x1, float _y1, uint32_t _rgba, uint8_t _style, const TextVertex* _uv);
+	void addDirtyRange(uint32_t _begin, uint32_t _end);
 	void verticalCenterLastLine(float _txtDecalY, float _top, float _bottom);
 
 	static uint32_t toABGR(uint32_t _rgba)
@@ -165,19 +201,10 @@ private:
 	TextRectangle m_rectangle;
 	FontManager* m_fontManager;
 
-	void setVertex(uint32_t _i, float _x, float _y, uint32_t _rgba, uint8_t _style = STYLE_NORMAL)
+	struct DirtyRange
 	{
-		m_vertexBuffer[_i].x = _x;
-		m_vertexBuffer[_i].y = _y;
-		m_vertexBuffer[_i].rgba = _rgba;
-		m_styleBuffer[_i] = _style;
-	}
-
-	struct TextVertex
-	{
-		float x, y;
-		int16_t u, v, w, t;
-		uint32_t rgba;
+		uint32_t begin;
+		uint32_t end;
 	};
 
 	TextVertex* m_vertexBuffer;
@@ -187,6 +214,10 @@ private:
 	uint32_t m_vertexCount;
 	uint32_t m_indexCount;
 	uint32_t m_lineStartIndex;
+
+	DirtyRange m_dirtyRanges[MAX_TEXT_DIRTY_RANGES];
+	uint32_t m_numDirtyRanges;
+	uint32_t m_cleanVertexCount;
 };
 
 TextBuffer::TextBuffer(FontManager* _fontManager)
@@ -210,6 +241,8 @@ TextBuffer::TextBuffer(FontManager* _fontManager)
 	, m_vertexCount(0)
 	, m_indexCount(0)
 	, m_lineStartIndex(0)
+	, m_numDirtyRanges(0)
+	, m_cleanVertexCount(0)
 {
 	m_rectangle.width = 0;
 	m_rectangle.height = 0;
@@ -283,25 +316,14 @@ void TextBuffer::appendAtlasFace(uint16_t _faceIndex)
 	float x1 = x0 + (float)m_fontManager->getAtlas()->getTextureSize();
 	float y1 = y0 + (float)m_fontManager->getAtlas()->getTextureSize();
 
+	TextVertex uv[4];
 	m_fontManager->getAtlas()->packFaceLayerUV(_faceIndex
-		, (uint8_t*)m_vertexBuffer
-		, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
+		, (uint8_t*)uv
+		, offsetof(TextVertex, u)
 		, sizeof(TextVertex)
 		);
 
-	setVertex(m_vertexCount + 0, x0, y0, m_backgroundColor);
-	setVertex(m_vertexCount + 1, x0, y1, m_backgroundColor);
-	setVertex(m_vertexCount + 2, x1, y1, m_backgroundColor);
-	setVertex(m_vertexCount + 3, x1, y0, m_backgroundColor);
-
-	m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
-	m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
-	m_indexBuffer[m_indexCount + 2] = m_vertexCount + 2;
-	m_indexBuffer[m_indexCount + 3] = m_vertexCount + 0;
-	m_indexBuffer[m_indexCount + 4] = m_vertexCount + 2;
-	m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
-	m_vertexCount += 4;
-	m_indexCount += 6;
+	appendQuad(x0, y0, x1, y1, m_backgroundColor, STYLE_NORMAL, uv);
 }
 
 void TextBuffer::clearTextBuffer()
@@ -370,6 +392,13 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 	const GlyphInfo& blackGlyph = m_fontManager->getBlackGlyph();
 	const Atlas* atlas = m_fontManager->getAtlas();
 
+	TextVertex blackUv[4];
+	atlas->packUV(blackGlyph.regionIndex
+		, (uint8_t*)blackUv
+		, offsetof(TextVertex, u)
+		, sizeof(TextVertex)
+		);
+
 	if (m_styleFlags & STYLE_BACKGROUND
 	&&  m_backgroundColor & 0xFF000000)
 	{
@@ -378,25 +407,7 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 		float x1 = ( (float)x0 + (glyph->advance_x) );
 		float y1 = (m_penY + m_lineAscender - m_lineDescender + m_lineGap);
 
-		atlas->packUV(blackGlyph.regionIndex
-			, (uint8_t*)m_vertexBuffer
-			, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
-			, sizeof(TextVertex)
-			);
-
-		setVertex(m_vertexCount + 0, x0, y0, m_backgroundColor, STYLE_BACKGROUND);
-		setVertex(m_vertexCount + 1, x0, y1, m_backgroundColor, STYLE_BACKGROUND);
-		setVertex(m_vertexCount + 2, x1, y1, m_backgroundColor, STYLE_BACKGROUND);
-		setVertex(m_vertexCount + 3, x1, y0, m_backgroundColor, STYLE_BACKGROUND);
-
-		m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
-		m_indexBuffer[m_indexCount + 2] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 3] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 4] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
-		m_vertexCount += 4;
-		m_indexCount += 6;
+		appendQuad(x0, y0, x1, y1, m_backgroundColor, STYLE_BACKGROUND, blackUv);
 	}
 
 	if (m_styleFlags & STYLE_UNDERLINE
@@ -407,25 +418,7 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 		float x1 = ( (float)x0 + (glyph->advance_x) );
 		float y1 = y0 + font.underlineThickness;
 
-		atlas->packUV(blackGlyph.regionIndex
-			, (uint8_t*)m_vertexBuffer
-			, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
-			, sizeof(TextVertex)
-			);
-
-		setVertex(m_vertexCount + 0, x0, y0, m_underlineColor, STYLE_UNDERLINE);
-		setVertex(m_vertexCount + 1, x0, y1, m_underlineColor, STYLE_UNDERLINE);
-		setVertex(m_vertexCount + 2, x1, y1, m_underlineColor, STYLE_UNDERLINE);
-		setVertex(m_vertexCount + 3, x1, y0, m_underlineColor, STYLE_UNDERLINE);
-
-		m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
-		m_indexBuffer[m_indexCount + 2] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 3] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 4] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
-		m_vertexCount += 4;
-		m_indexCount += 6;
+		appendQuad(x0, y0, x1, y1, m_underlineColor, STYLE_UNDERLINE, blackUv);
 	}
 
 	if (m_styleFlags & STYLE_OVERLINE
@@ -436,25 +429,7 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 		float x1 = ( (float)x0 + (glyph->advance_x) );
 		float y1 = y0 + font.underlineThickness;
 
-		m_fontManager->getAtlas()->packUV(blackGlyph.regionIndex
-			, (uint8_t*)m_vertexBuffer
-			, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
-			, sizeof(TextVertex)
-			);
-
-		setVertex(m_vertexCount + 0, x0, y0, m_overlineColor, STYLE_OVERLINE);
-		setVertex(m_vertexCount + 1, x0, y1, m_overlineColor, STYLE_OVERLINE);
-		setVertex(m_vertexCount + 2, x1, y1, m_overlineColor, STYLE_OVERLINE);
-		setVertex(m_vertexCount + 3, x1, y0, m_overlineColor, STYLE_OVERLINE);
-
-		m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
-		m_indexBuffer[m_indexCount + 2] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 3] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 4] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
-		m_vertexCount += 4;
-		m_indexCount += 6;
+		appendQuad(x0, y0, x1, y1, m_overlineColor, STYLE_OVERLINE, blackUv);
 	}
 
 	if (m_styleFlags & STYLE_STRIKE_THROUGH
@@ -465,25 +440,7 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 		float x1 = ( (float)x0 + (glyph->advance_x) );
 		float y1 = y0 + font.underlineThickness;
 
-		atlas->packUV(blackGlyph.regionIndex
-			, (uint8_t*)m_vertexBuffer
-			, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
-			, sizeof(TextVertex)
-			);
-
-		setVertex(m_vertexCount + 0, x0, y0, m_strikeThroughColor, STYLE_STRIKE_THROUGH);
-		setVertex(m_vertexCount + 1, x0, y1, m_strikeThroughColor, STYLE_STRIKE_THROUGH);
-		setVertex(m_vertexCount + 2, x1, y1, m_strikeThroughColor, STYLE_STRIKE_THROUGH);
-		setVertex(m_vertexCount + 3, x1, y0, m_strikeThroughColor, STYLE_STRIKE_THROUGH);
-
-		m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
-		m_indexBuffer[m_indexCount + 2] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 3] = m_vertexCount + 0;
-		m_indexBuffer[m_indexCount + 4] = m_vertexCount + 2;
-		m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
-		m_vertexCount += 4;
-		m_indexCount += 6;
+		appendQuad(x0, y0, x1, y1, m_strikeThroughColor, STYLE_STRIKE_THROUGH, blackUv);
 	}
 
 	float x0 = m_penX + (glyph->offset_x);
@@ -491,16 +448,51 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 	float x1 = (x0 + glyph->width);
 	float y1 = (y0 + glyph->height);
 
+	TextVertex uv[4];
 	atlas->packUV(glyph->regionIndex
-		, (uint8_t*)m_vertexBuffer
-		, sizeof(TextVertex) * m_vertexCount + offsetof(TextVertex, u)
+		, (uint8_t*)uv
+		, offsetof(TextVertex, u)
 		, sizeof(TextVertex)
 		);
 
-	setVertex(m_vertexCount + 0, x0, y0, m_textColor);
-	setVertex(m_vertexCount + 1, x0, y1, m_textColor);
-	setVertex(m_vertexCount + 2, x1, y1, m_textColor);
-	setVertex(m_vertexCount + 3, x1, y0, m_textColor);
+	appendQuad(x0, y0, x1, y1, m_textColor, STYLE_NORMAL, uv);
+
+	m_penX += glyph->advance_x;
+	if (m_penX > m_rectangle.width)
+	{
+		m_rectangle.width = m_penX;
+	}
+
+	if ( (m_penY +m_lineAscender - m_lineDescender+m_lineGap) > m_rectangle.height)
+	{
+		m_rectangle.height = (m_penY +m_lineAscender - m_lineDescender+m_lineGap);
+	}
+}
+
+void TextBuffer::appendQuad(float _x0, float _y0, float _x1, float _y1, uint32_t _rgba, uint8_t _style, const TextVertex* _uv)
+{
+	TextVertex quad[4];
+	memcpy(quad, _uv, sizeof(quad) );
+	quad[0].x = _x0; quad[0].y = _y0;
+	quad[1].x = _x0; quad[1].y = _y1;
+	quad[2].x = _x1; quad[2].y = _y1;
+	quad[3].x = _x1; quad[3].y = _y0;
+
+	for (uint32_t ii = 0; ii < 4; ++ii)
+	{
+		quad[ii].rgba = _rgba;
+		m_styleBuffer[m_vertexCount + ii] = _style;
+	}
+
+	// When text is rebuilt with the same layout, most quads are identical
+	// to the ones already uploaded, and only changed quads become dirty.
+	TextVertex* vertex = &m_vertexBuffer[m_vertexCount];
+	if (m_vertexCount + 4 > m_cleanVertexCount
+	||  0 != memcmp(vertex, quad, sizeof(quad) ) )
+	{
+		memcpy(vertex, quad, sizeof(quad) );
+		addDirtyRange(m_vertexCount, m_vertexCount + 4);
+	}
 
 	m_indexBuffer[m_indexCount + 0] = m_vertexCount + 0;
 	m_indexBuffer[m_indexCount + 1] = m_vertexCount + 1;
@@ -510,21 +502,56 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 	m_indexBuffer[m_indexCount + 5] = m_vertexCount + 3;
 	m_vertexCount += 4;
 	m_indexCount += 6;
+}
 
-	m_penX += glyph->advance_x;
-	if (m_penX > m_rectangle.width)
+void TextBuffer::addDirtyRange(uint32_t _begin, uint32_t _end)
+{
+	for (uint32_t ii = 0; ii < m_numDirtyRanges; ++ii)
 	{
-		m_rectangle.width = m_penX;
+		DirtyRange& range = m_dirtyRanges[ii];
+		if (_begin <= range.end
+		&&  _end >= range.begin)
+		{
+			range.begin = bx::uint32_min(range.begin, _begin);
+			range.end = bx::uint32_max(range.end, _end);
+			return;
+		}
 	}
 
-	if ( (m_penY +m_lineAscender - m_lineDescender+m_lineGap) > m_rectangle.height)
+	if (m_numDirtyRanges < MAX_TEXT_DIRTY_RANGES)
 	{
-		m_rectangle.height = (m_penY +m_lineAscender - m_lineDescender+m_lineGap);
+		DirtyRange& range = m_dirtyRanges[m_numDirtyRanges++];
+		range.begin = _begin;
+		range.end = _end;
+		return;
+	}
+
+	// Out of ranges, extend the closest one.
+	uint32_t closest = 0;
+	uint32_t closestGap = UINT32_MAX;
+	for (uint32_t ii = 0; ii < m_numDirtyRanges; ++ii)
+	{
+		const DirtyRange& range = m_dirtyRanges[ii];
+		const uint32_t gap = _begin > range.end ? _begin - range.end : range.begin - _end;
+		if (gap < closestGap)
+		{
+			closest = ii;
+			closestGap = gap;
+		}
 	}
+
+	DirtyRange& range = m_dirtyRanges[closest];
+	range.begin = bx::uint32_min(range.begin, _begin);
+	range.end = bx::uint32_max(range.end, _end);
 }
 
 void TextBuffer::verticalCenterLastLine(float _dy, float _top, float _bottom)
 {
+	if (m_lineStartIndex < m_vertexCount)
+	{
+		addDirtyRange(m_lineStartIndex, m_vertexCount);
+	}
+
 	for (uint32_t ii = m_lineStartIndex; ii < m_vertexCount; ii += 4)
 	{
 		if (m_styleBuffer[ii] == STYLE_BACKGROUND)
@@ -546,6 +573,7 @@ void TextBuffer::verticalCenterLastLine(float _dy, float _top, float _bottom)
 
 TextBufferManager::TextBufferManager(FontManager* _fontManager)
 	: m_fontManager(_fontManager)
+	, m_uploadSize(0)
 {
 	m_textBuffers = new BufferCache[MAX_TEXT_BUFFER_COUNT];
 
@@ -638,6 +666,8 @@ TextBufferHandle TextBufferManager::createTextBuffer(uint32_t _type, BufferType:
 	bc.bufferType = _bufferType;
 	bc.indexBufferHandleIdx = bgfx::invalidHandle;
 	bc.vertexBufferHandleIdx = bgfx::invalidHandle;
+	bc.vertexCapacity = 0;
+	bc.uploadedIndexCount = 0;
 
 	TextBufferHandle ret = {textIdx};
 	return ret;
@@ -672,12 +702,14 @@ void TextBufferManager::destroyTextBuffer(TextBufferHandle _handle)
 		break;
 
 	case BufferType::Dynamic:
-		bgfx::DynamicIndexBufferHandle ibh;
-		bgfx::DynamicVertexBufferHandle vbh;
-		ibh.idx = bc.indexBufferHandleIdx;
-		vbh.idx = bc.vertexBufferHandleIdx;
-		bgfx::destroyDynamicIndexBuffer(ibh);
-		bgfx::destroyDynamicVertexBuffer(vbh);
+		{
+			bgfx::DynamicIndexBufferHandle ibh;
+			bgfx::DynamicVertexBufferHandle vbh;
+			ibh.idx = bc.indexBufferHandleIdx;
+			vbh.idx = bc.vertexBufferHandleIdx;
+			bgfx::destroyDynamicIndexBuffer(ibh);
+			bgfx::destroyDynamicVertexBuffer(vbh);
+		}
 
 		break;
 
@@ -751,6 +783,8 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, uint8_t _id,
 
 				bc.indexBufferHandleIdx = ibh.idx;
 				bc.vertexBufferHandleIdx = vbh.idx;
+
+				m_uploadSize += indexSize + vertexSize;
 			}
 			else
 			{
@@ -759,44 +793,78 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, uint8_t _id,
 			}
 
 			bgfx::setVertexBuffer(vbh, bc.textBuffer->getVertexCount() );
-			bgfx::setIndexBuffer(ibh, bc.textBuffer->getIndexCount() );
+			bgfx::setIndexBuffer(ibh, 0, bc.textBuffer->getIndexCount() );
 		}
 		break;
 
 	case BufferType::Dynamic:
 		{
+			TextBuffer* textBuffer = bc.textBuffer;
+			const uint32_t vertexCount = textBuffer->getVertexCount();
+			const uint32_t indexCount = textBuffer->getIndexCount();
+
 			bgfx::DynamicIndexBufferHandle ibh;
 			bgfx::DynamicVertexBufferHandle vbh;
+			ibh.idx = bc.indexBufferHandleIdx;
+			vbh.idx = bc.vertexBufferHandleIdx;
 
-			if (bgfx::invalidHandle == bc.vertexBufferHandleIdx )
+			if (bgfx::invalidHandle == bc.vertexBufferHandleIdx
+			||  vertexCount > bc.vertexCapacity)
 			{
-				mem = bgfx::alloc(indexSize);
-				memcpy(mem->data, bc.textBuffer->getIndexBuffer(), indexSize);
-				ibh = bgfx::createDynamicIndexBuffer(mem);
+				if (bgfx::invalidHandle != bc.vertexBufferHandleIdx)
+				{
+					bgfx::destroyDynamicIndexBuffer(ibh);
+					bgfx::destroyDynamicVertexBuffer(vbh);
+				}
+
+				// Grow geometrically so that text growing by few glyphs
+				// per frame doesn't recreate buffers every frame.
+				bc.vertexCapacity = bx::uint32_min(bx::uint32_max(vertexCount, bc.vertexCapacity*2), MAX_BUFFERED_CHARACTERS*4);
+				ibh = bgfx::createDynamicIndexBuffer(bc.vertexCapacity/4*6);
+				vbh = bgfx::createDynamicVertexBuffer(uint16_t(bc.vertexCapacity), m_vertexDecl);
 
 				mem = bgfx::alloc(vertexSize);
-				memcpy(mem->data, bc.textBuffer->getVertexBuffer(), vertexSize);
-				vbh = bgfx::createDynamicVertexBuffer(mem, m_vertexDecl);
+				memcpy(mem->data, textBuffer->getVertexBuffer(), vertexSize);
+				bgfx::updateDynamicVertexBuffer(vbh, 0, mem);
+				m_uploadSize += mem->size;
 
 				bc.indexBufferHandleIdx = ibh.idx;
 				bc.vertexBufferHandleIdx = vbh.idx;
+				bc.uploadedIndexCount = 0;
 			}
 			else
 			{
-				ibh.idx = bc.indexBufferHandleIdx;
-				vbh.idx = bc.vertexBufferHandleIdx;
+				const uint32_t vertexStride = textBuffer->getVertexSize();
+				for (uint32_t ii = 0, num = textBuffer->getNumDirtyRanges(); ii < num; ++ii)
+				{
+					uint32_t startVertex;
+					uint32_t numVertices;
+					if (textBuffer->getDirtyRange(ii, startVertex, numVertices) )
+					{
+						mem = bgfx::alloc(numVertices*vertexStride);
+						memcpy(mem->data, textBuffer->getVertexBuffer() + startVertex*vertexStride, mem->size);
+						bgfx::updateDynamicVertexBuffer(vbh, startVertex, mem);
+						m_uploadSize += mem->size;
+					}
+				}
+			}
 
-				mem = bgfx::alloc(indexSize);
-				memcpy(mem->data, bc.textBuffer->getIndexBuffer(), indexSize);
-				bgfx::updateDynamicIndexBuffer(ibh, mem);
+			textBuffer->clearDirtyRanges();
 
-				mem = bgfx::alloc(vertexSize);
-				memcpy(mem->data, bc.textBuffer->getVertexBuffer(), vertexSize);
-				bgfx::updateDynamicVertexBuffer(vbh, mem);
+			// Indices depend only on glyph count, upload only new ones.
+			if (indexCount > bc.uploadedIndexCount)
+			{
+				const uint32_t indexStride = textBuffer->getIndexSize();
+				mem = bgfx::alloc( (indexCount - bc.uploadedIndexCount)*indexStride);
+				memcpy(mem->data, textBuffer->getIndexBuffer() + bc.uploadedIndexCount, mem->size);
+				bgfx::updateDynamicIndexBuffer(ibh, bc.uploadedIndexCount, mem);
+				m_uploadSize += mem->size;
+
+				bc.uploadedIndexCount = indexCount;
 			}
 
-			bgfx::setVertexBuffer(vbh, bc.textBuffer->getVertexCount() );
-			bgfx::setIndexBuffer(ibh, bc.textBuffer->getIndexCount() );
+			bgfx::setVertexBuffer(vbh, vertexCount);
+			bgfx::setIndexBuffer(ibh, 0, indexCount);
 		}
 		break;
 
@@ -808,6 +876,7 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, uint8_t _id,
 			bgfx::allocTransientVertexBuffer(&tvb, bc.textBuffer->getVertexCount(), m_vertexDecl);
 			memcpy(tib.data, bc.textBuffer->getIndexBuffer(), indexSize);
 			memcpy(tvb.data, bc.textBuffer->getVertexBuffer(), vertexSize);
+			m_uploadSize += indexSize + vertexSize;
 			bgfx::setVertexBuffer(&tvb, bc.textBuffer->getVertexCount() );
 			bgfx::setIndexBuffer(&tib, bc.textBuffer->getIndexCount() );
 		}
@@ -894,6 +963,16 @@ void TextBufferManager::clearTextBuffer(TextBufferHandle _handle)
 	bc.textBuffer->clearTextBuffer();
 }
 
+uint32_t TextBufferManager::getUploadSize() const
+{
+	return m_uploadSize;
+}
+
+void TextBufferManager::resetUploadSize()
+{
+	m_uploadSize = 0;
+}
+
 TextRectangle TextBufferManager::getRectangle(TextBufferHandle _handle) const
 {
 	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
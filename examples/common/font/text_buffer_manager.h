@@ -73,6 +73,13 @@ public:
 	
 	/// Return the rectangular size of the current text buffer (including all its content).
 	TextRectangle getRectangle(TextBufferHandle _handle) const;	
+
+	/// Return number of vertex and index bytes uploaded by submitTextBuffer since last resetUploadSize.
+	/// Dynamic text buffers upload only glyphs that changed since their previous submit.
+	uint32_t getUploadSize() const;
+
+	/// Reset upload size counter, call it once per frame to measure upload per frame.
+	void resetUploadSize();
 	
 private:
 	struct BufferCache
@@ -82,6 +89,8 @@ private:
 		TextBuffer* textBuffer;
 		BufferType::Enum bufferType;
 		uint32_t fontType;
+		uint32_t vertexCapacity;
+		uint32_t uploadedIndexCount;
 	};
 
 	BufferCache* m_textBuffers;
@@ -92,6 +101,7 @@ private:
 	bgfx::ProgramHandle m_basicProgram;
 	bgfx::ProgramHandle m_distanceProgram;
 	bgfx::ProgramHandle m_distanceSubpixelProgram;
+	uint32_t m_uploadSize;
 };
 
 #endif // TEXT_BUFFER_MANAGER_H_HEADER_GUARD
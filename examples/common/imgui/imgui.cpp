@@ -24,6 +24,7 @@
 // Source altered and distributed from https://github.com/AdrienHerubel/imgui
 
 #include <stdio.h>
+#include <vector>
 #include <bx/string.h>
 #include <bx/uint32_t.h>
 #include <bgfx.h>
@@ -32,13 +33,12 @@
 #include "imgui.h"
 #include "../fpumath.h"
 
-#include "vs_imgui_color.bin.h"
-#include "fs_imgui_color.bin.h"
 #include "vs_imgui_texture.bin.h"
 #include "fs_imgui_texture.bin.h"
 
 #define MAX_TEMP_COORDS 100
 #define NUM_CIRCLE_VERTS (8 * 4)
+#define WHITE_TEXEL_SIZE 4
 
 static const int32_t BUTTON_HEIGHT = 20;
 static const int32_t SLIDER_HEIGHT = 20;
@@ -66,25 +66,6 @@ static void imguiFree(void* _ptr, void* /*_userptr*/)
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb_truetype/stb_truetype.h>
 
-struct PosColorVertex
-{
-	float m_x;
-	float m_y;
-	uint32_t m_abgr;
-
-	static void init()
-	{
-		ms_decl.begin();
-		ms_decl.add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float);
-		ms_decl.add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true);
-		ms_decl.end();
-	}
-
-	static bgfx::VertexDecl ms_decl;
-};
-
-bgfx::VertexDecl PosColorVertex::ms_decl;
-
 struct PosColorUvVertex
 {
 	float m_x;
@@ -144,14 +125,18 @@ struct Imgui
 		, m_textureWidth(512)
 		, m_textureHeight(512)
 		, m_halfTexel(0.0f)
+		, m_whiteU(0.0f)
+		, m_whiteV(0.0f)
 		, m_view(31)
 	{
 		m_invTextureWidth  = 1.0f/m_textureWidth;
 		m_invTextureHeight = 1.0f/m_textureHeight;
 
+		memset(&m_stats, 0, sizeof(m_stats) );
+		memset(&m_frameStats, 0, sizeof(m_frameStats) );
+
 		u_texColor.idx = bgfx::invalidHandle;
 		m_fontTexture.idx = bgfx::invalidHandle;
-		m_colorProgram.idx = bgfx::invalidHandle;
 		m_textureProgram.idx = bgfx::invalidHandle;
 	}
 
@@ -164,36 +149,27 @@ struct Imgui
 			m_circleVerts[ii * 2 + 1] = sinf(a);
 		}
 
-		PosColorVertex::init();
 		PosColorUvVertex::init();
 
 		u_texColor  = bgfx::createUniform("u_texColor", bgfx::UniformType::Uniform1i);
 
-		const bgfx::Memory* vs_imgui_color;
-		const bgfx::Memory* fs_imgui_color;
 		const bgfx::Memory* vs_imgui_texture;
 		const bgfx::Memory* fs_imgui_texture;
 
 		switch (bgfx::getRendererType() )
 		{
 		case bgfx::RendererType::Direct3D9:
-			vs_imgui_color   = bgfx::makeRef(vs_imgui_color_dx9, sizeof(vs_imgui_color_dx9) );
-			fs_imgui_color   = bgfx::makeRef(fs_imgui_color_dx9, sizeof(fs_imgui_color_dx9) );
 			vs_imgui_texture = bgfx::makeRef(vs_imgui_texture_dx9, sizeof(vs_imgui_texture_dx9) );
 			fs_imgui_texture = bgfx::makeRef(fs_imgui_texture_dx9, sizeof(fs_imgui_texture_dx9) );
 			m_halfTexel = 0.5f;
 			break;
 
 		case bgfx::RendererType::Direct3D11:
-			vs_imgui_color   = bgfx::makeRef(vs_imgui_color_dx11, sizeof(vs_imgui_color_dx11) );
-			fs_imgui_color   = bgfx::makeRef(fs_imgui_color_dx11, sizeof(fs_imgui_color_dx11) );
 			vs_imgui_texture = bgfx::makeRef(vs_imgui_texture_dx11, sizeof(vs_imgui_texture_dx11) );
 			fs_imgui_texture = bgfx::makeRef(fs_imgui_texture_dx11, sizeof(fs_imgui_texture_dx11) );
 			break;
 
 		default:
-			vs_imgui_color   = bgfx::makeRef(vs_imgui_color_glsl, sizeof(vs_imgui_color_glsl) );
-			fs_imgui_color   = bgfx::makeRef(fs_imgui_color_glsl, sizeof(fs_imgui_color_glsl) );
 			vs_imgui_texture = bgfx::makeRef(vs_imgui_texture_glsl, sizeof(vs_imgui_texture_glsl) );
 			fs_imgui_texture = bgfx::makeRef(fs_imgui_texture_glsl, sizeof(fs_imgui_texture_glsl) );
 			break;
@@ -202,12 +178,6 @@ struct Imgui
 		bgfx::VertexShaderHandle vsh;
 		bgfx::FragmentShaderHandle fsh;
 
-		vsh = bgfx::createVertexShader(vs_imgui_color);
-		fsh = bgfx::createFragmentShader(fs_imgui_color);
-		m_colorProgram = bgfx::createProgram(vsh, fsh);
-		bgfx::destroyVertexShader(vsh);
-		bgfx::destroyFragmentShader(fsh);
-
 		vsh = bgfx::createVertexShader(vs_imgui_texture);
 		fsh = bgfx::createFragmentShader(fs_imgui_texture);
 		m_textureProgram = bgfx::createProgram(vsh, fsh);
@@ -216,6 +186,17 @@ struct Imgui
 
 		const bgfx::Memory* mem = bgfx::alloc(m_textureWidth * m_textureHeight);
 		stbtt_BakeFontBitmap( (uint8_t*)_data, 0, 15.0f, mem->data, m_textureWidth, m_textureHeight, 32, 96, m_cdata);
+
+		// Solid white block in unused bottom-right corner of font texture.
+		// Untextured geometry samples it, so that polygons and text share
+		// program and texture, and can be batched together.
+		for (uint32_t yy = m_textureHeight - WHITE_TEXEL_SIZE; yy < m_textureHeight; ++yy)
+		{
+			memset(&mem->data[yy*m_textureWidth + m_textureWidth - WHITE_TEXEL_SIZE], 0xff, WHITE_TEXEL_SIZE);
+		}
+		m_whiteU = (m_textureWidth  - WHITE_TEXEL_SIZE/2) * m_invTextureWidth;
+		m_whiteV = (m_textureHeight - WHITE_TEXEL_SIZE/2) * m_invTextureHeight;
+
 		m_fontTexture = bgfx::createTexture2D(m_textureWidth, m_textureHeight, 1, bgfx::TextureFormat::L8, BGFX_TEXTURE_NONE, mem);
 
 		return true;
@@ -225,8 +206,11 @@ struct Imgui
 	{
 		bgfx::destroyUniform(u_texColor);
 		bgfx::destroyTexture(m_fontTexture);
-		bgfx::destroyProgram(m_colorProgram);
 		bgfx::destroyProgram(m_textureProgram);
+
+		m_vertices.clear();
+		m_indices.clear();
+		m_drawRuns.clear();
 	}
 
 	bool anyActive() const
@@ -365,9 +349,120 @@ struct Imgui
 
 	void endFrame()
 	{
+		submitDrawRuns();
 		clearInput();
 	}
 
+	const ImguiStats* getStats() const
+	{
+		return &m_stats;
+	}
+
+	/// Appends _numVertices vertices and _numIndices indices to the frame
+	/// draw list. Returned vertices and _indices are valid until the next
+	/// call. Indices must be offset by _firstVertex.
+	PosColorUvVertex* addDraw(bgfx::ProgramHandle _program, bgfx::TextureHandle _texture, uint32_t _numVertices, uint32_t _numIndices, uint16_t*& _indices, uint16_t& _firstVertex)
+	{
+		if (0 == _numVertices
+		||  _numVertices > UINT16_MAX+1)
+		{
+			return NULL;
+		}
+
+		const uint32_t vertexOffset = (uint32_t)m_vertices.size();
+		const uint32_t indexOffset  = (uint32_t)m_indices.size();
+
+		DrawRun* run = m_drawRuns.empty() ? NULL : &m_drawRuns.back();
+		if (NULL == run
+		||  run->m_program.idx != _program.idx
+		||  run->m_texture.idx != _texture.idx
+		||  run->m_scissor != m_scissor
+		||  run->m_numVertices + _numVertices > UINT16_MAX+1)
+		{
+			DrawRun newRun;
+			newRun.m_program = _program;
+			newRun.m_texture = _texture;
+			newRun.m_scissor = m_scissor;
+			newRun.m_startVertex = vertexOffset;
+			newRun.m_numVertices = 0;
+			newRun.m_startIndex = indexOffset;
+			newRun.m_numIndices = 0;
+			m_drawRuns.push_back(newRun);
+			run = &m_drawRuns.back();
+		}
+
+		_firstVertex = (uint16_t)run->m_numVertices;
+		run->m_numVertices += _numVertices;
+		run->m_numIndices  += _numIndices;
+
+		m_vertices.resize(vertexOffset + _numVertices);
+		m_indices.resize(indexOffset + _numIndices);
+		_indices = &m_indices[indexOffset];
+
+		m_frameStats.numPrimitives++;
+
+		return &m_vertices[vertexOffset];
+	}
+
+	void submitDrawRuns()
+	{
+		const uint32_t numVertices = (uint32_t)m_vertices.size();
+		const uint32_t numIndices  = (uint32_t)m_indices.size();
+
+		if (0 != numIndices
+		&&  bgfx::checkAvailTransientVertexBuffer(numVertices, PosColorUvVertex::ms_decl)
+		&&  bgfx::checkAvailTransientIndexBuffer(numIndices) )
+		{
+			bgfx::TransientVertexBuffer tvb;
+			bgfx::allocTransientVertexBuffer(&tvb, numVertices, PosColorUvVertex::ms_decl);
+			memcpy(tvb.data, &m_vertices[0], numVertices*sizeof(PosColorUvVertex) );
+
+			bgfx::TransientIndexBuffer tib;
+			bgfx::allocTransientIndexBuffer(&tib, numIndices);
+			memcpy(tib.data, &m_indices[0], numIndices*sizeof(uint16_t) );
+
+			for (uint32_t ii = 0, num = (uint32_t)m_drawRuns.size(); ii < num; ++ii)
+			{
+				const DrawRun& run = m_drawRuns[ii];
+
+				// Run indices are relative to its first vertex, so each run
+				// can address up to 64K vertices with 16-bit indices.
+				bgfx::TransientVertexBuffer runTvb = tvb;
+				runTvb.startVertex += run.m_startVertex;
+
+				bgfx::TransientIndexBuffer runTib = tib;
+				runTib.startIndex += run.m_startIndex;
+
+				if (bgfx::invalidHandle != run.m_texture.idx)
+				{
+					bgfx::setTexture(0, u_texColor, run.m_texture);
+				}
+
+				bgfx::setVertexBuffer(&runTvb, run.m_numVertices);
+				bgfx::setIndexBuffer(&runTib, run.m_numIndices);
+				bgfx::setState(0
+					| BGFX_STATE_RGB_WRITE
+					| BGFX_STATE_ALPHA_WRITE
+					| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
+					);
+				bgfx::setProgram(run.m_program);
+				bgfx::setScissor(run.m_scissor);
+				bgfx::submit(m_view);
+			}
+
+			m_frameStats.numDraws = (uint32_t)m_drawRuns.size();
+		}
+
+		m_frameStats.numVertices = numVertices;
+		m_frameStats.numIndices  = numIndices;
+		m_stats = m_frameStats;
+		memset(&m_frameStats, 0, sizeof(m_frameStats) );
+
+		m_vertices.clear();
+		m_indices.clear();
+		m_drawRuns.clear();
+	}
+
 	bool beginScrollArea(const char* _name, int32_t _x, int32_t _y, int32_t _width, int32_t _height, int32_t* _scroll)
 	{
 		m_areaId++;
@@ -1002,74 +1097,50 @@ struct Imgui
 			m_tempCoords[ii * 2 + 1] = _coords[ii * 2 + 1] + dmy * _r;
 		}
 
-		uint32_t numVertices = _numCoords*6 + (_numCoords-2)*3;
-		if (bgfx::checkAvailTransientVertexBuffer(numVertices, PosColorVertex::ms_decl) )
+		// Vertices 0..n-1 are polygon, n..2n-1 are faded out outline.
+		const uint32_t numVertices = _numCoords*2;
+		const uint32_t numIndices  = _numCoords*6 + (_numCoords-2)*3;
+
+		uint16_t* index;
+		uint16_t first;
+		PosColorUvVertex* vertex = addDraw(m_textureProgram, m_fontTexture, numVertices, numIndices, index, first);
+		if (NULL != vertex)
 		{
-			bgfx::TransientVertexBuffer tvb;
-			bgfx::allocTransientVertexBuffer(&tvb, numVertices, PosColorVertex::ms_decl);
 			uint32_t trans = _abgr&0xffffff;
 
-			PosColorVertex* vertex = (PosColorVertex*)tvb.data;
+			for (uint32_t ii = 0; ii < _numCoords; ++ii)
+			{
+				vertex[ii].m_x = _coords[ii*2+0];
+				vertex[ii].m_y = _coords[ii*2+1];
+				vertex[ii].m_u = m_whiteU;
+				vertex[ii].m_v = m_whiteV;
+				vertex[ii].m_abgr = _abgr;
+
+				vertex[_numCoords+ii].m_x = m_tempCoords[ii*2+0];
+				vertex[_numCoords+ii].m_y = m_tempCoords[ii*2+1];
+				vertex[_numCoords+ii].m_u = m_whiteU;
+				vertex[_numCoords+ii].m_v = m_whiteV;
+				vertex[_numCoords+ii].m_abgr = trans;
+			}
+
+			const uint16_t outer = uint16_t(first + _numCoords);
 			for (uint32_t ii = 0, jj = _numCoords-1; ii < _numCoords; jj = ii++)
 			{
-				vertex->m_x = _coords[ii*2+0];
-				vertex->m_y = _coords[ii*2+1];
-				vertex->m_abgr = _abgr;
-				++vertex;
-
-				vertex->m_x = _coords[jj*2+0];
-				vertex->m_y = _coords[jj*2+1];
-				vertex->m_abgr = _abgr;
-				++vertex;
-
-				vertex->m_x = m_tempCoords[jj*2+0];
-				vertex->m_y = m_tempCoords[jj*2+1];
-				vertex->m_abgr = trans;
-				++vertex;
-
-				vertex->m_x = m_tempCoords[jj*2+0];
-				vertex->m_y = m_tempCoords[jj*2+1];
-				vertex->m_abgr = trans;
-				++vertex;
-
-				vertex->m_x = m_tempCoords[ii*2+0];
-				vertex->m_y = m_tempCoords[ii*2+1];
-				vertex->m_abgr = trans;
-				++vertex;
-
-				vertex->m_x = _coords[ii*2+0];
-				vertex->m_y = _coords[ii*2+1];
-				vertex->m_abgr = _abgr;
-				++vertex;
+				*index++ = uint16_t(first + ii);
+				*index++ = uint16_t(first + jj);
+				*index++ = uint16_t(outer + jj);
+
+				*index++ = uint16_t(outer + jj);
+				*index++ = uint16_t(outer + ii);
+				*index++ = uint16_t(first + ii);
 			}
 
 			for (uint32_t ii = 2; ii < _numCoords; ++ii)
 			{
-				vertex->m_x = _coords[0];
-				vertex->m_y = _coords[1];
-				vertex->m_abgr = _abgr;
-				++vertex;
-
-				vertex->m_x = _coords[(ii-1)*2+0];
-				vertex->m_y = _coords[(ii-1)*2+1];
-				vertex->m_abgr = _abgr;
-				++vertex;
-
-				vertex->m_x = _coords[ii*2+0];
-				vertex->m_y = _coords[ii*2+1];
-				vertex->m_abgr = _abgr;
-				++vertex;
+				*index++ = first;
+				*index++ = uint16_t(first + ii-1);
+				*index++ = uint16_t(first + ii);
 			}
-
-			bgfx::setVertexBuffer(&tvb);
-			bgfx::setState(0
-				| BGFX_STATE_RGB_WRITE
-				| BGFX_STATE_ALPHA_WRITE
-				| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
-				);
-			bgfx::setProgram(m_colorProgram);
-			bgfx::setScissor(m_scissor);
-			bgfx::submit(m_view);
 		}
 	}
 
@@ -1274,12 +1345,14 @@ struct Imgui
 			getTextLength(m_cdata, _text, numVertices);
 		}
 
-		if (bgfx::checkAvailTransientVertexBuffer(numVertices, PosColorUvVertex::ms_decl) )
-		{
-			bgfx::TransientVertexBuffer tvb;
-			bgfx::allocTransientVertexBuffer(&tvb, numVertices, PosColorUvVertex::ms_decl);
+		// getTextLength counts 6 vertices per quad, indexed quad needs 4.
+		const uint32_t numQuads = numVertices/6;
 
-			PosColorUvVertex* vertex = (PosColorUvVertex*)tvb.data;
+		uint16_t* index;
+		uint16_t first;
+		PosColorUvVertex* vertex = addDraw(m_textureProgram, m_fontTexture, numQuads*4, numQuads*6, index, first);
+		if (NULL != vertex)
+		{
 
 			const float ox = _x;
 
@@ -1310,13 +1383,6 @@ struct Imgui
 					vertex->m_abgr = _abgr;
 					++vertex;
 
-					vertex->m_x = quad.x1;
-					vertex->m_y = quad.y1;
-					vertex->m_u = quad.s1;
-					vertex->m_v = quad.t1;
-					vertex->m_abgr = _abgr;
-					++vertex;
-
 					vertex->m_x = quad.x1;
 					vertex->m_y = quad.y0;
 					vertex->m_u = quad.s1;
@@ -1324,10 +1390,10 @@ struct Imgui
 					vertex->m_abgr = _abgr;
 					++vertex;
 
-					vertex->m_x = quad.x0;
-					vertex->m_y = quad.y0;
-					vertex->m_u = quad.s0;
-					vertex->m_v = quad.t0;
+					vertex->m_x = quad.x1;
+					vertex->m_y = quad.y1;
+					vertex->m_u = quad.s1;
+					vertex->m_v = quad.t1;
 					vertex->m_abgr = _abgr;
 					++vertex;
 
@@ -1338,27 +1404,17 @@ struct Imgui
 					vertex->m_abgr = _abgr;
 					++vertex;
 
-					vertex->m_x = quad.x1;
-					vertex->m_y = quad.y1;
-					vertex->m_u = quad.s1;
-					vertex->m_v = quad.t1;
-					vertex->m_abgr = _abgr;
-					++vertex;
+					*index++ = first + 0;
+					*index++ = first + 2;
+					*index++ = first + 1;
+					*index++ = first + 0;
+					*index++ = first + 3;
+					*index++ = first + 2;
+					first += 4;
 				}
 
 				++_text;
 			}
-
-			bgfx::setTexture(0, u_texColor, m_fontTexture);
-			bgfx::setVertexBuffer(&tvb);
-			bgfx::setState(0
-				| BGFX_STATE_RGB_WRITE
-				| BGFX_STATE_ALPHA_WRITE
-				| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
-				);
-			bgfx::setProgram(m_textureProgram);
-			bgfx::setScissor(m_scissor);
-			bgfx::submit(m_view);
 		}
 	}
 
@@ -1408,11 +1464,29 @@ struct Imgui
 	float m_invTextureWidth;
 	float m_invTextureHeight;
 	float m_halfTexel;
+	float m_whiteU;
+	float m_whiteV;
+
+	struct DrawRun
+	{
+		bgfx::ProgramHandle m_program;
+		bgfx::TextureHandle m_texture;
+		uint16_t m_scissor;
+		uint32_t m_startVertex;
+		uint32_t m_numVertices;
+		uint32_t m_startIndex;
+		uint32_t m_numIndices;
+	};
+
+	std::vector<PosColorUvVertex> m_vertices;
+	std::vector<uint16_t> m_indices;
+	std::vector<DrawRun> m_drawRuns;
+	ImguiStats m_frameStats;
+	ImguiStats m_stats;
 
 	uint8_t m_view;
 	bgfx::UniformHandle u_texColor;
 	bgfx::TextureHandle m_fontTexture;
-	bgfx::ProgramHandle m_colorProgram;
 	bgfx::ProgramHandle m_textureProgram;
 };
 
@@ -1438,6 +1512,11 @@ void imguiEndFrame()
 	s_imgui.endFrame();
 }
 
+const ImguiStats* imguiGetStats()
+{
+	return s_imgui.getStats();
+}
+
 bool imguiBeginScrollArea(const char* _name, int32_t _x, int32_t _y, int32_t _width, int32_t _height, int32_t* _scroll)
 {
 	return s_imgui.beginScrollArea(_name, _x, _y, _width, _height, _scroll);
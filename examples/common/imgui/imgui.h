@@ -49,12 +49,23 @@ inline uint32_t imguiRGBA(uint8_t _r, uint8_t _g, uint8_t _b, uint8_t _a = 255)
 		;
 }
 
+struct ImguiStats
+{
+	uint32_t numPrimitives; ///< Polygons and text runs, each was a draw call before batching.
+	uint32_t numDraws;      ///< Draw calls submitted after batching.
+	uint32_t numVertices;
+	uint32_t numIndices;
+};
+
 bool imguiCreate(const void* _data, uint32_t _size);
 void imguiDestroy();
 
 void imguiBeginFrame(int32_t _mx, int32_t _my, uint8_t _button, int32_t _scroll, uint16_t _width, uint16_t _height, uint8_t _view = 31);
 void imguiEndFrame();
 
+/// Returns draw statistics of last imguiEndFrame.
+const ImguiStats* imguiGetStats();
+
 bool imguiBeginScrollArea(const char* _name, int _x, int _y, int _width, int _height, int* _scroll);
 void imguiEndScrollArea();
 
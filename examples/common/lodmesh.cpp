@@ -0,0 +1,278 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "lodmesh.h"
+#include "meshloader.h"
+#include "entry/dbg.h"
+
+#include <bx/readerwriter.h>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Sizes of bounding volumes stored by geometryc.
+#define LODMESH_SPHERE_SIZE (4*sizeof(float) )
+#define LODMESH_AABB_SIZE (6*sizeof(float) )
+#define LODMESH_OBB_SIZE (16*sizeof(float) )
+
+// Size of meshlet stored in MSH chunk.
+#define LODMESH_MESHLET_SIZE 44
+
+bool LodMesh::load(const char* _filePath)
+{
+	bx::CrtFileReader reader;
+	if (0 != reader.open(_filePath) )
+	{
+		return false;
+	}
+
+	LodGroup group;
+	group.m_vbh.idx = bgfx::invalidHandle;
+	group.m_vbhStream.idx = bgfx::invalidHandle;
+	group.m_ibh.idx = bgfx::invalidHandle;
+
+	// Bounds of whole vertex buffer, used as level 0 bounds when file
+	// doesn't have LOD chunk.
+	LodLevel level0;
+	memset(&level0, 0, sizeof(level0) );
+
+	uint32_t chunk;
+	bool ok = true;
+	while (ok && 4 == bx::read(&reader, chunk) )
+	{
+		switch (chunk)
+		{
+		case BGFX_CHUNK_MAGIC_VB:
+		case BGFX_CHUNK_MAGIC_VB32:
+		case BGFX_CHUNK_MAGIC_VBC:
+			{
+				bx::read(&reader, level0.m_center);
+				bx::read(&reader, level0.m_radius);
+				bx::read(&reader, level0.m_min);
+				bx::read(&reader, level0.m_max);
+				bx::skip(&reader, LODMESH_OBB_SIZE);
+				group.m_vbh = meshLoadVertexBuffer(&reader, chunk, m_decl);
+				ok = bgfx::isValid(group.m_vbh);
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_VBS:
+			ok = meshLoadVertexStream(&reader, group.m_vbhStream);
+			break;
+
+		case BGFX_CHUNK_MAGIC_IB:
+		case BGFX_CHUNK_MAGIC_IB32:
+		case BGFX_CHUNK_MAGIC_IBC:
+		case BGFX_CHUNK_MAGIC_IBC32:
+			group.m_ibh = meshLoadIndexBuffer(&reader, chunk);
+			ok = bgfx::isValid(group.m_ibh);
+			break;
+
+		case BGFX_CHUNK_MAGIC_PRI:
+			{
+				uint16_t len;
+				bx::read(&reader, len);
+				bx::skip(&reader, len);
+
+				uint16_t num;
+				bx::read(&reader, num);
+
+				// Level 0 covers all primitives.
+				level0.m_startIndex = UINT32_MAX;
+				level0.m_numIndices = 0;
+				level0.m_error = 0.0f;
+
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					bx::read(&reader, len);
+					bx::skip(&reader, len);
+
+					uint32_t startIndex;
+					uint32_t numIndices;
+					bx::read(&reader, startIndex);
+					bx::read(&reader, numIndices);
+					bx::skip(&reader, 2*sizeof(uint32_t) + LODMESH_SPHERE_SIZE + LODMESH_AABB_SIZE + LODMESH_OBB_SIZE);
+
+					level0.m_startIndex = startIndex < level0.m_startIndex ? startIndex : level0.m_startIndex;
+					level0.m_numIndices += numIndices;
+				}
+
+				group.m_levels.push_back(level0);
+				m_groups.push_back(group);
+				group.m_vbh.idx = bgfx::invalidHandle;
+				group.m_vbhStream.idx = bgfx::invalidHandle;
+				group.m_ibh.idx = bgfx::invalidHandle;
+				group.m_levels.clear();
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_LOD:
+			{
+				uint16_t num;
+				bx::read(&reader, num);
+
+				LodLevelArray& levels = m_groups.back().m_levels;
+				levels.resize(num);
+
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					LodLevel& level = levels[ii];
+					bx::read(&reader, level.m_startIndex);
+					bx::read(&reader, level.m_numIndices);
+					bx::read(&reader, level.m_error);
+					bx::read(&reader, level.m_center);
+					bx::read(&reader, level.m_radius);
+					bx::read(&reader, level.m_min);
+					bx::read(&reader, level.m_max);
+				}
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_MSH:
+			{
+				uint16_t numPrims;
+				bx::read(&reader, numPrims);
+				bx::skip(&reader, numPrims*2*sizeof(uint32_t) );
+
+				uint32_t num;
+				bx::read(&reader, num);
+				bx::skip(&reader, num*LODMESH_MESHLET_SIZE);
+
+				bx::read(&reader, num);
+				bx::skip(&reader, num*sizeof(uint32_t) );
+
+				bx::read(&reader, num);
+				bx::skip(&reader, num*3);
+			}
+			break;
+
+		default:
+			// Chunk size is unknown, rest of file can't be parsed.
+			DBG("Unknown chunk %08x at %d.", chunk, (int32_t)reader.seek() );
+			reader.close();
+			return true;
+		}
+	}
+
+	reader.close();
+
+	if (!ok)
+	{
+		DBG("Failed to load %s, chunk %08x is corrupt.", _filePath, chunk);
+
+		if (bgfx::isValid(group.m_vbh) )
+		{
+			bgfx::destroyVertexBuffer(group.m_vbh);
+		}
+
+		if (bgfx::isValid(group.m_vbhStream) )
+		{
+			bgfx::destroyVertexBuffer(group.m_vbhStream);
+		}
+
+		if (bgfx::isValid(group.m_ibh) )
+		{
+			bgfx::destroyIndexBuffer(group.m_ibh);
+		}
+
+		unload();
+	}
+
+	return ok;
+}
+
+void LodMesh::unload()
+{
+	for (LodGroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+	{
+		const LodGroup& group = *it;
+		bgfx::destroyVertexBuffer(group.m_vbh);
+
+		if (bgfx::isValid(group.m_vbhStream) )
+		{
+			bgfx::destroyVertexBuffer(group.m_vbhStream);
+		}
+
+		if (bgfx::isValid(group.m_ibh) )
+		{
+			bgfx::destroyIndexBuffer(group.m_ibh);
+		}
+	}
+	m_groups.clear();
+}
+
+uint32_t LodMesh::selectLevel(uint32_t _group, const float* _mtx, const float* _eye, float _projScale, float _pixelError) const
+{
+	const LodLevelArray& levels = m_groups[_group].m_levels;
+
+	// Errors are in object space, scale them by largest axis scale.
+	float scale = 0.0f;
+	for (uint32_t ii = 0; ii < 3; ++ii)
+	{
+		const float* axis = &_mtx[ii*4];
+		const float len = sqrtf(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+		scale = len > scale ? len : scale;
+	}
+
+	uint32_t result = 0;
+	for (uint32_t ii = 1, num = (uint32_t)levels.size(); ii < num; ++ii)
+	{
+		const LodLevel& level = levels[ii];
+
+		const float* center = level.m_center;
+		const float xx = center[0]*_mtx[0] + center[1]*_mtx[4] + center[2]*_mtx[ 8] + _mtx[12] - _eye[0];
+		const float yy = center[0]*_mtx[1] + center[1]*_mtx[5] + center[2]*_mtx[ 9] + _mtx[13] - _eye[1];
+		const float zz = center[0]*_mtx[2] + center[1]*_mtx[6] + center[2]*_mtx[10] + _mtx[14] - _eye[2];
+
+		// Distance to closest point of bounding sphere. When camera is
+		// inside sphere, error is projected from very close distance, and
+		// only level 0 passes.
+		float distance = sqrtf(xx*xx + yy*yy + zz*zz) - level.m_radius*scale;
+		distance = distance > FLT_EPSILON ? distance : FLT_EPSILON;
+
+		const float pixels = level.m_error*scale*_projScale/distance;
+		if (pixels > _pixelError)
+		{
+			break;
+		}
+
+		result = ii;
+	}
+
+	return result;
+}
+
+uint32_t LodMesh::submit(uint8_t _view, bgfx::ProgramHandle _program, const float* _mtx, const float* _eye, float _projScale, float _pixelError, uint64_t _state) const
+{
+	uint32_t numIndices = 0;
+
+	for (uint32_t ii = 0, num = (uint32_t)m_groups.size(); ii < num; ++ii)
+	{
+		const LodGroup& group = m_groups[ii];
+		const LodLevel& level = group.m_levels[selectLevel(ii, _mtx, _eye, _projScale, _pixelError)];
+
+		bgfx::setTransform(_mtx);
+		bgfx::setProgram(_program);
+		bgfx::setIndexBuffer(group.m_ibh, level.m_startIndex, level.m_numIndices);
+		bgfx::setVertexBuffer(group.m_vbh);
+
+		if (bgfx::isValid(group.m_vbhStream) )
+		{
+			bgfx::setVertexStream(1, group.m_vbhStream);
+		}
+		bgfx::setState(_state);
+		bgfx::submit(_view);
+
+		numIndices += level.m_numIndices;
+	}
+
+	return numIndices;
+}
+
+float lodProjScale(float _fovy, float _height)
+{
+	return _height*0.5f/tanf(_fovy*(3.14159265358979323846f/180.0f)*0.5f);
+}
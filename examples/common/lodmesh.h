@@ -0,0 +1,85 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef LODMESH_H_HEADER_GUARD
+#define LODMESH_H_HEADER_GUARD
+
+#include <bx/bx.h>
+#include <bgfx.h>
+
+#include <vector>
+
+/// Level of detail inside mesh group. All levels share group vertex and
+/// index buffer, coarser levels are stored after level 0.
+///
+struct LodLevel
+{
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+	float m_error;      //!< Simplification error in object space.
+	float m_center[3];  //!< Bounding sphere of vertices used by level.
+	float m_radius;
+	float m_min[3];     //!< Bounding box of vertices used by level.
+	float m_max[3];
+};
+
+typedef std::vector<LodLevel> LodLevelArray;
+
+struct LodGroup
+{
+	bgfx::VertexBufferHandle m_vbh;
+	bgfx::VertexBufferHandle m_vbhStream; //!< Attributes other than position, vertex stream 1.
+	bgfx::IndexBufferHandle m_ibh;
+	LodLevelArray m_levels;
+};
+
+typedef std::vector<LodGroup> LodGroupArray;
+
+/// Mesh with LOD chain generated by geometryc --lod. Meshes without LOD
+/// chunk are loaded with single level.
+///
+struct LodMesh
+{
+	/// Load mesh from geometryc output file.
+	///
+	/// @returns False if file can't be opened, or vertex or index chunk
+	///   is corrupt. Nothing stays loaded after failure.
+	///
+	bool load(const char* _filePath);
+
+	///
+	void unload();
+
+	/// Select level for one group.
+	///
+	/// @param _group Group index.
+	/// @param _mtx Model matrix.
+	/// @param _eye Camera position in world space.
+	/// @param _projScale Projection scale, see lodProjScale.
+	/// @param _pixelError Maximum allowed error in pixels.
+	/// @returns Coarsest level which error projected to screen is below
+	///   _pixelError.
+	///
+	uint32_t selectLevel(uint32_t _group, const float* _mtx, const float* _eye, float _projScale, float _pixelError) const;
+
+	/// Submit all groups, each with level selected by projected error.
+	///
+	/// @returns Number of submitted indices.
+	///
+	uint32_t submit(uint8_t _view, bgfx::ProgramHandle _program, const float* _mtx, const float* _eye, float _projScale, float _pixelError, uint64_t _state = BGFX_STATE_DEFAULT) const;
+
+	bgfx::VertexDecl m_decl;
+	LodGroupArray m_groups;
+};
+
+/// Returns number of pixels covered by object space unit at unit distance
+/// from camera.
+///
+/// @param _fovy Vertical field of view in degrees.
+/// @param _height Viewport height in pixels.
+///
+float lodProjScale(float _fovy, float _height);
+
+#endif // LODMESH_H_HEADER_GUARD
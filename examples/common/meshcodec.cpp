@@ -0,0 +1,528 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "meshcodec.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MESHCODEC_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define MESHCODEC_SSE2 0
+#endif // SSE2
+
+#define MESHCODEC_BLOCK_SIZE 16
+
+// Maximum encoded vertex size (float3 position is quantized to 6 bytes).
+#define MESHCODEC_MAX_STRIDE 256
+
+static uint32_t encodedStride(uint32_t _stride, uint16_t _posOffset)
+{
+	if (_stride < 12
+	||  _stride - 6 > MESHCODEC_MAX_STRIDE
+	||  uint32_t(_posOffset) + 12 > _stride)
+	{
+		return 0;
+	}
+
+	return _stride - 6;
+}
+
+static inline uint8_t zigzag8(uint8_t _value)
+{
+	return uint8_t( (_value << 1) ^ (int8_t(_value) >> 7) );
+}
+
+static inline uint8_t unzigzag8(uint8_t _value)
+{
+	return uint8_t( (_value >> 1) ^ -(_value & 1) );
+}
+
+uint32_t meshVertexEncodeBound(uint32_t _numVertices, uint32_t _stride)
+{
+	const uint32_t numBlocks = (_numVertices + MESHCODEC_BLOCK_SIZE - 1) / MESHCODEC_BLOCK_SIZE;
+	return numBlocks * ( (_stride + 3) / 4 + _stride*MESHCODEC_BLOCK_SIZE);
+}
+
+uint32_t meshVertexEncode(uint8_t* _dst, uint32_t _dstSize, MeshQuantization& _quant, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint16_t _posOffset)
+{
+	const uint32_t stride = encodedStride(_stride, _posOffset);
+	if (0 == stride
+	||  0 == _numVertices)
+	{
+		return 0;
+	}
+
+	const uint8_t* vertices = (const uint8_t*)_vertices;
+
+	float min[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+	float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		const float* position = (const float*)&vertices[ii*_stride + _posOffset];
+		for (uint32_t jj = 0; jj < 3; ++jj)
+		{
+			min[jj] = position[jj] < min[jj] ? position[jj] : min[jj];
+			max[jj] = position[jj] > max[jj] ? position[jj] : max[jj];
+		}
+	}
+
+	float invScale[3];
+	for (uint32_t jj = 0; jj < 3; ++jj)
+	{
+		_quant.m_offset[jj] = min[jj];
+		_quant.m_scale[jj] = (max[jj] - min[jj]) / 65535.0f;
+		invScale[jj] = 0.0f < _quant.m_scale[jj] ? 1.0f/_quant.m_scale[jj] : 0.0f;
+	}
+
+	const uint32_t headerSize = (stride + 3) / 4;
+	const uint32_t tailSize = _stride - _posOffset - 12;
+
+	uint8_t prev[MESHCODEC_MAX_STRIDE];
+	uint8_t row[MESHCODEC_MAX_STRIDE];
+	uint8_t deltas[MESHCODEC_MAX_STRIDE][MESHCODEC_BLOCK_SIZE];
+	memset(prev, 0, sizeof(prev) );
+
+	uint8_t* dst = _dst;
+	const uint8_t* end = _dst + _dstSize;
+
+	for (uint32_t block = 0; block < _numVertices; block += MESHCODEC_BLOCK_SIZE)
+	{
+		for (uint32_t jj = 0; jj < MESHCODEC_BLOCK_SIZE; ++jj)
+		{
+			// Block is padded with copies of last vertex, which encode as
+			// zero deltas.
+			if (block + jj < _numVertices)
+			{
+				const uint8_t* vertex = &vertices[(block + jj)*_stride];
+				const float* position = (const float*)&vertex[_posOffset];
+				for (uint32_t kk = 0; kk < 3; ++kk)
+				{
+					float qq = (position[kk] - min[kk])*invScale[kk] + 0.5f;
+					qq = qq < 0.0f ? 0.0f : (qq > 65535.0f ? 65535.0f : qq);
+					const uint16_t value = uint16_t(qq);
+					row[kk*2+0] = uint8_t(value);
+					row[kk*2+1] = uint8_t(value>>8);
+				}
+
+				memcpy(&row[6], vertex, _posOffset);
+				memcpy(&row[6 + _posOffset], &vertex[_posOffset + 12], tailSize);
+			}
+
+			for (uint32_t kk = 0; kk < stride; ++kk)
+			{
+				deltas[kk][jj] = zigzag8(uint8_t(row[kk] - prev[kk]) );
+				prev[kk] = row[kk];
+			}
+		}
+
+		if (dst + headerSize > end)
+		{
+			return 0;
+		}
+
+		uint8_t* header = dst;
+		memset(header, 0, headerSize);
+		dst += headerSize;
+
+		for (uint32_t kk = 0; kk < stride; ++kk)
+		{
+			const uint8_t* delta = deltas[kk];
+
+			uint8_t maxDelta = 0;
+			for (uint32_t jj = 0; jj < MESHCODEC_BLOCK_SIZE; ++jj)
+			{
+				maxDelta = delta[jj] > maxDelta ? delta[jj] : maxDelta;
+			}
+
+			const uint32_t code = 0 == maxDelta ? 0 : (maxDelta < 4 ? 1 : (maxDelta < 16 ? 2 : 3) );
+			header[kk/4] |= uint8_t(code << ( (kk%4)*2) );
+
+			const uint32_t size = 0 == code ? 0 : 2<<code;
+			if (dst + size > end)
+			{
+				return 0;
+			}
+
+			switch (code)
+			{
+			case 1:
+				for (uint32_t jj = 0; jj < 4; ++jj)
+				{
+					dst[jj] = uint8_t(delta[jj] | (delta[jj+4]<<2) | (delta[jj+8]<<4) | (delta[jj+12]<<6) );
+				}
+				break;
+
+			case 2:
+				for (uint32_t jj = 0; jj < 8; ++jj)
+				{
+					dst[jj] = uint8_t(delta[jj] | (delta[jj+8]<<4) );
+				}
+				break;
+
+			case 3:
+				memcpy(dst, delta, MESHCODEC_BLOCK_SIZE);
+				break;
+
+			default:
+				break;
+			}
+
+			dst += size;
+		}
+	}
+
+	return uint32_t(dst - _dst);
+}
+
+#if MESHCODEC_SSE2
+static inline __m128i unpackDeltas(const uint8_t* _src, uint32_t _code)
+{
+	__m128i result;
+
+	switch (_code)
+	{
+	case 1:
+		{
+			int32_t packed;
+			memcpy(&packed, _src, 4);
+			const __m128i xx = _mm_cvtsi32_si128(packed);
+			const __m128i mask = _mm_set1_epi8(3);
+			const __m128i v0 = _mm_and_si128(xx, mask);
+			const __m128i v1 = _mm_and_si128(_mm_srli_epi16(xx, 2), mask);
+			const __m128i v2 = _mm_and_si128(_mm_srli_epi16(xx, 4), mask);
+			const __m128i v3 = _mm_and_si128(_mm_srli_epi16(xx, 6), mask);
+			result = _mm_unpacklo_epi64(_mm_unpacklo_epi32(v0, v1), _mm_unpacklo_epi32(v2, v3) );
+		}
+		break;
+
+	case 2:
+		{
+			const __m128i xx = _mm_loadl_epi64( (const __m128i*)_src);
+			const __m128i mask = _mm_set1_epi8(15);
+			result = _mm_unpacklo_epi64(_mm_and_si128(xx, mask), _mm_and_si128(_mm_srli_epi16(xx, 4), mask) );
+		}
+		break;
+
+	case 3:
+		result = _mm_loadu_si128( (const __m128i*)_src);
+		break;
+
+	default:
+		return _mm_setzero_si128();
+	}
+
+	// Zigzag decode: (x >> 1) ^ -(x & 1)
+	const __m128i half = _mm_and_si128(_mm_srli_epi16(result, 1), _mm_set1_epi8(0x7f) );
+	const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(result, _mm_set1_epi8(1) ) );
+	return _mm_xor_si128(half, sign);
+}
+
+/// Transpose 16x16 bytes. Each round interleaves rows i and i+8, after
+/// four rounds row and column are swapped.
+static inline void transpose16x16(__m128i* _rows)
+{
+	__m128i tmp[16];
+	for (uint32_t round = 0; round < 2; ++round)
+	{
+		for (uint32_t ii = 0; ii < 8; ++ii)
+		{
+			tmp[ii*2+0] = _mm_unpacklo_epi8(_rows[ii], _rows[ii+8]);
+			tmp[ii*2+1] = _mm_unpackhi_epi8(_rows[ii], _rows[ii+8]);
+		}
+
+		for (uint32_t ii = 0; ii < 8; ++ii)
+		{
+			_rows[ii*2+0] = _mm_unpacklo_epi8(tmp[ii], tmp[ii+8]);
+			_rows[ii*2+1] = _mm_unpackhi_epi8(tmp[ii], tmp[ii+8]);
+		}
+	}
+}
+#else
+static inline void unpackDeltas(uint8_t* _deltas, const uint8_t* _src, uint32_t _code)
+{
+	switch (_code)
+	{
+	case 1:
+		for (uint32_t jj = 0; jj < 4; ++jj)
+		{
+			_deltas[jj+ 0] = unzigzag8( (_src[jj]   )&3);
+			_deltas[jj+ 4] = unzigzag8( (_src[jj]>>2)&3);
+			_deltas[jj+ 8] = unzigzag8( (_src[jj]>>4)&3);
+			_deltas[jj+12] = unzigzag8( (_src[jj]>>6)&3);
+		}
+		break;
+
+	case 2:
+		for (uint32_t jj = 0; jj < 8; ++jj)
+		{
+			_deltas[jj+0] = unzigzag8(_src[jj]&15);
+			_deltas[jj+8] = unzigzag8(_src[jj]>>4);
+		}
+		break;
+
+	case 3:
+		for (uint32_t jj = 0; jj < 16; ++jj)
+		{
+			_deltas[jj] = unzigzag8(_src[jj]);
+		}
+		break;
+
+	default:
+		memset(_deltas, 0, MESHCODEC_BLOCK_SIZE);
+		break;
+	}
+}
+#endif // MESHCODEC_SSE2
+
+bool meshVertexDecode(void* _vertices, uint32_t _numVertices, uint32_t _stride, uint16_t _posOffset, const MeshQuantization& _quant, const uint8_t* _src, uint32_t _srcSize)
+{
+	const uint32_t stride = encodedStride(_stride, _posOffset);
+	if (0 == stride)
+	{
+		return false;
+	}
+
+	const uint32_t headerSize = (stride + 3) / 4;
+	const uint32_t tailSize = _stride - _posOffset - 12;
+	const uint32_t paddedStride = (stride + 15) & ~15;
+
+	// Deltas are unpacked per vertex byte (16 vertices), and transposed
+	// into rows of vertex bytes. Padding columns stay zero.
+	uint8_t columns[MESHCODEC_MAX_STRIDE*MESHCODEC_BLOCK_SIZE];
+	uint8_t rows[MESHCODEC_BLOCK_SIZE*MESHCODEC_MAX_STRIDE];
+	uint8_t prev[MESHCODEC_MAX_STRIDE];
+	memset(columns, 0, sizeof(columns) );
+	memset(prev, 0, sizeof(prev) );
+
+	uint8_t* vertices = (uint8_t*)_vertices;
+	const uint8_t* src = _src;
+	const uint8_t* end = _src + _srcSize;
+
+	for (uint32_t block = 0; block < _numVertices; block += MESHCODEC_BLOCK_SIZE)
+	{
+		if (src + headerSize > end)
+		{
+			return false;
+		}
+
+		const uint8_t* header = src;
+		src += headerSize;
+
+		for (uint32_t kk = 0; kk < stride; ++kk)
+		{
+			const uint32_t code = (header[kk/4] >> ( (kk%4)*2) ) & 3;
+			const uint32_t size = 0 == code ? 0 : 2<<code;
+			if (src + size > end)
+			{
+				return false;
+			}
+
+#if MESHCODEC_SSE2
+			_mm_storeu_si128( (__m128i*)&columns[kk*MESHCODEC_BLOCK_SIZE], unpackDeltas(src, code) );
+#else
+			unpackDeltas(&columns[kk*MESHCODEC_BLOCK_SIZE], src, code);
+#endif // MESHCODEC_SSE2
+
+			src += size;
+		}
+
+#if MESHCODEC_SSE2
+		for (uint32_t column = 0; column < paddedStride; column += 16)
+		{
+			__m128i tmp[16];
+			for (uint32_t ii = 0; ii < 16; ++ii)
+			{
+				tmp[ii] = _mm_loadu_si128( (const __m128i*)&columns[(column + ii)*MESHCODEC_BLOCK_SIZE]);
+			}
+
+			transpose16x16(tmp);
+
+			__m128i value = _mm_loadu_si128( (const __m128i*)&prev[column]);
+			for (uint32_t jj = 0; jj < MESHCODEC_BLOCK_SIZE; ++jj)
+			{
+				value = _mm_add_epi8(value, tmp[jj]);
+				_mm_storeu_si128( (__m128i*)&rows[jj*MESHCODEC_MAX_STRIDE + column], value);
+			}
+			_mm_storeu_si128( (__m128i*)&prev[column], value);
+		}
+#else
+		for (uint32_t kk = 0; kk < paddedStride; ++kk)
+		{
+			const uint8_t* delta = &columns[kk*MESHCODEC_BLOCK_SIZE];
+			uint8_t value = prev[kk];
+			for (uint32_t jj = 0; jj < MESHCODEC_BLOCK_SIZE; ++jj)
+			{
+				value = uint8_t(value + delta[jj]);
+				rows[jj*MESHCODEC_MAX_STRIDE + kk] = value;
+			}
+			prev[kk] = value;
+		}
+#endif // MESHCODEC_SSE2
+
+		const uint32_t num = _numVertices - block < MESHCODEC_BLOCK_SIZE ? _numVertices - block : MESHCODEC_BLOCK_SIZE;
+		for (uint32_t jj = 0; jj < num; ++jj)
+		{
+			const uint8_t* row = &rows[jj*MESHCODEC_MAX_STRIDE];
+			uint8_t* vertex = &vertices[(block + jj)*_stride];
+
+			float position[3];
+			for (uint32_t kk = 0; kk < 3; ++kk)
+			{
+				const uint16_t value = uint16_t(row[kk*2] | (row[kk*2+1]<<8) );
+				position[kk] = _quant.m_offset[kk] + float(value)*_quant.m_scale[kk];
+			}
+
+			memcpy(&vertex[_posOffset], position, sizeof(position) );
+			memcpy(vertex, &row[6], _posOffset);
+			memcpy(&vertex[_posOffset + 12], &row[6 + _posOffset], tailSize);
+		}
+	}
+
+	return src == end;
+}
+
+uint32_t meshIndexEncodeBound(uint32_t _numIndices)
+{
+	return _numIndices*5;
+}
+
+uint32_t meshIndexEncode(uint8_t* _dst, uint32_t _dstSize, const uint32_t* _indices, uint32_t _numIndices)
+{
+	uint8_t* dst = _dst;
+	const uint8_t* end = _dst + _dstSize;
+
+	uint32_t prev = 0;
+	for (uint32_t ii = 0; ii < _numIndices; ++ii)
+	{
+		const int32_t delta = int32_t(_indices[ii] - prev);
+		prev = _indices[ii];
+
+		uint32_t value = (uint32_t(delta) << 1) ^ uint32_t(delta >> 31);
+
+		uint32_t size = 1;
+		for (uint32_t tmp = value >> 7; 0 != tmp; tmp >>= 7)
+		{
+			++size;
+		}
+
+		if (dst + size > end)
+		{
+			return 0;
+		}
+
+		while (0x80 <= value)
+		{
+			*dst++ = uint8_t(value | 0x80);
+			value >>= 7;
+		}
+		*dst++ = uint8_t(value);
+	}
+
+	return uint32_t(dst - _dst);
+}
+
+template <typename Ty>
+static bool indexDecode(Ty* _indices, uint32_t _numIndices, const uint8_t* _src, uint32_t _srcSize)
+{
+	const uint8_t* src = _src;
+	const uint8_t* end = _src + _srcSize;
+
+	uint32_t prev = 0;
+	for (uint32_t ii = 0; ii < _numIndices; ++ii)
+	{
+		if (src == end)
+		{
+			return false;
+		}
+
+		// Most deltas fit into single byte after vertex cache
+		// optimization.
+		uint32_t value = *src++;
+		if (0x80 <= value)
+		{
+			value &= 0x7f;
+			for (uint32_t shift = 7; ; shift += 7)
+			{
+				if (src == end
+				||  shift > 28)
+				{
+					return false;
+				}
+
+				const uint32_t byte = *src++;
+				value |= (byte & 0x7f) << shift;
+				if (byte < 0x80)
+				{
+					break;
+				}
+			}
+		}
+
+		prev += (value >> 1) ^ (0 - (value & 1) );
+		_indices[ii] = Ty(prev);
+	}
+
+	return src == end;
+}
+
+bool meshIndexDecode(void* _indices, uint32_t _numIndices, bool _index32, const uint8_t* _src, uint32_t _srcSize)
+{
+	if (_index32)
+	{
+		return indexDecode( (uint32_t*)_indices, _numIndices, _src, _srcSize);
+	}
+
+	return indexDecode( (uint16_t*)_indices, _numIndices, _src, _srcSize);
+}
+
+bool meshReadVertices(bx::ReaderI* _reader, void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl)
+{
+	MeshQuantization quant;
+	uint32_t size;
+	if (int32_t(sizeof(quant) ) != bx::read(_reader, quant)
+	||  int32_t(sizeof(size) ) != bx::read(_reader, size)
+	||  INT32_MAX < size)
+	{
+		return false;
+	}
+
+	uint8_t* data = (uint8_t*)malloc(size);
+	if (int32_t(size) != bx::read(_reader, data, size) )
+	{
+		free(data);
+		return false;
+	}
+
+	bool result = meshVertexDecode(_vertices, _numVertices, _decl.getStride(), _decl.getOffset(bgfx::Attrib::Position), quant, data, size);
+	free(data);
+
+	return result;
+}
+
+bool meshReadIndices(bx::ReaderI* _reader, void* _indices, uint32_t _numIndices, bool _index32)
+{
+	uint32_t size;
+	if (int32_t(sizeof(size) ) != bx::read(_reader, size)
+	||  INT32_MAX < size)
+	{
+		return false;
+	}
+
+	uint8_t* data = (uint8_t*)malloc(size);
+	if (int32_t(size) != bx::read(_reader, data, size) )
+	{
+		free(data);
+		return false;
+	}
+
+	bool result = meshIndexDecode(_indices, _numIndices, _index32, data, size);
+	free(data);
+
+	return result;
+}
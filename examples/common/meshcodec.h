@@ -0,0 +1,94 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef MESHCODEC_H_HEADER_GUARD
+#define MESHCODEC_H_HEADER_GUARD
+
+#include <bx/bx.h>
+#include <bx/readerwriter.h>
+#include <bgfx.h>
+
+/// Compressed vertex buffer chunk, written by geometryc --compress instead
+/// of VB/VB32 chunk:
+///
+///   Sphere, Aabb, Obb, VertexDecl, uint32_t numVertices
+///   MeshQuantization, uint32_t size, uint8_t [size] (meshVertexEncode)
+///
+#define BGFX_CHUNK_MAGIC_VBC BX_MAKEFOURCC('V', 'B', 'C', 0x0)
+
+/// Compressed index buffer chunks, decoded into 16-bit or 32-bit indices,
+/// written instead of IB/IB32 chunk:
+///
+///   uint32_t numIndices, uint32_t size, uint8_t [size] (meshIndexEncode)
+///
+#define BGFX_CHUNK_MAGIC_IBC BX_MAKEFOURCC('I', 'B', 'C', 0x0)
+#define BGFX_CHUNK_MAGIC_IBC32 BX_MAKEFOURCC('I', 'B', 'C', 0x1)
+
+/// Position is quantized to 16 bits per component, relative to position
+/// bounding box:
+///
+///   position = offset + quantized*scale
+///
+struct MeshQuantization
+{
+	float m_offset[3];
+	float m_scale[3];
+};
+
+/// Returns maximum size of encoded vertex data.
+///
+uint32_t meshVertexEncodeBound(uint32_t _numVertices, uint32_t _stride);
+
+/// Encode vertices. Position must be float3 at _posOffset. Position is
+/// quantized, every other attribute is encoded losslessly.
+///
+/// Vertices are split into blocks of 16. Each vertex byte is delta
+/// encoded against the same byte of previous vertex, zigzag encoded, and
+/// all 16 deltas of one byte are packed with 0, 2, 4 or 8 bits per
+/// delta. Vertex order should already be optimized for vertex fetch, so
+/// that neighbor vertices are close to each other.
+///
+/// @returns Encoded size, or 0 if _dstSize is not big enough.
+///
+uint32_t meshVertexEncode(uint8_t* _dst, uint32_t _dstSize, MeshQuantization& _quant, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint16_t _posOffset);
+
+/// Decode vertices into _vertices (_numVertices*_stride bytes).
+///
+/// @returns False if encoded data is malformed.
+///
+bool meshVertexDecode(void* _vertices, uint32_t _numVertices, uint32_t _stride, uint16_t _posOffset, const MeshQuantization& _quant, const uint8_t* _src, uint32_t _srcSize);
+
+/// Returns maximum size of encoded index data.
+///
+uint32_t meshIndexEncodeBound(uint32_t _numIndices);
+
+/// Encode indices in triangle order. Every index is stored as zigzag
+/// encoded delta from previous index, packed as 7-bit varint.
+///
+/// @returns Encoded size, or 0 if _dstSize is not big enough.
+///
+uint32_t meshIndexEncode(uint8_t* _dst, uint32_t _dstSize, const uint32_t* _indices, uint32_t _numIndices);
+
+/// Decode indices into 16-bit or 32-bit index buffer.
+///
+/// @returns False if encoded data is malformed.
+///
+bool meshIndexDecode(void* _indices, uint32_t _numIndices, bool _index32, const uint8_t* _src, uint32_t _srcSize);
+
+/// Read remainder of VBC chunk after vertex count, and decode it into
+/// _vertices.
+///
+/// @returns False if chunk is truncated or encoded data is malformed.
+///
+bool meshReadVertices(bx::ReaderI* _reader, void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl);
+
+/// Read remainder of IBC/IBC32 chunk after index count, and decode it
+/// into _indices.
+///
+/// @returns False if chunk is truncated or encoded data is malformed.
+///
+bool meshReadIndices(bx::ReaderI* _reader, void* _indices, uint32_t _numIndices, bool _index32);
+
+#endif // MESHCODEC_H_HEADER_GUARD
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "meshloader.h"
+
+#include <stdlib.h>
+
+// Data is decoded into heap memory first, bgfx::alloc memory can't be
+// released without creating resource when chunk turns out to be corrupt.
+static void meshFree(void* _ptr, void* /*_userData*/)
+{
+	free(_ptr);
+}
+
+bool meshReadVertexHeader(bx::ReaderI* _reader, uint32_t _chunk, bgfx::VertexDecl& _decl, uint32_t& _numVertices)
+{
+	if (int32_t(sizeof(_decl) ) != bx::read(_reader, _decl) )
+	{
+		return false;
+	}
+
+	if (BGFX_CHUNK_MAGIC_VB != _chunk)
+	{
+		if (int32_t(sizeof(_numVertices) ) != bx::read(_reader, _numVertices) )
+		{
+			return false;
+		}
+	}
+	else
+	{
+		uint16_t num;
+		if (int32_t(sizeof(num) ) != bx::read(_reader, num) )
+		{
+			return false;
+		}
+		_numVertices = num;
+	}
+
+	const uint64_t size = uint64_t(_numVertices)*_decl.getStride();
+	return 0 != size
+		&& INT32_MAX >= size
+		;
+}
+
+bool meshReadVertexData(bx::ReaderI* _reader, uint32_t _chunk, void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl)
+{
+	if (BGFX_CHUNK_MAGIC_VBC == _chunk)
+	{
+		return meshReadVertices(_reader, _vertices, _numVertices, _decl);
+	}
+
+	const int32_t size = int32_t(_numVertices*_decl.getStride() );
+	return size == bx::read(_reader, _vertices, size);
+}
+
+bgfx::VertexBufferHandle meshLoadVertexBuffer(bx::ReaderI* _reader, uint32_t _chunk, bgfx::VertexDecl& _decl)
+{
+	bgfx::VertexBufferHandle handle = BGFX_INVALID_HANDLE;
+
+	uint32_t numVertices;
+	if (meshReadVertexHeader(_reader, _chunk, _decl, numVertices) )
+	{
+		const uint32_t size = numVertices*_decl.getStride();
+		void* vertices = malloc(size);
+		if (meshReadVertexData(_reader, _chunk, vertices, numVertices, _decl) )
+		{
+			handle = bgfx::createVertexBuffer(bgfx::makeRef(vertices, size, meshFree), _decl);
+		}
+		else
+		{
+			free(vertices);
+		}
+	}
+
+	return handle;
+}
+
+bool meshLoadVertexStream(bx::ReaderI* _reader, bgfx::VertexBufferHandle& _handle)
+{
+	_handle.idx = bgfx::invalidHandle;
+
+	uint8_t stream;
+	bgfx::VertexDecl decl;
+	uint32_t numVertices;
+	if (int32_t(sizeof(stream) ) != bx::read(_reader, stream)
+	||  1 != stream
+	||  int32_t(sizeof(decl) ) != bx::read(_reader, decl)
+	||  int32_t(sizeof(numVertices) ) != bx::read(_reader, numVertices) )
+	{
+		return false;
+	}
+
+	const uint64_t size = uint64_t(numVertices)*decl.getStride();
+	if (INT32_MAX < size)
+	{
+		return false;
+	}
+
+	if (0 == size)
+	{
+		return true;
+	}
+
+	void* vertices = malloc(uint32_t(size) );
+	if (int32_t(size) != bx::read(_reader, vertices, int32_t(size) ) )
+	{
+		free(vertices);
+		return false;
+	}
+
+	_handle = bgfx::createVertexBuffer(bgfx::makeRef(vertices, uint32_t(size), meshFree), decl);
+	return true;
+}
+
+bgfx::IndexBufferHandle meshLoadIndexBuffer(bx::ReaderI* _reader, uint32_t _chunk)
+{
+	bgfx::IndexBufferHandle handle = BGFX_INVALID_HANDLE;
+
+	const bool index32 = BGFX_CHUNK_MAGIC_IB32 == _chunk || BGFX_CHUNK_MAGIC_IBC32 == _chunk;
+
+	uint32_t numIndices;
+	if (int32_t(sizeof(numIndices) ) != bx::read(_reader, numIndices)
+	||  0 == numIndices
+	||  (INT32_MAX>>2) < numIndices)
+	{
+		return handle;
+	}
+
+	const uint32_t size = numIndices*(index32 ? 4 : 2);
+	void* indices = malloc(size);
+
+	bool ok;
+	if (BGFX_CHUNK_MAGIC_IBC == _chunk
+	||  BGFX_CHUNK_MAGIC_IBC32 == _chunk)
+	{
+		ok = meshReadIndices(_reader, indices, numIndices, index32);
+	}
+	else
+	{
+		ok = int32_t(size) == bx::read(_reader, indices, size);
+	}
+
+	if (ok)
+	{
+		handle = bgfx::createIndexBuffer(bgfx::makeRef(indices, size, meshFree), index32 ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+	}
+	else
+	{
+		free(indices);
+	}
+
+	return handle;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef MESHLOADER_H_HEADER_GUARD
+#define MESHLOADER_H_HEADER_GUARD
+
+#include <bx/bx.h>
+#include <bx/readerwriter.h>
+#include <bgfx.h>
+
+#include "meshcodec.h"
+
+#define BGFX_CHUNK_MAGIC_VB BX_MAKEFOURCC('V', 'B', ' ', 0x0)
+#define BGFX_CHUNK_MAGIC_VB32 BX_MAKEFOURCC('V', 'B', ' ', 0x1)
+#define BGFX_CHUNK_MAGIC_IB BX_MAKEFOURCC('I', 'B', ' ', 0x0)
+#define BGFX_CHUNK_MAGIC_IB32 BX_MAKEFOURCC('I', 'B', ' ', 0x1)
+#define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
+#define BGFX_CHUNK_MAGIC_LOD BX_MAKEFOURCC('L', 'O', 'D', 0x0)
+#define BGFX_CHUNK_MAGIC_MSH BX_MAKEFOURCC('M', 'S', 'H', 0x0)
+#define BGFX_CHUNK_MAGIC_VBS BX_MAKEFOURCC('V', 'B', 'S', 0x0)
+
+/// Read vertex declaration and number of vertices of VB, VB32 or VBC
+/// chunk. Reader must be positioned after bounding volumes of chunk.
+///
+/// @returns False if chunk is truncated or empty.
+///
+bool meshReadVertexHeader(bx::ReaderI* _reader, uint32_t _chunk, bgfx::VertexDecl& _decl, uint32_t& _numVertices);
+
+/// Read vertex data of VB, VB32 or VBC chunk following header, and decode
+/// it into _vertices when chunk is compressed.
+///
+/// @returns False if chunk is truncated or can't be decoded.
+///
+bool meshReadVertexData(bx::ReaderI* _reader, uint32_t _chunk, void* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl);
+
+/// Read remainder of VB, VB32 or VBC chunk after bounding volumes, and
+/// create vertex buffer.
+///
+/// @returns Invalid handle if chunk is corrupt. Rest of file can't be
+///   parsed after failure.
+///
+bgfx::VertexBufferHandle meshLoadVertexBuffer(bx::ReaderI* _reader, uint32_t _chunk, bgfx::VertexDecl& _decl);
+
+/// Read VBS chunk, which geometryc --posstream writes with attributes
+/// other than position, and create vertex buffer to be set as vertex
+/// stream 1. Vertex buffer of VB chunk has only position then.
+///
+/// @param _handle Vertex buffer, invalid when mesh has no attributes
+///   other than position.
+/// @returns False if chunk is corrupt or it's not stream 1.
+///
+bool meshLoadVertexStream(bx::ReaderI* _reader, bgfx::VertexBufferHandle& _handle);
+
+/// Read IB, IB32, IBC or IBC32 chunk, and create index buffer. Index
+/// buffer of 32-bit chunk is created with BGFX_BUFFER_INDEX32.
+///
+/// @returns Invalid handle if chunk is corrupt. Rest of file can't be
+///   parsed after failure.
+///
+bgfx::IndexBufferHandle meshLoadIndexBuffer(bx::ReaderI* _reader, uint32_t _chunk);
+
+#endif // MESHLOADER_H_HEADER_GUARD
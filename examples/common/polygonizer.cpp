@@ -0,0 +1,788 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "polygonizer.h"
+
+#include <bgfx.h>
+#include <bx/bx.h>
+#include <bx/float4_t.h>
+#include <bx/timer.h>
+#include <bx/uint32_t.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Samples per block edge, and row pitch of block scratch padded to
+// multiple of 4 samples.
+#define POLYGONIZER_BLOCK_SAMPLES (POLYGONIZER_BLOCK_SIZE+1)
+#define POLYGONIZER_BLOCK_PITCH ( (POLYGONIZER_BLOCK_SAMPLES+3)&~3)
+#define POLYGONIZER_BLOCK_PLANE (POLYGONIZER_BLOCK_SAMPLES*POLYGONIZER_BLOCK_SAMPLES*POLYGONIZER_BLOCK_PITCH)
+
+// Block scratch has value and normal xyz planes.
+#define POLYGONIZER_SCRATCH_SIZE (4*POLYGONIZER_BLOCK_PLANE*sizeof(float) )
+
+// Triangulation tables taken from:
+// http://paulbourke.net/geometry/polygonise/
+
+static const uint16_t s_edges[256] =
+{
+	0x000, 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
+	0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
+	0x190, 0x099, 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
+	0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
+	0x230, 0x339, 0x033, 0x13a, 0x636, 0x73f, 0x435, 0x53c,
+	0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
+	0x3a0, 0x2a9, 0x1a3, 0x0aa, 0x7a6, 0x6af, 0x5a5, 0x4ac,
+	0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
+	0x460, 0x569, 0x663, 0x76a, 0x66 , 0x16f, 0x265, 0x36c,
+	0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
+	0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0x0ff, 0x3f5, 0x2fc,
+	0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
+	0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x055, 0x15c,
+	0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
+	0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0x0cc,
+	0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
+	0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc,
+	0x0cc, 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
+	0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c,
+	0x15c, 0x55 , 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
+	0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc,
+	0x2fc, 0x3f5, 0x0ff, 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
+	0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c,
+	0x36c, 0x265, 0x16f, 0x066, 0x76a, 0x663, 0x569, 0x460,
+	0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac,
+	0x4ac, 0x5a5, 0x6af, 0x7a6, 0x0aa, 0x1a3, 0x2a9, 0x3a0,
+	0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c,
+	0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x033, 0x339, 0x230,
+	0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c,
+	0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x099, 0x190,
+	0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c,
+	0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x000,
+};
+
+static const int8_t s_indices[256][16] =
+{
+	{  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  1,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  8,  3,  9,  8,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  2, 10,  0,  2,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  8,  3,  2, 10,  8, 10,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0, 11,  2,  8, 11,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  9,  0,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1, 11,  2,  1,  9, 11,  9,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   3, 10,  1, 11, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0, 10,  1,  0,  8, 10,  8, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  9,  0,  3, 11,  9, 11, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  3,  0,  7,  3,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  1,  9,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  1,  9,  4,  7,  1,  7,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  4,  7,  3,  0,  4,  1,  2, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  2, 10,  9,  0,  2,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   2, 10,  9,  2,  9,  7,  2,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
+	{   8,  4,  7,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  4,  7, 11,  2,  4,  2,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  0,  1,  8,  4,  7,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  7, 11,  9,  4, 11,  9, 11,  2,  9,  2,  1, -1, -1, -1, -1 },
+	{   3, 10,  1,  3, 11, 10,  7,  8,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   1, 11, 10,  1,  4, 11,  1,  0,  4,  7, 11,  4, -1, -1, -1, -1 },
+	{   4,  7,  8,  9,  0, 11,  9, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
+	{   4,  7, 11,  4, 11,  9,  9, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  5,  4,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  5,  4,  1,  5,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  5,  4,  8,  3,  5,  3,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  0,  8,  1,  2, 10,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   5,  2, 10,  5,  4,  2,  4,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{   2, 10,  5,  3,  2,  5,  3,  5,  4,  3,  4,  8, -1, -1, -1, -1 },
+	{   9,  5,  4,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0, 11,  2,  0,  8, 11,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  5,  4,  0,  1,  5,  2,  3, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  1,  5,  2,  5,  8,  2,  8, 11,  4,  8,  5, -1, -1, -1, -1 },
+	{  10,  3, 11, 10,  1,  3,  9,  5,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  9,  5,  0,  8,  1,  8, 10,  1,  8, 11, 10, -1, -1, -1, -1 },
+	{   5,  4,  0,  5,  0, 11,  5, 11, 10, 11,  0,  3, -1, -1, -1, -1 },
+	{   5,  4,  8,  5,  8, 10, 10,  8, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  7,  8,  5,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  3,  0,  9,  5,  3,  5,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  7,  8,  0,  1,  7,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  7,  8,  9,  5,  7, 10,  1,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  1,  2,  9,  5,  0,  5,  3,  0,  5,  7,  3, -1, -1, -1, -1 },
+	{   8,  0,  2,  8,  2,  5,  8,  5,  7, 10,  5,  2, -1, -1, -1, -1 },
+	{   2, 10,  5,  2,  5,  3,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   7,  9,  5,  7,  8,  9,  3, 11,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  5,  7,  9,  7,  2,  9,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
+	{   2,  3, 11,  0,  1,  8,  1,  7,  8,  1,  5,  7, -1, -1, -1, -1 },
+	{  11,  2,  1, 11,  1,  7,  7,  1,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  5,  8,  8,  5,  7, 10,  1,  3, 10,  3, 11, -1, -1, -1, -1 },
+	{   5,  7,  0,  5,  0,  9,  7, 11,  0,  1,  0, 10, 11, 10,  0, -1 },
+	{  11, 10,  0, 11,  0,  3, 10,  5,  0,  8,  0,  7,  5,  7,  0, -1 },
+	{  11, 10,  5,  7, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  0,  1,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  8,  3,  1,  9,  8,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  6,  5,  2,  6,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  6,  5,  1,  2,  6,  3,  0,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  6,  5,  9,  0,  6,  0,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   5,  9,  8,  5,  8,  2,  5,  2,  6,  3,  2,  8, -1, -1, -1, -1 },
+	{   2,  3, 11, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  0,  8, 11,  2,  0, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  1,  9,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   5, 10,  6,  1,  9,  2,  9, 11,  2,  9,  8, 11, -1, -1, -1, -1 },
+	{   6,  3, 11,  6,  5,  3,  5,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8, 11,  0, 11,  5,  0,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
+	{   3, 11,  6,  0,  3,  6,  0,  6,  5,  0,  5,  9, -1, -1, -1, -1 },
+	{   6,  5,  9,  6,  9, 11, 11,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   5, 10,  6,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  3,  0,  4,  7,  3,  6,  5, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  9,  0,  5, 10,  6,  8,  4,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  6,  5,  1,  9,  7,  1,  7,  3,  7,  9,  4, -1, -1, -1, -1 },
+	{   6,  1,  2,  6,  5,  1,  4,  7,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2,  5,  5,  2,  6,  3,  0,  4,  3,  4,  7, -1, -1, -1, -1 },
+	{   8,  4,  7,  9,  0,  5,  0,  6,  5,  0,  2,  6, -1, -1, -1, -1 },
+	{   7,  3,  9,  7,  9,  4,  3,  2,  9,  5,  9,  6,  2,  6,  9, -1 },
+	{   3, 11,  2,  7,  8,  4, 10,  6,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   5, 10,  6,  4,  7,  2,  4,  2,  0,  2,  7, 11, -1, -1, -1, -1 },
+	{   0,  1,  9,  4,  7,  8,  2,  3, 11,  5, 10,  6, -1, -1, -1, -1 },
+	{   9,  2,  1,  9, 11,  2,  9,  4, 11,  7, 11,  4,  5, 10,  6, -1 },
+	{   8,  4,  7,  3, 11,  5,  3,  5,  1,  5, 11,  6, -1, -1, -1, -1 },
+	{   5,  1, 11,  5, 11,  6,  1,  0, 11,  7, 11,  4,  0,  4, 11, -1 },
+	{   0,  5,  9,  0,  6,  5,  0,  3,  6, 11,  6,  3,  8,  4,  7, -1 },
+	{   6,  5,  9,  6,  9, 11,  4,  7,  9,  7, 11,  9, -1, -1, -1, -1 },
+	{  10,  4,  9,  6,  4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4, 10,  6,  4,  9, 10,  0,  8,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  0,  1, 10,  6,  0,  6,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  3,  1,  8,  1,  6,  8,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
+	{   1,  4,  9,  1,  2,  4,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  0,  8,  1,  2,  9,  2,  4,  9,  2,  6,  4, -1, -1, -1, -1 },
+	{   0,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  3,  2,  8,  2,  4,  4,  2,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  4,  9, 10,  6,  4, 11,  2,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  2,  2,  8, 11,  4,  9, 10,  4, 10,  6, -1, -1, -1, -1 },
+	{   3, 11,  2,  0,  1,  6,  0,  6,  4,  6,  1, 10, -1, -1, -1, -1 },
+	{   6,  4,  1,  6,  1, 10,  4,  8,  1,  2,  1, 11,  8, 11,  1, -1 },
+	{   9,  6,  4,  9,  3,  6,  9,  1,  3, 11,  6,  3, -1, -1, -1, -1 },
+	{   8, 11,  1,  8,  1,  0, 11,  6,  1,  9,  1,  4,  6,  4,  1, -1 },
+	{   3, 11,  6,  3,  6,  0,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   6,  4,  8, 11,  6,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   7, 10,  6,  7,  8, 10,  8,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  7,  3,  0, 10,  7,  0,  9, 10,  6,  7, 10, -1, -1, -1, -1 },
+	{  10,  6,  7,  1, 10,  7,  1,  7,  8,  1,  8,  0, -1, -1, -1, -1 },
+	{  10,  6,  7, 10,  7,  1,  1,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2,  6,  1,  6,  8,  1,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
+	{   2,  6,  9,  2,  9,  1,  6,  7,  9,  0,  9,  3,  7,  3,  9, -1 },
+	{   7,  8,  0,  7,  0,  6,  6,  0,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{   7,  3,  2,  6,  7,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  3, 11, 10,  6,  8, 10,  8,  9,  8,  6,  7, -1, -1, -1, -1 },
+	{   2,  0,  7,  2,  7, 11,  0,  9,  7,  6,  7, 10,  9, 10,  7, -1 },
+	{   1,  8,  0,  1,  7,  8,  1, 10,  7,  6,  7, 10,  2,  3, 11, -1 },
+	{  11,  2,  1, 11,  1,  7, 10,  6,  1,  6,  7,  1, -1, -1, -1, -1 },
+	{   8,  9,  6,  8,  6,  7,  9,  1,  6, 11,  6,  3,  1,  3,  6, -1 },
+	{   0,  9,  1, 11,  6,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   7,  8,  0,  7,  0,  6,  3, 11,  0, 11,  6,  0, -1, -1, -1, -1 },
+	{   7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  0,  8, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  1,  9, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  1,  9,  8,  3,  1, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  1,  2,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10,  3,  0,  8,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  9,  0,  2, 10,  9,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   6, 11,  7,  2, 10,  3, 10,  8,  3, 10,  9,  8, -1, -1, -1, -1 },
+	{   7,  2,  3,  6,  2,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   7,  0,  8,  7,  6,  0,  6,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  7,  6,  2,  3,  7,  0,  1,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  6,  2,  1,  8,  6,  1,  9,  8,  8,  7,  6, -1, -1, -1, -1 },
+	{  10,  7,  6, 10,  1,  7,  1,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  7,  6,  1,  7, 10,  1,  8,  7,  1,  0,  8, -1, -1, -1, -1 },
+	{   0,  3,  7,  0,  7, 10,  0, 10,  9,  6, 10,  7, -1, -1, -1, -1 },
+	{   7,  6, 10,  7, 10,  8,  8, 10,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   6,  8,  4, 11,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  6, 11,  3,  0,  6,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  6, 11,  8,  4,  6,  9,  0,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  4,  6,  9,  6,  3,  9,  3,  1, 11,  3,  6, -1, -1, -1, -1 },
+	{   6,  8,  4,  6, 11,  8,  2, 10,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10,  3,  0, 11,  0,  6, 11,  0,  4,  6, -1, -1, -1, -1 },
+	{   4, 11,  8,  4,  6, 11,  0,  2,  9,  2, 10,  9, -1, -1, -1, -1 },
+	{  10,  9,  3, 10,  3,  2,  9,  4,  3, 11,  3,  6,  4,  6,  3, -1 },
+	{   8,  2,  3,  8,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  4,  2,  4,  6,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  9,  0,  2,  3,  4,  2,  4,  6,  4,  3,  8, -1, -1, -1, -1 },
+	{   1,  9,  4,  1,  4,  2,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  1,  3,  8,  6,  1,  8,  4,  6,  6, 10,  1, -1, -1, -1, -1 },
+	{  10,  1,  0, 10,  0,  6,  6,  0,  4, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  6,  3,  4,  3,  8,  6, 10,  3,  0,  3,  9, 10,  9,  3, -1 },
+	{  10,  9,  4,  6, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  9,  5,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3,  4,  9,  5, 11,  7,  6, -1, -1, -1, -1, -1, -1, -1 },
+	{   5,  0,  1,  5,  4,  0,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  7,  6,  8,  3,  4,  3,  5,  4,  3,  1,  5, -1, -1, -1, -1 },
+	{   9,  5,  4, 10,  1,  2,  7,  6, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   6, 11,  7,  1,  2, 10,  0,  8,  3,  4,  9,  5, -1, -1, -1, -1 },
+	{   7,  6, 11,  5,  4, 10,  4,  2, 10,  4,  0,  2, -1, -1, -1, -1 },
+	{   3,  4,  8,  3,  5,  4,  3,  2,  5, 10,  5,  2, 11,  7,  6, -1 },
+	{   7,  2,  3,  7,  6,  2,  5,  4,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  5,  4,  0,  8,  6,  0,  6,  2,  6,  8,  7, -1, -1, -1, -1 },
+	{   3,  6,  2,  3,  7,  6,  1,  5,  0,  5,  4,  0, -1, -1, -1, -1 },
+	{   6,  2,  8,  6,  8,  7,  2,  1,  8,  4,  8,  5,  1,  5,  8, -1 },
+	{   9,  5,  4, 10,  1,  6,  1,  7,  6,  1,  3,  7, -1, -1, -1, -1 },
+	{   1,  6, 10,  1,  7,  6,  1,  0,  7,  8,  7,  0,  9,  5,  4, -1 },
+	{   4,  0, 10,  4, 10,  5,  0,  3, 10,  6, 10,  7,  3,  7, 10, -1 },
+	{   7,  6, 10,  7, 10,  8,  5,  4, 10,  4,  8, 10, -1, -1, -1, -1 },
+	{   6,  9,  5,  6, 11,  9, 11,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  6, 11,  0,  6,  3,  0,  5,  6,  0,  9,  5, -1, -1, -1, -1 },
+	{   0, 11,  8,  0,  5, 11,  0,  1,  5,  5,  6, 11, -1, -1, -1, -1 },
+	{   6, 11,  3,  6,  3,  5,  5,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 10,  9,  5, 11,  9, 11,  8, 11,  5,  6, -1, -1, -1, -1 },
+	{   0, 11,  3,  0,  6, 11,  0,  9,  6,  5,  6,  9,  1,  2, 10, -1 },
+	{  11,  8,  5, 11,  5,  6,  8,  0,  5, 10,  5,  2,  0,  2,  5, -1 },
+	{   6, 11,  3,  6,  3,  5,  2, 10,  3, 10,  5,  3, -1, -1, -1, -1 },
+	{   5,  8,  9,  5,  2,  8,  5,  6,  2,  3,  8,  2, -1, -1, -1, -1 },
+	{   9,  5,  6,  9,  6,  0,  0,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  5,  8,  1,  8,  0,  5,  6,  8,  3,  8,  2,  6,  2,  8, -1 },
+	{   1,  5,  6,  2,  1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  3,  6,  1,  6, 10,  3,  8,  6,  5,  6,  9,  8,  9,  6, -1 },
+	{  10,  1,  0, 10,  0,  6,  9,  5,  0,  5,  6,  0, -1, -1, -1, -1 },
+	{   0,  3,  8,  5,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  5,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  5, 10,  7,  5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  5, 10, 11,  7,  5,  8,  3,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{   5, 11,  7,  5, 10, 11,  1,  9,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{  10,  7,  5, 10, 11,  7,  9,  8,  1,  8,  3,  1, -1, -1, -1, -1 },
+	{  11,  1,  2, 11,  7,  1,  7,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3,  1,  2,  7,  1,  7,  5,  7,  2, 11, -1, -1, -1, -1 },
+	{   9,  7,  5,  9,  2,  7,  9,  0,  2,  2, 11,  7, -1, -1, -1, -1 },
+	{   7,  5,  2,  7,  2, 11,  5,  9,  2,  3,  2,  8,  9,  8,  2, -1 },
+	{   2,  5, 10,  2,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  2,  0,  8,  5,  2,  8,  7,  5, 10,  2,  5, -1, -1, -1, -1 },
+	{   9,  0,  1,  5, 10,  3,  5,  3,  7,  3, 10,  2, -1, -1, -1, -1 },
+	{   9,  8,  2,  9,  2,  1,  8,  7,  2, 10,  2,  5,  7,  5,  2, -1 },
+	{   1,  3,  5,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  7,  0,  7,  1,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  0,  3,  9,  3,  5,  5,  3,  7, -1, -1, -1, -1, -1, -1, -1 },
+	{   9,  8,  7,  5,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   5,  8,  4,  5, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   5,  0,  4,  5, 11,  0,  5, 10, 11, 11,  3,  0, -1, -1, -1, -1 },
+	{   0,  1,  9,  8,  4, 10,  8, 10, 11, 10,  4,  5, -1, -1, -1, -1 },
+	{  10, 11,  4, 10,  4,  5, 11,  3,  4,  9,  4,  1,  3,  1,  4, -1 },
+	{   2,  5,  1,  2,  8,  5,  2, 11,  8,  4,  5,  8, -1, -1, -1, -1 },
+	{   0,  4, 11,  0, 11,  3,  4,  5, 11,  2, 11,  1,  5,  1, 11, -1 },
+	{   0,  2,  5,  0,  5,  9,  2, 11,  5,  4,  5,  8, 11,  8,  5, -1 },
+	{   9,  4,  5,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  5, 10,  3,  5,  2,  3,  4,  5,  3,  8,  4, -1, -1, -1, -1 },
+	{   5, 10,  2,  5,  2,  4,  4,  2,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{   3, 10,  2,  3,  5, 10,  3,  8,  5,  4,  5,  8,  0,  1,  9, -1 },
+	{   5, 10,  2,  5,  2,  4,  1,  9,  2,  9,  4,  2, -1, -1, -1, -1 },
+	{   8,  4,  5,  8,  5,  3,  3,  5,  1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  4,  5,  1,  0,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   8,  4,  5,  8,  5,  3,  9,  0,  5,  0,  3,  5, -1, -1, -1, -1 },
+	{   9,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4, 11,  7,  4,  9, 11,  9, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  8,  3,  4,  9,  7,  9, 11,  7,  9, 10, 11, -1, -1, -1, -1 },
+	{   1, 10, 11,  1, 11,  4,  1,  4,  0,  7,  4, 11, -1, -1, -1, -1 },
+	{   3,  1,  4,  3,  4,  8,  1, 10,  4,  7,  4, 11, 10, 11,  4, -1 },
+	{   4, 11,  7,  9, 11,  4,  9,  2, 11,  9,  1,  2, -1, -1, -1, -1 },
+	{   9,  7,  4,  9, 11,  7,  9,  1, 11,  2, 11,  1,  0,  8,  3, -1 },
+	{  11,  7,  4, 11,  4,  2,  2,  4,  0, -1, -1, -1, -1, -1, -1, -1 },
+	{  11,  7,  4, 11,  4,  2,  8,  3,  4,  3,  2,  4, -1, -1, -1, -1 },
+	{   2,  9, 10,  2,  7,  9,  2,  3,  7,  7,  4,  9, -1, -1, -1, -1 },
+	{   9, 10,  7,  9,  7,  4, 10,  2,  7,  8,  7,  0,  2,  0,  7, -1 },
+	{   3,  7, 10,  3, 10,  2,  7,  4, 10,  1, 10,  0,  4,  0, 10, -1 },
+	{   1, 10,  2,  8,  7,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  9,  1,  4,  1,  7,  7,  1,  3, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  9,  1,  4,  1,  7,  0,  8,  1,  8,  7,  1, -1, -1, -1, -1 },
+	{   4,  0,  3,  7,  4,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   9, 10,  8, 10, 11,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  0,  9,  3,  9, 11, 11,  9, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  1, 10,  0, 10,  8,  8, 10, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  1, 10, 11,  3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  2, 11,  1, 11,  9,  9, 11,  8, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  0,  9,  3,  9, 11,  1,  2,  9,  2, 11,  9, -1, -1, -1, -1 },
+	{   0,  2, 11,  8,  0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   3,  2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  3,  8,  2,  8, 10, 10,  8,  9, -1, -1, -1, -1, -1, -1, -1 },
+	{   9, 10,  2,  0,  9,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   2,  3,  8,  2,  8, 10,  0,  1,  8,  1, 10,  8, -1, -1, -1, -1 },
+	{   1, 10,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   1,  3,  8,  9,  1,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  9,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{   0,  3,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+};
+
+static const float s_cube[8][3] =
+{
+	{ 0.0f, 1.0f, 1.0f }, // 0
+	{ 1.0f, 1.0f, 1.0f }, // 1
+	{ 1.0f, 1.0f, 0.0f }, // 2
+	{ 0.0f, 1.0f, 0.0f }, // 3
+	{ 0.0f, 0.0f, 1.0f }, // 4
+	{ 1.0f, 0.0f, 1.0f }, // 5
+	{ 1.0f, 0.0f, 0.0f }, // 6
+	{ 0.0f, 0.0f, 0.0f }, // 7
+};
+
+// Cube corner offsets in block scratch, x, y, z.
+static const uint8_t s_corner[8][3] =
+{
+	{ 0, 1, 1 },
+	{ 1, 1, 1 },
+	{ 1, 1, 0 },
+	{ 0, 1, 0 },
+	{ 0, 0, 1 },
+	{ 1, 0, 1 },
+	{ 1, 0, 0 },
+	{ 0, 0, 0 },
+};
+
+static float vertLerp(float* __restrict _result, float _iso, uint32_t _idx0, float _v0, uint32_t _idx1, float _v1)
+{
+	const float* __restrict edge0 = s_cube[_idx0];
+	const float* __restrict edge1 = s_cube[_idx1];
+
+	if (fabsf(_iso-_v1) < 0.00001f)
+	{
+		_result[0] = edge1[0];
+		_result[1] = edge1[1];
+		_result[2] = edge1[2];
+		return 1.0f;
+	}
+
+	if (fabsf(_iso-_v0) < 0.00001f
+	||  fabsf(_v0-_v1) < 0.00001f)
+	{
+		_result[0] = edge0[0];
+		_result[1] = edge0[1];
+		_result[2] = edge0[2];
+		return 0.0f;
+	}
+
+	float lerp = (_iso - _v0) / (_v1 - _v0);
+	_result[0] = edge0[0] + lerp * (edge1[0] - edge0[0]);
+	_result[1] = edge0[1] + lerp * (edge1[1] - edge0[1]);
+	_result[2] = edge0[2] + lerp * (edge1[2] - edge0[2]);
+
+	return lerp;
+}
+
+static uint32_t triangulate(PolygonizerVertex* _result, const float* __restrict _rgb, const float* __restrict _xyz, float _scale, const float _val[8], const float _normal[8][3], uint8_t _cubeindex, float _iso)
+{
+	float verts[12][6];
+	uint16_t flags = s_edges[_cubeindex];
+
+	for (uint32_t ii = 0; ii < 12; ++ii)
+	{
+		if (flags & (1<<ii) )
+		{
+			uint32_t idx0 = ii&7;
+			uint32_t idx1 = "\x1\x2\x3\x0\x5\x6\x7\x4\x4\x5\x6\x7"[ii];
+			float* vertex = verts[ii];
+			float lerp = vertLerp(vertex, _iso, idx0, _val[idx0], idx1, _val[idx1]);
+
+			const float* na = _normal[idx0];
+			const float* nb = _normal[idx1];
+			vertex[3] = na[0] + lerp * (nb[0] - na[0]);
+			vertex[4] = na[1] + lerp * (nb[1] - na[1]);
+			vertex[5] = na[2] + lerp * (nb[2] - na[2]);
+		}
+	}
+
+	float dr = _rgb[3] - _rgb[0];
+	float dg = _rgb[4] - _rgb[1];
+	float db = _rgb[5] - _rgb[2];
+
+	uint32_t num = 0;
+	const int8_t* indices = s_indices[_cubeindex];
+	for (uint32_t ii = 0; indices[ii] != -1; ++ii)
+	{
+		const float* vertex = verts[indices[ii] ];
+
+		PolygonizerVertex& result = _result[num];
+		result.m_pos[0] = _xyz[0] + vertex[0]*_scale;
+		result.m_pos[1] = _xyz[1] + vertex[1]*_scale;
+		result.m_pos[2] = _xyz[2] + vertex[2]*_scale;
+
+		result.m_normal[0] = vertex[3];
+		result.m_normal[1] = vertex[4];
+		result.m_normal[2] = vertex[5];
+
+		uint32_t rr = uint8_t( (_rgb[0] + vertex[0]*dr)*255.0f);
+		uint32_t gg = uint8_t( (_rgb[1] + vertex[1]*dg)*255.0f);
+		uint32_t bb = uint8_t( (_rgb[2] + vertex[2]*db)*255.0f);
+
+		result.m_abgr = 0xff000000
+			| (bb<<16)
+			| (gg<<8)
+			| rr
+			;
+
+		++num;
+	}
+
+	return num;
+}
+
+Polygonizer::Polygonizer()
+	: m_cellSize(1.0f)
+	, m_iso(0.0f)
+	, m_dims(0)
+	, m_numBlocks(0)
+	, m_numThreads(1)
+{
+	memset(&m_stats, 0, sizeof(m_stats) );
+	m_min[0] = 0.0f;
+	m_min[1] = 0.0f;
+	m_min[2] = 0.0f;
+}
+
+Polygonizer::~Polygonizer()
+{
+	setGrid(0, m_min, m_cellSize);
+}
+
+void Polygonizer::setGrid(uint32_t _dims, const float* _min, float _cellSize)
+{
+	m_min[0] = _min[0];
+	m_min[1] = _min[1];
+	m_min[2] = _min[2];
+	m_cellSize = _cellSize;
+
+	if (_dims == m_dims)
+	{
+		return;
+	}
+
+	for (uint32_t ii = 0, num = uint32_t(m_slabs.size() ); ii < num; ++ii)
+	{
+		Slab& slab = m_slabs[ii];
+		free(slab.m_vertices);
+		free(slab.m_scratchUnaligned);
+	}
+
+	m_dims = _dims;
+	m_numBlocks = 1 < _dims ? (_dims-1 + POLYGONIZER_BLOCK_SIZE-1)/POLYGONIZER_BLOCK_SIZE : 0;
+	m_slabs.resize(m_numBlocks);
+
+	for (uint32_t ii = 0; ii < m_numBlocks; ++ii)
+	{
+		Slab& slab = m_slabs[ii];
+		slab.m_vertices = NULL;
+		slab.m_numVertices = 0;
+		slab.m_maxVertices = 0;
+		slab.m_numBlocksSkipped = 0;
+		slab.m_scratchUnaligned = malloc(POLYGONIZER_SCRATCH_SIZE + 15);
+		slab.m_scratch = (float*)bx::alignPtr(slab.m_scratchUnaligned, 0, 16);
+	}
+
+	memset(&m_stats, 0, sizeof(m_stats) );
+}
+
+void Polygonizer::setNumThreads(uint32_t _numThreads)
+{
+	m_numThreads = bx::uint32_max(_numThreads, 1);
+}
+
+uint32_t Polygonizer::polygonize(const float (*_spheres)[4], uint32_t _numSpheres, float _iso)
+{
+	const int64_t start = bx::getHPCounter();
+
+	m_iso = _iso;
+	m_spheres.resize(_numSpheres);
+	for (uint32_t ii = 0; ii < _numSpheres; ++ii)
+	{
+		Sphere& sphere = m_spheres[ii];
+		sphere.m_pos[0] = _spheres[ii][0];
+		sphere.m_pos[1] = _spheres[ii][1];
+		sphere.m_pos[2] = _spheres[ii][2];
+		sphere.m_invRadiusSq = _spheres[ii][3]*_spheres[ii][3];
+		sphere.m_radiusSq = 1.0f/sphere.m_invRadiusSq;
+	}
+
+	bgfx::parallelFor(m_numBlocks, polygonizeSlab, this, m_numThreads);
+
+	const uint32_t numCells = 1 < m_dims ? m_dims-1 : 0;
+	m_stats.m_numCells = numCells*numCells*numCells;
+	m_stats.m_numBlocks = m_numBlocks*m_numBlocks*m_numBlocks;
+	m_stats.m_numBlocksSkipped = 0;
+	m_stats.m_numVertices = 0;
+
+	for (uint32_t ii = 0; ii < m_numBlocks; ++ii)
+	{
+		const Slab& slab = m_slabs[ii];
+		m_stats.m_numBlocksSkipped += slab.m_numBlocksSkipped;
+		m_stats.m_numVertices += slab.m_numVertices;
+	}
+
+	m_stats.m_numVerticesDropped = m_stats.m_numVertices;
+	m_stats.m_time = bx::getHPCounter() - start;
+
+	return m_stats.m_numVertices;
+}
+
+uint32_t Polygonizer::copy(PolygonizerVertex* _dst, uint32_t _max)
+{
+	uint32_t num = 0;
+	_max -= _max%3;
+
+	for (uint32_t ii = 0; ii < m_numBlocks && num < _max; ++ii)
+	{
+		const Slab& slab = m_slabs[ii];
+		const uint32_t numVertices = bx::uint32_min(slab.m_numVertices, _max - num);
+		memcpy(&_dst[num], slab.m_vertices, numVertices*sizeof(PolygonizerVertex) );
+		num += numVertices;
+	}
+
+	m_stats.m_numVerticesDropped = m_stats.m_numVertices - num;
+
+	return num;
+}
+
+void Polygonizer::polygonizeSlab(uint32_t _slab, void* _userData)
+{
+	const Polygonizer& polygonizer = *(const Polygonizer*)_userData;
+	Slab& slab = const_cast<Slab&>(polygonizer.m_slabs[_slab]);
+	slab.m_numVertices = 0;
+	slab.m_numBlocksSkipped = 0;
+
+	const uint32_t lastCell = polygonizer.m_dims-1;
+
+	uint32_t first[3];
+	uint32_t last[3];
+	first[2] = _slab*POLYGONIZER_BLOCK_SIZE;
+	last[2] = bx::uint32_min(first[2] + POLYGONIZER_BLOCK_SIZE, lastCell);
+
+	for (uint32_t yy = 0; yy < polygonizer.m_numBlocks; ++yy)
+	{
+		first[1] = yy*POLYGONIZER_BLOCK_SIZE;
+		last[1] = bx::uint32_min(first[1] + POLYGONIZER_BLOCK_SIZE, lastCell);
+
+		for (uint32_t xx = 0; xx < polygonizer.m_numBlocks; ++xx)
+		{
+			first[0] = xx*POLYGONIZER_BLOCK_SIZE;
+			last[0] = bx::uint32_min(first[0] + POLYGONIZER_BLOCK_SIZE, lastCell);
+
+			if (polygonizer.skipBlock(first, last) )
+			{
+				++slab.m_numBlocksSkipped;
+				continue;
+			}
+
+			polygonizer.evaluateBlock(slab.m_scratch, first, last);
+			polygonizer.triangulateBlock(slab, slab.m_scratch, first, last);
+		}
+	}
+}
+
+bool Polygonizer::skipBlock(const uint32_t* _first, const uint32_t* _last) const
+{
+	float bmin[3];
+	float bmax[3];
+	for (uint32_t ii = 0; ii < 3; ++ii)
+	{
+		bmin[ii] = m_min[ii] + float(_first[ii])*m_cellSize;
+		bmax[ii] = m_min[ii] + float(_last[ii])*m_cellSize;
+	}
+
+	// Each sphere contributes r^2/d^2, field is bounded by closest and
+	// farthest point of block to each sphere.
+	float maxSum = 0.0f;
+	float minSum = 0.0f;
+	for (uint32_t ii = 0, num = uint32_t(m_spheres.size() ); ii < num; ++ii)
+	{
+		const Sphere& sphere = m_spheres[ii];
+
+		float dmin = 0.0f;
+		float dmax = 0.0f;
+		for (uint32_t jj = 0; jj < 3; ++jj)
+		{
+			const float d0 = bmin[jj] - sphere.m_pos[jj];
+			const float d1 = sphere.m_pos[jj] - bmax[jj];
+			const float dd = d0 > 0.0f ? d0 : (d1 > 0.0f ? d1 : 0.0f);
+			const float df = fabsf(d0) > fabsf(d1) ? d0 : d1;
+			dmin += dd*dd;
+			dmax += df*df;
+		}
+
+		if (0.0f == dmin)
+		{
+			maxSum = HUGE_VALF;
+		}
+		else
+		{
+			maxSum += sphere.m_radiusSq/dmin;
+		}
+
+		minSum += sphere.m_radiusSq/dmax;
+	}
+
+	// Block is empty when all samples are either outside or inside of iso
+	// surface. Bounds are widened a bit against rounding of evaluation.
+	const float threshold = m_iso + 1.0f;
+	return maxSum < threshold*0.999f
+		|| minSum > threshold*1.001f
+		;
+}
+
+void Polygonizer::evaluateBlock(float* _scratch, const uint32_t* _first, const uint32_t* _last) const
+{
+	using namespace bx;
+
+	const uint32_t numX = _last[0] - _first[0] + 1;
+	const uint32_t numY = _last[1] - _first[1] + 1;
+	const uint32_t numZ = _last[2] - _first[2] + 1;
+	const uint32_t numSpheres = uint32_t(m_spheres.size() );
+	const Sphere* spheres = &m_spheres[0];
+
+	float* val     = &_scratch[POLYGONIZER_BLOCK_PLANE*0];
+	float* normalX = &_scratch[POLYGONIZER_BLOCK_PLANE*1];
+	float* normalY = &_scratch[POLYGONIZER_BLOCK_PLANE*2];
+	float* normalZ = &_scratch[POLYGONIZER_BLOCK_PLANE*3];
+
+	const float4_t one  = float4_splat(1.0f);
+	const float4_t zero = float4_zero();
+	const float4_t tiny = float4_splat(1e-20f);
+
+	for (uint32_t zz = 0; zz < numZ; ++zz)
+	{
+		const float pz = m_min[2] + float(_first[2]+zz)*m_cellSize;
+
+		for (uint32_t yy = 0; yy < numY; ++yy)
+		{
+			const float py = m_min[1] + float(_first[1]+yy)*m_cellSize;
+			const uint32_t offset = (zz*POLYGONIZER_BLOCK_SAMPLES + yy)*POLYGONIZER_BLOCK_PITCH;
+
+			for (uint32_t xx = 0; xx < numX; xx += 4)
+			{
+				const float px = m_min[0] + float(_first[0]+xx)*m_cellSize;
+				const float4_t vpx = float4_ld(px
+					, px + m_cellSize
+					, px + m_cellSize*2.0f
+					, px + m_cellSize*3.0f
+					);
+
+				float4_t sum = zero;
+				float4_t gx  = zero;
+				float4_t gy  = zero;
+				float4_t gz  = zero;
+
+				for (uint32_t ii = 0; ii < numSpheres; ++ii)
+				{
+					const Sphere& sphere = spheres[ii];
+					const float dy = sphere.m_pos[1] - py;
+					const float dz = sphere.m_pos[2] - pz;
+
+					const float4_t invr2 = float4_splat(sphere.m_invRadiusSq);
+					const float4_t vdx   = float4_sub(float4_splat(sphere.m_pos[0]), vpx);
+					const float4_t vdyz  = float4_splat(dy*dy + dz*dz);
+					const float4_t dot   = float4_mul(float4_add(float4_mul(vdx, vdx), vdyz), invr2);
+
+					// w = r^2/d^2, gradient of w is -2*w^2/r^2*(p-c).
+					const float4_t ww = float4_div(one, dot);
+					const float4_t tt = float4_mul(float4_mul(ww, ww), invr2);
+					sum = float4_add(sum, ww);
+					gx  = float4_add(gx, float4_mul(tt, vdx) );
+					gy  = float4_add(gy, float4_mul(tt, float4_splat(dy) ) );
+					gz  = float4_add(gz, float4_mul(tt, float4_splat(dz) ) );
+				}
+
+				// Normal points away from spheres, against gradient.
+				const float4_t len2 = float4_add(float4_mul(gx, gx), float4_add(float4_mul(gy, gy), float4_mul(gz, gz) ) );
+				const float4_t invLen = float4_div(float4_neg(one), float4_sqrt(float4_max(len2, tiny) ) );
+
+				float4_st(&val    [offset+xx], float4_sub(sum, one) );
+				float4_st(&normalX[offset+xx], float4_mul(gx, invLen) );
+				float4_st(&normalY[offset+xx], float4_mul(gy, invLen) );
+				float4_st(&normalZ[offset+xx], float4_mul(gz, invLen) );
+			}
+		}
+	}
+}
+
+void Polygonizer::triangulateBlock(Slab& _slab, const float* _scratch, const uint32_t* _first, const uint32_t* _last) const
+{
+	const float* val     = &_scratch[POLYGONIZER_BLOCK_PLANE*0];
+	const float* normalX = &_scratch[POLYGONIZER_BLOCK_PLANE*1];
+	const float* normalY = &_scratch[POLYGONIZER_BLOCK_PLANE*2];
+	const float* normalZ = &_scratch[POLYGONIZER_BLOCK_PLANE*3];
+
+	const float invdim = 1.0f/float(m_dims-1);
+	const float iso = m_iso;
+
+	uint32_t corner[8];
+	for (uint32_t ii = 0; ii < 8; ++ii)
+	{
+		corner[ii] = (s_corner[ii][2]*POLYGONIZER_BLOCK_SAMPLES + s_corner[ii][1])*POLYGONIZER_BLOCK_PITCH + s_corner[ii][0];
+	}
+
+	for (uint32_t zz = _first[2]; zz < _last[2]; ++zz)
+	{
+		float rgb[6];
+		rgb[2] = zz*invdim;
+		rgb[5] = (zz+1)*invdim;
+
+		for (uint32_t yy = _first[1]; yy < _last[1]; ++yy)
+		{
+			rgb[1] = yy*invdim;
+			rgb[4] = (yy+1)*invdim;
+
+			const uint32_t offset = ( (zz-_first[2])*POLYGONIZER_BLOCK_SAMPLES + yy-_first[1])*POLYGONIZER_BLOCK_PITCH - _first[0];
+
+			for (uint32_t xx = _first[0]; xx < _last[0]; ++xx)
+			{
+				const uint32_t xoffset = offset + xx;
+
+				uint8_t cubeindex = 0;
+				float cval[8];
+				for (uint32_t ii = 0; ii < 8; ++ii)
+				{
+					cval[ii] = val[xoffset + corner[ii] ];
+					cubeindex |= (cval[ii] < iso) ? uint8_t(1<<ii) : 0;
+				}
+
+				if (0 == s_edges[cubeindex])
+				{
+					continue;
+				}
+
+				float normal[8][3];
+				for (uint32_t ii = 0; ii < 8; ++ii)
+				{
+					normal[ii][0] = normalX[xoffset + corner[ii] ];
+					normal[ii][1] = normalY[xoffset + corner[ii] ];
+					normal[ii][2] = normalZ[xoffset + corner[ii] ];
+				}
+
+				rgb[0] = xx*invdim;
+				rgb[3] = (xx+1)*invdim;
+
+				const float pos[3] =
+				{
+					m_min[0] + float(xx)*m_cellSize,
+					m_min[1] + float(yy)*m_cellSize,
+					m_min[2] + float(zz)*m_cellSize,
+				};
+
+				if (_slab.m_numVertices + POLYGONIZER_MAX_CELL_VERTICES > _slab.m_maxVertices)
+				{
+					_slab.m_maxVertices = bx::uint32_max(_slab.m_maxVertices*2, 4<<10);
+					_slab.m_vertices = (PolygonizerVertex*)realloc(_slab.m_vertices, _slab.m_maxVertices*sizeof(PolygonizerVertex) );
+				}
+
+				_slab.m_numVertices += triangulate(&_slab.m_vertices[_slab.m_numVertices], rgb, pos, m_cellSize, cval, normal, cubeindex, iso);
+			}
+		}
+	}
+}
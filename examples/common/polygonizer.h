@@ -0,0 +1,126 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef POLYGONIZER_H_HEADER_GUARD
+#define POLYGONIZER_H_HEADER_GUARD
+
+#include <stdint.h>
+
+#include <vector>
+
+/// Cells per block edge. Blocks are unit of empty space skipping, and
+/// slabs of blocks along Z are unit of parallel work.
+#define POLYGONIZER_BLOCK_SIZE 8
+
+/// Maximum number of vertices marching cubes emits per cell.
+#define POLYGONIZER_MAX_CELL_VERTICES 15
+
+/// Vertex layout written by polygonizer: position, normal and color as
+/// 4 normalized uint8.
+///
+struct PolygonizerVertex
+{
+	float m_pos[3];
+	float m_normal[3];
+	uint32_t m_abgr;
+};
+
+struct PolygonizerStats
+{
+	uint32_t m_numCells;            //!< Cells in grid.
+	uint32_t m_numBlocks;           //!< Blocks in grid.
+	uint32_t m_numBlocksSkipped;    //!< Blocks skipped by sphere bounds.
+	uint32_t m_numVertices;         //!< Vertices generated.
+	uint32_t m_numVerticesDropped;  //!< Generated vertices not copied by last copy call.
+	int64_t m_time;                 //!< Time of last polygonize call in bx::getHPCounter units.
+};
+
+/// Marching cubes polygonizer of metaball field:
+///
+///   f(p) = sum(r_i^2 / |p - c_i|^2) - 1
+///
+/// Field is evaluated 4 samples at a time per block of cells. Blocks which
+/// are entirely inside or outside of iso surface, according to sphere
+/// bounds, are skipped. Slabs of blocks are triangulated in parallel, each
+/// into own output, and output is concatenated in slab order so result
+/// doesn't depend on number of threads.
+///
+class Polygonizer
+{
+public:
+	Polygonizer();
+	~Polygonizer();
+
+	/// Set grid.
+	///
+	/// @param _dims Number of samples along each axis. Grid has _dims-1
+	///   cells along each axis.
+	/// @param _min Position of first sample.
+	/// @param _cellSize Distance between samples.
+	///
+	void setGrid(uint32_t _dims, const float* _min, float _cellSize);
+
+	/// Set number of threads used, including calling thread.
+	void setNumThreads(uint32_t _numThreads);
+
+	/// Polygonize iso surface into internal per slab storage.
+	///
+	/// @param _spheres Sphere center xyz, and inverse radius in w.
+	/// @param _iso Iso value.
+	/// @returns Number of generated vertices, triangle list.
+	///
+	uint32_t polygonize(const float (*_spheres)[4], uint32_t _numSpheres, float _iso);
+
+	/// Copy generated vertices.
+	///
+	/// @param _max Maximum number of vertices copied, only whole triangles
+	///   are copied.
+	/// @returns Number of copied vertices. Vertices which didn't fit are
+	///   reported in PolygonizerStats::m_numVerticesDropped.
+	///
+	uint32_t copy(PolygonizerVertex* _dst, uint32_t _max);
+
+	///
+	const PolygonizerStats& getStats() const
+	{
+		return m_stats;
+	}
+
+private:
+	struct Sphere
+	{
+		float m_pos[3];
+		float m_invRadiusSq;
+		float m_radiusSq;
+	};
+
+	struct Slab
+	{
+		PolygonizerVertex* m_vertices;
+		uint32_t m_numVertices;
+		uint32_t m_maxVertices;
+		uint32_t m_numBlocksSkipped;
+		void* m_scratchUnaligned;
+		float* m_scratch;
+	};
+
+	static void polygonizeSlab(uint32_t _slab, void* _userData);
+
+	bool skipBlock(const uint32_t* _first, const uint32_t* _last) const;
+	void evaluateBlock(float* _scratch, const uint32_t* _first, const uint32_t* _last) const;
+	void triangulateBlock(Slab& _slab, const float* _scratch, const uint32_t* _first, const uint32_t* _last) const;
+
+	std::vector<Slab> m_slabs;
+	std::vector<Sphere> m_spheres;
+	PolygonizerStats m_stats;
+	float m_min[3];
+	float m_cellSize;
+	float m_iso;
+	uint32_t m_dims;
+	uint32_t m_numBlocks;
+	uint32_t m_numThreads;
+};
+
+#endif // POLYGONIZER_H_HEADER_GUARD
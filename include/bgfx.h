@@ -236,6 +236,10 @@
 #define BGFX_RESET_VSYNC                 UINT32_C(0x00000080)
 #define BGFX_RESET_CAPTURE               UINT32_C(0x00000100)
 
+///
+#define BGFX_BUFFER_NONE                 UINT8_C(0x00)
+#define BGFX_BUFFER_INDEX32              UINT8_C(0x01) //!< Index buffer contains 32-bit indices.
+
 ///
 #define BGFX_CAPS_TEXTURE_FORMAT_BC1     UINT64_C(0x0000000000000001)
 #define BGFX_CAPS_TEXTURE_FORMAT_BC2     UINT64_C(0x0000000000000002)
@@ -265,6 +269,8 @@
 #define BGFX_CAPS_INSTANCING             UINT64_C(0x0000000008000000)
 #define BGFX_CAPS_RENDERER_MULTITHREADED UINT64_C(0x0000000010000000)
 #define BGFX_CAPS_FRAGMENT_DEPTH         UINT64_C(0x0000000020000000)
+#define BGFX_CAPS_INDEX32                UINT64_C(0x0000000040000000)
+#define BGFX_CAPS_TEXTURE_RESIDENCY      UINT64_C(0x0000000080000000)
 
 #define BGFX_CAPS_TEXTURE_DEPTH_MASK (0 \
 			| BGFX_CAPS_TEXTURE_FORMAT_D16 \
@@ -424,6 +430,7 @@ namespace bgfx
 	static const uint16_t invalidHandle = UINT16_MAX;
 
 	BGFX_HANDLE(DynamicIndexBufferHandle);
+	BGFX_HANDLE(DrawListHandle);
 	BGFX_HANDLE(DynamicVertexBufferHandle);
 	BGFX_HANDLE(FragmentShaderHandle);
 	BGFX_HANDLE(IndexBufferHandle);
@@ -484,6 +491,13 @@ namespace bgfx
 		uint32_t size;
 	};
 
+	/// Memory release callback.
+	///
+	/// @param _ptr Pointer to data passed to makeRef.
+	/// @param _userData User data passed to makeRef.
+	///
+	typedef void (*ReleaseFn)(void* _ptr, void* _userData);
+
 	/// Renderer capabilities.
 	struct Caps
 	{
@@ -532,6 +546,26 @@ namespace bgfx
 		VertexBufferHandle handle;
 	};
 
+	/// Structure of arrays describing draw calls for bulk submit. Per draw
+	/// arrays have `num` elements. Optional arrays can be NULL.
+	///
+	struct SubmitArrays
+	{
+		uint32_t num;                           //!< Number of draw calls.
+		const ProgramHandle* program;           //!< Program.
+		const uint64_t* state;                  //!< State flags, NULL for BGFX_STATE_DEFAULT.
+		const float* mtx;                       //!< Model matrix, 16 floats per draw call, NULL for identity.
+		const VertexBufferHandle* vertexBuffer; //!< Vertex buffer.
+		const uint32_t* numVertices;            //!< Number of vertices, NULL for all.
+		const IndexBufferHandle* indexBuffer;   //!< Index buffer, NULL for non-indexed draw calls.
+		const uint32_t* startIndex;             //!< First index, NULL for 0.
+		const uint32_t* numIndices;             //!< Number of indices, NULL for all.
+		const UniformHandle* sampler;           //!< Program sampler per texture stage, shared by all draw calls.
+		const TextureHandle* texture;           //!< numSamplers textures per draw call.
+		uint8_t numSamplers;                    //!< Number of texture stages.
+		const int32_t* depth;                   //!< Depth for sorting, NULL for 0.
+	};
+
 	struct TextureInfo
 	{
 		TextureFormat::Enum format;
@@ -543,6 +577,23 @@ namespace bgfx
 		uint8_t bitsPerPixel;
 	};
 
+	/// Mip level requested by texture streaming manager.
+	struct TextureStreamRequest
+	{
+		TextureHandle handle; ///< Streaming texture.
+		uint8_t mip;          ///< Mip level to upload with updateTexture2DStreaming.
+	};
+
+	/// Texture streaming statistics.
+	struct TextureStreamingStats
+	{
+		uint32_t budget;      ///< Byte budget for streaming textures.
+		uint32_t resident;    ///< Bytes of resident mip levels.
+		uint32_t requested;   ///< Bytes of mip levels wanted to be resident.
+		uint16_t numTextures; ///< Number of streaming textures.
+		uint16_t numRequests; ///< Number of pending mip level requests.
+	};
+
 	/// Vertex declaration.
 	struct VertexDecl
 	{
@@ -600,6 +651,35 @@ namespace bgfx
 	/// Unpack vec4 from vertex stream format.
 	void vertexUnpack(float _output[4], Attrib::Enum _attr, const VertexDecl& _decl, const void* _data, uint32_t _index = 0);
 
+	/// Pack _num vec4 into vertex stream format.
+	///
+	/// @param _input Array of _num vec4, tightly packed.
+	/// @param _inputNormalized Input values are normalized.
+	/// @param _attr Attribute to pack.
+	/// @param _decl Vertex stream declaration.
+	/// @param _data Vertex stream.
+	/// @param _index First vertex to pack.
+	/// @param _num Number of vertices to pack.
+	///
+	/// NOTE:
+	///   Results are the same as calling vertexPack for each vertex.
+	///
+	void vertexPack(const float* _input, bool _inputNormalized, Attrib::Enum _attr, const VertexDecl& _decl, void* _data, uint32_t _index, uint32_t _num);
+
+	/// Unpack _num vec4 from vertex stream format.
+	///
+	/// @param _output Array of _num vec4, tightly packed.
+	/// @param _attr Attribute to unpack.
+	/// @param _decl Vertex stream declaration.
+	/// @param _data Vertex stream.
+	/// @param _index First vertex to unpack.
+	/// @param _num Number of vertices to unpack.
+	///
+	/// NOTE:
+	///   Results are the same as calling vertexUnpack for each vertex.
+	///
+	void vertexUnpack(float* _output, Attrib::Enum _attr, const VertexDecl& _decl, const void* _data, uint32_t _index, uint32_t _num);
+
 	/// Converts vertex stream data from one vertex stream format to another.
 	///
 	/// @param _destDecl Destination vertex stream declaration.
@@ -622,6 +702,158 @@ namespace bgfx
 	///
 	uint16_t weldVertices(uint16_t* _output, const VertexDecl& _decl, const void* _data, uint16_t _num, float _epsilon = 0.001f);
 
+	/// Weld vertices comparing all attributes.
+	///
+	/// @param _output Welded vertices remapping table. The size of buffer
+	///   must be the same as number of vertices. Every vertex is remapped to
+	///   lowest numbered unique vertex within tolerance, or to itself.
+	/// @param _decl Vertex stream declaration.
+	/// @param _data Vertex stream.
+	/// @param _num Number of vertices in vertex stream.
+	/// @param _epsilon Error tolerance per attribute, indexed by Attrib::Enum.
+	///   Unpacked attribute values are compared by distance, zero means
+	///   exact match, and negative value excludes attribute from comparison.
+	///   Position must be compared, it's used for spatial hashing.
+	/// @param _numThreads Number of threads used, including calling thread.
+	///   Result doesn't depend on number of threads.
+	/// @returns Number of unique vertices after vertex welding.
+	///
+	/// NOTE:
+	///   Temporary memory is allocated with allocator passed to init.
+	///
+	uint32_t weldVertices(uint32_t* _output, const VertexDecl& _decl, const void* _data, uint32_t _num, const float _epsilon[Attrib::Count], uint32_t _numThreads = 1);
+
+	typedef void (*ParallelForFn)(uint32_t _index, void* _userData);
+
+	/// Call _fn for every index in [0, _num) on up to _numThreads threads,
+	/// including calling thread. Indices are handed out dynamically, in
+	/// increasing order. Returns when all calls are done.
+	///
+	/// NOTE:
+	///   Worker threads are created on first use and kept for subsequent
+	///   calls. Calls made while workers are busy, from _fn or from other
+	///   thread, run on calling thread only.
+	///
+	void parallelFor(uint32_t _num, ParallelForFn _fn, void* _userData, uint32_t _numThreads);
+
+	/// Returns size of scratch memory in bytes that is sufficient for any of
+	/// mesh optimization functions below.
+	///
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices.
+	///
+	uint32_t getMeshOptimizeScratchSize(uint32_t _numIndices, uint32_t _numVertices);
+
+	/// Reorder triangles for post-transform vertex cache.
+	///
+	/// @param _indices Triangle list indices, reordered in place.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices referenced by indices.
+	/// @param _cacheSize Simulated FIFO vertex cache size.
+	/// @param _scratch Scratch memory of getMeshOptimizeScratchSize bytes,
+	///   4 byte aligned. When NULL, memory is allocated with allocator passed
+	///   to init for the duration of call.
+	///
+	/// NOTE:
+	///   Runs in linear time. Triangles keep their winding, but order of
+	///   triangles within index buffer is not preserved.
+	///
+	void optimizeVertexCache(uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize = 16, void* _scratch = NULL);
+
+	/// Reorder triangles for post-transform vertex cache.
+	///
+	/// @param _indices Triangle list indices, reordered in place.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices referenced by indices.
+	/// @param _cacheSize Simulated FIFO vertex cache size.
+	/// @param _scratch Scratch memory of getMeshOptimizeScratchSize bytes,
+	///   4 byte aligned. When NULL, memory is allocated with allocator passed
+	///   to init for the duration of call.
+	///
+	void optimizeVertexCache(uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize = 16, void* _scratch = NULL);
+
+	/// Calculate vertex remapping table that puts vertices in order of first
+	/// use by index buffer, so that vertex fetch reads memory mostly
+	/// sequentially. Unreferenced vertices are moved to the end.
+	///
+	/// @param _remap Remapping table from old to new vertex index. The size
+	///   of buffer must be the same as number of vertices.
+	/// @param _indices Indices, should already be optimized for vertex
+	///   cache.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices.
+	/// @returns Number of referenced vertices.
+	///
+	uint32_t optimizeVertexFetch(uint32_t* _remap, const uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices);
+
+	/// Calculate vertex remapping table that puts vertices in order of first
+	/// use by index buffer.
+	///
+	/// @param _remap Remapping table from old to new vertex index. The size
+	///   of buffer must be the same as number of vertices.
+	/// @param _indices Indices, should already be optimized for vertex
+	///   cache.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices.
+	/// @returns Number of referenced vertices.
+	///
+	uint32_t optimizeVertexFetch(uint32_t* _remap, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices);
+
+	/// Remap indices in place.
+	///
+	/// @param _indices Indices.
+	/// @param _numIndices Number of indices.
+	/// @param _remap Remapping table from old to new vertex index.
+	///
+	void remapIndices(uint16_t* _indices, uint32_t _numIndices, const uint32_t* _remap);
+
+	/// Remap indices in place.
+	///
+	/// @param _indices Indices.
+	/// @param _numIndices Number of indices.
+	/// @param _remap Remapping table from old to new vertex index.
+	///
+	void remapIndices(uint32_t* _indices, uint32_t _numIndices, const uint32_t* _remap);
+
+	/// Remap vertices in place.
+	///
+	/// @param _decl Vertex stream declaration.
+	/// @param _data Vertex stream.
+	/// @param _numVertices Number of vertices in vertex stream.
+	/// @param _remap Remapping table from old to new vertex index, must be
+	///   permutation (for example result of optimizeVertexFetch).
+	/// @param _scratch Scratch memory of getMeshOptimizeScratchSize bytes,
+	///   4 byte aligned. When NULL, memory is allocated with allocator passed
+	///   to init for the duration of call.
+	///
+	void remapVertices(const VertexDecl& _decl, void* _data, uint32_t _numVertices, const uint32_t* _remap, void* _scratch = NULL);
+
+	/// Returns average cache miss ratio (ACMR), number of simulated FIFO
+	/// vertex cache misses per triangle. 0.5 is ideal for regular grid, 3.0
+	/// is worst case.
+	///
+	/// @param _indices Triangle list indices.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices referenced by indices.
+	/// @param _cacheSize Simulated FIFO vertex cache size.
+	/// @param _scratch Scratch memory of getMeshOptimizeScratchSize bytes,
+	///   4 byte aligned. When NULL, memory is allocated with allocator passed
+	///   to init for the duration of call.
+	///
+	float getVertexCacheAcmr(const uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize = 16, void* _scratch = NULL);
+
+	/// Returns average cache miss ratio (ACMR) for 32-bit indices.
+	///
+	/// @param _indices Triangle list indices.
+	/// @param _numIndices Number of indices.
+	/// @param _numVertices Number of vertices referenced by indices.
+	/// @param _cacheSize Simulated FIFO vertex cache size.
+	/// @param _scratch Scratch memory of getMeshOptimizeScratchSize bytes,
+	///   4 byte aligned. When NULL, memory is allocated with allocator passed
+	///   to init for the duration of call.
+	///
+	float getVertexCacheAcmr(const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize = 16, void* _scratch = NULL);
+
 	/// Swizzle RGBA8 image to BGRA8.
 	///
 	/// @param _width Width of input image (pixels).
@@ -647,6 +879,31 @@ namespace bgfx
 	/// Returns renderer backend API type.
 	RendererType::Enum getRendererType();
 
+	/// Use built-in program binary cache instead of CallbackI cache
+	/// functions.
+	///
+	/// @param _filePath Cache file path. Pass NULL to disable built-in
+	///   cache.
+	///
+	/// NOTE:
+	///   Must be called before bgfx::init. All program binaries are
+	///   stored in single append-only file which is memory mapped when
+	///   renderer is initialized. File is discarded when GPU or driver
+	///   changes, and it's compacted on shutdown when it contains more
+	///   stale than live data. Program binaries are supported only by
+	///   OpenGL renderers (GL_ARB_get_program_binary, OpenGL ES 3.0).
+	///
+	void setProgramCache(const char* _filePath);
+
+	/// Create programs from all binaries stored in program cache. Call
+	/// this while loading screen is displayed, so that later createProgram
+	/// calls with matching shaders don't stall on program linking.
+	///
+	/// NOTE:
+	///   Works only with cache set by setProgramCache.
+	///
+	void prewarmProgramCache();
+
 	/// Initialize bgfx library.
 	///
 	/// @param _callback Provide application specific callback interface.
@@ -672,6 +929,17 @@ namespace bgfx
 	///   double/multi buffering data outside the library and passing it to
 	///   library via makeRef calls.
 	///
+	/// @remarks Index buffers, vertex buffers, textures (except streaming
+	///   textures) and uniforms can be created and destroyed from threads
+	///   other than API thread. Commands of each thread are executed in
+	///   order in which they were issued, and create commands of other
+	///   threads are executed before those of API thread issued in the same
+	///   frame. Resources created on other thread can be used for rendering
+	///   only after first frame call which started after creation
+	///   returned. All other API calls must be
+	///   made from API thread, and no call can be made once shutdown
+	///   started.
+	///
 	uint32_t frame();
 
 	/// Returns renderer capabilities.
@@ -685,6 +953,21 @@ namespace bgfx
 	/// You must make sure data is available for at least 2 bgfx::frame calls.
 	const Memory* makeRef(const void* _data, uint32_t _size);
 
+	/// Make reference to data to pass to bgfx, and get notified once bgfx
+	/// doesn't need data anymore.
+	///
+	/// @param _data Data.
+	/// @param _size Size of data.
+	/// @param _releaseFn Function called with _data and _userData once
+	///   data is consumed. Data must stay valid until this call.
+	/// @param _userData User data passed to _releaseFn.
+	///
+	/// NOTE:
+	///   _releaseFn can be called from render thread, and it must not call
+	///   bgfx API.
+	///
+	const Memory* makeRef(const void* _data, uint32_t _size, ReleaseFn _releaseFn, void* _userData = NULL);
+
 	/// Set debug flags.
 	///
 	/// @param _debug Available flags:
@@ -709,9 +992,20 @@ namespace bgfx
 	void dbgTextPrintf(uint16_t _x, uint16_t _y, uint8_t _attr, const char* _format, ...);
 
 	/// Create static index buffer.
-	IndexBufferHandle createIndexBuffer(const Memory* _mem);
+	///
+	/// @param _mem Index buffer data.
+	/// @param _flags Buffer flags:
+	///   BGFX_BUFFER_INDEX32 - Buffer contains 32-bit indices. Availability
+	///     depends on: BGFX_CAPS_INDEX32.
+	///
+	/// @remarks Can be called from any thread, see frame.
+	///
+	IndexBufferHandle createIndexBuffer(const Memory* _mem, uint8_t _flags = BGFX_BUFFER_NONE);
 
 	/// Destroy static index buffer.
+	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	void destroyIndexBuffer(IndexBufferHandle _handle);
 
 	/// Create static vertex buffer.
@@ -720,25 +1014,31 @@ namespace bgfx
 	/// @param _decl Vertex declaration.
 	/// @returns Static vertex buffer handle.
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	VertexBufferHandle createVertexBuffer(const Memory* _mem, const VertexDecl& _decl);
 
 	/// Destroy static vertex buffer.
 	///
 	/// @param _handle Static vertex buffer handle.
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	void destroyVertexBuffer(VertexBufferHandle _handle);
 
 	/// Create empty dynamic index buffer.
 	///
 	/// @param _num Number of indices.
+	/// @param _flags Buffer flags, see createIndexBuffer.
 	///
-	DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num);
+	DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint8_t _flags = BGFX_BUFFER_NONE);
 
 	/// Create dynamic index buffer and initialized it.
 	///
 	/// @param _mem Index buffer data.
+	/// @param _flags Buffer flags, see createIndexBuffer.
 	///
-	DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem);
+	DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem, uint8_t _flags = BGFX_BUFFER_NONE);
 
 	/// Update dynamic index buffer.
 	///
@@ -747,6 +1047,15 @@ namespace bgfx
 	///
 	void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, const Memory* _mem);
 
+	/// Update part of dynamic index buffer.
+	///
+	/// @param _handle Dynamic index buffer handle.
+	/// @param _startIndex First index to update.
+	/// @param _mem Index buffer data, it must fit into buffer after
+	///   _startIndex.
+	///
+	void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const Memory* _mem);
+
 	/// Destroy dynamic index buffer.
 	///
 	/// @param _handle Dynamic index buffer handle.
@@ -770,14 +1079,25 @@ namespace bgfx
 	/// Update dynamic vertex buffer.
 	void updateDynamicVertexBuffer(DynamicVertexBufferHandle _handle, const Memory* _mem);
 
+	/// Update part of dynamic vertex buffer.
+	///
+	/// @param _handle Dynamic vertex buffer handle.
+	/// @param _startVertex First vertex to update.
+	/// @param _mem Vertex buffer data, it must fit into buffer after
+	///   _startVertex.
+	///
+	void updateDynamicVertexBuffer(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const Memory* _mem);
+
 	/// Destroy dynamic vertex buffer.
 	void destroyDynamicVertexBuffer(DynamicVertexBufferHandle _handle);
 
 	/// Returns true if internal transient index buffer has enough space.
 	///
 	/// @param _num Number of indices.
+	/// @param _flags Buffer flags, see createIndexBuffer. 32-bit indices
+	///   are allocated from separate transient index buffer.
 	///
-	bool checkAvailTransientIndexBuffer(uint32_t _num);
+	bool checkAvailTransientIndexBuffer(uint32_t _num, uint8_t _flags = BGFX_BUFFER_NONE);
 
 	/// Returns true if internal transient vertex buffer has enough space.
 	///
@@ -786,12 +1106,21 @@ namespace bgfx
 	///
 	bool checkAvailTransientVertexBuffer(uint32_t _num, const VertexDecl& _decl);
 
-	/// Returns true if internal instance data buffer has enough space.
+	/// Returns true if internal instance data buffer has enough space, and
+	/// instance data buffers can be allocated this frame.
 	///
 	/// @param _num Number of instances.
-	/// @param _stride Stride per instance.
+	/// @param _stride Stride per instance. When checking for multiple
+	///   buffers, sum of their strides, and every stride must be multiple
+	///   of 16.
+	/// @param _numBuffers Number of instance data buffers, for example one
+	///   per instance data stream.
 	///
-	bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride);
+	/// NOTE:
+	///   Multiple buffers are checked conservatively, alignment padding
+	///   between them is assumed to be worst case.
+	///
+	bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride, uint16_t _numBuffers = 1);
 
 	/// Returns true if both internal transient index and vertex buffer have
 	/// enough space.
@@ -808,12 +1137,13 @@ namespace bgfx
 	///   for the duration of frame, and it can be reused for multiple draw
 	///   calls.
 	/// @param _num Number of indices to allocate.
+	/// @param _flags Buffer flags, see createIndexBuffer.
 	///
 	/// NOTE:
 	///   You must call setIndexBuffer after alloc in order to avoid memory
 	///   leak.
 	///
-	void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num);
+	void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num, uint8_t _flags = BGFX_BUFFER_NONE);
 
 	/// Allocate transient vertex buffer.
 	///
@@ -831,9 +1161,19 @@ namespace bgfx
 
 	/// Allocate instance data buffer.
 	///
-	/// NOTE:
-	///   You must call setInstanceDataBuffer after alloc in order to avoid
-	///   memory leak.
+	/// @param _num Number of instances.
+	/// @param _stride Stride per instance, rounded up to multiple of 16
+	///   bytes. Each 16 bytes are one vec4 instance data attribute.
+	///
+	/// @returns InstanceDataBuffer is allocated from frame storage, and is
+	///   valid until setInstanceDataBuffer or setInstanceDataStream is
+	///   called with it, at most for the duration of frame. It doesn't
+	///   need to be freed. NULL if there are no more instance data buffers
+	///   this frame.
+	///
+	/// @remarks Number of instance data buffers per frame is limited by
+	///   BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS, use
+	///   checkAvailInstanceDataBuffer to check.
 	///
 	const InstanceDataBuffer* allocInstanceDataBuffer(uint32_t _num, uint16_t _stride);
 
@@ -881,6 +1221,8 @@ namespace bgfx
 	/// @param _info Returns parsed DDS texture information.
 	/// @returns Texture handle.
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	TextureHandle createTexture(const Memory* _mem, uint32_t _flags = BGFX_TEXTURE_NONE, TextureInfo* _info = NULL);
 
 	/// Create 2D texture.
@@ -892,6 +1234,8 @@ namespace bgfx
 	/// @param _flags
 	/// @param _mem
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	TextureHandle createTexture2D(uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags = BGFX_TEXTURE_NONE, const Memory* _mem = NULL);
 
 	/// Create 3D texture.
@@ -904,6 +1248,8 @@ namespace bgfx
 	/// @param _flags
 	/// @param _mem
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	TextureHandle createTexture3D(uint16_t _width, uint16_t _height, uint16_t _depth, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags = BGFX_TEXTURE_NONE, const Memory* _mem = NULL);
 
 	/// Create Cube texture.
@@ -914,6 +1260,8 @@ namespace bgfx
 	/// @param _flags
 	/// @param _mem
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	TextureHandle createTextureCube(uint16_t _size, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags = BGFX_TEXTURE_NONE, const Memory* _mem = NULL);
 
 	/// Update 2D texture.
@@ -979,8 +1327,67 @@ namespace bgfx
 	void updateTextureCube(TextureHandle _handle, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height, const Memory* _mem, uint16_t _pitch = UINT16_MAX);
 
 	/// Destroy texture.
+	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	void destroyTexture(TextureHandle _handle);
 
+	/// Create streaming 2D texture.
+	///
+	/// @param _width Width of mip level 0.
+	/// @param _height Height of mip level 0.
+	/// @param _numMips Number of mip levels in full mip chain.
+	/// @param _format
+	/// @param _flags
+	/// @param _baseMip Finest mip level uploaded on creation. Mip levels
+	///   from this level are always resident.
+	/// @param _mem Mip levels from _baseMip to _numMips-1.
+	///
+	/// NOTE:
+	///   Texture storage holds only resident mip levels. When finer mip
+	///   level is uploaded or finest level is dropped, storage is
+	///   reallocated and resident mip levels are copied on GPU. Renderers
+	///   which can't copy between textures (OpenGL without
+	///   GL_ARB_copy_image, OpenGL ES) don't report
+	///   BGFX_CAPS_TEXTURE_RESIDENCY, they allocate full mip chain and only
+	///   clamp sampling to resident mip levels.
+	///
+	///   Texture usage is recorded when texture is set with setTexture.
+	///   Every frame streaming manager decides which mip levels should be
+	///   resident within streaming budget (see setTextureStreamingBudget).
+	///   Finer mip levels are requested with getTextureStreamingRequests,
+	///   and finest levels of idle textures are dropped automatically.
+	///
+	TextureHandle createTexture2DStreaming(uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags, uint8_t _baseMip, const Memory* _mem);
+
+	/// Upload requested mip level of streaming texture.
+	///
+	/// @param _handle Streaming texture handle.
+	/// @param _mip Mip level, it must be one level finer than currently
+	///   finest resident mip level. Stale uploads are ignored.
+	/// @param _mem Mip level data.
+	///
+	/// NOTE:
+	///   Uploaded mip level is used for sampling from next frame.
+	///
+	void updateTexture2DStreaming(TextureHandle _handle, uint8_t _mip, const Memory* _mem);
+
+	/// Set byte budget for resident mip levels of all streaming textures.
+	/// Budget bounds texture memory only when BGFX_CAPS_TEXTURE_RESIDENCY
+	/// is supported.
+	void setTextureStreamingBudget(uint32_t _budget);
+
+	/// Returns mip levels requested by streaming manager in last frame.
+	///
+	/// @param _requests Output array.
+	/// @param _max Size of output array.
+	/// @returns Number of requests written.
+	///
+	uint16_t getTextureStreamingRequests(TextureStreamRequest* _requests, uint16_t _max);
+
+	/// Returns texture streaming statistics.
+	void getTextureStreamingStats(TextureStreamingStats& _stats);
+
 	/// Create render target.
 	RenderTargetHandle createRenderTarget(uint16_t _width, uint16_t _height, uint32_t _flags = BGFX_RENDER_TARGET_COLOR_RGBA8, uint32_t _textureFlags = BGFX_TEXTURE_U_CLAMP|BGFX_TEXTURE_V_CLAMP);
 
@@ -1014,9 +1421,14 @@ namespace bgfx
 	///
 	///   u_alphaRef float - alpha reference value for alpha test.
 	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	UniformHandle createUniform(const char* _name, UniformType::Enum _type, uint16_t _num = 1);
 
 	/// Destroy shader uniform parameter.
+	///
+	/// @remarks Can be called from any thread, see frame.
+	///
 	void destroyUniform(UniformHandle _handle);
 
 	/// Set view name.
@@ -1210,9 +1622,47 @@ namespace bgfx
 	/// Set vertex buffer for draw primitive.
 	void setVertexBuffer(const TransientVertexBuffer* _tvb, uint32_t _numVertices = UINT32_MAX);
 
-	/// Set instance data buffer for draw primitive.
+	/// Set additional vertex stream for draw primitive. Vertex buffer set
+	/// with setVertexBuffer is stream 0, and determines number of vertices.
+	/// Each stream provides attributes of its own vertex declaration, and
+	/// attributes are fetched from all streams with the same vertex index.
+	/// Streams must not provide the same attribute.
+	///
+	/// @param _stream Vertex stream, from 1 to BGFX_CONFIG_MAX_VERTEX_STREAMS-1.
+	///   Streams must be set in order, without gaps.
+	/// @param _handle Vertex buffer.
+	/// @param _startVertex First vertex in stream.
+	///
+	/// @remarks Depth only passes can bind position stream as stream 0
+	///   without other streams, and fetch only position data.
+	///
+	void setVertexStream(uint8_t _stream, VertexBufferHandle _handle, uint32_t _startVertex = 0);
+
+	/// Set additional vertex stream for draw primitive.
+	void setVertexStream(uint8_t _stream, DynamicVertexBufferHandle _handle);
+
+	/// Set additional vertex stream for draw primitive.
+	void setVertexStream(uint8_t _stream, const TransientVertexBuffer* _tvb);
+
+	/// Set instance data buffer for draw primitive. Instance data buffer is
+	/// instance data stream 0.
 	void setInstanceDataBuffer(const InstanceDataBuffer* _idb, uint16_t _num = UINT16_MAX);
 
+	/// Set additional instance data stream for draw primitive, for example
+	/// per instance material data next to per instance transform.
+	///
+	/// @param _stream Instance data stream, from 1 to
+	///   BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS-1. Streams must be set in
+	///   order, after setInstanceDataBuffer.
+	/// @param _idb Instance data buffer.
+	///
+	/// @remarks Instance data attributes are numbered consecutively over
+	///   streams, stream 1 attributes follow stream 0 attributes. Total
+	///   number of attributes is limited by BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT.
+	///   Number of instances is the smallest among streams.
+	///
+	void setInstanceDataStream(uint8_t _stream, const InstanceDataBuffer* _idb);
+
 	/// Set program for draw primitive.
 	void setProgram(ProgramHandle _handle);
 
@@ -1267,9 +1717,61 @@ namespace bgfx
 	///
 	uint32_t submitMask(uint32_t _viewMask, int32_t _depth = 0);
 
+	/// Submit array of draw calls for rendering into single view.
+	///
+	/// @param _id View id.
+	/// @param _arrays Draw calls.
+	/// @returns Number of draw calls.
+	///
+	/// @remarks
+	///   Uniforms set before this call are applied to every draw call,
+	///   other previously set draw state is discarded.
+	///
+	uint32_t submit(uint8_t _id, const SubmitArrays& _arrays);
+
 	/// Discard all previously set state for draw call.
 	void discard();
 
+	/// Create retained draw list.
+	DrawListHandle createDrawList();
+
+	/// Destroy draw list.
+	void destroyDrawList(DrawListHandle _handle);
+
+	/// Start recording draw calls into draw list. Until endDrawList is
+	/// called, draw calls are recorded into draw list instead of being
+	/// submitted into current frame, and view id passed to submit is
+	/// ignored. Recording replaces previous contents of draw list.
+	///
+	/// @remarks
+	///   Draw list must not reference transient buffers, or transforms and
+	///   scissors cached before beginDrawList. Recording is limited by space
+	///   left in current frame, and frame must not be called while recording.
+	///
+	///   Draw list stores buffer, program and texture handles, not
+	///   resources. Referenced resources, including dynamic buffers, must
+	///   not be destroyed until draw list is destroyed or recorded again,
+	///   otherwise draw list would replay resource which reused handle.
+	///   Debug build checks this when static buffers, programs and
+	///   textures are destroyed.
+	///
+	void beginDrawList(DrawListHandle _handle);
+
+	/// End recording of draw list.
+	void endDrawList();
+
+	/// Submit all draw calls recorded into draw list for rendering into
+	/// single view. Recorded sort keys, render states and uniforms are
+	/// copied into frame in bulk.
+	///
+	/// @param _id View id.
+	/// @param _handle Draw list handle.
+	/// @param _mtx Model matrix which replaces recorded transforms of all
+	///   draw calls in draw list. NULL uses recorded transforms.
+	/// @returns Number of draw calls.
+	///
+	uint32_t submit(uint8_t _id, DrawListHandle _handle, const void* _mtx = NULL);
+
 	/// Request screen shot.
 	///
 	/// @param _filePath Will be passed to CallbackI::screenShot callback.
@@ -11,16 +11,25 @@ project "geometryc"
 		BX_DIR .. "include",
 		BGFX_DIR .. "include",
 		BGFX_DIR .. "3rdparty/forsyth-too",
+		BGFX_DIR .. "examples/common",
 	}
 
 	files {
 		BGFX_DIR .. "3rdparty/forsyth-too/**.cpp",
 		BGFX_DIR .. "3rdparty/forsyth-too/**.h",
+		BGFX_DIR .. "src/meshopt.**",
+		BGFX_DIR .. "src/parallel.**",
 		BGFX_DIR .. "src/vertexdecl.**",
+		BGFX_DIR .. "examples/common/meshcodec.**",
 		BGFX_DIR .. "tools/geometryc/**.cpp",
 		BGFX_DIR .. "tools/geometryc/**.h",
 	}
 
+	configuration { "linux-*" }
+		links {
+			"pthread",
+		}
+
 	configuration { "osx" }
 		links {
 			"Cocoa.framework",
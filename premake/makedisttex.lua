@@ -9,6 +9,7 @@ project "makedisttex"
 
 	includedirs {
 		BX_DIR .. "include",
+		BGFX_DIR .. "include",
 		BGFX_DIR .. "3rdparty/edtaa3",
 		BGFX_DIR .. "3rdparty/stb_image",
 	}
@@ -16,5 +17,12 @@ project "makedisttex"
 	files {
 		BGFX_DIR .. "3rdparty/edtaa3/**.cpp",
 		BGFX_DIR .. "3rdparty/edtaa3/**.h",
+		BGFX_DIR .. "examples/common/font/distance_field.**",
+		BGFX_DIR .. "src/parallel.**",
 		BGFX_DIR .. "tools/makedisttex.cpp",
 	}
+
+	configuration { "linux-*" }
+		links {
+			"pthread",
+		}
@@ -0,0 +1,26 @@
+--
+-- Copyright 2010-2013 Branimir Karadzic. All rights reserved.
+-- License: http://www.opensource.org/licenses/BSD-2-Clause
+--
+
+project "packc"
+	uuid "5b0e9ac6-8d1e-11e3-9a3c-0800200c9a66"
+	kind "ConsoleApp"
+
+	includedirs {
+		BX_DIR .. "include",
+		BGFX_DIR .. "include",
+	}
+
+	files {
+		BGFX_DIR .. "examples/common/assetpack.*",
+		BGFX_DIR .. "tools/packc/**.cpp",
+		BGFX_DIR .. "tools/packc/**.h",
+	}
+
+	configuration { "osx" }
+		links {
+			"Cocoa.framework",
+		}
+
+	strip()
@@ -169,3 +169,4 @@ dofile "makedisttex.lua"
 dofile "shaderc.lua"
 dofile "texturec.lua"
 dofile "geometryc.lua"
+dofile "packc.lua"
@@ -14,9 +14,11 @@ namespace bgfx
 				BX_CHECK(NULL != s_ctx, "Library is not initialized yet."); \
 				BX_CHECK(BGFX_MAIN_THREAD_MAGIC == s_threadIndex, "Must be called from main thread.")
 #	define BGFX_CHECK_RENDER_THREAD() BX_CHECK(BGFX_MAIN_THREAD_MAGIC != s_threadIndex, "Must be called from render thread.")
+#	define BGFX_CHECK_RESOURCE_THREAD() BX_CHECK(NULL != s_ctx, "Library is not initialized yet.")
 #else
 #	define BGFX_CHECK_MAIN_THREAD()
 #	define BGFX_CHECK_RENDER_THREAD()
+#	define BGFX_CHECK_RESOURCE_THREAD()
 #endif // BGFX_CONFIG_MULTITHREADED && !BX_PLATFORM_OSX && !BX_PLATFORM_IOS
 
 #if BX_PLATFORM_ANDROID
@@ -203,11 +205,15 @@ namespace bgfx
 	static bool s_graphicsDebuggerPresent = false;
 
 	CallbackI* g_callback = NULL;
+
+	static char s_programCacheFilePath[512];
+	const char* g_programCacheFilePath = NULL;
 	bx::ReallocatorI* g_allocator = NULL;
 
 	Caps g_caps;
 
 	static BX_THREAD uint32_t s_threadIndex = 0;
+	static BX_THREAD uint32_t s_resourceThreadIndex = 0;
 	static Context* s_ctx = NULL;
 	static bool s_renderFrameCalled = false;
 
@@ -275,7 +281,9 @@ namespace bgfx
 		}
 	}
 
-	static const uint32_t numCharsPerBatch = 1024;
+	// Whole text grid is kept in vertex buffer, 4 vertices per cell, so it
+	// can be drawn with 16-bit indices without rebuilding unchanged rows.
+	static const uint32_t numCharsPerBatch = (UINT16_MAX+1)/4;
 	static const uint32_t numBatchVertices = numCharsPerBatch*4;
 	static const uint32_t numBatchIndices = numCharsPerBatch*6;
 
@@ -333,6 +341,11 @@ namespace bgfx
 
 		m_vb = s_ctx->createTransientVertexBuffer(numBatchVertices*m_decl.m_stride, &m_decl);
 		m_ib = s_ctx->createTransientIndexBuffer(numBatchIndices*2);
+
+		m_last = NULL;
+		m_lastSeq = 0;
+		m_ibValid = false;
+		m_vbDirty = false;
 	}
 
 	void TextVideoMemBlitter::shutdown()
@@ -345,7 +358,7 @@ namespace bgfx
 		s_ctx->destroyTransientIndexBuffer(m_ib);
 	}
 
-	void TextVideoMemBlitter::blit(const TextVideoMem& _mem)
+	void TextVideoMemBlitter::blit(TextVideoMem& _mem)
 	{
 		BGFX_CHECK_RENDER_THREAD();
 		struct Vertex
@@ -379,9 +392,6 @@ namespace bgfx
 			0xffeceeee,
 		};
 
-		uint32_t yy = 0;
-		uint32_t xx = 0;
-
 		const float texelWidth = 1.0f/2048.0f;
 		const float texelWidthHalf = texelWidth*0.5f;
 		const float texelHeight = 1.0f/24.0f;
@@ -396,64 +406,152 @@ namespace bgfx
 
 		setup();
 
-		for (;yy < _mem.m_height;)
+		if (!m_ibValid)
 		{
-			Vertex* vertex = (Vertex*)m_vb->data;
 			uint16_t* indices = (uint16_t*)m_ib->data;
-			uint32_t startVertex = 0;
-			uint32_t numIndices = 0;
+			for (uint32_t ii = 0; ii < numCharsPerBatch; ++ii)
+			{
+				const uint16_t startVertex = uint16_t(ii*4);
+				indices[0] = startVertex+0;
+				indices[1] = startVertex+1;
+				indices[2] = startVertex+2;
+				indices[3] = startVertex+2;
+				indices[4] = startVertex+3;
+				indices[5] = startVertex+0;
+				indices += 6;
+			}
+
+			updateIndexBuffer(numBatchIndices);
+			m_ibValid = true;
+		}
 
-			for (; yy < _mem.m_height && numIndices < numBatchIndices; ++yy)
+		const uint32_t numCells = _mem.m_width*_mem.m_height;
+		if (numCells > numCharsPerBatch)
+		{
+			// Grid doesn't fit into vertex buffer, stream non-empty cells
+			// in batches.
+			m_last = NULL;
+
+			uint32_t yy = 0;
+			uint32_t xx = 0;
+
+			for (;yy < _mem.m_height;)
 			{
-				xx = xx < _mem.m_width ? xx : 0;
-				const uint8_t* line = &_mem.m_mem[(yy*_mem.m_width+xx)*2];
+				Vertex* vertex = (Vertex*)m_vb->data;
+				uint32_t numVertices = 0;
 
-				for (; xx < _mem.m_width && numIndices < numBatchIndices; ++xx)
+				for (; yy < _mem.m_height && numVertices < numBatchVertices; ++yy)
 				{
-					uint8_t ch = line[0];
-					uint8_t attr = line[1];
+					xx = xx < _mem.m_width ? xx : 0;
+					const uint8_t* line = &_mem.m_mem[(yy*_mem.m_width+xx)*2];
 
-					if (0 != (ch|attr)
-					&& (' ' != ch || 0 != (attr&0xf0) ) )
+					for (; xx < _mem.m_width && numVertices < numBatchVertices; ++xx)
 					{
-						uint32_t fg = palette[attr&0xf];
-						uint32_t bg = palette[(attr>>4)&0xf];
+						uint8_t ch = line[0];
+						uint8_t attr = line[1];
 
-						Vertex vert[4] =
+						if (0 != (ch|attr)
+						&& (' ' != ch || 0 != (attr&0xf0) ) )
 						{
-							{ (xx  )*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, utop },
-							{ (xx+1)*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, utop },
-							{ (xx+1)*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, ubottom },
-							{ (xx  )*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, ubottom },
-						};
-
-						memcpy(vertex, vert, sizeof(vert) );
-						vertex += 4;
-
-						indices[0] = startVertex+0;
-						indices[1] = startVertex+1;
-						indices[2] = startVertex+2;
-						indices[3] = startVertex+2;
-						indices[4] = startVertex+3;
-						indices[5] = startVertex+0;
-
-						startVertex += 4;
-						indices += 6;
-
-						numIndices += 6;
+							uint32_t fg = palette[attr&0xf];
+							uint32_t bg = palette[(attr>>4)&0xf];
+
+							Vertex vert[4] =
+							{
+								{ (xx  )*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, utop },
+								{ (xx+1)*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, utop },
+								{ (xx+1)*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, ubottom },
+								{ (xx  )*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, ubottom },
+							};
+
+							memcpy(vertex, vert, sizeof(vert) );
+							vertex += 4;
+							numVertices += 4;
+						}
+
+						line += 2;
 					}
 
-					line += 2;
+					if (numVertices >= numBatchVertices)
+					{
+						break;
+					}
 				}
 
-				if (numIndices >= numBatchIndices)
+				updateVertexBuffer(0, numVertices);
+				render(numVertices/4*6);
+			}
+
+			_mem.resetDirty();
+			return;
+		}
+
+		// Dirty rows are tracked against previous blit of same text memory,
+		// or against text memory of previous frame that _mem continues.
+		const bool continues = NULL != m_last
+			&& ( (&_mem == m_last && _mem.m_seq == m_lastSeq)
+			||   (_mem.m_prev == m_last && _mem.m_seq == m_lastSeq+1) )
+			;
+
+		uint32_t firstDirty = UINT32_MAX;
+		const uint32_t rowVertices = _mem.m_width*4;
+
+		for (uint32_t yy = 0; yy <= _mem.m_height; ++yy)
+		{
+			if (yy == _mem.m_height
+			|| (continues && !_mem.isDirty(uint16_t(yy) ) ) )
+			{
+				if (UINT32_MAX != firstDirty)
 				{
-					break;
+					updateVertexBuffer(firstDirty*rowVertices, (yy-firstDirty)*rowVertices);
+					firstDirty = UINT32_MAX;
 				}
+
+				continue;
 			}
 
-			render(numIndices);
+			firstDirty = UINT32_MAX == firstDirty ? yy : firstDirty;
+
+			Vertex* vertex = &( (Vertex*)m_vb->data)[yy*rowVertices];
+			const uint8_t* line = &_mem.m_mem[yy*_mem.m_width*2];
+
+			for (uint32_t xx = 0; xx < _mem.m_width; ++xx)
+			{
+				uint8_t ch = line[0];
+				uint8_t attr = line[1];
+
+				if (0 != (ch|attr)
+				&& (' ' != ch || 0 != (attr&0xf0) ) )
+				{
+					uint32_t fg = palette[attr&0xf];
+					uint32_t bg = palette[(attr>>4)&0xf];
+
+					Vertex vert[4] =
+					{
+						{ (xx  )*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, utop },
+						{ (xx+1)*8.0f, (yy  )*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, utop },
+						{ (xx+1)*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch+1)*8.0f*texelWidth - texelWidthHalf, ubottom },
+						{ (xx  )*8.0f, (yy+1)*fontHeight, 0.0f, fg, bg, (ch  )*8.0f*texelWidth - texelWidthHalf, ubottom },
+					};
+
+					memcpy(vertex, vert, sizeof(vert) );
+				}
+				else
+				{
+					// Empty cell is degenerate quad, it's not rasterized.
+					memset(vertex, 0, 4*sizeof(Vertex) );
+				}
+
+				vertex += 4;
+				line += 2;
+			}
 		}
+
+		_mem.resetDirty();
+		m_last = &_mem;
+		m_lastSeq = _mem.m_seq;
+
+		render(numCells*6);
 	}
 
 	void ClearQuad::init()
@@ -495,7 +593,7 @@ namespace bgfx
 		indices[3] = 2;
 		indices[4] = 3;
 		indices[5] = 0;
-		m_ib = s_ctx->createIndexBuffer(mem);
+		m_ib = s_ctx->createIndexBuffer(mem, BGFX_BUFFER_NONE);
 #endif // BGFX_CONFIG_CLEAR_QUAD
 	}
 
@@ -627,6 +725,396 @@ namespace bgfx
 		return m_num;
 	}
 
+	/// Encode 4 sort keys, same as SortKey::encode, with 64-bit keys built
+	/// from low and high 32-bit halves.
+	static void encodeSortKeys4(uint64_t* _keys, const int32_t* _depth, const uint32_t* _program, const uint32_t* _trans, uint16_t _seq, uint16_t _seqMask, uint8_t _view)
+	{
+#if BX_CPU_ENDIAN_LITTLE
+		using namespace bx;
+
+		const float4_t depth   = float4_ild(_depth[0], _depth[1], _depth[2], _depth[3]);
+		const float4_t program = float4_ild(_program[0], _program[1], _program[2], _program[3]);
+		const float4_t trans   = float4_ild(_trans[0], _trans[1], _trans[2], _trans[3]);
+		const float4_t seq     = float4_and(float4_iadd(float4_isplat(_seq), float4_ild(0, 1, 2, 3) ), float4_isplat(_seqMask) );
+		const float4_t view    = float4_isplat(uint32_t(_view)<<(SORT_KEY_VIEW_SHIFT-32) );
+
+		// Depth is sign extended into high half.
+		const float4_t lo = float4_or(depth, float4_sll(program, 0x18) );
+		const float4_t hi = float4_or(float4_or(float4_sra(depth, 31), float4_srl(program, 32-0x18) )
+			, float4_or(float4_or(float4_sll(trans, 0x21-32), float4_sll(seq, SORT_KEY_SEQ_SHIFT-32) ), view)
+			);
+
+		float4_stu(&_keys[0], float4_shuf_xAyB(lo, hi) );
+		float4_stu(&_keys[2], float4_shuf_zCwD(lo, hi) );
+#else
+		SortKey key;
+		key.m_view = _view;
+		for (uint32_t ii = 0; ii < 4; ++ii)
+		{
+			key.m_depth = _depth[ii];
+			key.m_program = uint16_t(_program[ii]);
+			key.m_trans = uint8_t(_trans[ii]);
+			key.m_seq = uint16_t(_seq+ii) & _seqMask;
+			_keys[ii] = key.encode();
+		}
+#endif // BX_CPU_ENDIAN_LITTLE
+	}
+
+	uint32_t Frame::submit(uint8_t _id, const SubmitArrays& _arrays)
+	{
+		uint32_t num = bx::uint32_min(_arrays.num, BGFX_CONFIG_MAX_DRAW_CALLS-1 - m_num);
+		if (NULL != _arrays.mtx)
+		{
+			num = bx::uint32_min(num, BGFX_CONFIG_MAX_MATRIX_CACHE-1 - m_matrixCache.m_num);
+		}
+		m_numDropped += _arrays.num - num;
+
+		const uint32_t matrixBase = m_matrixCache.add(_arrays.mtx, uint16_t(num) );
+
+		// Uniforms set before submit, and sampler stages, are shared by all
+		// draw calls and copied into constant range of each draw call.
+		uint64_t flags = BGFX_STATE_NONE;
+		for (uint32_t stage = 0; stage < _arrays.numSamplers; ++stage)
+		{
+			flags |= BGFX_STATE_TEX0<<stage;
+
+			if (isValid(_arrays.sampler[stage]) )
+			{
+				setUniform(_arrays.sampler[stage], &stage);
+			}
+		}
+
+		const uint32_t constBegin = m_state.m_constBegin;
+		const uint32_t constSize = m_constantBuffer->getPos() - constBegin;
+
+		RenderState state;
+		state.m_constEnd = constBegin;
+		state.clear();
+		state.m_numStreams = 1;
+
+		for (uint32_t stage = 0; stage < _arrays.numSamplers; ++stage)
+		{
+			state.m_sampler[stage].m_flags = BGFX_SAMPLER_TEXTURE|BGFX_SAMPLER_DEFAULT_FLAGS;
+		}
+
+		int32_t  keyDepth[4];
+		uint32_t keyProgram[4];
+		uint32_t keyTrans[4];
+		uint32_t numKeys = 0;
+
+		const uint16_t seqMask = s_ctx->m_seqMask[_id];
+		uint16_t seq = s_ctx->m_seq[_id];
+
+		for (uint32_t ii = 0; ii < num; ++ii)
+		{
+			const uint32_t numIndices  = NULL != _arrays.numIndices  ? _arrays.numIndices[ii]  : UINT32_MAX;
+			const uint32_t numVertices = NULL != _arrays.numVertices ? _arrays.numVertices[ii] : UINT32_MAX;
+			const ProgramHandle program = _arrays.program[ii];
+
+			if (!isValid(program)
+			|| (0 == numVertices && 0 == numIndices) )
+			{
+				BX_WARN(isValid(program), "Program with invalid handle");
+				++m_numDropped;
+				continue;
+			}
+
+			if (0 != ii)
+			{
+				state.m_constBegin = m_constantBuffer->getPos();
+				m_constantBuffer->write(m_constantBuffer->getData(constBegin), constSize);
+			}
+			state.m_constEnd = m_constantBuffer->getPos();
+
+			const uint64_t flagsState = NULL != _arrays.state ? _arrays.state[ii] : BGFX_STATE_DEFAULT;
+			state.m_flags = flagsState | flags;
+			state.m_matrix = NULL != _arrays.mtx ? matrixBase + ii : 0;
+			state.m_numVertices = numVertices;
+			state.m_stream[0].m_handle = _arrays.vertexBuffer[ii];
+
+			if (NULL != _arrays.indexBuffer)
+			{
+				state.m_indexBuffer = _arrays.indexBuffer[ii];
+				state.m_startIndex = NULL != _arrays.startIndex ? _arrays.startIndex[ii] : 0;
+				state.m_numIndices = numIndices;
+			}
+
+			const TextureHandle* texture = &_arrays.texture[ii*_arrays.numSamplers];
+			for (uint32_t stage = 0; stage < _arrays.numSamplers; ++stage)
+			{
+				state.m_sampler[stage].m_idx = texture[stage].idx;
+			}
+
+			m_renderState[m_numRenderStates] = state;
+
+			keyDepth[numKeys]   = NULL != _arrays.depth ? _arrays.depth[ii] : 0;
+			keyProgram[numKeys] = program.idx;
+			keyTrans[numKeys]   = getTrans(flagsState);
+			m_sortValues[m_num+numKeys] = m_numRenderStates;
+			++m_numRenderStates;
+			++numKeys;
+
+			if (4 == numKeys)
+			{
+				encodeSortKeys4(&m_sortKeys[m_num], keyDepth, keyProgram, keyTrans, seq, seqMask, _id);
+				m_num += 4;
+				seq += 4;
+				numKeys = 0;
+			}
+		}
+
+		for (uint32_t ii = 0; ii < numKeys; ++ii)
+		{
+			SortKey key;
+			key.m_depth = keyDepth[ii];
+			key.m_program = uint16_t(keyProgram[ii]);
+			key.m_trans = uint8_t(keyTrans[ii]);
+			key.m_seq = seq & seqMask;
+			key.m_view = _id;
+			m_sortKeys[m_num] = key.encode();
+			++m_num;
+			++seq;
+		}
+
+		s_ctx->m_seq[_id] = seq;
+
+		m_state.m_constEnd = m_constantBuffer->getPos();
+		discard();
+
+		return m_num;
+	}
+
+	uint32_t Frame::submit(uint8_t _id, const DrawList& _list, const void* _mtx)
+	{
+		// Uniforms set after last submit would otherwise be picked up by
+		// next draw call together with draw list constants.
+		BX_WARN(m_constantBuffer->getPos() == m_state.m_constEnd, "Uniforms set before submitting draw list are discarded.");
+		m_constantBuffer->reset(m_state.m_constEnd);
+
+		if (0 == _list.m_numKeys)
+		{
+			return m_num;
+		}
+
+		const uint32_t numMatrices = NULL != _mtx ? 1 : _list.m_numMatrices;
+
+		// Draw list is submitted whole or dropped, nothing is copied unless
+		// all frame caches can fit it.
+		if (BGFX_CONFIG_MAX_DRAW_CALLS-1 < m_num + _list.m_numKeys
+		||  BGFX_CONFIG_MAX_MATRIX_CACHE <= m_matrixCache.m_num + numMatrices
+		||  BGFX_CONFIG_MAX_RECT_CACHE   <= m_rectCache.m_num + _list.m_numRects)
+		{
+			m_numDropped += _list.m_numKeys;
+			return m_num;
+		}
+
+		const uint32_t constBase = m_constantBuffer->getPos();
+		m_constantBuffer->write(_list.m_constants, _list.m_constantSize);
+		if (m_constantBuffer->getPos() != constBase + _list.m_constantSize)
+		{
+			m_numDropped += _list.m_numKeys;
+			return m_num;
+		}
+
+		const uint32_t matrixBase = NULL != _mtx
+			? m_matrixCache.add(_mtx, 1)
+			: m_matrixCache.add(_list.m_matrices, uint16_t(numMatrices) )
+			;
+
+		uint32_t rectBase = m_rectCache.m_num;
+		for (uint32_t ii = 0; ii < _list.m_numRects; ++ii)
+		{
+			const Rect& rect = _list.m_rects[ii];
+			m_rectCache.add(rect.m_x, rect.m_y, rect.m_width, rect.m_height);
+		}
+
+		RenderState* renderState = &m_renderState[m_numRenderStates];
+		memcpy(renderState, _list.m_renderState, _list.m_numRenderStates*sizeof(RenderState) );
+
+		for (uint32_t ii = 0; ii < _list.m_numRenderStates; ++ii)
+		{
+			RenderState& state = renderState[ii];
+			state.m_constBegin += constBase;
+			state.m_constEnd += constBase;
+
+			if (NULL != _mtx)
+			{
+				state.m_matrix = matrixBase;
+				state.m_num = 1;
+			}
+			else if (0 != state.m_matrix)
+			{
+				state.m_matrix += matrixBase - 1;
+			}
+
+			if (UINT16_MAX != state.m_scissor)
+			{
+				state.m_scissor = uint16_t(state.m_scissor + rectBase);
+			}
+		}
+
+		const uint16_t seqMask = s_ctx->m_seqMask[_id];
+		uint16_t seq = s_ctx->m_seq[_id];
+		for (uint32_t ii = 0; ii < _list.m_numKeys; ++ii, ++seq)
+		{
+			m_sortKeys[m_num+ii] = SortKey::addViewSeq(_list.m_keys[ii], _id, seq & seqMask);
+			m_sortValues[m_num+ii] = uint16_t(m_numRenderStates + _list.m_values[ii]);
+		}
+		s_ctx->m_seq[_id] = seq;
+
+		m_num = uint16_t(m_num + _list.m_numKeys);
+		m_numRenderStates = uint16_t(m_numRenderStates + _list.m_numRenderStates);
+
+		m_state.m_constEnd = m_constantBuffer->getPos();
+		m_state.m_constBegin = m_state.m_constEnd;
+
+		return m_num;
+	}
+
+	void Frame::beginDrawList(DrawList& _list)
+	{
+		// Pending state and uniforms don't belong to draw list.
+		discard();
+		m_constantBuffer->reset(m_state.m_constEnd);
+
+		_list.m_beginNum = m_num;
+		_list.m_beginRenderState = m_numRenderStates;
+		_list.m_beginMatrix = m_matrixCache.m_num;
+		_list.m_beginRect = m_rectCache.m_num;
+		_list.m_beginConstant = m_state.m_constEnd;
+	}
+
+	void Frame::endDrawList(DrawList& _list)
+	{
+		discard();
+
+		_list.destroy();
+
+		_list.m_numKeys = m_num - _list.m_beginNum;
+		_list.m_numRenderStates = m_numRenderStates - _list.m_beginRenderState;
+		_list.m_numMatrices = m_matrixCache.m_num - _list.m_beginMatrix;
+		_list.m_numRects = m_rectCache.m_num - _list.m_beginRect;
+		_list.m_constantSize = m_state.m_constEnd - _list.m_beginConstant;
+
+		if (0 < _list.m_numKeys)
+		{
+			_list.m_keys = (uint64_t*)BX_ALLOC(g_allocator, _list.m_numKeys*sizeof(uint64_t) );
+			_list.m_values = (uint16_t*)BX_ALLOC(g_allocator, _list.m_numKeys*sizeof(uint16_t) );
+
+			for (uint32_t ii = 0; ii < _list.m_numKeys; ++ii)
+			{
+				_list.m_keys[ii] = SortKey::removeViewSeq(m_sortKeys[_list.m_beginNum+ii]);
+				_list.m_values[ii] = uint16_t(m_sortValues[_list.m_beginNum+ii] - _list.m_beginRenderState);
+			}
+
+			_list.m_renderState = (RenderState*)BX_ALLOC(g_allocator, _list.m_numRenderStates*sizeof(RenderState) );
+			memcpy(_list.m_renderState, &m_renderState[_list.m_beginRenderState], _list.m_numRenderStates*sizeof(RenderState) );
+
+			uint8_t used[BGFX_CONFIG_MAX_TEXTURES/8];
+			memset(used, 0, sizeof(used) );
+			TextureHandle textures[BGFX_CONFIG_MAX_TEXTURES];
+			uint32_t numTextures = 0;
+			uint32_t numTransient = 0;
+
+			for (uint32_t ii = 0; ii < _list.m_numRenderStates; ++ii)
+			{
+				RenderState& state = _list.m_renderState[ii];
+				state.m_constBegin -= _list.m_beginConstant;
+				state.m_constEnd -= _list.m_beginConstant;
+
+				if (_list.m_beginMatrix <= state.m_matrix)
+				{
+					state.m_matrix = state.m_matrix - _list.m_beginMatrix + 1;
+				}
+				else
+				{
+					BX_WARN(0 == state.m_matrix, "Draw list can't reference matrix cached before beginDrawList.");
+					state.m_matrix = 0;
+				}
+
+				if (UINT16_MAX != state.m_scissor)
+				{
+					BX_WARN(_list.m_beginRect <= state.m_scissor, "Draw list can't reference scissor cached before beginDrawList.");
+					state.m_scissor = _list.m_beginRect <= state.m_scissor
+						? uint16_t(state.m_scissor - _list.m_beginRect)
+						: UINT16_MAX
+						;
+				}
+
+				for (uint32_t stream = 0; stream < state.m_numStreams; ++stream)
+				{
+					numTransient += state.m_stream[stream].m_handle.idx == m_transientVb->handle.idx;
+				}
+
+				for (uint32_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+				{
+					numTransient += state.m_instanceData[stream].m_handle.idx == m_transientVb->handle.idx;
+				}
+
+				numTransient += 0
+					+ (state.m_indexBuffer.idx == m_transientIb->handle.idx)
+					+ (state.m_indexBuffer.idx == m_transientIb32->handle.idx)
+					;
+
+				for (uint32_t stage = 0; stage < BGFX_STATE_TEX_COUNT; ++stage)
+				{
+					const Sampler& sampler = state.m_sampler[stage];
+					if (invalidHandle != sampler.m_idx
+					&&  BGFX_SAMPLER_TEXTURE == (sampler.m_flags&BGFX_SAMPLER_TYPE_MASK)
+					&&  0 == (used[sampler.m_idx>>3] & (1<<(sampler.m_idx&7) ) ) )
+					{
+						used[sampler.m_idx>>3] |= 1<<(sampler.m_idx&7);
+						textures[numTextures].idx = sampler.m_idx;
+						++numTextures;
+					}
+				}
+			}
+
+			BX_WARN(0 == numTransient, "Draw list references transient buffers, which are valid only in current frame.");
+
+			if (0 < numTextures)
+			{
+				_list.m_numTextures = numTextures;
+				_list.m_textures = (TextureHandle*)BX_ALLOC(g_allocator, numTextures*sizeof(TextureHandle) );
+				memcpy(_list.m_textures, textures, numTextures*sizeof(TextureHandle) );
+			}
+
+			if (0 < _list.m_numMatrices)
+			{
+				_list.m_matrices = (float*)BX_ALLOC(g_allocator, _list.m_numMatrices*sizeof(Matrix4) );
+				memcpy(_list.m_matrices, &m_matrixCache.m_cache[_list.m_beginMatrix], _list.m_numMatrices*sizeof(Matrix4) );
+			}
+
+			if (0 < _list.m_numRects)
+			{
+				_list.m_rects = (Rect*)BX_ALLOC(g_allocator, _list.m_numRects*sizeof(Rect) );
+				memcpy(_list.m_rects, &m_rectCache.m_cache[_list.m_beginRect], _list.m_numRects*sizeof(Rect) );
+			}
+
+			if (0 < _list.m_constantSize)
+			{
+				_list.m_constants = (char*)BX_ALLOC(g_allocator, _list.m_constantSize);
+				memcpy(_list.m_constants, m_constantBuffer->getData(_list.m_beginConstant), _list.m_constantSize);
+			}
+		}
+		else
+		{
+			_list.m_numRenderStates = 0;
+			_list.m_numMatrices = 0;
+			_list.m_numRects = 0;
+			_list.m_constantSize = 0;
+		}
+
+		// Recorded draw calls are not part of current frame.
+		m_num = uint16_t(_list.m_beginNum);
+		m_numRenderStates = uint16_t(_list.m_beginRenderState);
+		m_matrixCache.m_num = _list.m_beginMatrix;
+		m_rectCache.m_num = _list.m_beginRect;
+		m_constantBuffer->reset(_list.m_beginConstant);
+		m_state.m_constEnd = _list.m_beginConstant;
+		m_state.clear();
+	}
+
 	void Frame::sort()
 	{
 		bx::radixSort64(m_sortKeys, s_ctx->m_tempKeys, m_sortValues, s_ctx->m_tempValues, m_num);
@@ -694,6 +1182,8 @@ namespace bgfx
 		CAPS_FLAGS(BGFX_CAPS_INSTANCING),
 		CAPS_FLAGS(BGFX_CAPS_RENDERER_MULTITHREADED),
 		CAPS_FLAGS(BGFX_CAPS_FRAGMENT_DEPTH),
+		CAPS_FLAGS(BGFX_CAPS_INDEX32),
+		CAPS_FLAGS(BGFX_CAPS_TEXTURE_RESIDENCY),
 #undef CAPS_FLAGS
 	};
 
@@ -903,6 +1393,7 @@ namespace bgfx
 		memset(m_scissor, 0, sizeof(m_scissor) );
 		memset(m_seq, 0, sizeof(m_seq) );
 		memset(m_seqMask, 0, sizeof(m_seqMask) );
+		m_drawListRecord.idx = invalidHandle;
 
 		for (uint32_t ii = 0; ii < BX_COUNTOF(m_rect); ++ii)
 		{
@@ -911,6 +1402,13 @@ namespace bgfx
 		}
 
 		m_declRef.init();
+		m_textureStreaming.init();
+
+		m_numResourceThreads = 0;
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_threadCmd); ++ii)
+		{
+			m_threadCmd[ii].reset();
+		}
 
 		frameNoRenderWait();
 
@@ -921,9 +1419,11 @@ namespace bgfx
 
 		m_submit->m_transientVb = createTransientVertexBuffer(BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE);
 		m_submit->m_transientIb = createTransientIndexBuffer(BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
+		m_submit->m_transientIb32 = createTransientIndexBuffer(BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE, BGFX_BUFFER_INDEX32);
 		frame();
 		m_submit->m_transientVb = createTransientVertexBuffer(BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE);
 		m_submit->m_transientIb = createTransientIndexBuffer(BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
+		m_submit->m_transientIb32 = createTransientIndexBuffer(BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE, BGFX_BUFFER_INDEX32);
 		frame();
 
 		for (uint8_t ii = 0; ii < BGFX_CONFIG_MAX_VIEWS; ++ii)
@@ -943,12 +1443,14 @@ namespace bgfx
 
 		destroyTransientVertexBuffer(m_submit->m_transientVb);
 		destroyTransientIndexBuffer(m_submit->m_transientIb);
+		destroyTransientIndexBuffer(m_submit->m_transientIb32);
 		m_textVideoMemBlitter.shutdown();
 		m_clearQuad.shutdown();
 		frame();
 
 		destroyTransientVertexBuffer(m_submit->m_transientVb);
 		destroyTransientIndexBuffer(m_submit->m_transientIb);
+		destroyTransientIndexBuffer(m_submit->m_transientIb32);
 		frame();
 
 		frame(); // If any VertexDecls needs to be destroyed.
@@ -992,6 +1494,7 @@ namespace bgfx
 		CHECK_HANDLE_LEAK(m_textureHandle);
 		CHECK_HANDLE_LEAK(m_renderTargetHandle);
 		CHECK_HANDLE_LEAK(m_uniformHandle);
+		CHECK_HANDLE_LEAK(m_drawListHandle);
 
 #	undef CHECK_HANDLE_LEAK
 #endif // BGFX_CONFIG_DEBUG
@@ -1060,8 +1563,106 @@ namespace bgfx
 		}
 	}
 
+	uint32_t TextureStreaming::getSize(const Texture& _texture, uint8_t _mip) const
+	{
+		const TextureFormat::Enum format = TextureFormat::Enum(_texture.m_format);
+		const uint32_t bpp = getBitsPerPixel(format);
+		const bool compressed = isCompressed(format);
+
+		uint32_t size = 0;
+		for (uint32_t lod = _mip, num = _texture.m_numMips; lod < num; ++lod)
+		{
+			uint32_t width  = bx::uint32_max(1, _texture.m_width >>lod);
+			uint32_t height = bx::uint32_max(1, _texture.m_height>>lod);
+
+			if (compressed)
+			{
+				width  = bx::uint32_max(1, (width +3)>>2)*4;
+				height = bx::uint32_max(1, (height+3)>>2)*4;
+			}
+
+			size += width*height*bpp/8;
+		}
+
+		return size;
+	}
+
+	void Context::streamTextures()
+	{
+		TextureStreaming& ts = m_textureStreaming;
+		ts.m_numRequests = 0;
+		ts.m_resident = 0;
+		ts.m_requested = 0;
+
+		if (0 == ts.m_num)
+		{
+			return;
+		}
+
+		// Mip levels from base mip are always resident, and they're taken from
+		// budget first. Remaining budget is distributed by recency of use, each
+		// texture gets finer mip levels until it reaches wanted mip level or
+		// budget runs out.
+		uint32_t base = 0;
+		for (uint16_t ii = 0, num = ts.m_num; ii < num; ++ii)
+		{
+			TextureHandle handle = ts.m_list[ii];
+			const TextureStreaming::Texture& texture = ts.m_texture[handle.idx];
+			base += ts.getSize(texture, texture.m_baseMip);
+
+			ts.m_keys[ii] = m_frames - ts.m_lastUsed[handle.idx];
+			ts.m_values[ii] = handle.idx;
+		}
+
+		bx::radixSort32(ts.m_keys, ts.m_tempKeys, ts.m_values, ts.m_tempValues, ts.m_num);
+
+		uint32_t available = ts.m_budget > base ? ts.m_budget - base : 0;
+
+		for (uint16_t ii = 0, num = ts.m_num; ii < num; ++ii)
+		{
+			TextureHandle handle = { ts.m_values[ii] };
+			TextureStreaming::Texture& texture = ts.m_texture[handle.idx];
+
+			// Drop one mip level for every idle period texture wasn't used.
+			const uint32_t idle = ts.m_keys[ii] / BGFX_CONFIG_TEXTURE_STREAMING_IDLE_FRAMES;
+			const uint8_t wanted = uint8_t(bx::uint32_min(texture.m_baseMip, idle) );
+			ts.m_requested += ts.getSize(texture, wanted);
+
+			uint8_t target = texture.m_baseMip;
+			uint32_t size = ts.getSize(texture, target);
+			while (target > wanted)
+			{
+				const uint32_t finer = ts.getSize(texture, target-1);
+				if (finer - size > available)
+				{
+					break;
+				}
+
+				available -= finer - size;
+				size = finer;
+				--target;
+			}
+
+			if (target > texture.m_lod)
+			{
+				texture.m_lod = target;
+				updateTextureResidency(handle, target);
+			}
+			else if (target < texture.m_lod)
+			{
+				TextureStreamRequest& request = ts.m_request[ts.m_numRequests++];
+				request.handle = handle;
+				request.mip = texture.m_lod-1;
+			}
+
+			ts.m_resident += ts.getSize(texture, texture.m_lod);
+		}
+	}
+
 	uint32_t Context::frame()
 	{
+		BX_CHECK(!isValid(m_drawListRecord), "frame called while recording draw list %d.", m_drawListRecord.idx);
+
 		// wait for render thread to finish
 		renderSemWait();
 		frameNoRenderWait();
@@ -1081,9 +1682,70 @@ namespace bgfx
 #endif // BGFX_CONFIG_MULTITHREADED
 	}
 
+	ThreadCommandBuffer* Context::getThreadCommandBuffer()
+	{
+		if (BGFX_MAIN_THREAD_MAGIC == s_threadIndex)
+		{
+			return NULL;
+		}
+
+		if (0 == s_resourceThreadIndex)
+		{
+			s_resourceThreadIndex = uint32_t(bx::atomicInc(&m_numResourceThreads) );
+		}
+
+		return &m_threadCmd[(s_resourceThreadIndex-1) % BGFX_CONFIG_MAX_RESOURCE_THREADS];
+	}
+
+	void Context::spliceThreadCommandBuffers()
+	{
+		// Commands of other threads are executed before those of API
+		// thread, so that API thread can use resources created on other
+		// threads in the same frame (for example program referencing uniform
+		// created on worker). Renderer init must stay first.
+		CommandBuffer& cmdPre = m_submit->m_cmdPre;
+		uint32_t pos = 0 < cmdPre.m_pos && CommandBuffer::RendererInit == cmdPre.m_buffer[0] ? 1 : 0;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_threadCmd); ++ii)
+		{
+			ThreadCommandBuffer& tcb = m_threadCmd[ii];
+			bx::LwMutexScope scope(tcb.m_mutex);
+
+			cmdPre.insert(pos, tcb.m_cmdPre);
+			pos += tcb.m_cmdPre.m_pos;
+
+			m_submit->m_cmdPost.append(tcb.m_cmdPost);
+
+			for (uint16_t jj = 0, num = tcb.m_numFreeIndexBufferHandles; jj < num; ++jj)
+			{
+				m_submit->free(tcb.m_freeIndexBufferHandle[jj]);
+			}
+
+			for (uint16_t jj = 0, num = tcb.m_numFreeVertexBufferHandles; jj < num; ++jj)
+			{
+				m_submit->free(tcb.m_freeVertexBufferHandle[jj]);
+			}
+
+			for (uint16_t jj = 0, num = tcb.m_numFreeTextureHandles; jj < num; ++jj)
+			{
+				m_textureStreaming.destroy(tcb.m_freeTextureHandle[jj]);
+				m_submit->free(tcb.m_freeTextureHandle[jj]);
+			}
+
+			for (uint16_t jj = 0, num = tcb.m_numFreeUniformHandles; jj < num; ++jj)
+			{
+				m_submit->free(tcb.m_freeUniformHandle[jj]);
+			}
+
+			tcb.reset();
+		}
+	}
+
 	void Context::swap()
 	{
+		spliceThreadCommandBuffers();
 		freeDynamicBuffers();
+		streamTextures();
 		m_submit->m_resolution = m_resolution;
 		m_submit->m_debug = m_debug;
 		memcpy(m_submit->m_rt, m_rt, sizeof(m_rt) );
@@ -1094,6 +1756,7 @@ namespace bgfx
 		memcpy(m_submit->m_proj, m_proj, sizeof(m_proj) );
 		memcpy(m_submit->m_other, m_other, sizeof(m_other) );
 		m_submit->finish();
+		m_submit->m_textVideoMem->resolveDirty(*m_render->m_textVideoMem);
 
 		Frame* temp = m_render;
 		m_render = m_submit;
@@ -1106,6 +1769,7 @@ namespace bgfx
 		freeAllHandles(m_submit);
 
 		m_submit->resetFreeHandles();
+		m_submit->m_textVideoMem->copy(*m_render->m_textVideoMem);
 		m_submit->m_textVideoMem->resize(m_render->m_textVideoMem->m_small, m_resolution.m_width, m_resolution.m_height);
 	}
 
@@ -1265,7 +1929,10 @@ namespace bgfx
 					Memory* mem;
 					_cmdbuf.read(mem);
 
-					rendererCreateIndexBuffer(handle, mem);
+					uint8_t flags;
+					_cmdbuf.read(flags);
+
+					rendererCreateIndexBuffer(handle, mem, flags);
 
 					release(mem);
 				}
@@ -1335,7 +2002,10 @@ namespace bgfx
 					uint32_t size;
 					_cmdbuf.read(size);
 
-					rendererCreateDynamicIndexBuffer(handle, size);
+					uint8_t flags;
+					_cmdbuf.read(flags);
+
+					rendererCreateDynamicIndexBuffer(handle, size, flags);
 				}
 				break;
 
@@ -1546,6 +2216,21 @@ namespace bgfx
 				}
 				break;
 
+			case CommandBuffer::UpdateTextureResidency:
+				{
+					TextureHandle handle;
+					_cmdbuf.read(handle);
+
+					uint8_t lod;
+					_cmdbuf.read(lod);
+
+					// Pending updates target current texture storage.
+					flushTextureUpdateBatch(_cmdbuf);
+
+					rendererUpdateTextureResidency(handle, lod);
+				}
+				break;
+
 			case CommandBuffer::DestroyTexture:
 				{
 					TextureHandle handle;
@@ -1625,24 +2310,6 @@ namespace bgfx
 				}
 				break;
 
-			case CommandBuffer::UpdateViewName:
-				{
-					uint8_t id;
-					_cmdbuf.read(id);
-
-					uint16_t len;
-					_cmdbuf.read(len);
-
-					const char* name = (const char*)_cmdbuf.skip(len);
-
-					rendererUpdateViewName(id, name);
-				}
-				break;
-
-			case CommandBuffer::End:
-				end = true;
-				break;
-
 			default:
 				BX_CHECK(false, "WTF!");
 				break;
@@ -1660,18 +2327,48 @@ namespace bgfx
 		return mem;
 	}
 
+	struct MemoryRef
+	{
+		Memory mem;
+		ReleaseFn releaseFn;
+		void* userData;
+	};
+
 	const Memory* makeRef(const void* _data, uint32_t _size)
 	{
-		Memory* mem = (Memory*)BX_ALLOC(g_allocator, sizeof(Memory) );
-		mem->size = _size;
-		mem->data = (uint8_t*)_data;
-		return mem;
+		return makeRef(_data, _size, NULL, NULL);
+	}
+
+	const Memory* makeRef(const void* _data, uint32_t _size, ReleaseFn _releaseFn, void* _userData)
+	{
+		MemoryRef* memRef = (MemoryRef*)BX_ALLOC(g_allocator, sizeof(MemoryRef) );
+		memRef->mem.size = _size;
+		memRef->mem.data = (uint8_t*)_data;
+		memRef->releaseFn = _releaseFn;
+		memRef->userData = _userData;
+		return &memRef->mem;
+	}
+
+	static bool isMemoryRef(const Memory* _mem)
+	{
+		// Memory allocated with alloc always has data right after header.
+		return _mem->data != (uint8_t*)_mem + sizeof(Memory);
 	}
 
 	void release(const Memory* _mem)
 	{
 		BX_CHECK(NULL != _mem, "_mem can't be NULL");
-		BX_FREE(g_allocator, const_cast<Memory*>(_mem) );
+		Memory* mem = const_cast<Memory*>(_mem);
+		if (isMemoryRef(mem) )
+		{
+			MemoryRef* memRef = reinterpret_cast<MemoryRef*>(mem);
+			if (NULL != memRef->releaseFn)
+			{
+				memRef->releaseFn(mem->data, memRef->userData);
+			}
+		}
+
+		BX_FREE(g_allocator, mem);
 	}
 
 	void setDebug(uint32_t _debug)
@@ -1695,49 +2392,87 @@ namespace bgfx
 		va_end(argList);
 	}
 
-	IndexBufferHandle createIndexBuffer(const Memory* _mem)
+	/// Locks command sub-buffer of calling thread for duration of
+	/// thread-safe resource API call made outside of API thread.
+	class ResourceThreadScope
 	{
-		BGFX_CHECK_MAIN_THREAD();
-		return s_ctx->createIndexBuffer(_mem);
+	public:
+		ResourceThreadScope()
+			: m_tcb(s_ctx->getThreadCommandBuffer() )
+		{
+			if (NULL != m_tcb)
+			{
+				m_tcb->m_mutex.lock();
+			}
+		}
+
+		~ResourceThreadScope()
+		{
+			if (NULL != m_tcb)
+			{
+				m_tcb->m_mutex.unlock();
+			}
+		}
+
+	private:
+		ThreadCommandBuffer* m_tcb;
+	};
+
+	IndexBufferHandle createIndexBuffer(const Memory* _mem, uint8_t _flags)
+	{
+		BGFX_CHECK_RESOURCE_THREAD();
+		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		ResourceThreadScope resourceScope;
+		return s_ctx->createIndexBuffer(_mem, _flags);
 	}
 
 	void destroyIndexBuffer(IndexBufferHandle _handle)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
+		ResourceThreadScope resourceScope;
 		s_ctx->destroyIndexBuffer(_handle);
 	}
 
 	VertexBufferHandle createVertexBuffer(const Memory* _mem, const VertexDecl& _decl)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
 		BX_CHECK(0 != _decl.m_stride, "Invalid VertexDecl.");
+		ResourceThreadScope resourceScope;
 		return s_ctx->createVertexBuffer(_mem, _decl);
 	}
 
 	void destroyVertexBuffer(VertexBufferHandle _handle)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
+		ResourceThreadScope resourceScope;
 		s_ctx->destroyVertexBuffer(_handle);
 	}
 
-	DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num)
+	DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint8_t _flags)
 	{
 		BGFX_CHECK_MAIN_THREAD();
-		return s_ctx->createDynamicIndexBuffer(_num);
+		return s_ctx->createDynamicIndexBuffer(_num, _flags);
 	}
 
-	DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem)
+	DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem, uint8_t _flags)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(NULL != _mem, "_mem can't be NULL");
-		return s_ctx->createDynamicIndexBuffer(_mem);
+		return s_ctx->createDynamicIndexBuffer(_mem, _flags);
 	}
 
 	void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, const Memory* _mem)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(NULL != _mem, "_mem can't be NULL");
-		s_ctx->updateDynamicIndexBuffer(_handle, _mem);
+		s_ctx->updateDynamicIndexBuffer(_handle, 0, _mem);
+	}
+
+	void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const Memory* _mem)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		s_ctx->updateDynamicIndexBuffer(_handle, _startIndex, _mem);
 	}
 
 	void destroyDynamicIndexBuffer(DynamicIndexBufferHandle _handle)
@@ -1765,7 +2500,14 @@ namespace bgfx
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(NULL != _mem, "_mem can't be NULL");
-		s_ctx->updateDynamicVertexBuffer(_handle, _mem);
+		s_ctx->updateDynamicVertexBuffer(_handle, 0, _mem);
+	}
+
+	void updateDynamicVertexBuffer(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const Memory* _mem)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		s_ctx->updateDynamicVertexBuffer(_handle, _startVertex, _mem);
 	}
 
 	void destroyDynamicVertexBuffer(DynamicVertexBufferHandle _handle)
@@ -1774,11 +2516,11 @@ namespace bgfx
 		s_ctx->destroyDynamicVertexBuffer(_handle);
 	}
 
-	bool checkAvailTransientIndexBuffer(uint32_t _num)
+	bool checkAvailTransientIndexBuffer(uint32_t _num, uint8_t _flags)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(0 < _num, "Requesting 0 indices.");
-		return s_ctx->checkAvailTransientIndexBuffer(_num);
+		return s_ctx->checkAvailTransientIndexBuffer(_num, _flags);
 	}
 
 	bool checkAvailTransientVertexBuffer(uint32_t _num, const VertexDecl& _decl)
@@ -1789,27 +2531,29 @@ namespace bgfx
 		return s_ctx->checkAvailTransientVertexBuffer(_num, _decl.m_stride);
 	}
 
-	bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride)
+	bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride, uint16_t _numBuffers)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(0 < _num, "Requesting 0 instances.");
-		return s_ctx->checkAvailTransientVertexBuffer(_num, _stride);
+		BX_CHECK(0 < _numBuffers, "Requesting 0 instance data buffers.");
+		BX_CHECK(1 == _numBuffers || 0 == (_stride&0xf), "Sum of instance data strides %d is not multiple of 16.", _stride);
+		return s_ctx->checkAvailInstanceDataBuffer(_num, _stride, _numBuffers);
 	}
 
 	bool checkAvailTransientBuffers(uint32_t _numVertices, const VertexDecl& _decl, uint32_t _numIndices)
 	{
 		BX_CHECK(0 != _decl.m_stride, "Invalid VertexDecl.");
 		return checkAvailTransientVertexBuffer(_numVertices, _decl)
-			&& checkAvailTransientIndexBuffer(_numIndices)
+			&& checkAvailTransientIndexBuffer(_numIndices, BGFX_BUFFER_NONE)
 			;
 	}
 
-	void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num)
+	void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num, uint8_t _flags)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		BX_CHECK(NULL != _tib, "_tib can't be NULL");
 		BX_CHECK(0 < _num, "Requesting 0 indices.");
-		return s_ctx->allocTransientIndexBuffer(_tib, _num);
+		return s_ctx->allocTransientIndexBuffer(_tib, _num, _flags);
 	}
 
 	void allocTransientVertexBuffer(TransientVertexBuffer* _tvb, uint32_t _num, const VertexDecl& _decl)
@@ -1906,14 +2650,15 @@ namespace bgfx
 
 	TextureHandle createTexture(const Memory* _mem, uint32_t _flags, TextureInfo* _info)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
 		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		ResourceThreadScope resourceScope;
 		return s_ctx->createTexture(_mem, _flags, _info);
 	}
 
 	TextureHandle createTexture2D(uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags, const Memory* _mem)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
 
 #if BGFX_CONFIG_DEBUG
 		if (NULL != _mem)
@@ -1942,17 +2687,19 @@ namespace bgfx
 		tc.m_sides = 0;
 		tc.m_depth = 0;
 		tc.m_numMips = _numMips;
+		tc.m_baseMip = 0;
 		tc.m_format = uint8_t(_format);
 		tc.m_cubeMap = false;
 		tc.m_mem = _mem;
 		bx::write(&writer, tc);
 
+		ResourceThreadScope resourceScope;
 		return s_ctx->createTexture(mem, _flags, NULL);
 	}
 
 	TextureHandle createTexture3D(uint16_t _width, uint16_t _height, uint16_t _depth, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags, const Memory* _mem)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
 		BX_CHECK(0 != (g_caps.supported & BGFX_CAPS_TEXTURE_3D), "Texture3D is not supported! Use bgfx::getCaps to check backend renderer capabilities.");
 
 #if BGFX_CONFIG_DEBUG
@@ -1982,17 +2729,19 @@ namespace bgfx
 		tc.m_sides = 0;
 		tc.m_depth = _depth;
 		tc.m_numMips = _numMips;
+		tc.m_baseMip = 0;
 		tc.m_format = uint8_t(_format);
 		tc.m_cubeMap = false;
 		tc.m_mem = _mem;
 		bx::write(&writer, tc);
 
+		ResourceThreadScope resourceScope;
 		return s_ctx->createTexture(mem, _flags, NULL);
 	}
 
 	TextureHandle createTextureCube(uint16_t _size, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags, const Memory* _mem)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
 
 #if BGFX_CONFIG_DEBUG
 		if (NULL != _mem)
@@ -2021,20 +2770,91 @@ namespace bgfx
 		tc.m_sides = 6;
 		tc.m_depth = 0;
 		tc.m_numMips = _numMips;
+		tc.m_baseMip = 0;
 		tc.m_format = uint8_t(_format);
 		tc.m_cubeMap = true;
 		tc.m_mem = _mem;
 		bx::write(&writer, tc);
 
+		ResourceThreadScope resourceScope;
 		return s_ctx->createTexture(mem, _flags, NULL);
 	}
 
 	void destroyTexture(TextureHandle _handle)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
+		ResourceThreadScope resourceScope;
 		s_ctx->destroyTexture(_handle);
 	}
 
+	TextureHandle createTexture2DStreaming(uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint32_t _flags, uint8_t _baseMip, const Memory* _mem)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		BX_CHECK(_baseMip < _numMips, "Base mip %d must be smaller than number of mips %d.", _baseMip, _numMips);
+
+#if BGFX_CONFIG_DEBUG
+		TextureStreaming::Texture texture;
+		texture.m_width = _width;
+		texture.m_height = _height;
+		texture.m_numMips = _numMips;
+		texture.m_format = uint8_t(_format);
+		const uint32_t storageSize = s_ctx->m_textureStreaming.getSize(texture, _baseMip);
+		BX_CHECK(storageSize == _mem->size
+			, "createTexture2DStreaming: Texture storage size doesn't match passed memory size (storage size: %d, memory size: %d)"
+			, storageSize
+			, _mem->size
+			);
+#endif // BGFX_CONFIG_DEBUG
+
+		uint32_t size = sizeof(uint32_t)+sizeof(TextureCreate);
+		const Memory* mem = alloc(size);
+
+		bx::StaticMemoryBlockWriter writer(mem->data, mem->size);
+		uint32_t magic = BGFX_CHUNK_MAGIC_TEX;
+		bx::write(&writer, magic);
+
+		TextureCreate tc;
+		tc.m_flags = _flags;
+		tc.m_width = _width;
+		tc.m_height = _height;
+		tc.m_sides = 0;
+		tc.m_depth = 0;
+		tc.m_numMips = _numMips;
+		tc.m_baseMip = _baseMip;
+		tc.m_format = uint8_t(_format);
+		tc.m_cubeMap = false;
+		tc.m_mem = _mem;
+		bx::write(&writer, tc);
+
+		return s_ctx->createTextureStreaming(mem, _flags, _width, _height, _numMips, _format, _baseMip);
+	}
+
+	void updateTexture2DStreaming(TextureHandle _handle, uint8_t _mip, const Memory* _mem)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(NULL != _mem, "_mem can't be NULL");
+		s_ctx->updateTextureStreaming(_handle, _mip, _mem);
+	}
+
+	void setTextureStreamingBudget(uint32_t _budget)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->setTextureStreamingBudget(_budget);
+	}
+
+	uint16_t getTextureStreamingRequests(TextureStreamRequest* _requests, uint16_t _max)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		return s_ctx->getTextureStreamingRequests(_requests, _max);
+	}
+
+	void getTextureStreamingStats(TextureStreamingStats& _stats)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->getTextureStreamingStats(_stats);
+	}
+
 	void updateTexture2D(TextureHandle _handle, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height, const Memory* _mem, uint16_t _pitch)
 	{
 		BGFX_CHECK_MAIN_THREAD();
@@ -2097,16 +2917,39 @@ namespace bgfx
 
 	UniformHandle createUniform(const char* _name, UniformType::Enum _type, uint16_t _num)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
+		ResourceThreadScope resourceScope;
 		return s_ctx->createUniform(_name, _type, _num);
 	}
 
 	void destroyUniform(UniformHandle _handle)
 	{
-		BGFX_CHECK_MAIN_THREAD();
+		BGFX_CHECK_RESOURCE_THREAD();
+		ResourceThreadScope resourceScope;
 		s_ctx->destroyUniform(_handle);
 	}
 
+	void setProgramCache(const char* _filePath)
+	{
+		BX_CHECK(NULL == s_ctx, "Program cache must be set before bgfx::init.");
+
+		if (NULL == _filePath)
+		{
+			g_programCacheFilePath = NULL;
+		}
+		else
+		{
+			bx::strlcpy(s_programCacheFilePath, _filePath, BX_COUNTOF(s_programCacheFilePath) );
+			g_programCacheFilePath = s_programCacheFilePath;
+		}
+	}
+
+	void prewarmProgramCache()
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->prewarmProgramCache();
+	}
+
 	void setViewName(uint8_t _id, const char* _name)
 	{
 		BGFX_CHECK_MAIN_THREAD();
@@ -2272,12 +3115,38 @@ namespace bgfx
 		s_ctx->setVertexBuffer(_tvb, _numVertices);
 	}
 
+	void setVertexStream(uint8_t _stream, VertexBufferHandle _handle, uint32_t _startVertex)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->setVertexStream(_stream, _handle, _startVertex);
+	}
+
+	void setVertexStream(uint8_t _stream, DynamicVertexBufferHandle _handle)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->setVertexStream(_stream, _handle);
+	}
+
+	void setVertexStream(uint8_t _stream, const TransientVertexBuffer* _tvb)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(NULL != _tvb, "_tvb can't be NULL");
+		s_ctx->setVertexStream(_stream, _tvb);
+	}
+
 	void setInstanceDataBuffer(const InstanceDataBuffer* _idb, uint16_t _num)
 	{
 		BGFX_CHECK_MAIN_THREAD();
 		s_ctx->setInstanceDataBuffer(_idb, _num);
 	}
 
+	void setInstanceDataStream(uint8_t _stream, const InstanceDataBuffer* _idb)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		BX_CHECK(0 < _stream, "Instance data stream 0 is set with setInstanceDataBuffer.");
+		s_ctx->setInstanceDataStream(_stream, _idb);
+	}
+
 	void setProgram(ProgramHandle _handle)
 	{
 		BGFX_CHECK_MAIN_THREAD();
@@ -2314,6 +3183,42 @@ namespace bgfx
 		s_ctx->discard();
 	}
 
+	uint32_t submit(uint8_t _id, const SubmitArrays& _arrays)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		return s_ctx->submit(_id, _arrays);
+	}
+
+	DrawListHandle createDrawList()
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		return s_ctx->createDrawList();
+	}
+
+	void destroyDrawList(DrawListHandle _handle)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->destroyDrawList(_handle);
+	}
+
+	void beginDrawList(DrawListHandle _handle)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->beginDrawList(_handle);
+	}
+
+	void endDrawList()
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		s_ctx->endDrawList();
+	}
+
+	uint32_t submit(uint8_t _id, DrawListHandle _handle, const void* _mtx)
+	{
+		BGFX_CHECK_MAIN_THREAD();
+		return s_ctx->submit(_id, _handle, _mtx);
+	}
+
 	void saveScreenShot(const char* _filePath)
 	{
 		BGFX_CHECK_MAIN_THREAD();
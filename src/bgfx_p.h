@@ -118,6 +118,7 @@ namespace stl
 #endif // BX_PLATFORM_*
 
 #include <bx/cpu.h>
+#include <bx/mutex.h>
 #include <bx/thread.h>
 #include <bx/timer.h>
 
@@ -221,6 +222,7 @@ namespace bgfx
 		uint16_t m_sides;
 		uint16_t m_depth;
 		uint8_t m_numMips;
+		uint8_t m_baseMip;
 		uint8_t m_format;
 		bool m_cubeMap;
 		const Memory* m_mem;
@@ -228,6 +230,7 @@ namespace bgfx
 
 	extern const uint32_t g_uniformTypeSize[UniformType::Count+1];
 	extern CallbackI* g_callback;
+	extern const char* g_programCacheFilePath;
 	extern bx::ReallocatorI* g_allocator;
 	extern Caps g_caps;
 
@@ -301,6 +304,9 @@ namespace bgfx
 	{
 		TextVideoMem()
 			: m_mem(NULL)
+			, m_dirty(NULL)
+			, m_prev(NULL)
+			, m_seq(0)
 			, m_size(0)
 			, m_width(0)
 			, m_height(0)
@@ -313,6 +319,7 @@ namespace bgfx
 		~TextVideoMem()
 		{
 			BX_FREE(g_allocator, m_mem);
+			BX_FREE(g_allocator, m_dirty);
 		}
 
 		void resize(bool _small = false, uint16_t _width = BGFX_DEFAULT_WIDTH, uint16_t _height = BGFX_DEFAULT_HEIGHT)
@@ -338,17 +345,28 @@ namespace bgfx
 				{
 					memset(&m_mem[size], 0, m_size-size);
 				}
+
+				m_dirty = (uint8_t*)BX_REALLOC(g_allocator, m_dirty, m_height);
+				memset(m_dirty, 1, m_height);
 			}
 		}
 
 		void clear(uint8_t _attr = 0)
 		{
 			uint8_t* mem = m_mem;
-			for (uint32_t ii = 0, num = m_size/2; ii < num; ++ii)
+			for (uint32_t yy = 0; yy < m_height; ++yy)
 			{
-				mem[0] = 0;
-				mem[1] = _attr;
-				mem += 2;
+				uint8_t dirty = 0;
+				for (uint32_t xx = 0; xx < m_width; ++xx)
+				{
+					dirty |= mem[0];
+					dirty |= mem[1] ^ _attr;
+					mem[0] = 0;
+					mem[1] = _attr;
+					mem += 2;
+				}
+
+				m_dirty[yy] |= 0 != dirty;
 			}
 		}
 
@@ -360,13 +378,18 @@ namespace bgfx
 
 				uint32_t num = bx::vsnprintf(temp, m_width, _format, _argList);
 
+				uint8_t dirty = 0;
 				uint8_t* mem = &m_mem[(_y*m_width+_x)*2];
 				for (uint32_t ii = 0, xx = _x; ii < num && xx < m_width; ++ii, ++xx)
 				{
+					dirty |= mem[0] ^ uint8_t(temp[ii]);
+					dirty |= mem[1] ^ _attr;
 					mem[0] = temp[ii];
 					mem[1] = _attr;
 					mem += 2;
 				}
+
+				m_dirty[_y] |= 0 != dirty;
 			}
 		}
 
@@ -378,7 +401,54 @@ namespace bgfx
 			va_end(argList);
 		}
 
+		/// Clear dirty flag of rows that ended up same as in _prev. Rows
+		/// cleared and printed again with same text don't need rebuild.
+		void resolveDirty(const TextVideoMem& _prev)
+		{
+			if (m_width  != _prev.m_width
+			||  m_height != _prev.m_height
+			||  m_small  != _prev.m_small)
+			{
+				memset(m_dirty, 1, m_height);
+				return;
+			}
+
+			const uint32_t pitch = m_width*2;
+			for (uint32_t yy = 0; yy < m_height; ++yy)
+			{
+				if (m_dirty[yy]
+				&&  0 == memcmp(&m_mem[yy*pitch], &_prev.m_mem[yy*pitch], pitch) )
+				{
+					m_dirty[yy] = 0;
+				}
+			}
+		}
+
+		/// Continue from content of _prev, used when frames are swapped so
+		/// that dirty rows are tracked against last submitted frame.
+		void copy(const TextVideoMem& _prev)
+		{
+			resize(_prev.m_small, _prev.m_width*8, _prev.m_height*(_prev.m_small ? 8 : 16) );
+			memcpy(m_mem, _prev.m_mem, m_size);
+			memset(m_dirty, 0, m_height);
+			m_prev = &_prev;
+			m_seq = _prev.m_seq + 1;
+		}
+
+		bool isDirty(uint16_t _y) const
+		{
+			return 0 != m_dirty[_y];
+		}
+
+		void resetDirty()
+		{
+			memset(m_dirty, 0, m_height);
+		}
+
 		uint8_t* m_mem;
+		uint8_t* m_dirty;
+		const TextVideoMem* m_prev;
+		uint32_t m_seq;
 		uint32_t m_size;
 		uint16_t m_width;
 		uint16_t m_height;
@@ -390,13 +460,26 @@ namespace bgfx
 		void init();
 		void shutdown();
 
-		void blit(const TextVideoMem* _mem)
+		void blit(TextVideoMem* _mem)
 		{
 			blit(*_mem);
 		}
 
-		void blit(const TextVideoMem& _mem);
+		/// Rebuilds and uploads only rows of text grid that changed since
+		/// last blit, and draws whole grid from persistent vertex buffer.
+		void blit(TextVideoMem& _mem);
+
+		/// Force full rebuild on next blit, call when buffer contents are
+		/// lost.
+		void invalidate()
+		{
+			m_last = NULL;
+			m_ibValid = false;
+		}
+
 		void setup();
+		void updateVertexBuffer(uint32_t _startVertex, uint32_t _numVertices);
+		void updateIndexBuffer(uint32_t _numIndices);
 		void render(uint32_t _numIndices);
 
 		TextureHandle m_texture;
@@ -404,6 +487,10 @@ namespace bgfx
 		TransientIndexBuffer* m_ib;
 		VertexDecl m_decl;
 		ProgramHandle m_program;
+		const TextVideoMem* m_last;
+		uint32_t m_lastSeq;
+		bool m_ibValid;
+		bool m_vbDirty; // Renderers that can't update buffer range in flight upload at render.
 		bool m_init;
 	};
 
@@ -512,9 +599,11 @@ namespace bgfx
 			CreateProgram,
 			CreateTexture,
 			UpdateTexture,
+			UpdateTextureResidency,
 			CreateRenderTarget,
 			CreateUniform,
 			UpdateViewName,
+			PrewarmProgramCache,
 			End,
 			RendererShutdownEnd,
 			DestroyVertexDecl,
@@ -577,6 +666,27 @@ namespace bgfx
 			m_size = BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE;
 		}
 
+		void append(const CommandBuffer& _cmdbuf)
+		{
+			BX_CHECK(m_pos + _cmdbuf.m_pos < m_size, "Command buffer overflow (pos %d, appended %d)."
+				, m_pos
+				, _cmdbuf.m_pos
+				);
+			write(_cmdbuf.m_buffer, _cmdbuf.m_pos);
+		}
+
+		void insert(uint32_t _pos, const CommandBuffer& _cmdbuf)
+		{
+			BX_CHECK(m_pos + _cmdbuf.m_pos < m_size, "Command buffer overflow (pos %d, inserted %d)."
+				, m_pos
+				, _cmdbuf.m_pos
+				);
+			BX_CHECK(_pos <= m_pos, "Invalid insert position %d (pos %d).", _pos, m_pos);
+			memmove(&m_buffer[_pos+_cmdbuf.m_pos], &m_buffer[_pos], m_pos-_pos);
+			memcpy(&m_buffer[_pos], _cmdbuf.m_buffer, _cmdbuf.m_pos);
+			m_pos += _cmdbuf.m_pos;
+		}
+
 		void finish()
 		{
 			uint8_t cmd = End;
@@ -594,6 +704,9 @@ namespace bgfx
 		void operator=(const CommandBuffer&);
 	};
 
+#define SORT_KEY_SEQ_SHIFT  0x23
+#define SORT_KEY_VIEW_SHIFT 0x2e
+
 	struct SortKey
 	{
 		uint64_t encode()
@@ -607,8 +720,8 @@ namespace bgfx
 			uint64_t tmp0 = m_depth;
 			uint64_t tmp1 = uint64_t(m_program)<<0x18;
 			uint64_t tmp2 = uint64_t(m_trans)<<0x21;
-			uint64_t tmp3 = uint64_t(m_seq)<<0x23;
-			uint64_t tmp4 = uint64_t(m_view)<<0x2e;
+			uint64_t tmp3 = uint64_t(m_seq)<<SORT_KEY_SEQ_SHIFT;
+			uint64_t tmp4 = uint64_t(m_view)<<SORT_KEY_VIEW_SHIFT;
 			uint64_t key = tmp0|tmp1|tmp2|tmp3|tmp4;
 			return key;
 		}
@@ -618,8 +731,23 @@ namespace bgfx
 			m_depth = _key&0xffffffff;
 			m_program = (_key>>0x18)&(BGFX_CONFIG_MAX_PROGRAMS-1);
 			m_trans = (_key>>0x21)&0x3;
-			m_seq = (_key>>0x23)&0x7ff;
-			m_view = (_key>>0x2e)&(BGFX_CONFIG_MAX_VIEWS-1);
+			m_seq = (_key>>SORT_KEY_SEQ_SHIFT)&0x7ff;
+			m_view = (_key>>SORT_KEY_VIEW_SHIFT)&(BGFX_CONFIG_MAX_VIEWS-1);
+		}
+
+		/// Strip view and sequence from encoded key.
+		static uint64_t removeViewSeq(uint64_t _key)
+		{
+			return _key & ( (UINT64_C(1)<<SORT_KEY_SEQ_SHIFT)-1);
+		}
+
+		/// Add view and sequence to key stripped with removeViewSeq.
+		static uint64_t addViewSeq(uint64_t _key, uint8_t _view, uint16_t _seq)
+		{
+			return _key
+				| (uint64_t(_seq)<<SORT_KEY_SEQ_SHIFT)
+				| (uint64_t(_view)<<SORT_KEY_VIEW_SHIFT)
+				;
 		}
 
 		void reset()
@@ -815,6 +943,11 @@ namespace bgfx
 			return m_pos;
 		}
 
+		const char* getData(uint32_t _pos) const
+		{
+			return &m_buffer[_pos];
+		}
+
 		void reset(uint32_t _pos = 0)
 		{
 			m_pos = _pos;
@@ -899,6 +1032,20 @@ namespace bgfx
  		UniformHashMap m_uniforms;
  	};
 
+	struct Stream
+	{
+		uint32_t m_startVertex;
+		VertexBufferHandle m_handle;
+		VertexDeclHandle m_decl;
+	};
+
+	struct InstanceDataStream
+	{
+		uint32_t m_offset;
+		uint16_t m_stride;
+		VertexBufferHandle m_handle;
+	};
+
 	struct RenderState
 	{
 		void reset()
@@ -907,6 +1054,77 @@ namespace bgfx
 			clear();
 		}
 
+		// Start vertex of single stream is applied by draw call, and it's
+		// compared only when multiple streams are bound.
+		bool isStreamChanged(const RenderState& _other) const
+		{
+			if (m_numStreams != _other.m_numStreams)
+			{
+				return true;
+			}
+
+			for (uint32_t ii = 0; ii < m_numStreams; ++ii)
+			{
+				const Stream& lhs = m_stream[ii];
+				const Stream& rhs = _other.m_stream[ii];
+				if (lhs.m_handle.idx != rhs.m_handle.idx
+				||  lhs.m_decl.idx != rhs.m_decl.idx
+				|| (1 < m_numStreams && lhs.m_startVertex != rhs.m_startVertex) )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void setStreams(const RenderState& _other)
+		{
+			m_numStreams = _other.m_numStreams;
+			memcpy(m_stream, _other.m_stream, bx::uint32_max(1, m_numStreams)*sizeof(Stream) );
+		}
+
+		bool isInstanceDataChanged(const RenderState& _other) const
+		{
+			if (m_numInstanceDataStreams != _other.m_numInstanceDataStreams)
+			{
+				return true;
+			}
+
+			for (uint32_t ii = 0; ii < m_numInstanceDataStreams; ++ii)
+			{
+				const InstanceDataStream& lhs = m_instanceData[ii];
+				const InstanceDataStream& rhs = _other.m_instanceData[ii];
+				if (lhs.m_handle.idx != rhs.m_handle.idx
+				||  lhs.m_offset != rhs.m_offset
+				||  lhs.m_stride != rhs.m_stride)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void setInstanceData(const RenderState& _other)
+		{
+			m_numInstanceDataStreams = _other.m_numInstanceDataStreams;
+			memcpy(m_instanceData, _other.m_instanceData, m_numInstanceDataStreams*sizeof(InstanceDataStream) );
+		}
+
+		/// Returns number of vec4 instance data attributes, summed over
+		/// instance data streams.
+		uint8_t getNumInstanceData() const
+		{
+			uint32_t num = 0;
+			for (uint32_t ii = 0; ii < m_numInstanceDataStreams; ++ii)
+			{
+				num += m_instanceData[ii].m_stride/16;
+			}
+
+			return uint8_t(num);
+		}
+
 		void clear()
 		{
 			m_constBegin = m_constEnd;
@@ -916,17 +1134,16 @@ namespace bgfx
 			m_matrix = 0;
 			m_startIndex = 0;
 			m_numIndices = UINT32_MAX;
-			m_startVertex = 0;
 			m_numVertices = UINT32_MAX;
-			m_instanceDataOffset = 0;
-			m_instanceDataStride = 0;
 			m_numInstances = 1;
 			m_num = 1;
 			m_scissor = UINT16_MAX;
-			m_vertexBuffer.idx = invalidHandle;
-			m_vertexDecl.idx = invalidHandle;
+			m_numStreams = 0;
+			m_stream[0].m_startVertex = 0;
+			m_stream[0].m_handle.idx = invalidHandle;
+			m_stream[0].m_decl.idx = invalidHandle;
 			m_indexBuffer.idx = invalidHandle;
-			m_instanceDataBuffer.idx = invalidHandle;
+			m_numInstanceDataStreams = 0;
 
 			for (uint32_t ii = 0; ii < BGFX_STATE_TEX_COUNT; ++ii)
 			{
@@ -943,21 +1160,151 @@ namespace bgfx
 		uint32_t m_matrix;
 		uint32_t m_startIndex;
 		uint32_t m_numIndices;
-		uint32_t m_startVertex;
 		uint32_t m_numVertices;
-		uint32_t m_instanceDataOffset;
-		uint16_t m_instanceDataStride;
 		uint16_t m_numInstances;
 		uint16_t m_num;
 		uint16_t m_scissor;
+		uint8_t m_numStreams;
+		uint8_t m_numInstanceDataStreams;
 
-		VertexBufferHandle m_vertexBuffer;
-		VertexDeclHandle m_vertexDecl;
+		// Stream 0 is set by setVertexBuffer and determines number of
+		// vertices, streams [1, m_numStreams) by setVertexStream. Only
+		// stream 0 handle is reset by clear.
+		Stream m_stream[BGFX_CONFIG_MAX_VERTEX_STREAMS];
 		IndexBufferHandle m_indexBuffer;
-		VertexBufferHandle m_instanceDataBuffer;
+
+		// Instance data stream 0 is set by setInstanceDataBuffer, streams
+		// [1, m_numInstanceDataStreams) by setInstanceDataStream.
+		InstanceDataStream m_instanceData[BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS];
 		Sampler m_sampler[BGFX_STATE_TEX_COUNT];
 	};
 
+	/// Draw calls recorded once by beginDrawList/endDrawList, and replayed
+	/// into frame with bulk copy. Sort keys are stored without view and
+	/// sequence, render state constant ranges are relative to recorded
+	/// constants, and matrix and scissor indices are relative to recorded
+	/// matrices and rects, biased by one so that 0 stays identity.
+	/// Resources are recorded by handle only, and they must outlive draw
+	/// list, otherwise replay would use whichever resource reused handle.
+	struct DrawList
+	{
+		void init()
+		{
+			m_keys = NULL;
+			m_values = NULL;
+			m_renderState = NULL;
+			m_matrices = NULL;
+			m_rects = NULL;
+			m_constants = NULL;
+			m_textures = NULL;
+			m_numKeys = 0;
+			m_numRenderStates = 0;
+			m_numMatrices = 0;
+			m_numRects = 0;
+			m_constantSize = 0;
+			m_numTextures = 0;
+		}
+
+		void destroy()
+		{
+			BX_FREE(g_allocator, m_keys);
+			BX_FREE(g_allocator, m_values);
+			BX_FREE(g_allocator, m_renderState);
+			BX_FREE(g_allocator, m_matrices);
+			BX_FREE(g_allocator, m_rects);
+			BX_FREE(g_allocator, m_constants);
+			BX_FREE(g_allocator, m_textures);
+			init();
+		}
+
+		bool isReferenced(VertexBufferHandle _handle) const
+		{
+			for (uint32_t ii = 0; ii < m_numRenderStates; ++ii)
+			{
+				const RenderState& state = m_renderState[ii];
+				for (uint32_t stream = 0; stream < state.m_numStreams; ++stream)
+				{
+					if (state.m_stream[stream].m_handle.idx == _handle.idx)
+					{
+						return true;
+					}
+				}
+
+				for (uint32_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+				{
+					if (state.m_instanceData[stream].m_handle.idx == _handle.idx)
+					{
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		bool isReferenced(IndexBufferHandle _handle) const
+		{
+			for (uint32_t ii = 0; ii < m_numRenderStates; ++ii)
+			{
+				if (m_renderState[ii].m_indexBuffer.idx == _handle.idx)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool isReferenced(ProgramHandle _handle) const
+		{
+			for (uint32_t ii = 0; ii < m_numKeys; ++ii)
+			{
+				SortKey key;
+				key.decode(m_keys[ii]);
+				if (key.m_program == _handle.idx)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool isReferenced(TextureHandle _handle) const
+		{
+			for (uint32_t ii = 0; ii < m_numTextures; ++ii)
+			{
+				if (m_textures[ii].idx == _handle.idx)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		uint64_t* m_keys;
+		uint16_t* m_values;
+		RenderState* m_renderState;
+		float* m_matrices;
+		Rect* m_rects;
+		char* m_constants;
+		TextureHandle* m_textures;
+		uint32_t m_numKeys;
+		uint32_t m_numRenderStates;
+		uint32_t m_numMatrices;
+		uint32_t m_numRects;
+		uint32_t m_constantSize;
+		uint32_t m_numTextures;
+
+		// Frame positions at beginDrawList.
+		uint32_t m_beginNum;
+		uint32_t m_beginRenderState;
+		uint32_t m_beginMatrix;
+		uint32_t m_beginRect;
+		uint32_t m_beginConstant;
+	};
+
 	struct Resolution
 	{
 		Resolution()
@@ -977,6 +1324,7 @@ namespace bgfx
 		IndexBufferHandle m_handle;
 		uint32_t m_offset;
 		uint32_t m_size;
+		uint8_t m_flags;
 	};
 
 	struct DynamicVertexBuffer
@@ -1036,7 +1384,9 @@ namespace bgfx
 			m_numRenderStates = 0;
 			m_numDropped = 0;
 			m_iboffset = 0;
+			m_ib32offset = 0;
 			m_vboffset = 0;
+			m_numInstanceDataBuffers = 0;
 			m_cmdPre.start();
 			m_cmdPost.start();
 			m_constantBuffer->reset();
@@ -1065,11 +1415,16 @@ namespace bgfx
 			m_constantBuffer->writeMarker(_name);
 		}
 
-		void setState(uint64_t _state, uint32_t _rgba)
+		static uint8_t getTrans(uint64_t _state)
 		{
 			uint8_t blend = ( (_state&BGFX_STATE_BLEND_MASK)>>BGFX_STATE_BLEND_SHIFT)&0xff;
 			// transparency sort order table
-			m_key.m_trans = "\x0\x1\x1\x2\x2\x1\x2\x1\x2\x1\x1\x1\x1\x1\x1\x1\x1\x1\x1"[( (blend)&0xf) + (!!blend)];
+			return "\x0\x1\x1\x2\x2\x1\x2\x1\x2\x1\x1\x1\x1\x1\x1\x1\x1\x1\x1"[( (blend)&0xf) + (!!blend)];
+		}
+
+		void setState(uint64_t _state, uint32_t _rgba)
+		{
+			m_key.m_trans = getTrans(_state);
 			m_state.m_flags = _state;
 			m_state.m_rgba = _rgba;
 		}
@@ -1123,34 +1478,56 @@ namespace bgfx
 		void setVertexBuffer(VertexBufferHandle _handle, uint32_t _numVertices)
 		{
 			BX_CHECK(_handle.idx < BGFX_CONFIG_MAX_VERTEX_BUFFERS, "Invalid vertex buffer handle. %d (< %d)", _handle.idx, BGFX_CONFIG_MAX_VERTEX_BUFFERS);
-			m_state.m_startVertex = 0;
 			m_state.m_numVertices = _numVertices;
-			m_state.m_vertexBuffer = _handle;
+			VertexDeclHandle decl = BGFX_INVALID_HANDLE;
+			setStream(0, _handle, 0, decl);
 		}
 
 		void setVertexBuffer(const DynamicVertexBuffer& _dvb, uint32_t _numVertices)
 		{
-			m_state.m_startVertex = _dvb.m_startVertex;
 			m_state.m_numVertices = bx::uint32_min(_dvb.m_numVertices, _numVertices);
-			m_state.m_vertexBuffer = _dvb.m_handle;
-			m_state.m_vertexDecl = _dvb.m_decl;
+			setStream(0, _dvb.m_handle, _dvb.m_startVertex, _dvb.m_decl);
 		}
 
 		void setVertexBuffer(const TransientVertexBuffer* _tvb, uint32_t _numVertices)
 		{
-			m_state.m_startVertex = _tvb->startVertex;
 			m_state.m_numVertices = bx::uint32_min(_tvb->size/_tvb->stride, _numVertices);
-			m_state.m_vertexBuffer = _tvb->handle;
-			m_state.m_vertexDecl = _tvb->decl;
+			setStream(0, _tvb->handle, _tvb->startVertex, _tvb->decl);
+		}
+
+		void setStream(uint8_t _stream, VertexBufferHandle _handle, uint32_t _startVertex, VertexDeclHandle _decl)
+		{
+			BX_CHECK(_stream < BGFX_CONFIG_MAX_VERTEX_STREAMS, "Invalid vertex stream %d (< %d).", _stream, BGFX_CONFIG_MAX_VERTEX_STREAMS);
+			BX_CHECK(_stream <= m_state.m_numStreams, "Vertex stream %d set before stream %d.", _stream, m_state.m_numStreams);
+			Stream& stream = m_state.m_stream[_stream];
+			stream.m_startVertex = _startVertex;
+			stream.m_handle = _handle;
+			stream.m_decl = _decl;
+			m_state.m_numStreams = uint8_t(bx::uint32_max(m_state.m_numStreams, _stream+1) );
 		}
 
 		void setInstanceDataBuffer(const InstanceDataBuffer* _idb, uint16_t _num)
 		{
- 			m_state.m_instanceDataOffset = _idb->offset;
-			m_state.m_instanceDataStride = _idb->stride;
-			m_state.m_numInstances = bx::uint16_min( (uint16_t)_idb->num, _num);
-			m_state.m_instanceDataBuffer = _idb->handle;
-			BX_FREE(g_allocator, const_cast<InstanceDataBuffer*>(_idb) );
+			m_state.m_numInstances = bx::uint16_min(_idb->num, _num);
+			m_state.m_numInstanceDataStreams = 0;
+			setInstanceDataStream(0, _idb);
+		}
+
+		void setInstanceDataStream(uint8_t _stream, const InstanceDataBuffer* _idb)
+		{
+			BX_CHECK(_stream < BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS, "Invalid instance data stream %d (< %d).", _stream, BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS);
+			BX_CHECK(_stream <= m_state.m_numInstanceDataStreams, "Instance data stream %d set before stream %d.", _stream, m_state.m_numInstanceDataStreams);
+			InstanceDataStream& stream = m_state.m_instanceData[_stream];
+			stream.m_offset = _idb->offset;
+			stream.m_stride = _idb->stride;
+			stream.m_handle = _idb->handle;
+			m_state.m_numInstanceDataStreams = uint8_t(bx::uint32_max(m_state.m_numInstanceDataStreams, _stream+1) );
+			m_state.m_numInstances = bx::uint16_min(m_state.m_numInstances, _idb->num);
+			BX_CHECK(BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT >= m_state.getNumInstanceData()
+				, "Too many instance data attributes %d (max: %d)."
+				, m_state.getNumInstanceData()
+				, BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
+				);
 		}
 
 		void setProgram(ProgramHandle _handle)
@@ -1202,10 +1579,23 @@ namespace bgfx
 
 		uint32_t submit(uint8_t _id, int32_t _depth);
 		uint32_t submitMask(uint32_t _viewMask, int32_t _depth);
+		uint32_t submit(uint8_t _id, const DrawList& _list, const void* _mtx);
+		uint32_t submit(uint8_t _id, const SubmitArrays& _arrays);
+		void beginDrawList(DrawList& _list);
+		void endDrawList(DrawList& _list);
 		void sort();
 
-		bool checkAvailTransientIndexBuffer(uint32_t _num)
+		bool checkAvailTransientIndexBuffer(uint32_t _num, uint8_t _flags)
 		{
+			if (0 != (_flags & BGFX_BUFFER_INDEX32) )
+			{
+				uint32_t offset = m_ib32offset;
+				uint32_t iboffset = offset + _num*sizeof(uint32_t);
+				iboffset = bx::uint32_min(iboffset, BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE);
+				uint32_t num = (iboffset-offset)/sizeof(uint32_t);
+				return num == _num;
+			}
+
 			uint32_t offset = m_iboffset;
 			uint32_t iboffset = offset + _num*sizeof(uint16_t);
 			iboffset = bx::uint32_min(iboffset, BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
@@ -1213,8 +1603,17 @@ namespace bgfx
 			return num == _num;
 		}
 
-		uint32_t allocTransientIndexBuffer(uint32_t& _num)
+		uint32_t allocTransientIndexBuffer(uint32_t& _num, uint8_t _flags)
 		{
+			if (0 != (_flags & BGFX_BUFFER_INDEX32) )
+			{
+				uint32_t offset = m_ib32offset;
+				m_ib32offset = offset + _num*sizeof(uint32_t);
+				m_ib32offset = bx::uint32_min(m_ib32offset, BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE);
+				_num = (m_ib32offset-offset)/sizeof(uint32_t);
+				return offset;
+			}
+
 			uint32_t offset = m_iboffset;
 			m_iboffset = offset + _num*sizeof(uint16_t);
 			m_iboffset = bx::uint32_min(m_iboffset, BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE);
@@ -1240,6 +1639,34 @@ namespace bgfx
 			return offset;
 		}
 
+		bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride, uint16_t _numBuffers)
+		{
+			if (uint32_t(m_numInstanceDataBuffers) + _numBuffers > BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS)
+			{
+				return false;
+			}
+
+			if (1 == _numBuffers)
+			{
+				return checkAvailTransientVertexBuffer(_num, _stride);
+			}
+
+			// Each buffer aligns its offset to its own stride, padding before
+			// buffer is less than its stride. Sum of strides bounds padding
+			// of all buffers.
+			return uint64_t(m_vboffset) + (uint64_t(_num)+1)*_stride <= BGFX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE;
+		}
+
+		InstanceDataBuffer* allocInstanceDataBuffer()
+		{
+			if (BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS <= m_numInstanceDataBuffers)
+			{
+				return NULL;
+			}
+
+			return &m_instanceDataBuffer[m_numInstanceDataBuffers++];
+		}
+
 		void writeConstant(UniformType::Enum _type, UniformHandle _handle, const void* _value, uint16_t _num)
 		{
 			m_constantBuffer->writeUniform(_type, _handle.idx, _value, _num);
@@ -1339,10 +1766,15 @@ namespace bgfx
 		RectCache m_rectCache;
 
 		uint32_t m_iboffset;
+		uint32_t m_ib32offset;
 		uint32_t m_vboffset;
 		TransientIndexBuffer* m_transientIb;
+		TransientIndexBuffer* m_transientIb32;
 		TransientVertexBuffer* m_transientVb;
 
+		InstanceDataBuffer m_instanceDataBuffer[BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS];
+		uint16_t m_numInstanceDataBuffers;
+
 		Resolution m_resolution;
 		uint32_t m_debug;
 
@@ -1376,6 +1808,84 @@ namespace bgfx
 		bool m_discard;
 	};
 
+	/// Handle allocator which can be used from multiple threads. Free
+	/// handles are kept in lock-free stack, and stack head is tagged with
+	/// counter to avoid ABA problem.
+	template <uint16_t MaxHandlesT>
+	class HandleAllocMt
+	{
+	public:
+		HandleAllocMt()
+			: m_head(0)
+			, m_numHandles(0)
+		{
+			for (uint16_t ii = 0; ii < MaxHandlesT; ++ii)
+			{
+				m_next[ii] = ii+1;
+			}
+			m_next[MaxHandlesT-1] = invalidHandle;
+		}
+
+		uint16_t alloc()
+		{
+			for (;;)
+			{
+				const int32_t head = m_head;
+				const uint16_t handle = uint16_t(head);
+				if (invalidHandle == handle)
+				{
+					return invalidHandle;
+				}
+
+				const int32_t next = tag(head, m_next[handle]);
+				if (head == bx::atomicCompareAndSwap(&m_head, head, next) )
+				{
+					bx::atomicInc(&m_numHandles);
+					return handle;
+				}
+			}
+		}
+
+		void free(uint16_t _handle)
+		{
+			BX_CHECK(_handle < MaxHandlesT, "Invalid handle %d.", _handle);
+
+			for (;;)
+			{
+				const int32_t head = m_head;
+				m_next[_handle] = uint16_t(head);
+
+				const int32_t next = tag(head, _handle);
+				if (head == bx::atomicCompareAndSwap(&m_head, head, next) )
+				{
+					bx::atomicDec(&m_numHandles);
+					return;
+				}
+			}
+		}
+
+		uint16_t getNumHandles() const
+		{
+			return uint16_t(m_numHandles);
+		}
+
+		uint16_t getMaxHandles() const
+		{
+			return MaxHandlesT;
+		}
+
+	private:
+		static int32_t tag(int32_t _head, uint16_t _handle)
+		{
+			const uint32_t counter = (uint32_t(_head)>>16) + 1;
+			return int32_t( (counter<<16) | _handle);
+		}
+
+		volatile int32_t m_head;
+		volatile int32_t m_numHandles;
+		volatile uint16_t m_next[MaxHandlesT];
+	};
+
 	struct VertexDeclRef
 	{
 		VertexDeclRef()
@@ -1388,8 +1898,8 @@ namespace bgfx
 			memset(m_vertexBufferRef, 0xff, sizeof(m_vertexBufferRef) );
 		}
 
-		template <uint16_t MaxHandlesT>
-		void shutdown(bx::HandleAllocT<MaxHandlesT>& _handleAlloc)
+		template <typename HandleAlloc>
+		void shutdown(HandleAlloc& _handleAlloc)
 		{
 			for (VertexDeclMap::iterator it = m_vertexDeclMap.begin(), itEnd = m_vertexDeclMap.end(); it != itEnd; ++it)
 			{
@@ -1441,6 +1951,150 @@ namespace bgfx
 		VertexDeclHandle m_vertexBufferRef[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
 	};
 
+	/// Commands and freed handles of thread other than API thread. Written
+	/// while holding m_mutex, and spliced into submit frame at swap.
+	struct ThreadCommandBuffer
+	{
+		void reset()
+		{
+			m_cmdPre.start();
+			m_cmdPost.start();
+			m_numFreeIndexBufferHandles = 0;
+			m_numFreeVertexBufferHandles = 0;
+			m_numFreeTextureHandles = 0;
+			m_numFreeUniformHandles = 0;
+		}
+
+		void free(IndexBufferHandle _handle)
+		{
+			BX_CHECK(m_numFreeIndexBufferHandles < BGFX_CONFIG_MAX_INDEX_BUFFERS, "Too many freed index buffers.");
+			m_freeIndexBufferHandle[m_numFreeIndexBufferHandles] = _handle;
+			++m_numFreeIndexBufferHandles;
+		}
+
+		void free(VertexBufferHandle _handle)
+		{
+			BX_CHECK(m_numFreeVertexBufferHandles < BGFX_CONFIG_MAX_VERTEX_BUFFERS, "Too many freed vertex buffers.");
+			m_freeVertexBufferHandle[m_numFreeVertexBufferHandles] = _handle;
+			++m_numFreeVertexBufferHandles;
+		}
+
+		void free(TextureHandle _handle)
+		{
+			BX_CHECK(m_numFreeTextureHandles < BGFX_CONFIG_MAX_TEXTURES, "Too many freed textures.");
+			m_freeTextureHandle[m_numFreeTextureHandles] = _handle;
+			++m_numFreeTextureHandles;
+		}
+
+		void free(UniformHandle _handle)
+		{
+			BX_CHECK(m_numFreeUniformHandles < BGFX_CONFIG_MAX_UNIFORMS, "Too many freed uniforms.");
+			m_freeUniformHandle[m_numFreeUniformHandles] = _handle;
+			++m_numFreeUniformHandles;
+		}
+
+		bx::LwMutex m_mutex;
+
+		CommandBuffer m_cmdPre;
+		CommandBuffer m_cmdPost;
+
+		uint16_t m_numFreeIndexBufferHandles;
+		uint16_t m_numFreeVertexBufferHandles;
+		uint16_t m_numFreeTextureHandles;
+		uint16_t m_numFreeUniformHandles;
+
+		IndexBufferHandle m_freeIndexBufferHandle[BGFX_CONFIG_MAX_INDEX_BUFFERS];
+		VertexBufferHandle m_freeVertexBufferHandle[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
+		TextureHandle m_freeTextureHandle[BGFX_CONFIG_MAX_TEXTURES];
+		UniformHandle m_freeUniformHandle[BGFX_CONFIG_MAX_UNIFORMS];
+	};
+
+	struct TextureStreaming
+	{
+		struct Texture
+		{
+			uint16_t m_width;
+			uint16_t m_height;
+			uint16_t m_listIdx;
+			uint8_t m_numMips;
+			uint8_t m_format;
+			uint8_t m_baseMip;
+			uint8_t m_lod;
+		};
+
+		TextureStreaming()
+			: m_budget(BGFX_CONFIG_TEXTURE_STREAMING_BUDGET)
+			, m_resident(0)
+			, m_requested(0)
+			, m_num(0)
+			, m_numRequests(0)
+		{
+		}
+
+		void init()
+		{
+			memset(m_lastUsed, 0, sizeof(m_lastUsed) );
+			memset(m_texture, 0, sizeof(m_texture) );
+			m_resident = 0;
+			m_requested = 0;
+			m_num = 0;
+			m_numRequests = 0;
+		}
+
+		void create(TextureHandle _handle, uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint8_t _baseMip, uint32_t _frame)
+		{
+			Texture& texture = m_texture[_handle.idx];
+			texture.m_width = _width;
+			texture.m_height = _height;
+			texture.m_listIdx = m_num;
+			texture.m_numMips = _numMips;
+			texture.m_format = uint8_t(_format);
+			texture.m_baseMip = _baseMip;
+			texture.m_lod = _baseMip;
+			m_lastUsed[_handle.idx] = _frame;
+			m_list[m_num++] = _handle;
+		}
+
+		void destroy(TextureHandle _handle)
+		{
+			Texture& texture = m_texture[_handle.idx];
+			if (0 != texture.m_numMips)
+			{
+				TextureHandle last = m_list[--m_num];
+				m_list[texture.m_listIdx] = last;
+				m_texture[last.idx].m_listIdx = texture.m_listIdx;
+				texture.m_numMips = 0;
+			}
+		}
+
+		bool isStreaming(TextureHandle _handle) const
+		{
+			return 0 != m_texture[_handle.idx].m_numMips;
+		}
+
+		void touch(TextureHandle _handle, uint32_t _frame)
+		{
+			m_lastUsed[_handle.idx] = _frame;
+		}
+
+		/// Returns size of mip chain starting at _mip.
+		uint32_t getSize(const Texture& _texture, uint8_t _mip) const;
+
+		uint32_t m_budget;
+		uint32_t m_resident;
+		uint32_t m_requested;
+		uint16_t m_num;
+		uint16_t m_numRequests;
+		uint32_t m_lastUsed[BGFX_CONFIG_MAX_TEXTURES];
+		Texture m_texture[BGFX_CONFIG_MAX_TEXTURES];
+		TextureHandle m_list[BGFX_CONFIG_MAX_TEXTURES];
+		TextureStreamRequest m_request[BGFX_CONFIG_MAX_TEXTURES];
+		uint32_t m_keys[BGFX_CONFIG_MAX_TEXTURES];
+		uint32_t m_tempKeys[BGFX_CONFIG_MAX_TEXTURES];
+		uint16_t m_values[BGFX_CONFIG_MAX_TEXTURES];
+		uint16_t m_tempValues[BGFX_CONFIG_MAX_TEXTURES];
+	};
+
 	// First-fit non-local allocator.
 	class NonLocalAllocator
 	{
@@ -1585,14 +2239,51 @@ namespace bgfx
 		void init();
 		void shutdown();
 
+		// Returns NULL when called from API thread.
+		ThreadCommandBuffer* getThreadCommandBuffer();
+
 		CommandBuffer& getCommandBuffer(CommandBuffer::Enum _cmd)
 		{
-			CommandBuffer& cmdbuf = _cmd < CommandBuffer::End ? m_submit->m_cmdPre : m_submit->m_cmdPost;
+			ThreadCommandBuffer* tcb = getThreadCommandBuffer();
+			CommandBuffer& cmdbuf = NULL == tcb
+				? (_cmd < CommandBuffer::End ? m_submit->m_cmdPre : m_submit->m_cmdPost)
+				: (_cmd < CommandBuffer::End ? tcb->m_cmdPre : tcb->m_cmdPost)
+				;
 			uint8_t cmd = (uint8_t)_cmd;
 			cmdbuf.write(cmd);
 			return cmdbuf;
 		}
 
+		template <typename Ty>
+		void freeHandle(Ty _handle)
+		{
+			ThreadCommandBuffer* tcb = getThreadCommandBuffer();
+			if (NULL == tcb)
+			{
+				m_submit->free(_handle);
+			}
+			else
+			{
+				tcb->free(_handle);
+			}
+		}
+
+		void freeHandle(TextureHandle _handle)
+		{
+			ThreadCommandBuffer* tcb = getThreadCommandBuffer();
+			if (NULL == tcb)
+			{
+				m_textureStreaming.destroy(_handle);
+				m_submit->free(_handle);
+			}
+			else
+			{
+				tcb->free(_handle);
+			}
+		}
+
+		void spliceThreadCommandBuffers();
+
 		BGFX_API_FUNC(void reset(uint32_t _width, uint32_t _height, uint32_t _flags) )
 		{
 			BX_WARN(0 != _width && 0 != _height, "Frame buffer resolution width or height cannot be 0 (width %d, height %d).", _width, _height);
@@ -1619,8 +2310,12 @@ namespace bgfx
 			m_submit->m_textVideoMem->printfVargs(_x, _y, _attr, _format, _argList);
 		}
 
-		BGFX_API_FUNC(IndexBufferHandle createIndexBuffer(const Memory* _mem) )
+		BGFX_API_FUNC(IndexBufferHandle createIndexBuffer(const Memory* _mem, uint8_t _flags) )
 		{
+			BX_WARN(0 == (_flags & BGFX_BUFFER_INDEX32) || 0 != (g_caps.supported & BGFX_CAPS_INDEX32)
+				, "32-bit indices are not supported by renderer."
+				);
+
 			IndexBufferHandle handle = { m_indexBufferHandle.alloc() };
 
 			BX_WARN(isValid(handle), "Failed to allocate index buffer handle.");
@@ -1629,6 +2324,7 @@ namespace bgfx
 				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateIndexBuffer);
 				cmdbuf.write(handle);
 				cmdbuf.write(_mem);
+				cmdbuf.write(_flags);
 			}
 
 			return handle;
@@ -1636,9 +2332,10 @@ namespace bgfx
 
 		BGFX_API_FUNC(void destroyIndexBuffer(IndexBufferHandle _handle) )
 		{
+			BX_CHECK(!isDrawListReferenced(_handle), "Index buffer %d is referenced by draw list.", _handle.idx);
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyIndexBuffer);
 			cmdbuf.write(_handle);
-			m_submit->free(_handle);
+			freeHandle(_handle);
 		}
 
 		VertexDeclHandle findVertexDecl(const VertexDecl& _decl)
@@ -1664,8 +2361,12 @@ namespace bgfx
 			BX_WARN(isValid(handle), "Failed to allocate vertex buffer handle.");
 			if (isValid(handle) )
 			{
-				VertexDeclHandle declHandle = findVertexDecl(_decl);
-				m_declRef.add(handle, declHandle, _decl.m_hash);
+				VertexDeclHandle declHandle;
+				{
+					bx::LwMutexScope resourceScope(m_resourceMutex);
+					declHandle = findVertexDecl(_decl);
+					m_declRef.add(handle, declHandle, _decl.m_hash);
+				}
 
 				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateVertexBuffer);
 				cmdbuf.write(handle);
@@ -1678,13 +2379,16 @@ namespace bgfx
 
 		BGFX_API_FUNC(void destroyVertexBuffer(VertexBufferHandle _handle) )
 		{
+			BX_CHECK(!isDrawListReferenced(_handle), "Vertex buffer %d is referenced by draw list.", _handle.idx);
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyVertexBuffer);
 			cmdbuf.write(_handle);
-			m_submit->free(_handle);
+			freeHandle(_handle);
 		}
 
 		void destroyVertexBufferInternal(VertexBufferHandle _handle)
 		{
+			bx::LwMutexScope resourceScope(m_resourceMutex);
+
 			VertexDeclHandle declHandle = m_declRef.release(_handle);
 			if (isValid(declHandle) )
 			{
@@ -1695,11 +2399,27 @@ namespace bgfx
 			m_vertexBufferHandle.free(_handle.idx);
 		}
 
-		BGFX_API_FUNC(DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num) )
+		NonLocalAllocator& getDynamicIndexBufferAllocator(uint8_t _flags)
 		{
+			// Renderers bind index format per buffer, 32-bit indices are
+			// suballocated from their own buffers.
+			return 0 != (_flags & BGFX_BUFFER_INDEX32)
+				? m_dynamicIndexBuffer32Allocator
+				: m_dynamicIndexBufferAllocator
+				;
+		}
+
+		BGFX_API_FUNC(DynamicIndexBufferHandle createDynamicIndexBuffer(uint32_t _num, uint8_t _flags) )
+		{
+			BX_WARN(0 == (_flags & BGFX_BUFFER_INDEX32) || 0 != (g_caps.supported & BGFX_CAPS_INDEX32)
+				, "32-bit indices are not supported by renderer."
+				);
+
 			DynamicIndexBufferHandle handle = BGFX_INVALID_HANDLE;
-			uint32_t size = BX_ALIGN_16(_num*2);
-			uint64_t ptr = m_dynamicIndexBufferAllocator.alloc(size);
+			const uint32_t indexSize = 0 != (_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
+			uint32_t size = BX_ALIGN_16(_num*indexSize);
+			NonLocalAllocator& allocator = getDynamicIndexBufferAllocator(_flags);
+			uint64_t ptr = allocator.alloc(size);
 			if (ptr == NonLocalAllocator::invalidBlock)
 			{
 				IndexBufferHandle indexBufferHandle = { m_indexBufferHandle.alloc() };
@@ -1712,9 +2432,10 @@ namespace bgfx
 				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateDynamicIndexBuffer);
 				cmdbuf.write(indexBufferHandle);
 				cmdbuf.write(BGFX_CONFIG_DYNAMIC_INDEX_BUFFER_SIZE);
+				cmdbuf.write(_flags);
 
-				m_dynamicIndexBufferAllocator.add(uint64_t(indexBufferHandle.idx)<<32, BGFX_CONFIG_DYNAMIC_INDEX_BUFFER_SIZE);
-				ptr = m_dynamicIndexBufferAllocator.alloc(size);
+				allocator.add(uint64_t(indexBufferHandle.idx)<<32, BGFX_CONFIG_DYNAMIC_INDEX_BUFFER_SIZE);
+				ptr = allocator.alloc(size);
 			}
 
 			handle.idx = m_dynamicIndexBufferHandle.alloc();
@@ -1728,27 +2449,37 @@ namespace bgfx
 			dib.m_handle.idx = uint16_t(ptr>>32);
 			dib.m_offset = uint32_t(ptr);
 			dib.m_size = size;
+			dib.m_flags = _flags;
 
 			return handle;
 		}
 
-		BGFX_API_FUNC(DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem) )
+		BGFX_API_FUNC(DynamicIndexBufferHandle createDynamicIndexBuffer(const Memory* _mem, uint8_t _flags) )
 		{
-			DynamicIndexBufferHandle handle = createDynamicIndexBuffer(_mem->size/2);
+			const uint32_t indexSize = 0 != (_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
+			DynamicIndexBufferHandle handle = createDynamicIndexBuffer(_mem->size/indexSize, _flags);
 			if (isValid(handle) )
 			{
-				updateDynamicIndexBuffer(handle, _mem);
+				updateDynamicIndexBuffer(handle, 0, _mem);
 			}
 			return handle;
 		}
 
-		BGFX_API_FUNC(void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, const Memory* _mem) )
+		BGFX_API_FUNC(void updateDynamicIndexBuffer(DynamicIndexBufferHandle _handle, uint32_t _startIndex, const Memory* _mem) )
 		{
 			DynamicIndexBuffer& dib = m_dynamicIndexBuffers[_handle.idx];
+			const uint32_t indexSize = 0 != (dib.m_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
+			const uint32_t offset = _startIndex*indexSize;
+			BX_CHECK(offset + _mem->size <= dib.m_size, "Updating outside of dynamic index buffer (start %d, size %d, buffer size %d)."
+				, _startIndex
+				, _mem->size
+				, dib.m_size
+				);
+
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::UpdateDynamicIndexBuffer);
 			cmdbuf.write(dib.m_handle);
-			cmdbuf.write(dib.m_offset);
-			cmdbuf.write(dib.m_size);
+			cmdbuf.write(dib.m_offset + offset);
+			cmdbuf.write(dib.m_size - bx::uint32_min(offset, dib.m_size) );
 			cmdbuf.write(_mem);
 		}
 
@@ -1760,7 +2491,7 @@ namespace bgfx
 		void destroyDynamicIndexBufferInternal(DynamicIndexBufferHandle _handle)
 		{
 			DynamicIndexBuffer& dib = m_dynamicIndexBuffers[_handle.idx];
-			m_dynamicIndexBufferAllocator.free(uint64_t(dib.m_handle.idx)<<32 | dib.m_offset);
+			getDynamicIndexBufferAllocator(dib.m_flags).free(uint64_t(dib.m_handle.idx)<<32 | dib.m_offset);
 			m_dynamicIndexBufferHandle.free(_handle.idx);
 		}
 
@@ -1787,6 +2518,7 @@ namespace bgfx
 				ptr = m_dynamicVertexBufferAllocator.alloc(size);
 			}
 
+			bx::LwMutexScope resourceScope(m_resourceMutex);
 			VertexDeclHandle declHandle = findVertexDecl(_decl);
 
 			handle.idx = m_dynamicVertexBufferHandle.alloc();
@@ -1796,6 +2528,7 @@ namespace bgfx
 			dvb.m_size = size;
 			dvb.m_startVertex = dvb.m_offset/_decl.m_stride;
 			dvb.m_numVertices = dvb.m_size/_decl.m_stride;
+			dvb.m_stride = _decl.m_stride;
 			dvb.m_decl = declHandle;
 			m_declRef.add(dvb.m_handle, declHandle, _decl.m_hash);
 
@@ -1807,18 +2540,25 @@ namespace bgfx
 			DynamicVertexBufferHandle handle = createDynamicVertexBuffer(_mem->size/_decl.m_stride, _decl);
 			if (isValid(handle) )
 			{
-				updateDynamicVertexBuffer(handle, _mem);
+				updateDynamicVertexBuffer(handle, 0, _mem);
 			}
 			return handle;
 		}
 
-		BGFX_API_FUNC(void updateDynamicVertexBuffer(DynamicVertexBufferHandle _handle, const Memory* _mem) )
+		BGFX_API_FUNC(void updateDynamicVertexBuffer(DynamicVertexBufferHandle _handle, uint32_t _startVertex, const Memory* _mem) )
 		{
 			DynamicVertexBuffer& dvb = m_dynamicVertexBuffers[_handle.idx];
+			const uint32_t offset = _startVertex*dvb.m_stride;
+			BX_CHECK(offset + _mem->size <= dvb.m_size, "Updating outside of dynamic vertex buffer (start %d, size %d, buffer size %d)."
+				, _startVertex
+				, _mem->size
+				, dvb.m_size
+				);
+
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::UpdateDynamicVertexBuffer);
 			cmdbuf.write(dvb.m_handle);
-			cmdbuf.write(dvb.m_offset);
-			cmdbuf.write(dvb.m_size);
+			cmdbuf.write(dvb.m_offset + offset);
+			cmdbuf.write(dvb.m_size - bx::uint32_min(offset, dvb.m_size) );
 			cmdbuf.write(_mem);
 		}
 
@@ -1831,20 +2571,23 @@ namespace bgfx
 		{
 			DynamicVertexBuffer& dvb = m_dynamicVertexBuffers[_handle.idx];
 
-			VertexDeclHandle declHandle = m_declRef.release(dvb.m_handle);
-			if (invalidHandle != declHandle.idx)
 			{
-				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyVertexDecl);
-				cmdbuf.write(declHandle);
+				bx::LwMutexScope resourceScope(m_resourceMutex);
+				VertexDeclHandle declHandle = m_declRef.release(dvb.m_handle);
+				if (invalidHandle != declHandle.idx)
+				{
+					CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyVertexDecl);
+					cmdbuf.write(declHandle);
+				}
 			}
 
 			m_dynamicVertexBufferAllocator.free(uint64_t(dvb.m_handle.idx)<<32 | dvb.m_offset);
 			m_dynamicVertexBufferHandle.free(_handle.idx);
 		}
 
-		BGFX_API_FUNC(bool checkAvailTransientIndexBuffer(uint32_t _num) const)
+		BGFX_API_FUNC(bool checkAvailTransientIndexBuffer(uint32_t _num, uint8_t _flags) const)
 		{
-			return m_submit->checkAvailTransientIndexBuffer(_num);
+			return m_submit->checkAvailTransientIndexBuffer(_num, _flags);
 		}
 
 		BGFX_API_FUNC(bool checkAvailTransientVertexBuffer(uint32_t _num, uint16_t _stride) const)
@@ -1852,7 +2595,7 @@ namespace bgfx
 			return m_submit->checkAvailTransientVertexBuffer(_num, _stride);
 		}
 
-		TransientIndexBuffer* createTransientIndexBuffer(uint32_t _size)
+		TransientIndexBuffer* createTransientIndexBuffer(uint32_t _size, uint8_t _flags = BGFX_BUFFER_NONE)
 		{
 			TransientIndexBuffer* ib = NULL;
 
@@ -1863,6 +2606,7 @@ namespace bgfx
 				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateDynamicIndexBuffer);
 				cmdbuf.write(handle);
 				cmdbuf.write(_size);
+				cmdbuf.write(_flags);
 
 				ib = (TransientIndexBuffer*)BX_ALLOC(g_allocator, sizeof(TransientIndexBuffer)+_size);
 				ib->data = (uint8_t*)&ib[1];
@@ -1882,16 +2626,18 @@ namespace bgfx
 			BX_FREE(g_allocator, const_cast<TransientIndexBuffer*>(_ib) );
 		}
 
-		BGFX_API_FUNC(void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num) )
+		BGFX_API_FUNC(void allocTransientIndexBuffer(TransientIndexBuffer* _tib, uint32_t _num, uint8_t _flags) )
 		{
-			uint32_t offset = m_submit->allocTransientIndexBuffer(_num);
+			uint32_t offset = m_submit->allocTransientIndexBuffer(_num, _flags);
 
-			TransientIndexBuffer& dib = *m_submit->m_transientIb;
+			const bool index32 = 0 != (_flags & BGFX_BUFFER_INDEX32);
+			const uint32_t indexSize = index32 ? sizeof(uint32_t) : sizeof(uint16_t);
+			TransientIndexBuffer& dib = index32 ? *m_submit->m_transientIb32 : *m_submit->m_transientIb;
 
 			_tib->data = &dib.data[offset];
-			_tib->size = _num * sizeof(uint16_t);
+			_tib->size = _num * indexSize;
 			_tib->handle = dib.handle;
-			_tib->startIndex = offset/sizeof(uint16_t);
+			_tib->startIndex = offset/indexSize;
 		}
 
 		TransientVertexBuffer* createTransientVertexBuffer(uint32_t _size, const VertexDecl* _decl = NULL)
@@ -1908,6 +2654,7 @@ namespace bgfx
 
 				if (NULL != _decl)
 				{
+					bx::LwMutexScope resourceScope(m_resourceMutex);
 					declHandle = findVertexDecl(*_decl);
 					m_declRef.add(handle, declHandle, _decl->m_hash);
 
@@ -1941,18 +2688,22 @@ namespace bgfx
 
 		BGFX_API_FUNC(void allocTransientVertexBuffer(TransientVertexBuffer* _tvb, uint32_t _num, const VertexDecl& _decl) )
 		{
-			VertexDeclHandle declHandle = m_declRef.find(_decl.m_hash);
-
 			TransientVertexBuffer& dvb = *m_submit->m_transientVb;
 
-			if (!isValid(declHandle) )
+			VertexDeclHandle declHandle;
 			{
-				VertexDeclHandle temp = { m_vertexDeclHandle.alloc() };
-				declHandle = temp;
-				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateVertexDecl);
-				cmdbuf.write(declHandle);
-				cmdbuf.write(_decl);
-				m_declRef.add(dvb.handle, declHandle, _decl.m_hash);
+				bx::LwMutexScope resourceScope(m_resourceMutex);
+				declHandle = m_declRef.find(_decl.m_hash);
+
+				if (!isValid(declHandle) )
+				{
+					VertexDeclHandle temp = { m_vertexDeclHandle.alloc() };
+					declHandle = temp;
+					CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateVertexDecl);
+					cmdbuf.write(declHandle);
+					cmdbuf.write(_decl);
+					m_declRef.add(dvb.handle, declHandle, _decl.m_hash);
+				}
 			}
 
 			uint32_t offset = m_submit->allocTransientVertexBuffer(_num, _decl.m_stride);
@@ -1965,13 +2716,27 @@ namespace bgfx
 			_tvb->decl = declHandle;
 		}
 
+		BGFX_API_FUNC(bool checkAvailInstanceDataBuffer(uint32_t _num, uint16_t _stride, uint16_t _numBuffers) )
+		{
+			return m_submit->checkAvailInstanceDataBuffer(_num, BX_ALIGN_16(_stride), _numBuffers);
+		}
+
 		BGFX_API_FUNC(const InstanceDataBuffer* allocInstanceDataBuffer(uint32_t _num, uint16_t _stride) )
 		{
+			InstanceDataBuffer* idb = m_submit->allocInstanceDataBuffer();
+			if (NULL == idb)
+			{
+				BX_WARN(false
+					, "Too many instance data buffers per frame (max: %d)."
+					, BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS
+					);
+				return NULL;
+			}
+
 			uint16_t stride = BX_ALIGN_16(_stride);
 			uint32_t offset = m_submit->allocTransientVertexBuffer(_num, stride);
 
 			TransientVertexBuffer& dvb = *m_submit->m_transientVb;
-			InstanceDataBuffer* idb = (InstanceDataBuffer*)BX_ALLOC(g_allocator, sizeof(InstanceDataBuffer) );
 			idb->data = &dvb.data[offset];
 			idb->size = _num * stride;
 			idb->offset = offset;
@@ -2143,6 +2908,7 @@ namespace bgfx
 
 		BGFX_API_FUNC(void destroyProgram(ProgramHandle _handle) )
 		{
+			BX_CHECK(!isDrawListReferenced(_handle), "Program %d is referenced by draw list.", _handle.idx);
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyProgram);
 			cmdbuf.write(_handle);
 			m_submit->free(_handle);
@@ -2193,9 +2959,10 @@ namespace bgfx
 
 		BGFX_API_FUNC(void destroyTexture(TextureHandle _handle) )
 		{
+			BX_CHECK(!isDrawListReferenced(_handle), "Texture %d is referenced by draw list.", _handle.idx);
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyTexture);
 			cmdbuf.write(_handle);
-			m_submit->free(_handle);
+			freeHandle(_handle);
 		}
 
 		BGFX_API_FUNC(void updateTexture(TextureHandle _handle, uint8_t _side, uint8_t _mip, uint16_t _x, uint16_t _y, uint16_t _z, uint16_t _width, uint16_t _height, uint16_t _depth, uint16_t _pitch, const Memory* _mem) )
@@ -2216,6 +2983,70 @@ namespace bgfx
 			cmdbuf.write(_mem);
 		}
 
+		BGFX_API_FUNC(TextureHandle createTextureStreaming(const Memory* _mem, uint32_t _flags, uint16_t _width, uint16_t _height, uint8_t _numMips, TextureFormat::Enum _format, uint8_t _baseMip) )
+		{
+			TextureHandle handle = createTexture(_mem, _flags, NULL);
+			if (isValid(handle) )
+			{
+				m_textureStreaming.create(handle, _width, _height, _numMips, _format, _baseMip, m_frames);
+			}
+
+			return handle;
+		}
+
+		BGFX_API_FUNC(void updateTextureStreaming(TextureHandle _handle, uint8_t _mip, const Memory* _mem) )
+		{
+			BX_CHECK(m_textureStreaming.isStreaming(_handle), "Texture %d is not streaming texture.", _handle.idx);
+			TextureStreaming::Texture& texture = m_textureStreaming.m_texture[_handle.idx];
+
+			if (_mip+1 != texture.m_lod)
+			{
+				BX_TRACE("Ignoring stale upload of mip %d for streaming texture %d (LOD %d)."
+					, _mip
+					, _handle.idx
+					, texture.m_lod
+					);
+				release(_mem);
+				return;
+			}
+
+			// Texture storage is grown to fit uploaded mip level first.
+			texture.m_lod = _mip;
+			updateTextureResidency(_handle, _mip);
+
+			const uint16_t width  = (uint16_t)bx::uint32_max(1, texture.m_width >>_mip);
+			const uint16_t height = (uint16_t)bx::uint32_max(1, texture.m_height>>_mip);
+			updateTexture(_handle, 0, _mip, 0, 0, 0, width, height, 1, UINT16_MAX, _mem);
+		}
+
+		void updateTextureResidency(TextureHandle _handle, uint8_t _lod)
+		{
+			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::UpdateTextureResidency);
+			cmdbuf.write(_handle);
+			cmdbuf.write(_lod);
+		}
+
+		BGFX_API_FUNC(void setTextureStreamingBudget(uint32_t _budget) )
+		{
+			m_textureStreaming.m_budget = _budget;
+		}
+
+		BGFX_API_FUNC(uint16_t getTextureStreamingRequests(TextureStreamRequest* _requests, uint16_t _max) )
+		{
+			uint16_t num = bx::uint16_min(_max, m_textureStreaming.m_numRequests);
+			memcpy(_requests, m_textureStreaming.m_request, num*sizeof(TextureStreamRequest) );
+			return num;
+		}
+
+		BGFX_API_FUNC(void getTextureStreamingStats(TextureStreamingStats& _stats) )
+		{
+			_stats.budget = m_textureStreaming.m_budget;
+			_stats.resident = m_textureStreaming.m_resident;
+			_stats.requested = m_textureStreaming.m_requested;
+			_stats.numTextures = m_textureStreaming.m_num;
+			_stats.numRequests = m_textureStreaming.m_numRequests;
+		}
+
 		BGFX_API_FUNC(RenderTargetHandle createRenderTarget(uint16_t _width, uint16_t _height, uint32_t _flags, uint32_t _textureFlags) )
 		{
 			RenderTargetHandle handle = { m_renderTargetHandle.alloc() };
@@ -2250,6 +3081,8 @@ namespace bgfx
 				return handle;
 			}
 
+			bx::LwMutexScope resourceScope(m_resourceMutex);
+
 			UniformHashMap::iterator it = m_uniformHashMap.find(_name);
 			if (it != m_uniformHashMap.end() )
 			{
@@ -2285,6 +3118,8 @@ namespace bgfx
 
 		BGFX_API_FUNC(void destroyUniform(UniformHandle _handle) )
 		{
+			bx::LwMutexScope resourceScope(m_resourceMutex);
+
 			UniformRef& uniform = m_uniformRef[_handle.idx];
 			BX_CHECK(uniform.m_refCount > 0, "Destroying already destroyed uniform %d.", _handle.idx);
 			int32_t refs = --uniform.m_refCount;
@@ -2293,7 +3128,7 @@ namespace bgfx
 			{
 				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyUniform);
 				cmdbuf.write(_handle);
-				m_submit->free(_handle);
+				freeHandle(_handle);
 			}
 		}
 
@@ -2314,6 +3149,11 @@ namespace bgfx
 			cmdbuf.write(_name, len);
 		}
 
+		BGFX_API_FUNC(void prewarmProgramCache() )
+		{
+			getCommandBuffer(CommandBuffer::PrewarmProgramCache);
+		}
+
 		BGFX_API_FUNC(void setViewRect(uint8_t _id, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height) )
 		{
 			Rect& rect = m_rect[_id];
@@ -2520,11 +3360,33 @@ namespace bgfx
 			m_submit->setVertexBuffer(_tvb, _numVertices);
 		}
 
+		BGFX_API_FUNC(void setVertexStream(uint8_t _stream, VertexBufferHandle _handle, uint32_t _startVertex) )
+		{
+			VertexDeclHandle decl = BGFX_INVALID_HANDLE;
+			m_submit->setStream(_stream, _handle, _startVertex, decl);
+		}
+
+		BGFX_API_FUNC(void setVertexStream(uint8_t _stream, DynamicVertexBufferHandle _handle) )
+		{
+			const DynamicVertexBuffer& dvb = m_dynamicVertexBuffers[_handle.idx];
+			m_submit->setStream(_stream, dvb.m_handle, dvb.m_startVertex, dvb.m_decl);
+		}
+
+		BGFX_API_FUNC(void setVertexStream(uint8_t _stream, const TransientVertexBuffer* _tvb) )
+		{
+			m_submit->setStream(_stream, _tvb->handle, _tvb->startVertex, _tvb->decl);
+		}
+
 		BGFX_API_FUNC(void setInstanceDataBuffer(const InstanceDataBuffer* _idb, uint16_t _num) )
 		{
 			m_submit->setInstanceDataBuffer(_idb, _num);
 		}
 
+		BGFX_API_FUNC(void setInstanceDataStream(uint8_t _stream, const InstanceDataBuffer* _idb) )
+		{
+			m_submit->setInstanceDataStream(_stream, _idb);
+		}
+
 		BGFX_API_FUNC(void setProgram(ProgramHandle _handle) )
 		{
 			m_submit->setProgram(_handle);
@@ -2532,6 +3394,11 @@ namespace bgfx
 
 		BGFX_API_FUNC(void setTexture(uint8_t _stage, UniformHandle _sampler, TextureHandle _handle, uint32_t _flags) )
 		{
+			if (isValid(_handle) )
+			{
+				m_textureStreaming.touch(_handle, m_frames);
+			}
+
 			m_submit->setTexture(_stage, _sampler, _handle, _flags);
 		}
 
@@ -2555,11 +3422,105 @@ namespace bgfx
 			m_submit->discard();
 		}
 
+		BGFX_API_FUNC(uint32_t submit(uint8_t _id, const SubmitArrays& _arrays) )
+		{
+			if (NULL != _arrays.texture)
+			{
+				for (uint32_t ii = 0, num = _arrays.num*_arrays.numSamplers; ii < num; ++ii)
+				{
+					if (isValid(_arrays.texture[ii]) )
+					{
+						m_textureStreaming.touch(_arrays.texture[ii], m_frames);
+					}
+				}
+			}
+
+			return m_submit->submit(_id, _arrays);
+		}
+
+#if BGFX_CONFIG_DEBUG
+		template <typename Ty>
+		bool isDrawListReferenced(Ty _handle)
+		{
+			// Draw lists are recorded on API thread, worker threads can't
+			// inspect them without racing with recording.
+			if (NULL != getThreadCommandBuffer() )
+			{
+				return false;
+			}
+
+			for (uint16_t ii = 0, num = m_drawListHandle.getNumHandles(); ii < num; ++ii)
+			{
+				if (m_drawList[m_drawListHandle.getHandleAt(ii)].isReferenced(_handle) )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+#endif // BGFX_CONFIG_DEBUG
+
+		BGFX_API_FUNC(DrawListHandle createDrawList() )
+		{
+			DrawListHandle handle = { m_drawListHandle.alloc() };
+			BX_WARN(isValid(handle), "Failed to allocate draw list handle.");
+
+			if (isValid(handle) )
+			{
+				m_drawList[handle.idx].init();
+			}
+
+			return handle;
+		}
+
+		BGFX_API_FUNC(void destroyDrawList(DrawListHandle _handle) )
+		{
+			BX_CHECK(_handle.idx != m_drawListRecord.idx, "Can't destroy draw list while it's being recorded.");
+
+			// Submitted draw lists are copied into frame, so draw list can
+			// be released immediately.
+			m_drawList[_handle.idx].destroy();
+			m_drawListHandle.free(_handle.idx);
+		}
+
+		BGFX_API_FUNC(void beginDrawList(DrawListHandle _handle) )
+		{
+			BX_CHECK(!isValid(m_drawListRecord), "Draw list %d is already being recorded.", m_drawListRecord.idx);
+			m_drawListRecord = _handle;
+			memcpy(m_drawListSeq, m_seq, sizeof(m_seq) );
+			m_submit->beginDrawList(m_drawList[_handle.idx]);
+		}
+
+		BGFX_API_FUNC(void endDrawList() )
+		{
+			BX_CHECK(isValid(m_drawListRecord), "endDrawList called without beginDrawList.");
+			m_submit->endDrawList(m_drawList[m_drawListRecord.idx]);
+
+			// Draw calls recorded into draw list don't advance view sequence.
+			memcpy(m_seq, m_drawListSeq, sizeof(m_seq) );
+			m_drawListRecord.idx = invalidHandle;
+		}
+
+		BGFX_API_FUNC(uint32_t submit(uint8_t _id, DrawListHandle _handle, const void* _mtx) )
+		{
+			BX_CHECK(!isValid(m_drawListRecord), "Can't submit draw list while recording draw list.");
+			const DrawList& list = m_drawList[_handle.idx];
+
+			for (uint32_t ii = 0; ii < list.m_numTextures; ++ii)
+			{
+				m_textureStreaming.touch(list.m_textures[ii], m_frames);
+			}
+
+			return m_submit->submit(_id, list, _mtx);
+		}
+
 		BGFX_API_FUNC(uint32_t frame() );
 
 		void dumpViewStats();
 		void freeDynamicBuffers();
 		void freeAllHandles(Frame* _frame);
+		void streamTextures();
 		void frameNoRenderWait();
 		void swap();
 
@@ -2568,11 +3529,11 @@ namespace bgfx
 		void rendererFlip();
 		void rendererInit();
 		void rendererShutdown();
-		void rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem);
+		void rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem, uint8_t _flags);
 		void rendererDestroyIndexBuffer(IndexBufferHandle _handle);
 		void rendererCreateVertexBuffer(VertexBufferHandle _handle, Memory* _mem, VertexDeclHandle _declHandle);
 		void rendererDestroyVertexBuffer(VertexBufferHandle _handle);
-		void rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size);
+		void rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size, uint8_t _flags);
 		void rendererUpdateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, Memory* _mem);
 		void rendererDestroyDynamicIndexBuffer(IndexBufferHandle _handle);
 		void rendererCreateDynamicVertexBuffer(VertexBufferHandle _handle, uint32_t _size);
@@ -2591,12 +3552,14 @@ namespace bgfx
 		void rendererUpdateTexture(TextureHandle _handle, uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem);
 		void rendererUpdateTextureEnd();
 		void rendererDestroyTexture(TextureHandle _handle);
+		void rendererUpdateTextureResidency(TextureHandle _handle, uint8_t _lod);
 		void rendererCreateRenderTarget(RenderTargetHandle _handle, uint16_t _width, uint16_t _height, uint32_t _flags, uint32_t _textureFlags);
 		void rendererDestroyRenderTarget(RenderTargetHandle _handle);
 		void rendererCreateUniform(UniformHandle _handle, UniformType::Enum _type, uint16_t _num, const char* _name);
 		void rendererDestroyUniform(UniformHandle _handle);
 		void rendererSaveScreenShot(const char* _filePath);
 		void rendererUpdateViewName(uint8_t _id, const char* _name);
+		void rendererPrewarmProgramCache();
 		void rendererUpdateUniform(uint16_t _loc, const void* _data, uint32_t _size);
 		void rendererSetMarker(const char* _marker, uint32_t _size);
 		void rendererUpdateUniforms(ConstantBuffer* _constantBuffer, uint32_t _begin, uint32_t _end);
@@ -2668,20 +3631,22 @@ namespace bgfx
 		DynamicVertexBufferHandle m_freeDynamicVertexBufferHandle[BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS];
 
 		NonLocalAllocator m_dynamicIndexBufferAllocator;
+		NonLocalAllocator m_dynamicIndexBuffer32Allocator;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_DYNAMIC_INDEX_BUFFERS> m_dynamicIndexBufferHandle;
 		NonLocalAllocator m_dynamicVertexBufferAllocator;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_DYNAMIC_VERTEX_BUFFERS> m_dynamicVertexBufferHandle;
 
-		bx::HandleAllocT<BGFX_CONFIG_MAX_INDEX_BUFFERS> m_indexBufferHandle;
-		bx::HandleAllocT<BGFX_CONFIG_MAX_VERTEX_DECLS > m_vertexDeclHandle;
+		HandleAllocMt<BGFX_CONFIG_MAX_INDEX_BUFFERS> m_indexBufferHandle;
+		HandleAllocMt<BGFX_CONFIG_MAX_VERTEX_DECLS> m_vertexDeclHandle;
 
-		bx::HandleAllocT<BGFX_CONFIG_MAX_VERTEX_BUFFERS> m_vertexBufferHandle;
+		HandleAllocMt<BGFX_CONFIG_MAX_VERTEX_BUFFERS> m_vertexBufferHandle;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_VERTEX_SHADERS> m_vertexShaderHandle;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_FRAGMENT_SHADERS> m_fragmentShaderHandle;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_PROGRAMS> m_programHandle;
-		bx::HandleAllocT<BGFX_CONFIG_MAX_TEXTURES> m_textureHandle;
+		HandleAllocMt<BGFX_CONFIG_MAX_TEXTURES> m_textureHandle;
 		bx::HandleAllocT<BGFX_CONFIG_MAX_RENDER_TARGETS> m_renderTargetHandle;
-		bx::HandleAllocT<BGFX_CONFIG_MAX_UNIFORMS> m_uniformHandle;
+		HandleAllocMt<BGFX_CONFIG_MAX_UNIFORMS> m_uniformHandle;
+		bx::HandleAllocT<BGFX_CONFIG_MAX_DRAW_LISTS> m_drawListHandle;
 
 		struct FragmentShaderRef
 		{
@@ -2716,6 +3681,12 @@ namespace bgfx
 		ProgramRef m_programRef[BGFX_CONFIG_MAX_PROGRAMS];
 		VertexDeclRef m_declRef;
 
+		// Guards vertex decl and uniform maps, which are shared with
+		// threads calling thread-safe resource API.
+		bx::LwMutex m_resourceMutex;
+		ThreadCommandBuffer m_threadCmd[BGFX_CONFIG_MAX_RESOURCE_THREADS];
+		volatile int32_t m_numResourceThreads;
+
 		RenderTargetHandle m_rt[BGFX_CONFIG_MAX_VIEWS];
 		Clear m_clear[BGFX_CONFIG_MAX_VIEWS];
 		Rect m_rect[BGFX_CONFIG_MAX_VIEWS];
@@ -2726,12 +3697,17 @@ namespace bgfx
 		uint16_t m_seq[BGFX_CONFIG_MAX_VIEWS];
 		uint16_t m_seqMask[BGFX_CONFIG_MAX_VIEWS];
 
+		DrawList m_drawList[BGFX_CONFIG_MAX_DRAW_LISTS];
+		DrawListHandle m_drawListRecord;
+		uint16_t m_drawListSeq[BGFX_CONFIG_MAX_VIEWS];
+
 		Resolution m_resolution;
 		uint32_t m_frames;
 		uint32_t m_debug;
 
 		TextVideoMemBlitter m_textVideoMemBlitter;
 		ClearQuad m_clearQuad;
+		TextureStreaming m_textureStreaming;
 
 		bool m_rendererInitialized;
 		bool m_exit;
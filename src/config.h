@@ -196,6 +196,17 @@
 #	define BGFX_CONFIG_MAX_UNIFORMS 512
 #endif // BGFX_CONFIG_MAX_CONSTANTS
 
+#ifndef BGFX_CONFIG_MAX_DRAW_LISTS
+#	define BGFX_CONFIG_MAX_DRAW_LISTS 256
+#endif // BGFX_CONFIG_MAX_DRAW_LISTS
+
+/// Number of command sub-buffers used by threads other than API thread
+/// calling thread-safe resource API. Threads beyond this number share
+/// sub-buffers.
+#ifndef BGFX_CONFIG_MAX_RESOURCE_THREADS
+#	define BGFX_CONFIG_MAX_RESOURCE_THREADS 4
+#endif // BGFX_CONFIG_MAX_RESOURCE_THREADS
+
 #ifndef BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE
 #	define BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE (64<<10)
 #endif // BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE
@@ -208,6 +219,13 @@
 #	define BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE (2<<20)
 #endif // BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE
 
+/// Size of transient index buffer used for 32-bit indices. D3D9 index
+/// buffer format is fixed at creation, so 32-bit indices can't share
+/// buffer with 16-bit indices.
+#ifndef BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE
+#	define BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE (1<<20)
+#endif // BGFX_CONFIG_TRANSIENT_INDEX_BUFFER32_SIZE
+
 #ifndef BGFX_CONFIG_MAX_CONSTANT_BUFFER_SIZE
 #	define BGFX_CONFIG_MAX_CONSTANT_BUFFER_SIZE (512<<10)
 #endif // BGFX_CONFIG_MAX_CONSTANT_BUFFER_SIZE
@@ -216,10 +234,48 @@
 #	define BGFX_CONFIG_USE_TINYSTL 1
 #endif // BGFX_CONFIG_USE_TINYSTL
 
+/// Maximum number of vec4 instance data attributes per draw call, summed
+/// over all instance data streams. Instance data attributes are i_data0 to
+/// i_data(N-1), bound to TEXCOORD(8-N) to TEXCOORD7, and shadow vertex
+/// attributes with the same semantic.
 #ifndef BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
-#	define BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT 5
+#	define BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT 8
 #endif // BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
 
+/// Maximum number of instance data streams per draw call.
+#ifndef BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS
+#	define BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS 2
+#endif // BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS
+
+/// Maximum number of instance data buffers allocated per frame.
+#ifndef BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS
+#	define BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS (4<<10)
+#endif // BGFX_CONFIG_MAX_INSTANCE_DATA_BUFFERS
+
+/// Maximum number of vertex streams per draw call, not counting instance
+/// data buffer.
+#ifndef BGFX_CONFIG_MAX_VERTEX_STREAMS
+#	define BGFX_CONFIG_MAX_VERTEX_STREAMS 4
+#endif // BGFX_CONFIG_MAX_VERTEX_STREAMS
+
+/// Default byte budget for resident mip levels of streaming textures, see
+/// setTextureStreamingBudget.
+#ifndef BGFX_CONFIG_TEXTURE_STREAMING_BUDGET
+#	define BGFX_CONFIG_TEXTURE_STREAMING_BUDGET (128<<20)
+#endif // BGFX_CONFIG_TEXTURE_STREAMING_BUDGET
+
+/// Number of frames streaming texture can stay unused before its finest
+/// resident mip level is dropped.
+#ifndef BGFX_CONFIG_TEXTURE_STREAMING_IDLE_FRAMES
+#	define BGFX_CONFIG_TEXTURE_STREAMING_IDLE_FRAMES 30
+#endif // BGFX_CONFIG_TEXTURE_STREAMING_IDLE_FRAMES
+
+/// Maximum number of worker threads kept by parallelFor, not counting
+/// calling thread.
+#ifndef BGFX_CONFIG_MAX_PARALLEL_THREADS
+#	define BGFX_CONFIG_MAX_PARALLEL_THREADS 15
+#endif // BGFX_CONFIG_MAX_PARALLEL_THREADS
+
 #ifndef BGFX_CONFIG_CLEAR_QUAD
 #	define BGFX_CONFIG_CLEAR_QUAD (BGFX_CONFIG_RENDERER_DIRECT3D11|BGFX_CONFIG_RENDERER_OPENGL)
 #endif // BGFX_CONFIG_CLEAR_QUAD
@@ -141,6 +141,7 @@ GL_IMPORT____(true,  PFNGLPROGRAMBINARYPROC,                     glProgramBinary
 GL_IMPORT____(true,  PFNGLPROGRAMPARAMETERIPROC,                 glProgramParameteri);
 
 GL_IMPORT____(true,  PFNGLBLITFRAMEBUFFERPROC,                   glBlitFramebuffer);
+GL_IMPORT____(true,  PFNGLCOPYIMAGESUBDATAPROC,                 glCopyImageSubData);
 
 GL_IMPORT____(true,  PFNGLQUERYCOUNTERPROC,                      glQueryCounter);
 GL_IMPORT____(true,  PFNGLGETQUERYOBJECTI64VPROC,                glGetQueryObjecti64v);
@@ -1043,6 +1043,7 @@ namespace bgfx
 		_imageContainer.m_hasAlpha = hasAlpha;
 		_imageContainer.m_cubeMap = cubeMap;
 		_imageContainer.m_ktx = false;
+		_imageContainer.m_baseMip = 0;
 
 		return TextureFormat::Unknown != format;
 	}
@@ -1195,6 +1196,7 @@ namespace bgfx
 		_imageContainer.m_hasAlpha = hasAlpha;
 		_imageContainer.m_cubeMap = numFaces > 1;
 		_imageContainer.m_ktx = true;
+		_imageContainer.m_baseMip = 0;
 
 		return TextureFormat::Unknown != format;
 	}
@@ -1320,6 +1322,7 @@ namespace bgfx
 		_imageContainer.m_hasAlpha = hasAlpha;
 		_imageContainer.m_cubeMap = numFaces > 1;
 		_imageContainer.m_ktx = false;
+		_imageContainer.m_baseMip = 0;
 
 		return TextureFormat::Unknown != format;
 	}
@@ -1371,6 +1374,7 @@ namespace bgfx
 			_imageContainer.m_hasAlpha = false;
 			_imageContainer.m_cubeMap = tc.m_cubeMap;
 			_imageContainer.m_ktx = false;
+			_imageContainer.m_baseMip = tc.m_baseMip;
 
 			return true;
 		}
@@ -1606,6 +1610,21 @@ namespace bgfx
 					height <<= 2;
 				}
 
+				if (lod < _imageContainer.m_baseMip)
+				{
+					// Mip levels above base mip are not part of data.
+					if (side == _side
+					&&  lod == _lod)
+					{
+						return false;
+					}
+
+					width  >>= 1;
+					height >>= 1;
+					depth  >>= 1;
+					continue;
+				}
+
 				if (side == _side
 				&&  lod == _lod)
 				{
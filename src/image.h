@@ -21,6 +21,7 @@ namespace bgfx
 		uint8_t m_format;
 		uint8_t m_blockSize;
 		uint8_t m_numMips;
+		uint8_t m_baseMip;
 		uint8_t m_bpp;
 		bool m_hasAlpha;
 		bool m_cubeMap;
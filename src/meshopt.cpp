@@ -0,0 +1,374 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <string.h>
+#include <alloca.h>
+#include <bx/allocator.h>
+#include <bx/debug.h>
+#include <bx/uint32_t.h>
+
+#include <bgfx.h>
+
+namespace bgfx
+{
+	extern bx::ReallocatorI* g_allocator;
+
+	static uint32_t alignScratch(uint32_t _size)
+	{
+		return (_size + 3) & ~3;
+	}
+
+	uint32_t getMeshOptimizeScratchSize(uint32_t _numIndices, uint32_t _numVertices)
+	{
+		// optimizeVertexCache needs most, everything else fits into it:
+		//   uint32_t indices[numIndices]
+		//   uint32_t adjacency[numIndices]
+		//   uint32_t deadEnd[numIndices]
+		//   uint32_t adjacencyStart[numVertices+1]
+		//   uint32_t liveCount[numVertices]
+		//   uint32_t timestamp[numVertices]
+		//   uint8_t  emitted[numTriangles]
+		return 3*_numIndices*sizeof(uint32_t)
+			+ (3*_numVertices+1)*sizeof(uint32_t)
+			+ alignScratch(_numIndices/3)
+			;
+	}
+
+	/// Scratch memory either provided by caller, or allocated for the
+	/// duration of call when caller passed NULL.
+	class MeshScratch
+	{
+	public:
+		MeshScratch(void* _scratch, uint32_t _size)
+			: m_alloc(NULL)
+		{
+			if (NULL == _scratch)
+			{
+				m_alloc = (uint8_t*)BX_ALLOC(g_allocator, _size);
+				_scratch = m_alloc;
+			}
+
+			m_ptr = (uint8_t*)_scratch;
+		}
+
+		~MeshScratch()
+		{
+			if (NULL != m_alloc)
+			{
+				BX_FREE(g_allocator, m_alloc);
+			}
+		}
+
+		template<typename Ty>
+		Ty* take(uint32_t _num)
+		{
+			Ty* result = (Ty*)m_ptr;
+			m_ptr += alignScratch(_num*sizeof(Ty) );
+			return result;
+		}
+
+	private:
+		uint8_t* m_alloc;
+		uint8_t* m_ptr;
+	};
+
+	/// Tipsify, "Fast Triangle Reordering for Vertex Locality and Reduced
+	/// Overdraw" by Sander, Nehab and Barczak. Triangles around fanning
+	/// vertex are emitted together, and next fanning vertex is picked among
+	/// just emitted vertices that will still be in FIFO cache after its
+	/// remaining triangles are emitted. Every triangle and vertex is
+	/// visited constant number of times.
+	template<typename Ty>
+	static void optimizeVertexCacheImpl(Ty* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		BX_CHECK(0 == _numIndices%3, "Number of indices must be multiple of 3 (numIndices %d).", _numIndices);
+
+		const uint32_t numTriangles = _numIndices/3;
+		if (0 == numTriangles)
+		{
+			return;
+		}
+
+		MeshScratch scratch(_scratch, getMeshOptimizeScratchSize(_numIndices, _numVertices) );
+		uint32_t* indices        = scratch.take<uint32_t>(_numIndices);
+		uint32_t* adjacency      = scratch.take<uint32_t>(_numIndices);
+		uint32_t* deadEnd        = scratch.take<uint32_t>(_numIndices);
+		uint32_t* adjacencyStart = scratch.take<uint32_t>(_numVertices+1);
+		uint32_t* liveCount      = scratch.take<uint32_t>(_numVertices);
+		uint32_t* timestamp      = scratch.take<uint32_t>(_numVertices);
+		uint8_t*  emitted        = scratch.take<uint8_t>(numTriangles);
+
+		memset(liveCount, 0, _numVertices*sizeof(uint32_t) );
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			const uint32_t index = _indices[ii];
+			BX_CHECK(index < _numVertices, "Index out of range (index %d, numVertices %d).", index, _numVertices);
+			indices[ii] = index;
+			liveCount[index]++;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			adjacencyStart[ii] = offset;
+			offset += liveCount[ii];
+		}
+		adjacencyStart[_numVertices] = offset;
+
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			adjacency[adjacencyStart[indices[ii] ]++] = ii/3;
+		}
+
+		// Filling moved every start to the end of its range, shift back.
+		for (uint32_t ii = _numVertices; ii > 0; --ii)
+		{
+			adjacencyStart[ii] = adjacencyStart[ii-1];
+		}
+		adjacencyStart[0] = 0;
+
+		memset(timestamp, 0, _numVertices*sizeof(uint32_t) );
+		memset(emitted, 0, numTriangles);
+
+		uint32_t time = _cacheSize+1;
+		uint32_t numDeadEnd = 0;
+		uint32_t cursor = 0;
+		uint32_t numOutput = 0;
+		uint32_t fanning = 0;
+
+		for (;;)
+		{
+			const uint32_t start = numOutput;
+
+			for (uint32_t ii = adjacencyStart[fanning], end = adjacencyStart[fanning+1]; ii < end; ++ii)
+			{
+				const uint32_t triangle = adjacency[ii];
+				if (0 != emitted[triangle])
+				{
+					continue;
+				}
+
+				emitted[triangle] = 1;
+
+				for (uint32_t jj = 0; jj < 3; ++jj)
+				{
+					const uint32_t index = indices[triangle*3+jj];
+					_indices[numOutput++] = Ty(index);
+					deadEnd[numDeadEnd++] = index;
+					liveCount[index]--;
+
+					if (time - timestamp[index] > _cacheSize)
+					{
+						timestamp[index] = time++;
+					}
+				}
+			}
+
+			// Prefer candidate that stays in cache after emitting its
+			// remaining triangles, and among those the oldest one.
+			uint32_t best = UINT32_MAX;
+			int32_t bestPriority = -1;
+			for (uint32_t ii = start; ii < numOutput; ++ii)
+			{
+				const uint32_t index = _indices[ii];
+				if (0 < liveCount[index])
+				{
+					const uint32_t age = time - timestamp[index];
+					const int32_t priority = age + 2*liveCount[index] <= _cacheSize ? int32_t(age) : 0;
+					if (priority > bestPriority)
+					{
+						best = index;
+						bestPriority = priority;
+					}
+				}
+			}
+
+			if (UINT32_MAX == best)
+			{
+				while (0 < numDeadEnd)
+				{
+					const uint32_t index = deadEnd[--numDeadEnd];
+					if (0 < liveCount[index])
+					{
+						best = index;
+						break;
+					}
+				}
+			}
+
+			if (UINT32_MAX == best)
+			{
+				for (; cursor < _numVertices; ++cursor)
+				{
+					if (0 < liveCount[cursor])
+					{
+						best = cursor;
+						break;
+					}
+				}
+			}
+
+			if (UINT32_MAX == best)
+			{
+				break;
+			}
+
+			fanning = best;
+		}
+
+		BX_CHECK(numOutput == numTriangles*3, "All triangles must be emitted (%d of %d).", numOutput/3, numTriangles);
+	}
+
+	void optimizeVertexCache(uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		optimizeVertexCacheImpl(_indices, _numIndices, _numVertices, _cacheSize, _scratch);
+	}
+
+	void optimizeVertexCache(uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		optimizeVertexCacheImpl(_indices, _numIndices, _numVertices, _cacheSize, _scratch);
+	}
+
+	template<typename Ty>
+	static uint32_t optimizeVertexFetchImpl(uint32_t* _remap, const Ty* _indices, uint32_t _numIndices, uint32_t _numVertices)
+	{
+		memset(_remap, 0xff, _numVertices*sizeof(uint32_t) );
+
+		uint32_t numUsed = 0;
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			const uint32_t index = _indices[ii];
+			BX_CHECK(index < _numVertices, "Index out of range (index %d, numVertices %d).", index, _numVertices);
+
+			if (UINT32_MAX == _remap[index])
+			{
+				_remap[index] = numUsed++;
+			}
+		}
+
+		uint32_t next = numUsed;
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			if (UINT32_MAX == _remap[ii])
+			{
+				_remap[ii] = next++;
+			}
+		}
+
+		return numUsed;
+	}
+
+	uint32_t optimizeVertexFetch(uint32_t* _remap, const uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
+	{
+		return optimizeVertexFetchImpl(_remap, _indices, _numIndices, _numVertices);
+	}
+
+	uint32_t optimizeVertexFetch(uint32_t* _remap, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
+	{
+		return optimizeVertexFetchImpl(_remap, _indices, _numIndices, _numVertices);
+	}
+
+	void remapIndices(uint16_t* _indices, uint32_t _numIndices, const uint32_t* _remap)
+	{
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			BX_CHECK(_remap[_indices[ii] ] <= UINT16_MAX, "Remapped index doesn't fit 16 bits (index %d).", _remap[_indices[ii] ]);
+			_indices[ii] = uint16_t(_remap[_indices[ii] ]);
+		}
+	}
+
+	void remapIndices(uint32_t* _indices, uint32_t _numIndices, const uint32_t* _remap)
+	{
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			_indices[ii] = _remap[_indices[ii] ];
+		}
+	}
+
+	void remapVertices(const VertexDecl& _decl, void* _data, uint32_t _numVertices, const uint32_t* _remap, void* _scratch)
+	{
+		const uint32_t stride = _decl.m_stride;
+		uint8_t* data = (uint8_t*)_data;
+
+		MeshScratch scratch(_scratch, getMeshOptimizeScratchSize(0, _numVertices) );
+		uint32_t* moved = scratch.take<uint32_t>( (_numVertices+31)/32);
+		memset(moved, 0, (_numVertices+31)/32*sizeof(uint32_t) );
+
+		uint8_t* carry = (uint8_t*)alloca(stride*2);
+		uint8_t* swap = carry + stride;
+
+		// Follow every permutation cycle once, carrying displaced vertex
+		// to its destination.
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			if (0 != (moved[ii>>5] & (1u<<(ii&31) ) ) )
+			{
+				continue;
+			}
+
+			memcpy(carry, &data[ii*stride], stride);
+
+			for (uint32_t dest = _remap[ii]; ; dest = _remap[dest])
+			{
+				BX_CHECK(dest < _numVertices, "Remap must be permutation (remap %d, numVertices %d).", dest, _numVertices);
+				BX_CHECK(0 == (moved[dest>>5] & (1u<<(dest&31) ) ) || dest == ii, "Remap must be permutation (vertex %d remapped twice).", dest);
+				moved[dest>>5] |= 1u<<(dest&31);
+
+				if (dest == ii)
+				{
+					memcpy(&data[dest*stride], carry, stride);
+					break;
+				}
+
+				memcpy(swap, &data[dest*stride], stride);
+				memcpy(&data[dest*stride], carry, stride);
+				memcpy(carry, swap, stride);
+			}
+		}
+	}
+
+	template<typename Ty>
+	static float getVertexCacheAcmrImpl(const Ty* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		const uint32_t numTriangles = _numIndices/3;
+		if (0 == numTriangles)
+		{
+			return 0.0f;
+		}
+
+		MeshScratch scratch(_scratch, getMeshOptimizeScratchSize(0, _numVertices) );
+		uint32_t* timestamp = scratch.take<uint32_t>(_numVertices);
+		memset(timestamp, 0, _numVertices*sizeof(uint32_t) );
+
+		// FIFO cache simulated with timestamps, vertex is in cache while
+		// less than cache size misses happened after it was inserted.
+		uint32_t time = _cacheSize+1;
+		uint32_t numMisses = 0;
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			const uint32_t index = _indices[ii];
+			BX_CHECK(index < _numVertices, "Index out of range (index %d, numVertices %d).", index, _numVertices);
+
+			if (time - timestamp[index] > _cacheSize)
+			{
+				timestamp[index] = time++;
+				++numMisses;
+			}
+		}
+
+		return float(numMisses)/float(numTriangles);
+	}
+
+	float getVertexCacheAcmr(const uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		return getVertexCacheAcmrImpl(_indices, _numIndices, _numVertices, _cacheSize, _scratch);
+	}
+
+	float getVertexCacheAcmr(const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize, void* _scratch)
+	{
+		return getVertexCacheAcmrImpl(_indices, _numIndices, _numVertices, _cacheSize, _scratch);
+	}
+
+} // namespace bgfx
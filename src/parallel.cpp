@@ -0,0 +1,147 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <bx/bx.h>
+#include <bx/cpu.h>
+#include <bx/sem.h>
+#include <bx/thread.h>
+
+#include <bgfx.h>
+#include "config.h"
+
+namespace bgfx
+{
+	struct ParallelForJob
+	{
+		ParallelForFn m_fn;
+		void* m_userData;
+		uint32_t m_num;
+		volatile int32_t m_next;
+	};
+
+	static void parallelForRun(ParallelForJob* _job)
+	{
+		for (uint32_t index = (uint32_t)bx::atomicFetchAndAdd(&_job->m_next, 1)
+			; index < _job->m_num
+			; index = (uint32_t)bx::atomicFetchAndAdd(&_job->m_next, 1)
+			)
+		{
+			_job->m_fn(index, _job->m_userData);
+		}
+	}
+
+	/// Worker threads are created on demand and kept alive between calls,
+	/// each call wakes as many of them as it needs.
+	class ParallelForPool
+	{
+	public:
+		ParallelForPool()
+			: m_job(NULL)
+			, m_num(0)
+			, m_busy(0)
+			, m_exit(false)
+		{
+		}
+
+		~ParallelForPool()
+		{
+			m_exit = true;
+			m_start.post(m_num);
+
+			for (uint32_t ii = 0; ii < m_num; ++ii)
+			{
+				m_thread[ii].shutdown();
+			}
+		}
+
+		bool tryAcquire()
+		{
+			return 0 == bx::atomicCompareAndSwap(&m_busy, 0, 1);
+		}
+
+		void release()
+		{
+			bx::atomicCompareAndSwap(&m_busy, 1, 0);
+		}
+
+		void run(ParallelForJob* _job, uint32_t _numWorkers)
+		{
+			const uint32_t numWorkers = _numWorkers < BGFX_CONFIG_MAX_PARALLEL_THREADS
+				? _numWorkers
+				: BGFX_CONFIG_MAX_PARALLEL_THREADS
+				;
+
+			for (; m_num < numWorkers; ++m_num)
+			{
+				m_thread[m_num].init(workerThread, this);
+			}
+
+			m_job = _job;
+			m_start.post(numWorkers);
+
+			parallelForRun(_job);
+
+			for (uint32_t ii = 0; ii < numWorkers; ++ii)
+			{
+				m_done.wait();
+			}
+
+			m_job = NULL;
+		}
+
+	private:
+		static int32_t workerThread(void* _userData)
+		{
+			ParallelForPool* pool = (ParallelForPool*)_userData;
+
+			for (;;)
+			{
+				pool->m_start.wait();
+
+				if (pool->m_exit)
+				{
+					break;
+				}
+
+				parallelForRun(pool->m_job);
+				pool->m_done.post();
+			}
+
+			return 0;
+		}
+
+		bx::Thread m_thread[BGFX_CONFIG_MAX_PARALLEL_THREADS];
+		bx::Semaphore m_start;
+		bx::Semaphore m_done;
+		ParallelForJob* volatile m_job;
+		uint32_t m_num;
+		volatile int32_t m_busy;
+		volatile bool m_exit;
+	};
+
+	static ParallelForPool s_parallelForPool;
+
+	void parallelFor(uint32_t _num, ParallelForFn _fn, void* _userData, uint32_t _numThreads)
+	{
+		const uint32_t numThreads = _numThreads < _num ? _numThreads : _num;
+
+		ParallelForJob job;
+		job.m_fn = _fn;
+		job.m_userData = _userData;
+		job.m_num = _num;
+		job.m_next = 0;
+
+		if (1 >= numThreads
+		||  !s_parallelForPool.tryAcquire() )
+		{
+			parallelForRun(&job);
+			return;
+		}
+
+		s_parallelForPool.run(&job, numThreads-1);
+		s_parallelForPool.release();
+	}
+
+} // namespace bgfx
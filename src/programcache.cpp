@@ -0,0 +1,463 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "bgfx_p.h"
+#include "programcache.h"
+
+#if BX_PLATFORM_WINDOWS
+	// windows.h is already included by bgfx_p.h.
+#elif BX_PLATFORM_NACL || BX_PLATFORM_EMSCRIPTEN || BX_PLATFORM_XBOX360
+	// Memory mapping is not available, cache is read into memory.
+#else
+#	define BGFX_PROGRAM_CACHE_MMAP 1
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif // BX_PLATFORM_
+
+namespace bgfx
+{
+	static const uint8_t s_zero[8] = {};
+
+	static uint32_t recordSize(uint32_t _size)
+	{
+		return sizeof(ProgramCacheRecord) + BX_ALIGN_MASK(_size, 7);
+	}
+
+	ProgramCache::ProgramCache()
+		: m_file(NULL)
+		, m_data(NULL)
+		, m_mappedSize(0)
+		, m_size(0)
+		, m_live(0)
+		, m_stale(0)
+		, m_hash(0)
+#if BX_PLATFORM_WINDOWS
+		, m_mapFile(INVALID_HANDLE_VALUE)
+		, m_mapping(NULL)
+#endif // BX_PLATFORM_WINDOWS
+		, m_damaged(false)
+	{
+		m_filePath[0] = '\0';
+	}
+
+	ProgramCache::~ProgramCache()
+	{
+		close();
+	}
+
+	bool ProgramCache::open(const char* _filePath, uint64_t _hash)
+	{
+		close();
+
+		bx::strlcpy(m_filePath, _filePath, BX_COUNTOF(m_filePath) );
+		m_hash = _hash;
+
+		bool valid = false;
+
+		if (map() )
+		{
+			const ProgramCacheHeader* header = (const ProgramCacheHeader*)m_data;
+			valid = sizeof(ProgramCacheHeader) <= m_mappedSize
+				&& BGFX_PROGRAM_CACHE_MAGIC == header->magic
+				&& BGFX_PROGRAM_CACHE_VERSION == header->version
+				&& _hash == header->hash
+				;
+		}
+
+		if (valid)
+		{
+			// Sizes are compared against remaining bytes, damaged record
+			// size must not wrap offset around.
+			uint32_t offset = sizeof(ProgramCacheHeader);
+			while (sizeof(ProgramCacheRecord) <= m_mappedSize - offset)
+			{
+				const ProgramCacheRecord* record = (const ProgramCacheRecord*)&m_data[offset];
+				const uint64_t size = sizeof(ProgramCacheRecord) + BX_ALIGN_MASK(uint64_t(record->size), 7);
+				if (size > m_mappedSize - offset)
+				{
+					break;
+				}
+
+				Entry entry;
+				entry.m_offset = offset + sizeof(ProgramCacheRecord);
+				entry.m_size = record->size;
+
+				EntryMap::iterator it = m_entries.find(record->id);
+				if (it != m_entries.end() )
+				{
+					m_stale += it->second.m_size;
+					m_live  -= it->second.m_size;
+					it->second = entry;
+				}
+				else
+				{
+					m_entries.insert(stl::make_pair(record->id, entry) );
+				}
+				m_live += entry.m_size;
+
+				offset += uint32_t(size);
+			}
+
+			m_size = offset;
+			m_damaged = offset != m_mappedSize;
+
+			m_file = fopen(m_filePath, "ab");
+		}
+		else
+		{
+			// Cache doesn't exist, or it was created by different driver.
+			// Programs binaries are not portable, start from scratch.
+			unmap();
+
+			m_file = fopen(m_filePath, "wb");
+			if (NULL != m_file)
+			{
+				ProgramCacheHeader header;
+				header.magic = BGFX_PROGRAM_CACHE_MAGIC;
+				header.version = BGFX_PROGRAM_CACHE_VERSION;
+				header.hash = _hash;
+				fwrite(&header, 1, sizeof(header), m_file);
+				fflush(m_file);
+				m_size = sizeof(header);
+			}
+		}
+
+		if (NULL == m_file)
+		{
+			BX_WARN(false, "Unable to open program cache '%s'.", m_filePath);
+			close();
+			return false;
+		}
+
+		BX_TRACE("Program cache '%s': %d programs, %d bytes, %d bytes stale."
+			, m_filePath
+			, (uint32_t)m_entries.size()
+			, m_live
+			, m_stale
+			);
+
+		if (m_damaged)
+		{
+			// Anything appended after damaged tail would be lost on next
+			// open.
+			BX_TRACE("Program cache '%s' is damaged, compacting.", m_filePath);
+			compact();
+		}
+
+		return true;
+	}
+
+	void ProgramCache::close()
+	{
+		if (NULL != m_file
+		&&  (m_damaged || m_stale > m_live) )
+		{
+			compact();
+		}
+
+		if (NULL != m_file)
+		{
+			fclose(m_file);
+			m_file = NULL;
+		}
+
+		unmap();
+
+		m_entries.clear();
+		m_size = 0;
+		m_live = 0;
+		m_stale = 0;
+		m_damaged = false;
+	}
+
+	void ProgramCache::compact()
+	{
+		if (NULL == m_file)
+		{
+			return;
+		}
+
+		char tmpFilePath[BX_COUNTOF(m_filePath)+4];
+		bx::snprintf(tmpFilePath, BX_COUNTOF(tmpFilePath), "%s.tmp", m_filePath);
+
+		FILE* file = fopen(tmpFilePath, "wb");
+		if (NULL == file)
+		{
+			BX_WARN(false, "Unable to compact program cache '%s'.", m_filePath);
+			return;
+		}
+
+		ProgramCacheHeader header;
+		header.magic = BGFX_PROGRAM_CACHE_MAGIC;
+		header.version = BGFX_PROGRAM_CACHE_VERSION;
+		header.hash = m_hash;
+		fwrite(&header, 1, sizeof(header), file);
+
+		uint32_t offset = sizeof(header);
+		uint32_t maxSize = 0;
+		void* data = NULL;
+
+		for (EntryMap::iterator it = m_entries.begin(), itEnd = m_entries.end(); it != itEnd; ++it)
+		{
+			Entry& entry = it->second;
+
+			if (maxSize < entry.m_size)
+			{
+				maxSize = entry.m_size;
+				data = BX_REALLOC(g_allocator, data, maxSize);
+			}
+
+			if (!readAt(entry.m_offset, data, entry.m_size) )
+			{
+				// Keep empty record, zero size is treated as cache miss.
+				m_live -= entry.m_size;
+				entry.m_size = 0;
+			}
+
+			ProgramCacheRecord record;
+			record.id = it->first;
+			record.size = entry.m_size;
+			record.reserved = 0;
+			fwrite(&record, 1, sizeof(record), file);
+			fwrite(data, 1, entry.m_size, file);
+			fwrite(s_zero, 1, recordSize(entry.m_size) - sizeof(record) - entry.m_size, file);
+
+			entry.m_offset = offset + sizeof(record);
+			offset += recordSize(entry.m_size);
+		}
+
+		if (NULL != data)
+		{
+			BX_FREE(g_allocator, data);
+		}
+
+		fclose(file);
+		fclose(m_file);
+		m_file = NULL;
+		unmap();
+
+		remove(m_filePath);
+		if (0 != rename(tmpFilePath, m_filePath) )
+		{
+			BX_WARN(false, "Unable to replace program cache '%s'.", m_filePath);
+			m_entries.clear();
+			m_live = 0;
+			m_stale = 0;
+			m_size = 0;
+			m_damaged = false;
+			return;
+		}
+
+		BX_TRACE("Program cache '%s' compacted %d -> %d bytes.", m_filePath, m_size, offset);
+
+		m_size = offset;
+		m_stale = 0;
+		m_damaged = false;
+
+		map();
+		m_file = fopen(m_filePath, "ab");
+	}
+
+	uint32_t ProgramCache::readSize(uint64_t _id) const
+	{
+		EntryMap::const_iterator it = m_entries.find(_id);
+		if (it != m_entries.end() )
+		{
+			return it->second.m_size;
+		}
+
+		return 0;
+	}
+
+	bool ProgramCache::read(uint64_t _id, void* _data, uint32_t _size) const
+	{
+		EntryMap::const_iterator it = m_entries.find(_id);
+		if (it != m_entries.end()
+		&&  _size <= it->second.m_size)
+		{
+			return readAt(it->second.m_offset, _data, _size);
+		}
+
+		return false;
+	}
+
+	void ProgramCache::write(uint64_t _id, const void* _data, uint32_t _size)
+	{
+		// Offsets of damaged tail are unknown, don't append until file is
+		// compacted.
+		if (NULL == m_file
+		||  m_damaged)
+		{
+			return;
+		}
+
+		ProgramCacheRecord record;
+		record.id = _id;
+		record.size = _size;
+		record.reserved = 0;
+
+		const uint32_t size = recordSize(_size);
+		bool ok = true
+			&& sizeof(record) == fwrite(&record, 1, sizeof(record), m_file)
+			&& _size == fwrite(_data, 1, _size, m_file)
+			&& size - sizeof(record) - _size == fwrite(s_zero, 1, size - sizeof(record) - _size, m_file)
+			;
+		fflush(m_file);
+
+		if (!ok)
+		{
+			BX_WARN(false, "Failed to write program cache '%s'.", m_filePath);
+			m_damaged = true;
+			return;
+		}
+
+		Entry entry;
+		entry.m_offset = m_size + sizeof(record);
+		entry.m_size = _size;
+
+		EntryMap::iterator it = m_entries.find(_id);
+		if (it != m_entries.end() )
+		{
+			m_stale += it->second.m_size;
+			m_live  -= it->second.m_size;
+			it->second = entry;
+		}
+		else
+		{
+			m_entries.insert(stl::make_pair(_id, entry) );
+		}
+
+		m_live += _size;
+		m_size += size;
+	}
+
+	bool ProgramCache::map()
+	{
+		unmap();
+
+#if BX_PLATFORM_WINDOWS
+		m_mapFile = CreateFileA(m_filePath, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (INVALID_HANDLE_VALUE == m_mapFile)
+		{
+			return false;
+		}
+
+		m_mappedSize = GetFileSize(m_mapFile, NULL);
+		if (0 < m_mappedSize)
+		{
+			m_mapping = CreateFileMappingA(m_mapFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (NULL != m_mapping)
+			{
+				m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			}
+		}
+#elif BGFX_PROGRAM_CACHE_MMAP
+		int fd = ::open(m_filePath, O_RDONLY);
+		if (-1 == fd)
+		{
+			return false;
+		}
+
+		struct stat st;
+		if (0 == fstat(fd, &st)
+		&&  0 < st.st_size)
+		{
+			m_mappedSize = (uint32_t)st.st_size;
+			void* ptr = mmap(NULL, m_mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			m_data = MAP_FAILED == ptr ? NULL : (const uint8_t*)ptr;
+		}
+		::close(fd);
+#else
+		FILE* file = fopen(m_filePath, "rb");
+		if (NULL == file)
+		{
+			return false;
+		}
+
+		fseek(file, 0L, SEEK_END);
+		m_mappedSize = (uint32_t)ftell(file);
+		fseek(file, 0L, SEEK_SET);
+		if (0 < m_mappedSize)
+		{
+			uint8_t* data = (uint8_t*)BX_ALLOC(g_allocator, m_mappedSize);
+			if (m_mappedSize == fread(data, 1, m_mappedSize, file) )
+			{
+				m_data = data;
+			}
+			else
+			{
+				BX_FREE(g_allocator, data);
+			}
+		}
+		fclose(file);
+#endif // BX_PLATFORM_
+
+		if (NULL == m_data)
+		{
+			unmap();
+			return false;
+		}
+
+		return true;
+	}
+
+	void ProgramCache::unmap()
+	{
+		if (NULL != m_data)
+		{
+#if BX_PLATFORM_WINDOWS
+			UnmapViewOfFile(m_data);
+#elif BGFX_PROGRAM_CACHE_MMAP
+			munmap(const_cast<uint8_t*>(m_data), m_mappedSize);
+#else
+			BX_FREE(g_allocator, const_cast<uint8_t*>(m_data) );
+#endif // BX_PLATFORM_
+		}
+
+#if BX_PLATFORM_WINDOWS
+		if (NULL != m_mapping)
+		{
+			CloseHandle(m_mapping);
+			m_mapping = NULL;
+		}
+
+		if (INVALID_HANDLE_VALUE != m_mapFile)
+		{
+			CloseHandle(m_mapFile);
+			m_mapFile = INVALID_HANDLE_VALUE;
+		}
+#endif // BX_PLATFORM_WINDOWS
+
+		m_data = NULL;
+		m_mappedSize = 0;
+	}
+
+	bool ProgramCache::readAt(uint32_t _offset, void* _data, uint32_t _size) const
+	{
+		if (_offset <= m_mappedSize
+		&&  _size   <= m_mappedSize - _offset)
+		{
+			memcpy(_data, &m_data[_offset], _size);
+			return true;
+		}
+
+		// Record was appended after file was mapped.
+		FILE* file = fopen(m_filePath, "rb");
+		if (NULL == file)
+		{
+			return false;
+		}
+
+		bool ok = 0 == fseek(file, _offset, SEEK_SET)
+			&& _size == fread(_data, 1, _size, file)
+			;
+		fclose(file);
+
+		return ok;
+	}
+
+} // namespace bgfx
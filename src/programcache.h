@@ -0,0 +1,113 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef BGFX_PROGRAMCACHE_H_HEADER_GUARD
+#define BGFX_PROGRAMCACHE_H_HEADER_GUARD
+
+#include "bgfx_p.h"
+
+#define BGFX_PROGRAM_CACHE_MAGIC BX_MAKEFOURCC('B', 'P', 'C', 0x0)
+#define BGFX_PROGRAM_CACHE_VERSION 1
+
+namespace bgfx
+{
+	/// Cache file layout:
+	///
+	///   ProgramCacheHeader
+	///   ProgramCacheRecord followed by record data, padded to 8 bytes
+	///   ...
+	///
+	/// Records are only appended. When the same id is written more than
+	/// once, the last record wins. Index is rebuilt on open by walking
+	/// record headers in the mapped file.
+	///
+	struct ProgramCacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t hash;
+	};
+
+	struct ProgramCacheRecord
+	{
+		uint64_t id;
+		uint32_t size;
+		uint32_t reserved;
+	};
+
+	/// Program binary cache stored in single append-only file.
+	///
+	class ProgramCache
+	{
+	public:
+		struct Entry
+		{
+			uint32_t m_offset;
+			uint32_t m_size;
+		};
+
+		typedef stl::unordered_map<uint64_t, Entry> EntryMap;
+
+		ProgramCache();
+		~ProgramCache();
+
+		/// Map cache file and build index. If file doesn't exist, or was
+		/// written by renderer with different hash, cache starts empty.
+		///
+		/// @param _filePath Cache file path.
+		/// @param _hash Renderer hash (GPU vendor, renderer, driver version).
+		///
+		bool open(const char* _filePath, uint64_t _hash);
+
+		/// Unmap cache file. If cache contains more stale than live data,
+		/// or tail of file is damaged, file is compacted before it's closed.
+		void close();
+
+		/// Rewrite cache file with only live records.
+		void compact();
+
+		bool isOpen() const
+		{
+			return NULL != m_file;
+		}
+
+		/// Returns size of cached data or 0 if id is not in cache.
+		uint32_t readSize(uint64_t _id) const;
+
+		/// Read cached data.
+		bool read(uint64_t _id, void* _data, uint32_t _size) const;
+
+		/// Append data to cache.
+		void write(uint64_t _id, const void* _data, uint32_t _size);
+
+		const EntryMap& getEntries() const
+		{
+			return m_entries;
+		}
+
+	private:
+		bool map();
+		void unmap();
+		bool readAt(uint32_t _offset, void* _data, uint32_t _size) const;
+
+		char m_filePath[512];
+		EntryMap m_entries;
+		FILE* m_file;
+		const uint8_t* m_data;
+		uint32_t m_mappedSize;
+		uint32_t m_size;
+		uint32_t m_live;
+		uint32_t m_stale;
+		uint64_t m_hash;
+#if BX_PLATFORM_WINDOWS
+		HANDLE m_mapFile;
+		HANDLE m_mapping;
+#endif // BX_PLATFORM_WINDOWS
+		bool m_damaged;
+	};
+
+} // namespace bgfx
+
+#endif // BGFX_PROGRAMCACHE_H_HEADER_GUARD
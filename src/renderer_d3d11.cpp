@@ -516,6 +516,8 @@ namespace bgfx
 								| BGFX_CAPS_TEXTURE_DEPTH_MASK
 								| BGFX_CAPS_VERTEX_ATTRIB_HALF
 								| BGFX_CAPS_FRAGMENT_DEPTH
+								| BGFX_CAPS_INDEX32
+								| BGFX_CAPS_TEXTURE_RESIDENCY
 								);
 			g_caps.maxTextureSize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
 
@@ -786,34 +788,87 @@ namespace bgfx
 			}
 		}
 
-		void setInputLayout(const VertexDecl& _vertexDecl, const Program& _program, uint8_t _numInstanceData)
+		void setInputLayout(const VertexDecl* const* _decls, uint8_t _numStreams, const Program& _program, const InstanceDataStream* _instanceData, uint8_t _numInstanceDataStreams)
 		{
-			uint64_t layoutHash = (uint64_t(_vertexDecl.m_hash)<<32) | _program.m_vsh->m_hash;
-			layoutHash ^= _numInstanceData;
+			bx::HashMurmur2A murmur;
+			murmur.begin();
+			for (uint8_t stream = 0; stream < _numStreams; ++stream)
+			{
+				murmur.add(_decls[stream]->m_hash);
+			}
+			murmur.add(_program.m_vsh->m_hash);
+
+			uint32_t numInstanceData = 0;
+			for (uint8_t stream = 0; stream < _numInstanceDataStreams; ++stream)
+			{
+				murmur.add(_instanceData[stream].m_stride);
+				numInstanceData += _instanceData[stream].m_stride/16;
+			}
+			murmur.add(_numInstanceDataStreams);
+			uint64_t layoutHash = (uint64_t(_numStreams)<<32) | murmur.end();
+
 			ID3D11InputLayout* layout = m_inputLayoutCache.find(layoutHash);
 			if (NULL == layout)
 			{
-				D3D11_INPUT_ELEMENT_DESC vertexElements[Attrib::Count+1+BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
+				D3D11_INPUT_ELEMENT_DESC vertexElements[Attrib::Count*BGFX_CONFIG_MAX_VERTEX_STREAMS+1+BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
+				D3D11_INPUT_ELEMENT_DESC* elem = vertexElements;
 
-				VertexDecl decl;
-				memcpy(&decl, &_vertexDecl, sizeof(VertexDecl) );
 				const uint8_t* attrMask = _program.m_vsh->m_attrMask;
 
-				for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
+				for (uint8_t stream = 0; stream < _numStreams; ++stream)
 				{
-					uint8_t mask = attrMask[ii];
-					uint8_t attr = (decl.m_attributes[ii] & mask);
-					decl.m_attributes[ii] = attr == 0 ? 0xff : attr == 0xff ? 0 : attr;
+					VertexDecl decl;
+					memcpy(&decl, _decls[stream], sizeof(VertexDecl) );
+
+					for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
+					{
+						uint8_t mask = attrMask[ii];
+						uint8_t attr = (decl.m_attributes[ii] & mask);
+
+						if (0 == attr)
+						{
+							attr = 0xff;
+						}
+						else if (0xff == attr)
+						{
+							// Attribute used by shader, but not provided by any
+							// stream, is bound as dummy in first stream.
+							bool provided = 0 != stream;
+							for (uint8_t other = 1; other < _numStreams && !provided; ++other)
+							{
+								provided = 0xff != _decls[other]->m_attributes[ii];
+							}
+
+							attr = provided ? 0xff : 0;
+						}
+
+						decl.m_attributes[ii] = attr;
+					}
+
+					D3D11_INPUT_ELEMENT_DESC* first = elem;
+					elem = fillVertexDecl(elem, decl);
+
+					for (; first != elem; ++first)
+					{
+						first->InputSlot = stream;
+					}
 				}
 
-				D3D11_INPUT_ELEMENT_DESC* elem = fillVertexDecl(vertexElements, decl);
 				uint32_t num = uint32_t(elem-vertexElements);
 
 				const D3D11_INPUT_ELEMENT_DESC inst = { "TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 };
 
-				for (uint32_t ii = 0; ii < _numInstanceData; ++ii)
+				// Instance data attributes are numbered consecutively over
+				// streams.
+				for (uint32_t ii = 0, stream = 0, offset = 0; ii < numInstanceData; ++ii, offset += 16)
 				{
-					uint32_t index = 8-_numInstanceData+ii;
+					while (offset == _instanceData[stream].m_stride)
+					{
+						++stream;
+						offset = 0;
+					}
+
+					uint32_t index = 8-numInstanceData+ii;
 
 					uint32_t jj;
 					D3D11_INPUT_ELEMENT_DESC* curr = vertexElements;
@@ -834,9 +889,9 @@ namespace bgfx
 					}
 
 					memcpy(curr, &inst, sizeof(D3D11_INPUT_ELEMENT_DESC) );
-					curr->InputSlot = 1;
+					curr->InputSlot = _numStreams+stream;
 					curr->SemanticIndex = index;
-					curr->AlignedByteOffset = ii*16;
+					curr->AlignedByteOffset = offset;
 				}
 
 				num = uint32_t(elem-vertexElements);
@@ -852,6 +907,12 @@ namespace bgfx
 			m_deviceCtx->IASetInputLayout(layout);
 		}
 
+		void setInputLayout(const VertexDecl& _vertexDecl, const Program& _program)
+		{
+			const VertexDecl* decl = &_vertexDecl;
+			setInputLayout(&decl, 1, _program, NULL, 0);
+		}
+
 		void setBlendState(uint64_t _state, uint32_t _rgba = UINT32_MAX)
 		{
 			_state &= BGFX_STATE_BLEND_MASK|BGFX_STATE_BLEND_EQUATION_MASK|BGFX_STATE_ALPHA_WRITE|BGFX_STATE_RGB_WRITE;
@@ -1227,9 +1288,10 @@ namespace bgfx
 
 	static RendererContext* s_renderCtx;
 
-	void IndexBuffer::create(uint32_t _size, void* _data)
+	void IndexBuffer::create(uint32_t _size, void* _data, uint8_t _flags)
 	{
 		m_size = _size;
+		m_flags = _flags;
 		m_dynamic = NULL == _data;
 
 		D3D11_BUFFER_DESC desc;
@@ -1431,7 +1493,7 @@ namespace bgfx
 		uint32_t stride = vertexDecl.m_stride;
 		uint32_t offset = 0;
 		deviceCtx->IASetVertexBuffers(0, 1, &vb.m_ptr, &stride, &offset);
-		s_renderCtx->setInputLayout(vertexDecl, program, 0);
+		s_renderCtx->setInputLayout(vertexDecl, program);
 
 		IndexBuffer& ib = s_renderCtx->m_indexBuffers[m_ib->handle.idx];
 		deviceCtx->IASetIndexBuffer(ib.m_ptr, DXGI_FORMAT_R16_UINT, 0);
@@ -1448,15 +1510,36 @@ namespace bgfx
 		s_renderCtx->commitTextureStage();
 	}
 
+	void TextVideoMemBlitter::updateVertexBuffer(uint32_t _startVertex, uint32_t _numVertices)
+	{
+		// Partial WRITE_NO_OVERWRITE would overwrite vertices GPU might be
+		// still reading. Vertices are uploaded with WRITE_DISCARD from CPU
+		// copy at render.
+		BX_UNUSED(_startVertex, _numVertices);
+		m_vbDirty = true;
+	}
+
+	void TextVideoMemBlitter::updateIndexBuffer(uint32_t _numIndices)
+	{
+		s_renderCtx->m_indexBuffers[m_ib->handle.idx].update(0, _numIndices*2, m_ib->data);
+	}
+
 	void TextVideoMemBlitter::render(uint32_t _numIndices)
 	{
 		ID3D11DeviceContext* deviceCtx = s_renderCtx->m_deviceCtx;
 
-		IndexBuffer& ib = s_renderCtx->m_indexBuffers[m_ib->handle.idx];
- 		ib.update(0, _numIndices*2, m_ib->data);
+		if (m_vbDirty)
+		{
+			const uint32_t size = _numIndices/6*4*m_decl.m_stride;
+			ID3D11Buffer* ptr = s_renderCtx->m_vertexBuffers[m_vb->handle.idx].m_ptr;
 
-		uint32_t numVertices = _numIndices*4/6;
-		s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(0, numVertices*m_decl.m_stride, m_vb->data);
+			D3D11_MAPPED_SUBRESOURCE mapped;
+			DX_CHECK(deviceCtx->Map(ptr, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped) );
+			memcpy(mapped.pData, m_vb->data, size);
+			deviceCtx->Unmap(ptr, 0);
+
+			m_vbDirty = false;
+		}
 
 		deviceCtx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		deviceCtx->DrawIndexed(_numIndices, 0, 0);
@@ -1546,7 +1629,7 @@ namespace bgfx
 
 			s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(0, 4*m_decl.m_stride, m_vb->data);
 			deviceCtx->IASetVertexBuffers(0, 1, &vb.m_ptr, &stride, &offset);
-			s_renderCtx->setInputLayout(vertexDecl, program, 0);
+			s_renderCtx->setInputLayout(vertexDecl, program);
 
 			IndexBuffer& ib = s_renderCtx->m_indexBuffers[m_ib.idx];
 			deviceCtx->IASetIndexBuffer(ib.m_ptr, DXGI_FORMAT_R16_UINT, 0);
@@ -1714,10 +1797,15 @@ namespace bgfx
 				m_type = Texture2D;
 			}
 
-			m_numMips = imageContainer.m_numMips;
+			// Streaming texture storage holds only mip levels from base mip.
+			m_width   = uint16_t(imageContainer.m_width);
+			m_height  = uint16_t(imageContainer.m_height);
+			m_lod     = imageContainer.m_baseMip;
+			m_numMips = imageContainer.m_numMips - m_lod;
 
-			uint32_t numSrd = imageContainer.m_numMips*(imageContainer.m_cubeMap ? 6 : 1);
+			uint32_t numSrd = m_numMips*(imageContainer.m_cubeMap ? 6 : 1);
 			D3D11_SUBRESOURCE_DATA* srd = (D3D11_SUBRESOURCE_DATA*)alloca(numSrd*sizeof(D3D11_SUBRESOURCE_DATA) );
+			uint32_t* subres = (uint32_t*)alloca(numSrd*sizeof(uint32_t) );
 
 			uint32_t kk = 0;
 
@@ -1727,7 +1815,7 @@ namespace bgfx
 				uint32_t height = imageContainer.m_height;
 				uint32_t depth  = imageContainer.m_depth;
 
-				for (uint32_t lod = 0, num = m_numMips; lod < num; ++lod)
+				for (uint32_t lod = 0, num = imageContainer.m_numMips; lod < num; ++lod)
 				{
 					width  = bx::uint32_max(1, width);
 					height = bx::uint32_max(1, height);
@@ -1758,6 +1846,7 @@ namespace bgfx
 						}
 
 						srd[kk].SysMemSlicePitch = mip.m_height*srd[kk].SysMemPitch;
+						subres[kk] = lod - m_lod + side*m_numMips;
 						++kk;
 					}
 
@@ -1767,6 +1856,8 @@ namespace bgfx
 				}
 			}
 
+			const bool initial = 0 != kk;
+
 			D3D11_SHADER_RESOURCE_VIEW_DESC srvd;
 			memset(&srvd, 0, sizeof(srvd) );
 			srvd.Format = format;
@@ -1777,13 +1868,13 @@ namespace bgfx
 			case TextureCube:
 				{
 					D3D11_TEXTURE2D_DESC desc;
-					desc.Width = imageContainer.m_width;
-					desc.Height = imageContainer.m_height;
-					desc.MipLevels = imageContainer.m_numMips;
+					desc.Width = bx::uint32_max(1, imageContainer.m_width>>m_lod);
+					desc.Height = bx::uint32_max(1, imageContainer.m_height>>m_lod);
+					desc.MipLevels = m_numMips;
 					desc.Format = srvd.Format;
 					desc.SampleDesc.Count = 1;
 					desc.SampleDesc.Quality = 0;
-					desc.Usage = kk == 0 ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+					desc.Usage = initial ? D3D11_USAGE_IMMUTABLE : D3D11_USAGE_DEFAULT;
 					desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 					desc.CPUAccessFlags = 0;
 
@@ -1792,17 +1883,17 @@ namespace bgfx
 						desc.ArraySize = 6;
 						desc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
 						srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-						srvd.TextureCube.MipLevels = imageContainer.m_numMips;
+						srvd.TextureCube.MipLevels = m_numMips;
 					}
 					else
 					{
 						desc.ArraySize = 1;
 						desc.MiscFlags = 0;
 						srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-						srvd.Texture2D.MipLevels = imageContainer.m_numMips;
+						srvd.Texture2D.MipLevels = m_numMips;
 					}
 
-					DX_CHECK(s_renderCtx->m_device->CreateTexture2D(&desc, kk == 0 ? NULL : srd, &m_texture2d) );
+					DX_CHECK(s_renderCtx->m_device->CreateTexture2D(&desc, initial ? srd : NULL, &m_texture2d) );
 				}
 				break;
 
@@ -1814,7 +1905,7 @@ namespace bgfx
 					desc.Depth = imageContainer.m_depth;
 					desc.MipLevels = imageContainer.m_numMips;
 					desc.Format = srvd.Format;
-					desc.Usage = kk == 0 ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+					desc.Usage = initial ? D3D11_USAGE_IMMUTABLE : D3D11_USAGE_DEFAULT;
 					desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 					desc.CPUAccessFlags = 0;
 					desc.MiscFlags = 0;
@@ -1822,24 +1913,18 @@ namespace bgfx
 					srvd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
 					srvd.Texture3D.MipLevels = imageContainer.m_numMips;
 
-					DX_CHECK(s_renderCtx->m_device->CreateTexture3D(&desc, kk == 0 ? NULL : srd, &m_texture3d) );
+					DX_CHECK(s_renderCtx->m_device->CreateTexture3D(&desc, initial ? srd : NULL, &m_texture3d) );
 				}
 				break;
 			}
 
 			DX_CHECK(s_renderCtx->m_device->CreateShaderResourceView(m_ptr, &srvd, &m_srv) );
 
-			if (convert
-			&&  0 != kk)
+			if (convert)
 			{
-				kk = 0;
-				for (uint8_t side = 0, numSides = imageContainer.m_cubeMap ? 6 : 1; side < numSides; ++side)
+				for (uint32_t ii = 0; ii < kk; ++ii)
 				{
-					for (uint32_t lod = 0, num = imageContainer.m_numMips; lod < num; ++lod)
-					{
-						BX_FREE(g_allocator, const_cast<void*>(srd[kk].pSysMem) );
-						++kk;
-					}
+					BX_FREE(g_allocator, const_cast<void*>(srd[ii].pSysMem) );
 				}
 			}
 		}
@@ -1851,6 +1936,50 @@ namespace bgfx
 		DX_RELEASE(m_ptr, 0);
 	}
 
+	void Texture::updateResidency(uint8_t _lod)
+	{
+		BX_CHECK(Texture2D == m_type, "Only 2D texture can be streamed.");
+
+		if (_lod == m_lod)
+		{
+			return;
+		}
+
+		const uint8_t numMips = uint8_t(m_lod + m_numMips - _lod);
+
+		D3D11_TEXTURE2D_DESC desc;
+		m_texture2d->GetDesc(&desc);
+		desc.Width = bx::uint32_max(1, m_width>>_lod);
+		desc.Height = bx::uint32_max(1, m_height>>_lod);
+		desc.MipLevels = numMips;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+
+		ID3D11Texture2D* texture;
+		DX_CHECK(s_renderCtx->m_device->CreateTexture2D(&desc, NULL, &texture) );
+
+		// Copy mip levels which stay resident, newly resident mip level is
+		// uploaded after storage is grown.
+		ID3D11DeviceContext* deviceCtx = s_renderCtx->m_deviceCtx;
+		for (uint32_t mip = bx::uint32_max(_lod, m_lod), num = m_lod + m_numMips; mip < num; ++mip)
+		{
+			deviceCtx->CopySubresourceRegion(texture, mip - _lod, 0, 0, 0, m_ptr, mip - m_lod, NULL);
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvd;
+		m_srv->GetDesc(&srvd);
+		srvd.Texture2D.MipLevels = numMips;
+
+		// Old storage might still be bound to shader stage.
+		DX_RELEASE_WARNONLY(m_srv, 0);
+		DX_RELEASE_WARNONLY(m_ptr, 0);
+
+		m_texture2d = texture;
+		DX_CHECK(s_renderCtx->m_device->CreateShaderResourceView(m_ptr, &srvd, &m_srv) );
+
+		m_lod = _lod;
+		m_numMips = numMips;
+	}
+
 	void Texture::commit(uint8_t _stage, uint32_t _flags)
 	{
 		TextureStage& ts = s_renderCtx->m_textureStage;
@@ -1873,7 +2002,7 @@ namespace bgfx
 		box.front = _z;
 		box.back = box.front + _depth;
 
-		const uint32_t subres = _mip + (_side * m_numMips);
+		const uint32_t subres = _mip - m_lod + (_side * m_numMips);
 		const uint32_t bpp = getBitsPerPixel(TextureFormat::Enum(m_textureFormat) );
 		const uint32_t rectpitch = _rect.m_width*bpp/8;
 		const uint32_t srcpitch  = UINT16_MAX == _pitch ? rectpitch : _pitch;
@@ -2019,9 +2148,9 @@ namespace bgfx
 		s_renderCtx = NULL;
 	}
 
-	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem)
+	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data, _flags);
 	}
 
 	void Context::rendererDestroyIndexBuffer(IndexBufferHandle _handle)
@@ -2050,9 +2179,9 @@ namespace bgfx
 		s_renderCtx->m_vertexBuffers[_handle.idx].destroy();
 	}
 
-	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size)
+	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL, _flags);
 	}
 
 	void Context::rendererUpdateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, Memory* _mem)
@@ -2134,6 +2263,11 @@ namespace bgfx
 		s_renderCtx->m_textures[_handle.idx].destroy();
 	}
 
+	void Context::rendererUpdateTextureResidency(TextureHandle _handle, uint8_t _lod)
+	{
+		s_renderCtx->m_textures[_handle.idx].updateResidency(_lod);
+	}
+
 	void Context::rendererCreateRenderTarget(RenderTargetHandle _handle, uint16_t _width, uint16_t _height, uint32_t _flags, uint32_t _textureFlags)
 	{
 		s_renderCtx->m_renderTargets[_handle.idx].create(_width, _height, _flags, _textureFlags);
@@ -2165,6 +2299,11 @@ namespace bgfx
 		mbstowcs(&s_viewNameW[_id][0], _name, BX_COUNTOF(s_viewNameW[0]) );
 	}
 
+	void Context::rendererPrewarmProgramCache()
+	{
+		// Program binaries are not used by this renderer.
+	}
+
 	void Context::rendererUpdateUniform(uint16_t _loc, const void* _data, uint32_t _size)
 	{
 		memcpy(s_renderCtx->m_uniforms[_loc].m_data, _data, _size);
@@ -2198,6 +2337,12 @@ namespace bgfx
 			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_iboffset, ib->data);
 		}
 
+		if (0 < m_render->m_ib32offset)
+		{
+			TransientIndexBuffer* ib = m_render->m_transientIb32;
+			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_ib32offset, ib->data);
+		}
+
 		if (0 < m_render->m_vboffset)
 		{
 			TransientVertexBuffer* vb = m_render->m_transientVb;
@@ -2589,38 +2734,60 @@ namespace bgfx
 				}
 
 				if (programChanged
-				||  currentState.m_vertexBuffer.idx != state.m_vertexBuffer.idx
-				||  currentState.m_instanceDataBuffer.idx != state.m_instanceDataBuffer.idx
-				||  currentState.m_instanceDataOffset != state.m_instanceDataOffset
-				||  currentState.m_instanceDataStride != state.m_instanceDataStride)
+				||  currentState.isStreamChanged(state)
+				||  currentState.isInstanceDataChanged(state) )
 				{
-					currentState.m_vertexBuffer = state.m_vertexBuffer;
-					currentState.m_instanceDataBuffer.idx = state.m_instanceDataBuffer.idx;
-					currentState.m_instanceDataOffset = state.m_instanceDataOffset;
-					currentState.m_instanceDataStride = state.m_instanceDataStride;
+					currentState.setStreams(state);
+					currentState.setInstanceData(state);
 
-					uint16_t handle = state.m_vertexBuffer.idx;
-					if (invalidHandle != handle)
+					if (isValid(state.m_stream[0].m_handle) )
 					{
-						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[handle];
+						// Multiple streams are offset by their own start vertex,
+						// and drawn with base vertex 0.
+						const uint8_t numStreams = state.m_numStreams;
+						const bool multiStream = 1 < numStreams;
 
-						uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
-						const VertexDecl& vertexDecl = s_renderCtx->m_vertexDecls[decl];
-						uint32_t stride = vertexDecl.m_stride;
-						uint32_t offset = 0;
-						deviceCtx->IASetVertexBuffers(0, 1, &vb.m_ptr, &stride, &offset);
+						const VertexDecl* decls[BGFX_CONFIG_MAX_VERTEX_STREAMS];
+						ID3D11Buffer* buffers[BGFX_CONFIG_MAX_VERTEX_STREAMS];
+						uint32_t strides[BGFX_CONFIG_MAX_VERTEX_STREAMS];
+						uint32_t offsets[BGFX_CONFIG_MAX_VERTEX_STREAMS];
 
-						if (isValid(state.m_instanceDataBuffer) )
+						for (uint8_t stream = 0; stream < numStreams; ++stream)
 						{
- 							const VertexBuffer& inst = s_renderCtx->m_vertexBuffers[state.m_instanceDataBuffer.idx];
-							uint32_t instStride = state.m_instanceDataStride;
-							deviceCtx->IASetVertexBuffers(1, 1, &inst.m_ptr, &instStride, &state.m_instanceDataOffset);
-							s_renderCtx->setInputLayout(vertexDecl, s_renderCtx->m_program[programIdx], state.m_instanceDataStride/16);
+							const Stream& st = state.m_stream[stream];
+							const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[st.m_handle.idx];
+
+							uint16_t decl = !isValid(vb.m_decl) ? st.m_decl.idx : vb.m_decl.idx;
+							const VertexDecl& vertexDecl = s_renderCtx->m_vertexDecls[decl];
+							decls[stream]   = &vertexDecl;
+							buffers[stream] = vb.m_ptr;
+							strides[stream] = vertexDecl.m_stride;
+							offsets[stream] = multiStream ? st.m_startVertex*vertexDecl.m_stride : 0;
+						}
+
+						deviceCtx->IASetVertexBuffers(0, numStreams, buffers, strides, offsets);
+
+						if (0 < state.m_numInstanceDataStreams)
+						{
+							ID3D11Buffer* instBuffers[BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS];
+							uint32_t instStrides[BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS];
+							uint32_t instOffsets[BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS];
+
+							for (uint8_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+							{
+								const InstanceDataStream& instanceData = state.m_instanceData[stream];
+								instBuffers[stream] = s_renderCtx->m_vertexBuffers[instanceData.m_handle.idx].m_ptr;
+								instStrides[stream] = instanceData.m_stride;
+								instOffsets[stream] = instanceData.m_offset;
+							}
+
+							deviceCtx->IASetVertexBuffers(numStreams, state.m_numInstanceDataStreams, instBuffers, instStrides, instOffsets);
+							s_renderCtx->setInputLayout(decls, numStreams, s_renderCtx->m_program[programIdx], state.m_instanceData, state.m_numInstanceDataStreams);
 						}
 						else
 						{
-							deviceCtx->IASetVertexBuffers(1, 0, NULL, NULL, NULL);
-							s_renderCtx->setInputLayout(vertexDecl, s_renderCtx->m_program[programIdx], 0);
+							deviceCtx->IASetVertexBuffers(numStreams, 0, NULL, NULL, NULL);
+							s_renderCtx->setInputLayout(decls, numStreams, s_renderCtx->m_program[programIdx], NULL, 0);
 						}
 					}
 					else
@@ -2637,7 +2804,10 @@ namespace bgfx
 					if (invalidHandle != handle)
 					{
 						const IndexBuffer& ib = s_renderCtx->m_indexBuffers[handle];
-						deviceCtx->IASetIndexBuffer(ib.m_ptr, DXGI_FORMAT_R16_UINT, 0);
+						deviceCtx->IASetIndexBuffer(ib.m_ptr
+							, 0 != (ib.m_flags & BGFX_BUFFER_INDEX32) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT
+							, 0
+							);
 					}
 					else
 					{
@@ -2645,17 +2815,19 @@ namespace bgfx
 					}
 				}
 
-				if (isValid(currentState.m_vertexBuffer) )
+				if (isValid(currentState.m_stream[0].m_handle) )
 				{
 					uint32_t numVertices = state.m_numVertices;
 					if (UINT32_MAX == numVertices)
 					{
-						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_vertexBuffer.idx];
-						uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
+						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_stream[0].m_handle.idx];
+						uint16_t decl = !isValid(vb.m_decl) ? state.m_stream[0].m_decl.idx : vb.m_decl.idx;
 						const VertexDecl& vertexDecl = s_renderCtx->m_vertexDecls[decl];
 						numVertices = vb.m_size/vertexDecl.m_stride;
 					}
 
+					const uint32_t baseVertex = 1 < state.m_numStreams ? 0 : state.m_stream[0].m_startVertex;
+
 					uint32_t numIndices = 0;
 					uint32_t numPrimsSubmitted = 0;
 					uint32_t numInstances = 0;
@@ -2665,7 +2837,8 @@ namespace bgfx
 					{
 						if (UINT32_MAX == state.m_numIndices)
 						{
-							numIndices = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx].m_size/2;
+							const IndexBuffer& ib = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx];
+							numIndices = ib.m_size/(0 != (ib.m_flags & BGFX_BUFFER_INDEX32) ? 4 : 2);
 							numPrimsSubmitted = numIndices/primNumVerts;
 							numInstances = state.m_numInstances;
 							numPrimsRendered = numPrimsSubmitted*state.m_numInstances;
@@ -2673,7 +2846,7 @@ namespace bgfx
 							deviceCtx->DrawIndexedInstanced(numIndices
 								, state.m_numInstances
 								, 0
-								, state.m_startVertex
+								, baseVertex
 								, 0
 								);
 						}
@@ -2687,7 +2860,7 @@ namespace bgfx
 							deviceCtx->DrawIndexedInstanced(numIndices
 								, state.m_numInstances
 								, state.m_startIndex
-								, state.m_startVertex
+								, baseVertex
 								, 0
 								);
 						}
@@ -2700,7 +2873,7 @@ namespace bgfx
 
 						deviceCtx->DrawInstanced(numVertices
 							, state.m_numInstances
-							, state.m_startVertex
+							, baseVertex
 							, 0
 							);
 					}
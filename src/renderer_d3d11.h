@@ -17,68 +17,16 @@ namespace bgfx
 {
 	typedef HRESULT (WINAPI * PFN_CREATEDXGIFACTORY)(REFIID _riid, void** _factory);
 
-	template <typename Ty>
-	class StateCacheT
-	{
-	public:
-		void add(uint64_t _id, Ty* _item)
-		{
-			invalidate(_id);
-			m_hashMap.insert(stl::make_pair(_id, _item) );
-		}
-
-		Ty* find(uint64_t _id)
-		{
-			HashMap::iterator it = m_hashMap.find(_id);
-			if (it != m_hashMap.end() )
-			{
-				return it->second;
-			}
-
-			return NULL;
-		}
-
-		void invalidate(uint64_t _id)
-		{
-			HashMap::iterator it = m_hashMap.find(_id);
-			if (it != m_hashMap.end() )
-			{
-				DX_RELEASE_WARNONLY(it->second, 0);
-				m_hashMap.erase(it);
-			}
-		}
-
-		void invalidate()
-		{
-			for (HashMap::iterator it = m_hashMap.begin(), itEnd = m_hashMap.end(); it != itEnd; ++it)
-			{
-				it->second->Release();
-			}
-
-#if BGFX_CONFIG_DEBUG
-			for (HashMap::iterator it = m_hashMap.begin(), itEnd = m_hashMap.end(); it != itEnd; ++it)
-			{
-				DX_CHECK_REFCOUNT(it->second, 0);
-			}
-#endif // BGFX_CONFIG_DEBUG
-
-			m_hashMap.clear();
-		}
-
-	private:
-		typedef stl::unordered_map<uint64_t, Ty*> HashMap;
-		HashMap m_hashMap;
-	};
-
 	struct IndexBuffer
 	{
 		IndexBuffer()
 			: m_ptr(NULL)
+			, m_flags(BGFX_BUFFER_NONE)
 			, m_dynamic(false)
 		{
 		}
 
-		void create(uint32_t _size, void* _data);
+		void create(uint32_t _size, void* _data, uint8_t _flags);
 		void update(uint32_t _offset, uint32_t _size, void* _data);
 
 		void destroy()
@@ -92,6 +40,7 @@ namespace bgfx
 
 		ID3D11Buffer* m_ptr;
 		uint32_t m_size;
+		uint8_t m_flags;
 		bool m_dynamic;
 	};
 
@@ -252,6 +201,9 @@ namespace bgfx
 			: m_ptr(NULL)
 			, m_srv(NULL)
 			, m_sampler(NULL)
+			, m_width(0)
+			, m_height(0)
+			, m_lod(0)
 			, m_numMips(0)
 		{
 		}
@@ -259,6 +211,7 @@ namespace bgfx
 		void create(const Memory* _mem, uint32_t _flags);
 		void destroy();
 		void update(uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem);
+		void updateResidency(uint8_t _lod);
 		void commit(uint8_t _stage, uint32_t _flags = BGFX_SAMPLER_DEFAULT_FLAGS);
 
 		union
@@ -273,6 +226,11 @@ namespace bgfx
 		uint8_t m_type;
 		uint8_t m_requestedFormat;
 		uint8_t m_textureFormat;
+
+		// Size of mip level 0, storage holds mip levels from m_lod.
+		uint16_t m_width;
+		uint16_t m_height;
+		uint8_t m_lod;
 		uint8_t m_numMips;
 	};
 
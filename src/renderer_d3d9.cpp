@@ -277,6 +277,7 @@ namespace bgfx
 			, m_nvidia(false)
 			, m_instancing(false)
 			, m_rtMsaa(false)
+			, m_textVideoMemLost(false)
 		{
 			m_rt.idx = invalidHandle;
 		}
@@ -442,7 +443,9 @@ namespace bgfx
 								| BGFX_CAPS_TEXTURE_DEPTH_MASK
 								| BGFX_CAPS_VERTEX_ATTRIB_HALF
 								| BGFX_CAPS_FRAGMENT_DEPTH
+								| BGFX_CAPS_TEXTURE_RESIDENCY
 								);
+			g_caps.supported |= m_caps.MaxVertexIndex > UINT16_MAX ? BGFX_CAPS_INDEX32 : 0;
 			g_caps.maxTextureSize = bx::uint32_min(m_caps.MaxTextureWidth, m_caps.MaxTextureHeight);
 
 #if BGFX_CONFIG_RENDERER_USE_EXTENSIONS
@@ -565,6 +568,8 @@ namespace bgfx
 				m_vertexDecls[ii].destroy();
 			}
 
+			m_vertexDeclCache.invalidate();
+
 			for (uint32_t ii = 0; ii < BX_COUNTOF(m_renderTargets); ++ii)
 			{
 				m_renderTargets[ii].destroy();
@@ -825,6 +830,10 @@ namespace bgfx
 				m_vertexBuffers[ii].postReset();
 			}
 
+			// Dynamic buffers are recreated empty, text blitter must rebuild
+			// its grid.
+			m_textVideoMemLost = true;
+
 			for (uint32_t ii = 0; ii < BX_COUNTOF(m_renderTargets); ++ii)
 			{
 				m_renderTargets[ii].postReset();
@@ -1019,7 +1028,7 @@ namespace bgfx
 		IDirect3DSurface9* m_captureSurface;
 		IDirect3DSurface9* m_captureResolve;
 
-		IDirect3DVertexDeclaration9* m_instanceDataDecls[BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
+		StateCacheT<IDirect3DVertexDeclaration9> m_vertexDeclCache;
 
 		void* m_d3d9dll;
 		uint32_t m_adapter;
@@ -1057,13 +1066,15 @@ namespace bgfx
 		TextVideoMem m_textVideoMem;
 		RenderTargetHandle m_rt;
 		bool m_rtMsaa;
+		bool m_textVideoMemLost;
 	};
 
 	static RendererContext* s_renderCtx;
 
-	void IndexBuffer::create(uint32_t _size, void* _data)
+	void IndexBuffer::create(uint32_t _size, void* _data, uint8_t _flags)
 	{
 		m_size = _size;
+		m_flags = _flags;
 		m_dynamic = NULL == _data;
 
 		uint32_t usage = D3DUSAGE_WRITEONLY;
@@ -1077,7 +1088,7 @@ namespace bgfx
 
 		DX_CHECK(s_renderCtx->m_device->CreateIndexBuffer(m_size
 			, usage
-			, D3DFMT_INDEX16
+			, 0 != (m_flags & BGFX_BUFFER_INDEX32) ? D3DFMT_INDEX32 : D3DFMT_INDEX16
 			, pool
 			, &m_ptr
 			, NULL
@@ -1103,7 +1114,7 @@ namespace bgfx
 		{
 			DX_CHECK(s_renderCtx->m_device->CreateIndexBuffer(m_size
 				, D3DUSAGE_WRITEONLY|D3DUSAGE_DYNAMIC
-				, D3DFMT_INDEX16
+				, 0 != (m_flags & BGFX_BUFFER_INDEX32) ? D3DFMT_INDEX32 : D3DFMT_INDEX16
 				, D3DPOOL_DEFAULT
 				, &m_ptr
 				, NULL
@@ -1210,7 +1221,7 @@ namespace bgfx
 		},
 	};
 
-	static D3DVERTEXELEMENT9* fillVertexDecl(D3DVERTEXELEMENT9* _out, const VertexDecl& _decl)
+	static D3DVERTEXELEMENT9* fillVertexDecl(D3DVERTEXELEMENT9* _out, const VertexDecl& _decl, uint8_t _stream = 0)
 	{
 		D3DVERTEXELEMENT9* elem = _out;
 
@@ -1226,6 +1237,7 @@ namespace bgfx
 
 				memcpy(elem, &s_attrib[attr], sizeof(D3DVERTEXELEMENT9) );
 
+				elem->Stream = _stream;
 				elem->Type = s_attribType[type][num-1][normalized];
 				elem->Offset = _decl.m_offset[attr];
 				++elem;
@@ -1235,19 +1247,35 @@ namespace bgfx
 		return elem;
 	}
 
-	static IDirect3DVertexDeclaration9* createVertexDecl(const VertexDecl& _decl, uint8_t _numInstanceData)
+	static IDirect3DVertexDeclaration9* createVertexDecl(const VertexDecl* const* _decls, uint8_t _numStreams, const InstanceDataStream* _instanceData, uint8_t _numInstanceDataStreams)
 	{
-		D3DVERTEXELEMENT9 vertexElements[Attrib::Count+1+BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
-		D3DVERTEXELEMENT9* elem = fillVertexDecl(vertexElements, _decl);
+		D3DVERTEXELEMENT9 vertexElements[Attrib::Count*BGFX_CONFIG_MAX_VERTEX_STREAMS+1+BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
+		D3DVERTEXELEMENT9* elem = vertexElements;
+
+		for (uint8_t stream = 0; stream < _numStreams; ++stream)
+		{
+			elem = fillVertexDecl(elem, *_decls[stream], stream);
+		}
 
 		const D3DVERTEXELEMENT9 inst = { 1, 0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 0 };
 
-		for (uint32_t ii = 0; ii < _numInstanceData; ++ii)
+		uint32_t numInstanceData = 0;
+		for (uint8_t stream = 0; stream < _numInstanceDataStreams; ++stream)
 		{
-			memcpy(elem, &inst, sizeof(D3DVERTEXELEMENT9) );
-			elem->UsageIndex = 8-_numInstanceData+ii;
-			elem->Offset = ii*16;
-			++elem;
+			numInstanceData += _instanceData[stream].m_stride/16;
+		}
+
+		// Instance data attributes are numbered consecutively over streams.
+		for (uint8_t stream = 0, index = 0; stream < _numInstanceDataStreams; ++stream)
+		{
+			for (uint32_t ii = 0, num = _instanceData[stream].m_stride/16; ii < num; ++ii, ++index)
+			{
+				memcpy(elem, &inst, sizeof(D3DVERTEXELEMENT9) );
+				elem->Stream = _numStreams+stream;
+				elem->UsageIndex = BYTE(8-numInstanceData+index);
+				elem->Offset = WORD(ii*16);
+				++elem;
+			}
 		}
 
 		memcpy(elem, &s_attrib[Attrib::Count], sizeof(D3DVERTEXELEMENT9) );
@@ -1257,11 +1285,40 @@ namespace bgfx
 		return ptr;
 	}
 
+	// Declarations for multiple vertex streams and instance data are
+	// created on first use, and cached by declarations of streams.
+	static IDirect3DVertexDeclaration9* findVertexDecl(const VertexDecl* const* _decls, uint8_t _numStreams, const InstanceDataStream* _instanceData, uint8_t _numInstanceDataStreams)
+	{
+		bx::HashMurmur2A murmur;
+		murmur.begin();
+		for (uint8_t stream = 0; stream < _numStreams; ++stream)
+		{
+			murmur.add(_decls[stream]->m_hash);
+		}
+
+		for (uint8_t stream = 0; stream < _numInstanceDataStreams; ++stream)
+		{
+			murmur.add(_instanceData[stream].m_stride);
+		}
+		murmur.add(_numInstanceDataStreams);
+		uint64_t hash = (uint64_t(_numStreams)<<32) | murmur.end();
+
+		IDirect3DVertexDeclaration9* ptr = s_renderCtx->m_vertexDeclCache.find(hash);
+		if (NULL == ptr)
+		{
+			ptr = createVertexDecl(_decls, _numStreams, _instanceData, _numInstanceDataStreams);
+			s_renderCtx->m_vertexDeclCache.add(hash, ptr);
+		}
+
+		return ptr;
+	}
+
 	void VertexDeclaration::create(const VertexDecl& _decl)
 	{
 		memcpy(&m_decl, &_decl, sizeof(VertexDecl) );
 		dump(m_decl);
-		m_ptr = createVertexDecl(_decl, 0);
+		const VertexDecl* decl = &_decl;
+		m_ptr = createVertexDecl(&decl, 1, NULL, 0);
 	}
 
 	void Shader::create(bool _fragment, const Memory* _mem)
@@ -1587,6 +1644,12 @@ namespace bgfx
 
 			D3DFORMAT format = s_textureFormat[m_textureFormat].m_fmt;
 
+			// Streaming texture storage holds only mip levels from base mip.
+			m_width   = uint16_t(imageContainer.m_width);
+			m_height  = uint16_t(imageContainer.m_height);
+			m_lod     = imageContainer.m_baseMip;
+			m_numMips = imageContainer.m_numMips - m_lod;
+
 			if (imageContainer.m_cubeMap)
 			{
 				createCubeTexture(imageContainer.m_width, imageContainer.m_numMips, format);
@@ -1597,7 +1660,11 @@ namespace bgfx
 			}
 			else
 			{
-				createTexture(imageContainer.m_width, imageContainer.m_height, imageContainer.m_numMips, format);
+				createTexture(bx::uint32_max(1, imageContainer.m_width>>m_lod)
+					, bx::uint32_max(1, imageContainer.m_height>>m_lod)
+					, m_numMips
+					, format
+					);
 			}
 
 			// For BC4 and B5 in DX9 LockRect returns wrong number of
@@ -1633,7 +1700,7 @@ namespace bgfx
 					{
 						uint32_t pitch;
 						uint32_t slicePitch;
-						uint8_t* bits = lock(side, lod, pitch, slicePitch);
+						uint8_t* bits = lock(side, uint8_t(lod - m_lod), pitch, slicePitch);
 
 						if (convert)
 						{
@@ -1666,7 +1733,7 @@ namespace bgfx
 							memcpy(bits, mip.m_data, size);
 						}
 
-						unlock(side, lod);
+						unlock(side, uint8_t(lod - m_lod) );
 					}
 
 					width     >>= 1;
@@ -1679,12 +1746,67 @@ namespace bgfx
 		}
 	}
 
+	void Texture::updateResidency(uint8_t _lod)
+	{
+		BX_CHECK(Texture2D == m_type, "Only 2D texture can be streamed.");
+
+		if (_lod == m_lod)
+		{
+			return;
+		}
+
+		const uint8_t numMips = uint8_t(m_lod + m_numMips - _lod);
+
+		D3DSURFACE_DESC desc;
+		DX_CHECK(m_texture2d->GetLevelDesc(0, &desc) );
+
+		IDirect3DTexture9* texture = m_texture2d;
+		createTexture(bx::uint32_max(1, m_width>>_lod)
+			, bx::uint32_max(1, m_height>>_lod)
+			, numMips
+			, desc.Format
+			);
+
+		// Copy mip levels which stay resident, newly resident mip level is
+		// uploaded after storage is grown.
+		const bool compressed = TextureFormat::Unknown > m_textureFormat;
+		for (uint32_t mip = bx::uint32_max(_lod, m_lod), num = m_lod + m_numMips; mip < num; ++mip)
+		{
+			D3DLOCKED_RECT src;
+			D3DLOCKED_RECT dst;
+			DX_CHECK(texture->LockRect(mip - m_lod, &src, NULL, D3DLOCK_READONLY) );
+			DX_CHECK(m_texture2d->LockRect(mip - _lod, &dst, NULL, 0) );
+
+			const uint32_t height = bx::uint32_max(1, m_height>>mip);
+			const uint32_t rows   = compressed ? (height+3)/4 : height;
+			const uint32_t pitch  = bx::uint32_min(src.Pitch, dst.Pitch);
+
+			const uint8_t* srcBits = (const uint8_t*)src.pBits;
+			uint8_t* dstBits = (uint8_t*)dst.pBits;
+			for (uint32_t yy = 0; yy < rows; ++yy)
+			{
+				memcpy(dstBits, srcBits, pitch);
+				srcBits += src.Pitch;
+				dstBits += dst.Pitch;
+			}
+
+			DX_CHECK(m_texture2d->UnlockRect(mip - _lod) );
+			DX_CHECK(texture->UnlockRect(mip - m_lod) );
+		}
+
+		// Old storage might still be bound to sampler stage.
+		DX_RELEASE_WARNONLY(texture, 0);
+
+		m_lod = _lod;
+		m_numMips = numMips;
+	}
+
 	void Texture::updateBegin(uint8_t _side, uint8_t _mip)
 	{
 		uint32_t slicePitch;
 		s_renderCtx->m_updateTextureSide = _side;
-		s_renderCtx->m_updateTextureMip = _mip;
-		s_renderCtx->m_updateTextureBits = lock(_side, _mip, s_renderCtx->m_updateTexturePitch, slicePitch);
+		s_renderCtx->m_updateTextureMip = uint8_t(_mip - m_lod);
+		s_renderCtx->m_updateTextureBits = lock(_side, s_renderCtx->m_updateTextureMip, s_renderCtx->m_updateTexturePitch, slicePitch);
 	}
 
 	void Texture::update(uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem)
@@ -1723,7 +1845,7 @@ namespace bgfx
 			BX_FREE(g_allocator, temp);
 		}
 
-		if (0 == _mip)
+		if (m_lod == _mip)
 		{
 			dirty(_side, _rect, _z, _depth);
 		}
@@ -1968,6 +2090,12 @@ namespace bgfx
 
 	void TextVideoMemBlitter::setup()
 	{
+		if (s_renderCtx->m_textVideoMemLost)
+		{
+			s_renderCtx->m_textVideoMemLost = false;
+			invalidate();
+		}
+
 		uint32_t width = s_renderCtx->m_params.BackBufferWidth;
 		uint32_t height = s_renderCtx->m_params.BackBufferHeight;
 
@@ -2015,11 +2143,20 @@ namespace bgfx
 		s_renderCtx->m_textures[m_texture.idx].commit(0);
 	}
 
+	void TextVideoMemBlitter::updateVertexBuffer(uint32_t _startVertex, uint32_t _numVertices)
+	{
+		const uint32_t offset = _startVertex*m_decl.m_stride;
+		s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(offset, _numVertices*m_decl.m_stride, &m_vb->data[offset]);
+	}
+
+	void TextVideoMemBlitter::updateIndexBuffer(uint32_t _numIndices)
+	{
+		s_renderCtx->m_indexBuffers[m_ib->handle.idx].update(0, _numIndices*2, m_ib->data);
+	}
+
 	void TextVideoMemBlitter::render(uint32_t _numIndices)
 	{
 		uint32_t numVertices = _numIndices*4/6;
-		s_renderCtx->m_indexBuffers[m_ib->handle.idx].update(0, _numIndices*2, m_ib->data, true);
-		s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(0, numVertices*m_decl.m_stride, m_vb->data, true);
 
 		DX_CHECK(s_renderCtx->m_device->DrawIndexedPrimitive(D3DPT_TRIANGLELIST
 			, 0
@@ -2050,9 +2187,9 @@ namespace bgfx
 		BX_DELETE(g_allocator, s_renderCtx);
 	}
 
-	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem)
+	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data, _flags);
 	}
 
 	void Context::rendererDestroyIndexBuffer(IndexBufferHandle _handle)
@@ -2080,9 +2217,9 @@ namespace bgfx
 		s_renderCtx->m_vertexBuffers[_handle.idx].destroy();
 	}
 
-	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size)
+	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL, _flags);
 	}
 
 	void Context::rendererUpdateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, Memory* _mem)
@@ -2168,6 +2305,11 @@ namespace bgfx
 		s_renderCtx->m_textures[_handle.idx].destroy();
 	}
 
+	void Context::rendererUpdateTextureResidency(TextureHandle _handle, uint8_t _lod)
+	{
+		s_renderCtx->m_textures[_handle.idx].updateResidency(_lod);
+	}
+
 	void Context::rendererCreateRenderTarget(RenderTargetHandle _handle, uint16_t _width, uint16_t _height, uint32_t _flags, uint32_t _textureFlags)
 	{
 		s_renderCtx->m_renderTargets[_handle.idx].create(_width, _height, _flags, _textureFlags);
@@ -2202,6 +2344,11 @@ namespace bgfx
 		mbstowcs(&s_viewNameW[_id][0], _name, BX_COUNTOF(s_viewNameW[0]) );
 	}
 
+	void Context::rendererPrewarmProgramCache()
+	{
+		// Program binaries are not used by this renderer.
+	}
+
 	void Context::rendererUpdateUniform(uint16_t _loc, const void* _data, uint32_t _size)
 	{
 		memcpy(s_renderCtx->m_uniforms[_loc], _data, _size);
@@ -2237,6 +2384,12 @@ namespace bgfx
 			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_iboffset, ib->data, true);
 		}
 
+		if (0 < m_render->m_ib32offset)
+		{
+			TransientIndexBuffer* ib = m_render->m_transientIb32;
+			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_ib32offset, ib->data, true);
+		}
+
 		if (0 < m_render->m_vboffset)
 		{
 			TransientVertexBuffer* vb = m_render->m_transientVb;
@@ -2730,42 +2883,77 @@ namespace bgfx
 				}
 
 				if (programChanged
-				||  currentState.m_vertexBuffer.idx != state.m_vertexBuffer.idx
-				||  currentState.m_instanceDataBuffer.idx != state.m_instanceDataBuffer.idx
-				||  currentState.m_instanceDataOffset != state.m_instanceDataOffset
-				||  currentState.m_instanceDataStride != state.m_instanceDataStride)
+				||  currentState.isStreamChanged(state)
+				||  currentState.isInstanceDataChanged(state) )
 				{
-					currentState.m_vertexBuffer = state.m_vertexBuffer;
-					currentState.m_instanceDataBuffer.idx = state.m_instanceDataBuffer.idx;
-					currentState.m_instanceDataOffset = state.m_instanceDataOffset;
-					currentState.m_instanceDataStride = state.m_instanceDataStride;
+					currentState.setStreams(state);
+					currentState.setInstanceData(state);
 
-					uint16_t handle = state.m_vertexBuffer.idx;
-					if (invalidHandle != handle)
+					if (isValid(state.m_stream[0].m_handle) )
 					{
-						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[handle];
+						// Multiple streams are offset by their own start vertex,
+						// and drawn with base vertex 0.
+						const uint8_t numStreams = state.m_numStreams;
+						const bool multiStream = 1 < numStreams;
 
-						uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
-						const VertexDeclaration& vertexDecl = s_renderCtx->m_vertexDecls[decl];
-						DX_CHECK(device->SetStreamSource(0, vb.m_ptr, 0, vertexDecl.m_decl.m_stride) );
+						const VertexDecl* decls[BGFX_CONFIG_MAX_VERTEX_STREAMS];
+						IDirect3DVertexDeclaration9* vertexDeclPtr = NULL;
 
-						if (isValid(state.m_instanceDataBuffer)
+						for (uint8_t stream = 0; stream < numStreams; ++stream)
+						{
+							const Stream& st = state.m_stream[stream];
+							const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[st.m_handle.idx];
+
+							uint16_t decl = !isValid(vb.m_decl) ? st.m_decl.idx : vb.m_decl.idx;
+							const VertexDeclaration& vertexDecl = s_renderCtx->m_vertexDecls[decl];
+							decls[stream] = &vertexDecl.m_decl;
+							vertexDeclPtr = vertexDecl.m_ptr;
+
+							const uint32_t offset = multiStream ? st.m_startVertex*vertexDecl.m_decl.m_stride : 0;
+							DX_CHECK(device->SetStreamSource(stream, vb.m_ptr, offset, vertexDecl.m_decl.m_stride) );
+						}
+
+						if (0 < state.m_numInstanceDataStreams
 						&&  s_renderCtx->m_instancing)
 						{
-							const VertexBuffer& inst = s_renderCtx->m_vertexBuffers[state.m_instanceDataBuffer.idx];
-							DX_CHECK(device->SetStreamSourceFreq(0, D3DSTREAMSOURCE_INDEXEDDATA|state.m_numInstances) );
-							DX_CHECK(device->SetStreamSourceFreq(1, D3DSTREAMSOURCE_INSTANCEDATA|1) );
-							DX_CHECK(device->SetStreamSource(1, inst.m_ptr, state.m_instanceDataOffset, state.m_instanceDataStride) );
+							for (uint8_t stream = 0; stream < numStreams; ++stream)
+							{
+								DX_CHECK(device->SetStreamSourceFreq(stream, D3DSTREAMSOURCE_INDEXEDDATA|state.m_numInstances) );
+							}
 
-							IDirect3DVertexDeclaration9* ptr = createVertexDecl(vertexDecl.m_decl, state.m_instanceDataStride/16);
+							for (uint8_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+							{
+								const InstanceDataStream& instanceData = state.m_instanceData[stream];
+								const VertexBuffer& inst = s_renderCtx->m_vertexBuffers[instanceData.m_handle.idx];
+								DX_CHECK(device->SetStreamSourceFreq(numStreams+stream, D3DSTREAMSOURCE_INSTANCEDATA|1) );
+								DX_CHECK(device->SetStreamSource(numStreams+stream, inst.m_ptr, instanceData.m_offset, instanceData.m_stride) );
+							}
+
+							IDirect3DVertexDeclaration9* ptr = findVertexDecl(decls, numStreams, state.m_instanceData, state.m_numInstanceDataStreams);
 							DX_CHECK(device->SetVertexDeclaration(ptr) );
-							DX_RELEASE(ptr, 0);
 						}
 						else
 						{
-							DX_CHECK(device->SetStreamSourceFreq(0, 1) );
-							DX_CHECK(device->SetStreamSource(1, NULL, 0, 0) );
-							DX_CHECK(device->SetVertexDeclaration(vertexDecl.m_ptr) );
+							for (uint8_t stream = 0; stream < numStreams; ++stream)
+							{
+								DX_CHECK(device->SetStreamSourceFreq(stream, 1) );
+							}
+
+							for (uint8_t stream = 0; stream < BGFX_CONFIG_MAX_INSTANCE_DATA_STREAMS; ++stream)
+							{
+								DX_CHECK(device->SetStreamSourceFreq(numStreams+stream, 1) );
+								DX_CHECK(device->SetStreamSource(numStreams+stream, NULL, 0, 0) );
+							}
+
+							if (multiStream)
+							{
+								IDirect3DVertexDeclaration9* ptr = findVertexDecl(decls, numStreams, NULL, 0);
+								DX_CHECK(device->SetVertexDeclaration(ptr) );
+							}
+							else
+							{
+								DX_CHECK(device->SetVertexDeclaration(vertexDeclPtr) );
+							}
 						}
 					}
 					else
@@ -2791,17 +2979,19 @@ namespace bgfx
 					}
 				}
 
-				if (isValid(currentState.m_vertexBuffer) )
+				if (isValid(currentState.m_stream[0].m_handle) )
 				{
 					uint32_t numVertices = state.m_numVertices;
 					if (UINT32_MAX == numVertices)
 					{
-						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_vertexBuffer.idx];
-						uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
+						const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_stream[0].m_handle.idx];
+						uint16_t decl = !isValid(vb.m_decl) ? state.m_stream[0].m_decl.idx : vb.m_decl.idx;
 						const VertexDeclaration& vertexDecl = s_renderCtx->m_vertexDecls[decl];
 						numVertices = vb.m_size/vertexDecl.m_decl.m_stride;
 					}
 
+					const uint32_t baseVertex = 1 < state.m_numStreams ? 0 : state.m_stream[0].m_startVertex;
+
 					uint32_t numIndices = 0;
 					uint32_t numPrimsSubmitted = 0;
 					uint32_t numInstances = 0;
@@ -2811,13 +3001,14 @@ namespace bgfx
 					{
 						if (UINT32_MAX == state.m_numIndices)
 						{
-							numIndices = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx].m_size/2;
+							const IndexBuffer& ib = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx];
+							numIndices = ib.m_size/(0 != (ib.m_flags & BGFX_BUFFER_INDEX32) ? 4 : 2);
 							numPrimsSubmitted = numIndices/primNumVerts;
 							numInstances = state.m_numInstances;
 							numPrimsRendered = numPrimsSubmitted*state.m_numInstances;
 
 							DX_CHECK(device->DrawIndexedPrimitive(primType
-								, state.m_startVertex
+								, baseVertex
 								, 0
 								, numVertices
 								, 0
@@ -2832,7 +3023,7 @@ namespace bgfx
 							numPrimsRendered = numPrimsSubmitted*state.m_numInstances;
 
 							DX_CHECK(device->DrawIndexedPrimitive(primType
-								, state.m_startVertex
+								, baseVertex
 								, 0
 								, numVertices
 								, state.m_startIndex
@@ -2847,7 +3038,7 @@ namespace bgfx
 						numPrimsRendered = numPrimsSubmitted*state.m_numInstances;
 
 						DX_CHECK(device->DrawPrimitive(primType
-							, state.m_startVertex
+							, baseVertex
 							, numPrimsSubmitted
 							) );
 					}
@@ -120,11 +120,12 @@ namespace bgfx
 	{
 		IndexBuffer()
 			: m_ptr(NULL)
+			, m_flags(BGFX_BUFFER_NONE)
 			, m_dynamic(false)
 		{
 		}
 
-		void create(uint32_t _size, void* _data);
+		void create(uint32_t _size, void* _data, uint8_t _flags);
 		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false)
 		{
 			void* buffer;
@@ -153,6 +154,7 @@ namespace bgfx
 
 		IDirect3DIndexBuffer9* m_ptr;
 		uint32_t m_size;
+		uint8_t m_flags;
 		bool m_dynamic;
 	};
 
@@ -298,6 +300,10 @@ namespace bgfx
 
 		Texture()
 			: m_ptr(NULL)
+			, m_width(0)
+			, m_height(0)
+			, m_lod(0)
+			, m_numMips(0)
 		{
 		}
 
@@ -319,6 +325,7 @@ namespace bgfx
 		void updateBegin(uint8_t _side, uint8_t _mip);
 		void update(uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem);
 		void updateEnd();
+		void updateResidency(uint8_t _lod);
 		void commit(uint8_t _stage, uint32_t _flags = BGFX_SAMPLER_DEFAULT_FLAGS);
 	
 		union
@@ -333,6 +340,12 @@ namespace bgfx
 		uint8_t m_type;
 		uint8_t m_requestedFormat;
 		uint8_t m_textureFormat;
+
+		// Size of mip level 0, storage holds mip levels from m_lod.
+		uint16_t m_width;
+		uint16_t m_height;
+		uint8_t m_lod;
+		uint8_t m_numMips;
 	};
 
 	struct RenderTarget
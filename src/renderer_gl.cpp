@@ -7,6 +7,7 @@
 
 #if (BGFX_CONFIG_RENDERER_OPENGLES2|BGFX_CONFIG_RENDERER_OPENGLES3|BGFX_CONFIG_RENDERER_OPENGL)
 #	include "renderer_gl.h"
+#	include "programcache.h"
 #	include <bx/timer.h>
 #	include <bx/uint32_t.h>
 
@@ -40,13 +41,16 @@ namespace bgfx
 		"a_texcoord7",
 	};
 
-	static const char* s_instanceDataName[BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT] =
+	static const char* s_instanceDataName[] =
 	{
 		"i_data0",
 		"i_data1",
 		"i_data2",
 		"i_data3",
 		"i_data4",
+		"i_data5",
+		"i_data6",
+		"i_data7",
 	};
 
 	static const GLenum s_attribType[AttribType::Count] =
@@ -257,6 +261,7 @@ namespace bgfx
 			ANGLE_instanced_arrays,
 			ANGLE_translated_shader_source,
 			APPLE_texture_format_BGRA8888,
+			ARB_copy_image,
 			ARB_debug_output,
 			ARB_depth_clamp,
 			ARB_ES3_compatibility,
@@ -313,6 +318,7 @@ namespace bgfx
 			OES_depth24,
 			OES_depth32,
 			OES_depth_texture,
+			OES_element_index_uint,
 			OES_fragment_precision_high,
 			OES_get_program_binary,
 			OES_required_internalformat,
@@ -343,6 +349,7 @@ namespace bgfx
 		{ "GL_ANGLE_instanced_arrays",             false,                             true  },
 		{ "GL_ANGLE_translated_shader_source",     false,                             true  },
 		{ "GL_APPLE_texture_format_BGRA8888",      false,                             true  },
+		{ "GL_ARB_copy_image",                     BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
 		{ "GL_ARB_debug_output",                   BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
 		{ "GL_ARB_depth_clamp",                    BGFX_CONFIG_RENDERER_OPENGL >= 32, true  },
 		{ "GL_ARB_ES3_compatibility",              BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
@@ -399,6 +406,7 @@ namespace bgfx
 		{ "GL_OES_depth24",                        false,                             true  },
 		{ "GL_OES_depth32",                        false,                             true  },
 		{ "GL_OES_depth_texture",                  false,                             true  },
+		{ "GL_OES_element_index_uint",             false,                             true  },
 		{ "GL_OES_fragment_precision_high",        false,                             true  },
 		{ "GL_OES_get_program_binary",             false,                             true  },
 		{ "GL_OES_required_internalformat",        false,                             true  },
@@ -573,6 +581,7 @@ namespace bgfx
 			, m_vaoSupport(BGFX_CONFIG_RENDERER_OPENGL >= 31)
 			, m_programBinarySupport(false)
 			, m_textureSwizzleSupport(false)
+			, m_copyImageSupport(false)
 			, m_depthTextureSupport(false)
 			, m_useClearQuad(true)
 			, m_flip(false)
@@ -893,6 +902,13 @@ namespace bgfx
 
 			invalidateCache();
 
+			for (PrewarmedProgramMap::iterator it = m_prewarmed.begin(), itEnd = m_prewarmed.end(); it != itEnd; ++it)
+			{
+				GL_CHECK(glDeleteProgram(it->second) );
+			}
+			m_prewarmed.clear();
+			m_programCache.close();
+
 #if BGFX_CONFIG_RENDERER_OPENGL
 			m_queries.destroy();
 #endif // BGFX_CONFIG_RENDERER_OPENGL
@@ -903,6 +919,37 @@ namespace bgfx
 			m_flip = false;
 		}
 
+		uint32_t cacheReadSize(uint64_t _id)
+		{
+			if (m_programCache.isOpen() )
+			{
+				return m_programCache.readSize(_id);
+			}
+
+			return g_callback->cacheReadSize(_id);
+		}
+
+		bool cacheRead(uint64_t _id, void* _data, uint32_t _size)
+		{
+			if (m_programCache.isOpen() )
+			{
+				return m_programCache.read(_id, _data, _size);
+			}
+
+			return g_callback->cacheRead(_id, _data, _size);
+		}
+
+		void cacheWrite(uint64_t _id, const void* _data, uint32_t _size)
+		{
+			if (m_programCache.isOpen() )
+			{
+				m_programCache.write(_id, _data, _size);
+				return;
+			}
+
+			g_callback->cacheWrite(_id, _data, _size);
+		}
+
 		IndexBuffer m_indexBuffers[BGFX_CONFIG_MAX_INDEX_BUFFERS];
 		VertexBuffer m_vertexBuffers[BGFX_CONFIG_MAX_VERTEX_BUFFERS];
 		Shader m_vertexShaders[BGFX_CONFIG_MAX_VERTEX_SHADERS];
@@ -918,6 +965,10 @@ namespace bgfx
 #endif // BGFX_CONFIG_RENDERER_OPENGL
 
 		VaoStateCache m_vaoStateCache;
+
+		ProgramCache m_programCache;
+		typedef stl::unordered_map<uint64_t, GLuint> PrewarmedProgramMap;
+		PrewarmedProgramMap m_prewarmed;
 #if !BGFX_CONFIG_RENDERER_OPENGLES2
 		SamplerStateCache m_samplerStateCache;
 #endif // !BGFX_CONFIG_RENDERER_OPENGLES2
@@ -936,6 +987,7 @@ namespace bgfx
 		bool m_samplerObjectSupport;
 		bool m_programBinarySupport;
 		bool m_textureSwizzleSupport;
+		bool m_copyImageSupport;
 		bool m_depthTextureSupport;
 		bool m_useClearQuad;
 		bool m_flip;
@@ -1050,23 +1102,34 @@ namespace bgfx
 
 	void Program::create(const Shader& _vsh, const Shader& _fsh)
 	{
-		m_id = glCreateProgram();
-		BX_TRACE("program create: %d: %d, %d", m_id, _vsh.m_id, _fsh.m_id);
-
 		bool cached = false;
 
 		uint64_t id = (uint64_t(_vsh.m_hash)<<32) | _fsh.m_hash;
 		id ^= s_renderCtx->m_hash;
 
-		if (s_renderCtx->m_programBinarySupport)
+		RendererContext::PrewarmedProgramMap::iterator it = s_renderCtx->m_prewarmed.find(id);
+		if (it != s_renderCtx->m_prewarmed.end() )
+		{
+			m_id = it->second;
+			s_renderCtx->m_prewarmed.erase(it);
+			cached = true;
+			BX_TRACE("program create: %d: %d, %d (prewarmed)", m_id, _vsh.m_id, _fsh.m_id);
+		}
+		else
+		{
+			m_id = glCreateProgram();
+			BX_TRACE("program create: %d: %d, %d", m_id, _vsh.m_id, _fsh.m_id);
+		}
+
+		if (!cached
+		&&  s_renderCtx->m_programBinarySupport)
 		{
-			uint32_t length = g_callback->cacheReadSize(id);
-			cached = length > 0;
+			uint32_t length = s_renderCtx->cacheReadSize(id);
 
-			if (cached)
+			if (length > sizeof(GLenum) )
 			{
 				void* data = BX_ALLOC(g_allocator, length);
-				if (g_callback->cacheRead(id, data, length) )
+				if (s_renderCtx->cacheRead(id, data, length) )
 				{
 					bx::MemoryReader reader(data, length);
 
@@ -1074,6 +1137,12 @@ namespace bgfx
 					bx::read(&reader, format);
 
 					GL_CHECK(glProgramBinary(m_id, format, reader.getDataPtr(), (GLsizei)reader.remaining() ) );
+
+					// Binary might be rejected by driver, in that case
+					// program is linked from shaders and cache is updated.
+					GLint linked = 0;
+					GL_CHECK(glGetProgramiv(m_id, GL_LINK_STATUS, &linked) );
+					cached = 0 != linked;
 				}
 
 				BX_FREE(g_allocator, data);
@@ -1116,7 +1185,7 @@ namespace bgfx
 					GL_CHECK(glGetProgramBinary(m_id, programLength, NULL, &format, &data[4]) );
 					*(uint32_t*)data = format;
 
-					g_callback->cacheWrite(id, data, length);
+					s_renderCtx->cacheWrite(id, data, length);
 
 					BX_FREE(g_allocator, data);
 				}
@@ -1270,20 +1339,23 @@ namespace bgfx
 		}
 		m_used[used] = Attrib::Count;
 
-		used = 0;
-		for (uint32_t ii = 0; ii < BX_COUNTOF(s_instanceDataName); ++ii)
+		for (uint32_t ii = 0; ii < BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT; ++ii)
 		{
-			GLuint loc = glGetAttribLocation(m_id, s_instanceDataName[ii]);
-			if (GLuint(-1) != loc )
+			GLint loc = -1;
+			if (ii < BX_COUNTOF(s_instanceDataName) )
 			{
-				BX_TRACE("instance data %s: %d", s_instanceDataName[ii], loc);
-				m_instanceData[used++] = loc;
+				loc = glGetAttribLocation(m_id, s_instanceDataName[ii]);
+				if (-1 != loc)
+				{
+					BX_TRACE("instance data %s: %d", s_instanceDataName[ii], loc);
+				}
 			}
+
+			m_instanceData[ii] = loc;
 		}
-		m_instanceData[used] = 0xffff;
 	}
 
-	void Program::bindAttributes(const VertexDecl& _vertexDecl, uint32_t _baseVertex) const
+	void Program::bindAttributes(const VertexDecl& _vertexDecl, uint32_t _baseVertex, bool _disableUnused) const
 	{
 		for (uint32_t ii = 0; Attrib::Count != m_used[ii]; ++ii)
 		{
@@ -1306,7 +1378,7 @@ namespace bgfx
 					uint32_t baseVertex = _baseVertex*_vertexDecl.m_stride + _vertexDecl.m_offset[attr];
 					GL_CHECK(glVertexAttribPointer(loc, num, s_attribType[type], normalized, _vertexDecl.m_stride, (void*)(uintptr_t)baseVertex) );
 				}
-				else
+				else if (_disableUnused)
 				{
 					GL_CHECK(glDisableVertexAttribArray(loc) );
 				}
@@ -1314,15 +1386,19 @@ namespace bgfx
 		}
 	}
 
-	void Program::bindInstanceData(uint32_t _stride, uint32_t _baseVertex) const
+	void Program::bindInstanceData(uint32_t _stride, uint32_t _baseVertex, uint32_t _first) const
 	{
+		// Instance data stream provides i_data[_first, _first+_stride/16).
 		uint32_t baseVertex = _baseVertex;
-		for (uint32_t ii = 0; 0xffff != m_instanceData[ii]; ++ii)
+		for (uint32_t ii = _first, num = bx::uint32_min(_first+_stride/16, BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT); ii < num; ++ii)
 		{
 			GLint loc = m_instanceData[ii];
-			GL_CHECK(glEnableVertexAttribArray(loc) );
-			GL_CHECK(glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, _stride, (void*)(uintptr_t)baseVertex) );
-			GL_CHECK(s_vertexAttribDivisor(loc, 1) );
+			if (-1 != loc)
+			{
+				GL_CHECK(glEnableVertexAttribArray(loc) );
+				GL_CHECK(glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, _stride, (void*)(uintptr_t)baseVertex) );
+				GL_CHECK(s_vertexAttribDivisor(loc, 1) );
+			}
 			baseVertex += 16;
 		}
 	}
@@ -1447,6 +1523,18 @@ namespace bgfx
 		{
 			uint8_t numMips = imageContainer.m_numMips;
 
+			m_width  = uint16_t(imageContainer.m_width);
+			m_height = uint16_t(imageContainer.m_height);
+
+			// Without image copy storage can't be reallocated, full mip
+			// chain is allocated and sampling is clamped to base level.
+			m_lod = s_renderCtx->m_copyImageSupport
+				&& !imageContainer.m_cubeMap
+				&& 1 >= imageContainer.m_depth
+				? imageContainer.m_baseMip
+				: 0
+				;
+
 			GLenum target = GL_TEXTURE_2D;
 			if (imageContainer.m_cubeMap)
 			{
@@ -1459,7 +1547,7 @@ namespace bgfx
 
 			init(target
 				, imageContainer.m_format
-				, numMips
+				, numMips - m_lod
 				, _flags
 				);
 
@@ -1480,12 +1568,14 @@ namespace bgfx
 
 			for (uint8_t side = 0, numSides = imageContainer.m_cubeMap ? 6 : 1; side < numSides; ++side)
 			{
-				uint32_t width  = imageContainer.m_width;
-				uint32_t height = imageContainer.m_height;
+				uint32_t width  = imageContainer.m_width  >> m_lod;
+				uint32_t height = imageContainer.m_height >> m_lod;
 				uint32_t depth  = imageContainer.m_depth;
 
-				for (uint32_t lod = 0, num = numMips; lod < num; ++lod)
+				for (uint32_t lod = m_lod, num = numMips; lod < num; ++lod)
 				{
+					const uint32_t level = lod - m_lod;
+
 					width  = bx::uint32_max(min, width);
 					height = bx::uint32_max(min, height);
 					depth  = bx::uint32_max(1, depth);
@@ -1496,7 +1586,7 @@ namespace bgfx
 						if (compressed)
 						{
 							compressedTexImage(target+side
-								, lod
+								, level
 								, internalFmt
 								, width
 								, height
@@ -1523,7 +1613,7 @@ namespace bgfx
 							}
 
 							texImage(target+side
-								, lod
+								, level
 								, internalFmt
 								, width
 								, height
@@ -1545,7 +1635,7 @@ namespace bgfx
 										  ;
 
 							compressedTexImage(target+side
-								, lod
+								, level
 								, internalFmt
 								, width
 								, height
@@ -1558,7 +1648,7 @@ namespace bgfx
 						else
 						{
 							texImage(target+side
-								, lod
+								, level
 								, internalFmt
 								, width
 								, height
@@ -1581,6 +1671,14 @@ namespace bgfx
 			{
 				BX_FREE(g_allocator, temp);
 			}
+
+#if BGFX_CONFIG_RENDERER_OPENGL|BGFX_CONFIG_RENDERER_OPENGLES3
+			if (0 != imageContainer.m_baseMip
+			&&  0 == m_lod)
+			{
+				GL_CHECK(glTexParameteri(m_target, GL_TEXTURE_BASE_LEVEL, imageContainer.m_baseMip) );
+			}
+#endif // BGFX_CONFIG_RENDERER_OPENGL|BGFX_CONFIG_RENDERER_OPENGLES3
 		}
 
 		GL_CHECK(glBindTexture(m_target, 0) );
@@ -1667,6 +1765,73 @@ namespace bgfx
 		}
 	}
 
+	void Texture::updateResidency(uint8_t _lod)
+	{
+		if (!s_renderCtx->m_copyImageSupport
+		||  GL_TEXTURE_2D != m_target)
+		{
+#if BGFX_CONFIG_RENDERER_OPENGL|BGFX_CONFIG_RENDERER_OPENGLES3
+			GL_CHECK(glBindTexture(m_target, m_id) );
+			GL_CHECK(glTexParameteri(m_target, GL_TEXTURE_BASE_LEVEL, _lod) );
+			GL_CHECK(glBindTexture(m_target, 0) );
+#else
+			// GLES2 can't limit mip range, streaming texture will sample mip
+			// levels which were not uploaded.
+			BX_UNUSED(_lod);
+#endif // BGFX_CONFIG_RENDERER_OPENGL|BGFX_CONFIG_RENDERER_OPENGLES3
+			return;
+		}
+
+#if BGFX_CONFIG_RENDERER_OPENGL
+		if (_lod == m_lod)
+		{
+			return;
+		}
+
+		const GLuint  oldId   = m_id;
+		const uint8_t oldLod  = m_lod;
+		const uint8_t numMips = m_lod + m_numMips;
+
+		init(m_target, m_requestedFormat, numMips - _lod, m_flags);
+
+		const GLenum internalFmt = s_textureFormat[m_textureFormat].m_internalFmt;
+		const bool compressed    = TextureFormat::Unknown > m_textureFormat;
+
+		for (uint8_t lod = _lod; lod < numMips; ++lod)
+		{
+			const uint32_t width  = bx::uint32_max(1, m_width  >> lod);
+			const uint32_t height = bx::uint32_max(1, m_height >> lod);
+
+			if (compressed)
+			{
+				uint32_t size = bx::uint32_max(1, (width  + 3)>>2)
+							  * bx::uint32_max(1, (height + 3)>>2)
+							  * 4*4*getBitsPerPixel(TextureFormat::Enum(m_textureFormat) )/8
+							  ;
+
+				compressedTexImage(m_target, lod - _lod, internalFmt, width, height, 1, 0, size, NULL);
+			}
+			else
+			{
+				texImage(m_target, lod - _lod, internalFmt, width, height, 1, 0, m_fmt, m_type, NULL);
+			}
+
+			if (lod >= oldLod)
+			{
+				GL_CHECK(glCopyImageSubData(oldId, m_target, lod - oldLod, 0, 0, 0
+					, m_id, m_target, lod - _lod, 0, 0, 0
+					, width, height, 1
+					) );
+			}
+		}
+
+		GL_CHECK(glBindTexture(m_target, 0) );
+		GL_CHECK(glDeleteTextures(1, &oldId) );
+
+		m_lod = _lod;
+#endif // BGFX_CONFIG_RENDERER_OPENGL
+	}
+
 	void Texture::update(uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem)
 	{
 		BX_UNUSED(_z, _depth);
@@ -1711,7 +1876,7 @@ namespace bgfx
 			}
 
 			GL_CHECK(compressedTexSubImage(target+_side
-				, _mip
+				, _mip - m_lod
 				, _rect.m_x
 				, _rect.m_y
 				, _z
@@ -1746,7 +1911,7 @@ namespace bgfx
 			}
 
 			GL_CHECK(texSubImage(target+_side
-				, _mip
+				, _mip - m_lod
 				, _rect.m_x
 				, _rect.m_y
 				, _z
@@ -2321,12 +2486,19 @@ namespace bgfx
 		GL_CHECK(glBindTexture(GL_TEXTURE_2D, s_renderCtx->m_textures[m_texture.idx].m_id) );
 	}
 
-	void TextVideoMemBlitter::render(uint32_t _numIndices)
+	void TextVideoMemBlitter::updateVertexBuffer(uint32_t _startVertex, uint32_t _numVertices)
+	{
+		const uint32_t offset = _startVertex*m_decl.m_stride;
+		s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(offset, _numVertices*m_decl.m_stride, &m_vb->data[offset]);
+	}
+
+	void TextVideoMemBlitter::updateIndexBuffer(uint32_t _numIndices)
 	{
-		uint32_t numVertices = _numIndices*4/6;
 		s_renderCtx->m_indexBuffers[m_ib->handle.idx].update(0, _numIndices*2, m_ib->data);
-		s_renderCtx->m_vertexBuffers[m_vb->handle.idx].update(0, numVertices*m_decl.m_stride, m_vb->data);
+	}
 
+	void TextVideoMemBlitter::render(uint32_t _numIndices)
+	{
 		VertexBuffer& vb = s_renderCtx->m_vertexBuffers[m_vb->handle.idx];
 		GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vb.m_id) );
 
@@ -2733,6 +2905,10 @@ namespace bgfx
 						 ? BGFX_CAPS_FRAGMENT_DEPTH
 						 : 0
 						 ;
+		g_caps.supported |= !!(BGFX_CONFIG_RENDERER_OPENGL|BGFX_CONFIG_RENDERER_OPENGLES3)|s_extension[Extension::OES_element_index_uint].m_supported
+						 ? BGFX_CAPS_INDEX32
+						 : 0
+						 ;
 		g_caps.maxTextureSize = glGet(GL_MAX_TEXTURE_SIZE);
 
 		s_renderCtx->m_vaoSupport = !!BGFX_CONFIG_RENDERER_OPENGLES3
@@ -2762,6 +2938,12 @@ namespace bgfx
 			|| s_extension[Extension::IMG_shader_binary].m_supported
 			;
 
+		if (s_renderCtx->m_programBinarySupport
+		&&  NULL != g_programCacheFilePath)
+		{
+			s_renderCtx->m_programCache.open(g_programCacheFilePath, s_renderCtx->m_hash);
+		}
+
 		s_renderCtx->m_textureSwizzleSupport = false
 			|| s_extension[Extension::ARB_texture_swizzle].m_supported
 			|| s_extension[Extension::EXT_texture_swizzle].m_supported
@@ -2775,6 +2957,14 @@ namespace bgfx
 
 		g_caps.supported |= s_renderCtx->m_depthTextureSupport ? BGFX_CAPS_TEXTURE_DEPTH_MASK : 0;
 
+#if BGFX_CONFIG_RENDERER_OPENGL
+		s_renderCtx->m_copyImageSupport = s_extension[Extension::ARB_copy_image].m_supported
+			&& NULL != glCopyImageSubData
+			;
+#endif // BGFX_CONFIG_RENDERER_OPENGL
+
+		g_caps.supported |= s_renderCtx->m_copyImageSupport ? BGFX_CAPS_TEXTURE_RESIDENCY : 0;
+
 		if (s_extension[Extension::EXT_texture_filter_anisotropic].m_supported)
 		{
 			GL_CHECK(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_renderCtx->m_maxAnisotropy) );
@@ -2893,9 +3083,9 @@ namespace bgfx
 		s_renderCtx = NULL;
 	}
 
-	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem)
+	void Context::rendererCreateIndexBuffer(IndexBufferHandle _handle, Memory* _mem, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_mem->size, _mem->data, _flags);
 	}
 
 	void Context::rendererDestroyIndexBuffer(IndexBufferHandle _handle)
@@ -2924,9 +3114,9 @@ namespace bgfx
 		s_renderCtx->m_vertexBuffers[_handle.idx].destroy();
 	}
 
-	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size)
+	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _size, uint8_t _flags)
 	{
-		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL);
+		s_renderCtx->m_indexBuffers[_handle.idx].create(_size, NULL, _flags);
 	}
 
 	void Context::rendererUpdateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, Memory* _mem)
@@ -3008,6 +3198,11 @@ namespace bgfx
 		s_renderCtx->m_textures[_handle.idx].destroy();
 	}
 
+	void Context::rendererUpdateTextureResidency(TextureHandle _handle, uint8_t _lod)
+	{
+		s_renderCtx->m_textures[_handle.idx].updateResidency(_lod);
+	}
+
 	void Context::rendererCreateRenderTarget(RenderTargetHandle _handle, uint16_t _width, uint16_t _height, uint32_t _flags, uint32_t _textureFlags)
 	{
 		s_renderCtx->m_renderTargets[_handle.idx].create(_width, _height, _flags, _textureFlags);
@@ -3042,6 +3237,79 @@ namespace bgfx
 		bx::strlcpy(&s_viewName[_id][0], _name, sizeof(s_viewName[0][0]) );
 	}
 
+	void Context::rendererPrewarmProgramCache()
+	{
+		const ProgramCache& cache = s_renderCtx->m_programCache;
+		if (!cache.isOpen() )
+		{
+			BX_WARN(false, "Program cache is not set, or program binaries are not supported.");
+			return;
+		}
+
+		int64_t elapsed = -bx::getHPCounter();
+
+		uint32_t num = 0;
+		uint32_t maxSize = 0;
+		void* data = NULL;
+
+		const ProgramCache::EntryMap& entries = cache.getEntries();
+		for (ProgramCache::EntryMap::const_iterator it = entries.begin(), itEnd = entries.end(); it != itEnd; ++it)
+		{
+			const uint64_t id = it->first;
+			const uint32_t size = it->second.m_size;
+
+			if (size <= sizeof(GLenum)
+			||  s_renderCtx->m_prewarmed.end() != s_renderCtx->m_prewarmed.find(id) )
+			{
+				continue;
+			}
+
+			if (maxSize < size)
+			{
+				maxSize = size;
+				data = BX_REALLOC(g_allocator, data, maxSize);
+			}
+
+			if (!cache.read(id, data, size) )
+			{
+				continue;
+			}
+
+			bx::MemoryReader reader(data, size);
+
+			GLenum format;
+			bx::read(&reader, format);
+
+			GLuint program = glCreateProgram();
+			GL_CHECK(glProgramBinary(program, format, reader.getDataPtr(), (GLsizei)reader.remaining() ) );
+
+			GLint linked = 0;
+			GL_CHECK(glGetProgramiv(program, GL_LINK_STATUS, &linked) );
+
+			if (0 == linked)
+			{
+				GL_CHECK(glDeleteProgram(program) );
+				continue;
+			}
+
+			s_renderCtx->m_prewarmed.insert(stl::make_pair(id, program) );
+			++num;
+		}
+
+		if (NULL != data)
+		{
+			BX_FREE(g_allocator, data);
+		}
+
+		elapsed += bx::getHPCounter();
+		BX_TRACE("Program cache prewarm: %d of %d programs, %0.3f ms."
+			, num
+			, (uint32_t)entries.size()
+			, double(elapsed)*1000.0/double(bx::getHPFrequency() )
+			);
+		BX_UNUSED(num, elapsed);
+	}
+
 	void Context::rendererUpdateUniform(uint16_t _loc, const void* _data, uint32_t _size)
 	{
 		memcpy(s_renderCtx->m_uniforms[_loc], _data, _size);
@@ -3080,6 +3348,12 @@ namespace bgfx
 			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_iboffset, ib->data);
 		}
 
+		if (0 < m_render->m_ib32offset)
+		{
+			TransientIndexBuffer* ib = m_render->m_transientIb32;
+			s_renderCtx->m_indexBuffers[ib->handle.idx].update(0, m_render->m_ib32offset, ib->data);
+		}
+
 		if (0 < m_render->m_vboffset)
 		{
 			TransientVertexBuffer* vb = m_render->m_transientVb;
@@ -3573,32 +3847,45 @@ namespace bgfx
 						}
 					}
 
+					bool streamStartZero = true;
+					for (uint32_t stream = 0; stream < state.m_numStreams; ++stream)
+					{
+						streamStartZero &= 0 == state.m_stream[stream].m_startVertex;
+					}
+
+					for (uint32_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+					{
+						streamStartZero &= 0 == state.m_instanceData[stream].m_offset;
+					}
+
 					if (0 != defaultVao
-					&&  0 == state.m_startVertex
-					&&  0 == state.m_instanceDataOffset)
+					&&  streamStartZero)
 					{
 						if (programChanged
-						||  currentState.m_vertexBuffer.idx != state.m_vertexBuffer.idx
+						||  currentState.isStreamChanged(state)
 						||  currentState.m_indexBuffer.idx != state.m_indexBuffer.idx
-						||  currentState.m_instanceDataBuffer.idx != state.m_instanceDataBuffer.idx
-						||  currentState.m_instanceDataOffset != state.m_instanceDataOffset
-						||  currentState.m_instanceDataStride != state.m_instanceDataStride)
+						||  currentState.isInstanceDataChanged(state) )
 						{
 							bx::HashMurmur2A murmur;
 							murmur.begin();
-							murmur.add(state.m_vertexBuffer.idx);
+							for (uint32_t stream = 0, num = bx::uint32_max(1, state.m_numStreams); stream < num; ++stream)
+							{
+								murmur.add(state.m_stream[stream].m_handle.idx);
+								murmur.add(state.m_stream[stream].m_decl.idx);
+							}
 							murmur.add(state.m_indexBuffer.idx);
-							murmur.add(state.m_instanceDataBuffer.idx);
-							murmur.add(state.m_instanceDataOffset);
-							murmur.add(state.m_instanceDataStride);
+							for (uint32_t stream = 0; stream < state.m_numInstanceDataStreams; ++stream)
+							{
+								murmur.add(state.m_instanceData[stream].m_handle.idx);
+								murmur.add(state.m_instanceData[stream].m_stride);
+							}
 							murmur.add(programIdx);
 							uint32_t hash = murmur.end();
 
-							currentState.m_vertexBuffer = state.m_vertexBuffer;
+							currentState.setStreams(state);
 							currentState.m_indexBuffer = state.m_indexBuffer;
-							currentState.m_instanceDataOffset = state.m_instanceDataOffset;
-							currentState.m_instanceDataStride = state.m_instanceDataStride;
-							baseVertex = state.m_startVertex;
+							currentState.setInstanceData(state);
+							baseVertex = state.m_stream[0].m_startVertex;
 
 							GLuint id = s_renderCtx->m_vaoStateCache.find(hash);
 							if (UINT32_MAX != id)
@@ -3615,21 +3902,27 @@ namespace bgfx
 								Program& program = s_renderCtx->m_program[programIdx];
 								program.add(hash);
 
-								if (isValid(state.m_vertexBuffer) )
+								if (isValid(state.m_stream[0].m_handle) )
 								{
-									VertexBuffer& vb = s_renderCtx->m_vertexBuffers[state.m_vertexBuffer.idx];
-									vb.add(hash);
-									GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vb.m_id) );
+									for (uint32_t stream = 0; stream < state.m_numStreams; ++stream)
+									{
+										const Stream& st = state.m_stream[stream];
+										VertexBuffer& vb = s_renderCtx->m_vertexBuffers[st.m_handle.idx];
+										vb.add(hash);
+										GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vb.m_id) );
 
-									uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
-									program.bindAttributes(s_renderCtx->m_vertexDecls[decl], state.m_startVertex);
+										uint16_t decl = !isValid(vb.m_decl) ? st.m_decl.idx : vb.m_decl.idx;
+										program.bindAttributes(s_renderCtx->m_vertexDecls[decl], st.m_startVertex, 0 == stream);
+									}
 
-									if (isValid(state.m_instanceDataBuffer) )
+									for (uint32_t stream = 0, first = 0; stream < state.m_numInstanceDataStreams; ++stream)
 									{
-										VertexBuffer& instanceVb = s_renderCtx->m_vertexBuffers[state.m_instanceDataBuffer.idx];
+										const InstanceDataStream& inst = state.m_instanceData[stream];
+										VertexBuffer& instanceVb = s_renderCtx->m_vertexBuffers[inst.m_handle.idx];
 										instanceVb.add(hash);
 										GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, instanceVb.m_id) );
-										program.bindInstanceData(state.m_instanceDataStride, state.m_instanceDataOffset);
+										program.bindInstanceData(inst.m_stride, inst.m_offset, first);
+										first += inst.m_stride/16;
 									}
 								}
 								else
@@ -3656,24 +3949,21 @@ namespace bgfx
 						&&  0 != currentVao)
 						{
 							GL_CHECK(glBindVertexArray(defaultVao) );
-							currentState.m_vertexBuffer.idx = invalidHandle;
+							currentState.m_numStreams = 0;
+							currentState.m_stream[0].m_handle.idx = invalidHandle;
 							currentState.m_indexBuffer.idx = invalidHandle;
 							bindAttribs = true;
 							currentVao = 0;
 						}
 
 						if (programChanged
-						||  currentState.m_vertexBuffer.idx != state.m_vertexBuffer.idx
-						||  currentState.m_instanceDataBuffer.idx != state.m_instanceDataBuffer.idx
-						||  currentState.m_instanceDataOffset != state.m_instanceDataOffset
-						||  currentState.m_instanceDataStride != state.m_instanceDataStride)
+						||  currentState.isStreamChanged(state)
+						||  currentState.isInstanceDataChanged(state) )
 						{
-							currentState.m_vertexBuffer = state.m_vertexBuffer;
-							currentState.m_instanceDataBuffer.idx = state.m_instanceDataBuffer.idx;
-							currentState.m_instanceDataOffset = state.m_instanceDataOffset;
-							currentState.m_instanceDataStride = state.m_instanceDataStride;
+							currentState.setStreams(state);
+							currentState.setInstanceData(state);
 
-							uint16_t handle = state.m_vertexBuffer.idx;
+							uint16_t handle = state.m_stream[0].m_handle.idx;
 							if (invalidHandle != handle)
 							{
 								VertexBuffer& vb = s_renderCtx->m_vertexBuffers[handle];
@@ -3702,33 +3992,45 @@ namespace bgfx
 							}
 						}
 
-						if (isValid(currentState.m_vertexBuffer) )
+						if (isValid(currentState.m_stream[0].m_handle) )
 						{
-							if (baseVertex != state.m_startVertex
+							if (baseVertex != state.m_stream[0].m_startVertex
 							||  bindAttribs)
 							{
-								baseVertex = state.m_startVertex;
-								const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[state.m_vertexBuffer.idx];
-								uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
+								baseVertex = state.m_stream[0].m_startVertex;
 								const Program& program = s_renderCtx->m_program[programIdx];
-								program.bindAttributes(s_renderCtx->m_vertexDecls[decl], state.m_startVertex);
 
-								if (isValid(state.m_instanceDataBuffer) )
+								for (uint32_t stream = 0; stream < state.m_numStreams; ++stream)
+								{
+									const Stream& st = state.m_stream[stream];
+									const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[st.m_handle.idx];
+									if (0 != stream)
+									{
+										GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vb.m_id) );
+									}
+
+									uint16_t decl = !isValid(vb.m_decl) ? st.m_decl.idx : vb.m_decl.idx;
+									program.bindAttributes(s_renderCtx->m_vertexDecls[decl], st.m_startVertex, 0 == stream);
+								}
+
+								for (uint32_t stream = 0, first = 0; stream < state.m_numInstanceDataStreams; ++stream)
 								{
-									GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, s_renderCtx->m_vertexBuffers[state.m_instanceDataBuffer.idx].m_id) );
-									program.bindInstanceData(state.m_instanceDataStride, state.m_instanceDataOffset);
+									const InstanceDataStream& inst = state.m_instanceData[stream];
+									GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, s_renderCtx->m_vertexBuffers[inst.m_handle.idx].m_id) );
+									program.bindInstanceData(inst.m_stride, inst.m_offset, first);
+									first += inst.m_stride/16;
 								}
 							}
 						}
 					}
 
-					if (isValid(currentState.m_vertexBuffer) )
+					if (isValid(currentState.m_stream[0].m_handle) )
 					{
 						uint32_t numVertices = state.m_numVertices;
 						if (UINT32_MAX == numVertices)
 						{
-							const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_vertexBuffer.idx];
-							uint16_t decl = !isValid(vb.m_decl) ? state.m_vertexDecl.idx : vb.m_decl.idx;
+							const VertexBuffer& vb = s_renderCtx->m_vertexBuffers[currentState.m_stream[0].m_handle.idx];
+							uint16_t decl = !isValid(vb.m_decl) ? state.m_stream[0].m_decl.idx : vb.m_decl.idx;
 							const VertexDecl& vertexDecl = s_renderCtx->m_vertexDecls[decl];
 							numVertices = vb.m_size/vertexDecl.m_stride;
 						}
@@ -3740,16 +4042,21 @@ namespace bgfx
 
 						if (isValid(state.m_indexBuffer) )
 						{
+							const IndexBuffer& ib = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx];
+							const bool index32 = 0 != (ib.m_flags & BGFX_BUFFER_INDEX32);
+							const uint32_t indexSize = index32 ? 4 : 2;
+							const GLenum indexFormat = index32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+
 							if (UINT32_MAX == state.m_numIndices)
 							{
-								numIndices = s_renderCtx->m_indexBuffers[state.m_indexBuffer.idx].m_size/2;
+								numIndices = ib.m_size/indexSize;
 								numPrimsSubmitted = numIndices/primNumVerts;
 								numInstances = state.m_numInstances;
 								numPrimsRendered = numPrimsSubmitted*state.m_numInstances;
 
 								GL_CHECK(s_drawElementsInstanced(primType
 									, numIndices
-									, GL_UNSIGNED_SHORT
+									, indexFormat
 									, (void*)0
 									, state.m_numInstances
 									) );
@@ -3763,8 +4070,8 @@ namespace bgfx
 
 								GL_CHECK(s_drawElementsInstanced(primType
 									, numIndices
-									, GL_UNSIGNED_SHORT
-									, (void*)(uintptr_t)(state.m_startIndex*2)
+									, indexFormat
+									, (void*)(uintptr_t)(state.m_startIndex*indexSize)
 									, state.m_numInstances
 									) );
 							}
@@ -487,9 +487,10 @@ namespace bgfx
 
 	struct IndexBuffer
 	{
-		void create(uint32_t _size, void* _data)
+		void create(uint32_t _size, void* _data, uint8_t _flags)
 		{
 			m_size = _size;
+			m_flags = _flags;
 
 			GL_CHECK(glGenBuffers(1, &m_id) );
 			BX_CHECK(0 != m_id, "Failed to generate buffer id.");
@@ -523,6 +524,7 @@ namespace bgfx
 
 		GLuint m_id;
 		uint32_t m_size;
+		uint8_t m_flags;
 		VaoCacheRef m_vcref;
 	};
 
@@ -578,6 +580,9 @@ namespace bgfx
 			, m_type(GL_ZERO)
 			, m_flags(0)
 			, m_currentFlags(UINT32_MAX)
+			, m_width(0)
+			, m_height(0)
+			, m_lod(0)
 			, m_numMips(0)
 		{
 		}
@@ -588,6 +593,7 @@ namespace bgfx
 		void createDepth(uint32_t _width, uint32_t _height);
 		void destroy();
 		void update(uint8_t _side, uint8_t _mip, const Rect& _rect, uint16_t _z, uint16_t _depth, uint16_t _pitch, const Memory* _mem);
+		void updateResidency(uint8_t _lod);
 		void setSamplerState(uint32_t _flags);
 		void commit(uint32_t _stage, uint32_t _flags);
 
@@ -597,6 +603,9 @@ namespace bgfx
 		GLenum m_type;
 		uint32_t m_flags;
 		uint32_t m_currentFlags;
+		uint16_t m_width;  // Size of mip level 0, storage holds mip levels from m_lod.
+		uint16_t m_height;
+		uint8_t m_lod;
 		uint8_t m_numMips;
 		uint8_t m_requestedFormat;
 		uint8_t m_textureFormat;
@@ -653,8 +662,8 @@ namespace bgfx
 		void create(const Shader& _vsh, const Shader& _fsh);
 		void destroy();
  		void init();
- 		void bindAttributes(const VertexDecl& _vertexDecl, uint32_t _baseVertex = 0) const;
-		void bindInstanceData(uint32_t _stride, uint32_t _baseVertex = 0) const;
+ 		void bindAttributes(const VertexDecl& _vertexDecl, uint32_t _baseVertex = 0, bool _disableUnused = true) const;
+		void bindInstanceData(uint32_t _stride, uint32_t _baseVertex = 0, uint32_t _first = 0) const;
 
 		void commit()
 		{
@@ -670,7 +679,7 @@ namespace bgfx
 
 		uint8_t m_used[Attrib::Count+1]; // dense
 		GLint m_attributes[Attrib::Count]; // sparse
-		GLint m_instanceData[BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
+		GLint m_instanceData[BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT]; // sparse
 
  		GLint m_sampler[BGFX_CONFIG_MAX_TEXTURES];
  		uint8_t m_numSamplers;
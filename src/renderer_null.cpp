@@ -17,6 +17,14 @@ namespace bgfx
 	{
 	}
 
+	void TextVideoMemBlitter::updateVertexBuffer(uint32_t /*_startVertex*/, uint32_t /*_numVertices*/)
+	{
+	}
+
+	void TextVideoMemBlitter::updateIndexBuffer(uint32_t /*_numIndices*/)
+	{
+	}
+
 	void TextVideoMemBlitter::render(uint32_t /*_numIndices*/)
 	{
 	}
@@ -33,7 +41,7 @@ namespace bgfx
 	{
 	}
 
-	void Context::rendererCreateIndexBuffer(IndexBufferHandle /*_handle*/, Memory* /*_mem*/)
+	void Context::rendererCreateIndexBuffer(IndexBufferHandle /*_handle*/, Memory* /*_mem*/, uint8_t /*_flags*/)
 	{
 	}
 
@@ -57,7 +65,7 @@ namespace bgfx
 	{
 	}
 
-	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle /*_handle*/, uint32_t /*_size*/)
+	void Context::rendererCreateDynamicIndexBuffer(IndexBufferHandle /*_handle*/, uint32_t /*_size*/, uint8_t /*_flags*/)
 	{
 	}
 
@@ -125,6 +133,10 @@ namespace bgfx
 	{
 	}
 
+	void Context::rendererUpdateTextureResidency(TextureHandle /*_handle*/, uint8_t /*_lod*/)
+	{
+	}
+
 	void Context::rendererCreateRenderTarget(RenderTargetHandle /*_handle*/, uint16_t /*_width*/, uint16_t /*_height*/, uint32_t /*_flags*/, uint32_t /*_textureFlags*/)
 	{
 	}
@@ -149,6 +161,10 @@ namespace bgfx
 	{
 	}
 
+	void Context::rendererPrewarmProgramCache()
+	{
+	}
+
 	void Context::rendererUpdateUniform(uint16_t /*_loc*/, const void* /*_data*/, uint32_t /*_size*/)
 	{
 	}
@@ -4,6 +4,7 @@
  */
 
 #include <string.h>
+#include <bx/allocator.h>
 #include <bx/debug.h>
 #include <bx/hash.h>
 #include <bx/uint32_t.h>
@@ -11,8 +12,26 @@
 
 #include "vertexdecl.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define BGFX_VERTEX_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define BGFX_VERTEX_SSE2 0
+#endif // SSE2
+
+#if !BGFX_VERTEX_SSE2 && (defined(__ARM_NEON__) || defined(__ARM_NEON) )
+#	define BGFX_VERTEX_NEON 1
+#	include <arm_neon.h>
+#else
+#	define BGFX_VERTEX_NEON 0
+#endif // NEON
+
+#define BGFX_VERTEX_SIMD (BGFX_VERTEX_SSE2|BGFX_VERTEX_NEON)
+
 namespace bgfx
 {
+	extern bx::ReallocatorI* g_allocator;
+
 	static const uint8_t s_attribTypeSizeDx9[AttribType::Count][4] =
 	{
 		{  4,  4,  4,  4 },
@@ -391,32 +410,593 @@ namespace bgfx
 		}
 	}
 
-	void vertexConvert(const VertexDecl& _destDecl, void* _destData, const VertexDecl& _srcDecl, const void* _srcData, uint32_t _num)
+	struct VertexAttribFormat
 	{
-		if (_destDecl.m_hash == _srcDecl.m_hash)
+		AttribType::Enum m_type;
+		uint8_t m_num;
+		bool m_asInt;
+	};
+
+	static void decodeFormat(VertexAttribFormat& _format, const VertexDecl& _decl, Attrib::Enum _attr)
+	{
+		bool normalized;
+		_decl.decode(_attr, _format.m_num, _format.m_type, normalized, _format.m_asInt);
+	}
+
+	static const uint8_t s_attribTypeElementSize[AttribType::Count] = { 1, 2, 2, 4 };
+
+	// Bytes read per vertex by batch unpack kernels.
+	static const uint8_t s_attribTypeLoadSize[AttribType::Count] = { 4, 8, 8, 16 };
+
+	// Batch unpack computes (value + bias)/scale, indexed by [type][asInt].
+	// Same expression as vertexUnpack, so results are bit exact.
+	static const float s_unpackBiasScale[AttribType::Count][2][2] =
+	{
+		{ {     0.0f,   255.0f }, { -128.0f,   127.0f } },
+		{ { 32768.0f, 65535.0f }, {    0.0f, 32767.0f } },
+		{ {     0.0f,     1.0f }, {    0.0f,     1.0f } },
+		{ {     0.0f,     1.0f }, {    0.0f,     1.0f } },
+	};
+
+	// Batch pack of normalized input computes value*scale + bias, indexed
+	// by [type][asInt]. Same expression as vertexPack.
+	static const float s_packScaleBias[AttribType::Count][2][2] =
+	{
+		{ {   255.0f,      0.0f }, {   127.0f, 128.0f } },
+		{ { 65535.0f, -32768.0f }, { 32767.0f,   0.0f } },
+		{ {     1.0f,      0.0f }, {     1.0f,   0.0f } },
+		{ {     1.0f,      0.0f }, {     1.0f,   0.0f } },
+	};
+
+	inline void memcpySmall(uint8_t* _dst, const uint8_t* _src, uint32_t _size)
+	{
+		// Fixed size copies are inlined.
+		switch (_size)
 		{
-			memcpy(_destData, _srcData, _srcDecl.getSize(_num) );
+		case  1: memcpy(_dst, _src,  1); break;
+		case  2: memcpy(_dst, _src,  2); break;
+		case  3: memcpy(_dst, _src,  3); break;
+		case  4: memcpy(_dst, _src,  4); break;
+		case  6: memcpy(_dst, _src,  6); break;
+		case  8: memcpy(_dst, _src,  8); break;
+		case 12: memcpy(_dst, _src, 12); break;
+		case 16: memcpy(_dst, _src, 16); break;
+		default: memcpy(_dst, _src, _size); break;
+		}
+	}
+
+#if BGFX_VERTEX_SSE2
+	typedef __m128  vec4f_t;
+	typedef __m128i vec4i_t;
+
+	inline vec4i_t vec4i_splat(uint32_t _a) { return _mm_set1_epi32(int32_t(_a) ); }
+	inline vec4i_t vec4i_ldu(const void* _ptr) { return _mm_loadu_si128( (const __m128i*)_ptr); }
+	inline vec4i_t vec4i_and(vec4i_t _a, vec4i_t _b) { return _mm_and_si128(_a, _b); }
+	inline vec4i_t vec4i_or(vec4i_t _a, vec4i_t _b) { return _mm_or_si128(_a, _b); }
+	inline vec4i_t vec4i_add(vec4i_t _a, vec4i_t _b) { return _mm_add_epi32(_a, _b); }
+	inline vec4i_t vec4i_sub(vec4i_t _a, vec4i_t _b) { return _mm_sub_epi32(_a, _b); }
+	inline vec4i_t vec4i_sll(vec4i_t _a, int _count) { return _mm_sll_epi32(_a, _mm_cvtsi32_si128(_count) ); }
+	inline vec4i_t vec4i_srl(vec4i_t _a, int _count) { return _mm_srl_epi32(_a, _mm_cvtsi32_si128(_count) ); }
+	inline vec4i_t vec4i_cmpeq(vec4i_t _a, vec4i_t _b) { return _mm_cmpeq_epi32(_a, _b); }
+	inline vec4i_t vec4i_cmpgt(vec4i_t _a, vec4i_t _b) { return _mm_cmpgt_epi32(_a, _b); }
+	inline bool vec4i_test_all(vec4i_t _mask) { return 0xf == _mm_movemask_ps(_mm_castsi128_ps(_mask) ); }
+	inline vec4i_t vec4i_ftoi(vec4f_t _a) { return _mm_cvttps_epi32(_a); }
+	inline vec4i_t vec4i_asint(vec4f_t _a) { return _mm_castps_si128(_a); }
+
+	inline vec4i_t vec4i_ldu8(const uint8_t* _ptr)
+	{
+		uint32_t packed;
+		memcpy(&packed, _ptr, 4);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i tmp  = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int32_t(packed) ), zero);
+		return _mm_unpacklo_epi16(tmp, zero);
+	}
+
+	inline vec4i_t vec4i_ldi16(const uint8_t* _ptr)
+	{
+		const __m128i tmp = _mm_loadl_epi64( (const __m128i*)_ptr);
+		return _mm_srai_epi32(_mm_unpacklo_epi16(tmp, tmp), 16);
+	}
+
+	inline vec4i_t vec4i_ldu16(const uint8_t* _ptr)
+	{
+		const __m128i tmp = _mm_loadl_epi64( (const __m128i*)_ptr);
+		return _mm_unpacklo_epi16(tmp, _mm_setzero_si128() );
+	}
+
+	inline void vec4i_stu8(uint8_t* _ptr, vec4i_t _a)
+	{
+		// Keep low 8 bits of every lane, same as integer truncation.
+		const __m128i tmp0 = _mm_and_si128(_a, _mm_set1_epi32(0xff) );
+		const __m128i tmp1 = _mm_packs_epi32(tmp0, tmp0);
+		const __m128i tmp2 = _mm_packus_epi16(tmp1, tmp1);
+		const uint32_t packed = uint32_t(_mm_cvtsi128_si32(tmp2) );
+		memcpy(_ptr, &packed, 4);
+	}
+
+	inline void vec4i_sti16(uint8_t* _ptr, vec4i_t _a)
+	{
+		// Keep low 16 bits of every lane, same as integer truncation.
+		const __m128i tmp = _mm_srai_epi32(_mm_slli_epi32(_a, 16), 16);
+		_mm_storel_epi64( (__m128i*)_ptr, _mm_packs_epi32(tmp, tmp) );
+	}
+
+	inline vec4f_t vec4f_splat(float _a) { return _mm_set1_ps(_a); }
+	inline vec4f_t vec4f_ldu(const void* _ptr) { return _mm_loadu_ps( (const float*)_ptr); }
+	inline void vec4f_stu(void* _ptr, vec4f_t _a) { _mm_storeu_ps( (float*)_ptr, _a); }
+	inline vec4f_t vec4f_add(vec4f_t _a, vec4f_t _b) { return _mm_add_ps(_a, _b); }
+	inline vec4f_t vec4f_mul(vec4f_t _a, vec4f_t _b) { return _mm_mul_ps(_a, _b); }
+	inline vec4f_t vec4f_div(vec4f_t _a, vec4f_t _b) { return _mm_div_ps(_a, _b); }
+	inline vec4f_t vec4f_itof(vec4i_t _a) { return _mm_cvtepi32_ps(_a); }
+	inline vec4f_t vec4f_asfloat(vec4i_t _a) { return _mm_castsi128_ps(_a); }
+#elif BGFX_VERTEX_NEON
+	typedef float32x4_t vec4f_t;
+	typedef int32x4_t   vec4i_t;
+
+	inline vec4i_t vec4i_splat(uint32_t _a) { return vdupq_n_s32(int32_t(_a) ); }
+	inline vec4i_t vec4i_ldu(const void* _ptr) { int32_t tmp[4]; memcpy(tmp, _ptr, 16); return vld1q_s32(tmp); }
+	inline vec4i_t vec4i_and(vec4i_t _a, vec4i_t _b) { return vandq_s32(_a, _b); }
+	inline vec4i_t vec4i_or(vec4i_t _a, vec4i_t _b) { return vorrq_s32(_a, _b); }
+	inline vec4i_t vec4i_add(vec4i_t _a, vec4i_t _b) { return vaddq_s32(_a, _b); }
+	inline vec4i_t vec4i_sub(vec4i_t _a, vec4i_t _b) { return vsubq_s32(_a, _b); }
+	inline vec4i_t vec4i_sll(vec4i_t _a, int _count) { return vshlq_s32(_a, vdupq_n_s32(_count) ); }
+	inline vec4i_t vec4i_srl(vec4i_t _a, int _count) { return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(_a), vdupq_n_s32(-_count) ) ); }
+	inline vec4i_t vec4i_cmpeq(vec4i_t _a, vec4i_t _b) { return vreinterpretq_s32_u32(vceqq_s32(_a, _b) ); }
+	inline vec4i_t vec4i_cmpgt(vec4i_t _a, vec4i_t _b) { return vreinterpretq_s32_u32(vcgtq_s32(_a, _b) ); }
+	inline vec4i_t vec4i_ftoi(vec4f_t _a) { return vcvtq_s32_f32(_a); }
+	inline vec4i_t vec4i_asint(vec4f_t _a) { return vreinterpretq_s32_f32(_a); }
+
+	inline bool vec4i_test_all(vec4i_t _mask)
+	{
+		const uint32x4_t mask = vreinterpretq_u32_s32(_mask);
+		const uint32x2_t tmp  = vand_u32(vget_low_u32(mask), vget_high_u32(mask) );
+		return UINT32_MAX == (vget_lane_u32(tmp, 0) & vget_lane_u32(tmp, 1) );
+	}
+
+	inline vec4i_t vec4i_ldu8(const uint8_t* _ptr)
+	{
+		uint32_t packed;
+		memcpy(&packed, _ptr, 4);
+		const uint16x8_t tmp = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed) ) );
+		return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(tmp) ) );
+	}
+
+	inline vec4i_t vec4i_ldi16(const uint8_t* _ptr)
+	{
+		uint64_t packed;
+		memcpy(&packed, _ptr, 8);
+		return vmovl_s16(vcreate_s16(packed) );
+	}
+
+	inline vec4i_t vec4i_ldu16(const uint8_t* _ptr)
+	{
+		uint64_t packed;
+		memcpy(&packed, _ptr, 8);
+		return vreinterpretq_s32_u32(vmovl_u16(vcreate_u16(packed) ) );
+	}
+
+	inline void vec4i_stu8(uint8_t* _ptr, vec4i_t _a)
+	{
+		// Narrowing keeps low bits of every lane, same as integer truncation.
+		const int16x4_t tmp0 = vmovn_s32(_a);
+		const int8x8_t  tmp1 = vmovn_s16(vcombine_s16(tmp0, tmp0) );
+		const uint32_t packed = vget_lane_u32(vreinterpret_u32_s8(tmp1), 0);
+		memcpy(_ptr, &packed, 4);
+	}
+
+	inline void vec4i_sti16(uint8_t* _ptr, vec4i_t _a)
+	{
+		const uint64_t packed = vget_lane_u64(vreinterpret_u64_s16(vmovn_s32(_a) ), 0);
+		memcpy(_ptr, &packed, 8);
+	}
+
+	inline vec4f_t vec4f_splat(float _a) { return vdupq_n_f32(_a); }
+	inline vec4f_t vec4f_ldu(const void* _ptr) { float tmp[4]; memcpy(tmp, _ptr, 16); return vld1q_f32(tmp); }
+	inline void vec4f_stu(void* _ptr, vec4f_t _a) { float tmp[4]; vst1q_f32(tmp, _a); memcpy(_ptr, tmp, 16); }
+	inline vec4f_t vec4f_add(vec4f_t _a, vec4f_t _b) { return vaddq_f32(_a, _b); }
+	inline vec4f_t vec4f_mul(vec4f_t _a, vec4f_t _b) { return vmulq_f32(_a, _b); }
+	inline vec4f_t vec4f_itof(vec4i_t _a) { return vcvtq_f32_s32(_a); }
+	inline vec4f_t vec4f_asfloat(vec4i_t _a) { return vreinterpretq_f32_s32(_a); }
+
+	inline vec4f_t vec4f_div(vec4f_t _a, vec4f_t _b)
+	{
+#	if defined(__aarch64__)
+		return vdivq_f32(_a, _b);
+#	else
+		// ARMv7 NEON has only reciprocal estimate, divide per lane to match
+		// scalar results exactly.
+		float aa[4];
+		float bb[4];
+		vst1q_f32(aa, _a);
+		vst1q_f32(bb, _b);
+		aa[0] /= bb[0];
+		aa[1] /= bb[1];
+		aa[2] /= bb[2];
+		aa[3] /= bb[3];
+		return vld1q_f32(aa);
+#	endif // defined(__aarch64__)
+	}
+#endif // BGFX_VERTEX_NEON
+
+#if BGFX_VERTEX_SIMD
+	static const uint32_t s_laneMask[4][4] =
+	{
+		{ UINT32_MAX,          0,          0,          0 },
+		{ UINT32_MAX, UINT32_MAX,          0,          0 },
+		{ UINT32_MAX, UINT32_MAX, UINT32_MAX,          0 },
+		{ UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX },
+	};
+
+	struct VertexKernel
+	{
+		vec4f_t m_scale;
+		vec4f_t m_bias;
+		vec4i_t m_mask;
+	};
+
+	static void initKernel(VertexKernel& _kernel, const VertexAttribFormat& _format, float _scale, float _bias)
+	{
+		_kernel.m_scale = vec4f_splat(_scale);
+		_kernel.m_bias  = vec4f_splat(_bias);
+		_kernel.m_mask  = vec4i_ldu(s_laneMask[_format.m_num-1]);
+	}
+
+	inline vec4i_t halfFromFloat4(vec4f_t _a)
+	{
+		const vec4i_t bits   = vec4i_asint(_a);
+		const vec4i_t abs    = vec4i_and(bits, vec4i_splat(0x7fffffff) );
+		const vec4i_t sign   = vec4i_and(vec4i_srl(bits, 16), vec4i_splat(0x8000) );
+		const vec4i_t exp    = vec4i_srl(abs, 23);
+		const vec4i_t normal = vec4i_and(vec4i_cmpgt(exp, vec4i_splat(112) ), vec4i_cmpgt(vec4i_splat(143), exp) );
+		const vec4i_t zero   = vec4i_cmpeq(abs, vec4i_splat(0) );
+
+		if (!vec4i_test_all(vec4i_or(normal, zero) ) )
+		{
+			// Denormal, overflow, Inf or NaN.
+			float value[4];
+			uint32_t result[4];
+			vec4f_stu(value, _a);
+			result[0] = bx::halfFromFloat(value[0]);
+			result[1] = bx::halfFromFloat(value[1]);
+			result[2] = bx::halfFromFloat(value[2]);
+			result[3] = bx::halfFromFloat(value[3]);
+			return vec4i_ldu(result);
+		}
+
+		// Round half up same as bx::halfFromFloat. Mantissa overflow carries
+		// into exponent.
+		const vec4i_t mant    = vec4i_and(abs, vec4i_splat(0x007fffff) );
+		const vec4i_t rounded = vec4i_add(mant, vec4i_sll(vec4i_and(mant, vec4i_splat(0x00001000) ), 1) );
+		const vec4i_t em      = vec4i_add(vec4i_sll(vec4i_sub(exp, vec4i_splat(112) ), 10), vec4i_srl(rounded, 13) );
+		return vec4i_or(vec4i_and(em, normal), sign);
+	}
+
+	inline vec4f_t halfToFloat4(vec4i_t _a)
+	{
+		const vec4i_t exp    = vec4i_and(vec4i_srl(_a, 10), vec4i_splat(0x1f) );
+		const vec4i_t abs    = vec4i_and(_a, vec4i_splat(0x7fff) );
+		const vec4i_t normal = vec4i_and(vec4i_cmpgt(exp, vec4i_splat(0) ), vec4i_cmpgt(vec4i_splat(31), exp) );
+		const vec4i_t zero   = vec4i_cmpeq(abs, vec4i_splat(0) );
+
+		if (!vec4i_test_all(vec4i_or(normal, zero) ) )
+		{
+			// Denormal, Inf or NaN.
+			uint32_t value[4];
+			float result[4];
+			memcpy(value, &_a, sizeof(value) );
+			result[0] = bx::halfToFloat(uint16_t(value[0]) );
+			result[1] = bx::halfToFloat(uint16_t(value[1]) );
+			result[2] = bx::halfToFloat(uint16_t(value[2]) );
+			result[3] = bx::halfToFloat(uint16_t(value[3]) );
+			return vec4f_ldu(result);
+		}
+
+		const vec4i_t sign = vec4i_sll(vec4i_and(_a, vec4i_splat(0x8000) ), 16);
+		const vec4i_t em   = vec4i_add(vec4i_sll(abs, 13), vec4i_splat(112<<23) );
+		return vec4f_asfloat(vec4i_or(vec4i_and(em, normal), sign) );
+	}
+
+	inline void unpackUint8(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		const vec4f_t value  = vec4f_itof(vec4i_ldu8(_data) );
+		const vec4f_t result = vec4f_div(vec4f_add(value, _kernel.m_bias), _kernel.m_scale);
+		vec4f_stu(_output, vec4f_asfloat(vec4i_and(vec4i_asint(result), _kernel.m_mask) ) );
+	}
+
+	inline void unpackInt16(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		const vec4f_t value  = vec4f_itof(vec4i_ldi16(_data) );
+		const vec4f_t result = vec4f_div(vec4f_add(value, _kernel.m_bias), _kernel.m_scale);
+		vec4f_stu(_output, vec4f_asfloat(vec4i_and(vec4i_asint(result), _kernel.m_mask) ) );
+	}
+
+	inline void unpackHalf(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		const vec4i_t value = vec4i_and(vec4i_ldu16(_data), _kernel.m_mask);
+		vec4f_stu(_output, halfToFloat4(value) );
+	}
+
+	inline void unpackFloat(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		const vec4i_t value = vec4i_and(vec4i_asint(vec4f_ldu(_data) ), _kernel.m_mask);
+		vec4f_stu(_output, vec4f_asfloat(value) );
+	}
+
+	inline void packUint8(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		const vec4f_t value = vec4f_add(vec4f_mul(vec4f_ldu(_input), _kernel.m_scale), _kernel.m_bias);
+		vec4i_stu8(_data, vec4i_ftoi(value) );
+	}
+
+	inline void packInt16(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		const vec4f_t value = vec4f_add(vec4f_mul(vec4f_ldu(_input), _kernel.m_scale), _kernel.m_bias);
+		vec4i_sti16(_data, vec4i_ftoi(value) );
+	}
+
+	inline void packHalf(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		// Unused lanes are cleared to stay on fast path.
+		const vec4f_t value = vec4f_asfloat(vec4i_and(vec4i_asint(vec4f_ldu(_input) ), _kernel.m_mask) );
+		vec4i_sti16(_data, halfFromFloat4(value) );
+	}
+
+	inline void packFloat(uint8_t* _data, const float* _input, const VertexKernel& /*_kernel*/)
+	{
+		memcpy(_data, _input, 16);
+	}
+#else
+	struct VertexKernel
+	{
+		float m_scale;
+		float m_bias;
+		uint32_t m_num;
+	};
+
+	static void initKernel(VertexKernel& _kernel, const VertexAttribFormat& _format, float _scale, float _bias)
+	{
+		_kernel.m_scale = _scale;
+		_kernel.m_bias  = _bias;
+		_kernel.m_num   = _format.m_num;
+	}
+
+	inline void unpackUint8(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		for (uint32_t ii = 0; ii < 4; ++ii)
+		{
+			_output[ii] = ii < _kernel.m_num ? (float(_data[ii]) + _kernel.m_bias)/_kernel.m_scale : 0.0f;
+		}
+	}
+
+	inline void unpackInt16(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		int16_t value[4];
+		memcpy(value, _data, sizeof(value) );
+
+		for (uint32_t ii = 0; ii < 4; ++ii)
+		{
+			_output[ii] = ii < _kernel.m_num ? (float(value[ii]) + _kernel.m_bias)/_kernel.m_scale : 0.0f;
+		}
+	}
+
+	inline void unpackHalf(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		uint16_t value[4];
+		memcpy(value, _data, sizeof(value) );
+
+		for (uint32_t ii = 0; ii < 4; ++ii)
+		{
+			_output[ii] = ii < _kernel.m_num ? bx::halfToFloat(value[ii]) : 0.0f;
+		}
+	}
+
+	inline void unpackFloat(float* _output, const uint8_t* _data, const VertexKernel& _kernel)
+	{
+		memcpy(_output, _data, 16);
+
+		for (uint32_t ii = _kernel.m_num; ii < 4; ++ii)
+		{
+			_output[ii] = 0.0f;
+		}
+	}
+
+	inline void packUint8(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		for (uint32_t ii = 0; ii < _kernel.m_num; ++ii)
+		{
+			_data[ii] = uint8_t(_input[ii]*_kernel.m_scale + _kernel.m_bias);
+		}
+	}
+
+	inline void packInt16(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		int16_t value[4];
+		for (uint32_t ii = 0; ii < _kernel.m_num; ++ii)
+		{
+			value[ii] = int16_t(_input[ii]*_kernel.m_scale + _kernel.m_bias);
+		}
+
+		memcpy(_data, value, _kernel.m_num*sizeof(int16_t) );
+	}
+
+	inline void packHalf(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		uint16_t value[4];
+		for (uint32_t ii = 0; ii < _kernel.m_num; ++ii)
+		{
+			value[ii] = bx::halfFromFloat(_input[ii]);
+		}
+
+		memcpy(_data, value, _kernel.m_num*sizeof(uint16_t) );
+	}
+
+	inline void packFloat(uint8_t* _data, const float* _input, const VertexKernel& _kernel)
+	{
+		memcpy(_data, _input, _kernel.m_num*sizeof(float) );
+	}
+#endif // BGFX_VERTEX_SIMD
+
+	typedef void (*UnpackFn)(float* _output, const uint8_t* _data, const VertexKernel& _kernel);
+	typedef void (*PackFn)(uint8_t* _data, const float* _input, const VertexKernel& _kernel);
+
+	template<UnpackFn unpackFn>
+	static void unpackLoop(float* _output, const uint8_t* _data, uint32_t _stride, uint32_t _avail, uint32_t _num, uint32_t _loadSize, uint32_t _size, const VertexKernel& _kernel)
+	{
+		// Kernels read _loadSize bytes. Vertices for which that would read
+		// past the end of the stream go through temporary.
+		uint32_t numSafe = 0;
+		if (_avail >= _loadSize)
+		{
+			numSafe = bx::uint32_min(_num, (_avail - _loadSize)/_stride + 1);
+		}
+
+		uint32_t ii = 0;
+		for (; ii < numSafe; ++ii)
+		{
+			unpackFn(&_output[ii*4], &_data[ii*_stride], _kernel);
+		}
+
+		for (; ii < _num; ++ii)
+		{
+			uint8_t temp[16] = {};
+			memcpy(temp, &_data[ii*_stride], _size);
+			unpackFn(&_output[ii*4], temp, _kernel);
+		}
+	}
+
+	template<PackFn packFn>
+	static void packLoop(uint8_t* _data, uint32_t _stride, const float* _input, uint32_t _num, uint32_t _size, const VertexKernel& _kernel)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint8_t temp[16];
+			packFn(temp, &_input[ii*4], _kernel);
+			memcpySmall(&_data[ii*_stride], temp, _size);
+		}
+	}
+
+	static void vertexUnpackAttrib(float* _output, const VertexAttribFormat& _format, const uint8_t* _data, uint32_t _stride, uint32_t _avail, uint32_t _num)
+	{
+		const float* biasScale = s_unpackBiasScale[_format.m_type][_format.m_asInt];
+
+		VertexKernel kernel;
+		initKernel(kernel, _format, biasScale[1], biasScale[0]);
+
+		const uint32_t loadSize = s_attribTypeLoadSize[_format.m_type];
+		const uint32_t size = _format.m_num*s_attribTypeElementSize[_format.m_type];
+
+		switch (_format.m_type)
+		{
+		default:
+		case AttribType::Uint8: unpackLoop<unpackUint8>(_output, _data, _stride, _avail, _num, loadSize, size, kernel); break;
+		case AttribType::Int16: unpackLoop<unpackInt16>(_output, _data, _stride, _avail, _num, loadSize, size, kernel); break;
+		case AttribType::Half:  unpackLoop<unpackHalf >(_output, _data, _stride, _avail, _num, loadSize, size, kernel); break;
+		case AttribType::Float: unpackLoop<unpackFloat>(_output, _data, _stride, _avail, _num, loadSize, size, kernel); break;
+		}
+	}
+
+	static void vertexPackAttrib(uint8_t* _data, uint32_t _stride, const float* _input, bool _inputNormalized, const VertexAttribFormat& _format, uint32_t _num)
+	{
+		const float* scaleBias = s_packScaleBias[_format.m_type][_format.m_asInt];
+
+		VertexKernel kernel;
+		initKernel(kernel, _format, _inputNormalized ? scaleBias[0] : 1.0f, _inputNormalized ? scaleBias[1] : 0.0f);
+
+		const uint32_t size = _format.m_num*s_attribTypeElementSize[_format.m_type];
+
+		switch (_format.m_type)
+		{
+		default:
+		case AttribType::Uint8: packLoop<packUint8>(_data, _stride, _input, _num, size, kernel); break;
+		case AttribType::Int16: packLoop<packInt16>(_data, _stride, _input, _num, size, kernel); break;
+		case AttribType::Half:  packLoop<packHalf >(_data, _stride, _input, _num, size, kernel); break;
+		case AttribType::Float: packLoop<packFloat>(_data, _stride, _input, _num, size, kernel); break;
+		}
+	}
+
+	void vertexPack(const float* _input, bool _inputNormalized, Attrib::Enum _attr, const VertexDecl& _decl, void* _data, uint32_t _index, uint32_t _num)
+	{
+		if (!_decl.has(_attr) )
+		{
+			return;
+		}
+
+		VertexAttribFormat format;
+		decodeFormat(format, _decl, _attr);
+
+		const uint32_t stride = _decl.getStride();
+		uint8_t* data = (uint8_t*)_data + _index*stride + _decl.getOffset(_attr);
+		vertexPackAttrib(data, stride, _input, _inputNormalized, format, _num);
+	}
+
+	void vertexUnpack(float* _output, Attrib::Enum _attr, const VertexDecl& _decl, const void* _data, uint32_t _index, uint32_t _num)
+	{
+		if (!_decl.has(_attr) )
+		{
+			memset(_output, 0, _num*4*sizeof(float) );
 			return;
 		}
 
-		struct ConvertOp
+		VertexAttribFormat format;
+		decodeFormat(format, _decl, _attr);
+
+		const uint32_t stride = _decl.getStride();
+		const uint32_t offset = _decl.getOffset(_attr);
+		const uint8_t* data = (const uint8_t*)_data + _index*stride + offset;
+		vertexUnpackAttrib(_output, format, data, stride, _num*stride - offset, _num);
+	}
+
+	struct VertexConvertOp
+	{
+		enum Enum
 		{
-			enum Enum
-			{
-				Set,
-				Copy,
-				Convert,
-			};
-
-			Attrib::Enum attr;
-			Enum op;
-			uint32_t src;
-			uint32_t dest;
-			uint32_t size;
+			Set,
+			Copy,
+			Convert,
 		};
 
-		ConvertOp convertOp[Attrib::Count];
-		uint32_t numOps = 0;
+		Enum m_op;
+		uint16_t m_src;
+		uint16_t m_dest;
+		uint16_t m_size;
+		VertexAttribFormat m_srcFormat;
+		VertexAttribFormat m_destFormat;
+	};
+
+	struct VertexConvertPlan
+	{
+		VertexDecl m_src;
+		VertexDecl m_dest;
+		VertexConvertOp m_op[Attrib::Count];
+		uint32_t m_numOps;
+	};
+
+	// Conversion plans are cached per thread, so no locking is needed.
+	static BX_THREAD VertexConvertPlan s_convertPlan[8];
+
+	static bool isEqual(const VertexDecl& _a, const VertexDecl& _b)
+	{
+		return _a.m_hash == _b.m_hash
+			&& _a.m_stride == _b.m_stride
+			&& 0 == memcmp(_a.m_offset, _b.m_offset, sizeof(_a.m_offset) )
+			&& 0 == memcmp(_a.m_attributes, _b.m_attributes, sizeof(_a.m_attributes) )
+			;
+	}
+
+	static const VertexConvertPlan& getConvertPlan(const VertexDecl& _destDecl, const VertexDecl& _srcDecl)
+	{
+		const uint32_t slot = (_srcDecl.m_hash ^ (_destDecl.m_hash*31) ) % BX_COUNTOF(s_convertPlan);
+		VertexConvertPlan& plan = s_convertPlan[slot];
+
+		if (isEqual(plan.m_src, _srcDecl)
+		&&  isEqual(plan.m_dest, _destDecl) )
+		{
+			return plan;
+		}
+
+		plan.m_src = _srcDecl;
+		plan.m_dest = _destDecl;
+		plan.m_numOps = 0;
 
 		for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
 		{
@@ -424,67 +1004,83 @@ namespace bgfx
 
 			if (_destDecl.has(attr) )
 			{
-				ConvertOp& cop = convertOp[numOps];
-				cop.attr = attr;
-				cop.dest = _destDecl.getOffset(attr);
-
-				uint8_t num;
-				AttribType::Enum type;
-				bool normalized;
-				bool asInt;
-				_destDecl.decode(attr, num, type, normalized, asInt);
-				cop.size = (*s_attribTypeSize[0])[type][num-1];
+				VertexConvertOp& cop = plan.m_op[plan.m_numOps];
+				cop.m_dest = _destDecl.getOffset(attr);
+				decodeFormat(cop.m_destFormat, _destDecl, attr);
+				cop.m_size = (*s_attribTypeSize[0])[cop.m_destFormat.m_type][cop.m_destFormat.m_num-1];
 
 				if (_srcDecl.has(attr) )
 				{
-					cop.src = _srcDecl.getOffset(attr);
-					cop.op = _destDecl.m_attributes[attr] == _srcDecl.m_attributes[attr] ? ConvertOp::Copy : ConvertOp::Convert;
+					cop.m_src = _srcDecl.getOffset(attr);
+					decodeFormat(cop.m_srcFormat, _srcDecl, attr);
+					cop.m_op = _destDecl.m_attributes[attr] == _srcDecl.m_attributes[attr] ? VertexConvertOp::Copy : VertexConvertOp::Convert;
 				}
 				else
 				{
-					cop.op = ConvertOp::Set;
+					cop.m_src = 0;
+					cop.m_op = VertexConvertOp::Set;
 				}
 
-				++numOps;
+				++plan.m_numOps;
 			}
 		}
 
-		if (0 < numOps)
+		return plan;
+	}
+
+	void vertexConvert(const VertexDecl& _destDecl, void* _destData, const VertexDecl& _srcDecl, const void* _srcData, uint32_t _num)
+	{
+		if (_destDecl.m_hash == _srcDecl.m_hash)
 		{
-			const uint8_t* src = (const uint8_t*)_srcData;
-			uint32_t srcStride = _srcDecl.getStride();
+			memcpy(_destData, _srcData, _srcDecl.getSize(_num) );
+			return;
+		}
 
-			uint8_t* dest = (uint8_t*)_destData;
-			uint32_t destStride = _destDecl.getStride();
+		const VertexConvertPlan& plan = getConvertPlan(_destDecl, _srcDecl);
 
-			float unpacked[4];
+		const uint8_t* src = (const uint8_t*)_srcData;
+		const uint32_t srcStride = _srcDecl.getStride();
 
-			for (uint32_t ii = 0; ii < _num; ++ii)
+		uint8_t* dest = (uint8_t*)_destData;
+		const uint32_t destStride = _destDecl.getStride();
+
+		// Converted attributes go through batch unpack/pack.
+		const uint32_t batchSize = 64;
+		float unpacked[batchSize*4];
+
+		for (uint32_t start = 0; start < _num; start += batchSize)
+		{
+			const uint32_t num = bx::uint32_min(batchSize, _num - start);
+
+			for (uint32_t jj = 0; jj < plan.m_numOps; ++jj)
 			{
-				for (uint32_t jj = 0; jj < numOps; ++jj)
+				const VertexConvertOp& cop = plan.m_op[jj];
+
+				switch (cop.m_op)
 				{
-					const ConvertOp& cop = convertOp[jj];
+				case VertexConvertOp::Set:
+					for (uint32_t ii = 0; ii < num; ++ii)
+					{
+						memset(&dest[ii*destStride + cop.m_dest], 0, cop.m_size);
+					}
+					break;
 
-					switch (cop.op)
+				case VertexConvertOp::Copy:
+					for (uint32_t ii = 0; ii < num; ++ii)
 					{
-					case ConvertOp::Set:
-						memset(dest + cop.dest, 0, cop.size);
-						break;
-
-					case ConvertOp::Copy:
-						memcpy(dest + cop.dest, src + cop.src, cop.size);
-						break;
-
-					case ConvertOp::Convert:
-						vertexUnpack(unpacked, cop.attr, _srcDecl, src);
-						vertexPack(unpacked, true, cop.attr, _destDecl, dest);
-						break;
+						memcpySmall(&dest[ii*destStride + cop.m_dest], &src[ii*srcStride + cop.m_src], cop.m_size);
 					}
-				}
+					break;
 
-				src += srcStride;
-				dest += destStride;
+				case VertexConvertOp::Convert:
+					vertexUnpackAttrib(unpacked, cop.m_srcFormat, &src[cop.m_src], srcStride, (_num - start)*srcStride - cop.m_src, num);
+					vertexPackAttrib(&dest[cop.m_dest], destStride, unpacked, true, cop.m_destFormat, num);
+					break;
+				}
 			}
+
+			src += num*srcStride;
+			dest += num*destStride;
 		}
 	}
 
@@ -581,4 +1177,309 @@ namespace bgfx
 
 		return numVertices;
 	}
+
+	// Grid cell coordinates are limited to 20 bits per axis, cells get larger
+	// than 2*epsilon for meshes with large extent.
+	static const int32_t s_weldCellMax = 1<<20;
+	static const uint32_t s_weldRangeSize = 16<<10;
+
+	struct WeldContext
+	{
+		const VertexDecl* m_decl;
+		const void* m_data;
+		uint32_t m_num;
+
+		Attrib::Enum m_attr[Attrib::Count];
+		float m_epsilonSq[Attrib::Count];
+		float* m_unpacked[Attrib::Count];
+		uint32_t m_numAttribs;
+
+		float* m_rangeBounds;
+		float m_min[3];
+		float m_invCellSize;
+		float m_probe;
+
+		uint32_t m_hashMask;
+		uint32_t* m_bucket;
+		uint32_t* m_bucketStart;
+		uint32_t* m_sorted;
+		uint32_t* m_match;
+	};
+
+	inline int32_t weldCellCoord(float _value, float _min, float _invCellSize)
+	{
+		const float coord = (_value - _min)*_invCellSize;
+		return coord <= 0.0f ? 0 : coord >= float(s_weldCellMax) ? s_weldCellMax : int32_t(coord);
+	}
+
+	inline uint32_t weldCellHash(int32_t _x, int32_t _y, int32_t _z)
+	{
+		return (uint32_t(_x)*73856093u)
+			^  (uint32_t(_y)*19349663u)
+			^  (uint32_t(_z)*83492791u)
+			;
+	}
+
+	static void weldUnpack(uint32_t _range, void* _userData)
+	{
+		WeldContext& ctx = *(WeldContext*)_userData;
+		const uint32_t begin = _range*s_weldRangeSize;
+		const uint32_t num = bx::uint32_min(s_weldRangeSize, ctx.m_num - begin);
+
+		for (uint32_t ii = 0; ii < ctx.m_numAttribs; ++ii)
+		{
+			vertexUnpack(&ctx.m_unpacked[ii][begin*4], ctx.m_attr[ii], *ctx.m_decl, ctx.m_data, begin, num);
+		}
+
+		const float* pos = &ctx.m_unpacked[0][begin*4];
+		float* bounds = &ctx.m_rangeBounds[_range*6];
+		memcpy(&bounds[0], pos, 3*sizeof(float) );
+		memcpy(&bounds[3], pos, 3*sizeof(float) );
+
+		for (uint32_t ii = 1; ii < num; ++ii)
+		{
+			pos += 4;
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				bounds[axis  ] = pos[axis] < bounds[axis  ] ? pos[axis] : bounds[axis  ];
+				bounds[axis+3] = pos[axis] > bounds[axis+3] ? pos[axis] : bounds[axis+3];
+			}
+		}
+	}
+
+	static void weldHash(uint32_t _range, void* _userData)
+	{
+		WeldContext& ctx = *(WeldContext*)_userData;
+		const uint32_t begin = _range*s_weldRangeSize;
+		const uint32_t end = begin + bx::uint32_min(s_weldRangeSize, ctx.m_num - begin);
+
+		for (uint32_t ii = begin; ii < end; ++ii)
+		{
+			const float* pos = &ctx.m_unpacked[0][ii*4];
+			const int32_t xx = weldCellCoord(pos[0], ctx.m_min[0], ctx.m_invCellSize);
+			const int32_t yy = weldCellCoord(pos[1], ctx.m_min[1], ctx.m_invCellSize);
+			const int32_t zz = weldCellCoord(pos[2], ctx.m_min[2], ctx.m_invCellSize);
+			ctx.m_bucket[ii] = weldCellHash(xx, yy, zz) & ctx.m_hashMask;
+		}
+	}
+
+	inline bool weldCompare(const WeldContext& _ctx, uint32_t _a, uint32_t _b)
+	{
+		const float* pa = &_ctx.m_unpacked[0][_a*4];
+		const float* pb = &_ctx.m_unpacked[0][_b*4];
+		if (sqLength(pa, pb) > _ctx.m_epsilonSq[0])
+		{
+			return false;
+		}
+
+		for (uint32_t ii = 1; ii < _ctx.m_numAttribs; ++ii)
+		{
+			const float* aa = &_ctx.m_unpacked[ii][_a*4];
+			const float* bb = &_ctx.m_unpacked[ii][_b*4];
+			const float ww = aa[3] - bb[3];
+			if (sqLength(aa, bb) + ww*ww > _ctx.m_epsilonSq[ii])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Returns lowest numbered vertex below _index within tolerance, or _index
+	// if there is none. When _output is not NULL, only unique vertices are
+	// considered.
+	static uint32_t weldFind(const WeldContext& _ctx, uint32_t _index, const uint32_t* _output)
+	{
+		const float* pos = &_ctx.m_unpacked[0][_index*4];
+
+		int32_t lo[3];
+		int32_t hi[3];
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			lo[axis] = weldCellCoord(pos[axis] - _ctx.m_probe, _ctx.m_min[axis], _ctx.m_invCellSize);
+			hi[axis] = weldCellCoord(pos[axis] + _ctx.m_probe, _ctx.m_min[axis], _ctx.m_invCellSize);
+		}
+
+		uint32_t best = _index;
+
+		for (int32_t zz = lo[2]; zz <= hi[2]; ++zz)
+		{
+			for (int32_t yy = lo[1]; yy <= hi[1]; ++yy)
+			{
+				for (int32_t xx = lo[0]; xx <= hi[0]; ++xx)
+				{
+					const uint32_t bucket = weldCellHash(xx, yy, zz) & _ctx.m_hashMask;
+
+					// Bucket is sorted by vertex index, first match is the lowest.
+					for (uint32_t ii = _ctx.m_bucketStart[bucket], end = _ctx.m_bucketStart[bucket+1]; ii < end; ++ii)
+					{
+						const uint32_t candidate = _ctx.m_sorted[ii];
+						if (candidate >= best)
+						{
+							break;
+						}
+
+						if ( (NULL == _output || candidate == _output[candidate])
+						&&  weldCompare(_ctx, _index, candidate) )
+						{
+							best = candidate;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		return best;
+	}
+
+	static void weldMatch(uint32_t _range, void* _userData)
+	{
+		WeldContext& ctx = *(WeldContext*)_userData;
+		const uint32_t begin = _range*s_weldRangeSize;
+		const uint32_t end = begin + bx::uint32_min(s_weldRangeSize, ctx.m_num - begin);
+
+		for (uint32_t ii = begin; ii < end; ++ii)
+		{
+			ctx.m_match[ii] = weldFind(ctx, ii, NULL);
+		}
+	}
+
+	uint32_t weldVertices(uint32_t* _output, const VertexDecl& _decl, const void* _data, uint32_t _num, const float _epsilon[Attrib::Count], uint32_t _numThreads)
+	{
+		BX_CHECK(_decl.has(Attrib::Position) && 0.0f <= _epsilon[Attrib::Position], "Vertex position must be compared when welding vertices.");
+
+		if (!_decl.has(Attrib::Position)
+		||  0.0f > _epsilon[Attrib::Position]
+		||  0 == _num)
+		{
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				_output[ii] = ii;
+			}
+
+			return _num;
+		}
+
+		WeldContext ctx;
+		ctx.m_decl = &_decl;
+		ctx.m_data = _data;
+		ctx.m_num = _num;
+
+		// Position is always first.
+		ctx.m_attr[0] = Attrib::Position;
+		ctx.m_numAttribs = 1;
+		for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
+		{
+			Attrib::Enum attr = Attrib::Enum(ii);
+			if (Attrib::Position != attr
+			&&  _decl.has(attr)
+			&&  0.0f <= _epsilon[attr])
+			{
+				ctx.m_attr[ctx.m_numAttribs++] = attr;
+			}
+		}
+
+		for (uint32_t ii = 0; ii < ctx.m_numAttribs; ++ii)
+		{
+			const float epsilon = _epsilon[ctx.m_attr[ii] ];
+			ctx.m_epsilonSq[ii] = epsilon*epsilon;
+			ctx.m_unpacked[ii] = (float*)BX_ALLOC(g_allocator, _num*4*sizeof(float) );
+		}
+
+		const uint32_t numRanges = (_num + s_weldRangeSize - 1)/s_weldRangeSize;
+		ctx.m_rangeBounds = (float*)BX_ALLOC(g_allocator, numRanges*6*sizeof(float) );
+		parallelFor(numRanges, weldUnpack, &ctx, _numThreads);
+
+		float max[3];
+		memcpy(ctx.m_min, &ctx.m_rangeBounds[0], 3*sizeof(float) );
+		memcpy(max, &ctx.m_rangeBounds[3], 3*sizeof(float) );
+		for (uint32_t ii = 1; ii < numRanges; ++ii)
+		{
+			const float* bounds = &ctx.m_rangeBounds[ii*6];
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				ctx.m_min[axis] = bounds[axis  ] < ctx.m_min[axis] ? bounds[axis  ] : ctx.m_min[axis];
+				max[axis]       = bounds[axis+3] > max[axis]       ? bounds[axis+3] : max[axis];
+			}
+		}
+
+		float extent = 0.0f;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			const float size = max[axis] - ctx.m_min[axis];
+			extent = size > extent ? size : extent;
+		}
+
+		// Vertex within epsilon is at most one cell away. Probe distance has
+		// margin for rounding of cell coordinates.
+		const float epsilon = _epsilon[Attrib::Position];
+		float cellSize = 2.0f*epsilon;
+		cellSize = extent/float(s_weldCellMax) > cellSize ? extent/float(s_weldCellMax) : cellSize;
+		cellSize = 0.0f < cellSize ? cellSize : 1.0f;
+		ctx.m_invCellSize = 1.0f/cellSize;
+		ctx.m_probe = epsilon*1.0625f;
+
+		const uint32_t numBuckets = bx::uint32_nextpow2(_num);
+		ctx.m_hashMask = numBuckets-1;
+		ctx.m_bucket = (uint32_t*)BX_ALLOC(g_allocator, _num*sizeof(uint32_t) );
+		parallelFor(numRanges, weldHash, &ctx, _numThreads);
+
+		// Counting sort by bucket keeps vertices in increasing order within
+		// bucket.
+		ctx.m_bucketStart = (uint32_t*)BX_ALLOC(g_allocator, (numBuckets+1)*sizeof(uint32_t) );
+		ctx.m_sorted = (uint32_t*)BX_ALLOC(g_allocator, _num*sizeof(uint32_t) );
+		memset(ctx.m_bucketStart, 0, (numBuckets+1)*sizeof(uint32_t) );
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			++ctx.m_bucketStart[ctx.m_bucket[ii]+1];
+		}
+
+		for (uint32_t ii = 1; ii <= numBuckets; ++ii)
+		{
+			ctx.m_bucketStart[ii] += ctx.m_bucketStart[ii-1];
+		}
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			ctx.m_sorted[ctx.m_bucketStart[ctx.m_bucket[ii] ]++] = ii;
+		}
+
+		memmove(&ctx.m_bucketStart[1], &ctx.m_bucketStart[0], numBuckets*sizeof(uint32_t) );
+		ctx.m_bucketStart[0] = 0;
+
+		ctx.m_match = ctx.m_bucket;
+		parallelFor(numRanges, weldMatch, &ctx, _numThreads);
+
+		// Vertex is welded with lowest numbered unique vertex within
+		// tolerance. Lowest matching vertex is almost always unique, search
+		// again only when it's not.
+		uint32_t numVertices = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint32_t index = ctx.m_match[ii];
+			if (index != ii
+			&&  index != _output[index])
+			{
+				index = weldFind(ctx, ii, _output);
+			}
+
+			_output[ii] = index;
+			numVertices += index == ii;
+		}
+
+		BX_FREE(g_allocator, ctx.m_sorted);
+		BX_FREE(g_allocator, ctx.m_bucketStart);
+		BX_FREE(g_allocator, ctx.m_bucket);
+		BX_FREE(g_allocator, ctx.m_rangeBounds);
+
+		for (uint32_t ii = 0; ii < ctx.m_numAttribs; ++ii)
+		{
+			BX_FREE(g_allocator, ctx.m_unpacked[ii]);
+		}
+
+		return numVertices;
+	}
 } // namespace bgfx
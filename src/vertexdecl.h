@@ -16,6 +16,10 @@ namespace bgfx
 	/// Dump vertex declaration into debug output.
 	void dump(const VertexDecl& _decl);
 
+	/// Brute force O(n^2) vertex welding by position, reference for
+	/// weldVertices.
+	uint16_t weldVerticesRef(uint16_t* _output, const VertexDecl& _decl, const void* _data, uint16_t _num, float _epsilon);
+
 } // namespace bgfx
 
 #endif // BGFX_VERTEXDECL_H_HEADER_GUARD
@@ -6,6 +6,7 @@
 #include <bgfx.h>
 #include "../../src/vertexdecl.h"
 
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,7 +14,6 @@
 #include <algorithm>
 #include <vector>
 #include <string>
-#include <unordered_map>
 
 #include <forsythtriangleorderoptimizer.h>
 
@@ -51,6 +51,7 @@
 	} while(0)
 
 #include <bx/bx.h>
+#include <bx/allocator.h>
 #include <bx/debug.h>
 #include <bx/commandline.h>
 #include <bx/timer.h>
@@ -58,64 +59,120 @@
 #include <bx/hash.h>
 #include <bx/uint32_t.h>
 
-#include "tokenizecmd.h"
 #include "bounds.h"
+#include "optimize.h"
+#include "simplify.h"
+#include "objparser.h"
 #include "math.h"
 
-struct Vector3
-{
-	float x;
-	float y;
-	float z;
-};
+#include <meshcodec.h>
 
-typedef std::vector<Vector3> Vector3Array;
+namespace bgfx
+{
+	// Vertex welding and mesh optimization allocate temporary memory with
+	// bgfx allocator, tool is not initializing bgfx.
+	static bx::CrtAllocator s_allocator;
+	bx::ReallocatorI* g_allocator = &s_allocator;
+}
 
-struct Index3
+struct Primitive
 {
-	int32_t m_position;
-	int32_t m_texcoord;
-	int32_t m_normal;
-	int32_t m_vertexIndex;
+	uint32_t m_startVertex;
+	uint32_t m_startIndex;
+	uint32_t m_numVertices;
+	uint32_t m_numIndices;
+	std::string m_name;
 };
 
-typedef std::unordered_map<uint64_t, Index3> Index3Map;
+typedef std::vector<Primitive> PrimitiveArray;
 
-struct Triangle
+struct Lod
 {
-	uint64_t m_index[3];
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+	float m_error;
 };
 
-typedef std::vector<Triangle> TriangleArray;
+typedef std::vector<Lod> LodArray;
 
-struct Group
+struct IndexMode
 {
-	uint32_t m_startTriangle;
-	uint32_t m_numTriangles;
-	std::string m_name;
-	std::string m_material;
+	enum Enum
+	{
+		Index16,
+		Index32,
+		Auto,
+	};
 };
 
-typedef std::vector<Group> GroupArray;
-
-struct Primitive
+struct WriteStats
 {
-	uint32_t m_startVertex;
-	uint32_t m_startIndex;
+	int64_t m_triReorderElapsed;
+	int64_t m_lodElapsed;
+	uint32_t m_numChunks;
 	uint32_t m_numVertices;
 	uint32_t m_numIndices;
-	std::string m_name;
+	uint32_t m_numMeshlets;
+	uint64_t m_vertexBytes;
+	uint64_t m_vertexEncodedBytes;
+	uint64_t m_indexBytes;
+	uint64_t m_indexEncodedBytes;
+	int64_t m_encodeElapsed;
+	VertexCacheStats m_cacheBefore;
+	VertexCacheStats m_cacheAfter;
+	VertexFetchStats m_fetchBefore;
+	VertexFetchStats m_fetchAfter;
 };
 
-typedef std::vector<Primitive> PrimitiveArray;
-
 static uint32_t s_obbSteps = 17;
+static uint16_t s_cacheSize = 32;
+static float s_overdrawThreshold = 0.0f;
+static bool s_meshlets = false;
+static uint32_t s_meshletMaxVertices = 64;
+static uint32_t s_meshletMaxTriangles = 126;
+static uint32_t s_lodLevels = 0;
+static float s_lodRatio = 0.5f;
+static float s_lodError = 0.0f;
+static bool s_compress = false;
+static bool s_posStream = false;
 
 #define BGFX_CHUNK_MAGIC_GEO BX_MAKEFOURCC('G', 'E', 'O', 0x0)
 #define BGFX_CHUNK_MAGIC_VB BX_MAKEFOURCC('V', 'B', ' ', 0x0)
+#define BGFX_CHUNK_MAGIC_VB32 BX_MAKEFOURCC('V', 'B', ' ', 0x1)
 #define BGFX_CHUNK_MAGIC_IB BX_MAKEFOURCC('I', 'B', ' ', 0x0)
+#define BGFX_CHUNK_MAGIC_IB32 BX_MAKEFOURCC('I', 'B', ' ', 0x1)
 #define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
 
+/// Meshlet chunk, follows PRI chunk when enabled:
+///
+///   uint16_t numPrimitives
+///   uint32_t startMeshlet, numMeshlets [numPrimitives]
+///   uint32_t numMeshlets, Meshlet [numMeshlets]
+///   uint32_t numVertices, uint32_t [numVertices] (indices into VB)
+///   uint32_t numTriangles, uint8_t [numTriangles*3] (indices into meshlet vertices)
+///
+#define BGFX_CHUNK_MAGIC_MSH BX_MAKEFOURCC('M', 'S', 'H', 0x0)
+
+/// LOD chunk, follows PRI chunk when enabled. Level 0 is the range covered
+/// by primitives, coarser levels are appended to the same index buffer and
+/// reference the same vertex buffer:
+///
+///   uint16_t numLevels
+///   uint32_t startIndex, uint32_t numIndices, float error, Sphere, Aabb [numLevels]
+///
+/// Error is object space distance, projected to screen at runtime.
+///
+#define BGFX_CHUNK_MAGIC_LOD BX_MAKEFOURCC('L', 'O', 'D', 0x0)
+
+/// Vertex stream chunk, follows IB chunk when position stream is enabled.
+/// VB chunk holds only positions, and remaining attributes are in stream 1,
+/// so depth only passes can fetch positions alone:
+///
+///   uint8_t stream
+///   VertexDecl, uint32_t numVertices, data [numVertices*stride]
+///
+#define BGFX_CHUNK_MAGIC_VBS BX_MAKEFOURCC('V', 'B', 'S', 0x0)
+
 long int fsize(FILE* _file)
 {
 	long int pos = ftell(_file);
@@ -125,172 +182,1215 @@ long int fsize(FILE* _file)
 	return size;
 }
 
-void triangleReorder(uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint16_t _cacheSize)
+void triangleReorder(uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint16_t _cacheSize)
 {
-	uint16_t* newIndexList = new uint16_t[_numIndices];
+	uint32_t* newIndexList = new uint32_t[_numIndices];
 	Forsyth::OptimizeFaces(_indices, _numIndices, _numVertices, newIndexList, _cacheSize);
-	memcpy(_indices, newIndexList, _numIndices*2);
+	memcpy(_indices, newIndexList, _numIndices*sizeof(uint32_t) );
 	delete [] newIndexList;
 }
 
-void calcTangents(void* _vertices, uint16_t _numVertices, bgfx::VertexDecl _decl, const uint16_t* _indices, uint32_t _numIndices)
+void calcTangents(void* _vertices, uint32_t _numVertices, bgfx::VertexDecl _decl, const uint32_t* _indices, uint32_t _numIndices)
+{
+	float* positions = new float[4*_numVertices];
+	float* texcoords = new float[4*_numVertices];
+	bgfx::vertexUnpack(positions, bgfx::Attrib::Position, _decl, _vertices, 0, _numVertices);
+	bgfx::vertexUnpack(texcoords, bgfx::Attrib::TexCoord0, _decl, _vertices, 0, _numVertices);
+
+	float* tangents = new float[6*_numVertices];
+	memset(tangents, 0, 6*_numVertices*sizeof(float) );
+
+	for (uint32_t ii = 0, num = _numIndices/3; ii < num; ++ii)
+	{
+		const uint32_t* indices = &_indices[ii*3];
+		const float* p0 = &positions[indices[0]*4];
+		const float* p1 = &positions[indices[1]*4];
+		const float* p2 = &positions[indices[2]*4];
+		const float* t0 = &texcoords[indices[0]*4];
+		const float* t1 = &texcoords[indices[1]*4];
+		const float* t2 = &texcoords[indices[2]*4];
+
+		const float bax = p1[0] - p0[0];
+		const float bay = p1[1] - p0[1];
+		const float baz = p1[2] - p0[2];
+		const float bau = t1[0] - t0[0];
+		const float bav = t1[1] - t0[1];
+
+		const float cax = p2[0] - p0[0];
+		const float cay = p2[1] - p0[1];
+		const float caz = p2[2] - p0[2];
+		const float cau = t2[0] - t0[0];
+		const float cav = t2[1] - t0[1];
+
+		const float det = (bau * cav - bav * cau);
+		const float invDet = 1.0f / det;
+
+		const float tx = (bax * cav - cax * bav) * invDet;
+		const float ty = (bay * cav - cay * bav) * invDet;
+		const float tz = (baz * cav - caz * bav) * invDet;
+
+		const float bx = (cax * bau - bax * cau) * invDet;
+		const float by = (cay * bau - bay * cau) * invDet;
+		const float bz = (caz * bau - baz * cau) * invDet;
+
+		for (uint32_t jj = 0; jj < 3; ++jj)
+		{
+			float* tanu = &tangents[indices[jj]*6];
+			float* tanv = &tanu[3];
+			tanu[0] += tx;
+			tanu[1] += ty;
+			tanu[2] += tz;
+
+			tanv[0] += bx;
+			tanv[1] += by;
+			tanv[2] += bz;
+		}
+	}
+
+	// Normals are unpacked into positions, and packed tangents are written
+	// into texcoords, both are not needed anymore.
+	float* normals = positions;
+	float* packed = texcoords;
+	bgfx::vertexUnpack(normals, bgfx::Attrib::Normal, _decl, _vertices, 0, _numVertices);
+
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		const float* tanu = &tangents[ii*6];
+		const float* tanv = &tangents[ii*6 + 3];
+
+		const float* normal = &normals[ii*4];
+		float ndt = vec3Dot(normal, tanu);
+
+		float nxt[3];
+		vec3Cross(nxt, normal, tanu);
+
+		float tmp[3];
+		tmp[0] = tanu[0] - normal[0] * ndt;
+		tmp[1] = tanu[1] - normal[1] * ndt;
+		tmp[2] = tanu[2] - normal[2] * ndt;
+
+		float* tangent = &packed[ii*4];
+		vec3Norm(tangent, tmp);
+
+		tangent[3] = vec3Dot(nxt, tanv) < 0.0f ? -1.0f : 1.0f;
+	}
+
+	bgfx::vertexPack(packed, true, bgfx::Attrib::Tangent, _decl, _vertices, 0, _numVertices);
+
+	delete [] tangents;
+	delete [] texcoords;
+	delete [] positions;
+} 
+
+void writeBounds(bx::WriterI* _writer, const void* _vertices, uint32_t _numVertices, uint32_t _stride)
+{
+	Sphere maxSphere;
+	calcMaxBoundingSphere(maxSphere, _vertices, _numVertices, _stride);
+
+	Sphere minSphere;
+	calcMinBoundingSphere(minSphere, _vertices, _numVertices, _stride);
+
+	if (minSphere.m_radius > maxSphere.m_radius)
+	{
+		bx::write(_writer, maxSphere);
+	}
+	else
+	{
+		bx::write(_writer, minSphere);
+	}
+
+	Aabb aabb;
+	calcAabb(aabb, _vertices, _numVertices, _stride);
+	bx::write(_writer, aabb);
+
+	Obb obb;
+	calcObb(obb, _vertices, _numVertices, _stride, s_obbSteps);
+	bx::write(_writer, obb);
+}
+
+void writeCompressed(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const uint32_t* _indices, uint32_t _numIndices, bool _index32, WriteStats& _stats)
+{
+	const uint32_t stride = _decl.getStride();
+
+	_stats.m_encodeElapsed -= bx::getHPCounter();
+
+	std::vector<uint8_t> vertexData(meshVertexEncodeBound(_numVertices, stride) );
+	MeshQuantization quant;
+	const uint32_t vertexSize = meshVertexEncode(&vertexData[0], (uint32_t)vertexData.size(), quant, _vertices, _numVertices, stride, _decl.getOffset(bgfx::Attrib::Position) );
+	EXPECT(0 != vertexSize);
+
+	std::vector<uint8_t> indexData(meshIndexEncodeBound(_numIndices) );
+	const uint32_t indexSize = meshIndexEncode(&indexData[0], (uint32_t)indexData.size(), _indices, _numIndices);
+	EXPECT(0 != indexSize);
+
+	_stats.m_encodeElapsed += bx::getHPCounter();
+
+	bx::write(_writer, BGFX_CHUNK_MAGIC_VBC);
+	writeBounds(_writer, _vertices, _numVertices, stride);
+
+	bx::write(_writer, _decl);
+	bx::write(_writer, _numVertices);
+	bx::write(_writer, quant);
+	bx::write(_writer, vertexSize);
+	bx::write(_writer, &vertexData[0], vertexSize);
+
+	bx::write(_writer, _index32 ? BGFX_CHUNK_MAGIC_IBC32 : BGFX_CHUNK_MAGIC_IBC);
+	bx::write(_writer, _numIndices);
+	bx::write(_writer, indexSize);
+	bx::write(_writer, &indexData[0], indexSize);
+
+	_stats.m_vertexBytes += _numVertices*stride;
+	_stats.m_vertexEncodedBytes += vertexSize;
+	_stats.m_indexBytes += _numIndices*(_index32 ? 4 : 2);
+	_stats.m_indexEncodedBytes += indexSize;
+}
+
+void writeBuffers(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const uint32_t* _indices, uint32_t _numIndices, bool _index32, WriteStats& _stats)
+{
+	uint32_t stride = _decl.getStride();
+	if (s_compress)
+	{
+		writeCompressed(_writer, _vertices, _numVertices, _decl, _indices, _numIndices, _index32, _stats);
+	}
+	else if (_index32)
+	{
+		bx::write(_writer, BGFX_CHUNK_MAGIC_VB32);
+		writeBounds(_writer, _vertices, _numVertices, stride);
+
+		bx::write(_writer, _decl);
+		bx::write(_writer, _numVertices);
+		bx::write(_writer, _vertices, _numVertices*stride);
+
+		bx::write(_writer, BGFX_CHUNK_MAGIC_IB32);
+		bx::write(_writer, _numIndices);
+		bx::write(_writer, _indices, _numIndices*4);
+	}
+	else
+	{
+		bx::write(_writer, BGFX_CHUNK_MAGIC_VB);
+		writeBounds(_writer, _vertices, _numVertices, stride);
+
+		bx::write(_writer, _decl);
+		bx::write(_writer, uint16_t(_numVertices) );
+		bx::write(_writer, _vertices, _numVertices*stride);
+
+		std::vector<uint16_t> indices16(_numIndices);
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			indices16[ii] = uint16_t(_indices[ii]);
+		}
+
+		bx::write(_writer, BGFX_CHUNK_MAGIC_IB);
+		bx::write(_writer, _numIndices);
+		bx::write(_writer, &indices16[0], _numIndices*2);
+	}
+}
+
+void splitPositionStream(bgfx::VertexDecl& _posDecl, std::vector<uint8_t>& _pos, bgfx::VertexDecl& _attrDecl, std::vector<uint8_t>& _attr, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl)
+{
+	_posDecl.begin();
+	_attrDecl.begin();
+
+	for (uint32_t attr = 0; attr < bgfx::Attrib::Count; ++attr)
+	{
+		if (_decl.has(bgfx::Attrib::Enum(attr) ) )
+		{
+			uint8_t num;
+			bgfx::AttribType::Enum type;
+			bool normalized;
+			bool asInt;
+			_decl.decode(bgfx::Attrib::Enum(attr), num, type, normalized, asInt);
+
+			bgfx::VertexDecl& decl = bgfx::Attrib::Position == attr ? _posDecl : _attrDecl;
+			decl.add(bgfx::Attrib::Enum(attr), num, type, normalized, asInt);
+		}
+	}
+
+	_posDecl.end();
+	_attrDecl.end();
+
+	_pos.resize(_posDecl.getSize(_numVertices) );
+	bgfx::vertexConvert(_posDecl, &_pos[0], _decl, _vertices, _numVertices);
+
+	_attr.resize(_attrDecl.getSize(_numVertices) );
+	if (!_attr.empty() )
+	{
+		bgfx::vertexConvert(_attrDecl, &_attr[0], _decl, _vertices, _numVertices);
+	}
+}
+
+void write(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const uint32_t* _indices, uint32_t _numIndices, bool _index32, const std::string& _material, const PrimitiveArray& _primitives, WriteStats& _stats)
 {
-	struct PosTexcoord
+	const uint32_t stride = _decl.getStride();
+
+	if (s_posStream)
+	{
+		bgfx::VertexDecl posDecl;
+		std::vector<uint8_t> pos;
+		bgfx::VertexDecl attrDecl;
+		std::vector<uint8_t> attr;
+		splitPositionStream(posDecl, pos, attrDecl, attr, _vertices, _numVertices, _decl);
+		writeBuffers(_writer, &pos[0], _numVertices, posDecl, _indices, _numIndices, _index32, _stats);
+
+		bx::write(_writer, BGFX_CHUNK_MAGIC_VBS);
+		bx::write(_writer, uint8_t(1) );
+		bx::write(_writer, attrDecl);
+		bx::write(_writer, _numVertices);
+		if (!attr.empty() )
+		{
+			bx::write(_writer, &attr[0], uint32_t(attr.size() ) );
+		}
+	}
+	else
+	{
+		writeBuffers(_writer, _vertices, _numVertices, _decl, _indices, _numIndices, _index32, _stats);
+	}
+
+	bx::write(_writer, BGFX_CHUNK_MAGIC_PRI);
+	uint16_t nameLen = uint16_t(_material.size() );
+	bx::write(_writer, nameLen);
+	bx::write(_writer, _material.c_str(), nameLen);
+	bx::write(_writer, uint16_t(_primitives.size() ) );
+	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+		nameLen = uint16_t(prim.m_name.size() );
+		bx::write(_writer, nameLen);
+		bx::write(_writer, prim.m_name.c_str(), nameLen);
+		bx::write(_writer, prim.m_startIndex);
+		bx::write(_writer, prim.m_numIndices);
+		bx::write(_writer, prim.m_startVertex);
+		bx::write(_writer, prim.m_numVertices);
+		writeBounds(_writer, &_vertices[prim.m_startVertex*stride], prim.m_numVertices, stride);
+	}
+}
+
+void writeMeshlets(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, uint32_t _stride, const uint32_t* _indices, const PrimitiveArray& _primitives, WriteStats& _stats)
+{
+	MeshletArray meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+	std::vector<uint32_t> ranges;
+
+	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+		const uint32_t start = (uint32_t)meshlets.size();
+		buildMeshlets(meshlets
+			, meshletVertices
+			, meshletTriangles
+			, &_indices[prim.m_startIndex]
+			, prim.m_numIndices
+			, _vertices
+			, _numVertices
+			, _stride
+			, s_meshletMaxVertices
+			, s_meshletMaxTriangles
+			);
+		ranges.push_back(start);
+		ranges.push_back( (uint32_t)meshlets.size() - start);
+	}
+
+	bx::write(_writer, BGFX_CHUNK_MAGIC_MSH);
+	bx::write(_writer, uint16_t(_primitives.size() ) );
+	bx::write(_writer, &ranges[0], (int32_t)(ranges.size()*sizeof(uint32_t) ) );
+
+	const uint32_t numMeshlets = (uint32_t)meshlets.size();
+	bx::write(_writer, numMeshlets);
+	bx::write(_writer, &meshlets[0], numMeshlets*sizeof(Meshlet) );
+
+	const uint32_t numMeshletVertices = (uint32_t)meshletVertices.size();
+	bx::write(_writer, numMeshletVertices);
+	bx::write(_writer, &meshletVertices[0], numMeshletVertices*sizeof(uint32_t) );
+
+	const uint32_t numMeshletTriangles = (uint32_t)meshletTriangles.size()/3;
+	bx::write(_writer, numMeshletTriangles);
+	bx::write(_writer, &meshletTriangles[0], numMeshletTriangles*3);
+
+	_stats.m_numMeshlets += numMeshlets;
+}
+
+void generateLods(LodArray& _lods, std::vector<uint32_t>& _indices, const uint8_t* _vertices, uint32_t _numVertices, uint32_t _stride)
+{
+	const uint32_t numIndices = (uint32_t)_indices.size();
+
+	Lod lod;
+	lod.m_startIndex = 0;
+	lod.m_numIndices = numIndices;
+	lod.m_error = 0.0f;
+	_lods.push_back(lod);
+
+	float maxError = FLT_MAX;
+	if (0.0f < s_lodError)
+	{
+		Sphere sphere;
+		calcMaxBoundingSphere(sphere, _vertices, _numVertices, _stride);
+		maxError = s_lodError*sphere.m_radius;
+	}
+
+	std::vector<uint32_t> indices;
+	float ratio = 1.0f;
+	for (uint32_t level = 1; level <= s_lodLevels; ++level)
+	{
+		ratio *= s_lodRatio;
+		const uint32_t target = uint32_t(numIndices*ratio)/3*3;
+
+		// Every level is simplified from level 0, so that error is
+		// measured against original surface.
+		const float error = simplify(indices, &_indices[0], numIndices, _vertices, _numVertices, _stride, target, maxError);
+
+		// Stop when mesh can't be simplified any further within error
+		// limit.
+		const uint32_t num = (uint32_t)indices.size();
+		if (0 == num
+		||  num*20 > _lods.back().m_numIndices*19)
+		{
+			break;
+		}
+
+		triangleReorder(&indices[0], num, _numVertices, s_cacheSize);
+
+		lod.m_startIndex = (uint32_t)_indices.size();
+		lod.m_numIndices = num;
+		lod.m_error = fmax(error, _lods.back().m_error);
+		_lods.push_back(lod);
+
+		_indices.insert(_indices.end(), indices.begin(), indices.end() );
+	}
+}
+
+void writeLods(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, uint32_t _stride, const uint32_t* _indices, const LodArray& _lods)
+{
+	bx::write(_writer, BGFX_CHUNK_MAGIC_LOD);
+	bx::write(_writer, uint16_t(_lods.size() ) );
+
+	std::vector<uint8_t> used(_numVertices);
+	std::vector<float> positions;
+
+	for (LodArray::const_iterator it = _lods.begin(), itEnd = _lods.end(); it != itEnd; ++it)
+	{
+		const Lod& lod = *it;
+
+		std::fill(used.begin(), used.end(), 0);
+		positions.clear();
+		for (uint32_t ii = lod.m_startIndex, end = ii + lod.m_numIndices; ii < end; ++ii)
+		{
+			const uint32_t index = _indices[ii];
+			if (0 == used[index])
+			{
+				used[index] = 1;
+				const float* position = (const float*)&_vertices[index*_stride];
+				positions.insert(positions.end(), position, position+3);
+			}
+		}
+
+		const uint32_t numPositions = (uint32_t)positions.size()/3;
+
+		Sphere sphere;
+		calcMaxBoundingSphere(sphere, &positions[0], numPositions, 3*sizeof(float) );
+
+		Aabb aabb;
+		calcAabb(aabb, &positions[0], numPositions, 3*sizeof(float) );
+
+		bx::write(_writer, lod.m_startIndex);
+		bx::write(_writer, lod.m_numIndices);
+		bx::write(_writer, lod.m_error);
+		bx::write(_writer, sphere);
+		bx::write(_writer, aabb);
+
+		printf("lod %d: %d triangles, error %f\n"
+			, uint32_t(it - _lods.begin() )
+			, lod.m_numIndices/3
+			, lod.m_error
+			);
+	}
+}
+
+void writeChunk(bx::WriterI* _writer, uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, uint32_t* _indices, uint32_t _numIndices, bool _index32, const std::string& _material, PrimitiveArray& _primitives, WriteStats& _stats)
+{
+	const uint32_t stride = _decl.getStride();
+
+	analyzeVertexCache(_stats.m_cacheBefore, _indices, _numIndices, _numVertices, s_cacheSize);
+	analyzeVertexFetch(_stats.m_fetchBefore, _indices, _numIndices, _numVertices, stride, s_cacheSize);
+
+	_stats.m_triReorderElapsed -= bx::getHPCounter();
+	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+		triangleReorder(&_indices[prim.m_startIndex], prim.m_numIndices, _numVertices, s_cacheSize);
+
+		if (0.0f < s_overdrawThreshold)
+		{
+			overdrawReorder(&_indices[prim.m_startIndex], prim.m_numIndices, _vertices, _numVertices, stride, s_cacheSize, s_overdrawThreshold);
+		}
+	}
+	_stats.m_triReorderElapsed += bx::getHPCounter();
+
+	std::vector<uint32_t> indices(_indices, _indices + _numIndices);
+
+	LodArray lods;
+	if (0 < s_lodLevels)
+	{
+		_stats.m_lodElapsed -= bx::getHPCounter();
+		generateLods(lods, indices, _vertices, _numVertices, stride);
+		_stats.m_lodElapsed += bx::getHPCounter();
+	}
+
+	const uint32_t numIndices = (uint32_t)indices.size();
+
+	// Vertices are remapped in order of first use. Each primitive still
+	// owns contiguous range of vertices it introduced. Coarser LOD levels
+	// come after level 0 and only reference vertices it already uses.
+	std::vector<uint32_t> remap(_numVertices);
+	bgfx::optimizeVertexFetch(&remap[0], &indices[0], numIndices, _numVertices);
+	bgfx::remapIndices(&indices[0], numIndices, &remap[0]);
+	bgfx::remapVertices(_decl, _vertices, _numVertices, &remap[0]);
+
+	uint32_t numUsed = 0;
+	for (PrimitiveArray::iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		Primitive& prim = *primIt;
+		prim.m_startVertex = numUsed;
+		for (uint32_t ii = prim.m_startIndex, end = ii + prim.m_numIndices; ii < end; ++ii)
+		{
+			numUsed = bx::uint32_max(numUsed, indices[ii]+1);
+		}
+		prim.m_numVertices = numUsed - prim.m_startVertex;
+	}
+
+	analyzeVertexCache(_stats.m_cacheAfter, &indices[0], _numIndices, _numVertices, s_cacheSize);
+	analyzeVertexFetch(_stats.m_fetchAfter, &indices[0], _numIndices, _numVertices, stride, s_cacheSize);
+
+	write(_writer, _vertices, _numVertices, _decl, &indices[0], numIndices, _index32, _material, _primitives, _stats);
+
+	if (!lods.empty() )
+	{
+		writeLods(_writer, _vertices, _numVertices, stride, &indices[0], lods);
+	}
+
+	if (s_meshlets)
+	{
+		writeMeshlets(_writer, _vertices, _numVertices, stride, &indices[0], _primitives, _stats);
+	}
+
+	_stats.m_numChunks++;
+	_stats.m_numVertices += _numVertices;
+	_stats.m_numIndices += numIndices;
+}
+
+void writeChunk16(bx::WriterI* _writer, const uint8_t* _vertices, const bgfx::VertexDecl& _decl, const std::vector<uint32_t>& _chunkVertices, std::vector<uint32_t>& _chunkIndices, const std::string& _material, PrimitiveArray& _chunkPrimitives, WriteStats& _stats)
+{
+	const uint32_t stride = _decl.getStride();
+	const uint32_t numVertices = (uint32_t)_chunkVertices.size();
+
+	uint8_t* vertices = new uint8_t[numVertices*stride];
+	for (uint32_t ii = 0; ii < numVertices; ++ii)
+	{
+		memcpy(&vertices[ii*stride], &_vertices[_chunkVertices[ii]*stride], stride);
+	}
+
+	writeChunk(_writer, vertices, numVertices, _decl, &_chunkIndices[0], (uint32_t)_chunkIndices.size(), false, _material, _chunkPrimitives, _stats);
+
+	delete [] vertices;
+}
+
+/// Partition primitive groups into chunks addressable with 16-bit indices.
+/// Triangles keep their original order. Primitive group that crosses chunk
+/// boundary is split into multiple primitives with the same name.
+void writeSplit16(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const uint32_t* _indices, const std::string& _material, const PrimitiveArray& _primitives, WriteStats& _stats)
+{
+	std::vector<uint32_t> remap(_numVertices, UINT32_MAX);
+	std::vector<uint32_t> chunkVertices;
+	std::vector<uint32_t> chunkIndices;
+	PrimitiveArray chunkPrimitives;
+
+	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+
+		Primitive chunkPrim;
+		chunkPrim.m_startVertex = (uint32_t)chunkVertices.size();
+		chunkPrim.m_startIndex = (uint32_t)chunkIndices.size();
+		chunkPrim.m_name = prim.m_name;
+
+		for (uint32_t ii = prim.m_startIndex, end = prim.m_startIndex + prim.m_numIndices; ii < end; ii += 3)
+		{
+			const uint32_t* tri = &_indices[ii];
+			const uint32_t numNew = (UINT32_MAX == remap[tri[0]])
+				+ (UINT32_MAX == remap[tri[1]])
+				+ (UINT32_MAX == remap[tri[2]])
+				;
+
+			// At most 65535 vertices per chunk, index 0xffff is left unused.
+			if (UINT16_MAX < chunkVertices.size() + numNew)
+			{
+				chunkPrim.m_numVertices = (uint32_t)chunkVertices.size() - chunkPrim.m_startVertex;
+				chunkPrim.m_numIndices = (uint32_t)chunkIndices.size() - chunkPrim.m_startIndex;
+				if (0 < chunkPrim.m_numIndices)
+				{
+					chunkPrimitives.push_back(chunkPrim);
+				}
+
+				writeChunk16(_writer, _vertices, _decl, chunkVertices, chunkIndices, _material, chunkPrimitives, _stats);
+
+				for (std::vector<uint32_t>::const_iterator it = chunkVertices.begin(); it != chunkVertices.end(); ++it)
+				{
+					remap[*it] = UINT32_MAX;
+				}
+
+				chunkVertices.clear();
+				chunkIndices.clear();
+				chunkPrimitives.clear();
+				chunkPrim.m_startVertex = 0;
+				chunkPrim.m_startIndex = 0;
+			}
+
+			for (uint32_t jj = 0; jj < 3; ++jj)
+			{
+				uint32_t& index = remap[tri[jj]];
+				if (UINT32_MAX == index)
+				{
+					index = (uint32_t)chunkVertices.size();
+					chunkVertices.push_back(tri[jj]);
+				}
+
+				chunkIndices.push_back(index);
+			}
+		}
+
+		chunkPrim.m_numVertices = (uint32_t)chunkVertices.size() - chunkPrim.m_startVertex;
+		chunkPrim.m_numIndices = (uint32_t)chunkIndices.size() - chunkPrim.m_startIndex;
+		if (0 < chunkPrim.m_numIndices)
+		{
+			chunkPrimitives.push_back(chunkPrim);
+		}
+	}
+
+	if (!chunkIndices.empty() )
+	{
+		writeChunk16(_writer, _vertices, _decl, chunkVertices, chunkIndices, _material, chunkPrimitives, _stats);
+	}
+}
+
+void writeBatch(bx::WriterI* _writer, uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, uint32_t* _indices, uint32_t _numIndices, const std::string& _material, const PrimitiveArray& _primitives, IndexMode::Enum _indexMode, bool _hasTangent, WriteStats& _stats)
+{
+	// Tangents are calculated before splitting, vertices duplicated across
+	// chunks must end up with the same tangent.
+	if (_hasTangent)
+	{
+		calcTangents(_vertices, _numVertices, _decl, _indices, _numIndices);
+	}
+
+	const bool index32 = IndexMode::Index32 == _indexMode
+		|| (IndexMode::Auto == _indexMode && UINT16_MAX < _numVertices)
+		;
+
+	if (!index32)
+	{
+		writeSplit16(_writer, _vertices, _numVertices, _decl, _indices, _material, _primitives, _stats);
+		return;
+	}
+
+	PrimitiveArray primitives(_primitives);
+	writeChunk(_writer, _vertices, _numVertices, _decl, _indices, _numIndices, true, _material, primitives, _stats);
+}
+
+struct BenchStats
+{
+	uint64_t m_bytes;
+	uint64_t m_encodedBytes;
+	int64_t m_decodeElapsed;
+	uint64_t m_decodedBytes;
+};
+
+#define BENCH_DECODE_ITERATIONS 16
+
+void benchVertices(BenchStats& _stats, bx::ReaderI* _reader, uint32_t _chunk)
+{
+	// Skip Sphere, Aabb and Obb.
+	uint8_t bounds[sizeof(Sphere) + sizeof(Aabb) + sizeof(Obb)];
+	bx::read(_reader, bounds, sizeof(bounds) );
+
+	bgfx::VertexDecl decl;
+	bx::read(_reader, decl);
+	const uint32_t stride = decl.getStride();
+	const uint16_t posOffset = decl.getOffset(bgfx::Attrib::Position);
+
+	uint32_t numVertices;
+	if (BGFX_CHUNK_MAGIC_VB == _chunk)
+	{
+		uint16_t num;
+		bx::read(_reader, num);
+		numVertices = num;
+	}
+	else
+	{
+		bx::read(_reader, numVertices);
+	}
+
+	std::vector<uint8_t> vertices(numVertices*stride);
+	std::vector<uint8_t> encoded;
+	MeshQuantization quant;
+
+	if (BGFX_CHUNK_MAGIC_VBC == _chunk)
+	{
+		bx::read(_reader, quant);
+
+		uint32_t size;
+		bx::read(_reader, size);
+		encoded.resize(size);
+		bx::read(_reader, &encoded[0], size);
+	}
+	else
+	{
+		bx::read(_reader, &vertices[0], (int32_t)vertices.size() );
+
+		encoded.resize(meshVertexEncodeBound(numVertices, stride) );
+		encoded.resize(meshVertexEncode(&encoded[0], (uint32_t)encoded.size(), quant, &vertices[0], numVertices, stride, posOffset) );
+	}
+
+	EXPECT(!encoded.empty() );
+
+	int64_t elapsed = -bx::getHPCounter();
+	for (uint32_t ii = 0; ii < BENCH_DECODE_ITERATIONS; ++ii)
+	{
+		EXPECT(meshVertexDecode(&vertices[0], numVertices, stride, posOffset, quant, &encoded[0], (uint32_t)encoded.size() ) );
+	}
+	elapsed += bx::getHPCounter();
+
+	_stats.m_bytes += vertices.size();
+	_stats.m_encodedBytes += encoded.size();
+	_stats.m_decodeElapsed += elapsed;
+	_stats.m_decodedBytes += vertices.size()*BENCH_DECODE_ITERATIONS;
+}
+
+void benchIndices(BenchStats& _stats, bx::ReaderI* _reader, uint32_t _chunk)
+{
+	const bool index32 = BGFX_CHUNK_MAGIC_IB32 == _chunk || BGFX_CHUNK_MAGIC_IBC32 == _chunk;
+	const uint32_t indexSize = index32 ? 4 : 2;
+
+	uint32_t numIndices;
+	bx::read(_reader, numIndices);
+
+	std::vector<uint8_t> indices(numIndices*indexSize);
+	std::vector<uint8_t> encoded;
+
+	if (BGFX_CHUNK_MAGIC_IBC == _chunk
+	||  BGFX_CHUNK_MAGIC_IBC32 == _chunk)
+	{
+		uint32_t size;
+		bx::read(_reader, size);
+		encoded.resize(size);
+		bx::read(_reader, &encoded[0], size);
+	}
+	else
+	{
+		bx::read(_reader, &indices[0], (int32_t)indices.size() );
+
+		std::vector<uint32_t> indices32(numIndices);
+		for (uint32_t ii = 0; ii < numIndices; ++ii)
+		{
+			indices32[ii] = index32 ? ( (const uint32_t*)&indices[0])[ii] : ( (const uint16_t*)&indices[0])[ii];
+		}
+
+		encoded.resize(meshIndexEncodeBound(numIndices) );
+		encoded.resize(meshIndexEncode(&encoded[0], (uint32_t)encoded.size(), &indices32[0], numIndices) );
+	}
+
+	EXPECT(!encoded.empty() );
+
+	int64_t elapsed = -bx::getHPCounter();
+	for (uint32_t ii = 0; ii < BENCH_DECODE_ITERATIONS; ++ii)
+	{
+		EXPECT(meshIndexDecode(&indices[0], numIndices, index32, &encoded[0], (uint32_t)encoded.size() ) );
+	}
+	elapsed += bx::getHPCounter();
+
+	_stats.m_bytes += indices.size();
+	_stats.m_encodedBytes += encoded.size();
+	_stats.m_decodeElapsed += elapsed;
+	_stats.m_decodedBytes += indices.size()*BENCH_DECODE_ITERATIONS;
+}
+
+void printBench(const char* _name, const BenchStats& _stats)
+{
+	const double seconds = double(_stats.m_decodeElapsed)/bx::getHPFrequency();
+	printf("%s: raw %0.1f KiB, compressed %0.1f KiB (%0.2fx), decode %0.2f GB/s\n"
+		, _name
+		, double(_stats.m_bytes)/1024.0
+		, double(_stats.m_encodedBytes)/1024.0
+		, double(_stats.m_bytes)/double(_stats.m_encodedBytes > 0 ? _stats.m_encodedBytes : 1)
+		, seconds > 0.0 ? double(_stats.m_decodedBytes)/seconds/1.0e9 : 0.0
+		);
+}
+
+/// Report disk size, read time and decode throughput of compiled mesh.
+/// Raw files are compressed in memory, compressed files are decoded as is.
+int benchmark(const char* _filePath)
+{
+	int64_t readElapsed = -bx::getHPCounter();
+
+	FILE* file = fopen(_filePath, "rb");
+	if (NULL == file)
+	{
+		printf("Unable to open input file '%s'.", _filePath);
+		return EXIT_FAILURE;
+	}
+
+	const uint32_t size = (uint32_t)fsize(file);
+	std::vector<uint8_t> data(size);
+	size_t numRead = fread(&data[0], 1, size, file);
+	fclose(file);
+	EXPECT(numRead == size);
+
+	readElapsed += bx::getHPCounter();
+
+	BenchStats vertexStats;
+	memset(&vertexStats, 0, sizeof(vertexStats) );
+
+	BenchStats indexStats;
+	memset(&indexStats, 0, sizeof(indexStats) );
+
+	bool compressed = false;
+
+	bx::MemoryReader reader(&data[0], size);
+
+	uint32_t chunk;
+	while (4 == bx::read(&reader, chunk) )
+	{
+		switch (chunk)
+		{
+		case BGFX_CHUNK_MAGIC_VB:
+		case BGFX_CHUNK_MAGIC_VB32:
+		case BGFX_CHUNK_MAGIC_VBC:
+			compressed |= BGFX_CHUNK_MAGIC_VBC == chunk;
+			benchVertices(vertexStats, &reader, chunk);
+			break;
+
+		case BGFX_CHUNK_MAGIC_IB:
+		case BGFX_CHUNK_MAGIC_IB32:
+		case BGFX_CHUNK_MAGIC_IBC:
+		case BGFX_CHUNK_MAGIC_IBC32:
+			benchIndices(indexStats, &reader, chunk);
+			break;
+
+		case BGFX_CHUNK_MAGIC_PRI:
+			{
+				uint16_t len;
+				bx::read(&reader, len);
+				bx::skip(&reader, len);
+
+				uint16_t num;
+				bx::read(&reader, num);
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					bx::read(&reader, len);
+					bx::skip(&reader, len + 4*sizeof(uint32_t) + sizeof(Sphere) + sizeof(Aabb) + sizeof(Obb) );
+				}
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_VBS:
+			{
+				uint8_t stream;
+				bx::read(&reader, stream);
+
+				bgfx::VertexDecl decl;
+				bx::read(&reader, decl);
+
+				uint32_t num;
+				bx::read(&reader, num);
+				bx::skip(&reader, num*decl.getStride() );
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_LOD:
+			{
+				uint16_t num;
+				bx::read(&reader, num);
+				bx::skip(&reader, num*(2*sizeof(uint32_t) + sizeof(float) + sizeof(Sphere) + sizeof(Aabb) ) );
+			}
+			break;
+
+		case BGFX_CHUNK_MAGIC_MSH:
+			{
+				uint16_t numPrims;
+				bx::read(&reader, numPrims);
+				bx::skip(&reader, numPrims*2*sizeof(uint32_t) );
+
+				uint32_t num;
+				bx::read(&reader, num);
+				bx::skip(&reader, num*sizeof(Meshlet) );
+
+				bx::read(&reader, num);
+				bx::skip(&reader, num*sizeof(uint32_t) );
+
+				bx::read(&reader, num);
+				bx::skip(&reader, num*3);
+			}
+			break;
+
+		default:
+			printf("Unknown chunk %08x at %d.\n", chunk, (int32_t)reader.seek() );
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Compressed chunks store a few more bytes of header than raw ones,
+	// which is ignored here.
+	const uint64_t raw = vertexStats.m_bytes + indexStats.m_bytes;
+	const uint64_t encoded = vertexStats.m_encodedBytes + indexStats.m_encodedBytes;
+	const uint64_t other = size - (compressed ? encoded : raw);
+	const uint64_t rawSize = other + raw;
+	const uint64_t compressedSize = other + encoded;
+
+	const double readSeconds = double(readElapsed)/bx::getHPFrequency();
+	printf("%s (%s): %d bytes, read %0.3f ms (%0.1f MB/s)\n"
+		, _filePath
+		, compressed ? "compressed" : "raw"
+		, size
+		, readSeconds*1000.0
+		, readSeconds > 0.0 ? double(size)/readSeconds/1.0e6 : 0.0
+		);
+	printf("file size: raw %d bytes, compressed %d bytes (%0.2fx)\n"
+		, uint32_t(rawSize)
+		, uint32_t(compressedSize)
+		, double(rawSize)/double(compressedSize > 0 ? compressedSize : 1)
+		);
+	printBench("vertices", vertexStats);
+	printBench("indices", indexStats);
+
+	return EXIT_SUCCESS;
+}
+
+inline double megaVerticesPerSecond(uint64_t _num, int64_t _elapsed)
+{
+	const double seconds = double(_elapsed)/bx::getHPFrequency();
+	return seconds > 0.0 ? double(_num)/seconds/1.0e6 : 0.0;
+}
+
+/// Compare per vertex vertexPack/vertexUnpack with batch versions for all
+/// attribute types, and per attribute conversion with vertexConvert.
+int benchmarkVertex()
+{
+	static const char* s_attribTypeName[bgfx::AttribType::Count] =
+	{
+		"Uint8",
+		"Int16",
+		"Half",
+		"Float",
+	};
+
+	const uint32_t numVertices = 64<<10;
+	const uint32_t numIterations = 16;
+	const uint64_t numTotal = uint64_t(numVertices)*numIterations;
+
+	std::vector<float> input(numVertices*4);
+	for (uint32_t ii = 0, num = (uint32_t)input.size(); ii < num; ++ii)
+	{
+		input[ii] = float(ii%2001)/1000.0f - 1.0f;
+	}
+
+	std::vector<float> output(numVertices*4);
+	std::vector<float> outputBatch(numVertices*4);
+
+	printf("%d vertices, %d iterations, Mvertices/s\n", numVertices, numIterations);
+	printf("type   num asint      pack     batch    unpack     batch\n");
+
+	uint32_t numMismatch = 0;
+
+	for (uint32_t type = 0; type < bgfx::AttribType::Count; ++type)
+	{
+		for (uint32_t num = 1; num <= 4; ++num)
+		{
+			// asInt is used only by Uint8 and Int16.
+			const uint32_t numAsInt = type < bgfx::AttribType::Half ? 2 : 1;
+
+			for (uint32_t asInt = 0; asInt < numAsInt; ++asInt)
+			{
+				bgfx::VertexDecl decl;
+				decl.begin();
+				decl.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+				decl.add(bgfx::Attrib::Normal, uint8_t(num), bgfx::AttribType::Enum(type), true, 0 != asInt);
+				decl.end();
+
+				std::vector<uint8_t> data(decl.getSize(numVertices) );
+
+				int64_t packElapsed = -bx::getHPCounter();
+				for (uint32_t it = 0; it < numIterations; ++it)
+				{
+					for (uint32_t ii = 0; ii < numVertices; ++ii)
+					{
+						bgfx::vertexPack(&input[ii*4], true, bgfx::Attrib::Normal, decl, &data[0], ii);
+					}
+				}
+				packElapsed += bx::getHPCounter();
+
+				int64_t packBatchElapsed = -bx::getHPCounter();
+				for (uint32_t it = 0; it < numIterations; ++it)
+				{
+					bgfx::vertexPack(&input[0], true, bgfx::Attrib::Normal, decl, &data[0], 0, numVertices);
+				}
+				packBatchElapsed += bx::getHPCounter();
+
+				int64_t unpackElapsed = -bx::getHPCounter();
+				for (uint32_t it = 0; it < numIterations; ++it)
+				{
+					for (uint32_t ii = 0; ii < numVertices; ++ii)
+					{
+						bgfx::vertexUnpack(&output[ii*4], bgfx::Attrib::Normal, decl, &data[0], ii);
+					}
+				}
+				unpackElapsed += bx::getHPCounter();
+
+				int64_t unpackBatchElapsed = -bx::getHPCounter();
+				for (uint32_t it = 0; it < numIterations; ++it)
+				{
+					bgfx::vertexUnpack(&outputBatch[0], bgfx::Attrib::Normal, decl, &data[0], 0, numVertices);
+				}
+				unpackBatchElapsed += bx::getHPCounter();
+
+				const bool mismatch = 0 != memcmp(&output[0], &outputBatch[0], output.size()*sizeof(float) );
+				numMismatch += mismatch;
+
+				printf("%-6s %3d %5d %9.1f %9.1f %9.1f %9.1f%s\n"
+					, s_attribTypeName[type]
+					, num
+					, asInt
+					, megaVerticesPerSecond(numTotal, packElapsed)
+					, megaVerticesPerSecond(numTotal, packBatchElapsed)
+					, megaVerticesPerSecond(numTotal, unpackElapsed)
+					, megaVerticesPerSecond(numTotal, unpackBatchElapsed)
+					, mismatch ? " MISMATCH" : ""
+					);
+			}
+		}
+	}
+
+	bgfx::VertexDecl srcDecl;
+	srcDecl.begin();
+	srcDecl.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+	srcDecl.add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float);
+	srcDecl.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float);
+	srcDecl.end();
+
+	bgfx::VertexDecl destDecl;
+	destDecl.begin();
+	destDecl.add(bgfx::Attrib::Position, 4, bgfx::AttribType::Half);
+	destDecl.add(bgfx::Attrib::Normal, 4, bgfx::AttribType::Uint8, true, true);
+	destDecl.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Int16, true, true);
+	destDecl.end();
+
+	std::vector<uint8_t> src(srcDecl.getSize(numVertices) );
+	bgfx::vertexPack(&input[0], true, bgfx::Attrib::Position, srcDecl, &src[0], 0, numVertices);
+	bgfx::vertexPack(&input[0], true, bgfx::Attrib::Normal, srcDecl, &src[0], 0, numVertices);
+	bgfx::vertexPack(&input[0], true, bgfx::Attrib::TexCoord0, srcDecl, &src[0], 0, numVertices);
+
+	std::vector<uint8_t> dest(destDecl.getSize(numVertices) );
+	std::vector<uint8_t> destBatch(destDecl.getSize(numVertices) );
+
+	const bgfx::Attrib::Enum convertAttribs[] =
 	{
-		float m_x;
-		float m_y;
-		float m_z;
-		float m_pad0;
-		float m_u;
-		float m_v;
-		float m_pad1;
-		float m_pad2;
+		bgfx::Attrib::Position,
+		bgfx::Attrib::Normal,
+		bgfx::Attrib::TexCoord0,
 	};
-	
-	float* tangents = new float[6*_numVertices];
-	memset(tangents, 0, 6*_numVertices*sizeof(float) );
-
-	PosTexcoord v0;
-	PosTexcoord v1;
-	PosTexcoord v2;
 
-	for (uint32_t ii = 0, num = _numIndices/3; ii < num; ++ii)
+	int64_t convertElapsed = -bx::getHPCounter();
+	for (uint32_t it = 0; it < numIterations; ++it)
 	{
-		const uint16_t* indices = &_indices[ii*3];
-		uint32_t i0 = indices[0];
-		uint32_t i1 = indices[1];
-		uint32_t i2 = indices[2];
-
-		bgfx::vertexUnpack(&v0.m_x, bgfx::Attrib::Position, _decl, _vertices, i0);
-		bgfx::vertexUnpack(&v0.m_u, bgfx::Attrib::TexCoord0, _decl, _vertices, i0);
-
-		bgfx::vertexUnpack(&v1.m_x, bgfx::Attrib::Position, _decl, _vertices, i1);
-		bgfx::vertexUnpack(&v1.m_u, bgfx::Attrib::TexCoord0, _decl, _vertices, i1);
-
-		bgfx::vertexUnpack(&v2.m_x, bgfx::Attrib::Position, _decl, _vertices, i2);
-		bgfx::vertexUnpack(&v2.m_u, bgfx::Attrib::TexCoord0, _decl, _vertices, i2);
+		for (uint32_t ii = 0; ii < numVertices; ++ii)
+		{
+			for (uint32_t jj = 0; jj < BX_COUNTOF(convertAttribs); ++jj)
+			{
+				float unpacked[4];
+				bgfx::vertexUnpack(unpacked, convertAttribs[jj], srcDecl, &src[0], ii);
+				bgfx::vertexPack(unpacked, true, convertAttribs[jj], destDecl, &dest[0], ii);
+			}
+		}
+	}
+	convertElapsed += bx::getHPCounter();
 
-		const float bax = v1.m_x - v0.m_x;
-		const float bay = v1.m_y - v0.m_y;
-		const float baz = v1.m_z - v0.m_z;
-		const float bau = v1.m_u - v0.m_u;
-		const float bav = v1.m_v - v0.m_v;
+	int64_t convertBatchElapsed = -bx::getHPCounter();
+	for (uint32_t it = 0; it < numIterations; ++it)
+	{
+		bgfx::vertexConvert(destDecl, &destBatch[0], srcDecl, &src[0], numVertices);
+	}
+	convertBatchElapsed += bx::getHPCounter();
 
-		const float cax = v2.m_x - v0.m_x;
-		const float cay = v2.m_y - v0.m_y;
-		const float caz = v2.m_z - v0.m_z;
-		const float cau = v2.m_u - v0.m_u;
-		const float cav = v2.m_v - v0.m_v;
+	const bool mismatch = dest != destBatch;
+	numMismatch += mismatch;
 
-		const float det = (bau * cav - bav * cau);
-		const float invDet = 1.0f / det;
+	printf("convert float pos/normal/uv -> packed: per vertex %0.1f, vertexConvert %0.1f%s\n"
+		, megaVerticesPerSecond(numTotal, convertElapsed)
+		, megaVerticesPerSecond(numTotal, convertBatchElapsed)
+		, mismatch ? " MISMATCH" : ""
+		);
 
-		const float tx = (bax * cav - cax * bav) * invDet;
-		const float ty = (bay * cav - cay * bav) * invDet;
-		const float tz = (baz * cav - caz * bav) * invDet;
+	return 0 == numMismatch ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-		const float bx = (cax * bau - bax * cau) * invDet;
-		const float by = (cay * bau - bay * cau) * invDet;
-		const float bz = (caz * bau - baz * cau) * invDet;
+/// Grid of quads on XY plane where every triangle has its own vertices.
+/// Positions get jitter smaller than _epsilon, and every other strip of
+/// 8 quads has texture coordinates offset, so corners on strip boundary
+/// are welded by position but not by all attributes.
+void makeWeldMesh(std::vector<uint8_t>& _data, const bgfx::VertexDecl& _decl, uint32_t _gridSize, float _epsilon)
+{
+	static const uint8_t s_corner[6][2] =
+	{
+		{ 0, 0 }, { 1, 0 }, { 1, 1 },
+		{ 0, 0 }, { 1, 1 }, { 0, 1 },
+	};
 
-		for (uint32_t jj = 0; jj < 3; ++jj)
-		{
-			float* tanu = &tangents[indices[jj]*6];
-			float* tanv = &tanu[3];
-			tanu[0] += tx;
-			tanu[1] += ty;
-			tanu[2] += tz;
+	const uint32_t numVertices = _gridSize*_gridSize*6;
+	_data.resize(_decl.getSize(numVertices) );
 
-			tanv[0] += bx;
-			tanv[1] += by;
-			tanv[2] += bz;
-		}
-	}
+	const float normal[4] = { 0.0f, 0.0f, 1.0f, 0.0f };
 
-	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	uint32_t index = 0;
+	for (uint32_t yy = 0; yy < _gridSize; ++yy)
 	{
-		const float* tanu = &tangents[ii*6];
-		const float* tanv = &tangents[ii*6 + 3];
-
-		float normal[4];
-		bgfx::vertexUnpack(normal, bgfx::Attrib::Normal, _decl, _vertices, ii);
-		float ndt = vec3Dot(normal, tanu);
-
-		float nxt[3];
-		vec3Cross(nxt, normal, tanu);
+		for (uint32_t xx = 0; xx < _gridSize; ++xx)
+		{
+			const float strip = float( (xx/8)&1)*0.5f;
 
-		float tmp[3];
-		tmp[0] = tanu[0] - normal[0] * ndt;
-		tmp[1] = tanu[1] - normal[1] * ndt;
-		tmp[2] = tanu[2] - normal[2] * ndt;
+			for (uint32_t ii = 0; ii < 6; ++ii, ++index)
+			{
+				const uint32_t cx = xx + s_corner[ii][0];
+				const uint32_t cy = yy + s_corner[ii][1];
+				const float jitter = float(bx::hashMurmur2A(index)&0xff)/255.0f*_epsilon*0.25f;
 
-		float tangent[4];
-		vec3Norm(tangent, tmp);
+				float pos[4] = { float(cx)*0.01f + jitter, float(cy)*0.01f - jitter, jitter, 0.0f };
+				bgfx::vertexPack(pos, false, bgfx::Attrib::Position, _decl, &_data[0], index);
+				bgfx::vertexPack(normal, true, bgfx::Attrib::Normal, _decl, &_data[0], index);
 
-		tangent[3] = vec3Dot(nxt, tanv) < 0.0f ? -1.0f : 1.0f;
-		bgfx::vertexPack(tangent, true, bgfx::Attrib::Tangent, _decl, _vertices, ii);
+				float uv[4] = { float(cx)/float(_gridSize) + strip, float(cy)/float(_gridSize), 0.0f, 0.0f };
+				bgfx::vertexPack(uv, true, bgfx::Attrib::TexCoord0, _decl, &_data[0], index);
+			}
+		}
 	}
+}
 
-	delete [] tangents;
-} 
-
-void writeBounds(bx::WriterI* _writer, const void* _vertices, uint32_t _numVertices, uint32_t _stride)
+/// Compare weldVerticesRef, 16-bit weldVertices and 32-bit weldVertices.
+int benchmarkWeld(uint32_t _numThreads)
 {
-	Sphere maxSphere;
-	calcMaxBoundingSphere(maxSphere, _vertices, _numVertices, _stride);
+	bgfx::VertexDecl decl;
+	decl.begin();
+	decl.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+	decl.add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float);
+	decl.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float);
+	decl.end();
 
-	Sphere minSphere;
-	calcMinBoundingSphere(minSphere, _vertices, _numVertices, _stride);
+	const float epsilon = 0.0001f;
 
-	if (minSphere.m_radius > maxSphere.m_radius)
+	float positionEpsilon[bgfx::Attrib::Count];
+	float allEpsilon[bgfx::Attrib::Count];
+	for (uint32_t ii = 0; ii < bgfx::Attrib::Count; ++ii)
 	{
-		bx::write(_writer, maxSphere);
-	}
-	else
-	{
-		bx::write(_writer, minSphere);
+		positionEpsilon[ii] = -1.0f;
+		allEpsilon[ii] = epsilon;
 	}
+	positionEpsilon[bgfx::Attrib::Position] = epsilon;
 
-	Aabb aabb;
-	calcAabb(aabb, _vertices, _numVertices, _stride);
-	bx::write(_writer, aabb);
-
-	Obb obb;
-	calcObb(obb, _vertices, _numVertices, _stride, s_obbSteps);
-	bx::write(_writer, obb);
-}
+	uint32_t numMismatch = 0;
+	std::vector<uint8_t> data;
 
-void write(bx::WriterI* _writer, const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const uint16_t* _indices, uint32_t _numIndices, const std::string& _material, const PrimitiveArray& _primitives)
-{
-	uint32_t stride = _decl.getStride();
-	bx::write(_writer, BGFX_CHUNK_MAGIC_VB);
-	writeBounds(_writer, _vertices, _numVertices, stride);
+	// Small mesh, reference O(n^2) welding is still usable.
+	{
+		makeWeldMesh(data, decl, 32, epsilon);
+		const uint16_t num = uint16_t(data.size()/decl.getStride() );
+
+		std::vector<uint16_t> ref(num);
+		int64_t refElapsed = -bx::getHPCounter();
+		const uint32_t refUnique = bgfx::weldVerticesRef(&ref[0], decl, &data[0], num, epsilon);
+		refElapsed += bx::getHPCounter();
+
+		std::vector<uint16_t> output16(num);
+		int64_t elapsed16 = -bx::getHPCounter();
+		const uint32_t unique16 = bgfx::weldVertices(&output16[0], decl, &data[0], num, epsilon);
+		elapsed16 += bx::getHPCounter();
+
+		std::vector<uint32_t> output32(num);
+		int64_t elapsed32 = -bx::getHPCounter();
+		const uint32_t unique32 = bgfx::weldVertices(&output32[0], decl, &data[0], num, positionEpsilon, _numThreads);
+		elapsed32 += bx::getHPCounter();
+
+		bool mismatch = refUnique != unique32;
+		for (uint32_t ii = 0; ii < num; ++ii)
+		{
+			mismatch |= ref[ii] != output32[ii];
+		}
+		numMismatch += mismatch;
 
-	bx::write(_writer, _decl);
-	bx::write(_writer, uint16_t(_numVertices) );
-	bx::write(_writer, _vertices, _numVertices*stride);
+		printf("%d vertices, position only:\n", num);
+		printf("  ref      %8d unique %9.2f Mvertices/s\n", refUnique, megaVerticesPerSecond(num, refElapsed) );
+		printf("  16-bit   %8d unique %9.2f Mvertices/s\n", unique16, megaVerticesPerSecond(num, elapsed16) );
+		printf("  32-bit   %8d unique %9.2f Mvertices/s%s\n", unique32, megaVerticesPerSecond(num, elapsed32), mismatch ? " MISMATCH" : "");
+	}
 
-	bx::write(_writer, BGFX_CHUNK_MAGIC_IB);
-	bx::write(_writer, _numIndices);
-	bx::write(_writer, _indices, _numIndices*2);
+	// Largest mesh 16-bit welding can handle.
+	{
+		makeWeldMesh(data, decl, 104, epsilon);
+		const uint16_t num = uint16_t(data.size()/decl.getStride() );
+
+		std::vector<uint16_t> output16(num);
+		int64_t elapsed16 = -bx::getHPCounter();
+		const uint32_t unique16 = bgfx::weldVertices(&output16[0], decl, &data[0], num, epsilon);
+		elapsed16 += bx::getHPCounter();
+
+		std::vector<uint32_t> output32(num);
+		int64_t elapsed32 = -bx::getHPCounter();
+		const uint32_t unique32 = bgfx::weldVertices(&output32[0], decl, &data[0], num, positionEpsilon, 1);
+		elapsed32 += bx::getHPCounter();
+
+		std::vector<uint32_t> output32mt(num);
+		int64_t elapsed32mt = -bx::getHPCounter();
+		bgfx::weldVertices(&output32mt[0], decl, &data[0], num, positionEpsilon, _numThreads);
+		elapsed32mt += bx::getHPCounter();
+
+		const bool mismatch = output32 != output32mt;
+		numMismatch += mismatch;
+
+		printf("%d vertices, position only:\n", num);
+		printf("  16-bit   %8d unique %9.2f Mvertices/s\n", unique16, megaVerticesPerSecond(num, elapsed16) );
+		printf("  32-bit   %8d unique %9.2f Mvertices/s, %d threads %0.2f Mvertices/s%s\n"
+			, unique32
+			, megaVerticesPerSecond(num, elapsed32)
+			, _numThreads
+			, megaVerticesPerSecond(num, elapsed32mt)
+			, mismatch ? " MISMATCH" : ""
+			);
+	}
 
-	bx::write(_writer, BGFX_CHUNK_MAGIC_PRI);
-	uint16_t nameLen = uint16_t(_material.size() );
-	bx::write(_writer, nameLen);
-	bx::write(_writer, _material.c_str(), nameLen);
-	bx::write(_writer, uint16_t(_primitives.size() ) );
-	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	// Large mesh, all attributes.
 	{
-		const Primitive& prim = *primIt;
-		nameLen = uint16_t(prim.m_name.size() );
-		bx::write(_writer, nameLen);
-		bx::write(_writer, prim.m_name.c_str(), nameLen);
-		bx::write(_writer, prim.m_startIndex);
-		bx::write(_writer, prim.m_numIndices);
-		bx::write(_writer, prim.m_startVertex);
-		bx::write(_writer, prim.m_numVertices);
-		writeBounds(_writer, &_vertices[prim.m_startVertex*stride], prim.m_numVertices, stride);
+		makeWeldMesh(data, decl, 600, epsilon);
+		const uint32_t num = uint32_t(data.size()/decl.getStride() );
+
+		std::vector<uint32_t> output32(num);
+		int64_t elapsed32 = -bx::getHPCounter();
+		const uint32_t unique32 = bgfx::weldVertices(&output32[0], decl, &data[0], num, allEpsilon, 1);
+		elapsed32 += bx::getHPCounter();
+
+		std::vector<uint32_t> output32mt(num);
+		int64_t elapsed32mt = -bx::getHPCounter();
+		bgfx::weldVertices(&output32mt[0], decl, &data[0], num, allEpsilon, _numThreads);
+		elapsed32mt += bx::getHPCounter();
+
+		const bool mismatch = output32 != output32mt;
+		numMismatch += mismatch;
+
+		printf("%d vertices, all attributes:\n", num);
+		printf("  32-bit   %8d unique %9.2f Mvertices/s, %d threads %0.2f Mvertices/s%s\n"
+			, unique32
+			, megaVerticesPerSecond(num, elapsed32)
+			, _numThreads
+			, megaVerticesPerSecond(num, elapsed32mt)
+			, mismatch ? " MISMATCH" : ""
+			);
 	}
+
+	return 0 == numMismatch ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 void help(const char* _error = NULL)
@@ -330,6 +1430,39 @@ void help(const char* _error = NULL)
 		  "           0 - unpacked 8 bytes (default).\n"
 		  "           1 - packed 4 bytes.\n"
 		  "      --tangent            Calculate tangent vectors (packing mode is the same as normal).\n"
+		  "      --index <mode>       Index format.\n"
+		  "           16   - 16-bit indices, meshes with more than 65535 vertices are\n"
+		  "                  split into multiple chunks (default).\n"
+		  "           32   - 32-bit indices, meshes are never split.\n"
+		  "           auto - 16-bit indices, 32-bit only for meshes that don't fit.\n"
+		  "           32-bit indices require BGFX_CAPS_INDEX32 at runtime.\n"
+		  "      --index32            Same as --index 32.\n"
+		  "      --overdraw <num>     Reorder triangle clusters to reduce overdraw. Value is\n"
+		  "           allowed vertex cache ACMR increase (for example 1.05). Default\n"
+		  "           is 0, overdraw optimization is disabled.\n"
+		  "      --meshlets           Write meshlet chunk with per meshlet bounds and normal\n"
+		  "           cone after each primitive chunk.\n"
+		  "      --meshletverts <num> Maximum number of vertices per meshlet (default 64).\n"
+		  "      --meshlettris <num>  Maximum number of triangles per meshlet (default 126).\n"
+		  "      --lod <num>          Number of LOD levels to generate, in addition to level 0.\n"
+		  "           Levels are written into the same file, with LOD chunk after\n"
+		  "           each primitive chunk. Load with examples/common/lodmesh.h.\n"
+		  "      --lodratio <num>     Triangle count ratio between levels (default 0.5).\n"
+		  "      --loderror <num>     Maximum simplification error, relative to mesh bounding\n"
+		  "           sphere radius (for example 0.01). Default is 0, no limit.\n"
+		  "      --threads <num>      Number of threads used for parsing input (default 4).\n"
+		  "      --block <num>        Input is read and parsed in blocks of <num> MiB\n"
+		  "           (default 64). Only one block of input text is in memory.\n"
+		  "      --compress           Write compressed vertex and index chunks. Positions are\n"
+		  "           quantized to 16 bits. Load with examples/common/meshcodec.h.\n"
+		  "      --posstream          Write positions alone in vertex chunk, and remaining\n"
+		  "           attributes as vertex stream 1 (VBS chunk), for depth only passes.\n"
+		  "      --bench <file path>  Measure size, read time and decode throughput of\n"
+		  "           compiled mesh file, raw and compressed.\n"
+		  "      --benchvertex        Measure per vertex and batch vertex pack, unpack and\n"
+		  "           convert throughput for all attribute types.\n"
+		  "      --benchweld          Measure vertex welding throughput, 16-bit and 32-bit\n"
+		  "           welding. Use --threads to set number of threads.\n"
 
 		  "\n"
 		  "For additional information, see https://github.com/bkaradzic/bgfx\n"
@@ -357,6 +1490,26 @@ int main(int _argc, const char* _argv[])
 {
 	bx::CommandLine cmdLine(_argc, _argv);
 
+	const char* benchFilePath = cmdLine.findOption("bench");
+	if (NULL != benchFilePath)
+	{
+		return benchmark(benchFilePath);
+	}
+
+	if (cmdLine.hasArg("benchvertex") )
+	{
+		return benchmarkVertex();
+	}
+
+	uint32_t numThreads = 4;
+	cmdLine.hasArg(numThreads, '\0', "threads");
+	numThreads = bx::uint32_min(bx::uint32_max(numThreads, 1), 64);
+
+	if (cmdLine.hasArg("benchweld") )
+	{
+		return benchmarkWeld(numThreads);
+	}
+
 	const char* filePath = cmdLine.findOption('f');
 	if (NULL == filePath)
 	{
@@ -391,253 +1544,85 @@ int main(int _argc, const char* _argv[])
 	bool flipV = cmdLine.hasArg("flipv");
 	bool hasTangent = cmdLine.hasArg("tangent");
 
-	FILE* file = fopen(filePath, "r");
-	if (NULL == file)
+	IndexMode::Enum indexMode = IndexMode::Index16;
+	const char* indexArg = cmdLine.findOption("index");
+	if (NULL != indexArg)
 	{
-		printf("Unable to open input file '%s'.", filePath);
-		exit(EXIT_FAILURE);
+		if (0 == strcmp(indexArg, "32") )
+		{
+			indexMode = IndexMode::Index32;
+		}
+		else if (0 == strcmp(indexArg, "auto") )
+		{
+			indexMode = IndexMode::Auto;
+		}
+		else if (0 != strcmp(indexArg, "16") )
+		{
+			help("Invalid index mode.");
+			return EXIT_FAILURE;
+		}
 	}
 
-	int64_t parseElapsed = -bx::getHPCounter();
-	int64_t triReorderElapsed = 0;
-
-	uint32_t size = (uint32_t)fsize(file);
-	char* data = new char[size+1];
-	size = (uint32_t)fread(data, 1, size, file);
-	data[size] = '\0';
-	fclose(file);
-
-	// https://en.wikipedia.org/wiki/Wavefront_.obj_file
-
-	Vector3Array positions;
-	Vector3Array normals;
-	Vector3Array texcoords;
-	Index3Map indexMap;
-	TriangleArray triangles;
-	GroupArray groups;
-
-	uint32_t num = 0;
-
-	Group group;
-	group.m_startTriangle = 0;
-	group.m_numTriangles = 0;
-
-	char commandLine[2048];
-	uint32_t len = sizeof(commandLine);
-	int argc;
-	char* argv[64];
-	const char* next = data;
-	do
+	if (cmdLine.hasArg("index32") )
 	{
-		next = tokenizeCommandLine(next, commandLine, len, argc, argv, BX_COUNTOF(argv), '\n');
-		if (0 < argc)
-		{
-			if (0 == strcmp(argv[0], "#") )
-			{
-				if (2 < argc
-				&&  0 == strcmp(argv[2], "polygons") )
-				{
-				}
-			}
-			else if (0 == strcmp(argv[0], "f") )
-			{
-				Triangle triangle;
-				memset(&triangle, 0, sizeof(Triangle) );
-
-				for (uint32_t edge = 0, numEdges = argc-1; edge < numEdges; ++edge)
-				{
-					Index3 index;
-					index.m_texcoord = -1;
-					index.m_normal = -1;
-					index.m_vertexIndex = -1;
-
-					char* vertex = argv[edge+1];
-					char* texcoord = strchr(vertex, '/');
-					if (NULL != texcoord)
-					{
-						*texcoord++ = '\0';
-
-						char* normal = strchr(texcoord, '/');
-						if (NULL != normal)
-						{
-							*normal++ = '\0';
-							index.m_normal = atoi(normal)-1;
-						}
-
-						index.m_texcoord = atoi(texcoord)-1;
-					}
-
-					index.m_position = atoi(vertex)-1;
-
-					uint64_t hash0 = index.m_position;
-					uint64_t hash1 = uint64_t(index.m_texcoord)<<20;
-					uint64_t hash2 = uint64_t(index.m_normal)<<40;
-					uint64_t hash = hash0^hash1^hash2;
-
-					std::pair<Index3Map::iterator, bool> result = indexMap.insert(std::make_pair(hash, index) );
-					if (!result.second)
-					{
-						Index3& oldIndex = result.first->second;
-						BX_UNUSED(oldIndex);
-						BX_CHECK(oldIndex.m_position == index.m_position
-							&& oldIndex.m_texcoord == index.m_texcoord
-							&& oldIndex.m_normal == index.m_normal
-							, "Hash collision!"
-							);
-					}
-
-					switch (edge)
-					{
-					case 0:
-					case 1:
-					case 2:
-						triangle.m_index[edge] = hash;
-						if (2 == edge)
-						{
-							if (ccw)
-							{
-								std::swap(triangle.m_index[1], triangle.m_index[2]);
-							}
-							triangles.push_back(triangle);
-						}
-						break;
+		indexMode = IndexMode::Index32;
+	}
 
-					default:
-						if (ccw)
-						{
-							triangle.m_index[2] = triangle.m_index[1];
-							triangle.m_index[1] = hash;
-						}
-						else
-						{
-							triangle.m_index[1] = triangle.m_index[2];
-							triangle.m_index[2] = hash;
-						}
-						triangles.push_back(triangle);
-						break;
-					}
-				}
-			}
-			else if (0 == strcmp(argv[0], "g") )
-			{
-				EXPECT(1 < argc);
-				group.m_name = argv[1];
-			}
-			else if (*argv[0] == 'v')
-			{
-				group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-				if (0 < group.m_numTriangles)
-				{
-					groups.push_back(group);
-					group.m_startTriangle = (uint32_t)(triangles.size() );
-					group.m_numTriangles = 0;
-				}
+	const char* overdrawArg = cmdLine.findOption("overdraw");
+	if (NULL != overdrawArg)
+	{
+		s_overdrawThreshold = (float)atof(overdrawArg);
+	}
 
-				if (0 == strcmp(argv[0], "vn") )
-				{
-					Vector3 normal;
-					normal.x = (float)atof(argv[1]);
-					normal.y = (float)atof(argv[2]);
-					normal.z = (float)atof(argv[3]);
+	s_meshlets = cmdLine.hasArg("meshlets");
+	cmdLine.hasArg(s_meshletMaxVertices, '\0', "meshletverts");
+	cmdLine.hasArg(s_meshletMaxTriangles, '\0', "meshlettris");
+	s_meshletMaxVertices = bx::uint32_min(bx::uint32_max(s_meshletMaxVertices, 3), 256);
+	s_meshletMaxTriangles = bx::uint32_min(bx::uint32_max(s_meshletMaxTriangles, 1), 65535);
 
-					normals.push_back(normal);
-				}
-				else if (0 == strcmp(argv[0], "vp") )
-				{
-					static bool once = true;
-					if (once)
-					{
-						once = false;
-						printf("warning: 'parameter space vertices' are unsupported.\n");
-					}
-				}
-				else if (0 == strcmp(argv[0], "vt") )
-				{
-					Vector3 texcoord;
-					texcoord.x = (float)atof(argv[1]);
-					texcoord.y = 0.0f;
-					texcoord.z = 0.0f;
-					switch (argc)
-					{
-					case 4:
-						texcoord.z = (float)atof(argv[3]);
-						// fallthrough
-					case 3:
-						texcoord.y = (float)atof(argv[2]);
-						break;
-
-					default:
-						break;
-					}
+	s_compress = cmdLine.hasArg("compress");
+	s_posStream = cmdLine.hasArg("posstream");
 
-					texcoords.push_back(texcoord);
-				}
-				else
-				{
-					float px = (float)atof(argv[1]);
-					float py = (float)atof(argv[2]);
-					float pz = (float)atof(argv[3]);
-					float pw = 1.0f;
-					if (argc > 4)
-					{
-						pw = (float)atof(argv[4]);
-					}
+	cmdLine.hasArg(s_lodLevels, '\0', "lod");
+	s_lodLevels = bx::uint32_min(s_lodLevels, 15);
 
-					float invW = scale/pw;
-					px *= invW;
-					py *= invW;
-					pz *= invW;
+	const char* lodRatioArg = cmdLine.findOption("lodratio");
+	if (NULL != lodRatioArg)
+	{
+		s_lodRatio = fmin(fmax( (float)atof(lodRatioArg), 0.01f), 0.99f);
+	}
 
-					Vector3 pos;
-					pos.x = px;
-					pos.y = py;
-					pos.z = pz;
+	const char* lodErrorArg = cmdLine.findOption("loderror");
+	if (NULL != lodErrorArg)
+	{
+		s_lodError = (float)atof(lodErrorArg);
+	}
 
-					positions.push_back(pos);
-				}
-			}
-			else if (0 == strcmp(argv[0], "usemtl") )
-			{
-				std::string material(argv[1]);
 
-				if (material != group.m_material)
-				{
-					group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-					if (0 < group.m_numTriangles)
-					{
-						groups.push_back(group);
-						group.m_startTriangle = (uint32_t)(triangles.size() );
-						group.m_numTriangles = 0;
-					}
-				}
+	uint32_t blockSize = 64;
+	cmdLine.hasArg(blockSize, '\0', "block");
+	blockSize = bx::uint32_min(bx::uint32_max(blockSize, 1), 1024);
 
-				group.m_material = material;
-			}
-// unsupported tags
-// 				else if (0 == strcmp(argv[0], "mtllib") )
-// 				{
-// 				}
-// 				else if (0 == strcmp(argv[0], "o") )
-// 				{
-// 				}
-// 				else if (0 == strcmp(argv[0], "s") )
-// 				{
-// 				}
-		}
+	int64_t parseElapsed = -bx::getHPCounter();
 
-		++num;
-	}
-	while ('\0' != *next);
+	ObjMesh mesh;
+	ObjParseStats parseStats;
+	memset(&parseStats, 0, sizeof(parseStats) );
 
-	group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-	if (0 < group.m_numTriangles)
+	if (!objParse(mesh, parseStats, filePath, scale, ccw, numThreads, blockSize<<20) )
 	{
-		groups.push_back(group);
-		group.m_startTriangle = (uint32_t)(triangles.size() );
-		group.m_numTriangles = 0;
+		printf("Unable to open input file '%s'.", filePath);
+		exit(EXIT_FAILURE);
 	}
 
-	delete [] data;
+	EXPECT(!mesh.m_indices.empty() );
+
+	const Vector3Array& positions = mesh.m_positions;
+	const Vector3Array& normals = mesh.m_normals;
+	const Vector3Array& texcoords = mesh.m_texcoords;
+	Index3Array& uniqueVertices = mesh.m_vertices;
+	GroupArray& groups = mesh.m_groups;
+	const uint32_t num = mesh.m_numLines;
 
 	int64_t now = bx::getHPCounter();
 	parseElapsed += now;
@@ -649,18 +1634,25 @@ int main(int _argc, const char* _argv[])
 	bool hasNormal;
 	bool hasTexcoord;
 	{
-		Index3Map::const_iterator it = indexMap.begin();
-		hasNormal = -1 != it->second.m_normal;
-		hasTexcoord = -1 != it->second.m_texcoord;
+		// Unique vertex order depends on number of parser threads, any
+		// vertex having attribute adds it to vertex declaration.
+		hasNormal = false;
+		hasTexcoord = false;
+
+		for (Index3Array::const_iterator it = uniqueVertices.begin(), itEnd = uniqueVertices.end(); it != itEnd; ++it)
+		{
+			hasNormal   |= -1 != it->m_normal;
+			hasTexcoord |= -1 != it->m_texcoord;
+		}
 
 		if (!hasTexcoord
 		&&  texcoords.size() == positions.size() )
 		{
 			hasTexcoord = true;
 
-			for (Index3Map::iterator it = indexMap.begin(), itEnd = indexMap.end(); it != itEnd; ++it)
+			for (Index3Array::iterator it = uniqueVertices.begin(), itEnd = uniqueVertices.end(); it != itEnd; ++it)
 			{
-				it->second.m_texcoord = it->second.m_position;
+				it->m_texcoord = it->m_position;
 			}
 		}
 
@@ -669,9 +1661,9 @@ int main(int _argc, const char* _argv[])
 		{
 			hasNormal = true;
 
-			for (Index3Map::iterator it = indexMap.begin(), itEnd = indexMap.end(); it != itEnd; ++it)
+			for (Index3Array::iterator it = uniqueVertices.begin(), itEnd = uniqueVertices.end(); it != itEnd; ++it)
 			{
-				it->second.m_normal = it->second.m_position;
+				it->m_normal = it->m_position;
 			}
 		}
 	}
@@ -726,20 +1718,24 @@ int main(int _argc, const char* _argv[])
 	}
 	decl.end();
 
+	const uint32_t numTriangles = uint32_t(mesh.m_indices.size()/3);
+
 	uint32_t stride = decl.getStride();
-	uint8_t* vertexData = new uint8_t[triangles.size() * 3 * stride];
-	uint16_t* indexData = new uint16_t[triangles.size() * 3];
-	int32_t numVertices = 0;
-	int32_t numIndices = 0;
-	int32_t numPrimitives = 0;
+	uint8_t* vertexData = new uint8_t[numTriangles * 3 * stride];
+	uint32_t* indexData = new uint32_t[numTriangles * 3];
+	uint32_t numVertices = 0;
+	uint32_t numIndices = 0;
 
 	uint8_t* vertices = vertexData;
-	uint16_t* indices = indexData;
+	uint32_t* indices = indexData;
 
 	std::string material = groups.begin()->m_material;
 
 	PrimitiveArray primitives;
 
+	WriteStats stats;
+	memset(&stats, 0, sizeof(stats) );
+
 	bx::CrtFileWriter writer;
 	if (0 != writer.open(outFilePath) )
 	{
@@ -747,68 +1743,44 @@ int main(int _argc, const char* _argv[])
 		exit(EXIT_FAILURE);
 	}
 
-	Primitive prim;
-	prim.m_startVertex = 0;
-	prim.m_startIndex = 0;
-
 	uint32_t positionOffset = decl.getOffset(bgfx::Attrib::Position);
 	uint32_t color0Offset = decl.getOffset(bgfx::Attrib::Color0);
 
+	// Unique vertex to batch vertex index, reset for every batch.
+	std::vector<int32_t> vertexIndex(uniqueVertices.size(), -1);
+
 	uint32_t ii = 0;
 	for (GroupArray::const_iterator groupIt = groups.begin(); groupIt != groups.end(); ++groupIt, ++ii)
 	{
-		for (uint32_t tri = groupIt->m_startTriangle, end = tri + groupIt->m_numTriangles; tri < end; ++tri)
+		if (material != groupIt->m_material)
 		{
-			if (material != groupIt->m_material
-			||  65533 < numVertices)
-			{
-				prim.m_numVertices = numVertices - prim.m_startVertex;
-				prim.m_numIndices = numIndices - prim.m_startIndex;
-				if (0 < prim.m_numVertices)
-				{
-					primitives.push_back(prim);
-				}
-
-				triReorderElapsed -= bx::getHPCounter();
-				for (PrimitiveArray::const_iterator primIt = primitives.begin(); primIt != primitives.end(); ++primIt)
-				{
-					const Primitive& prim = *primIt;
-					triangleReorder(indexData + prim.m_startIndex, prim.m_numIndices, numVertices, 32);
-				}
-				triReorderElapsed += bx::getHPCounter();
+			writeBatch(&writer, vertexData, numVertices, decl, indexData, numIndices, material, primitives, indexMode, hasTangent, stats);
+			primitives.clear();
 
-				if (hasTangent)
-				{
-					calcTangents(vertexData, numVertices, decl, indexData, numIndices);
-				}
+			std::fill(vertexIndex.begin(), vertexIndex.end(), -1);
 
-				write(&writer, vertexData, numVertices, decl, indexData, numIndices, material, primitives);
-				primitives.clear();
-
-				for (Index3Map::iterator indexIt = indexMap.begin(); indexIt != indexMap.end(); ++indexIt)
-				{
-					indexIt->second.m_vertexIndex = -1;
-				}
+			vertices = vertexData;
+			indices = indexData;
+			numVertices = 0;
+			numIndices = 0;
 
-				vertices = vertexData;
-				indices = indexData;
-				numVertices = 0;
-				numIndices = 0;
-				prim.m_startVertex = 0;
-				prim.m_startIndex = 0;
-				++numPrimitives;
+			material = groupIt->m_material;
+		}
 
-				material = groupIt->m_material;
-			}
+		Primitive prim;
+		prim.m_startVertex = numVertices;
+		prim.m_startIndex = numIndices;
+		prim.m_name = groupIt->m_name;
 
-			Triangle& triangle = triangles[tri];
+		for (uint32_t tri = groupIt->m_startTriangle, end = tri + groupIt->m_numTriangles; tri < end; ++tri)
+		{
 			for (uint32_t edge = 0; edge < 3; ++edge)
 			{
-				uint64_t hash = triangle.m_index[edge];
-				Index3& index = indexMap[hash];
-				if (index.m_vertexIndex == -1)
+				const uint32_t id = mesh.m_indices[tri*3 + edge];
+				const Index3& index = uniqueVertices[id];
+				if (vertexIndex[id] == -1)
 				{
-		 			index.m_vertexIndex = numVertices++;
+					vertexIndex[id] = numVertices++;
 
 					float* position = (float*)(vertices + positionOffset);
 					memcpy(position, &positions[index.m_position], 3*sizeof(float) );
@@ -821,8 +1793,11 @@ int main(int _argc, const char* _argv[])
 
 					if (hasTexcoord)
 					{
-						float uv[2];
-						memcpy(uv, &texcoords[index.m_texcoord], 2*sizeof(float) );
+						float uv[2] = { 0.0f, 0.0f };
+						if (-1 != index.m_texcoord)
+						{
+							memcpy(uv, &texcoords[index.m_texcoord], 2*sizeof(float) );
+						}
 
 						if (flipV)
 						{
@@ -834,27 +1809,27 @@ int main(int _argc, const char* _argv[])
 
 					if (hasNormal)
 					{
-						float normal[4];
-						vec3Norm(normal, (float*)&normals[index.m_normal]);
+						float normal[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+						if (-1 != index.m_normal)
+						{
+							vec3Norm(normal, (float*)&normals[index.m_normal]);
+						}
 						bgfx::vertexPack(normal, true, bgfx::Attrib::Normal, decl, vertices);
 					}
 
 					vertices += stride;
 				}
 
-				*indices++ = (uint16_t)index.m_vertexIndex;
+				*indices++ = (uint32_t)vertexIndex[id];
 				++numIndices;
 			}
 		}
 
-		if (0 < numVertices)
+		prim.m_numVertices = numVertices - prim.m_startVertex;
+		prim.m_numIndices = numIndices - prim.m_startIndex;
+		if (0 < prim.m_numIndices)
 		{
-			prim.m_numVertices = numVertices - prim.m_startVertex;
-			prim.m_numIndices = numIndices - prim.m_startIndex;
-			prim.m_name = groupIt->m_name;
 			primitives.push_back(prim);
-			prim.m_startVertex = numVertices;
-			prim.m_startIndex = numIndices;
 		}
 
 		BX_TRACE("%3d: s %5d, n %5d, %s\n"
@@ -867,20 +1842,7 @@ int main(int _argc, const char* _argv[])
 
 	if (0 < primitives.size() )
 	{
-		triReorderElapsed -= bx::getHPCounter();
-		for (PrimitiveArray::const_iterator primIt = primitives.begin(); primIt != primitives.end(); ++primIt)
-		{
-			const Primitive& prim = *primIt;
-			triangleReorder(indexData + prim.m_startIndex, prim.m_numIndices, numVertices, 32);
-		}
-		triReorderElapsed += bx::getHPCounter();
-
-		if (hasTangent)
-		{
-			calcTangents(vertexData, numVertices, decl, indexData, numIndices);
-		}
-
-		write(&writer, vertexData, numVertices, decl, indexData, numIndices, material, primitives);
+		writeBatch(&writer, vertexData, numVertices, decl, indexData, numIndices, material, primitives, indexMode, hasTangent, stats);
 	}
 
 	printf("size: %d\n", uint32_t(writer.seek() ) );
@@ -892,16 +1854,65 @@ int main(int _argc, const char* _argv[])
 	now = bx::getHPCounter();
 	convertElapsed += now;
 
-	printf("parse %f [s]\ntri reorder %f [s]\nconvert %f [s]\n# %d, g %d, p %d, v %d, i %d\n"
+	const double parseSeconds = double(parseElapsed)/bx::getHPFrequency();
+	printf("parse %0.1f MiB, %d threads: read %f [s], parse %f [s], merge %f [s], dedup %f [s] (%0.1f MB/s)\n"
+		, double(parseStats.m_numBytes)/(1024.0*1024.0)
+		, numThreads
+		, double(parseStats.m_readElapsed)/bx::getHPFrequency()
+		, double(parseStats.m_parseElapsed)/bx::getHPFrequency()
+		, double(parseStats.m_mergeElapsed)/bx::getHPFrequency()
+		, double(parseStats.m_dedupElapsed)/bx::getHPFrequency()
+		, parseSeconds > 0.0 ? double(parseStats.m_numBytes)/parseSeconds/1.0e6 : 0.0
+		);
+
+	printf("parse %f [s]\ntri reorder %f [s]\nlod %f [s]\nconvert %f [s]\n# %d, g %d, p %d, v %d, i %d\n"
 		, double(parseElapsed)/bx::getHPFrequency()
-		, double(triReorderElapsed)/bx::getHPFrequency()
+		, double(stats.m_triReorderElapsed)/bx::getHPFrequency()
+		, double(stats.m_lodElapsed)/bx::getHPFrequency()
 		, double(convertElapsed)/bx::getHPFrequency()
 		, num
 		, uint32_t(groups.size() )
-		, numPrimitives
-		, numVertices
-		, numIndices
+		, stats.m_numChunks
+		, stats.m_numVertices
+		, stats.m_numIndices
+		);
+
+	const VertexCacheStats& cb = stats.m_cacheBefore;
+	const VertexCacheStats& ca = stats.m_cacheAfter;
+	printf("vertex cache (fifo %d): acmr %0.3f -> %0.3f, atvr %0.3f -> %0.3f\n"
+		, s_cacheSize
+		, double(cb.m_numMisses)/double(bx::uint32_max(cb.m_numTriangles, 1) )
+		, double(ca.m_numMisses)/double(bx::uint32_max(ca.m_numTriangles, 1) )
+		, double(cb.m_numMisses)/double(bx::uint32_max(cb.m_numVertices, 1) )
+		, double(ca.m_numMisses)/double(bx::uint32_max(ca.m_numVertices, 1) )
+		);
+
+	const VertexFetchStats& fb = stats.m_fetchBefore;
+	const VertexFetchStats& fa = stats.m_fetchAfter;
+	printf("vertex fetch: overfetch %0.3f -> %0.3f (%0.1f -> %0.1f KiB)\n"
+		, double(fb.m_bytesFetched)/double(fb.m_bytesUnique > 0 ? fb.m_bytesUnique : 1)
+		, double(fa.m_bytesFetched)/double(fa.m_bytesUnique > 0 ? fa.m_bytesUnique : 1)
+		, double(fb.m_bytesFetched)/1024.0
+		, double(fa.m_bytesFetched)/1024.0
 		);
 
+	if (s_meshlets)
+	{
+		printf("meshlets: %d\n", stats.m_numMeshlets);
+	}
+
+	if (s_compress)
+	{
+		printf("compress %f [s]: vertices %0.1f -> %0.1f KiB (%0.2fx), indices %0.1f -> %0.1f KiB (%0.2fx)\n"
+			, double(stats.m_encodeElapsed)/bx::getHPFrequency()
+			, double(stats.m_vertexBytes)/1024.0
+			, double(stats.m_vertexEncodedBytes)/1024.0
+			, double(stats.m_vertexBytes)/double(stats.m_vertexEncodedBytes > 0 ? stats.m_vertexEncodedBytes : 1)
+			, double(stats.m_indexBytes)/1024.0
+			, double(stats.m_indexEncodedBytes)/1024.0
+			, double(stats.m_indexBytes)/double(stats.m_indexEncodedBytes > 0 ? stats.m_indexEncodedBytes : 1)
+			);
+	}
+
 	return EXIT_SUCCESS;
 }
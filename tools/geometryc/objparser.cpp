@@ -0,0 +1,701 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <bx/bx.h>
+#include <bx/timer.h>
+#include <bx/uint32_t.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <bgfx.h>
+
+#include "objparser.h"
+
+// https://en.wikipedia.org/wiki/Wavefront_.obj_file
+
+struct ObjEventType
+{
+	enum Enum
+	{
+		Vertex,
+		Group,
+		Material,
+	};
+};
+
+/// Group and material changes are recorded together with number of
+/// triangles parsed before them, and replayed in file order during merge.
+struct ObjEvent
+{
+	uint32_t m_triangle;
+	ObjEventType::Enum m_type;
+	std::string m_name;
+};
+
+typedef std::vector<ObjEvent> ObjEventArray;
+
+struct ObjChunk
+{
+	const char* m_begin;
+	const char* m_end;
+	Vector3Array m_positions;
+	Vector3Array m_normals;
+	Vector3Array m_texcoords;
+	Index3Array m_corners;
+	ObjEventArray m_events;
+	uint32_t m_numLines;
+	bool m_paramSpace;
+};
+
+struct ObjParseContext
+{
+	ObjChunk* m_chunks;
+	float m_scale;
+	bool m_ccw;
+};
+
+static inline bool isSpace(char _ch)
+{
+	return ' ' == _ch || '\t' == _ch || '\r' == _ch;
+}
+
+static inline bool isDigit(char _ch)
+{
+	return uint32_t(_ch - '0') < 10;
+}
+
+static inline const char* skipSpace(const char* _str, const char* _end)
+{
+	while (_str < _end && isSpace(*_str) )
+	{
+		++_str;
+	}
+
+	return _str;
+}
+
+static inline const char* skipLine(const char* _str, const char* _end)
+{
+	const char* eol = (const char*)memchr(_str, '\n', _end - _str);
+	return NULL == eol ? _end : eol + 1;
+}
+
+/// Returns true if there is another number on the line.
+static inline bool hasNumber(const char* _str, const char* _end)
+{
+	_str = skipSpace(_str, _end);
+	return _str < _end
+		&& (isDigit(*_str) || '-' == *_str || '+' == *_str || '.' == *_str)
+		;
+}
+
+static const char* parseInt(const char* _str, const char* _end, int32_t& _value)
+{
+	bool neg = false;
+	if (_str < _end
+	&&  ('-' == *_str || '+' == *_str) )
+	{
+		neg = '-' == *_str;
+		++_str;
+	}
+
+	int32_t value = 0;
+	for (; _str < _end && isDigit(*_str); ++_str)
+	{
+		value = value*10 + (*_str - '0');
+	}
+
+	_value = neg ? -value : value;
+	return _str;
+}
+
+/// Parse float without going through locale aware atof. Up to 15
+/// significant digits are accumulated as integer, which is exact in
+/// double, and scaled by power of 10 once.
+static const char* parseFloat(const char* _str, const char* _end, float& _value)
+{
+	static const double s_pow10[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	const char* str = skipSpace(_str, _end);
+
+	bool neg = false;
+	if (str < _end
+	&&  ('-' == *str || '+' == *str) )
+	{
+		neg = '-' == *str;
+		++str;
+	}
+
+	const uint64_t maxMantissa = UINT64_C(100000000000000);
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+
+	for (; str < _end && isDigit(*str); ++str)
+	{
+		if (mantissa < maxMantissa)
+		{
+			mantissa = mantissa*10 + (*str - '0');
+		}
+		else
+		{
+			++exponent;
+		}
+	}
+
+	if (str < _end
+	&&  '.' == *str)
+	{
+		for (++str; str < _end && isDigit(*str); ++str)
+		{
+			if (mantissa < maxMantissa)
+			{
+				mantissa = mantissa*10 + (*str - '0');
+				--exponent;
+			}
+		}
+	}
+
+	if (str < _end
+	&&  ('e' == *str || 'E' == *str) )
+	{
+		int32_t exp;
+		str = parseInt(str + 1, _end, exp);
+		exponent += exp;
+	}
+
+	double value = double(mantissa);
+	if (0 > exponent)
+	{
+		value = -22 <= exponent ? value / s_pow10[-exponent] : value * pow(10.0, exponent);
+	}
+	else if (0 < exponent)
+	{
+		value = 22 >= exponent ? value * s_pow10[exponent] : value * pow(10.0, exponent);
+	}
+
+	_value = float(neg ? -value : value);
+	return str;
+}
+
+static const char* parseName(const char* _str, const char* _end, std::string& _name)
+{
+	const char* str = skipSpace(_str, _end);
+	const char* begin = str;
+	while (str < _end && !isSpace(*str) && '\n' != *str)
+	{
+		++str;
+	}
+
+	_name.assign(begin, str);
+	return str;
+}
+
+static const char* parseFace(const char* _str, const char* _end, bool _ccw, Index3Array& _corners)
+{
+	Index3 triangle[3];
+
+	const char* str = _str;
+	for (uint32_t edge = 0; hasNumber(str, _end); ++edge)
+	{
+		Index3 index;
+		index.m_texcoord = -1;
+		index.m_normal = -1;
+
+		int32_t value;
+		str = parseInt(skipSpace(str, _end), _end, value);
+		index.m_position = value - 1;
+
+		if (str < _end
+		&&  '/' == *str)
+		{
+			++str;
+			if (str < _end
+			&&  '/' != *str)
+			{
+				str = parseInt(str, _end, value);
+				index.m_texcoord = value - 1;
+			}
+
+			if (str < _end
+			&&  '/' == *str)
+			{
+				str = parseInt(str + 1, _end, value);
+				index.m_normal = value - 1;
+			}
+		}
+
+		while (str < _end && !isSpace(*str) && '\n' != *str)
+		{
+			++str;
+		}
+
+		switch (edge)
+		{
+		case 0:
+		case 1:
+		case 2:
+			triangle[edge] = index;
+			if (2 == edge)
+			{
+				if (_ccw)
+				{
+					std::swap(triangle[1], triangle[2]);
+				}
+				_corners.insert(_corners.end(), triangle, triangle+3);
+			}
+			break;
+
+		default:
+			if (_ccw)
+			{
+				triangle[2] = triangle[1];
+				triangle[1] = index;
+			}
+			else
+			{
+				triangle[1] = triangle[2];
+				triangle[2] = index;
+			}
+			_corners.insert(_corners.end(), triangle, triangle+3);
+			break;
+		}
+	}
+
+	return str;
+}
+
+static void parseChunk(uint32_t _index, void* _userData)
+{
+	ObjParseContext& context = *(ObjParseContext*)_userData;
+	ObjChunk& chunk = context.m_chunks[_index];
+
+	const char* str = chunk.m_begin;
+	const char* end = chunk.m_end;
+
+	while (str < end)
+	{
+		const char* line = skipSpace(str, end);
+		const char next = line + 1 < end ? line[1] : '\n';
+		++chunk.m_numLines;
+
+		switch (line < end ? *line : '\n')
+		{
+		case 'v':
+			{
+				// Vertex data after faces starts new group.
+				const uint32_t numTriangles = uint32_t(chunk.m_corners.size()/3);
+				if (chunk.m_events.empty()
+				||  ObjEventType::Vertex != chunk.m_events.back().m_type
+				||  numTriangles != chunk.m_events.back().m_triangle)
+				{
+					ObjEvent event;
+					event.m_triangle = numTriangles;
+					event.m_type = ObjEventType::Vertex;
+					chunk.m_events.push_back(event);
+				}
+
+				if ('n' == next)
+				{
+					Vector3 normal;
+					const char* ptr = parseFloat(line + 2, end, normal.x);
+					ptr = parseFloat(ptr, end, normal.y);
+					parseFloat(ptr, end, normal.z);
+					chunk.m_normals.push_back(normal);
+				}
+				else if ('t' == next)
+				{
+					Vector3 texcoord;
+					texcoord.y = 0.0f;
+					texcoord.z = 0.0f;
+					const char* ptr = parseFloat(line + 2, end, texcoord.x);
+					if (hasNumber(ptr, end) )
+					{
+						ptr = parseFloat(ptr, end, texcoord.y);
+						if (hasNumber(ptr, end) )
+						{
+							parseFloat(ptr, end, texcoord.z);
+						}
+					}
+					chunk.m_texcoords.push_back(texcoord);
+				}
+				else if ('p' == next)
+				{
+					chunk.m_paramSpace = true;
+				}
+				else
+				{
+					Vector3 pos;
+					const char* ptr = parseFloat(line + 1, end, pos.x);
+					ptr = parseFloat(ptr, end, pos.y);
+					ptr = parseFloat(ptr, end, pos.z);
+
+					float pw = 1.0f;
+					if (hasNumber(ptr, end) )
+					{
+						parseFloat(ptr, end, pw);
+					}
+
+					const float invW = context.m_scale/pw;
+					pos.x *= invW;
+					pos.y *= invW;
+					pos.z *= invW;
+					chunk.m_positions.push_back(pos);
+				}
+			}
+			break;
+
+		case 'f':
+			if (isSpace(next) )
+			{
+				parseFace(line + 1, end, context.m_ccw, chunk.m_corners);
+			}
+			break;
+
+		case 'g':
+			if (isSpace(next) )
+			{
+				ObjEvent event;
+				event.m_triangle = uint32_t(chunk.m_corners.size()/3);
+				event.m_type = ObjEventType::Group;
+				parseName(line + 1, end, event.m_name);
+				chunk.m_events.push_back(event);
+			}
+			break;
+
+		case 'u':
+			if (line + 7 <= end
+			&&  0 == strncmp(line, "usemtl", 6)
+			&&  isSpace(line[6]) )
+			{
+				ObjEvent event;
+				event.m_triangle = uint32_t(chunk.m_corners.size()/3);
+				event.m_type = ObjEventType::Material;
+				parseName(line + 6, end, event.m_name);
+				chunk.m_events.push_back(event);
+			}
+			break;
+
+		// unsupported tags: #, mtllib, o, s
+
+		default:
+			break;
+		}
+
+		str = skipLine(line, end);
+	}
+}
+
+struct DedupPartition
+{
+	Index3Array m_vertices;
+	uint32_t m_base;
+};
+
+struct DedupContext
+{
+	const Index3* m_corners;
+	uint32_t* m_hashes;
+	uint32_t* m_ids;
+	DedupPartition* m_partitions;
+	uint32_t m_numCorners;
+	uint32_t m_numPartitions;
+};
+
+#define DEDUP_RANGE_SIZE (64<<10)
+
+static inline uint32_t hashIndex3(const Index3& _index)
+{
+	uint32_t hash = uint32_t(_index.m_position)*0x9e3779b1u;
+	hash ^= uint32_t(_index.m_texcoord)*0x85ebca6bu;
+	hash ^= uint32_t(_index.m_normal)*0xc2b2ae35u;
+	return hash ^ (hash >> 15);
+}
+
+static inline uint32_t hashPartition(uint32_t _hash, uint32_t _numPartitions)
+{
+	return uint32_t( (uint64_t(_hash) * _numPartitions) >> 32);
+}
+
+static void dedupHash(uint32_t _index, void* _userData)
+{
+	DedupContext& context = *(DedupContext*)_userData;
+	const uint32_t begin = _index*DEDUP_RANGE_SIZE;
+	const uint32_t end = bx::uint32_min(begin + DEDUP_RANGE_SIZE, context.m_numCorners);
+
+	for (uint32_t ii = begin; ii < end; ++ii)
+	{
+		context.m_hashes[ii] = hashIndex3(context.m_corners[ii]);
+	}
+}
+
+/// Every partition owns subset of hash values, so partitions can be built
+/// independently. Corners are visited in order, which makes vertex order
+/// within partition deterministic.
+static void dedupPartition(uint32_t _index, void* _userData)
+{
+	DedupContext& context = *(DedupContext*)_userData;
+	DedupPartition& partition = context.m_partitions[_index];
+
+	uint32_t count = 0;
+	for (uint32_t ii = 0; ii < context.m_numCorners; ++ii)
+	{
+		count += _index == hashPartition(context.m_hashes[ii], context.m_numPartitions);
+	}
+
+	uint32_t size = 16;
+	while (size < count*2)
+	{
+		size *= 2;
+	}
+
+	const uint32_t mask = size - 1;
+	std::vector<uint32_t> table(size, UINT32_MAX);
+
+	for (uint32_t ii = 0; ii < context.m_numCorners; ++ii)
+	{
+		const uint32_t hash = context.m_hashes[ii];
+		if (_index != hashPartition(hash, context.m_numPartitions) )
+		{
+			continue;
+		}
+
+		const Index3& corner = context.m_corners[ii];
+
+		uint32_t slot = hash & mask;
+		for (;;)
+		{
+			const uint32_t id = table[slot];
+			if (UINT32_MAX == id)
+			{
+				table[slot] = uint32_t(partition.m_vertices.size() );
+				context.m_ids[ii] = table[slot];
+				partition.m_vertices.push_back(corner);
+				break;
+			}
+
+			const Index3& vertex = partition.m_vertices[id];
+			if (vertex.m_position == corner.m_position
+			&&  vertex.m_texcoord == corner.m_texcoord
+			&&  vertex.m_normal   == corner.m_normal)
+			{
+				context.m_ids[ii] = id;
+				break;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+	}
+}
+
+static void dedupRemap(uint32_t _index, void* _userData)
+{
+	DedupContext& context = *(DedupContext*)_userData;
+	const uint32_t begin = _index*DEDUP_RANGE_SIZE;
+	const uint32_t end = bx::uint32_min(begin + DEDUP_RANGE_SIZE, context.m_numCorners);
+
+	for (uint32_t ii = begin; ii < end; ++ii)
+	{
+		const uint32_t partition = hashPartition(context.m_hashes[ii], context.m_numPartitions);
+		context.m_ids[ii] += context.m_partitions[partition].m_base;
+	}
+}
+
+static void dedup(ObjMesh& _mesh, const Index3Array& _corners, uint32_t _numThreads)
+{
+	const uint32_t numCorners = uint32_t(_corners.size() );
+	const uint32_t numRanges = (numCorners + DEDUP_RANGE_SIZE - 1) / DEDUP_RANGE_SIZE;
+
+	std::vector<uint32_t> hashes(numCorners);
+	_mesh.m_indices.resize(numCorners);
+
+	std::vector<DedupPartition> partitions(_numThreads);
+
+	DedupContext context;
+	context.m_corners = numCorners > 0 ? &_corners[0] : NULL;
+	context.m_hashes = numCorners > 0 ? &hashes[0] : NULL;
+	context.m_ids = numCorners > 0 ? &_mesh.m_indices[0] : NULL;
+	context.m_partitions = &partitions[0];
+	context.m_numCorners = numCorners;
+	context.m_numPartitions = _numThreads;
+
+	bgfx::parallelFor(numRanges, dedupHash, &context, _numThreads);
+	bgfx::parallelFor(_numThreads, dedupPartition, &context, _numThreads);
+
+	uint32_t numVertices = 0;
+	for (uint32_t ii = 0; ii < _numThreads; ++ii)
+	{
+		partitions[ii].m_base = numVertices;
+		numVertices += uint32_t(partitions[ii].m_vertices.size() );
+	}
+
+	bgfx::parallelFor(numRanges, dedupRemap, &context, _numThreads);
+
+	_mesh.m_vertices.clear();
+	_mesh.m_vertices.reserve(numVertices);
+	for (uint32_t ii = 0; ii < _numThreads; ++ii)
+	{
+		const Index3Array& vertices = partitions[ii].m_vertices;
+		_mesh.m_vertices.insert(_mesh.m_vertices.end(), vertices.begin(), vertices.end() );
+	}
+}
+
+static void pushGroup(GroupArray& _groups, Group& _group, uint32_t _numTriangles)
+{
+	_group.m_numTriangles = _numTriangles - _group.m_startTriangle;
+	if (0 < _group.m_numTriangles)
+	{
+		_groups.push_back(_group);
+		_group.m_startTriangle = _numTriangles;
+		_group.m_numTriangles = 0;
+	}
+}
+
+bool objParse(ObjMesh& _mesh, ObjParseStats& _stats, const char* _filePath, float _scale, bool _ccw, uint32_t _numThreads, uint32_t _blockSize)
+{
+	FILE* file = fopen(_filePath, "rb");
+	if (NULL == file)
+	{
+		return false;
+	}
+
+	const uint32_t numThreads = bx::uint32_max(_numThreads, 1);
+	const uint32_t numChunks = numThreads*4;
+
+	uint32_t blockSize = bx::uint32_max(_blockSize, 4<<10);
+	char* block = (char*)malloc(blockSize);
+	uint32_t size = 0;
+
+	Index3Array corners;
+
+	Group group;
+	group.m_startTriangle = 0;
+	group.m_numTriangles = 0;
+
+	_mesh.m_numLines = 0;
+	bool paramSpace = false;
+
+	for (bool eof = false; !eof;)
+	{
+		_stats.m_readElapsed -= bx::getHPCounter();
+		const uint32_t numRead = uint32_t(fread(&block[size], 1, blockSize - size, file) );
+		_stats.m_readElapsed += bx::getHPCounter();
+
+		size += numRead;
+		eof = size < blockSize;
+		_stats.m_numBytes += numRead;
+
+		// Parse up to the last complete line, the rest is carried over to
+		// the next block.
+		uint32_t parseSize = size;
+		if (!eof)
+		{
+			while (0 < parseSize && '\n' != block[parseSize-1])
+			{
+				--parseSize;
+			}
+
+			if (0 == parseSize)
+			{
+				// Line doesn't fit into block.
+				blockSize *= 2;
+				block = (char*)realloc(block, blockSize);
+				continue;
+			}
+		}
+
+		_stats.m_parseElapsed -= bx::getHPCounter();
+
+		std::vector<ObjChunk> chunks(numChunks);
+		const char* begin = block;
+		const char* end = block + parseSize;
+		for (uint32_t ii = 0; ii < numChunks; ++ii)
+		{
+			ObjChunk& chunk = chunks[ii];
+			const char* split = begin + (end - begin) / (numChunks - ii);
+			chunk.m_begin = begin;
+			chunk.m_end = begin == split ? split : skipLine(split - 1, end);
+			chunk.m_numLines = 0;
+			chunk.m_paramSpace = false;
+			begin = chunk.m_end;
+		}
+
+		ObjParseContext context;
+		context.m_chunks = &chunks[0];
+		context.m_scale = _scale;
+		context.m_ccw = _ccw;
+		bgfx::parallelFor(numChunks, parseChunk, &context, numThreads);
+
+		int64_t now = bx::getHPCounter();
+		_stats.m_parseElapsed += now;
+		_stats.m_mergeElapsed -= now;
+
+		for (uint32_t ii = 0; ii < numChunks; ++ii)
+		{
+			ObjChunk& chunk = chunks[ii];
+			const uint32_t base = uint32_t(corners.size()/3);
+
+			for (ObjEventArray::const_iterator it = chunk.m_events.begin(), itEnd = chunk.m_events.end(); it != itEnd; ++it)
+			{
+				const ObjEvent& event = *it;
+				switch (event.m_type)
+				{
+				case ObjEventType::Vertex:
+					pushGroup(_mesh.m_groups, group, base + event.m_triangle);
+					break;
+
+				case ObjEventType::Group:
+					group.m_name = event.m_name;
+					break;
+
+				case ObjEventType::Material:
+					if (event.m_name != group.m_material)
+					{
+						pushGroup(_mesh.m_groups, group, base + event.m_triangle);
+					}
+					group.m_material = event.m_name;
+					break;
+				}
+			}
+
+			_mesh.m_positions.insert(_mesh.m_positions.end(), chunk.m_positions.begin(), chunk.m_positions.end() );
+			_mesh.m_normals.insert(_mesh.m_normals.end(), chunk.m_normals.begin(), chunk.m_normals.end() );
+			_mesh.m_texcoords.insert(_mesh.m_texcoords.end(), chunk.m_texcoords.begin(), chunk.m_texcoords.end() );
+			corners.insert(corners.end(), chunk.m_corners.begin(), chunk.m_corners.end() );
+
+			_mesh.m_numLines += chunk.m_numLines;
+			paramSpace |= chunk.m_paramSpace;
+		}
+
+		_stats.m_mergeElapsed += bx::getHPCounter();
+
+		size -= parseSize;
+		memmove(block, &block[parseSize], size);
+	}
+
+	free(block);
+	fclose(file);
+
+	pushGroup(_mesh.m_groups, group, uint32_t(corners.size()/3) );
+
+	if (paramSpace)
+	{
+		printf("warning: 'parameter space vertices' are unsupported.\n");
+	}
+
+	_stats.m_dedupElapsed -= bx::getHPCounter();
+	dedup(_mesh, corners, numThreads);
+	_stats.m_dedupElapsed += bx::getHPCounter();
+
+	return true;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef OBJPARSER_H_HEADER_GUARD
+#define OBJPARSER_H_HEADER_GUARD
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct Vector3
+{
+	float x;
+	float y;
+	float z;
+};
+
+typedef std::vector<Vector3> Vector3Array;
+
+/// Unique combination of OBJ position, texcoord and normal index. Missing
+/// texcoord or normal is -1.
+struct Index3
+{
+	int32_t m_position;
+	int32_t m_texcoord;
+	int32_t m_normal;
+};
+
+typedef std::vector<Index3> Index3Array;
+
+struct Group
+{
+	uint32_t m_startTriangle;
+	uint32_t m_numTriangles;
+	std::string m_name;
+	std::string m_material;
+};
+
+typedef std::vector<Group> GroupArray;
+
+struct ObjMesh
+{
+	Vector3Array m_positions;
+	Vector3Array m_normals;
+	Vector3Array m_texcoords;
+	Index3Array m_vertices;        //!< Unique vertices.
+	std::vector<uint32_t> m_indices; //!< Three indices into m_vertices per triangle.
+	GroupArray m_groups;
+	uint32_t m_numLines;
+};
+
+struct ObjParseStats
+{
+	uint64_t m_numBytes;
+	int64_t m_readElapsed;
+	int64_t m_parseElapsed;
+	int64_t m_mergeElapsed;
+	int64_t m_dedupElapsed;
+};
+
+/// Parse Wavefront OBJ file.
+///
+/// File is read in blocks of _blockSize bytes, cut at line boundary. Every
+/// block is split into line aligned chunks that are parsed in parallel,
+/// and merged in file order, so result doesn't depend on number of
+/// threads. Only one block of text is resident at a time. After parsing,
+/// position/texcoord/normal triples are deduplicated in parallel.
+///
+/// @param _scale Position scale.
+/// @param _ccw Counter-clockwise winding order.
+/// @returns False if file can't be opened.
+///
+bool objParse(ObjMesh& _mesh, ObjParseStats& _stats, const char* _filePath, float _scale, bool _ccw, uint32_t _numThreads, uint32_t _blockSize);
+
+#endif // OBJPARSER_H_HEADER_GUARD
@@ -0,0 +1,386 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <algorithm>
+
+#include "optimize.h"
+#include "math.h"
+
+static const float* getPosition(const void* _vertices, uint32_t _stride, uint32_t _index)
+{
+	return (const float*)( (const uint8_t*)_vertices + _index*_stride);
+}
+
+/// FIFO cache simulated with timestamps. Entry is in cache while less than
+/// cache size misses happened after it was inserted.
+class FifoCache
+{
+public:
+	FifoCache(uint32_t _num, uint32_t _cacheSize)
+		: m_timestamp(_num, 0)
+		, m_time(_cacheSize+1)
+		, m_cacheSize(_cacheSize)
+	{
+	}
+
+	bool touch(uint32_t _index)
+	{
+		if (m_time - m_timestamp[_index] > m_cacheSize)
+		{
+			m_timestamp[_index] = m_time++;
+			return false;
+		}
+
+		return true;
+	}
+
+	void flush()
+	{
+		m_time += m_cacheSize+1;
+	}
+
+private:
+	std::vector<uint32_t> m_timestamp;
+	uint32_t m_time;
+	uint32_t m_cacheSize;
+};
+
+void analyzeVertexCache(VertexCacheStats& _stats, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize)
+{
+	FifoCache cache(_numVertices, _cacheSize);
+	std::vector<uint8_t> used(_numVertices, 0);
+
+	for (uint32_t ii = 0; ii < _numIndices; ++ii)
+	{
+		const uint32_t index = _indices[ii];
+		_stats.m_numMisses += !cache.touch(index);
+		_stats.m_numVertices += 0 == used[index];
+		used[index] = 1;
+	}
+
+	_stats.m_numTriangles += _numIndices/3;
+}
+
+void analyzeVertexFetch(VertexFetchStats& _stats, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _stride, uint32_t _cacheSize)
+{
+	const uint32_t lineSize = 64;
+	const uint32_t numLines = (_numVertices*_stride + lineSize - 1)/lineSize;
+
+	// 8KB of fetch cache.
+	FifoCache lineCache(numLines, 128);
+	FifoCache vertexCache(_numVertices, _cacheSize);
+	std::vector<uint8_t> used(_numVertices, 0);
+
+	for (uint32_t ii = 0; ii < _numIndices; ++ii)
+	{
+		const uint32_t index = _indices[ii];
+		if (0 == used[index])
+		{
+			used[index] = 1;
+			_stats.m_bytesUnique += _stride;
+		}
+
+		if (!vertexCache.touch(index) )
+		{
+			const uint32_t start = index*_stride;
+			const uint32_t end = start + _stride;
+			for (uint32_t line = start/lineSize; line*lineSize < end; ++line)
+			{
+				if (!lineCache.touch(line) )
+				{
+					_stats.m_bytesFetched += lineSize;
+				}
+			}
+		}
+	}
+}
+
+struct Cluster
+{
+	uint32_t m_startTriangle;
+	uint32_t m_numTriangles;
+	float m_sortKey;
+};
+
+struct ClusterSortByKey
+{
+	bool operator()(const Cluster& _lhs, const Cluster& _rhs) const
+	{
+		return _lhs.m_sortKey > _rhs.m_sortKey;
+	}
+};
+
+static uint32_t countMisses(FifoCache& _cache, const uint32_t* _triangle)
+{
+	return !_cache.touch(_triangle[0])
+		+  !_cache.touch(_triangle[1])
+		+  !_cache.touch(_triangle[2])
+		;
+}
+
+void overdrawReorder(uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _cacheSize, float _threshold)
+{
+	const uint32_t numTriangles = _numIndices/3;
+	if (2 > numTriangles)
+	{
+		return;
+	}
+
+	// Hard boundaries, triangles that miss all vertices start with cold
+	// cache, moving them around doesn't change ACMR.
+	std::vector<uint32_t> hard;
+	{
+		FifoCache cache(_numVertices, _cacheSize);
+		for (uint32_t tri = 0; tri < numTriangles; ++tri)
+		{
+			if (3 == countMisses(cache, &_indices[tri*3])
+			||  0 == tri)
+			{
+				hard.push_back(tri);
+			}
+		}
+		hard.push_back(numTriangles);
+	}
+
+	// Soft boundaries, hard cluster is cut further where cluster so far
+	// has ACMR within threshold of the whole hard cluster.
+	std::vector<Cluster> clusters;
+	{
+		FifoCache cache(_numVertices, _cacheSize);
+		for (uint32_t ii = 0, num = (uint32_t)hard.size()-1; ii < num; ++ii)
+		{
+			const uint32_t start = hard[ii];
+			const uint32_t end = hard[ii+1];
+
+			cache.flush();
+			uint32_t misses = 0;
+			for (uint32_t tri = start; tri < end; ++tri)
+			{
+				misses += countMisses(cache, &_indices[tri*3]);
+			}
+			const float limit = float(misses)/float(end-start)*_threshold;
+
+			cache.flush();
+			Cluster cluster;
+			cluster.m_startTriangle = start;
+			misses = 0;
+			for (uint32_t tri = start; tri < end; ++tri)
+			{
+				misses += countMisses(cache, &_indices[tri*3]);
+
+				const uint32_t count = tri + 1 - cluster.m_startTriangle;
+				if (tri + 1 < end
+				&&  float(misses) <= limit*float(count) )
+				{
+					cluster.m_numTriangles = count;
+					clusters.push_back(cluster);
+					cluster.m_startTriangle = tri + 1;
+					misses = 0;
+					cache.flush();
+				}
+			}
+
+			cluster.m_numTriangles = end - cluster.m_startTriangle;
+			clusters.push_back(cluster);
+		}
+	}
+
+	if (2 > clusters.size() )
+	{
+		return;
+	}
+
+	Aabb aabb;
+	calcAabb(aabb, _vertices, _numVertices, _stride);
+
+	float center[3];
+	center[0] = (aabb.m_min[0] + aabb.m_max[0]) * 0.5f;
+	center[1] = (aabb.m_min[1] + aabb.m_max[1]) * 0.5f;
+	center[2] = (aabb.m_min[2] + aabb.m_max[2]) * 0.5f;
+
+	// Clusters that face away from mesh center are likely to be in front
+	// of the rest of the mesh, they are drawn first.
+	for (std::vector<Cluster>::iterator it = clusters.begin(), itEnd = clusters.end(); it != itEnd; ++it)
+	{
+		Cluster& cluster = *it;
+
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+
+		for (uint32_t tri = cluster.m_startTriangle, end = tri + cluster.m_numTriangles; tri < end; ++tri)
+		{
+			const uint32_t* indices = &_indices[tri*3];
+			const float* p0 = getPosition(_vertices, _stride, indices[0]);
+			const float* p1 = getPosition(_vertices, _stride, indices[1]);
+			const float* p2 = getPosition(_vertices, _stride, indices[2]);
+
+			float e0[3];
+			float e1[3];
+			vec3Sub(e0, p1, p0);
+			vec3Sub(e1, p2, p0);
+
+			float cross[3];
+			vec3Cross(cross, e0, e1);
+			const float triArea = sqrtf(vec3Dot(cross, cross) );
+
+			normal[0] += cross[0];
+			normal[1] += cross[1];
+			normal[2] += cross[2];
+
+			centroid[0] += (p0[0] + p1[0] + p2[0]) * triArea;
+			centroid[1] += (p0[1] + p1[1] + p2[1]) * triArea;
+			centroid[2] += (p0[2] + p1[2] + p2[2]) * triArea;
+			area += triArea;
+		}
+
+		cluster.m_sortKey = 0.0f;
+
+		const float len = sqrtf(vec3Dot(normal, normal) );
+		if (0.0f < len
+		&&  0.0f < area)
+		{
+			float mean[3];
+			vec3Mul(mean, centroid, 1.0f/(area*3.0f) );
+
+			float dir[3];
+			vec3Sub(dir, mean, center);
+			cluster.m_sortKey = vec3Dot(dir, normal)/len;
+		}
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), ClusterSortByKey() );
+
+	std::vector<uint32_t> indices(_indices, _indices + numTriangles*3);
+	uint32_t* dst = _indices;
+	for (std::vector<Cluster>::const_iterator it = clusters.begin(), itEnd = clusters.end(); it != itEnd; ++it)
+	{
+		const Cluster& cluster = *it;
+		memcpy(dst, &indices[cluster.m_startTriangle*3], cluster.m_numTriangles*3*sizeof(uint32_t) );
+		dst += cluster.m_numTriangles*3;
+	}
+}
+
+static void finishMeshlet(Meshlet& _meshlet, const std::vector<uint32_t>& _meshletVertices, const std::vector<uint8_t>& _meshletTriangles, const void* _vertices, uint32_t _stride)
+{
+	const uint32_t* vertices = &_meshletVertices[_meshlet.m_vertexOffset];
+	const uint8_t* triangles = &_meshletTriangles[_meshlet.m_triangleOffset];
+
+	std::vector<float> positions(_meshlet.m_numVertices*3);
+	for (uint32_t ii = 0; ii < _meshlet.m_numVertices; ++ii)
+	{
+		memcpy(&positions[ii*3], getPosition(_vertices, _stride, vertices[ii]), 3*sizeof(float) );
+	}
+
+	calcMaxBoundingSphere(_meshlet.m_sphere, &positions[0], _meshlet.m_numVertices, 3*sizeof(float) );
+
+	std::vector<float> normals(_meshlet.m_numTriangles*3);
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	uint32_t numNormals = 0;
+
+	for (uint32_t ii = 0; ii < _meshlet.m_numTriangles; ++ii)
+	{
+		const float* p0 = &positions[triangles[ii*3+0]*3];
+		const float* p1 = &positions[triangles[ii*3+1]*3];
+		const float* p2 = &positions[triangles[ii*3+2]*3];
+
+		float e0[3];
+		float e1[3];
+		vec3Sub(e0, p1, p0);
+		vec3Sub(e1, p2, p0);
+
+		float cross[3];
+		vec3Cross(cross, e0, e1);
+		if (0.0f < vec3Dot(cross, cross) )
+		{
+			float* normal = &normals[numNormals*3];
+			vec3Norm(normal, cross);
+			axis[0] += normal[0];
+			axis[1] += normal[1];
+			axis[2] += normal[2];
+			++numNormals;
+		}
+	}
+
+	// Cutoff of 1.0 means cluster is never culled.
+	_meshlet.m_coneAxis[0] = 0.0f;
+	_meshlet.m_coneAxis[1] = 0.0f;
+	_meshlet.m_coneAxis[2] = 1.0f;
+	_meshlet.m_coneCutoff = 1.0f;
+
+	if (0 == numNormals
+	||  0.0f == vec3Dot(axis, axis) )
+	{
+		return;
+	}
+
+	vec3Norm(_meshlet.m_coneAxis, axis);
+
+	float minDot = 1.0f;
+	for (uint32_t ii = 0; ii < numNormals; ++ii)
+	{
+		minDot = fmin(minDot, vec3Dot(&normals[ii*3], _meshlet.m_coneAxis) );
+	}
+
+	if (0.0f < minDot)
+	{
+		_meshlet.m_coneCutoff = sqrtf(1.0f - minDot*minDot);
+	}
+}
+
+void buildMeshlets(MeshletArray& _meshlets, std::vector<uint32_t>& _meshletVertices, std::vector<uint8_t>& _meshletTriangles, const uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _maxVertices, uint32_t _maxTriangles)
+{
+	std::vector<uint32_t> local(_numVertices, UINT32_MAX);
+
+	Meshlet meshlet;
+	memset(&meshlet, 0, sizeof(Meshlet) );
+	meshlet.m_vertexOffset = (uint32_t)_meshletVertices.size();
+	meshlet.m_triangleOffset = (uint32_t)_meshletTriangles.size();
+
+	for (uint32_t ii = 0; ii < _numIndices; ii += 3)
+	{
+		const uint32_t* tri = &_indices[ii];
+		const uint32_t numNew = (UINT32_MAX == local[tri[0]])
+			+ (UINT32_MAX == local[tri[1]])
+			+ (UINT32_MAX == local[tri[2]])
+			;
+
+		if (meshlet.m_numVertices + numNew > _maxVertices
+		||  meshlet.m_numTriangles + 1u > _maxTriangles)
+		{
+			finishMeshlet(meshlet, _meshletVertices, _meshletTriangles, _vertices, _stride);
+			_meshlets.push_back(meshlet);
+
+			for (uint32_t jj = 0; jj < meshlet.m_numVertices; ++jj)
+			{
+				local[_meshletVertices[meshlet.m_vertexOffset + jj] ] = UINT32_MAX;
+			}
+
+			memset(&meshlet, 0, sizeof(Meshlet) );
+			meshlet.m_vertexOffset = (uint32_t)_meshletVertices.size();
+			meshlet.m_triangleOffset = (uint32_t)_meshletTriangles.size();
+		}
+
+		for (uint32_t jj = 0; jj < 3; ++jj)
+		{
+			uint32_t& index = local[tri[jj] ];
+			if (UINT32_MAX == index)
+			{
+				index = meshlet.m_numVertices++;
+				_meshletVertices.push_back(tri[jj]);
+			}
+
+			_meshletTriangles.push_back(uint8_t(index) );
+		}
+
+		++meshlet.m_numTriangles;
+	}
+
+	if (0 < meshlet.m_numTriangles)
+	{
+		finishMeshlet(meshlet, _meshletVertices, _meshletTriangles, _vertices, _stride);
+		_meshlets.push_back(meshlet);
+	}
+}
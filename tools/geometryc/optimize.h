@@ -0,0 +1,73 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef OPTIMIZE_H_HEADER_GUARD
+#define OPTIMIZE_H_HEADER_GUARD
+
+#include <stdint.h>
+#include <vector>
+
+#include "bounds.h"
+
+struct VertexCacheStats
+{
+	uint32_t m_numMisses;
+	uint32_t m_numTriangles;
+	uint32_t m_numVertices;
+};
+
+struct VertexFetchStats
+{
+	uint64_t m_bytesFetched;
+	uint64_t m_bytesUnique;
+};
+
+/// Meshlet, small cluster of triangles with local index buffer.
+///
+/// Cluster is backfacing for all triangles when:
+///   dot(center - eye, coneAxis) >= coneCutoff*length(center - eye) + radius
+///
+struct Meshlet
+{
+	Sphere m_sphere;
+	float m_coneAxis[3];
+	float m_coneCutoff;
+	uint32_t m_vertexOffset;
+	uint32_t m_triangleOffset;
+	uint16_t m_numVertices;
+	uint16_t m_numTriangles;
+};
+
+typedef std::vector<Meshlet> MeshletArray;
+
+/// Simulate FIFO post-transform vertex cache. Results are accumulated
+/// into _stats.
+///
+/// ACMR = misses/triangles (0.5 is ideal for regular grid).
+/// ATVR = misses/vertices (1.0 is ideal).
+///
+void analyzeVertexCache(VertexCacheStats& _stats, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _cacheSize);
+
+/// Simulate vertex fetch through 64-byte cache lines. Results are
+/// accumulated into _stats. Overfetch = fetched/unique (1.0 is ideal).
+///
+void analyzeVertexFetch(VertexFetchStats& _stats, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _stride, uint32_t _cacheSize);
+
+/// Reorder triangle clusters to reduce overdraw. Indices must already be
+/// optimized for vertex cache. Index stream is cut into clusters where
+/// cache is cold anyway, or where local ACMR is below _threshold times
+/// cluster ACMR. Clusters that face away from mesh center are moved to
+/// the front, since they are likely to occlude the rest of the mesh.
+///
+/// @param _threshold Allowed ACMR increase (1.05 is 5% worse ACMR).
+///
+void overdrawReorder(uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _cacheSize, float _threshold);
+
+/// Split triangles into meshlets with at most _maxVertices (max 256)
+/// unique vertices and _maxTriangles triangles each. Meshlets are appended.
+///
+void buildMeshlets(MeshletArray& _meshlets, std::vector<uint32_t>& _meshletVertices, std::vector<uint8_t>& _meshletTriangles, const uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _maxVertices, uint32_t _maxTriangles);
+
+#endif // OPTIMIZE_H_HEADER_GUARD
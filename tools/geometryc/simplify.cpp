@@ -0,0 +1,407 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "simplify.h"
+#include "math.h"
+
+/// Symmetric 4x4 plane quadric, accumulated with triangle area as weight.
+struct Quadric
+{
+	float m_a00, m_a11, m_a22;
+	float m_a01, m_a02, m_a12;
+	float m_b0, m_b1, m_b2;
+	float m_c;
+	float m_weight;
+};
+
+static void quadricZero(Quadric& _q)
+{
+	memset(&_q, 0, sizeof(Quadric) );
+}
+
+static void quadricAdd(Quadric& _result, const Quadric& _q)
+{
+	_result.m_a00 += _q.m_a00;
+	_result.m_a11 += _q.m_a11;
+	_result.m_a22 += _q.m_a22;
+	_result.m_a01 += _q.m_a01;
+	_result.m_a02 += _q.m_a02;
+	_result.m_a12 += _q.m_a12;
+	_result.m_b0 += _q.m_b0;
+	_result.m_b1 += _q.m_b1;
+	_result.m_b2 += _q.m_b2;
+	_result.m_c += _q.m_c;
+	_result.m_weight += _q.m_weight;
+}
+
+static void quadricFromPlane(Quadric& _q, const float* _normal, float _dist, float _weight)
+{
+	const float nx = _normal[0];
+	const float ny = _normal[1];
+	const float nz = _normal[2];
+	_q.m_a00 = nx*nx*_weight;
+	_q.m_a11 = ny*ny*_weight;
+	_q.m_a22 = nz*nz*_weight;
+	_q.m_a01 = nx*ny*_weight;
+	_q.m_a02 = nx*nz*_weight;
+	_q.m_a12 = ny*nz*_weight;
+	_q.m_b0 = nx*_dist*_weight;
+	_q.m_b1 = ny*_dist*_weight;
+	_q.m_b2 = nz*_dist*_weight;
+	_q.m_c = _dist*_dist*_weight;
+	_q.m_weight = _weight;
+}
+
+/// Returns weighted mean of squared distances to accumulated planes.
+static float quadricError(const Quadric& _q, const float* _pos)
+{
+	const float xx = _pos[0];
+	const float yy = _pos[1];
+	const float zz = _pos[2];
+
+	const float rx = _q.m_a00*xx + _q.m_a01*yy + _q.m_a02*zz + _q.m_b0;
+	const float ry = _q.m_a01*xx + _q.m_a11*yy + _q.m_a12*zz + _q.m_b1;
+	const float rz = _q.m_a02*xx + _q.m_a12*yy + _q.m_a22*zz + _q.m_b2;
+
+	const float error = rx*xx + ry*yy + rz*zz
+		+ _q.m_b0*xx + _q.m_b1*yy + _q.m_b2*zz
+		+ _q.m_c
+		;
+
+	return 0.0f < _q.m_weight ? fmax(error, 0.0f)/_q.m_weight : 0.0f;
+}
+
+struct Collapse
+{
+	uint32_t m_from;
+	uint32_t m_to;
+	float m_error;
+};
+
+struct CollapseSortByError
+{
+	bool operator()(const Collapse& _lhs, const Collapse& _rhs) const
+	{
+		return _lhs.m_error < _rhs.m_error;
+	}
+};
+
+struct PositionLess
+{
+	PositionLess(const uint8_t* _vertices, uint32_t _stride)
+		: m_vertices(_vertices)
+		, m_stride(_stride)
+	{
+	}
+
+	bool operator()(uint32_t _lhs, uint32_t _rhs) const
+	{
+		const float* lhs = (const float*)(m_vertices + _lhs*m_stride);
+		const float* rhs = (const float*)(m_vertices + _rhs*m_stride);
+		if (lhs[0] != rhs[0]) return lhs[0] < rhs[0];
+		if (lhs[1] != rhs[1]) return lhs[1] < rhs[1];
+		return lhs[2] < rhs[2];
+	}
+
+	const uint8_t* m_vertices;
+	uint32_t m_stride;
+};
+
+float simplify(std::vector<uint32_t>& _result, const uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _targetIndices, float _maxError)
+{
+	const uint8_t* vertices = (const uint8_t*)_vertices;
+	_result.assign(_indices, _indices + _numIndices);
+
+	// Vertices with the same position share one position id. Quadrics,
+	// topology and flip tests are done on position ids.
+	std::vector<uint32_t> position(_numVertices);
+	std::vector<uint32_t> numAttribs(_numVertices, 0);
+	{
+		std::vector<uint32_t> order(_numVertices);
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			order[ii] = ii;
+		}
+
+		PositionLess less(vertices, _stride);
+		std::sort(order.begin(), order.end(), less);
+
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			const uint32_t first = 0 < ii && !less(order[ii-1], order[ii]) ? position[order[ii-1] ] : order[ii];
+			position[order[ii] ] = first;
+		}
+	}
+
+	std::vector<uint8_t> used(_numVertices, 0);
+	for (uint32_t ii = 0; ii < _numIndices; ++ii)
+	{
+		used[_indices[ii] ] = 1;
+	}
+
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		numAttribs[position[ii] ] += used[ii];
+	}
+
+	// Seam vertices (more than one attribute set per position) and open
+	// border vertices are locked.
+	std::vector<uint8_t> locked(_numVertices, 0);
+	{
+		std::unordered_map<uint64_t, uint32_t> edges;
+		for (uint32_t ii = 0; ii < _numIndices; ii += 3)
+		{
+			for (uint32_t jj = 0; jj < 3; ++jj)
+			{
+				const uint64_t aa = position[_indices[ii+jj] ];
+				const uint64_t bb = position[_indices[ii+(jj+1)%3] ];
+				edges[(aa<<32)|bb]++;
+			}
+		}
+
+		for (std::unordered_map<uint64_t, uint32_t>::const_iterator it = edges.begin(), itEnd = edges.end(); it != itEnd; ++it)
+		{
+			const uint32_t aa = uint32_t(it->first>>32);
+			const uint32_t bb = uint32_t(it->first);
+			const uint64_t reverse = (uint64_t(bb)<<32)|aa;
+			if (edges.end() == edges.find(reverse) )
+			{
+				locked[aa] = 1;
+				locked[bb] = 1;
+			}
+		}
+
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			locked[ii] |= 1 < numAttribs[ii];
+		}
+	}
+
+	std::vector<Quadric> quadrics(_numVertices);
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		quadricZero(quadrics[ii]);
+	}
+
+	for (uint32_t ii = 0; ii < _numIndices; ii += 3)
+	{
+		const float* p0 = (const float*)(vertices + _indices[ii+0]*_stride);
+		const float* p1 = (const float*)(vertices + _indices[ii+1]*_stride);
+		const float* p2 = (const float*)(vertices + _indices[ii+2]*_stride);
+
+		float e0[3];
+		float e1[3];
+		vec3Sub(e0, p1, p0);
+		vec3Sub(e1, p2, p0);
+
+		float cross[3];
+		vec3Cross(cross, e0, e1);
+		const float area = sqrtf(vec3Dot(cross, cross) );
+		if (0.0f == area)
+		{
+			continue;
+		}
+
+		float normal[3];
+		vec3Mul(normal, cross, 1.0f/area);
+
+		Quadric q;
+		quadricFromPlane(q, normal, -vec3Dot(normal, p0), area);
+
+		for (uint32_t jj = 0; jj < 3; ++jj)
+		{
+			quadricAdd(quadrics[position[_indices[ii+jj] ] ], q);
+		}
+	}
+
+	const float maxError = _maxError*_maxError;
+	float result = 0.0f;
+
+	std::vector<uint32_t> remap(_numVertices);
+	std::vector<uint8_t> touched(_numVertices);
+	std::vector<uint32_t> adjacencyOffset(_numVertices+1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+
+	while (_result.size() > _targetIndices)
+	{
+		const uint32_t numIndices = (uint32_t)_result.size();
+		const uint32_t* indices = &_result[0];
+
+		// Triangles around each position.
+		std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+		for (uint32_t ii = 0; ii < numIndices; ++ii)
+		{
+			adjacencyOffset[position[indices[ii] ]+1]++;
+		}
+
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			adjacencyOffset[ii+1] += adjacencyOffset[ii];
+		}
+
+		adjacency.resize(numIndices);
+		{
+			std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end()-1);
+			for (uint32_t ii = 0; ii < numIndices; ++ii)
+			{
+				adjacency[fill[position[indices[ii] ] ]++] = ii/3;
+			}
+		}
+
+		collapses.clear();
+		for (uint32_t ii = 0; ii < numIndices; ii += 3)
+		{
+			for (uint32_t jj = 0; jj < 3; ++jj)
+			{
+				const uint32_t aa = indices[ii+jj];
+				const uint32_t bb = indices[ii+(jj+1)%3];
+				const uint32_t pa = position[aa];
+				const uint32_t pb = position[bb];
+
+				for (uint32_t kk = 0; kk < 2; ++kk)
+				{
+					const uint32_t from = 0 == kk ? aa : bb;
+					const uint32_t to   = 0 == kk ? bb : aa;
+					const uint32_t pfrom = 0 == kk ? pa : pb;
+					const uint32_t pto   = 0 == kk ? pb : pa;
+
+					if (pfrom == pto
+					||  locked[pfrom])
+					{
+						continue;
+					}
+
+					Quadric q = quadrics[pfrom];
+					quadricAdd(q, quadrics[pto]);
+
+					Collapse collapse;
+					collapse.m_from = from;
+					collapse.m_to = to;
+					collapse.m_error = quadricError(q, (const float*)(vertices + to*_stride) );
+					collapses.push_back(collapse);
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), CollapseSortByError() );
+
+		for (uint32_t ii = 0; ii < _numVertices; ++ii)
+		{
+			remap[ii] = ii;
+		}
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// Each collapse removes about two triangles.
+		const uint32_t numTriangles = numIndices/3;
+		const uint32_t targetTriangles = _targetIndices/3;
+		const uint32_t maxCollapses = (numTriangles - targetTriangles)/2 + 1;
+		uint32_t numCollapses = 0;
+
+		for (std::vector<Collapse>::const_iterator it = collapses.begin(), itEnd = collapses.end(); it != itEnd && numCollapses < maxCollapses; ++it)
+		{
+			const Collapse& collapse = *it;
+			if (collapse.m_error > maxError)
+			{
+				break;
+			}
+
+			const uint32_t pfrom = position[collapse.m_from];
+			const uint32_t pto = position[collapse.m_to];
+			if (touched[pfrom]
+			||  touched[pto])
+			{
+				continue;
+			}
+
+			// Reject collapse if any remaining triangle around source vertex
+			// flips.
+			const float* to = (const float*)(vertices + collapse.m_to*_stride);
+			bool flip = false;
+			for (uint32_t jj = adjacencyOffset[pfrom], end = adjacencyOffset[pfrom+1]; jj < end && !flip; ++jj)
+			{
+				const uint32_t* tri = &indices[adjacency[jj]*3];
+				const uint32_t p0 = position[tri[0] ];
+				const uint32_t p1 = position[tri[1] ];
+				const uint32_t p2 = position[tri[2] ];
+				if (pto == p0
+				||  pto == p1
+				||  pto == p2)
+				{
+					continue;
+				}
+
+				const float* v0 = (const float*)(vertices + tri[0]*_stride);
+				const float* v1 = (const float*)(vertices + tri[1]*_stride);
+				const float* v2 = (const float*)(vertices + tri[2]*_stride);
+				const float* n0 = pfrom == p0 ? to : v0;
+				const float* n1 = pfrom == p1 ? to : v1;
+				const float* n2 = pfrom == p2 ? to : v2;
+
+				float e0[3], e1[3], before[3], after[3];
+				vec3Sub(e0, v1, v0);
+				vec3Sub(e1, v2, v0);
+				vec3Cross(before, e0, e1);
+				vec3Sub(e0, n1, n0);
+				vec3Sub(e1, n2, n0);
+				vec3Cross(after, e0, e1);
+
+				flip = 0.0f >= vec3Dot(before, after);
+			}
+
+			if (flip)
+			{
+				continue;
+			}
+
+			remap[collapse.m_from] = collapse.m_to;
+			quadricAdd(quadrics[pto], quadrics[pfrom]);
+			result = fmax(result, collapse.m_error);
+			++numCollapses;
+
+			// Neighbors are locked for the rest of the pass, so that flip
+			// tests stay valid.
+			for (uint32_t jj = adjacencyOffset[pfrom], end = adjacencyOffset[pfrom+1]; jj < end; ++jj)
+			{
+				const uint32_t* tri = &indices[adjacency[jj]*3];
+				touched[position[tri[0] ] ] = 1;
+				touched[position[tri[1] ] ] = 1;
+				touched[position[tri[2] ] ] = 1;
+			}
+		}
+
+		if (0 == numCollapses)
+		{
+			break;
+		}
+
+		uint32_t num = 0;
+		for (uint32_t ii = 0; ii < numIndices; ii += 3)
+		{
+			const uint32_t i0 = remap[_result[ii+0] ];
+			const uint32_t i1 = remap[_result[ii+1] ];
+			const uint32_t i2 = remap[_result[ii+2] ];
+			const uint32_t p0 = position[i0];
+			const uint32_t p1 = position[i1];
+			const uint32_t p2 = position[i2];
+
+			if (p0 != p1
+			&&  p0 != p2
+			&&  p1 != p2)
+			{
+				_result[num+0] = i0;
+				_result[num+1] = i1;
+				_result[num+2] = i2;
+				num += 3;
+			}
+		}
+		_result.resize(num);
+	}
+
+	return sqrtf(result);
+}
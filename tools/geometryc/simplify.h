@@ -0,0 +1,31 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef SIMPLIFY_H_HEADER_GUARD
+#define SIMPLIFY_H_HEADER_GUARD
+
+#include <stdint.h>
+#include <vector>
+
+/// Simplify triangle list with quadric error metric edge collapses.
+///
+/// Vertices are only collapsed onto existing neighbor vertices, so
+/// simplified index buffer references the same vertex buffer. Vertices
+/// on attribute seams (same position, different attributes) and on open
+/// borders never move.
+///
+/// @param _result Simplified index buffer.
+/// @param _indices Source index buffer.
+/// @param _numIndices Number of source indices.
+/// @param _vertices Vertex data, position must be float3 at offset 0.
+/// @param _numVertices Number of vertices.
+/// @param _stride Vertex stride.
+/// @param _targetIndices Stop when index count drops to this number.
+/// @param _maxError Maximum allowed error, in object space units.
+/// @returns Achieved error, in object space units.
+///
+float simplify(std::vector<uint32_t>& _result, const uint32_t* _indices, uint32_t _numIndices, const void* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _targetIndices, float _maxError);
+
+#endif // SIMPLIFY_H_HEADER_GUARD
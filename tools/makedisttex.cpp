@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <math.h>
 
 #include <edtaa3func.h>
 #include <stb_image.c>
@@ -14,8 +15,13 @@
 #define BX_NAMESPACE 1
 #include <bx/bx.h>
 #include <bx/commandline.h>
+#include <bx/timer.h>
 #include <bx/uint32_t.h>
 
+#include <bgfx.h>
+
+#include "../examples/common/font/distance_field.h"
+
 long int fsize(FILE* _file)
 {
 	long int pos = ftell(_file);
@@ -51,6 +57,39 @@ void edtaa3(double* _img, uint16_t _width, uint16_t _height, double* _out)
 	free(gy);
 }
 
+/// Reference signed distance, positive outside, computed with edtaa3.
+void distanceFieldEdtaa3(float* _dist, const uint8_t* _img, uint32_t _width, uint32_t _height)
+{
+	uint32_t size = _width*_height;
+
+	double* imgIn = (double*)malloc(size*sizeof(double) );
+	double* outside = (double*)malloc(size*sizeof(double) );
+	double* inside = (double*)malloc(size*sizeof(double) );
+
+	for (uint32_t ii = 0; ii < size; ++ii)
+	{
+		imgIn[ii] = double(_img[ii])/255.0;
+	}
+
+	edtaa3(imgIn, _width, _height, outside);
+
+	for (uint32_t ii = 0; ii < size; ++ii)
+	{
+		imgIn[ii] = 1.0 - imgIn[ii];
+	}
+
+	edtaa3(imgIn, _width, _height, inside);
+
+	for (uint32_t ii = 0; ii < size; ++ii)
+	{
+		_dist[ii] = float(outside[ii] - inside[ii]);
+	}
+
+	free(imgIn);
+	free(inside);
+	free(outside);
+}
+
 void saveTga(const char* _filePath, uint32_t _width, uint32_t _height, uint32_t _pitch, bool _grayscale, const void* _data)
 {
 	FILE* file = fopen(_filePath, "wb");
@@ -92,24 +131,154 @@ void saveTga(const char* _filePath, uint32_t _width, uint32_t _height, uint32_t
 	}
 }
 
-inline double min(double _a, double _b)
+struct DistanceFieldCompare
 {
-	return _a > _b ? _b : _a;
-}
-
-inline double max(double _a, double _b)
+	float m_maxError;
+	float m_meanError;
+	uint32_t m_maxLevel;
+	float m_meanLevel;
+};
+
+/// Compare distance fields within _edge pixels from shape edge, where
+/// distance field carries information. Levels are 8-bit output values.
+void compare(DistanceFieldCompare& _result, const float* _ref, const float* _dist, uint32_t _size, double _edge)
 {
-	return _a > _b ? _a : _b;
+	const float scale = float(255.0/_edge);
+	const float limit = float(_edge*0.5);
+
+	double sumError = 0.0;
+	double sumLevel = 0.0;
+	uint32_t num = 0;
+
+	_result.m_maxError = 0.0f;
+	_result.m_maxLevel = 0;
+
+	for (uint32_t ii = 0; ii < _size; ++ii)
+	{
+		if (fabsf(_ref[ii]) < limit)
+		{
+			const float error = fabsf(_ref[ii] - _dist[ii]);
+			_result.m_maxError = error > _result.m_maxError ? error : _result.m_maxError;
+			sumError += error;
+
+			uint8_t ref;
+			uint8_t dist;
+			distanceFieldQuantize(&ref, &_ref[ii], 1, scale, 127.5f);
+			distanceFieldQuantize(&dist, &_dist[ii], 1, scale, 127.5f);
+			const uint32_t level = ref > dist ? ref - dist : dist - ref;
+			_result.m_maxLevel = bx::uint32_max(level, _result.m_maxLevel);
+			sumLevel += level;
+
+			++num;
+		}
+	}
+
+	_result.m_meanError = float(sumError/bx::uint32_max(num, 1) );
+	_result.m_meanLevel = float(sumLevel/bx::uint32_max(num, 1) );
 }
 
-inline double clamp(double _val, double _min, double _max)
+struct GlyphBatch
 {
-	return max(min(_val, _max), _min);
+	const uint8_t* m_img;
+	float* m_dist;
+	uint8_t* m_scratch;
+	uint32_t m_pitch;
+	uint32_t m_glyphSize;
+	uint32_t m_glyphsPerRow;
+	uint32_t m_numGlyphs;
+	uint32_t m_numThreads;
+};
+
+/// Glyph batch is split between threads, and every glyph is processed on
+/// single thread, same as FontManager does.
+void glyphBatchChunk(uint32_t _chunk, void* _userData)
+{
+	GlyphBatch& batch = *(GlyphBatch*)_userData;
+	const uint32_t glyphSize = batch.m_glyphSize;
+	const uint32_t size = glyphSize*glyphSize;
+
+	uint8_t* scratch = batch.m_scratch + _chunk*(size + distanceFieldScratchSize(glyphSize, glyphSize) );
+	uint8_t* glyph = scratch + distanceFieldScratchSize(glyphSize, glyphSize);
+
+	for (uint32_t ii = _chunk; ii < batch.m_numGlyphs; ii += batch.m_numThreads)
+	{
+		const uint8_t* src = &batch.m_img[(ii/batch.m_glyphsPerRow)*glyphSize*batch.m_pitch + (ii%batch.m_glyphsPerRow)*glyphSize];
+		for (uint32_t yy = 0; yy < glyphSize; ++yy)
+		{
+			memcpy(&glyph[yy*glyphSize], &src[yy*batch.m_pitch], glyphSize);
+		}
+
+		distanceField(&batch.m_dist[ii*size], glyph, glyphSize, glyphSize, scratch);
+	}
 }
 
-inline double saturate(double _val)
+int benchmark(const uint8_t* _img, uint32_t _width, uint32_t _height, uint32_t _glyphSize, uint32_t _numThreads, double _edge)
 {
-	return clamp(_val, 0.0, 1.0);
+	const uint32_t glyphsPerRow = _width/_glyphSize;
+	const uint32_t numGlyphs = glyphsPerRow*(_height/_glyphSize);
+	if (0 == numGlyphs)
+	{
+		fprintf(stderr, "Image is smaller than glyph size %d.\n", _glyphSize);
+		return EXIT_FAILURE;
+	}
+
+	const uint32_t size = _glyphSize*_glyphSize;
+	float* ref = (float*)malloc(numGlyphs*size*sizeof(float) );
+	uint8_t* glyph = (uint8_t*)malloc(size);
+
+	int64_t elapsed = -bx::getHPCounter();
+	for (uint32_t ii = 0; ii < numGlyphs; ++ii)
+	{
+		const uint8_t* src = &_img[(ii/glyphsPerRow)*_glyphSize*_width + (ii%glyphsPerRow)*_glyphSize];
+		for (uint32_t yy = 0; yy < _glyphSize; ++yy)
+		{
+			memcpy(&glyph[yy*_glyphSize], &src[yy*_width], _glyphSize);
+		}
+
+		distanceFieldEdtaa3(&ref[ii*size], glyph, _glyphSize, _glyphSize);
+	}
+	elapsed += bx::getHPCounter();
+
+	const double freq = double(bx::getHPFrequency() );
+	printf("%d glyphs %dx%d\n", numGlyphs, _glyphSize, _glyphSize);
+	printf("  edtaa3: %8.1f glyphs/s\n", numGlyphs*freq/double(elapsed) );
+
+	GlyphBatch batch;
+	batch.m_img = _img;
+	batch.m_dist = (float*)malloc(numGlyphs*size*sizeof(float) );
+	batch.m_scratch = (uint8_t*)malloc(_numThreads*(size + distanceFieldScratchSize(_glyphSize, _glyphSize) ) );
+	batch.m_pitch = _width;
+	batch.m_glyphSize = _glyphSize;
+	batch.m_glyphsPerRow = glyphsPerRow;
+	batch.m_numGlyphs = numGlyphs;
+
+	const uint32_t threads[] = { 1, _numThreads };
+	for (uint32_t ii = 0, num = 1 < _numThreads ? 2 : 1; ii < num; ++ii)
+	{
+		batch.m_numThreads = threads[ii];
+
+		elapsed = -bx::getHPCounter();
+		bgfx::parallelFor(batch.m_numThreads, glyphBatchChunk, &batch, batch.m_numThreads);
+		elapsed += bx::getHPCounter();
+
+		printf("     edt: %8.1f glyphs/s (%d threads)\n", numGlyphs*freq/double(elapsed), batch.m_numThreads);
+	}
+
+	DistanceFieldCompare result;
+	compare(result, ref, batch.m_dist, numGlyphs*size, _edge);
+	printf("  error vs edtaa3: max %0.3f, mean %0.3f pixels, max %d, mean %0.3f levels\n"
+		, result.m_maxError
+		, result.m_meanError
+		, result.m_maxLevel
+		, result.m_meanLevel
+		);
+
+	free(batch.m_scratch);
+	free(batch.m_dist);
+	free(glyph);
+	free(ref);
+
+	return EXIT_SUCCESS;
 }
 
 int main(int _argc, const char* _argv[])
@@ -123,8 +292,11 @@ int main(int _argc, const char* _argv[])
 		return EXIT_FAILURE;
 	}
 
+	const bool bench = cmdLine.hasArg("bench");
+
 	const char* outFilePath = cmdLine.findOption('o');
-	if (NULL == outFilePath)
+	if (NULL == outFilePath
+	&&  !bench)
 	{
 		fprintf(stderr, "Output file name must be specified.\n");
 		return EXIT_FAILURE;
@@ -137,6 +309,13 @@ int main(int _argc, const char* _argv[])
 		edge = atof(edgeOpt);
 	}
 
+	uint32_t numThreads = 1;
+	const char* threadsOpt = cmdLine.findOption("threads");
+	if (NULL != threadsOpt)
+	{
+		numThreads = bx::uint32_min(bx::uint32_max(atoi(threadsOpt), 1), 64);
+	}
+
 	int width;
 	int height;
 	int comp;
@@ -149,41 +328,57 @@ int main(int _argc, const char* _argv[])
 		return EXIT_FAILURE;
 	}
 
-	uint32_t size = width*height;
-
-	double* imgIn = (double*)malloc(size*sizeof(double) );
-	double* outside = (double*)malloc(size*sizeof(double) );
-	double* inside = (double*)malloc(size*sizeof(double) );
-
-	for (uint32_t ii = 0; ii < size; ++ii)
+	if (bench)
 	{
-		imgIn[ii] = double(img[ii])/255.0;
+		uint32_t glyphSize = 64;
+		const char* glyphOpt = cmdLine.findOption("glyph");
+		if (NULL != glyphOpt)
+		{
+			glyphSize = bx::uint32_max(atoi(glyphOpt), 1);
+		}
+
+		int result = benchmark(img, width, height, glyphSize, numThreads, edge);
+		stbi_image_free(img);
+		return result;
 	}
 
-	edtaa3(imgIn, width, height, outside);
+	uint32_t size = width*height;
 
-	for (uint32_t ii = 0; ii < size; ++ii)
+	float* dist = (float*)malloc(size*sizeof(float) );
+
+	if (cmdLine.hasArg("edtaa3") )
 	{
-		imgIn[ii] = 1.0 - imgIn[ii];
+		distanceFieldEdtaa3(dist, img, width, height);
 	}
+	else
+	{
+		uint8_t* scratch = (uint8_t*)malloc(distanceFieldScratchSize(width, height, numThreads) );
+		distanceField(dist, img, width, height, scratch, numThreads);
+		free(scratch);
 
-	edtaa3(imgIn, width, height, inside);
+		if (cmdLine.hasArg("compare") )
+		{
+			float* ref = (float*)malloc(size*sizeof(float) );
+			distanceFieldEdtaa3(ref, img, width, height);
+
+			DistanceFieldCompare result;
+			compare(result, ref, dist, size, edge);
+			printf("Error vs edtaa3: max %0.3f, mean %0.3f pixels, max %d, mean %0.3f levels\n"
+				, result.m_maxError
+				, result.m_meanError
+				, result.m_maxLevel
+				, result.m_meanLevel
+				);
+
+			free(ref);
+		}
+	}
 
-	free(imgIn);
+	stbi_image_free(img);
 
 	uint8_t* grayscale = (uint8_t*)malloc(size);
-
-	double edgeOffset = edge*0.5;
-	double invEdge = 1.0/edge;
-
-	for (uint32_t ii = 0; ii < size; ++ii)
-	{
-		double dist = saturate( ( (outside[ii] - inside[ii])+edgeOffset) * invEdge);
-		grayscale[ii] = 255-uint8_t(dist * 255.0);
-	}
-
-	free(inside);
-	free(outside);
+	distanceFieldQuantize(grayscale, dist, size, float(255.0/edge), 127.5f);
+	free(dist);
 
 	saveTga(outFilePath, width, height, width, true, grayscale);
 
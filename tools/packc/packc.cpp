@@ -0,0 +1,339 @@
+/*
+ * Copyright 2011-2013 Branimir Karadzic. All rights reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <bx/bx.h>
+#include <bx/commandline.h>
+#include <bx/readerwriter.h>
+#include <bx/timer.h>
+#include <bx/uint32_t.h>
+
+#include "../../examples/common/assetpack.h"
+
+struct Asset
+{
+	std::string m_name;
+	std::vector<uint8_t> m_data;
+	uint32_t m_hash;
+};
+
+typedef std::vector<Asset> AssetArray;
+
+bool operator<(const Asset& _a, const Asset& _b)
+{
+	return _a.m_hash < _b.m_hash;
+}
+
+long int fsize(FILE* _file)
+{
+	long int pos = ftell(_file);
+	fseek(_file, 0L, SEEK_END);
+	long int size = ftell(_file);
+	fseek(_file, pos, SEEK_SET);
+	return size;
+}
+
+static bool readFile(const char* _filePath, std::vector<uint8_t>& _data)
+{
+	FILE* file = fopen(_filePath, "rb");
+	if (NULL == file)
+	{
+		return false;
+	}
+
+	uint32_t size = (uint32_t)fsize(file);
+	_data.resize(size);
+	size_t read = 0 == size ? 0 : fread(&_data[0], 1, size, file);
+	fclose(file);
+
+	return read == size;
+}
+
+static void writePadding(bx::WriterI* _writer, uint32_t _size)
+{
+	static const uint8_t zero[ASSETPACK_ALIGN] = {};
+	bx::write(_writer, zero, _size);
+}
+
+static uint32_t checksum(const void* _data, uint32_t _size)
+{
+	const uint8_t* data = (const uint8_t*)_data;
+	uint32_t sum = 0;
+	for (uint32_t ii = 0; ii < _size; ++ii)
+	{
+		sum += data[ii];
+	}
+
+	return sum;
+}
+
+static int bench(const char* _filePath, uint32_t _iterations)
+{
+	AssetPack pack;
+	if (!pack.open(_filePath) )
+	{
+		fprintf(stderr, "Unable to open asset pack '%s'.\n", _filePath);
+		return EXIT_FAILURE;
+	}
+
+	const uint32_t numEntries = pack.getNumEntries();
+	std::vector<std::string> names;
+	names.reserve(numEntries);
+
+	uint64_t totalSize = 0;
+	for (uint32_t ii = 0; ii < numEntries; ++ii)
+	{
+		names.push_back(pack.getName(ii) );
+		totalSize += pack.getSize(ii);
+	}
+	pack.close();
+
+	// Loose files are loaded the same way example loaders do, into fresh
+	// allocation per asset.
+	uint32_t looseSum = 0;
+	int64_t looseElapsed = -bx::getHPCounter();
+	for (uint32_t iter = 0; iter < _iterations; ++iter)
+	{
+		for (uint32_t ii = 0; ii < numEntries; ++ii)
+		{
+			FILE* file = fopen(names[ii].c_str(), "rb");
+			if (NULL == file)
+			{
+				fprintf(stderr, "Unable to open loose file '%s'.\n", names[ii].c_str() );
+				return EXIT_FAILURE;
+			}
+
+			uint32_t size = (uint32_t)fsize(file);
+			uint8_t* data = (uint8_t*)malloc(size+1);
+			size_t ignore = fread(data, 1, size, file);
+			BX_UNUSED(ignore);
+			fclose(file);
+			data[size] = '\0';
+
+			looseSum += checksum(data, size);
+			free(data);
+		}
+	}
+	looseElapsed += bx::getHPCounter();
+
+	uint32_t packSum = 0;
+	int64_t packElapsed = -bx::getHPCounter();
+	for (uint32_t iter = 0; iter < _iterations; ++iter)
+	{
+		pack.open(_filePath);
+		for (uint32_t ii = 0; ii < numEntries; ++ii)
+		{
+			uint32_t size;
+			const void* data = pack.find(names[ii].c_str(), size);
+			packSum += checksum(data, size);
+		}
+		pack.close();
+	}
+	packElapsed += bx::getHPCounter();
+
+	if (looseSum != packSum)
+	{
+		fprintf(stderr, "Loose files don't match asset pack content.\n");
+		return EXIT_FAILURE;
+	}
+
+	const double freq = double(bx::getHPFrequency() );
+	const double looseMs = double(looseElapsed)*1000.0/freq/_iterations;
+	const double packMs  = double(packElapsed )*1000.0/freq/_iterations;
+	const double mb = double(totalSize)/(1024.0*1024.0);
+
+	printf("%d assets, %0.2f MiB, %d iterations (warm file cache).\n", numEntries, mb, _iterations);
+	printf("  loose files: %8.3f ms (%8.1f MiB/s)\n", looseMs, mb/looseMs*1000.0);
+	printf("  asset pack:  %8.3f ms (%8.1f MiB/s)\n", packMs,  mb/packMs *1000.0);
+
+	return EXIT_SUCCESS;
+}
+
+void help(const char* _error = NULL)
+{
+	if (NULL != _error)
+	{
+		fprintf(stderr, "Error:\n%s\n\n", _error);
+	}
+
+	fprintf(stderr
+		, "packc, bgfx asset pack compiler tool\n"
+		  "Copyright 2011-2013 Branimir Karadzic. All rights reserved.\n"
+		  "License: http://www.opensource.org/licenses/BSD-2-Clause\n\n"
+		);
+
+	fprintf(stderr
+		, "Usage: packc -f <file list> -o <out>\n"
+		  "       packc --bench -i <pack>\n"
+
+		  "\n"
+		  "Options:\n"
+		  "  -f <file path>           Text file with one asset path per line. Assets are\n"
+		  "           stored under the same path, relative to working directory.\n"
+		  "  -o <file path>           Output asset pack.\n"
+		  "  -i <file path>           Input asset pack.\n"
+		  "      --bench              Compare loading all assets from loose files and\n"
+		  "           from asset pack.\n"
+		  "      --iterations <num>   Number of benchmark iterations (default 10).\n"
+
+		  "\n"
+		  "For additional information, see https://github.com/bkaradzic/bgfx\n"
+		);
+}
+
+int main(int _argc, const char* _argv[])
+{
+	bx::CommandLine cmdLine(_argc, _argv);
+
+	if (cmdLine.hasArg("bench") )
+	{
+		const char* packFilePath = cmdLine.findOption('i');
+		if (NULL == packFilePath)
+		{
+			help("Input asset pack must be specified.");
+			return EXIT_FAILURE;
+		}
+
+		uint32_t iterations = 10;
+		cmdLine.hasArg(iterations, '\0', "iterations");
+
+		return bench(packFilePath, bx::uint32_max(iterations, 1) );
+	}
+
+	const char* listFilePath = cmdLine.findOption('f');
+	if (NULL == listFilePath)
+	{
+		help("File list must be specified.");
+		return EXIT_FAILURE;
+	}
+
+	const char* outFilePath = cmdLine.findOption('o');
+	if (NULL == outFilePath)
+	{
+		help("Output file name must be specified.");
+		return EXIT_FAILURE;
+	}
+
+	std::vector<uint8_t> list;
+	if (!readFile(listFilePath, list) )
+	{
+		fprintf(stderr, "Unable to open file list '%s'.\n", listFilePath);
+		return EXIT_FAILURE;
+	}
+	list.push_back('\0');
+
+	AssetArray assets;
+
+	for (char* line = strtok( (char*)&list[0], "\r\n"); NULL != line; line = strtok(NULL, "\r\n") )
+	{
+		if ('\0' == line[0]
+		||  '#' == line[0])
+		{
+			continue;
+		}
+
+		Asset asset;
+		asset.m_name = line;
+		asset.m_hash = assetPackHash(line);
+
+		if (!readFile(line, asset.m_data) )
+		{
+			fprintf(stderr, "Unable to read asset '%s'.\n", line);
+			return EXIT_FAILURE;
+		}
+
+		assets.push_back(asset);
+	}
+
+	std::stable_sort(assets.begin(), assets.end() );
+
+	for (uint32_t ii = 1, num = (uint32_t)assets.size(); ii < num; ++ii)
+	{
+		if (assets[ii-1].m_name == assets[ii].m_name)
+		{
+			fprintf(stderr, "Duplicate asset '%s'.\n", assets[ii].m_name.c_str() );
+			return EXIT_FAILURE;
+		}
+	}
+
+	const uint32_t numEntries = (uint32_t)assets.size();
+
+	AssetPackHeader header;
+	header.magic = ASSETPACK_MAGIC;
+	header.version = ASSETPACK_VERSION;
+	header.numEntries = numEntries;
+	header.tocOffset = BX_ALIGN_16(sizeof(AssetPackHeader) );
+	header.namesOffset = header.tocOffset + numEntries*sizeof(AssetPackEntry);
+
+	std::vector<AssetPackEntry> toc(numEntries);
+
+	uint32_t offset = header.namesOffset;
+	for (uint32_t ii = 0; ii < numEntries; ++ii)
+	{
+		toc[ii].hash = assets[ii].m_hash;
+		toc[ii].name = offset;
+		offset += (uint32_t)assets[ii].m_name.size()+1;
+	}
+
+	for (uint32_t ii = 0; ii < numEntries; ++ii)
+	{
+		// Keep at least one zero byte after each asset, so that text assets
+		// can be used directly.
+		offset = BX_ALIGN_16(offset);
+		toc[ii].offset = offset;
+		toc[ii].size = (uint32_t)assets[ii].m_data.size();
+		offset += toc[ii].size+1;
+	}
+	header.size = BX_ALIGN_16(offset);
+
+	bx::CrtFileWriter writer;
+	if (0 != bx::open(&writer, outFilePath) )
+	{
+		fprintf(stderr, "Unable to open output file '%s'.\n", outFilePath);
+		return EXIT_FAILURE;
+	}
+
+	bx::write(&writer, header);
+	writePadding(&writer, header.tocOffset - sizeof(AssetPackHeader) );
+
+	if (0 < numEntries)
+	{
+		bx::write(&writer, &toc[0], numEntries*sizeof(AssetPackEntry) );
+	}
+
+	offset = header.namesOffset;
+	for (uint32_t ii = 0; ii < numEntries; ++ii)
+	{
+		const std::string& name = assets[ii].m_name;
+		bx::write(&writer, name.c_str(), (int32_t)name.size()+1);
+		offset += (uint32_t)name.size()+1;
+	}
+
+	for (uint32_t ii = 0; ii < numEntries; ++ii)
+	{
+		writePadding(&writer, toc[ii].offset - offset);
+		offset = toc[ii].offset;
+
+		if (0 < toc[ii].size)
+		{
+			bx::write(&writer, &assets[ii].m_data[0], toc[ii].size);
+		}
+		offset += toc[ii].size;
+	}
+	writePadding(&writer, header.size - offset);
+
+	bx::close(&writer);
+
+	printf("%d assets, %d bytes.\n", numEntries, header.size);
+
+	return EXIT_SUCCESS;
+}